@@ -290,6 +290,28 @@ PersistentCache::PersistentCache(bool read_only)
 
 PersistentCache::~PersistentCache() = default;
 
+std::shared_ptr<fml::UniqueFD> PersistentCache::GetRasterCacheDirectory()
+    const {
+  if (!IsValid()) {
+    return std::make_shared<fml::UniqueFD>();
+  }
+  return std::make_shared<fml::UniqueFD>(fml::CreateDirectory(
+      *cache_directory_, {kRasterCacheSubdirName},
+      is_read_only_ ? fml::FilePermission::kRead
+                    : fml::FilePermission::kReadWrite));
+}
+
+std::shared_ptr<fml::UniqueFD> PersistentCache::GetGlyphAtlasDirectory()
+    const {
+  if (!IsValid()) {
+    return std::make_shared<fml::UniqueFD>();
+  }
+  return std::make_shared<fml::UniqueFD>(fml::CreateDirectory(
+      *cache_directory_, {kGlyphAtlasSubdirName},
+      is_read_only_ ? fml::FilePermission::kRead
+                    : fml::FilePermission::kReadWrite));
+}
+
 bool PersistentCache::IsValid() const {
   return cache_directory_ && cache_directory_->is_valid();
 }
@@ -131,7 +131,21 @@ class PersistentCache : public GrContextOptions::PersistentCache {
 
   static void MarkStrategySet() { strategy_set_ = true; }
 
+  bool IsReadOnly() const { return is_read_only_; }
+
+  /// Opens, creating it if needed, the directory in which the raster cache
+  /// keeps its entries on disk. The directory is invalid if this persistent
+  /// cache is. This does blocking file IO.
+  std::shared_ptr<fml::UniqueFD> GetRasterCacheDirectory() const;
+
+  /// Opens, creating it if needed, the directory in which the Impeller
+  /// glyph atlases keep their glyphs on disk. The directory is invalid if
+  /// this persistent cache is. This does blocking file IO.
+  std::shared_ptr<fml::UniqueFD> GetGlyphAtlasDirectory() const;
+
   static constexpr char kSkSLSubdirName[] = "sksl";
+  static constexpr char kRasterCacheSubdirName[] = "raster_cache";
+  static constexpr char kGlyphAtlasSubdirName[] = "glyph_atlas";
   static constexpr char kAssetFileName[] = "io.flutter.shaders.json";
 
  private:
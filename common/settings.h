@@ -30,6 +30,19 @@ enum class AndroidRenderingAPI {
   kSkiaOpenGLES
 };
 
+// How the frame pipeline between the UI and raster threads handles frames
+// that the raster thread has not gotten to yet.
+enum class FramePipelinePolicy {
+  // Every frame is rasterized in the order it was produced.
+  kFifo,
+  // Only the newest of the waiting frames is rasterized, the older ones are
+  // dropped.
+  kLatestWins,
+  // Frames are rasterized in order, but frames that waited for longer than
+  // the max latency are dropped if there is a newer frame.
+  kBoundedLatency,
+};
+
 class FrameTiming {
  public:
   enum Phase {
@@ -354,6 +367,36 @@ struct Settings {
   // Max bytes threshold of resource cache, or 0 for unlimited.
   size_t resource_cache_max_bytes_threshold = 0;
 
+  // Max bytes of all raster cache images, including those of layers drawn in
+  // the current frame, above which images of layers that were not drawn are
+  // evicted. 0 evicts them on the first frame they are not drawn.
+  size_t raster_cache_max_bytes_threshold = 0;
+
+  // Rasterize display lists for the raster cache on the IO thread instead of
+  // in the frame that first qualifies them for caching.
+  bool raster_cache_async_population = false;
+
+  // Max bytes of raster cache images to keep on disk across launches, or 0
+  // to not keep any. Implies raster_cache_async_population.
+  size_t raster_cache_disk_max_bytes = 0;
+
+  // Keep the glyphs rasterized into the Impeller glyph atlases on disk, and
+  // restore them on the next launch instead of rasterizing them again.
+  bool enable_glyph_atlas_disk_cache = false;
+
+  // How frames waiting between the UI and raster threads are handled.
+  FramePipelinePolicy frame_pipeline_policy = FramePipelinePolicy::kFifo;
+
+  // The max number of frames in flight between the UI and raster threads, or
+  // 0 for the default depth. Depths above 1 are clamped to 1 when the
+  // platform and raster threads are merged.
+  uint32_t frame_pipeline_depth = 0;
+
+  // The max time a frame may wait for the raster thread before it is dropped
+  // in favor of a newer frame, with FramePipelinePolicy::kBoundedLatency.
+  fml::TimeDelta frame_pipeline_max_latency =
+      fml::TimeDelta::FromMilliseconds(34);
+
   /// Enable embedder api on the embedder.
   ///
   /// This is currently only used by iOS.
@@ -3,8 +3,10 @@
 // found in the LICENSE file.
 
 #include "flutter/benchmarking/benchmarking.h"
+#include "flutter/display_list/dl_storage_arena.h"
 #include "flutter/display_list/testing/dl_test_snippets.h"
 #include "flutter/display_list/utils/dl_receiver_utils.h"
+#include "flutter/fml/concurrent_message_loop.h"
 
 namespace flutter {
 
@@ -200,6 +202,128 @@ static void BM_DisplayListBuilderWithSaveLayerAndImageFilter(
   }
 }
 
+static void RecordLargePicture(DisplayListBuilder& builder,
+                               size_t rect_count) {
+  DlPaint paint;
+  for (size_t i = 0; i < rect_count; i++) {
+    paint.setColor(DlColor(0xFF000000 | static_cast<uint32_t>(i)));
+    builder.DrawRect(DlRect::MakeXYWH(i % 100, i / 100, 10, 10), paint);
+  }
+}
+
+// Records a large picture every iteration with a fresh builder, growing
+// its op storage with realloc.
+static void BM_DisplayListBuilderLargePictureDefault(benchmark::State& state) {
+  size_t rect_count = state.range(0);
+  while (state.KeepRunning()) {
+    DisplayListBuilder builder;
+    RecordLargePicture(builder, rect_count);
+    auto display_list = builder.Build();
+  }
+}
+
+// Records a large picture every iteration with a single builder that
+// records into an arena, as a recorder that is reused every frame would.
+// The ArenaAllocations counter reports the number of heap allocations the
+// arena performed, which stays constant after the first few iterations.
+static void BM_DisplayListBuilderLargePictureArena(benchmark::State& state) {
+  size_t rect_count = state.range(0);
+  // Retain enough bytes for the largest pictures in the benchmark.
+  auto arena = DisplayListArena::Make(DisplayListArena::kDefaultChunkSize,
+                                      64 * 1024 * 1024);
+  DisplayListBuilder builder(DisplayListBuilder::kMaxCullRect, false, arena);
+  sk_sp<DisplayList> previous;
+  size_t warm_allocations = 0u;
+  int iterations = 0;
+  while (state.KeepRunning()) {
+    RecordLargePicture(builder, rect_count);
+    previous = builder.Build();
+    if (++iterations == 4) {
+      warm_allocations = arena->allocation_count();
+    }
+  }
+  state.counters["ArenaAllocations"] = arena->allocation_count();
+  if (iterations > 4) {
+    state.counters["SteadyStateAllocations"] =
+        arena->allocation_count() - warm_allocations;
+    EXPECT_EQ(arena->allocation_count(), warm_allocations);
+  }
+}
+
+// The number of points, sprites, vertices or rects recorded by each of
+// the bulk bounds benchmarks below.
+static constexpr int kBulkBoundsCount = 10000;
+
+static std::vector<DlPoint> MakeBulkBoundsPoints() {
+  std::vector<DlPoint> points;
+  points.reserve(kBulkBoundsCount);
+  for (int i = 0; i < kBulkBoundsCount; i++) {
+    points.emplace_back((i * 37) % 1000, (i * 53) % 1000);
+  }
+  return points;
+}
+
+// Records a single DrawPoints call of many points, dominated by the
+// computation of the bounds of the points.
+static void BM_DisplayListBuilderDrawPoints(benchmark::State& state,
+                                            DlCanvas::PointMode mode) {
+  auto points = MakeBulkBoundsPoints();
+  DlPaint paint;
+  while (state.KeepRunning()) {
+    DisplayListBuilder builder;
+    builder.DrawPoints(mode, kBulkBoundsCount, points.data(), paint);
+    auto display_list = builder.Build();
+  }
+}
+
+// Records a single DrawAtlas call of many rotated sprites, dominated by
+// the computation of the bounds of the sprite quads.
+static void BM_DisplayListBuilderDrawAtlas(benchmark::State& state) {
+  std::vector<SkRSXform> xforms;
+  std::vector<DlRect> tex;
+  for (int i = 0; i < kBulkBoundsCount; i++) {
+    SkScalar radians = i * 0.01f;
+    xforms.push_back(SkRSXform::Make(std::cos(radians), std::sin(radians),
+                                     (i * 37) % 1000, (i * 53) % 1000));
+    tex.push_back(DlRect::MakeXYWH((i % 4) * 10, (i / 4 % 4) * 10, 10, 10));
+  }
+  while (state.KeepRunning()) {
+    DisplayListBuilder builder;
+    builder.DrawAtlas(testing::TestImage1, xforms.data(), tex.data(), nullptr,
+                      kBulkBoundsCount, DlBlendMode::kSrcOver,
+                      DlImageSampling::kNearestNeighbor, nullptr);
+    auto display_list = builder.Build();
+  }
+}
+
+// Creates a DlVertices object with many vertices, dominated by the
+// computation of the bounds of the vertices.
+static void BM_DlVerticesMake(benchmark::State& state) {
+  auto points = MakeBulkBoundsPoints();
+  while (state.KeepRunning()) {
+    auto vertices =
+        DlVertices::Make(DlVertexMode::kTriangles, kBulkBoundsCount,
+                         ToSkPoints(points.data()), nullptr, nullptr);
+    benchmark::DoNotOptimize(vertices->bounds());
+  }
+}
+
+// Records many rects under a scale and translate transform, dominated by
+// mapping the bounds of each rect to device space.
+static void BM_DisplayListBuilderScaledRects(benchmark::State& state) {
+  DlPaint paint;
+  while (state.KeepRunning()) {
+    DisplayListBuilder builder;
+    builder.Translate(10.0f, 20.0f);
+    builder.Scale(1.5f, 2.5f);
+    for (int i = 0; i < kBulkBoundsCount; i++) {
+      builder.DrawRect(
+          DlRect::MakeXYWH((i * 37) % 1000, (i * 53) % 1000, 10, 10), paint);
+    }
+    auto display_list = builder.Build();
+  }
+}
+
 class DlOpReceiverIgnore : public IgnoreAttributeDispatchHelper,
                            public IgnoreTransformDispatchHelper,
                            public IgnoreClipDispatchHelper,
@@ -310,6 +434,35 @@ static void BM_DisplayListDispatchByVectorCull(
   }
 }
 
+// Dispatches a large picture split into up to state.range(0) tiles, each
+// to its own receiver on the workers of a concurrent message loop, as a
+// renderer converting the tiles of a 4K frame in parallel would.
+static void BM_DisplayListDispatchTiled(benchmark::State& state) {
+  size_t max_tiles = state.range(0);
+  DisplayListBuilder builder(SkRect::MakeWH(3840, 2160), true);
+  DlPaint paint;
+  for (int i = 0; i < 20000; i++) {
+    paint.setColor(DlColor(0xFF000000 | static_cast<uint32_t>(i)));
+    builder.DrawRect(
+        DlRect::MakeXYWH((i * 37) % 3800, (i * 53) % 2120, 40, 40), paint);
+  }
+  auto display_list = builder.Build();
+  auto tiles = display_list->ComputeDispatchTiles(SkRect::MakeWH(3840, 2160),
+                                                  max_tiles);
+  std::vector<DlOpReceiverIgnore> tile_receivers(tiles.size());
+  std::vector<DlOpReceiver*> receivers;
+  for (auto& receiver : tile_receivers) {
+    receivers.push_back(&receiver);
+  }
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  auto runner = loop->GetTaskRunner();
+  while (state.KeepRunning()) {
+    display_list->DispatchTiled(tiles, receivers, runner);
+  }
+  state.counters["Tiles"] = tiles.size();
+  state.counters["Workers"] = loop->GetWorkerCount();
+}
+
 BENCHMARK_CAPTURE(BM_DisplayListBuilderDefault,
                   kDefault,
                   DisplayListBuilderBenchmarkType::kDefault)
@@ -429,6 +582,27 @@ BENCHMARK_CAPTURE(BM_DisplayListBuilderWithSaveLayerAndImageFilter,
                   DisplayListBuilderBenchmarkType::kBoundsAndRtree)
     ->Unit(benchmark::kMicrosecond);
 
+BENCHMARK(BM_DisplayListBuilderLargePictureDefault)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DisplayListBuilderLargePictureArena)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_CAPTURE(BM_DisplayListBuilderDrawPoints,
+                  kPoints,
+                  DlCanvas::PointMode::kPoints)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DisplayListBuilderDrawPoints,
+                  kLines,
+                  DlCanvas::PointMode::kLines)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DisplayListBuilderDrawAtlas)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DlVerticesMake)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DisplayListBuilderScaledRects)->Unit(benchmark::kMicrosecond);
+
 BENCHMARK_CAPTURE(BM_DisplayListDispatchDefault,
                   kDefaultNoRtree,
                   DisplayListDispatchBenchmarkType::kDefaultNoRtree)
@@ -464,4 +638,10 @@ BENCHMARK_CAPTURE(BM_DisplayListDispatchByVectorCull,
                   DisplayListDispatchBenchmarkType::kCulledWithRtree)
     ->Unit(benchmark::kMicrosecond);
 
+BENCHMARK(BM_DisplayListDispatchTiled)
+    ->RangeMultiplier(4)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
 }  // namespace flutter
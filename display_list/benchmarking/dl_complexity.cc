@@ -4,6 +4,7 @@
 
 #include "flutter/display_list/benchmarking/dl_complexity.h"
 #include "flutter/display_list/benchmarking/dl_complexity_gl.h"
+#include "flutter/display_list/benchmarking/dl_complexity_impeller.h"
 #if !SLIMPELLER
 #include "flutter/display_list/benchmarking/dl_complexity_metal.h"
 #endif  // !SLIMPELLER
@@ -43,4 +44,9 @@ DisplayListComplexityCalculator::GetForSoftware() {
   return DisplayListNaiveComplexityCalculator::GetInstance();
 }
 
+DisplayListComplexityCalculator*
+DisplayListComplexityCalculator::GetForImpeller() {
+  return DisplayListImpellerComplexityCalculator::GetInstance();
+}
+
 }  // namespace flutter
@@ -0,0 +1,245 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures the raster time of the rendering ops in the dl_test_snippets
+// corpus and fits the costs of a DlComplexityModel to the measurements.
+//
+// Usage:
+//   display_list_complexity_calibration [--backend=software|opengl|metal]
+//                                       [--impeller]
+//                                       [--repetitions=<ops per list>]
+//                                       [--iterations=<runs per list>]
+//
+// Every variant of every rendering op is recorded into a list of its own,
+// repeated so that the list takes long enough to measure, with a number of
+// different attributes and scales so that the per-op, per-pixel and
+// per-edge costs can be told apart. With --impeller the lists are rendered
+// by Impeller through the ImpellerSnapshot method of the surface provider,
+// otherwise they are rendered by Skia.
+//
+// The fitted costs are printed as C++ that can replace the costs of a model
+// based calculator such as
+// DisplayListImpellerComplexityCalculator::PlaceholderModel.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "flutter/display_list/benchmarking/dl_complexity_impeller.h"
+#include "flutter/display_list/benchmarking/dl_complexity_model.h"
+#include "flutter/display_list/dl_builder.h"
+#include "flutter/display_list/skia/dl_sk_canvas.h"
+#include "flutter/display_list/testing/dl_test_snippets.h"
+#include "flutter/display_list/testing/dl_test_surface_provider.h"
+#include "flutter/fml/command_line.h"
+#include "flutter/fml/time/time_point.h"
+
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/gpu/ganesh/GrDirectContext.h"
+#include "third_party/skia/include/gpu/ganesh/GrRecordingContext.h"
+
+namespace flutter {
+
+DlOpReceiver& DisplayListBuilderBenchmarkAccessor(DisplayListBuilder& builder) {
+  return builder.asReceiver();
+}
+
+namespace testing {
+
+namespace {
+
+constexpr int kSurfaceSize = 1024;
+constexpr int kDefaultRepetitions = 50;
+constexpr int kDefaultIterations = 15;
+
+const char* const kFeatureNames[] = {
+    "kDrawOps",
+    "kFillArea",
+    "kStrokeLength",
+    "kStrokeArea",
+    "kAntiAliasedEdgeLength",
+    "kPathVerbs",
+    "kPoints",
+    "kImageArea",
+    "kImageUploadPixels",
+    "kTextRuns",
+    "kShadowArea",
+    "kSaveLayers",
+    "kSaveLayerArea",
+    "kFilteredArea",
+};
+static_assert(sizeof(kFeatureNames) / sizeof(kFeatureNames[0]) ==
+              kDlComplexityFeatureCount);
+
+struct SampleStyle {
+  bool anti_alias;
+  DlDrawStyle draw_style;
+  float stroke_width;
+};
+
+const SampleStyle kSampleStyles[] = {
+    {false, DlDrawStyle::kFill, 0.0f},
+    {true, DlDrawStyle::kFill, 0.0f},
+    {false, DlDrawStyle::kStroke, 4.0f},
+    {true, DlDrawStyle::kStroke, 4.0f},
+    {true, DlDrawStyle::kStroke, 0.0f},
+};
+
+// The snippets draw into a small area near the origin so even the largest
+// scale fits on the surface.
+const float kSampleScales[] = {1.0f, 3.0f, 9.0f};
+
+sk_sp<DisplayList> BuildSample(DisplayListInvocation& invocation,
+                               const SampleStyle& style,
+                               float scale,
+                               int repetitions) {
+  DisplayListBuilder builder(SkRect::MakeWH(kSurfaceSize, kSurfaceSize));
+  DlOpReceiver& receiver = DisplayListBuilderBenchmarkAccessor(builder);
+  receiver.setAntiAlias(style.anti_alias);
+  receiver.setDrawStyle(style.draw_style);
+  receiver.setStrokeWidth(style.stroke_width);
+  receiver.scale(scale, scale);
+  for (int i = 0; i < repetitions; i++) {
+    invocation.Invoke(receiver);
+  }
+  return builder.Build();
+}
+
+void FlushSubmitCpuSync(const sk_sp<SkSurface>& surface) {
+  if (GrDirectContext* dContext =
+          GrAsDirectContext(surface->recordingContext())) {
+    dContext->flushAndSubmit(surface.get(), GrSyncCpu::kYes);
+  }
+}
+
+// Returns the median time taken by |render| over |iterations| runs, after
+// one untimed run to warm up any caches.
+double MedianNanoseconds(const std::function<void()>& render,
+                         int iterations) {
+  render();
+  std::vector<double> times;
+  for (int i = 0; i < iterations; i++) {
+    fml::TimePoint start = fml::TimePoint::Now();
+    render();
+    times.push_back((fml::TimePoint::Now() - start).ToNanoseconds());
+  }
+  std::nth_element(times.begin(), times.begin() + times.size() / 2,
+                   times.end());
+  return times[times.size() / 2];
+}
+
+bool ParseBackend(const std::string& name,
+                  DlSurfaceProvider::BackendType* backend) {
+  if (name == "software") {
+    *backend = DlSurfaceProvider::kSoftwareBackend;
+  } else if (name == "opengl") {
+    *backend = DlSurfaceProvider::kOpenGlBackend;
+  } else if (name == "metal") {
+    *backend = DlSurfaceProvider::kMetalBackend;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+int RunCalibration(const fml::CommandLine& command_line) {
+  DlSurfaceProvider::BackendType backend;
+  std::string backend_name =
+      command_line.GetOptionValueWithDefault("backend", "software");
+  if (!ParseBackend(backend_name, &backend)) {
+    fprintf(stderr, "Unknown backend: %s\n", backend_name.c_str());
+    return 1;
+  }
+  bool use_impeller = command_line.HasOption("impeller");
+  int repetitions = std::max(
+      std::stoi(command_line.GetOptionValueWithDefault(
+          "repetitions", std::to_string(kDefaultRepetitions))),
+      1);
+  int iterations = std::max(
+      std::stoi(command_line.GetOptionValueWithDefault(
+          "iterations", std::to_string(kDefaultIterations))),
+      1);
+
+  std::unique_ptr<DlSurfaceProvider> provider =
+      DlSurfaceProvider::Create(backend);
+  if (!provider || !provider->InitializeSurface(kSurfaceSize, kSurfaceSize)) {
+    fprintf(stderr, "The %s backend is not available\n",
+            backend_name.c_str());
+    return 1;
+  }
+  if (use_impeller && !provider->supports_impeller()) {
+    fprintf(stderr, "The %s backend does not support Impeller\n",
+            provider->backend_name().c_str());
+    return 1;
+  }
+
+  std::function<void(const sk_sp<DisplayList>&)> render;
+  if (use_impeller) {
+    render = [&provider](const sk_sp<DisplayList>& display_list) {
+      provider->ImpellerSnapshot(display_list, kSurfaceSize, kSurfaceSize);
+    };
+  } else {
+    render = [&provider](const sk_sp<DisplayList>& display_list) {
+      sk_sp<SkSurface> surface = provider->GetPrimarySurface()->sk_surface();
+      DlSkCanvasAdapter canvas(surface->getCanvas());
+      canvas.Clear(DlColor::kTransparent());
+      canvas.DrawDisplayList(display_list);
+      FlushSubmitCpuSync(surface);
+    };
+  }
+
+  // The time taken to clear, submit and (for Impeller) read back an empty
+  // list is not part of the cost of any of the ops.
+  sk_sp<DisplayList> empty = DisplayListBuilder().Build();
+  double overhead_ns =
+      MedianNanoseconds([&] { render(empty); }, iterations);
+
+  DlComplexityModel prior =
+      DisplayListImpellerComplexityCalculator::PlaceholderModel();
+  DlComplexityCalibrator calibrator;
+  for (DisplayListInvocationGroup& group : CreateAllRenderingOps()) {
+    for (DisplayListInvocation& invocation : group.variants) {
+      for (const SampleStyle& style : kSampleStyles) {
+        for (float scale : kSampleScales) {
+          sk_sp<DisplayList> display_list =
+              BuildSample(invocation, style, scale, repetitions);
+          double measured_ns =
+              MedianNanoseconds([&] { render(display_list); }, iterations) -
+              overhead_ns;
+          calibrator.AddSample(DlComplexityFeatures::Measure(*display_list),
+                               measured_ns);
+        }
+      }
+    }
+    fprintf(stderr, "Measured %s\n", group.op_name.c_str());
+  }
+
+  DlComplexityModel fitted = calibrator.Fit(prior);
+
+  printf("// %zu samples on %s%s, %" PRId64 "ns overhead per frame.\n",
+         calibrator.sample_count(), provider->backend_name().c_str(),
+         use_impeller ? " (Impeller)" : "",
+         static_cast<int64_t>(overhead_ns));
+  printf("// Mean relative error: %.1f%% with the prior costs, "
+         "%.1f%% with the fitted costs.\n",
+         calibrator.MeanRelativeError(prior) * 100.0,
+         calibrator.MeanRelativeError(fitted) * 100.0);
+  for (size_t i = 0; i < kDlComplexityFeatureCount; i++) {
+    printf("cost(DlComplexityFeature::%s) = %.4g;\n", kFeatureNames[i],
+           fitted.costs[i]);
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace flutter
+
+int main(int argc, char** argv) {
+  return flutter::testing::RunCalibration(
+      fml::CommandLineFromArgcArgv(argc, argv));
+}
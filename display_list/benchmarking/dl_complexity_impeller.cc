@@ -0,0 +1,53 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/display_list/benchmarking/dl_complexity_impeller.h"
+
+namespace flutter {
+
+DisplayListImpellerComplexityCalculator*
+    DisplayListImpellerComplexityCalculator::instance_ = nullptr;
+
+DisplayListImpellerComplexityCalculator*
+DisplayListImpellerComplexityCalculator::GetInstance() {
+  if (instance_ == nullptr) {
+    instance_ = new DisplayListImpellerComplexityCalculator();
+  }
+  return instance_;
+}
+
+DlComplexityModel DisplayListImpellerComplexityCalculator::PlaceholderModel() {
+  DlComplexityModel model;
+  auto cost = [&model](DlComplexityFeature feature) -> double& {
+    return model.costs[static_cast<size_t>(feature)];
+  };
+
+  // Nanoseconds per unit. These are guesses, not measurements, that only
+  // encode the expected ordering of the costs on a software rasterizer
+  // where every pixel is shaded on the CPU: each draw call has a fixed cost
+  // for encoding its commands, and geometry that Impeller tessellates on
+  // the CPU (paths, strokes and anti-aliased edges) costs more per pixel
+  // than plain fills. Replace them with the output of
+  // display_list_complexity_calibration.
+  cost(DlComplexityFeature::kDrawOps) = 1000.0;
+  cost(DlComplexityFeature::kFillArea) = 0.5;
+  cost(DlComplexityFeature::kStrokeLength) = 20.0;
+  cost(DlComplexityFeature::kStrokeArea) = 1.0;
+  cost(DlComplexityFeature::kAntiAliasedEdgeLength) = 4.0;
+  cost(DlComplexityFeature::kPathVerbs) = 200.0;
+  cost(DlComplexityFeature::kPoints) = 30.0;
+  cost(DlComplexityFeature::kImageArea) = 1.5;
+  cost(DlComplexityFeature::kImageUploadPixels) = 2.0;
+  cost(DlComplexityFeature::kTextRuns) = 20000.0;
+  cost(DlComplexityFeature::kShadowArea) = 6.0;
+  cost(DlComplexityFeature::kSaveLayers) = 30000.0;
+  cost(DlComplexityFeature::kSaveLayerArea) = 2.0;
+  cost(DlComplexityFeature::kFilteredArea) = 15.0;
+
+  // Set cache threshold at 1ms
+  model.cache_threshold_ns = 1000000.0;
+  return model;
+}
+
+}  // namespace flutter
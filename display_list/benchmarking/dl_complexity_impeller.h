@@ -0,0 +1,36 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_DISPLAY_LIST_BENCHMARKING_DL_COMPLEXITY_IMPELLER_H_
+#define FLUTTER_DISPLAY_LIST_BENCHMARKING_DL_COMPLEXITY_IMPELLER_H_
+
+#include "flutter/display_list/benchmarking/dl_complexity_model.h"
+
+namespace flutter {
+
+// Estimates the cost of rendering a DisplayList with Impeller on a
+// software Vulkan implementation such as SwiftShader.
+//
+// The costs are a placeholder: they are rough guesses of the relative cost
+// of each feature and have not been fitted to measured raster times. They
+// are kept as a DlComplexityModel table so that they can be replaced by the
+// output of the display_list_complexity_calibration tool once it can be run
+// against that backend, and the scores should not be relied on for more
+// than coarse decisions until then.
+class DisplayListImpellerComplexityCalculator
+    : public DisplayListModelComplexityCalculator {
+ public:
+  static DisplayListImpellerComplexityCalculator* GetInstance();
+
+  static DlComplexityModel PlaceholderModel();
+
+ private:
+  DisplayListImpellerComplexityCalculator()
+      : DisplayListModelComplexityCalculator(PlaceholderModel()) {}
+  static DisplayListImpellerComplexityCalculator* instance_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_DISPLAY_LIST_BENCHMARKING_DL_COMPLEXITY_IMPELLER_H_
@@ -0,0 +1,421 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/display_list/benchmarking/dl_complexity_model.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "flutter/display_list/dl_op_receiver.h"
+#include "flutter/display_list/dl_vertices.h"
+#include "flutter/display_list/utils/dl_receiver_utils.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+
+namespace flutter {
+
+namespace {
+
+// How strongly a fitted cost is pulled towards the cost of the prior
+// model, relative to the weight of the samples that contain its feature.
+constexpr double kPriorWeight = 1e-4;
+constexpr int kMaxFitIterations = 500;
+
+constexpr double kPi = 3.14159265358979323846;
+
+class FeatureAccumulator : public virtual DlOpReceiver,
+                           public virtual IgnoreClipDispatchHelper {
+ public:
+  FeatureAccumulator(DlComplexityFeatures& features, double paint_area)
+      : features_(features), paint_area_(paint_area) {}
+
+  void setAntiAlias(bool aa) override { attributes_.anti_alias = aa; }
+  void setDrawStyle(DlDrawStyle style) override { attributes_.style = style; }
+  void setStrokeWidth(float width) override {
+    attributes_.stroke_width = width;
+  }
+  void setImageFilter(const DlImageFilter* filter) override {
+    attributes_.has_image_filter = filter != nullptr;
+  }
+  void setMaskFilter(const DlMaskFilter* filter) override {
+    attributes_.has_mask_filter = filter != nullptr;
+  }
+  void setColor(DlColor color) override {}
+  void setStrokeMiter(float limit) override {}
+  void setStrokeCap(DlStrokeCap cap) override {}
+  void setStrokeJoin(DlStrokeJoin join) override {}
+  void setColorSource(const DlColorSource* source) override {}
+  void setColorFilter(const DlColorFilter* filter) override {}
+  void setInvertColors(bool invert) override {}
+  void setBlendMode(DlBlendMode mode) override {}
+
+  void save() override { scale_stack_.push_back(area_scale_); }
+  void saveLayer(const DlRect& bounds,
+                 const SaveLayerOptions options,
+                 const DlImageFilter* backdrop,
+                 std::optional<int64_t> backdrop_id) override {
+    double area =
+        bounds.IsEmpty() ? paint_area_ : bounds.Area() * area_scale_;
+    Add(DlComplexityFeature::kSaveLayers, 1.0);
+    Add(DlComplexityFeature::kSaveLayerArea, area);
+    if (backdrop ||
+        (options.renders_with_attributes() && attributes_.has_image_filter)) {
+      Add(DlComplexityFeature::kFilteredArea, area);
+    }
+    save();
+  }
+  void restore() override {
+    if (!scale_stack_.empty()) {
+      area_scale_ = scale_stack_.back();
+      scale_stack_.pop_back();
+    }
+  }
+
+  // Only the change in area caused by a transform affects the features,
+  // which is the determinant of its upper left 2x2 matrix.
+  void translate(DlScalar tx, DlScalar ty) override {}
+  void scale(DlScalar sx, DlScalar sy) override { Concat(sx * sy); }
+  void rotate(DlScalar degrees) override {}
+  void skew(DlScalar sx, DlScalar sy) override { Concat(1.0 - sx * sy); }
+  // clang-format off
+  void transform2DAffine(DlScalar mxx, DlScalar mxy, DlScalar mxt,
+                         DlScalar myx, DlScalar myy, DlScalar myt) override {
+    Concat(mxx * myy - mxy * myx);
+  }
+  void transformFullPerspective(
+      DlScalar mxx, DlScalar mxy, DlScalar mxz, DlScalar mxt,
+      DlScalar myx, DlScalar myy, DlScalar myz, DlScalar myt,
+      DlScalar mzx, DlScalar mzy, DlScalar mzz, DlScalar mzt,
+      DlScalar mwx, DlScalar mwy, DlScalar mwz, DlScalar mwt) override {
+    Concat(mxx * myy - mxy * myx);
+  }
+  // clang-format on
+  void transformReset() override { area_scale_ = 1.0; }
+
+  void drawColor(DlColor color, DlBlendMode mode) override {
+    AddOp(paint_area_);
+    Add(DlComplexityFeature::kFillArea, paint_area_);
+  }
+  void drawPaint() override { drawColor(DlColor(), DlBlendMode::kSrcOver); }
+  void drawLine(const DlPoint& p0, const DlPoint& p1) override {
+    AddOp(0.0);
+    AddStroke(p0.GetDistance(p1));
+  }
+  void drawDashedLine(const DlPoint& p0,
+                      const DlPoint& p1,
+                      DlScalar on_length,
+                      DlScalar off_length) override {
+    AddOp(0.0);
+    double interval = on_length + off_length;
+    double fraction = interval > 0.0 ? on_length / interval : 1.0;
+    AddStroke(p0.GetDistance(p1) * fraction);
+  }
+  void drawRect(const DlRect& rect) override {
+    AddGeometry(rect.Area(), 2.0 * (rect.GetWidth() + rect.GetHeight()));
+  }
+  void drawOval(const DlRect& bounds) override {
+    AddGeometry(kPi * 0.25 * bounds.Area(),
+                kPi * 0.5 * (bounds.GetWidth() + bounds.GetHeight()));
+  }
+  void drawCircle(const DlPoint& center, DlScalar radius) override {
+    AddGeometry(kPi * radius * radius, 2.0 * kPi * radius);
+  }
+  void drawRoundRect(const DlRoundRect& rrect) override {
+    drawRect(rrect.GetBounds());
+  }
+  void drawDiffRoundRect(const DlRoundRect& outer,
+                         const DlRoundRect& inner) override {
+    const DlRect& outer_bounds = outer.GetBounds();
+    const DlRect& inner_bounds = inner.GetBounds();
+    AddGeometry(std::max(outer_bounds.Area() - inner_bounds.Area(), 0.0f),
+                2.0 * (outer_bounds.GetWidth() + outer_bounds.GetHeight() +
+                       inner_bounds.GetWidth() + inner_bounds.GetHeight()));
+  }
+  void drawPath(const DlPath& path) override {
+    Add(DlComplexityFeature::kPathVerbs, path.GetSkPath().countVerbs());
+    drawRect(path.GetBounds());
+  }
+  void drawArc(const DlRect& oval_bounds,
+               DlScalar start_degrees,
+               DlScalar sweep_degrees,
+               bool use_center) override {
+    double fraction = std::min(std::abs(sweep_degrees) / 360.0, 1.0);
+    double half_perimeter = oval_bounds.GetWidth() + oval_bounds.GetHeight();
+    double perimeter = fraction * kPi * 0.5 * half_perimeter;
+    if (use_center) {
+      perimeter += 0.5 * half_perimeter;
+    }
+    AddGeometry(fraction * kPi * 0.25 * oval_bounds.Area(), perimeter);
+  }
+  void drawPoints(PointMode mode,
+                  uint32_t count,
+                  const DlPoint points[]) override {
+    AddOp(0.0);
+    Add(DlComplexityFeature::kPoints, count);
+  }
+  void drawVertices(const std::shared_ptr<DlVertices>& vertices,
+                    DlBlendMode mode) override {
+    double area = vertices->bounds().width() * vertices->bounds().height();
+    AddOp(area);
+    Add(DlComplexityFeature::kPoints, vertices->vertex_count());
+    AddScaled(DlComplexityFeature::kFillArea, area);
+  }
+  void drawImage(const sk_sp<DlImage> image,
+                 const DlPoint& point,
+                 DlImageSampling sampling,
+                 bool render_with_attributes) override {
+    AddImage(image, image->dimensions().area());
+  }
+  void drawImageRect(const sk_sp<DlImage> image,
+                     const DlRect& src,
+                     const DlRect& dst,
+                     DlImageSampling sampling,
+                     bool render_with_attributes,
+                     SrcRectConstraint constraint) override {
+    AddImage(image, dst.Area());
+  }
+  void drawImageNine(const sk_sp<DlImage> image,
+                     const DlIRect& center,
+                     const DlRect& dst,
+                     DlFilterMode filter,
+                     bool render_with_attributes) override {
+    AddImage(image, dst.Area());
+  }
+  void drawAtlas(const sk_sp<DlImage> atlas,
+                 const SkRSXform xform[],
+                 const DlRect tex[],
+                 const DlColor colors[],
+                 int count,
+                 DlBlendMode mode,
+                 DlImageSampling sampling,
+                 const DlRect* cull_rect,
+                 bool render_with_attributes) override {
+    double area = 0.0;
+    for (int i = 0; i < count; i++) {
+      double scale = xform[i].fSCos * xform[i].fSCos +
+                     xform[i].fSSin * xform[i].fSSin;
+      area += tex[i].Area() * scale;
+    }
+    AddImage(atlas, area);
+  }
+  void drawDisplayList(const sk_sp<DisplayList> display_list,
+                       DlScalar opacity) override {
+    // The nested list starts from default attributes and must not change
+    // the attributes of this list.
+    Attributes attributes = attributes_;
+    attributes_ = Attributes();
+    save();
+    if (opacity < SK_Scalar1 && !display_list->can_apply_group_opacity()) {
+      saveLayer(display_list->GetBounds(), SaveLayerOptions::kWithAttributes,
+                nullptr, std::nullopt);
+    }
+    display_list->Dispatch(*this);
+    if (opacity < SK_Scalar1 && !display_list->can_apply_group_opacity()) {
+      restore();
+    }
+    restore();
+    attributes_ = attributes;
+  }
+  void drawTextBlob(const sk_sp<SkTextBlob> blob,
+                    DlScalar x,
+                    DlScalar y) override {
+    AddOp(blob->bounds().width() * blob->bounds().height());
+    Add(DlComplexityFeature::kTextRuns, 1.0);
+  }
+  void drawTextFrame(const std::shared_ptr<impeller::TextFrame>& text_frame,
+                     DlScalar x,
+                     DlScalar y) override {
+    AddOp(0.0);
+    Add(DlComplexityFeature::kTextRuns, 1.0);
+  }
+  void drawShadow(const DlPath& path,
+                  const DlColor color,
+                  const DlScalar elevation,
+                  bool transparent_occluder,
+                  DlScalar dpr) override {
+    double area = path.GetBounds().Area();
+    AddOp(area);
+    AddScaled(DlComplexityFeature::kShadowArea, area);
+  }
+
+ private:
+  void Add(DlComplexityFeature feature, double value) {
+    features_[feature] += value;
+  }
+
+  void AddScaled(DlComplexityFeature feature, double area) {
+    features_[feature] += area * area_scale_;
+  }
+
+  void Concat(double determinant) { area_scale_ *= std::abs(determinant); }
+
+  void AddOp(double area) {
+    Add(DlComplexityFeature::kDrawOps, 1.0);
+    if (attributes_.has_image_filter || attributes_.has_mask_filter) {
+      AddScaled(DlComplexityFeature::kFilteredArea, area);
+    }
+  }
+
+  void AddStroke(double length) {
+    double scale = std::sqrt(area_scale_);
+    Add(DlComplexityFeature::kStrokeLength, length * scale);
+    AddScaled(DlComplexityFeature::kStrokeArea,
+              length * attributes_.stroke_width);
+    if (attributes_.anti_alias) {
+      Add(DlComplexityFeature::kAntiAliasedEdgeLength, 2.0 * length * scale);
+    }
+  }
+
+  void AddGeometry(double area, double perimeter) {
+    AddOp(area);
+    if (attributes_.style != DlDrawStyle::kStroke) {
+      AddScaled(DlComplexityFeature::kFillArea, area);
+      if (attributes_.anti_alias) {
+        Add(DlComplexityFeature::kAntiAliasedEdgeLength,
+            perimeter * std::sqrt(area_scale_));
+      }
+    }
+    if (attributes_.style != DlDrawStyle::kFill) {
+      AddStroke(perimeter);
+    }
+  }
+
+  void AddImage(const sk_sp<DlImage>& image, double area) {
+    AddOp(area);
+    AddScaled(DlComplexityFeature::kImageArea, area);
+    if (!image->isTextureBacked()) {
+      Add(DlComplexityFeature::kImageUploadPixels,
+          image->dimensions().area());
+    }
+  }
+
+  DlComplexityFeatures& features_;
+  const double paint_area_;
+
+  struct Attributes {
+    bool anti_alias = false;
+    DlDrawStyle style = DlDrawStyle::kFill;
+    double stroke_width = 0.0;
+    bool has_image_filter = false;
+    bool has_mask_filter = false;
+  };
+  Attributes attributes_;
+
+  double area_scale_ = 1.0;
+  std::vector<double> scale_stack_;
+};
+
+}  // namespace
+
+DlComplexityFeatures DlComplexityFeatures::Measure(
+    const DisplayList& display_list) {
+  DlComplexityFeatures features;
+  FeatureAccumulator accumulator(features, display_list.GetBounds().Area());
+  display_list.Dispatch(accumulator);
+  return features;
+}
+
+double DlComplexityModel::EstimateNanoseconds(
+    const DlComplexityFeatures& features) const {
+  double nanoseconds = 0.0;
+  for (size_t i = 0; i < kDlComplexityFeatureCount; i++) {
+    nanoseconds += costs[i] * features.values()[i];
+  }
+  return nanoseconds;
+}
+
+unsigned int DlComplexityModel::NanosecondsToScore(double nanoseconds,
+                                                   unsigned int ceiling) {
+  // A score of 100 is 0.0005ms, or 500ns.
+  double score = nanoseconds / 5.0;
+  if (!(score > 0.0)) {
+    return 0u;
+  }
+  if (score >= static_cast<double>(ceiling)) {
+    return ceiling;
+  }
+  return static_cast<unsigned int>(score);
+}
+
+unsigned int DisplayListModelComplexityCalculator::Compute(
+    const DisplayList* display_list) {
+  DlComplexityFeatures features = DlComplexityFeatures::Measure(*display_list);
+  return DlComplexityModel::NanosecondsToScore(
+      model_.EstimateNanoseconds(features), ceiling_);
+}
+
+void DlComplexityCalibrator::AddSample(const DlComplexityFeatures& features,
+                                       double measured_ns) {
+  if (measured_ns > 0.0) {
+    samples_.push_back({features, measured_ns});
+  }
+}
+
+DlComplexityModel DlComplexityCalibrator::Fit(
+    const DlComplexityModel& prior) const {
+  constexpr size_t n = kDlComplexityFeatureCount;
+
+  // Accumulate the normal equations of the least squares problem with each
+  // sample weighted by 1 / measured^2 so that the residuals are relative.
+  std::array<std::array<double, n>, n> ata = {};
+  std::array<double, n> atb = {};
+  for (const Sample& sample : samples_) {
+    const std::array<double, n>& x = sample.features.values();
+    double weight = 1.0 / (sample.measured_ns * sample.measured_ns);
+    for (size_t j = 0; j < n; j++) {
+      if (x[j] == 0.0) {
+        continue;
+      }
+      atb[j] += weight * x[j] * sample.measured_ns;
+      for (size_t k = 0; k < n; k++) {
+        ata[j][k] += weight * x[j] * x[k];
+      }
+    }
+  }
+
+  // Projected coordinate descent. Each step solves for one cost exactly
+  // with the others held fixed and clamps it to be non-negative.
+  DlComplexityModel model = prior;
+  for (int iteration = 0; iteration < kMaxFitIterations; iteration++) {
+    double max_change = 0.0;
+    for (size_t j = 0; j < n; j++) {
+      if (ata[j][j] <= 0.0) {
+        continue;
+      }
+      double residual = atb[j];
+      for (size_t k = 0; k < n; k++) {
+        if (k != j) {
+          residual -= ata[j][k] * model.costs[k];
+        }
+      }
+      double ridge = kPriorWeight * ata[j][j];
+      double cost = std::max(
+          (residual + ridge * prior.costs[j]) / (ata[j][j] + ridge), 0.0);
+      double change = std::abs(cost - model.costs[j]);
+      if (cost > 0.0) {
+        change /= cost;
+      }
+      max_change = std::max(max_change, change);
+      model.costs[j] = cost;
+    }
+    if (max_change < 1e-9) {
+      break;
+    }
+  }
+  return model;
+}
+
+double DlComplexityCalibrator::MeanRelativeError(
+    const DlComplexityModel& model) const {
+  if (samples_.empty()) {
+    return 0.0;
+  }
+  double total = 0.0;
+  for (const Sample& sample : samples_) {
+    double estimate = model.EstimateNanoseconds(sample.features);
+    total += std::abs(estimate - sample.measured_ns) / sample.measured_ns;
+  }
+  return total / samples_.size();
+}
+
+}  // namespace flutter
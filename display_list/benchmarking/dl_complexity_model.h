@@ -0,0 +1,158 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_DISPLAY_LIST_BENCHMARKING_DL_COMPLEXITY_MODEL_H_
+#define FLUTTER_DISPLAY_LIST_BENCHMARKING_DL_COMPLEXITY_MODEL_H_
+
+#include <array>
+#include <limits>
+#include <vector>
+
+#include "flutter/display_list/benchmarking/dl_complexity.h"
+#include "flutter/display_list/display_list.h"
+
+namespace flutter {
+
+// The Metal and OpenGL calculators encode their costs by hand in the
+// dispatch methods of their helpers. The calculators in this file instead
+// describe a DisplayList as a small vector of features and estimate its
+// raster time as a weighted sum of those features. The weights are a table
+// of numbers that can be fitted to raster times measured on a particular
+// backend by the display_list_complexity_calibration tool rather than
+// being tuned by hand.
+//
+// Areas and lengths are measured in device pixels using the scale of the
+// current transform. As with the other calculators, clips are ignored.
+enum class DlComplexityFeature {
+  // The number of rendering ops, the fixed cost of each draw call.
+  kDrawOps,
+  // The area of filled geometry, including drawPaint and drawColor which
+  // fill the bounds of the DisplayList.
+  kFillArea,
+  // The length of stroked outlines and lines, including hairlines.
+  kStrokeLength,
+  // The area of stroked outlines and lines, their length times their
+  // stroke width.
+  kStrokeArea,
+  // The length of the edges of anti-aliased geometry.
+  kAntiAliasedEdgeLength,
+  // The number of verbs in the paths passed to drawPath.
+  kPathVerbs,
+  // The number of points passed to drawPoints and vertices passed to
+  // drawVertices.
+  kPoints,
+  // The area covered by images.
+  kImageArea,
+  // The number of pixels of images that are not texture backed and have
+  // to be uploaded before they can be drawn.
+  kImageUploadPixels,
+  // The number of text blobs and text frames.
+  kTextRuns,
+  // The area of the bounds of shadowed paths.
+  kShadowArea,
+  // The number of saveLayer calls.
+  kSaveLayers,
+  // The area of the bounds of saveLayer calls.
+  kSaveLayerArea,
+  // The area of rendering ops and save layers drawn with an image filter,
+  // a mask filter or a backdrop filter.
+  kFilteredArea,
+};
+
+constexpr size_t kDlComplexityFeatureCount =
+    static_cast<size_t>(DlComplexityFeature::kFilteredArea) + 1;
+
+class DlComplexityFeatures {
+ public:
+  // Walks |display_list|, and any DisplayLists nested in it, and returns
+  // the features it contains.
+  static DlComplexityFeatures Measure(const DisplayList& display_list);
+
+  double operator[](DlComplexityFeature feature) const {
+    return values_[static_cast<size_t>(feature)];
+  }
+  double& operator[](DlComplexityFeature feature) {
+    return values_[static_cast<size_t>(feature)];
+  }
+
+  const std::array<double, kDlComplexityFeatureCount>& values() const {
+    return values_;
+  }
+
+ private:
+  std::array<double, kDlComplexityFeatureCount> values_ = {};
+};
+
+struct DlComplexityModel {
+  // The raster time, in nanoseconds, of one unit of each feature.
+  std::array<double, kDlComplexityFeatureCount> costs = {};
+
+  // DisplayLists estimated to take longer than this to rasterize are worth
+  // caching.
+  double cache_threshold_ns = 1000000.0;
+
+  double EstimateNanoseconds(const DlComplexityFeatures& features) const;
+
+  // Converts an estimate to the scale shared by all of the complexity
+  // calculators, where a score of 100 is roughly 0.0005ms.
+  static unsigned int NanosecondsToScore(double nanoseconds,
+                                         unsigned int ceiling);
+};
+
+class DisplayListModelComplexityCalculator
+    : public DisplayListComplexityCalculator {
+ public:
+  explicit DisplayListModelComplexityCalculator(const DlComplexityModel& model)
+      : model_(model), ceiling_(std::numeric_limits<unsigned int>::max()) {}
+
+  unsigned int Compute(const DisplayList* display_list) override;
+
+  bool ShouldBeCached(unsigned int complexity_score) override {
+    return complexity_score >
+           DlComplexityModel::NanosecondsToScore(model_.cache_threshold_ns,
+                                                 ceiling_);
+  }
+
+  void SetComplexityCeiling(unsigned int ceiling) override {
+    ceiling_ = ceiling;
+  }
+
+  const DlComplexityModel& model() const { return model_; }
+
+ private:
+  const DlComplexityModel model_;
+  unsigned int ceiling_;
+};
+
+// Fits the costs of a DlComplexityModel to a set of measured raster times.
+//
+// The fit minimizes the squared relative error of the estimates, so that
+// the many cheap samples and the few expensive ones carry the same weight,
+// and keeps every cost non-negative. Costs of features that none of the
+// samples contain are taken from the prior model passed to |Fit|, and all
+// costs are pulled slightly towards the prior so that features which only
+// ever appear together still get sensible values.
+class DlComplexityCalibrator {
+ public:
+  void AddSample(const DlComplexityFeatures& features, double measured_ns);
+
+  size_t sample_count() const { return samples_.size(); }
+
+  DlComplexityModel Fit(const DlComplexityModel& prior) const;
+
+  // Returns the mean of |estimate - measured| / measured over the samples.
+  double MeanRelativeError(const DlComplexityModel& model) const;
+
+ private:
+  struct Sample {
+    DlComplexityFeatures features;
+    double measured_ns;
+  };
+
+  std::vector<Sample> samples_;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_DISPLAY_LIST_BENCHMARKING_DL_COMPLEXITY_MODEL_H_
@@ -4,7 +4,9 @@
 
 #include "flutter/display_list/benchmarking/dl_complexity.h"
 #include "flutter/display_list/benchmarking/dl_complexity_gl.h"
+#include "flutter/display_list/benchmarking/dl_complexity_impeller.h"
 #include "flutter/display_list/benchmarking/dl_complexity_metal.h"
+#include "flutter/display_list/benchmarking/dl_complexity_model.h"
 #include "flutter/display_list/display_list.h"
 #include "flutter/display_list/dl_builder.h"
 #include "flutter/display_list/dl_sampling_options.h"
@@ -23,12 +25,14 @@ namespace {
 std::vector<DisplayListComplexityCalculator*> Calculators() {
   return {DisplayListMetalComplexityCalculator::GetInstance(),
           DisplayListGLComplexityCalculator::GetInstance(),
+          DisplayListImpellerComplexityCalculator::GetInstance(),
           DisplayListNaiveComplexityCalculator::GetInstance()};
 }
 
 std::vector<DisplayListComplexityCalculator*> AccumulatorCalculators() {
   return {DisplayListMetalComplexityCalculator::GetInstance(),
-          DisplayListGLComplexityCalculator::GetInstance()};
+          DisplayListGLComplexityCalculator::GetInstance(),
+          DisplayListImpellerComplexityCalculator::GetInstance()};
 }
 
 std::vector<SkPoint> GetTestPoints() {
@@ -440,5 +444,80 @@ TEST(DisplayListComplexity, DrawAtlas) {
   }
 }
 
+TEST(DisplayListComplexity, ModelFeaturesUseDeviceScale) {
+  DisplayListBuilder builder;
+  builder.DrawRect(SkRect::MakeXYWH(0, 0, 10, 10), DlPaint());
+  builder.Scale(2.0f, 2.0f);
+  builder.DrawRect(SkRect::MakeXYWH(0, 0, 10, 10),
+                   DlPaint().setDrawStyle(DlDrawStyle::kStroke));
+  auto display_list = builder.Build();
+
+  auto features = DlComplexityFeatures::Measure(*display_list);
+  EXPECT_EQ(features[DlComplexityFeature::kDrawOps], 2.0);
+  EXPECT_EQ(features[DlComplexityFeature::kFillArea], 100.0);
+  EXPECT_EQ(features[DlComplexityFeature::kStrokeLength], 80.0);
+  EXPECT_EQ(features[DlComplexityFeature::kAntiAliasedEdgeLength], 0.0);
+}
+
+TEST(DisplayListComplexity, CalibratorRecoversModelCosts) {
+  DlComplexityModel actual;
+  actual.costs[static_cast<size_t>(DlComplexityFeature::kDrawOps)] = 800.0;
+  actual.costs[static_cast<size_t>(DlComplexityFeature::kFillArea)] = 0.25;
+  actual.costs[static_cast<size_t>(DlComplexityFeature::kPathVerbs)] = 150.0;
+  actual.costs[static_cast<size_t>(DlComplexityFeature::kSaveLayers)] = 1e4;
+
+  DlComplexityModel prior =
+      DisplayListImpellerComplexityCalculator::PlaceholderModel();
+  DlComplexityCalibrator calibrator;
+  for (int i = 1; i <= 64; i++) {
+    DlComplexityFeatures features;
+    features[DlComplexityFeature::kDrawOps] = i;
+    features[DlComplexityFeature::kFillArea] = (i * 7919) % 10000;
+    features[DlComplexityFeature::kPathVerbs] = (i * 31) % 17;
+    features[DlComplexityFeature::kSaveLayers] = i % 3;
+    calibrator.AddSample(features, actual.EstimateNanoseconds(features));
+  }
+  ASSERT_EQ(calibrator.sample_count(), 64u);
+
+  DlComplexityModel fitted = calibrator.Fit(prior);
+  EXPECT_LT(calibrator.MeanRelativeError(fitted), 0.01);
+  EXPECT_LT(calibrator.MeanRelativeError(fitted),
+            calibrator.MeanRelativeError(prior));
+  for (auto feature :
+       {DlComplexityFeature::kDrawOps, DlComplexityFeature::kFillArea,
+        DlComplexityFeature::kPathVerbs, DlComplexityFeature::kSaveLayers}) {
+    size_t index = static_cast<size_t>(feature);
+    EXPECT_NEAR(fitted.costs[index], actual.costs[index],
+                actual.costs[index] * 0.01);
+  }
+  // Features that the samples do not contain keep the cost of the prior.
+  size_t text_runs = static_cast<size_t>(DlComplexityFeature::kTextRuns);
+  EXPECT_EQ(fitted.costs[text_runs], prior.costs[text_runs]);
+}
+
+TEST(DisplayListComplexity, ImpellerCalculatorCachesExpensiveLists) {
+  DisplayListBuilder builder_cheap;
+  builder_cheap.DrawRect(SkRect::MakeXYWH(10, 10, 80, 80), DlPaint());
+  auto display_list_cheap = builder_cheap.Build();
+
+  DisplayListBuilder builder_expensive;
+  DlPaint blur_paint;
+  blur_paint.setImageFilter(
+      DlBlurImageFilter::Make(5.0f, 5.0f, DlTileMode::kDecal));
+  for (int i = 0; i < 20; i++) {
+    SkRect bounds = SkRect::MakeXYWH(0, 0, 500, 500);
+    builder_expensive.SaveLayer(&bounds, &blur_paint);
+    builder_expensive.DrawRect(bounds, DlPaint().setAntiAlias(true));
+    builder_expensive.Restore();
+  }
+  auto display_list_expensive = builder_expensive.Build();
+
+  auto calculator = DisplayListComplexityCalculator::GetForImpeller();
+  EXPECT_FALSE(calculator->ShouldBeCached(
+      calculator->Compute(display_list_cheap.get())));
+  EXPECT_TRUE(calculator->ShouldBeCached(
+      calculator->Compute(display_list_expensive.get())));
+}
+
 }  // namespace testing
 }  // namespace flutter
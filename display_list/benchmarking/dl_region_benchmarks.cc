@@ -5,9 +5,11 @@
 #include "flutter/benchmarking/benchmarking.h"
 
 #include "flutter/display_list/geometry/dl_region.h"
+#include "flutter/display_list/geometry/dl_rtree.h"
 #include "flutter/fml/logging.h"
 #include "third_party/skia/include/core/SkRegion.h"
 
+#include <algorithm>
 #include <random>
 
 namespace {
@@ -90,26 +92,27 @@ class SkRegionAdapter {
   SkRegion region_;
 };
 
-class DlRegionAdapter {
+template <flutter::DlRegion::Representation representation>
+class DlRegionAdapterBase {
  public:
-  explicit DlRegionAdapter(const std::vector<SkIRect>& rects)
-      : region_(rects) {}
+  explicit DlRegionAdapterBase(const std::vector<SkIRect>& rects)
+      : region_(rects, representation) {}
 
-  static DlRegionAdapter unionRegions(const DlRegionAdapter& a1,
-                                      const DlRegionAdapter& a2) {
-    return DlRegionAdapter(
+  static DlRegionAdapterBase unionRegions(const DlRegionAdapterBase& a1,
+                                          const DlRegionAdapterBase& a2) {
+    return DlRegionAdapterBase(
         flutter::DlRegion::MakeUnion(a1.region_, a2.region_));
   }
 
-  static DlRegionAdapter intersectRegions(const DlRegionAdapter& a1,
-                                          const DlRegionAdapter& a2) {
-    return DlRegionAdapter(
+  static DlRegionAdapterBase intersectRegions(const DlRegionAdapterBase& a1,
+                                              const DlRegionAdapterBase& a2) {
+    return DlRegionAdapterBase(
         flutter::DlRegion::MakeIntersection(a1.region_, a2.region_));
   }
 
   SkIRect getBounds() { return region_.bounds(); }
 
-  bool intersects(const DlRegionAdapter& region) {
+  bool intersects(const DlRegionAdapterBase& region) {
     return region_.intersects(region.region_);
   }
 
@@ -118,12 +121,17 @@ class DlRegionAdapter {
   std::vector<SkIRect> getRects() { return region_.getRects(false); }
 
  private:
-  explicit DlRegionAdapter(flutter::DlRegion&& region)
+  explicit DlRegionAdapterBase(flutter::DlRegion&& region)
       : region_(std::move(region)) {}
 
   flutter::DlRegion region_;
 };
 
+using DlRegionAdapter =
+    DlRegionAdapterBase<flutter::DlRegion::Representation::kExact>;
+using DlTiledRegionAdapter =
+    DlRegionAdapterBase<flutter::DlRegion::Representation::kTiled>;
+
 template <typename Region>
 void RunFromRectsBenchmark(benchmark::State& state, int maxSize) {
   std::random_device d;
@@ -253,6 +261,85 @@ void RunIntersectsSingleRectBenchmark(benchmark::State& state, int maxSize) {
   }
 }
 
+// The number of rects in the R-Tree benchmarks, which is in the range of
+// the largest DisplayLists that apps record.
+const int kRTreeRectCount = 100000;
+
+// Generates rects scattered over a 4000 x 4000 area, either in a random
+// order or sorted from top to bottom like the ops of most DisplayLists.
+std::vector<SkRect> GenerateRTreeRects(int maxSize, bool sorted) {
+  std::seed_seq seed{2, 1, 3};
+  std::mt19937 rng(seed);
+
+  auto irects = GenerateRects(rng, SkIRect::MakeWH(4000, 4000),
+                              kRTreeRectCount, maxSize);
+  std::vector<SkRect> rects;
+  rects.reserve(irects.size());
+  for (const SkIRect& rect : irects) {
+    rects.push_back(SkRect::Make(rect));
+  }
+  if (sorted) {
+    std::sort(rects.begin(), rects.end(),
+              [](const SkRect& a, const SkRect& b) { return a.fTop < b.fTop; });
+  }
+  return rects;
+}
+
+std::vector<SkRect> GenerateRTreeQueries(double sizeFactor) {
+  std::seed_seq seed{3, 2, 1};
+  std::mt19937 rng(seed);
+
+  std::vector<SkRect> queries;
+  for (int i = 0; i < 100; ++i) {
+    queries.push_back(SkRect::Make(
+        RandomSubRect(rng, SkIRect::MakeWH(4000, 4000), sizeFactor)));
+  }
+  return queries;
+}
+
+void RunRTreeBuildBenchmark(benchmark::State& state, bool sorted) {
+  auto rects = GenerateRTreeRects(30, sorted);
+
+  while (state.KeepRunning()) {
+    flutter::DlRTree tree(rects.data(), static_cast<int>(rects.size()));
+  }
+}
+
+void RunRTreeSearchBenchmark(benchmark::State& state,
+                             double sizeFactor,
+                             bool sorted) {
+  auto rects = GenerateRTreeRects(30, sorted);
+  auto queries = GenerateRTreeQueries(sizeFactor);
+  flutter::DlRTree tree(rects.data(), static_cast<int>(rects.size()));
+
+  std::vector<int> results;
+  while (state.KeepRunning()) {
+    for (const SkRect& query : queries) {
+      results.clear();
+      tree.search(query, &results);
+    }
+  }
+}
+
+void RunRTreeSearchEachBenchmark(benchmark::State& state,
+                                 double sizeFactor,
+                                 bool sorted) {
+  auto rects = GenerateRTreeRects(30, sorted);
+  auto queries = GenerateRTreeQueries(sizeFactor);
+  flutter::DlRTree tree(rects.data(), static_cast<int>(rects.size()));
+
+  while (state.KeepRunning()) {
+    int hits = 0;
+    for (const SkRect& query : queries) {
+      tree.searchEach(query, [&hits](int) {
+        hits++;
+        return true;
+      });
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+}
+
 }  // namespace
 
 namespace flutter {
@@ -313,39 +400,97 @@ static void BM_SkRegion_IntersectsSingleRect(benchmark::State& state,
   RunIntersectsSingleRectBenchmark<SkRegionAdapter>(state, maxSize);
 }
 
+static void BM_DlTiledRegion_FromRects(benchmark::State& state,
+                                       int maxSize) {
+  RunFromRectsBenchmark<DlTiledRegionAdapter>(state, maxSize);
+}
+
+static void BM_DlTiledRegion_Operation(benchmark::State& state,
+                                       RegionOp op,
+                                       bool withSingleRect,
+                                       int maxSize,
+                                       double sizeFactor) {
+  RunRegionOpBenchmark<DlTiledRegionAdapter>(state, op, withSingleRect,
+                                             maxSize, sizeFactor);
+}
+
+static void BM_DlTiledRegion_IntersectsRegion(benchmark::State& state,
+                                              int maxSize,
+                                              double sizeFactor) {
+  RunIntersectsRegionBenchmark<DlTiledRegionAdapter>(state, maxSize,
+                                                     sizeFactor);
+}
+
+static void BM_DlTiledRegion_IntersectsSingleRect(benchmark::State& state,
+                                                  int maxSize) {
+  RunIntersectsSingleRectBenchmark<DlTiledRegionAdapter>(state, maxSize);
+}
+
+static void BM_DlRTree_Build(benchmark::State& state, bool sorted) {
+  RunRTreeBuildBenchmark(state, sorted);
+}
+
+static void BM_DlRTree_Search(benchmark::State& state,
+                              double sizeFactor,
+                              bool sorted) {
+  RunRTreeSearchBenchmark(state, sizeFactor, sorted);
+}
+
+static void BM_DlRTree_SearchEach(benchmark::State& state,
+                                  double sizeFactor,
+                                  bool sorted) {
+  RunRTreeSearchEachBenchmark(state, sizeFactor, sorted);
+}
+
 const double kSizeFactorSmall = 0.3;
 
 BENCHMARK_CAPTURE(BM_DlRegion_IntersectsSingleRect, Tiny, 30)
     ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_IntersectsSingleRect, Tiny, 30)
+    ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_IntersectsSingleRect, Tiny, 30)
     ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_DlRegion_IntersectsSingleRect, Small, 100)
     ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_IntersectsSingleRect, Small, 100)
+    ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_IntersectsSingleRect, Small, 100)
     ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_DlRegion_IntersectsSingleRect, Medium, 400)
     ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_IntersectsSingleRect, Medium, 400)
+    ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_IntersectsSingleRect, Medium, 400)
     ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_DlRegion_IntersectsSingleRect, Large, 1500)
     ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_IntersectsSingleRect, Large, 1500)
+    ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_IntersectsSingleRect, Large, 1500)
     ->Unit(benchmark::kNanosecond);
 
 BENCHMARK_CAPTURE(BM_DlRegion_IntersectsRegion, Tiny, 30, 1.0)
     ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_IntersectsRegion, Tiny, 30, 1.0)
+    ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_IntersectsRegion, Tiny, 30, 1.0)
     ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_DlRegion_IntersectsRegion, Small, 100, 1.0)
     ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_IntersectsRegion, Small, 100, 1.0)
+    ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_IntersectsRegion, Small, 100, 1.0)
     ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_DlRegion_IntersectsRegion, Medium, 400, 1.0)
     ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_IntersectsRegion, Medium, 400, 1.0)
+    ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_IntersectsRegion, Medium, 400, 1.0)
     ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_DlRegion_IntersectsRegion, Large, 1500, 1.0)
     ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_IntersectsRegion, Large, 1500, 1.0)
+    ->Unit(benchmark::kNanosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_IntersectsRegion, Large, 1500, 1.0)
     ->Unit(benchmark::kNanosecond);
 
@@ -397,6 +542,13 @@ BENCHMARK_CAPTURE(BM_DlRegion_Operation,
                   30,
                   1.0)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_Operation,
+                  Union_Tiny,
+                  RegionOp::kUnion,
+                  false,
+                  30,
+                  1.0)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_Operation,
                   Union_Tiny,
                   RegionOp::kUnion,
@@ -411,6 +563,13 @@ BENCHMARK_CAPTURE(BM_DlRegion_Operation,
                   100,
                   1.0)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_Operation,
+                  Union_Small,
+                  RegionOp::kUnion,
+                  false,
+                  100,
+                  1.0)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_Operation,
                   Union_Small,
                   RegionOp::kUnion,
@@ -425,6 +584,13 @@ BENCHMARK_CAPTURE(BM_DlRegion_Operation,
                   400,
                   1.0)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_Operation,
+                  Union_Medium,
+                  RegionOp::kUnion,
+                  false,
+                  400,
+                  1.0)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_Operation,
                   Union_Medium,
                   RegionOp::kUnion,
@@ -439,6 +605,13 @@ BENCHMARK_CAPTURE(BM_DlRegion_Operation,
                   1500,
                   1.0)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_Operation,
+                  Union_Large,
+                  RegionOp::kUnion,
+                  false,
+                  1500,
+                  1.0)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_Operation,
                   Union_Large,
                   RegionOp::kUnion,
@@ -625,6 +798,13 @@ BENCHMARK_CAPTURE(BM_DlRegion_Operation,
                   30,
                   1.0)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_Operation,
+                  Intersection_SingleRect_Tiny,
+                  RegionOp::kIntersection,
+                  true,
+                  30,
+                  1.0)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_Operation,
                   Intersection_SingleRect_Tiny,
                   RegionOp::kIntersection,
@@ -639,6 +819,13 @@ BENCHMARK_CAPTURE(BM_DlRegion_Operation,
                   100,
                   1.0)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_Operation,
+                  Intersection_SingleRect_Small,
+                  RegionOp::kIntersection,
+                  true,
+                  100,
+                  1.0)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_Operation,
                   Intersection_SingleRect_Small,
                   RegionOp::kIntersection,
@@ -653,6 +840,13 @@ BENCHMARK_CAPTURE(BM_DlRegion_Operation,
                   400,
                   1.0)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_Operation,
+                  Intersection_SingleRect_Medium,
+                  RegionOp::kIntersection,
+                  true,
+                  400,
+                  1.0)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_Operation,
                   Intersection_SingleRect_Medium,
                   RegionOp::kIntersection,
@@ -667,6 +861,13 @@ BENCHMARK_CAPTURE(BM_DlRegion_Operation,
                   1500,
                   1.0)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_Operation,
+                  Intersection_SingleRect_Large,
+                  RegionOp::kIntersection,
+                  true,
+                  1500,
+                  1.0)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_Operation,
                   Intersection_SingleRect_Large,
                   RegionOp::kIntersection,
@@ -677,18 +878,26 @@ BENCHMARK_CAPTURE(BM_SkRegion_Operation,
 
 BENCHMARK_CAPTURE(BM_DlRegion_FromRects, Tiny, 30)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_FromRects, Tiny, 30)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_FromRects, Tiny, 30)
     ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_DlRegion_FromRects, Small, 100)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_FromRects, Small, 100)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_FromRects, Small, 100)
     ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_DlRegion_FromRects, Medium, 400)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_FromRects, Medium, 400)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_FromRects, Medium, 400)
     ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_DlRegion_FromRects, Large, 1500)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlTiledRegion_FromRects, Large, 1500)
+    ->Unit(benchmark::kMicrosecond);
 BENCHMARK_CAPTURE(BM_SkRegion_FromRects, Large, 1500)
     ->Unit(benchmark::kMicrosecond);
 
@@ -709,4 +918,37 @@ BENCHMARK_CAPTURE(BM_DlRegion_GetRects, Large, 1500)
 BENCHMARK_CAPTURE(BM_SkRegion_GetRects, Large, 1500)
     ->Unit(benchmark::kMicrosecond);
 
+BENCHMARK_CAPTURE(BM_DlRTree_Build, Sorted, true)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_DlRTree_Build, Scattered, false)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_DlRTree_Search, SortedTiny, 0.01, true)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlRTree_SearchEach, SortedTiny, 0.01, true)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlRTree_Search, ScatteredTiny, 0.01, false)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlRTree_SearchEach, ScatteredTiny, 0.01, false)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlRTree_Search, SortedSmall, 0.1, true)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlRTree_SearchEach, SortedSmall, 0.1, true)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlRTree_Search, ScatteredSmall, 0.1, false)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlRTree_SearchEach, ScatteredSmall, 0.1, false)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlRTree_Search, SortedLarge, kSizeFactorSmall, true)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlRTree_SearchEach, SortedLarge, kSizeFactorSmall, true)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlRTree_Search, ScatteredLarge, kSizeFactorSmall, false)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DlRTree_SearchEach,
+                  ScatteredLarge,
+                  kSizeFactorSmall,
+                  false)
+    ->Unit(benchmark::kMicrosecond);
+
 }  // namespace flutter
\ No newline at end of file
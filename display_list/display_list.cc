@@ -2,10 +2,16 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
 #include <type_traits>
 
 #include "flutter/display_list/display_list.h"
 #include "flutter/display_list/dl_op_records.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/trace_event.h"
 
 namespace flutter {
@@ -280,8 +286,10 @@ DisplayListOpCategory DisplayList::GetOpCategory(DisplayListOpType type) {
     case DisplayListOpType::kSetBlendMode:
     case DisplayListOpType::kClearColorFilter:
     case DisplayListOpType::kSetPodColorFilter:
+    case DisplayListOpType::kSetSharedColorFilter:
     case DisplayListOpType::kClearColorSource:
     case DisplayListOpType::kSetPodColorSource:
+    case DisplayListOpType::kSetSharedColorSource:
     case DisplayListOpType::kSetImageColorSource:
     case DisplayListOpType::kSetRuntimeEffectColorSource:
     case DisplayListOpType::kClearImageFilter:
@@ -289,6 +297,7 @@ DisplayListOpCategory DisplayList::GetOpCategory(DisplayListOpType type) {
     case DisplayListOpType::kSetSharedImageFilter:
     case DisplayListOpType::kClearMaskFilter:
     case DisplayListOpType::kSetPodMaskFilter:
+    case DisplayListOpType::kSetSharedMaskFilter:
       return DisplayListOpCategory::kAttribute;
 
     case DisplayListOpType::kSave:
@@ -391,6 +400,142 @@ std::vector<DlIndex> DisplayList::GetCulledIndices(
   return indices;
 }
 
+std::vector<SkRect> DisplayList::ComputeDispatchTiles(
+    const SkRect& area,
+    size_t max_tiles) const {
+  std::vector<SkRect> tiles;
+  SkRect content = bounds_;
+  if (max_tiles == 0u || !content.intersect(area)) {
+    return tiles;
+  }
+  const SkIRect grid = content.roundOut();
+  const int64_t width = grid.width();
+  const int64_t height = grid.height();
+
+  // Choose the grid dimensions so that the tiles are close to square.
+  const int64_t tile_limit = static_cast<int64_t>(max_tiles);
+  int64_t columns = std::llround(std::sqrt(
+      static_cast<double>(tile_limit) * width / std::max<int64_t>(height, 1)));
+  columns = std::clamp<int64_t>(columns, 1, std::min(tile_limit, width));
+  int64_t rows = std::clamp<int64_t>(tile_limit / columns, 1, height);
+
+  tiles.reserve(rows * columns);
+  for (int64_t row = 0; row < rows; row++) {
+    int64_t top = grid.fTop + height * row / rows;
+    int64_t bottom = grid.fTop + height * (row + 1) / rows;
+    for (int64_t column = 0; column < columns; column++) {
+      int64_t left = grid.fLeft + width * column / columns;
+      int64_t right = grid.fLeft + width * (column + 1) / columns;
+      SkRect tile = SkRect::MakeLTRB(left, top, right, bottom);
+      // Skip the tiles that do not contain any ops, the search stops at
+      // the first op that it finds.
+      if (rtree_ && rtree_->searchEach(tile, [](int) { return false; })) {
+        continue;
+      }
+      tiles.push_back(tile);
+    }
+  }
+  return tiles;
+}
+
+namespace {
+
+// The state shared between the calling thread and the worker tasks of a
+// |DisplayList::DispatchTiled| call. Worker tasks may start running after
+// the call has returned, at which point there are no tiles left for them
+// to claim, so this state is reference counted.
+struct TiledDispatchState {
+  explicit TiledDispatchState(size_t count) : tile_count(count) {}
+
+  const size_t tile_count;
+  std::atomic<size_t> next_tile{0u};
+
+  std::mutex mutex;
+  std::condition_variable all_tiles_dispatched;
+  size_t dispatched_tiles = 0u;
+};
+
+}  // namespace
+
+void DisplayList::DispatchTiled(
+    const std::vector<SkRect>& tiles,
+    const std::vector<DlOpReceiver*>& receivers,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& runner) const {
+  FML_DCHECK(tiles.size() == receivers.size());
+  const size_t tile_count = std::min(tiles.size(), receivers.size());
+  if (tile_count == 0u) {
+    return;
+  }
+  TRACE_EVENT0("flutter", "DisplayList::DispatchTiled");
+
+  auto state = std::make_shared<TiledDispatchState>(tile_count);
+  // The list, tiles and receivers are only accessed after successfully
+  // claiming a tile which can only happen before this method returns.
+  auto dispatch_tiles = [state, list = this, tiles = &tiles,
+                         receivers = &receivers]() {
+    size_t index;
+    while ((index = state->next_tile.fetch_add(1u)) < state->tile_count) {
+      list->Dispatch(*(*receivers)[index], (*tiles)[index]);
+      std::scoped_lock lock(state->mutex);
+      if (++state->dispatched_tiles == state->tile_count) {
+        state->all_tiles_dispatched.notify_all();
+      }
+    }
+  };
+
+  if (runner) {
+    // The calling thread works on the tiles as well.
+    for (size_t i = 1u; i < tile_count; i++) {
+      runner->PostTask(dispatch_tiles);
+    }
+  }
+  dispatch_tiles();
+
+  std::unique_lock lock(state->mutex);
+  state->all_tiles_dispatched.wait(lock, [&state]() {
+    return state->dispatched_tiles == state->tile_count;
+  });
+}
+
+std::vector<DisplayList::OpRange> DisplayList::GetTopLevelGroups() const {
+  std::vector<OpRange> groups;
+  const DlIndex count = offsets_.size();
+  DlIndex start = 0u;
+  DlIndex index = 0u;
+  while (index < count) {
+    auto op = reinterpret_cast<const DLOp*>(storage_.get() + offsets_[index]);
+    switch (GetOpCategory(op->type)) {
+      case DisplayListOpCategory::kSave:
+      case DisplayListOpCategory::kSaveLayer: {
+        // The entire contents of the save, including its restore, belong
+        // to the same group.
+        DlIndex restore_index =
+            static_cast<const SaveOpBase*>(op)->restore_index;
+        FML_DCHECK(restore_index > index && restore_index < count);
+        index = restore_index + 1;
+        groups.push_back({start, index});
+        start = index;
+        break;
+      }
+      case DisplayListOpCategory::kRendering:
+      case DisplayListOpCategory::kSubDisplayList:
+        index++;
+        groups.push_back({start, index});
+        start = index;
+        break;
+      default:
+        index++;
+        break;
+    }
+  }
+  if (start < count) {
+    // Trailing attribute, transform or clip records that were not
+    // followed by any rendering.
+    groups.push_back({start, count});
+  }
+  return groups;
+}
+
 bool DisplayList::Dispatch(DlOpReceiver& receiver, DlIndex index) const {
   // Assert unsigned type so we can eliminate >= 0 comparison
   static_assert(std::is_unsigned_v<DlIndex>);
@@ -14,6 +14,10 @@
 #include "flutter/display_list/geometry/dl_rtree.h"
 #include "flutter/fml/logging.h"
 
+namespace fml {
+class ConcurrentTaskRunner;
+}  // namespace fml
+
 // The Flutter DisplayList mechanism encapsulates a persistent sequence of
 // rendering operations.
 //
@@ -72,9 +76,11 @@ namespace flutter {
                                     \
   V(ClearColorFilter)               \
   V(SetPodColorFilter)              \
+  V(SetSharedColorFilter)           \
                                     \
   V(ClearColorSource)               \
   V(SetPodColorSource)              \
+  V(SetSharedColorSource)           \
   V(SetImageColorSource)            \
   V(SetRuntimeEffectColorSource)    \
                                     \
@@ -84,6 +90,7 @@ namespace flutter {
                                     \
   V(ClearMaskFilter)                \
   V(SetPodMaskFilter)               \
+  V(SetSharedMaskFilter)            \
                                     \
   V(Save)                           \
   V(SaveLayer)                      \
@@ -263,26 +270,41 @@ class SaveLayerOptions {
   };
 };
 
-// Manages a buffer allocated with malloc.
+class DisplayListArena;
+
+// Manages a buffer allocated with malloc, or a buffer borrowed from a
+// |DisplayListArena| which will be returned to the arena when released.
 class DisplayListStorage {
  public:
   DisplayListStorage() = default;
   DisplayListStorage(DisplayListStorage&&) = default;
+  DisplayListStorage& operator=(DisplayListStorage&&) = default;
 
   uint8_t* get() { return ptr_.get(); }
 
   const uint8_t* get() const { return ptr_.get(); }
 
   void realloc(size_t count) {
+    // Buffers borrowed from an arena are never resized.
+    FML_DCHECK(!ptr_.get_deleter().arena);
     ptr_.reset(static_cast<uint8_t*>(std::realloc(ptr_.release(), count)));
     FML_CHECK(ptr_);
   }
 
  private:
+  DisplayListStorage(uint8_t* ptr,
+                     std::shared_ptr<DisplayListArena> arena,
+                     size_t capacity);
+
   struct FreeDeleter {
-    void operator()(uint8_t* p) { std::free(p); }
+    std::shared_ptr<DisplayListArena> arena;
+    size_t capacity = 0u;
+
+    void operator()(uint8_t* p);
   };
   std::unique_ptr<uint8_t, FreeDeleter> ptr_;
+
+  friend class DisplayListArena;
 };
 
 using DlIndex = uint32_t;
@@ -528,6 +550,100 @@ class DisplayList : public SkRefCnt {
   /// @see |Dispatch(receiver, index)|
   std::vector<DlIndex> GetCulledIndices(const SkRect& cull_rect) const;
 
+  /// @brief   Divide the part of the indicated device space |area| that
+  ///          is covered by the bounds of this DisplayList into a grid of
+  ///          at most |max_tiles| pixel aligned tiles, omitting any tiles
+  ///          in which the RTree shows that nothing is rendered.
+  ///
+  /// The tiles are disjoint and are returned in row major order. They are
+  /// meant to be passed to |DispatchTiled|.
+  ///
+  /// If the DisplayList has no RTree then no tiles are omitted.
+  ///
+  /// @see |DispatchTiled|
+  std::vector<SkRect> ComputeDispatchTiles(const SkRect& area,
+                                           size_t max_tiles) const;
+
+  /// @brief   Dispatch the records needed to render each of the |tiles|
+  ///          to the receiver at the same index in |receivers|, using the
+  ///          workers of the indicated |runner|, and wait for all of the
+  ///          tiles to be dispatched.
+  ///
+  /// Each receiver is sent exactly the records that |Dispatch(receiver,
+  /// tile)| would send it, in the same order. Rendering operations that
+  /// overlap more than one tile are sent to the receiver of each of those
+  /// tiles and overlapping operations are always received in the order
+  /// in which they were recorded, so every tile renders exactly what a
+  /// serial dispatch clipped to that tile would render.
+  ///
+  /// Each receiver is only ever called from one thread at a time, but
+  /// different receivers are called concurrently on different threads.
+  /// The calling thread also dispatches tiles while it waits, so it is
+  /// safe to call this method from one of the workers of |runner|. If
+  /// |runner| is null then all of the tiles are dispatched on the calling
+  /// thread.
+  ///
+  /// @see |ComputeDispatchTiles|
+  void DispatchTiled(
+      const std::vector<SkRect>& tiles,
+      const std::vector<DlOpReceiver*>& receivers,
+      const std::shared_ptr<fml::ConcurrentTaskRunner>& runner) const;
+
+  /// @brief   A half-open range of record indices, from |start| (inclusive)
+  ///          to |end| (exclusive).
+  struct OpRange {
+    DlIndex start;
+    DlIndex end;
+
+    bool operator==(const OpRange& other) const {
+      return start == other.start && end == other.end;
+    }
+  };
+
+  /// @brief   Return the ranges of records that form the independent
+  ///          top-level groups of this DisplayList, in order.
+  ///
+  /// Each group is either a complete save or saveLayer at the root level
+  /// along with all of its contents up to and including its matching
+  /// restore, or a single root level rendering operation. Any attribute,
+  /// transform or clip records that appear at the root level are included
+  /// in the group that follows them. The returned ranges cover every record
+  /// in the DisplayList with no gaps or overlap.
+  ///
+  /// These groups are the units that a |DisplayListBuilder| can splice
+  /// from a previous DisplayList into a new recording.
+  ///
+  /// @see |DisplayListBuilder::BeginSplice|
+  std::vector<OpRange> GetTopLevelGroups() const;
+
+  /// @brief   Indicates if this DisplayList was recorded by splicing the
+  ///          groups of the indicated DisplayList into a new recording.
+  ///
+  /// If this method returns true then the only pixels that may differ
+  /// between rendering the other DisplayList and rendering this one are
+  /// contained within the rectangles returned from
+  /// |GetSpliceChangedRects|.
+  ///
+  /// @see |DisplayListBuilder::BeginSplice|
+  bool IsSplicedFrom(const DisplayList& other) const {
+    return spliced_from_id_ != 0u && spliced_from_id_ == other.unique_id_;
+  }
+
+  /// @brief   The |unique_id| of the DisplayList that this DisplayList was
+  ///          spliced from, or 0 if it was recorded from scratch.
+  uint32_t spliced_from_id() const { return spliced_from_id_; }
+
+  /// @brief   The rectangles, in the same coordinate space as the |bounds|,
+  ///          within which the rendering of this DisplayList may differ
+  ///          from the DisplayList it was spliced from.
+  ///
+  /// The list is empty if this DisplayList was not spliced from another.
+  ///
+  /// @see |IsSplicedFrom|
+  const std::vector<SkRect>& GetSpliceChangedRects() const {
+    return splice_changed_rects_;
+  }
+
  private:
   DisplayList(DisplayListStorage&& ptr,
               size_t byte_count,
@@ -570,6 +686,10 @@ class DisplayList : public SkRefCnt {
 
   const sk_sp<const DlRTree> rtree_;
 
+  // Set by the DisplayListBuilder when this list was spliced from another.
+  uint32_t spliced_from_id_ = 0u;
+  std::vector<SkRect> splice_changed_rects_;
+
   void DispatchOneOp(DlOpReceiver& receiver, const uint8_t* ptr) const;
 
   void RTreeResultsToIndexVector(std::vector<DlIndex>& indices,
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -12,10 +13,12 @@
 #include "flutter/display_list/dl_blend_mode.h"
 #include "flutter/display_list/dl_builder.h"
 #include "flutter/display_list/dl_paint.h"
+#include "flutter/display_list/dl_storage_arena.h"
 #include "flutter/display_list/geometry/dl_rtree.h"
 #include "flutter/display_list/skia/dl_sk_dispatcher.h"
 #include "flutter/display_list/testing/dl_test_snippets.h"
 #include "flutter/display_list/utils/dl_receiver_utils.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/logging.h"
 #include "flutter/fml/math.h"
 #include "flutter/impeller/typographer/backends/skia/text_frame_skia.h"
@@ -5894,5 +5897,326 @@ TEST_F(DisplayListTest, BackdropFilterCulledAlongsideClipAndTransform) {
   }
 }
 
+TEST_F(DisplayListTest, ArenaBuilderMatchesDefaultBuilder) {
+  // A tiny chunk size forces the ops to be split across many chunks.
+  auto arena = DisplayListArena::Make(256u);
+  DisplayListBuilder arena_builder(DisplayListBuilder::kMaxCullRect,
+                                   /*prepare_rtree=*/true, arena);
+  DisplayListBuilder default_builder(/*prepare_rtree=*/true);
+  for (auto& group : allGroups) {
+    for (size_t i = 0; i < group.variants.size(); i++) {
+      for (DisplayListBuilder* builder : {&arena_builder, &default_builder}) {
+        DlOpReceiver& receiver = ToReceiver(*builder);
+        receiver.save();
+        group.variants[i].Invoke(receiver);
+        receiver.restore();
+      }
+    }
+  }
+  sk_sp<DisplayList> arena_dl = arena_builder.Build();
+  sk_sp<DisplayList> default_dl = default_builder.Build();
+
+  ASSERT_EQ(arena_dl->op_count(false), default_dl->op_count(false));
+  ASSERT_EQ(arena_dl->bytes(false), default_dl->bytes(false));
+  EXPECT_EQ(arena_dl->total_depth(), default_dl->total_depth());
+  EXPECT_EQ(arena_dl->bounds(), default_dl->bounds());
+  EXPECT_TRUE(DisplayListsEQ_Verbose(arena_dl, default_dl));
+}
+
+TEST_F(DisplayListTest, ArenaBuilderIsReusableAfterBuild) {
+  auto arena = DisplayListArena::Make();
+  DisplayListBuilder builder(DisplayListBuilder::kMaxCullRect,
+                             /*prepare_rtree=*/false, arena);
+  for (int frame = 0; frame < 3; frame++) {
+    builder.Save();
+    builder.Translate(frame, frame);
+    builder.DrawRect(DlRect::MakeLTRB(10, 10, 20, 20), DlPaint());
+    builder.Restore();
+    sk_sp<DisplayList> dl = builder.Build();
+
+    DisplayListBuilder expected;
+    expected.Save();
+    expected.Translate(frame, frame);
+    expected.DrawRect(DlRect::MakeLTRB(10, 10, 20, 20), DlPaint());
+    expected.Restore();
+    EXPECT_TRUE(DisplayListsEQ_Verbose(dl, expected.Build())) << frame;
+  }
+}
+
+TEST_F(DisplayListTest, ArenaBuilderSteadyStateDoesNotAllocate) {
+  auto arena = DisplayListArena::Make(1024u);
+  DisplayListBuilder builder(DisplayListBuilder::kMaxCullRect,
+                             /*prepare_rtree=*/false, arena);
+  auto record_frame = [&builder](int frame) {
+    DlPaint paint;
+    for (int i = 0; i < 1000; i++) {
+      paint.setColor(DlColor(0xFF000000 | (i + frame)));
+      builder.DrawRect(DlRect::MakeXYWH(i, frame, 10, 10), paint);
+    }
+    return builder.Build();
+  };
+
+  // The previous frame is still alive while the next frame is recorded,
+  // as it would be while it is being rendered on the raster thread.
+  sk_sp<DisplayList> previous;
+  for (int frame = 0; frame < 4; frame++) {
+    previous = record_frame(frame);
+  }
+  size_t allocations = arena->allocation_count();
+  for (int frame = 4; frame < 100; frame++) {
+    sk_sp<DisplayList> dl = record_frame(frame);
+    EXPECT_EQ(dl->op_count(), 1000u);
+    previous = std::move(dl);
+  }
+  EXPECT_EQ(arena->allocation_count(), allocations);
+}
+
+TEST_F(DisplayListTest, ArenaStorageOutlivesBuilder) {
+  auto arena = DisplayListArena::Make();
+  sk_sp<DisplayList> dl;
+  {
+    DisplayListBuilder builder(DisplayListBuilder::kMaxCullRect,
+                               /*prepare_rtree=*/false, arena);
+    builder.DrawRect(DlRect::MakeLTRB(10, 10, 20, 20), DlPaint());
+    dl = builder.Build();
+  }
+  EXPECT_EQ(arena->retained_bytes(), 0u);
+  EXPECT_EQ(dl->op_count(), 1u);
+  dl.reset();
+  EXPECT_GT(arena->retained_bytes(), 0u);
+}
+
+TEST_F(DisplayListTest, TopLevelGroupsFollowSaveAndRenderOps) {
+  DisplayListBuilder builder;
+  builder.DrawRect(DlRect::MakeLTRB(10, 10, 20, 20),
+                   DlPaint(DlColor::kRed()));
+  builder.Save();
+  builder.Translate(5, 5);
+  builder.DrawRect(DlRect::MakeLTRB(10, 10, 20, 20), DlPaint());
+  builder.Restore();
+  builder.ClipRect(DlRect::MakeLTRB(0, 0, 100, 100));
+  builder.DrawOval(DlRect::MakeLTRB(30, 30, 40, 40), DlPaint());
+  builder.Translate(10, 10);
+  auto dl = builder.Build();
+
+  ASSERT_EQ(dl->GetRecordCount(), 10u);
+  std::vector<DisplayList::OpRange> expected = {
+      {0u, 2u},   // setColor, drawRect
+      {2u, 7u},   // save, translate, setColor, drawRect, restore
+      {7u, 9u},   // clipRect, drawOval
+      {9u, 10u},  // translate
+  };
+  EXPECT_EQ(dl->GetTopLevelGroups(), expected);
+}
+
+static sk_sp<DisplayList> MakeSpliceBase(bool prepare_rtree) {
+  DisplayListBuilder builder(prepare_rtree);
+  builder.DrawRect(DlRect::MakeLTRB(10, 10, 20, 20),
+                   DlPaint(DlColor::kRed()));
+  builder.DrawRect(DlRect::MakeLTRB(30, 10, 40, 20),
+                   DlPaint(DlColor::kGreen()));
+  builder.DrawRect(DlRect::MakeLTRB(50, 10, 60, 20),
+                   DlPaint(DlColor::kBlue()));
+  return builder.Build();
+}
+
+TEST_F(DisplayListTest, SpliceOfAllGroupsReturnsBase) {
+  auto base = MakeSpliceBase(true);
+
+  DisplayListBuilder builder(true);
+  builder.BeginSplice(base);
+  ASSERT_EQ(builder.GetSpliceGroupCount(), 3u);
+  for (size_t i = 0; i < builder.GetSpliceGroupCount(); i++) {
+    EXPECT_TRUE(builder.SpliceGroup(i)) << i;
+  }
+  EXPECT_EQ(builder.Build(), base);
+}
+
+TEST_F(DisplayListTest, SpliceReportsReplacedGroupAsChanged) {
+  auto base = MakeSpliceBase(true);
+
+  DisplayListBuilder builder(true);
+  builder.BeginSplice(base);
+  EXPECT_TRUE(builder.SpliceGroup(0));
+  builder.DrawRect(DlRect::MakeLTRB(30, 50, 40, 60),
+                   DlPaint(DlColor::kGreen()));
+  EXPECT_TRUE(builder.SpliceGroup(2));
+  auto dl = builder.Build();
+
+  DisplayListBuilder expected_builder(true);
+  expected_builder.DrawRect(DlRect::MakeLTRB(10, 10, 20, 20),
+                            DlPaint(DlColor::kRed()));
+  expected_builder.DrawRect(DlRect::MakeLTRB(30, 50, 40, 60),
+                            DlPaint(DlColor::kGreen()));
+  expected_builder.DrawRect(DlRect::MakeLTRB(50, 10, 60, 20),
+                            DlPaint(DlColor::kBlue()));
+  EXPECT_TRUE(DisplayListsEQ_Verbose(dl, expected_builder.Build()));
+
+  ASSERT_NE(dl, base);
+  EXPECT_TRUE(dl->IsSplicedFrom(*base));
+  EXPECT_FALSE(base->IsSplicedFrom(*dl));
+  EXPECT_EQ(dl->spliced_from_id(), base->unique_id());
+  std::vector<SkRect> expected_changes = {
+      // The newly recorded rect
+      SkRect::MakeLTRB(30, 50, 40, 60),
+      // The group that was not spliced
+      SkRect::MakeLTRB(30, 10, 40, 20),
+  };
+  EXPECT_EQ(dl->GetSpliceChangedRects(), expected_changes);
+}
+
+TEST_F(DisplayListTest, SpliceUnderDifferentTransformIsChanged) {
+  auto base = MakeSpliceBase(true);
+
+  DisplayListBuilder builder(true);
+  builder.BeginSplice(base);
+  EXPECT_TRUE(builder.SpliceGroup(0));
+  EXPECT_TRUE(builder.SpliceGroup(1));
+  builder.Translate(0, 50);
+  EXPECT_FALSE(builder.SpliceGroup(2));
+  auto dl = builder.Build();
+
+  EXPECT_TRUE(dl->IsSplicedFrom(*base));
+  std::vector<SkRect> expected_changes = {
+      SkRect::MakeLTRB(50, 60, 60, 70),
+      SkRect::MakeLTRB(50, 10, 60, 20),
+  };
+  EXPECT_EQ(dl->GetSpliceChangedRects(), expected_changes);
+}
+
+TEST_F(DisplayListTest, SpliceUnderDifferentClipShapeIsChanged) {
+  DisplayListBuilder base_builder(true);
+  base_builder.DrawRect(DlRect::MakeLTRB(50, 50, 60, 60),
+                        DlPaint(DlColor::kRed()));
+  base_builder.ClipRect(DlRect::MakeLTRB(0, 0, 100, 100));
+  base_builder.DrawRect(DlRect::MakeLTRB(40, 40, 60, 60),
+                        DlPaint(DlColor::kGreen()));
+  base_builder.DrawRect(DlRect::MakeLTRB(0, 0, 10, 10),
+                        DlPaint(DlColor::kBlue()));
+  auto base = base_builder.Build();
+
+  // The round rect clip has the same bounds as the rect clip it replaces
+  // but cuts off the corner that the last group draws into.
+  DisplayListBuilder builder(true);
+  builder.BeginSplice(base);
+  ASSERT_EQ(builder.GetSpliceGroupCount(), 3u);
+  EXPECT_TRUE(builder.SpliceGroup(0));
+  builder.ClipRoundRect(DlRoundRect::MakeRectXY(
+      DlRect::MakeLTRB(0, 0, 100, 100), 20, 20));
+  builder.DrawRect(DlRect::MakeLTRB(40, 40, 60, 60),
+                   DlPaint(DlColor::kGreen()));
+  EXPECT_FALSE(builder.SpliceGroup(2));
+  auto dl = builder.Build();
+
+  EXPECT_TRUE(dl->IsSplicedFrom(*base));
+  const std::vector<SkRect>& changes = dl->GetSpliceChangedRects();
+  EXPECT_NE(std::find(changes.begin(), changes.end(),
+                      SkRect::MakeLTRB(0, 0, 10, 10)),
+            changes.end());
+}
+
+TEST_F(DisplayListTest, SpliceOutOfOrderIsChanged) {
+  auto base = MakeSpliceBase(true);
+
+  DisplayListBuilder builder(true);
+  builder.BeginSplice(base);
+  EXPECT_TRUE(builder.SpliceGroup(1));
+  EXPECT_FALSE(builder.SpliceGroup(0));
+  EXPECT_TRUE(builder.SpliceGroup(2));
+  auto dl = builder.Build();
+
+  EXPECT_TRUE(dl->IsSplicedFrom(*base));
+  EXPECT_EQ(dl->GetSpliceChangedRects().size(), 2u);
+}
+
+TEST_F(DisplayListTest, SpliceWithoutRTreeUsesBaseBounds) {
+  auto base = MakeSpliceBase(false);
+
+  DisplayListBuilder builder(false);
+  builder.BeginSplice(base);
+  EXPECT_TRUE(builder.SpliceGroup(0));
+  EXPECT_TRUE(builder.SpliceGroup(1));
+  auto dl = builder.Build();
+
+  EXPECT_TRUE(dl->IsSplicedFrom(*base));
+  std::vector<SkRect> expected_changes = {
+      SkRect::MakeLTRB(10, 10, 60, 20),
+  };
+  EXPECT_EQ(dl->GetSpliceChangedRects(), expected_changes);
+}
+
+TEST_F(DisplayListTest, ComputeDispatchTilesOmitsEmptyTiles) {
+  auto record = [](bool prepare_rtree) {
+    DisplayListBuilder builder(prepare_rtree);
+    builder.DrawRect(DlRect::MakeLTRB(0, 0, 10, 10), DlPaint());
+    builder.DrawRect(DlRect::MakeLTRB(90, 90, 100, 100), DlPaint());
+    return builder.Build();
+  };
+  SkRect area = SkRect::MakeLTRB(0, 0, 200, 200);
+
+  std::vector<SkRect> expected_rtree_tiles = {
+      SkRect::MakeLTRB(0, 0, 50, 50),
+      SkRect::MakeLTRB(50, 50, 100, 100),
+  };
+  EXPECT_EQ(record(true)->ComputeDispatchTiles(area, 4u),
+            expected_rtree_tiles);
+
+  std::vector<SkRect> expected_tiles = {
+      SkRect::MakeLTRB(0, 0, 50, 50),
+      SkRect::MakeLTRB(50, 0, 100, 50),
+      SkRect::MakeLTRB(0, 50, 50, 100),
+      SkRect::MakeLTRB(50, 50, 100, 100),
+  };
+  EXPECT_EQ(record(false)->ComputeDispatchTiles(area, 4u), expected_tiles);
+
+  EXPECT_TRUE(record(true)->ComputeDispatchTiles(area, 0u).empty());
+  EXPECT_TRUE(record(true)
+                  ->ComputeDispatchTiles(SkRect::MakeLTRB(300, 300, 400, 400),
+                                         4u)
+                  .empty());
+}
+
+TEST_F(DisplayListTest, DispatchTiledMatchesCulledDispatch) {
+  DisplayListBuilder builder(/*prepare_rtree=*/true);
+  DlPaint paint;
+  for (int i = 0; i < 200; i++) {
+    paint.setColor(DlColor(0xFF000000 | (i * 0x010305)));
+    if (i % 10 == 0) {
+      builder.Save();
+      builder.Translate(i, 0);
+      builder.ClipRect(DlRect::MakeLTRB(0, 0, 300, 300));
+    }
+    builder.DrawRect(DlRect::MakeXYWH((i * 37) % 400, (i * 53) % 400, 40, 40),
+                     paint);
+    if (i % 10 == 9) {
+      builder.Restore();
+    }
+  }
+  auto display_list = builder.Build();
+  auto tiles = display_list->ComputeDispatchTiles(
+      SkRect::MakeLTRB(0, 0, 1000, 1000), 16u);
+  ASSERT_GT(tiles.size(), 1u);
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4u);
+  for (auto runner : {loop->GetTaskRunner(),
+                      std::shared_ptr<fml::ConcurrentTaskRunner>()}) {
+    std::vector<DisplayListBuilder> tile_builders(tiles.size());
+    std::vector<DlOpReceiver*> receivers;
+    for (auto& tile_builder : tile_builders) {
+      receivers.push_back(&DisplayListBuilderTestingAccessor(tile_builder));
+    }
+    display_list->DispatchTiled(tiles, receivers, runner);
+
+    for (size_t i = 0; i < tiles.size(); i++) {
+      DisplayListBuilder expected;
+      display_list->Dispatch(DisplayListBuilderTestingAccessor(expected),
+                             tiles[i]);
+      EXPECT_TRUE(
+          DisplayListsEQ_Verbose(tile_builders[i].Build(), expected.Build()))
+          << "tile " << i;
+    }
+  }
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -0,0 +1,297 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/display_list/dl_attribute_interner.h"
+
+#include <algorithm>
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/logging.h"
+
+namespace flutter {
+
+namespace {
+
+// The hash functions below only need to be consistent with the |equals_|
+// methods of the attributes. Values that those methods compare through a
+// content aware |Equals| method of a resource class (such as the DlImage
+// of an image color source) are left out of the hash as equal contents
+// may be held in different objects.
+
+void HashMatrix(size_t& seed, const SkMatrix& matrix) {
+  for (int i = 0; i < 9; i++) {
+    fml::HashCombineSeed(seed, matrix.get(i));
+  }
+}
+
+void HashPoint(size_t& seed, const SkPoint& point) {
+  fml::HashCombineSeed(seed, point.fX, point.fY);
+}
+
+void HashGradient(size_t& seed, const DlGradientColorSourceBase* gradient) {
+  HashMatrix(seed, gradient->matrix());
+  fml::HashCombineSeed(seed, gradient->tile_mode(), gradient->stop_count());
+  const DlColor* colors = gradient->colors();
+  const float* stops = gradient->stops();
+  for (int i = 0; i < gradient->stop_count(); i++) {
+    fml::HashCombineSeed(seed, colors[i].argb(), stops[i]);
+  }
+}
+
+}  // namespace
+
+std::shared_ptr<DlAttributeInterner> DlAttributeInterner::Make() {
+  return std::shared_ptr<DlAttributeInterner>(new DlAttributeInterner());
+}
+
+template <class D>
+std::shared_ptr<D> DlAttributeInterner::Table<D>::Intern(const D& attribute,
+                                                        size_t hash,
+                                                        bool* hit) {
+  auto range = entries_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    std::shared_ptr<D> candidate = it->second.lock();
+    if (candidate && *candidate == attribute) {
+      *hit = true;
+      return candidate;
+    }
+  }
+  *hit = false;
+  if (entries_.size() >= purge_threshold_) {
+    Purge();
+    purge_threshold_ = std::max(purge_threshold_, entries_.size() * 2u);
+  }
+  std::shared_ptr<D> canonical = attribute.shared();
+  entries_.emplace(hash, canonical);
+  return canonical;
+}
+
+template <class D>
+void DlAttributeInterner::Table<D>::Purge() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.expired()) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+std::shared_ptr<DlColorSource> DlAttributeInterner::Intern(
+    const DlColorSource* source) {
+  if (!source) {
+    return nullptr;
+  }
+  size_t hash = Hash(*source);
+  bool hit;
+  std::scoped_lock lock(mutex_);
+  std::shared_ptr<DlColorSource> canonical =
+      color_sources_.Intern(*source, hash, &hit);
+  hit_count_ += hit ? 1u : 0u;
+  return canonical;
+}
+
+std::shared_ptr<DlColorFilter> DlAttributeInterner::Intern(
+    const DlColorFilter* filter) {
+  if (!filter) {
+    return nullptr;
+  }
+  size_t hash = Hash(*filter);
+  bool hit;
+  std::scoped_lock lock(mutex_);
+  std::shared_ptr<DlColorFilter> canonical =
+      color_filters_.Intern(*filter, hash, &hit);
+  hit_count_ += hit ? 1u : 0u;
+  return canonical;
+}
+
+std::shared_ptr<DlImageFilter> DlAttributeInterner::Intern(
+    const DlImageFilter* filter) {
+  if (!filter) {
+    return nullptr;
+  }
+  size_t hash = Hash(*filter);
+  bool hit;
+  std::scoped_lock lock(mutex_);
+  std::shared_ptr<DlImageFilter> canonical =
+      image_filters_.Intern(*filter, hash, &hit);
+  hit_count_ += hit ? 1u : 0u;
+  return canonical;
+}
+
+std::shared_ptr<DlMaskFilter> DlAttributeInterner::Intern(
+    const DlMaskFilter* filter) {
+  if (!filter) {
+    return nullptr;
+  }
+  size_t hash = Hash(*filter);
+  bool hit;
+  std::scoped_lock lock(mutex_);
+  std::shared_ptr<DlMaskFilter> canonical =
+      mask_filters_.Intern(*filter, hash, &hit);
+  hit_count_ += hit ? 1u : 0u;
+  return canonical;
+}
+
+size_t DlAttributeInterner::size() const {
+  std::scoped_lock lock(mutex_);
+  return color_sources_.size() + color_filters_.size() +
+         image_filters_.size() + mask_filters_.size();
+}
+
+size_t DlAttributeInterner::hit_count() const {
+  std::scoped_lock lock(mutex_);
+  return hit_count_;
+}
+
+size_t DlAttributeInterner::Hash(const DlColorSource& source) {
+  size_t seed = fml::HashCombine(source.type());
+  switch (source.type()) {
+    case DlColorSourceType::kColor:
+      fml::HashCombineSeed(seed, source.asColor()->color().argb());
+      break;
+    case DlColorSourceType::kImage: {
+      const DlImageColorSource* image = source.asImage();
+      HashMatrix(seed, image->matrix());
+      fml::HashCombineSeed(seed, image->horizontal_tile_mode(),
+                           image->vertical_tile_mode(), image->sampling());
+      break;
+    }
+    case DlColorSourceType::kLinearGradient: {
+      const DlLinearGradientColorSource* linear = source.asLinearGradient();
+      HashPoint(seed, linear->start_point());
+      HashPoint(seed, linear->end_point());
+      HashGradient(seed, linear);
+      break;
+    }
+    case DlColorSourceType::kRadialGradient: {
+      const DlRadialGradientColorSource* radial = source.asRadialGradient();
+      HashPoint(seed, radial->center());
+      fml::HashCombineSeed(seed, radial->radius());
+      HashGradient(seed, radial);
+      break;
+    }
+    case DlColorSourceType::kConicalGradient: {
+      const DlConicalGradientColorSource* conical =
+          source.asConicalGradient();
+      HashPoint(seed, conical->start_center());
+      HashPoint(seed, conical->end_center());
+      fml::HashCombineSeed(seed, conical->start_radius(),
+                           conical->end_radius());
+      HashGradient(seed, conical);
+      break;
+    }
+    case DlColorSourceType::kSweepGradient: {
+      const DlSweepGradientColorSource* sweep = source.asSweepGradient();
+      HashPoint(seed, sweep->center());
+      fml::HashCombineSeed(seed, sweep->start(), sweep->end());
+      HashGradient(seed, sweep);
+      break;
+    }
+    case DlColorSourceType::kRuntimeEffect: {
+      // Runtime effects compare their effect, uniforms and samplers by
+      // identity.
+      const DlRuntimeEffectColorSource* effect = source.asRuntimeEffect();
+      fml::HashCombineSeed(seed, effect->runtime_effect().get(),
+                           effect->uniform_data().get());
+      for (const std::shared_ptr<DlColorSource>& sampler :
+           effect->samplers()) {
+        fml::HashCombineSeed(seed, sampler.get());
+      }
+      break;
+    }
+  }
+  return seed;
+}
+
+size_t DlAttributeInterner::Hash(const DlColorFilter& filter) {
+  size_t seed = fml::HashCombine(filter.type());
+  switch (filter.type()) {
+    case DlColorFilterType::kBlend: {
+      const DlBlendColorFilter* blend = filter.asBlend();
+      fml::HashCombineSeed(seed, blend->color().argb(), blend->mode());
+      break;
+    }
+    case DlColorFilterType::kMatrix: {
+      const DlMatrixColorFilter* matrix = filter.asMatrix();
+      for (int i = 0; i < 20; i++) {
+        fml::HashCombineSeed(seed, (*matrix)[i]);
+      }
+      break;
+    }
+    case DlColorFilterType::kSrgbToLinearGamma:
+    case DlColorFilterType::kLinearToSrgbGamma:
+      break;
+  }
+  return seed;
+}
+
+size_t DlAttributeInterner::Hash(const DlImageFilter& filter) {
+  size_t seed = fml::HashCombine(filter.type());
+  switch (filter.type()) {
+    case DlImageFilterType::kBlur: {
+      const DlBlurImageFilter* blur = filter.asBlur();
+      fml::HashCombineSeed(seed, blur->sigma_x(), blur->sigma_y(),
+                           blur->tile_mode());
+      break;
+    }
+    case DlImageFilterType::kDilate: {
+      const DlDilateImageFilter* dilate = filter.asDilate();
+      fml::HashCombineSeed(seed, dilate->radius_x(), dilate->radius_y());
+      break;
+    }
+    case DlImageFilterType::kErode: {
+      const DlErodeImageFilter* erode = filter.asErode();
+      fml::HashCombineSeed(seed, erode->radius_x(), erode->radius_y());
+      break;
+    }
+    case DlImageFilterType::kMatrix: {
+      const DlMatrixImageFilter* matrix = filter.asMatrix();
+      HashMatrix(seed, matrix->matrix());
+      fml::HashCombineSeed(seed, matrix->sampling());
+      break;
+    }
+    case DlImageFilterType::kCompose: {
+      const DlComposeImageFilter* compose = filter.asCompose();
+      if (compose->outer()) {
+        fml::HashCombineSeed(seed, Hash(*compose->outer()));
+      }
+      if (compose->inner()) {
+        fml::HashCombineSeed(seed, Hash(*compose->inner()));
+      }
+      break;
+    }
+    case DlImageFilterType::kColorFilter: {
+      const DlColorFilterImageFilter* color_filter = filter.asColorFilter();
+      if (color_filter->color_filter()) {
+        fml::HashCombineSeed(seed, Hash(*color_filter->color_filter()));
+      }
+      break;
+    }
+    case DlImageFilterType::kLocalMatrix: {
+      const DlLocalMatrixImageFilter* local = filter.asLocalMatrix();
+      HashMatrix(seed, local->matrix());
+      if (local->image_filter()) {
+        fml::HashCombineSeed(seed, Hash(*local->image_filter()));
+      }
+      break;
+    }
+  }
+  return seed;
+}
+
+size_t DlAttributeInterner::Hash(const DlMaskFilter& filter) {
+  size_t seed = fml::HashCombine(filter.type());
+  switch (filter.type()) {
+    case DlMaskFilterType::kBlur: {
+      const DlBlurMaskFilter* blur = filter.asBlur();
+      fml::HashCombineSeed(seed, blur->style(), blur->sigma(),
+                           blur->respectCTM());
+      break;
+    }
+  }
+  return seed;
+}
+
+}  // namespace flutter
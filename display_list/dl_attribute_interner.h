@@ -0,0 +1,103 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_DISPLAY_LIST_DL_ATTRIBUTE_INTERNER_H_
+#define FLUTTER_DISPLAY_LIST_DL_ATTRIBUTE_INTERNER_H_
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "flutter/display_list/effects/dl_color_filter.h"
+#include "flutter/display_list/effects/dl_color_source.h"
+#include "flutter/display_list/effects/dl_image_filter.h"
+#include "flutter/display_list/effects/dl_mask_filter.h"
+#include "flutter/fml/macros.h"
+
+namespace flutter {
+
+// A table of canonical instances of the DisplayList attribute classes
+// (|DlColorSource|, |DlColorFilter|, |DlImageFilter| and |DlMaskFilter|)
+// keyed by a hash of their contents.
+//
+// Interning an attribute returns the one shared instance that is equal
+// to it, creating that instance on first use. A DisplayListBuilder that
+// is given an interner records references to those canonical instances
+// instead of copying each attribute into its op storage, so that:
+//
+// - Attributes recorded by any builder sharing the interner can be
+//   compared by pointer, which is the first check made by |Equals| when
+//   comparing DisplayLists and paints.
+// - Consumers that cache resources derived from an attribute, such as
+//   the filter and pipeline caches of a renderer, see the same pointer
+//   every time an equivalent attribute is used, in this frame or any
+//   later one, and can key their caches on it.
+//
+// The table only holds weak references to the canonical instances, an
+// instance is released as soon as the last DisplayList or paint that
+// refers to it goes away and the table entry is reclaimed on a later
+// insertion.
+//
+// The interner may be used from multiple threads.
+class DlAttributeInterner {
+ public:
+  static std::shared_ptr<DlAttributeInterner> Make();
+
+  // Each of these methods returns the canonical instance equal to the
+  // indicated attribute, or nullptr if it is null. The canonical instance
+  // is never the attribute object that was passed in so the argument may
+  // live in temporary storage, such as the op storage of a DisplayList.
+  std::shared_ptr<DlColorSource> Intern(const DlColorSource* source);
+  std::shared_ptr<DlColorFilter> Intern(const DlColorFilter* filter);
+  std::shared_ptr<DlImageFilter> Intern(const DlImageFilter* filter);
+  std::shared_ptr<DlMaskFilter> Intern(const DlMaskFilter* filter);
+
+  // The number of canonical instances currently held by the table,
+  // including any that have been released but not yet reclaimed.
+  size_t size() const;
+
+  // The number of calls to |Intern| that found an existing canonical
+  // instance rather than creating a new one.
+  size_t hit_count() const;
+
+  // Hashes of the contents of the attributes. Any two attributes that
+  // compare equal produce the same hash.
+  static size_t Hash(const DlColorSource& source);
+  static size_t Hash(const DlColorFilter& filter);
+  static size_t Hash(const DlImageFilter& filter);
+  static size_t Hash(const DlMaskFilter& filter);
+
+ private:
+  template <class D>
+  class Table {
+   public:
+    std::shared_ptr<D> Intern(const D& attribute, size_t hash, bool* hit);
+    size_t size() const { return entries_.size(); }
+
+   private:
+    // Removes all of the entries whose instances have been released.
+    void Purge();
+
+    std::unordered_multimap<size_t, std::weak_ptr<D>> entries_;
+    // The table is purged whenever it grows past this size, which is
+    // then reset to twice the number of live entries so that purging
+    // is amortized over the insertions.
+    size_t purge_threshold_ = 64u;
+  };
+
+  DlAttributeInterner() = default;
+
+  mutable std::mutex mutex_;
+  Table<DlColorSource> color_sources_;
+  Table<DlColorFilter> color_filters_;
+  Table<DlImageFilter> image_filters_;
+  Table<DlMaskFilter> mask_filters_;
+  size_t hit_count_ = 0u;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DlAttributeInterner);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_DISPLAY_LIST_DL_ATTRIBUTE_INTERNER_H_
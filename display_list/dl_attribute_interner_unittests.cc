@@ -0,0 +1,221 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/display_list/dl_attribute_interner.h"
+
+#include "flutter/display_list/dl_builder.h"
+#include "flutter/display_list/utils/dl_receiver_utils.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+
+DlOpReceiver& DisplayListBuilderTestingAccessor(DisplayListBuilder& builder);
+
+namespace testing {
+
+namespace {
+
+class AttributeCapturingReceiver : public IgnoreAttributeDispatchHelper,
+                                   public IgnoreTransformDispatchHelper,
+                                   public IgnoreClipDispatchHelper,
+                                   public IgnoreDrawDispatchHelper {
+ public:
+  void setColorSource(const DlColorSource* source) override {
+    color_sources.push_back(source);
+  }
+  void setImageFilter(const DlImageFilter* filter) override {
+    image_filters.push_back(filter);
+  }
+  void setColorFilter(const DlColorFilter* filter) override {
+    color_filters.push_back(filter);
+  }
+  void setMaskFilter(const DlMaskFilter* filter) override {
+    mask_filters.push_back(filter);
+  }
+
+  std::vector<const DlColorSource*> color_sources;
+  std::vector<const DlImageFilter*> image_filters;
+  std::vector<const DlColorFilter*> color_filters;
+  std::vector<const DlMaskFilter*> mask_filters;
+};
+
+const DlColor kGradientColors[] = {DlColor::kRed(), DlColor::kBlue()};
+const float kGradientStops[] = {0.0f, 1.0f};
+
+DlPaint MakeAttributePaint(float sigma) {
+  DlPaint paint;
+  paint.setColorSource(DlColorSource::MakeLinear(
+      SkPoint::Make(0, 0), SkPoint::Make(10, 10), 2, kGradientColors,
+      kGradientStops, DlTileMode::kClamp));
+  paint.setColorFilter(
+      DlBlendColorFilter::Make(DlColor::kGreen(), DlBlendMode::kModulate));
+  paint.setImageFilter(
+      DlBlurImageFilter::Make(sigma, sigma, DlTileMode::kDecal));
+  paint.setMaskFilter(DlBlurMaskFilter::Make(DlBlurStyle::kNormal, sigma));
+  return paint;
+}
+
+sk_sp<DisplayList> RecordWithInterner(
+    const std::shared_ptr<DlAttributeInterner>& interner,
+    float sigma) {
+  DisplayListBuilder builder;
+  builder.SetAttributeInterner(interner);
+  builder.DrawRect(SkRect::MakeLTRB(0, 0, 10, 10), MakeAttributePaint(sigma));
+  return builder.Build();
+}
+
+}  // namespace
+
+TEST(DlAttributeInterner, NullAttributesAreNotInterned) {
+  auto interner = DlAttributeInterner::Make();
+  EXPECT_EQ(interner->Intern(static_cast<const DlColorSource*>(nullptr)),
+            nullptr);
+  EXPECT_EQ(interner->Intern(static_cast<const DlColorFilter*>(nullptr)),
+            nullptr);
+  EXPECT_EQ(interner->Intern(static_cast<const DlImageFilter*>(nullptr)),
+            nullptr);
+  EXPECT_EQ(interner->Intern(static_cast<const DlMaskFilter*>(nullptr)),
+            nullptr);
+  EXPECT_EQ(interner->size(), 0u);
+}
+
+TEST(DlAttributeInterner, EqualAttributesShareOneInstance) {
+  auto interner = DlAttributeInterner::Make();
+  DlBlurImageFilter blur1(5.0f, 5.0f, DlTileMode::kClamp);
+  DlBlurImageFilter blur2(5.0f, 5.0f, DlTileMode::kClamp);
+  DlBlurImageFilter blur3(5.0f, 6.0f, DlTileMode::kClamp);
+
+  std::shared_ptr<DlImageFilter> canonical1 = interner->Intern(&blur1);
+  std::shared_ptr<DlImageFilter> canonical2 = interner->Intern(&blur2);
+  std::shared_ptr<DlImageFilter> canonical3 = interner->Intern(&blur3);
+
+  ASSERT_NE(canonical1, nullptr);
+  EXPECT_NE(canonical1.get(), &blur1);
+  EXPECT_TRUE(*canonical1 == blur1);
+  EXPECT_EQ(canonical1, canonical2);
+  EXPECT_NE(canonical1, canonical3);
+  EXPECT_TRUE(*canonical3 == blur3);
+  EXPECT_EQ(interner->Intern(canonical1.get()), canonical1);
+  EXPECT_EQ(interner->size(), 2u);
+  EXPECT_EQ(interner->hit_count(), 2u);
+}
+
+TEST(DlAttributeInterner, NestedFiltersAreComparedByContents) {
+  auto interner = DlAttributeInterner::Make();
+  auto color_filter =
+      DlBlendColorFilter::Make(DlColor::kRed(), DlBlendMode::kSrcOver);
+  auto blur = DlBlurImageFilter::Make(2.0f, 2.0f, DlTileMode::kDecal);
+  auto equal_color_filter =
+      DlBlendColorFilter::Make(DlColor::kRed(), DlBlendMode::kSrcOver);
+  auto equal_blur = DlBlurImageFilter::Make(2.0f, 2.0f, DlTileMode::kDecal);
+  DlComposeImageFilter compose1(
+      blur, DlColorFilterImageFilter::Make(color_filter));
+  DlComposeImageFilter compose2(
+      equal_blur, DlColorFilterImageFilter::Make(equal_color_filter));
+  DlComposeImageFilter compose3(DlColorFilterImageFilter::Make(color_filter),
+                                blur);
+
+  EXPECT_EQ(DlAttributeInterner::Hash(compose1),
+            DlAttributeInterner::Hash(compose2));
+  EXPECT_EQ(interner->Intern(&compose1), interner->Intern(&compose2));
+  EXPECT_NE(interner->Intern(&compose1), interner->Intern(&compose3));
+}
+
+TEST(DlAttributeInterner, EqualAttributesHashEqually) {
+  float values1[20] = {1, 0, 0, 0, 0,  //
+                       0, 1, 0, 0, 0,  //
+                       0, 0, 1, 0, 0,  //
+                       0, 0, 0, 1, 0};
+  float values2[20];
+  memcpy(values2, values1, sizeof(values1));
+  DlMatrixColorFilter matrix1(values1);
+  DlMatrixColorFilter matrix2(values2);
+  EXPECT_EQ(DlAttributeInterner::Hash(matrix1),
+            DlAttributeInterner::Hash(matrix2));
+
+  auto linear1 = DlColorSource::MakeLinear(
+      SkPoint::Make(0, 0), SkPoint::Make(10, 10), 2, kGradientColors,
+      kGradientStops, DlTileMode::kClamp);
+  auto linear2 = DlColorSource::MakeLinear(
+      SkPoint::Make(0, 0), SkPoint::Make(10, 10), 2, kGradientColors,
+      kGradientStops, DlTileMode::kClamp);
+  EXPECT_EQ(DlAttributeInterner::Hash(*linear1),
+            DlAttributeInterner::Hash(*linear2));
+
+  // Positive and negative zero compare equal so they must hash equally.
+  DlMatrixImageFilter matrix_filter1(SkMatrix::Translate(0.0f, 5.0f),
+                                     DlImageSampling::kLinear);
+  DlMatrixImageFilter matrix_filter2(SkMatrix::Translate(-0.0f, 5.0f),
+                                     DlImageSampling::kLinear);
+  ASSERT_TRUE(matrix_filter1 == matrix_filter2);
+  EXPECT_EQ(DlAttributeInterner::Hash(matrix_filter1),
+            DlAttributeInterner::Hash(matrix_filter2));
+}
+
+TEST(DlAttributeInterner, ReleasedInstancesAreReclaimed) {
+  auto interner = DlAttributeInterner::Make();
+  for (int i = 1; i <= 1000; i++) {
+    DlBlurMaskFilter filter(DlBlurStyle::kNormal, static_cast<float>(i));
+    EXPECT_NE(interner->Intern(&filter), nullptr);
+  }
+  EXPECT_LT(interner->size(), 100u);
+
+  DlBlurMaskFilter filter(DlBlurStyle::kNormal, 1.0f);
+  std::shared_ptr<DlMaskFilter> canonical = interner->Intern(&filter);
+  for (int i = 2; i <= 1000; i++) {
+    DlBlurMaskFilter other(DlBlurStyle::kNormal, static_cast<float>(i));
+    EXPECT_NE(interner->Intern(&other), nullptr);
+  }
+  EXPECT_EQ(interner->Intern(&filter), canonical);
+}
+
+TEST(DlAttributeInterner, BuildersRecordCanonicalAttributes) {
+  auto interner = DlAttributeInterner::Make();
+  sk_sp<DisplayList> display_list1 = RecordWithInterner(interner, 2.0f);
+  sk_sp<DisplayList> display_list2 = RecordWithInterner(interner, 2.0f);
+  sk_sp<DisplayList> display_list3 = RecordWithInterner(interner, 3.0f);
+
+  AttributeCapturingReceiver receiver1;
+  display_list1->Dispatch(receiver1);
+  AttributeCapturingReceiver receiver2;
+  display_list2->Dispatch(receiver2);
+  AttributeCapturingReceiver receiver3;
+  display_list3->Dispatch(receiver3);
+
+  ASSERT_EQ(receiver1.color_sources.size(), 1u);
+  ASSERT_EQ(receiver1.image_filters.size(), 1u);
+  ASSERT_EQ(receiver1.color_filters.size(), 1u);
+  ASSERT_EQ(receiver1.mask_filters.size(), 1u);
+  EXPECT_EQ(receiver1.color_sources, receiver2.color_sources);
+  EXPECT_EQ(receiver1.image_filters, receiver2.image_filters);
+  EXPECT_EQ(receiver1.color_filters, receiver2.color_filters);
+  EXPECT_EQ(receiver1.mask_filters, receiver2.mask_filters);
+  EXPECT_EQ(receiver1.color_sources, receiver3.color_sources);
+  EXPECT_EQ(receiver1.color_filters, receiver3.color_filters);
+  EXPECT_NE(receiver1.image_filters, receiver3.image_filters);
+  EXPECT_NE(receiver1.mask_filters, receiver3.mask_filters);
+
+  EXPECT_TRUE(display_list1->Equals(display_list2));
+  EXPECT_FALSE(display_list1->Equals(display_list3));
+}
+
+TEST(DlAttributeInterner, InternedListsReplayIntoEqualLists) {
+  auto interner = DlAttributeInterner::Make();
+  sk_sp<DisplayList> interned = RecordWithInterner(interner, 2.0f);
+  sk_sp<DisplayList> not_interned = RecordWithInterner(nullptr, 2.0f);
+
+  // The two lists hold different op records for the attributes but they
+  // render identically.
+  DisplayListBuilder builder;
+  interned->Dispatch(DisplayListBuilderTestingAccessor(builder));
+  sk_sp<DisplayList> replayed = builder.Build();
+
+  EXPECT_TRUE(replayed->Equals(not_interned));
+  EXPECT_EQ(interned->bounds(), not_interned->bounds());
+  EXPECT_EQ(interned->total_depth(), not_interned->total_depth());
+  EXPECT_EQ(interned->op_count(), not_interned->op_count());
+}
+
+}  // namespace testing
+}  // namespace flutter
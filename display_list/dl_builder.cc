@@ -4,12 +4,15 @@
 
 #include "flutter/display_list/dl_builder.h"
 
+#include <algorithm>
+
 #include "flutter/display_list/display_list.h"
 #include "flutter/display_list/dl_blend_mode.h"
 #include "flutter/display_list/dl_op_flags.h"
 #include "flutter/display_list/dl_op_records.h"
 #include "flutter/display_list/effects/dl_color_source.h"
 #include "flutter/display_list/utils/dl_accumulation_rect.h"
+#include "flutter/display_list/utils/dl_receiver_utils.h"
 #include "fml/logging.h"
 #include "third_party/skia/include/core/SkScalar.h"
 
@@ -43,17 +46,23 @@ template <typename T, typename... Args>
 void* DisplayListBuilder::Push(size_t pod, Args&&... args) {
   size_t size = SkAlignPtr(sizeof(T) + pod);
   FML_CHECK(size < (1 << 24));
-  if (used_ + size > allocated_) {
-    static_assert(is_power_of_two(DL_BUILDER_PAGE),
-                  "This math needs updating for non-pow2.");
-    // Next greater multiple of DL_BUILDER_PAGE.
-    allocated_ = (used_ + size + DL_BUILDER_PAGE) & ~(DL_BUILDER_PAGE - 1);
-    storage_.realloc(allocated_);
-    FML_CHECK(storage_.get());
-    memset(storage_.get() + used_, 0, allocated_ - used_);
-  }
-  FML_CHECK(used_ + size <= allocated_);
-  auto op = reinterpret_cast<T*>(storage_.get() + used_);
+  uint8_t* ptr;
+  if (arena_) {
+    ptr = AllocateFromArena(size);
+  } else {
+    if (used_ + size > allocated_) {
+      static_assert(is_power_of_two(DL_BUILDER_PAGE),
+                    "This math needs updating for non-pow2.");
+      // Next greater multiple of DL_BUILDER_PAGE.
+      allocated_ = (used_ + size + DL_BUILDER_PAGE) & ~(DL_BUILDER_PAGE - 1);
+      storage_.realloc(allocated_);
+      FML_CHECK(storage_.get());
+      memset(storage_.get() + used_, 0, allocated_ - used_);
+    }
+    FML_CHECK(used_ + size <= allocated_);
+    ptr = storage_.get() + used_;
+  }
+  auto op = reinterpret_cast<T*>(ptr);
   used_ += size;
   new (op) T{std::forward<Args>(args)...};
   op->type = T::kType;
@@ -64,6 +73,432 @@ void* DisplayListBuilder::Push(size_t pod, Args&&... args) {
   return op + 1;
 }
 
+uint8_t* DisplayListBuilder::AllocateFromArena(size_t size) {
+  FML_DCHECK(arena_);
+  if (arena_chunks_.empty() ||
+      arena_chunks_.back().used + size > arena_chunks_.back().capacity) {
+    // The first chunk is sized to hold everything that was recorded
+    // into the previous DisplayList so that a builder recording similar
+    // content every frame only ever needs a single chunk.
+    size_t wanted = arena_chunks_.empty()
+                        ? arena_->RecommendedCapacity(last_build_bytes_)
+                        : arena_->chunk_size();
+    DisplayListArena::Block block = arena_->Acquire(std::max(wanted, size));
+    arena_chunks_.push_back({block.ptr, block.capacity, 0u, used_});
+  }
+  ArenaChunk& chunk = arena_chunks_.back();
+  uint8_t* ptr = chunk.ptr + chunk.used;
+  chunk.used += size;
+  // Recycled chunks contain stale data, but the padding bytes of each op
+  // must be zeroed so that the bulk memcmp in DisplayList::Equals works.
+  memset(ptr, 0, size);
+  return ptr;
+}
+
+uint8_t* DisplayListBuilder::StorageAt(size_t offset) {
+  if (!arena_) {
+    return storage_.get() + offset;
+  }
+  // Find the last chunk that starts at or before the offset.
+  auto it = std::upper_bound(
+      arena_chunks_.begin(), arena_chunks_.end(), offset,
+      [](size_t value, const ArenaChunk& chunk) {
+        return value < chunk.start;
+      });
+  FML_DCHECK(it != arena_chunks_.begin());
+  --it;
+  FML_DCHECK(offset - it->start < it->used);
+  return it->ptr + (offset - it->start);
+}
+
+DisplayListStorage DisplayListBuilder::TakeStorage(size_t bytes) {
+  if (!arena_) {
+    storage_.realloc(bytes);
+    return std::move(storage_);
+  }
+  last_build_bytes_ = bytes;
+  DisplayListStorage storage;
+  if (arena_chunks_.size() == 1u) {
+    // The common steady state case, the chunk becomes the storage for
+    // the DisplayList without any copying.
+    const ArenaChunk& chunk = arena_chunks_.front();
+    storage =
+        DisplayListArena::MakeStorage(arena_, {chunk.ptr, chunk.capacity});
+    arena_chunks_.clear();
+  } else if (!arena_chunks_.empty()) {
+    // The recording outgrew its first chunk, the chunks are consolidated
+    // into a single buffer once here rather than every time the buffer
+    // would have been grown by realloc.
+    DisplayListArena::Block block = arena_->Acquire(bytes);
+    uint8_t* dst = block.ptr;
+    for (const ArenaChunk& chunk : arena_chunks_) {
+      memcpy(dst, chunk.ptr, chunk.used);
+      dst += chunk.used;
+    }
+    FML_DCHECK(static_cast<size_t>(dst - block.ptr) == bytes);
+    // The ops now live in the consolidated buffer so the chunks are
+    // returned to the arena without disposing of them.
+    for (const ArenaChunk& chunk : arena_chunks_) {
+      arena_->Release(chunk.ptr, chunk.capacity);
+    }
+    arena_chunks_.clear();
+    storage = DisplayListArena::MakeStorage(arena_, block);
+  }
+  return storage;
+}
+
+void DisplayListBuilder::ReleaseArenaChunks() {
+  for (const ArenaChunk& chunk : arena_chunks_) {
+    DisplayList::DisposeOps(chunk.ptr, chunk.ptr + chunk.used);
+    arena_->Release(chunk.ptr, chunk.capacity);
+  }
+  arena_chunks_.clear();
+}
+
+namespace {
+
+// A clip applied at the root level of a DisplayList along with the
+// transform it was applied under. The device cull coverage of the root
+// level only bounds the clips, so the clips themselves are compared to
+// tell whether a group renders under the same clip.
+struct SpliceRootClip {
+  enum class Shape { kRect, kOval, kRoundRect, kPath };
+
+  static SpliceRootClip Rect(Shape shape,
+                             const DlRect& rect,
+                             DlCanvas::ClipOp clip_op,
+                             bool is_aa,
+                             const DlMatrix& matrix) {
+    return {shape, clip_op, is_aa, matrix, DlRoundRect::MakeRect(rect), {}};
+  }
+  static SpliceRootClip RoundRect(const DlRoundRect& rrect,
+                                  DlCanvas::ClipOp clip_op,
+                                  bool is_aa,
+                                  const DlMatrix& matrix) {
+    return {Shape::kRoundRect, clip_op, is_aa, matrix, rrect, {}};
+  }
+  static SpliceRootClip Path(const DlPath& path,
+                             DlCanvas::ClipOp clip_op,
+                             bool is_aa,
+                             const DlMatrix& matrix) {
+    return {Shape::kPath, clip_op, is_aa, matrix, {}, path};
+  }
+
+  bool operator==(const SpliceRootClip& other) const {
+    return shape == other.shape && clip_op == other.clip_op &&
+           is_aa == other.is_aa && matrix == other.matrix &&
+           rrect == other.rrect && path == other.path;
+  }
+
+  Shape shape;
+  DlCanvas::ClipOp clip_op;
+  bool is_aa;
+  DlMatrix matrix;
+  // The rect of a rect clip and the bounds of an oval clip are kept as a
+  // round rect without radii.
+  DlRoundRect rrect;
+  DlPath path;
+};
+
+// Tracks the rendering attributes and the root level transform and clip
+// of a DisplayList as its records are dispatched in order, so that the
+// state in effect at the start of any of its top level groups can be
+// compared to the state of a builder into which that group is spliced.
+class SpliceStateTracker : public IgnoreDrawDispatchHelper {
+ public:
+  explicit SpliceStateTracker(const DlRect& cull_rect) : state_(cull_rect) {}
+
+  const DlPaint& paint() const { return paint_; }
+  const DisplayListMatrixClipState& state() const { return state_; }
+  const std::vector<SpliceRootClip>& root_clips() const { return root_clips_; }
+
+  void setAntiAlias(bool aa) override { paint_.setAntiAlias(aa); }
+  void setInvertColors(bool invert) override {
+    paint_.setInvertColors(invert);
+  }
+  void setStrokeCap(DlStrokeCap cap) override { paint_.setStrokeCap(cap); }
+  void setStrokeJoin(DlStrokeJoin join) override {
+    paint_.setStrokeJoin(join);
+  }
+  void setDrawStyle(DlDrawStyle style) override {
+    paint_.setDrawStyle(style);
+  }
+  void setStrokeWidth(float width) override { paint_.setStrokeWidth(width); }
+  void setStrokeMiter(float limit) override { paint_.setStrokeMiter(limit); }
+  void setColor(DlColor color) override { paint_.setColor(color); }
+  void setBlendMode(DlBlendMode mode) override { paint_.setBlendMode(mode); }
+  void setColorSource(const DlColorSource* source) override {
+    paint_.setColorSource(source);
+  }
+  void setImageFilter(const DlImageFilter* filter) override {
+    paint_.setImageFilter(filter);
+  }
+  void setColorFilter(const DlColorFilter* filter) override {
+    paint_.setColorFilter(filter);
+  }
+  void setMaskFilter(const DlMaskFilter* filter) override {
+    paint_.setMaskFilter(filter);
+  }
+
+  // Transforms and clips inside of a save are undone by its restore, but
+  // attributes are not, so only the save depth needs to be tracked here.
+  void save() override { save_depth_++; }
+  void saveLayer(const DlRect& bounds,
+                 const SaveLayerOptions options,
+                 const DlImageFilter* backdrop,
+                 std::optional<int64_t> backdrop_id) override {
+    save_depth_++;
+  }
+  void restore() override { save_depth_--; }
+
+  void translate(DlScalar tx, DlScalar ty) override {
+    if (save_depth_ == 0) {
+      state_.translate(tx, ty);
+    }
+  }
+  void scale(DlScalar sx, DlScalar sy) override {
+    if (save_depth_ == 0) {
+      state_.scale(sx, sy);
+    }
+  }
+  void rotate(DlScalar degrees) override {
+    if (save_depth_ == 0) {
+      state_.rotate(degrees);
+    }
+  }
+  void skew(DlScalar sx, DlScalar sy) override {
+    if (save_depth_ == 0) {
+      state_.skew(sx, sy);
+    }
+  }
+  // clang-format off
+  void transform2DAffine(DlScalar mxx, DlScalar mxy, DlScalar mxt,
+                         DlScalar myx, DlScalar myy, DlScalar myt) override {
+    if (save_depth_ == 0) {
+      state_.transform2DAffine(mxx, mxy, mxt, myx, myy, myt);
+    }
+  }
+  void transformFullPerspective(
+      DlScalar mxx, DlScalar mxy, DlScalar mxz, DlScalar mxt,
+      DlScalar myx, DlScalar myy, DlScalar myz, DlScalar myt,
+      DlScalar mzx, DlScalar mzy, DlScalar mzz, DlScalar mzt,
+      DlScalar mwx, DlScalar mwy, DlScalar mwz, DlScalar mwt) override {
+    if (save_depth_ == 0) {
+      state_.transformFullPerspective(mxx, mxy, mxz, mxt,
+                                      myx, myy, myz, myt,
+                                      mzx, mzy, mzz, mzt,
+                                      mwx, mwy, mwz, mwt);
+    }
+  }
+  // clang-format on
+  void transformReset() override {
+    if (save_depth_ == 0) {
+      state_.setIdentity();
+    }
+  }
+
+  void clipRect(const DlRect& rect,
+                DlCanvas::ClipOp clip_op,
+                bool is_aa) override {
+    if (save_depth_ == 0) {
+      root_clips_.push_back(SpliceRootClip::Rect(
+          SpliceRootClip::Shape::kRect, rect, clip_op, is_aa, state_.matrix()));
+      state_.clipRect(rect, clip_op, is_aa);
+    }
+  }
+  void clipOval(const DlRect& bounds,
+                DlCanvas::ClipOp clip_op,
+                bool is_aa) override {
+    if (save_depth_ == 0) {
+      root_clips_.push_back(
+          SpliceRootClip::Rect(SpliceRootClip::Shape::kOval, bounds, clip_op,
+                               is_aa, state_.matrix()));
+      state_.clipOval(bounds, clip_op, is_aa);
+    }
+  }
+  void clipRoundRect(const DlRoundRect& rrect,
+                     DlCanvas::ClipOp clip_op,
+                     bool is_aa) override {
+    if (save_depth_ == 0) {
+      root_clips_.push_back(
+          SpliceRootClip::RoundRect(rrect, clip_op, is_aa, state_.matrix()));
+      state_.clipRRect(rrect, clip_op, is_aa);
+    }
+  }
+  void clipPath(const DlPath& path,
+                DlCanvas::ClipOp clip_op,
+                bool is_aa) override {
+    if (save_depth_ == 0) {
+      root_clips_.push_back(
+          SpliceRootClip::Path(path, clip_op, is_aa, state_.matrix()));
+      state_.clipPath(path, clip_op, is_aa);
+    }
+  }
+
+ private:
+  DlPaint paint_;
+  DisplayListMatrixClipState state_;
+  std::vector<SpliceRootClip> root_clips_;
+  int save_depth_ = 0;
+};
+
+}  // namespace
+
+struct DisplayListBuilder::SpliceInfo {
+  SpliceInfo(const sk_sp<DisplayList>& base_list, const DlRect& base_cull)
+      : base(base_list),
+        groups(base_list->GetTopLevelGroups()),
+        group_bounds(groups.size()),
+        group_reused(groups.size(), false),
+        cull_rect(base_cull),
+        tracker(base_cull) {
+    if (base->has_rtree()) {
+      // The rtree rects are tagged with the index of the op that produced
+      // them which lets us attribute them to the group containing that op.
+      const DlRTree& rtree = *base->rtree();
+      for (int i = 0; i < rtree.leaf_count(); i++) {
+        DlIndex op_index = static_cast<DlIndex>(rtree.id(i));
+        auto group = std::upper_bound(
+            groups.begin(), groups.end(), op_index,
+            [](DlIndex value, const DisplayList::OpRange& range) {
+              return value < range.start;
+            });
+        FML_DCHECK(group != groups.begin());
+        group_bounds[std::prev(group) - groups.begin()].accumulate(
+            rtree.bounds(i));
+      }
+    } else {
+      // Without an rtree we have no way to know which group rendered
+      // where so each group conservatively covers the whole list.
+      for (AccumulationRect& bounds : group_bounds) {
+        bounds.accumulate(base->bounds());
+      }
+    }
+  }
+
+  // Dispatches records of the base list to the tracker until it reaches
+  // the indicated index.
+  void AdvanceTracker(DlIndex index) {
+    if (index < tracker_index) {
+      // Splicing an earlier group, start over from the beginning.
+      tracker = SpliceStateTracker(cull_rect);
+      tracker_index = 0u;
+    }
+    for (; tracker_index < index; tracker_index++) {
+      base->Dispatch(tracker, tracker_index);
+    }
+  }
+
+  // Moves the bounds accumulated in |changed_run| to |changed_rects|.
+  void FlushChangedRun() {
+    if (!changed_run.is_empty()) {
+      changed_rects.push_back(changed_run.bounds());
+      changed_run.reset();
+    }
+  }
+
+  const sk_sp<DisplayList> base;
+  const std::vector<DisplayList::OpRange> groups;
+  std::vector<AccumulationRect> group_bounds;
+  std::vector<bool> group_reused;
+
+  const DlRect cull_rect;
+  SpliceStateTracker tracker;
+  DlIndex tracker_index = 0u;
+
+  // The clips recorded at the root level of the new list so far.
+  std::vector<SpliceRootClip> root_clips;
+
+  // Groups must be spliced in their original order to be considered
+  // unchanged as they might overlap.
+  int last_reused_group = -1;
+  bool replaying_unchanged_group = false;
+
+  // The device space bounds of the ops recorded since the last group
+  // was spliced, and the accumulated list of such runs.
+  AccumulationRect changed_run;
+  std::vector<SkRect> changed_rects;
+};
+
+// Splicing is only meant to describe the changes between similar
+// pictures. Beyond this many changed rects the damage is coalesced
+// into a single rect.
+static constexpr size_t kMaxSpliceChangedRects = 16u;
+
+void DisplayListBuilder::BeginSplice(const sk_sp<DisplayList>& base) {
+  FML_DCHECK(op_index_ == 0u && save_stack_.size() == 1u);
+  if (!base || op_index_ != 0u) {
+    splice_.reset();
+    return;
+  }
+  splice_ = std::make_unique<SpliceInfo>(base, original_cull_rect_);
+}
+
+size_t DisplayListBuilder::GetSpliceGroupCount() const {
+  return splice_ ? splice_->groups.size() : 0u;
+}
+
+bool DisplayListBuilder::SpliceGroup(size_t group_index) {
+  FML_DCHECK(splice_);
+  if (!splice_ || group_index >= splice_->groups.size()) {
+    return false;
+  }
+  SpliceInfo& splice = *splice_;
+  const DisplayList::OpRange& group = splice.groups[group_index];
+
+  // The group can only be reused unchanged if it will render into the same
+  // place in the same order as it did in the base list, which means that
+  // it must be recorded at the root level under the same transform and clip
+  // that were in effect when it was first recorded. Clips with the same
+  // bounds may still differ in shape, so the root clips are compared too.
+  splice.FlushChangedRun();
+  splice.AdvanceTracker(group.start);
+  const DisplayListMatrixClipState& base_state = splice.tracker.state();
+  bool unchanged =
+      save_stack_.size() == 1u &&
+      static_cast<int>(group_index) > splice.last_reused_group &&
+      base_state.matrix() == global_state().matrix() &&
+      base_state.GetDeviceCullCoverage() ==
+          global_state().GetDeviceCullCoverage() &&
+      splice.tracker.root_clips() == splice.root_clips;
+
+  // Attributes are not scoped by saves so the group may depend on any
+  // attribute that was set before it, make sure they all match.
+  const DlPaint& paint = splice.tracker.paint();
+  setAntiAlias(paint.isAntiAlias());
+  setInvertColors(paint.isInvertColors());
+  setColor(paint.getColor());
+  setBlendMode(paint.getBlendMode());
+  setDrawStyle(paint.getDrawStyle());
+  setStrokeWidth(paint.getStrokeWidth());
+  setStrokeMiter(paint.getStrokeMiter());
+  setStrokeCap(paint.getStrokeCap());
+  setStrokeJoin(paint.getStrokeJoin());
+  setColorSource(paint.getColorSource().get());
+  setColorFilter(paint.getColorFilter().get());
+  setImageFilter(paint.getImageFilter().get());
+  setMaskFilter(paint.getMaskFilter().get());
+
+  splice.replaying_unchanged_group = unchanged;
+  for (DlIndex i = group.start; i < group.end; i++) {
+    splice.base->Dispatch(asReceiver(), i);
+  }
+  splice.replaying_unchanged_group = false;
+  splice.FlushChangedRun();
+
+  if (unchanged) {
+    splice.group_reused[group_index] = true;
+    splice.last_reused_group = static_cast<int>(group_index);
+  }
+  return unchanged;
+}
+
+void DisplayListBuilder::AccumulateSpliceBounds(const SkRect& global_bounds) {
+  if (splice_ && !splice_->replaying_unchanged_group) {
+    splice_->changed_run.accumulate(global_bounds);
+  }
+}
+
 sk_sp<DisplayList> DisplayListBuilder::Build() {
   while (save_stack_.size() > 1) {
     restore();
@@ -81,6 +516,25 @@ sk_sp<DisplayList> DisplayListBuilder::Build() {
   bool root_is_unbounded = current_layer().is_unbounded;
   DlBlendMode max_root_blend_mode = current_layer().max_blend_mode;
 
+  std::unique_ptr<SpliceInfo> splice = std::move(splice_);
+  if (splice) {
+    splice->FlushChangedRun();
+    // Any group of the base list that was not reused unchanged may have
+    // been removed or moved so the area it covered must be repainted.
+    for (size_t i = 0; i < splice->groups.size(); i++) {
+      if (!splice->group_reused[i] && !splice->group_bounds[i].is_empty()) {
+        splice->changed_rects.push_back(splice->group_bounds[i].bounds());
+      }
+    }
+    if (splice->changed_rects.size() > kMaxSpliceChangedRects) {
+      AccumulationRect all_changes;
+      for (const SkRect& rect : splice->changed_rects) {
+        all_changes.accumulate(rect);
+      }
+      splice->changed_rects = {all_changes.bounds()};
+    }
+  }
+
   sk_sp<DlRTree> rtree;
   SkRect bounds;
   if (rtree_data_.has_value()) {
@@ -108,12 +562,21 @@ sk_sp<DisplayList> DisplayListBuilder::Build() {
   save_stack_.pop_back();
   Init(rtree != nullptr);
 
-  storage_.realloc(bytes);
-  return sk_sp<DisplayList>(new DisplayList(
-      std::move(storage_), bytes, count, nested_bytes, nested_count,
+  sk_sp<DisplayList> display_list(new DisplayList(
+      TakeStorage(bytes), bytes, count, nested_bytes, nested_count,
       total_depth, bounds, opacity_compatible, is_safe, affects_transparency,
       max_root_blend_mode, root_has_backdrop_filter, root_is_unbounded,
       std::move(rtree)));
+  if (splice) {
+    if (splice->changed_rects.empty() &&
+        display_list->has_rtree() == splice->base->has_rtree()) {
+      // Every group was reused as is and nothing else was recorded.
+      return splice->base;
+    }
+    display_list->spliced_from_id_ = splice->base->unique_id();
+    display_list->splice_changed_rects_ = std::move(splice->changed_rects);
+  }
+  return display_list;
 }
 
 static constexpr DlRect kEmpty = DlRect();
@@ -129,6 +592,13 @@ DisplayListBuilder::DisplayListBuilder(const SkRect& cull_rect,
   Init(prepare_rtree);
 }
 
+DisplayListBuilder::DisplayListBuilder(const SkRect& cull_rect,
+                                       bool prepare_rtree,
+                                       std::shared_ptr<DisplayListArena> arena)
+    : arena_(std::move(arena)), original_cull_rect_(ProtectEmpty(cull_rect)) {
+  Init(prepare_rtree);
+}
+
 void DisplayListBuilder::Init(bool prepare_rtree) {
   FML_DCHECK(save_stack_.empty());
   FML_DCHECK(!rtree_data_.has_value());
@@ -141,6 +611,10 @@ void DisplayListBuilder::Init(bool prepare_rtree) {
 }
 
 DisplayListBuilder::~DisplayListBuilder() {
+  if (arena_) {
+    ReleaseArenaChunks();
+    return;
+  }
   uint8_t* ptr = storage_.get();
   if (ptr) {
     DisplayList::DisposeOps(ptr, ptr + used_);
@@ -199,6 +673,13 @@ void DisplayListBuilder::onSetColorSource(const DlColorSource* source) {
   if (source == nullptr) {
     current_.setColorSource(nullptr);
     Push<ClearColorSourceOp>(0);
+  } else if (attribute_interner_ &&
+             source->type() != DlColorSourceType::kColor) {
+    std::shared_ptr<DlColorSource> canonical =
+        attribute_interner_->Intern(source);
+    current_.setColorSource(canonical);
+    is_ui_thread_safe_ = is_ui_thread_safe_ && source->isUIThreadSafe();
+    Push<SetSharedColorSourceOp>(0, std::move(canonical));
   } else {
     current_.setColorSource(source->shared());
     is_ui_thread_safe_ = is_ui_thread_safe_ && source->isUIThreadSafe();
@@ -257,6 +738,11 @@ void DisplayListBuilder::onSetImageFilter(const DlImageFilter* filter) {
   if (filter == nullptr) {
     current_.setImageFilter(nullptr);
     Push<ClearImageFilterOp>(0);
+  } else if (attribute_interner_) {
+    std::shared_ptr<DlImageFilter> canonical =
+        attribute_interner_->Intern(filter);
+    current_.setImageFilter(canonical);
+    Push<SetSharedImageFilterOp>(0, std::move(canonical));
   } else {
     current_.setImageFilter(filter->shared());
     switch (filter->type()) {
@@ -301,6 +787,11 @@ void DisplayListBuilder::onSetColorFilter(const DlColorFilter* filter) {
   if (filter == nullptr) {
     current_.setColorFilter(nullptr);
     Push<ClearColorFilterOp>(0);
+  } else if (attribute_interner_) {
+    std::shared_ptr<DlColorFilter> canonical =
+        attribute_interner_->Intern(filter);
+    current_.setColorFilter(canonical);
+    Push<SetSharedColorFilterOp>(0, std::move(canonical));
   } else {
     current_.setColorFilter(filter->shared());
     switch (filter->type()) {
@@ -337,6 +828,12 @@ void DisplayListBuilder::onSetMaskFilter(const DlMaskFilter* filter) {
     current_.setMaskFilter(nullptr);
     render_op_depth_cost_ = 1u;
     Push<ClearMaskFilterOp>(0);
+  } else if (attribute_interner_) {
+    std::shared_ptr<DlMaskFilter> canonical =
+        attribute_interner_->Intern(filter);
+    current_.setMaskFilter(canonical);
+    render_op_depth_cost_ = 2u;
+    Push<SetSharedMaskFilterOp>(0, std::move(canonical));
   } else {
     current_.setMaskFilter(filter->shared());
     render_op_depth_cost_ = 2u;
@@ -524,7 +1021,11 @@ void DisplayListBuilder::saveLayer(const DlRect& bounds,
       FML_DCHECK(record_bounds.IsEmpty());
     }
 
-    if (backdrop) {
+    if (backdrop && attribute_interner_) {
+      Push<SaveLayerBackdropOp>(0, options, record_bounds,
+                                attribute_interner_->Intern(backdrop),
+                                backdrop_id);
+    } else if (backdrop) {
       Push<SaveLayerBackdropOp>(0, options, record_bounds, backdrop,
                                 backdrop_id);
     } else {
@@ -568,8 +1069,8 @@ void DisplayListBuilder::Restore() {
   }
 
   if (!current_info().has_deferred_save_op) {
-    SaveOpBase* op = reinterpret_cast<SaveOpBase*>(storage_.get() +
-                                                   current_info().save_offset);
+    SaveOpBase* op =
+        reinterpret_cast<SaveOpBase*>(StorageAt(current_info().save_offset));
     FML_CHECK(op->type == DisplayListOpType::kSave ||
               op->type == DisplayListOpType::kSaveLayer ||
               op->type == DisplayListOpType::kSaveLayerBackdrop);
@@ -605,7 +1106,7 @@ void DisplayListBuilder::RestoreLayer() {
   SkRect content_bounds = current_layer().layer_local_accumulator.bounds();
 
   SaveLayerOpBase* layer_op = reinterpret_cast<SaveLayerOpBase*>(
-      storage_.get() + current_info().save_offset);
+      StorageAt(current_info().save_offset));
   FML_CHECK(layer_op->type == DisplayListOpType::kSaveLayer ||
             layer_op->type == DisplayListOpType::kSaveLayerBackdrop);
 
@@ -699,6 +1200,10 @@ void DisplayListBuilder::TransferLayerBounds(const SkRect& content_bounds) {
   const SkRect clip = parent_info().global_state.device_cull_rect();
   const SkMatrix matrix = parent_info().global_state.matrix_3x3();
 
+  // The content bounds that were recorded as changed did not include the
+  // effect of the filter, which may spread them anywhere within the clip.
+  AccumulateSpliceBounds(clip);
+
   if (rtree_data_.has_value()) {
     // Neither current or parent layer should have any global bounds in
     // their accumulator
@@ -962,6 +1467,11 @@ void DisplayListBuilder::ClipRect(const DlRect& rect,
       Push<ClipDifferenceRectOp>(0, rect, is_aa);
       break;
   }
+  if (splice_ && save_stack_.size() == 1u) {
+    splice_->root_clips.push_back(
+        SpliceRootClip::Rect(SpliceRootClip::Shape::kRect, rect, clip_op,
+                             is_aa, global_state().matrix()));
+  }
 }
 void DisplayListBuilder::ClipOval(const DlRect& bounds,
                                   ClipOp clip_op,
@@ -994,6 +1504,11 @@ void DisplayListBuilder::ClipOval(const DlRect& bounds,
       Push<ClipDifferenceOvalOp>(0, bounds, is_aa);
       break;
   }
+  if (splice_ && save_stack_.size() == 1u) {
+    splice_->root_clips.push_back(
+        SpliceRootClip::Rect(SpliceRootClip::Shape::kOval, bounds, clip_op,
+                             is_aa, global_state().matrix()));
+  }
 }
 void DisplayListBuilder::ClipRoundRect(const DlRoundRect& rrect,
                                        ClipOp clip_op,
@@ -1031,6 +1546,10 @@ void DisplayListBuilder::ClipRoundRect(const DlRoundRect& rrect,
       Push<ClipDifferenceRoundRectOp>(0, rrect, is_aa);
       break;
   }
+  if (splice_ && save_stack_.size() == 1u) {
+    splice_->root_clips.push_back(SpliceRootClip::RoundRect(
+        rrect, clip_op, is_aa, global_state().matrix()));
+  }
 }
 void DisplayListBuilder::ClipPath(const DlPath& path,
                                   ClipOp clip_op,
@@ -1071,6 +1590,10 @@ void DisplayListBuilder::ClipPath(const DlPath& path,
       Push<ClipDifferencePathOp>(0, path, is_aa);
       break;
   }
+  if (splice_ && save_stack_.size() == 1u) {
+    splice_->root_clips.push_back(
+        SpliceRootClip::Path(path, clip_op, is_aa, global_state().matrix()));
+  }
 }
 
 bool DisplayListBuilder::QuickReject(const DlRect& bounds) const {
@@ -1303,9 +1826,7 @@ void DisplayListBuilder::drawPoints(PointMode mode,
   FML_DCHECK(count < DlOpReceiver::kMaxDrawPointsCount);
   int bytes = count * sizeof(SkPoint);
   AccumulationRect accumulator;
-  for (size_t i = 0; i < count; i++) {
-    accumulator.accumulate(pts[i]);
-  }
+  accumulator.accumulate(pts, count);
   SkRect point_bounds = accumulator.bounds();
   if (!AccumulateOpBounds(point_bounds, flags)) {
     return;
@@ -1479,6 +2000,26 @@ void DisplayListBuilder::DrawImageNine(const sk_sp<DlImage>& image,
     drawImageNine(image, center, dst, filter, false);
   }
 }
+// Computes the bounds of the quad that an RSXform maps a sprite of the
+// indicated size to using the same arithmetic as SkRSXform::toQuad, but
+// without materializing the corners.
+static SkRect RSXformQuadBounds(const SkRSXform& xform,
+                                DlScalar width,
+                                DlScalar height) {
+  DlScalar ax = xform.fSCos * width;
+  DlScalar ay = xform.fSSin * width;
+  DlScalar bx = -xform.fSSin * height;
+  DlScalar by = xform.fSCos * height;
+  DlScalar x[4] = {xform.fTx, ax + xform.fTx, ax + bx + xform.fTx,
+                   bx + xform.fTx};
+  DlScalar y[4] = {xform.fTy, ay + xform.fTy, ay + by + xform.fTy,
+                   by + xform.fTy};
+  return SkRect::MakeLTRB(std::min({x[0], x[1], x[2], x[3]}),
+                          std::min({y[0], y[1], y[2], y[3]}),
+                          std::max({x[0], x[1], x[2], x[3]}),
+                          std::max({y[0], y[1], y[2], y[3]}));
+}
+
 void DisplayListBuilder::drawAtlas(const sk_sp<DlImage> atlas,
                                    const SkRSXform xform[],
                                    const DlRect tex[],
@@ -1495,14 +2036,10 @@ void DisplayListBuilder::drawAtlas(const sk_sp<DlImage> atlas,
   if (result == OpResult::kNoEffect) {
     return;
   }
-  SkPoint quad[4];
   AccumulationRect accumulator;
   for (int i = 0; i < count; i++) {
-    const SkRect& src = ToSkRect(tex[i]);
-    xform[i].toQuad(src.width(), src.height(), quad);
-    for (int j = 0; j < 4; j++) {
-      accumulator.accumulate(quad[j]);
-    }
+    accumulator.accumulate(
+        RSXformQuadBounds(xform[i], tex[i].GetWidth(), tex[i].GetHeight()));
   }
   if (accumulator.is_empty() ||
       !AccumulateOpBounds(accumulator.bounds(), flags)) {
@@ -1513,11 +2050,9 @@ void DisplayListBuilder::drawAtlas(const sk_sp<DlImage> atlas,
   // since each atlas op is treated as an independent operation, we have
   // to pass along our locally computed overlap condition for the individual
   // atlas operations to the layer accumulator.
-  // Note that the above accumulation may falsely trigger the overlapping
-  // state as it is done quad corner by quad corner and an entire quad may
-  // be non-overlapping with the layer bounds, but as we add each point
-  // independently it might expand the bounds on one corner and then flag
-  // the condition when the next corner is added.
+  // Note that the above accumulation may still falsely trigger the
+  // overlapping state as it compares the bounds of each rotated quad
+  // rather than the quads themselves.
   if (accumulator.overlap_detected()) {
     current_layer().layer_local_accumulator.record_overlapping_bounds();
   }
@@ -1806,6 +2341,7 @@ bool DisplayListBuilder::AccumulateUnbounded(const SaveInfo& save) {
   if (global_clip.isEmpty() || !save.layer_state.mapAndClipRect(&layer_clip)) {
     return false;
   }
+  AccumulateSpliceBounds(global_clip);
   if (rtree_data_.has_value()) {
     FML_DCHECK(save.layer_info->global_space_accumulator.is_empty());
     rtree_data_->rects.push_back(global_clip);
@@ -1838,6 +2374,7 @@ bool DisplayListBuilder::AccumulateBounds(const SkRect& bounds,
       !layer.layer_state.mapAndClipRect(bounds, &layer_bounds)) {
     return false;
   }
+  AccumulateSpliceBounds(global_bounds);
   if (rtree_data_.has_value()) {
     FML_DCHECK(layer.layer_info->global_space_accumulator.is_empty());
     if (id >= 0) {
@@ -6,12 +6,14 @@
 #define FLUTTER_DISPLAY_LIST_DL_BUILDER_H_
 
 #include "flutter/display_list/display_list.h"
+#include "flutter/display_list/dl_attribute_interner.h"
 #include "flutter/display_list/dl_blend_mode.h"
 #include "flutter/display_list/dl_canvas.h"
 #include "flutter/display_list/dl_op_flags.h"
 #include "flutter/display_list/dl_op_receiver.h"
 #include "flutter/display_list/dl_paint.h"
 #include "flutter/display_list/dl_sampling_options.h"
+#include "flutter/display_list/dl_storage_arena.h"
 #include "flutter/display_list/geometry/dl_geometry_types.h"
 #include "flutter/display_list/image/dl_image.h"
 #include "flutter/display_list/utils/dl_accumulation_rect.h"
@@ -38,6 +40,17 @@ class DisplayListBuilder final : public virtual DlCanvas,
   explicit DisplayListBuilder(const SkRect& cull_rect = kMaxCullRect,
                               bool prepare_rtree = false);
 
+  // Constructs a builder that records its ops into chunks acquired from
+  // the indicated |arena| rather than into a single buffer grown with
+  // realloc. The builder keeps its reference to the arena across calls
+  // to |Build| so that a builder reused to record every frame will reuse
+  // the storage of the DisplayLists it built on earlier frames.
+  //
+  // @see |DisplayListArena|
+  DisplayListBuilder(const SkRect& cull_rect,
+                     bool prepare_rtree,
+                     std::shared_ptr<DisplayListArena> arena);
+
   DisplayListBuilder(DlScalar width, DlScalar height)
       : DisplayListBuilder(SkRect::MakeWH(width, height)) {}
 
@@ -243,6 +256,58 @@ class DisplayListBuilder final : public virtual DlCanvas,
 
   sk_sp<DisplayList> Build();
 
+  /// Begins recording the next DisplayList as an incremental update of the
+  /// |base| DisplayList, typically the list that this builder produced for
+  /// the previous frame.
+  ///
+  /// After this call the caller may interleave regular recording calls with
+  /// calls to |SpliceGroup| which copy one of the top level groups of the
+  /// |base| list (as reported by |DisplayList::GetTopLevelGroups|) into the
+  /// new recording. The builder keeps track of which parts of the new list
+  /// could possibly render differently from the |base| list: groups that
+  /// are spliced in order under the same transform, clip and attributes as
+  /// they were recorded under in the |base| list are unchanged, everything
+  /// else that is recorded and every group of the |base| list that is not
+  /// spliced is considered changed.
+  ///
+  /// The DisplayList returned from the next call to |Build| will report
+  /// that it was spliced from |base| along with the rectangles that may
+  /// have changed, allowing a consumer such as the DiffContext to compute
+  /// damage without comparing the two lists. If nothing changed at all
+  /// then |Build| returns the |base| list itself.
+  ///
+  /// This method must be called before anything else is recorded.
+  ///
+  /// @see |DisplayList::IsSplicedFrom|
+  /// @see |DisplayList::GetSpliceChangedRects|
+  void BeginSplice(const sk_sp<DisplayList>& base);
+
+  /// Returns the number of top level groups in the DisplayList passed to
+  /// |BeginSplice|, or 0 if no splice is in progress.
+  size_t GetSpliceGroupCount() const;
+
+  /// Copies the indicated top level group of the DisplayList passed to
+  /// |BeginSplice| into the current recording and returns true if the
+  /// group was reused without contributing to the changed region.
+  bool SpliceGroup(size_t group_index);
+
+  /// Sets the table of canonical attribute instances that this builder
+  /// records color sources, color filters, image filters and mask filters
+  /// through. While an interner is set the builder records a reference to
+  /// the canonical instance of each attribute instead of a copy of it, so
+  /// that equal attributes recorded by any builder that shares the
+  /// interner are the same object.
+  ///
+  /// The interner only affects attributes that are set after this call.
+  ///
+  /// @see |DlAttributeInterner|
+  void SetAttributeInterner(std::shared_ptr<DlAttributeInterner> interner) {
+    attribute_interner_ = std::move(interner);
+  }
+  const std::shared_ptr<DlAttributeInterner>& GetAttributeInterner() const {
+    return attribute_interner_;
+  }
+
   ENABLE_DL_CANVAS_BACKWARDS_COMPATIBILITY
 
  private:
@@ -262,6 +327,12 @@ class DisplayListBuilder final : public virtual DlCanvas,
       DisplayListBuilder& builder);
   friend int DisplayListBuilderTestingLastOpIndex(DisplayListBuilder& builder);
 
+  // Replays deserialized records through the DlOpReceiver interface so that
+  // the resulting ops match those of the original DisplayList exactly.
+  friend class DlSerializer;
+  // Replays the ops of a DisplayList that survive optimization.
+  friend class DlOptimizer;
+
   void SetAttributesFromPaint(const DlPaint& paint,
                               const DisplayListAttributeFlags flags);
 
@@ -499,6 +570,32 @@ class DisplayListBuilder final : public virtual DlCanvas,
   DisplayListStorage storage_;
   size_t used_ = 0u;
   size_t allocated_ = 0u;
+
+  // A chunk of op storage acquired from |arena_|. Ops never span chunks
+  // and the chunks are never moved or resized while recording.
+  struct ArenaChunk {
+    uint8_t* ptr;
+    size_t capacity;
+    size_t used;
+    // The offset of the start of this chunk within the sequence of
+    // recorded ops, used to resolve the offsets stored in SaveInfo.
+    size_t start;
+  };
+
+  // When non-null, ops are recorded into |arena_chunks_| rather than
+  // into |storage_|.
+  const std::shared_ptr<DisplayListArena> arena_;
+  std::vector<ArenaChunk> arena_chunks_;
+  // The number of bytes used by the most recently built DisplayList,
+  // used to size the first chunk of the next recording.
+  size_t last_build_bytes_ = 0u;
+
+  uint8_t* AllocateFromArena(size_t size);
+  DisplayListStorage TakeStorage(size_t bytes);
+  void ReleaseArenaChunks();
+
+  // Returns the address of the op recorded at the indicated offset.
+  uint8_t* StorageAt(size_t offset);
   uint32_t render_op_count_ = 0u;
   uint32_t depth_ = 0u;
   // Most rendering ops will use 1 depth value, but some attributes may
@@ -512,6 +609,10 @@ class DisplayListBuilder final : public virtual DlCanvas,
 
   bool is_ui_thread_safe_ = true;
 
+  // When non-null, attributes are recorded as references to the canonical
+  // instances held by this interner rather than as copies.
+  std::shared_ptr<DlAttributeInterner> attribute_interner_;
+
   template <typename T, typename... Args>
   void* Push(size_t extra, Args&&... args);
 
@@ -520,6 +621,15 @@ class DisplayListBuilder final : public virtual DlCanvas,
     std::vector<int> indices;
   };
 
+  // The state of an incremental recording started by |BeginSplice|,
+  // defined in the implementation file.
+  struct SpliceInfo;
+  std::unique_ptr<SpliceInfo> splice_;
+
+  // Records that the indicated device space bounds were rendered by an op
+  // that was not part of an unchanged group spliced from the base list.
+  void AccumulateSpliceBounds(const SkRect& global_bounds);
+
   struct LayerInfo {
     LayerInfo(const std::shared_ptr<const DlImageFilter>& filter,
               size_t rtree_rects_start_index)
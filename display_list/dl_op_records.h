@@ -235,23 +235,37 @@ struct SetRuntimeEffectColorSourceOp : DLOp {
 };
 
 // 4 byte header + 16 byte payload uses 24 total bytes (4 bytes unused)
-struct SetSharedImageFilterOp : DLOp {
-  static constexpr auto kType = DisplayListOpType::kSetSharedImageFilter;
-
-  explicit SetSharedImageFilterOp(const DlImageFilter* filter)
-      : filter(filter->shared()) {}
-
-  const std::shared_ptr<DlImageFilter> filter;
-
-  void dispatch(DlOpReceiver& receiver) const {
-    receiver.setImageFilter(filter.get());
-  }
-
-  DisplayListCompare equals(const SetSharedImageFilterOp* other) const {
-    return Equals(filter, other->filter) ? DisplayListCompare::kEqual
-                                         : DisplayListCompare::kNotEqual;
-  }
-};
+//
+// Holds a reference to a shared Dl<name> instance rather than a copy of
+// it. Used for attributes that hold references to other attributes and
+// for the canonical instances handed out by a |DlAttributeInterner|, in
+// which case two ops referring to the same instance compare equal without
+// having to examine the contents.
+#define DEFINE_SET_SHARED_DLATTR_OP(name, field)                         \
+  struct SetShared##name##Op final : DLOp {                              \
+    static constexpr auto kType = DisplayListOpType::kSetShared##name;   \
+                                                                         \
+    explicit SetShared##name##Op(const Dl##name* field)                  \
+        : field(field->shared()) {}                                      \
+    explicit SetShared##name##Op(std::shared_ptr<Dl##name> field)        \
+        : field(std::move(field)) {}                                     \
+                                                                         \
+    const std::shared_ptr<Dl##name> field;                               \
+                                                                         \
+    void dispatch(DlOpReceiver& receiver) const {                        \
+      receiver.set##name(field.get());                                   \
+    }                                                                    \
+                                                                         \
+    DisplayListCompare equals(const SetShared##name##Op* other) const {  \
+      return Equals(field, other->field) ? DisplayListCompare::kEqual    \
+                                         : DisplayListCompare::kNotEqual; \
+    }                                                                    \
+  };
+DEFINE_SET_SHARED_DLATTR_OP(ColorFilter, filter)
+DEFINE_SET_SHARED_DLATTR_OP(ImageFilter, filter)
+DEFINE_SET_SHARED_DLATTR_OP(MaskFilter, filter)
+DEFINE_SET_SHARED_DLATTR_OP(ColorSource, source)
+#undef DEFINE_SET_SHARED_DLATTR_OP
 
 // The base struct for all save() and saveLayer() ops
 // 4 byte header + 12 byte payload packs exactly into 16 bytes
@@ -315,6 +329,13 @@ struct SaveLayerBackdropOp final : SaveLayerOpBase {
       : SaveLayerOpBase(options, rect),
         backdrop(backdrop->shared()),
         backdrop_id_(backdrop_id) {}
+  SaveLayerBackdropOp(const SaveLayerOptions& options,
+                      const DlRect& rect,
+                      std::shared_ptr<DlImageFilter> backdrop,
+                      std::optional<int64_t> backdrop_id)
+      : SaveLayerOpBase(options, rect),
+        backdrop(std::move(backdrop)),
+        backdrop_id_(backdrop_id) {}
 
   const std::shared_ptr<DlImageFilter> backdrop;
   std::optional<int64_t> backdrop_id_;
@@ -692,6 +713,12 @@ struct DrawVerticesOp final : DrawOpBase {
   void dispatch(DlOpReceiver& receiver) const {
     receiver.drawVertices(vertices, mode);
   }
+
+  DisplayListCompare equals(const DrawVerticesOp* other) const {
+    return (mode == other->mode && *vertices == *other->vertices)
+               ? DisplayListCompare::kEqual
+               : DisplayListCompare::kNotEqual;
+  }
 };
 
 // 4 byte header + 40 byte payload uses 44 bytes but is rounded up to 48 bytes
@@ -0,0 +1,780 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/display_list/dl_optimizer.h"
+
+#include <vector>
+
+#include "flutter/display_list/dl_builder.h"
+#include "flutter/display_list/utils/dl_matrix_clip_tracker.h"
+#include "flutter/display_list/utils/dl_receiver_utils.h"
+
+namespace flutter {
+
+namespace {
+
+using ClipOp = DlCanvas::ClipOp;
+using PointMode = DlCanvas::PointMode;
+using SrcRectConstraint = DlCanvas::SrcRectConstraint;
+
+// Returns true if anything rendered with |paint| replaces the destination
+// pixels it fully covers with opaque pixels.
+bool IsOpaqueCoverPaint(const DlPaint& paint) {
+  if (!paint.getColor().isOpaque() || paint.isInvertColors()) {
+    return false;
+  }
+  if (paint.getBlendMode() != DlBlendMode::kSrcOver &&
+      paint.getBlendMode() != DlBlendMode::kSrc) {
+    return false;
+  }
+  if (paint.getColorFilterPtr() || paint.getImageFilterPtr() ||
+      paint.getMaskFilterPtr()) {
+    return false;
+  }
+  // Image color sources may be opaque inside the image and transparent
+  // outside of it, gradients are opaque everywhere or nowhere.
+  const DlColorSource* source = paint.getColorSourcePtr();
+  return !source || (source->isGradient() && source->is_opaque());
+}
+
+// Finds the ops that completely cover the pixels below them with opaque
+// pixels. Only ops outside of any saveLayer can hide the ops beneath them
+// since the contents of a layer are composited as a group.
+//
+// Covers are only recognized when the clip is known exactly, that is when
+// it is made up of rect clips under rect-preserving transforms, in which
+// case the clip is tracked as a device space rectangle.
+//
+// A backdrop filter can spread the pixels of the ops beneath it outside
+// of their bounds so a cover never hides ops that precede a backdrop
+// filter that precedes the cover.
+class CoverFinder : public IgnoreDrawDispatchHelper {
+ public:
+  struct Cover {
+    // The index of the covering op.
+    DlIndex index;
+    // The index of the first op that the cover may hide.
+    DlIndex first_hidden_index;
+    SkIRect device_bounds;
+  };
+
+  CoverFinder()
+      : state_(DisplayListBuilder::kMaxCullRect),
+        clip_(ToDlRect(DisplayListBuilder::kMaxCullRect)) {}
+
+  void set_current_index(DlIndex index) { current_index_ = index; }
+  bool is_inside_layer() const { return layer_depth_ > 0; }
+  const std::vector<Cover>& covers() const { return covers_; }
+
+  void setAntiAlias(bool aa) override { paint_.setAntiAlias(aa); }
+  void setDrawStyle(DlDrawStyle style) override { paint_.setDrawStyle(style); }
+  void setColor(DlColor color) override { paint_.setColor(color); }
+  void setStrokeWidth(float width) override { paint_.setStrokeWidth(width); }
+  void setStrokeMiter(float limit) override { paint_.setStrokeMiter(limit); }
+  void setStrokeCap(DlStrokeCap cap) override { paint_.setStrokeCap(cap); }
+  void setStrokeJoin(DlStrokeJoin join) override {
+    paint_.setStrokeJoin(join);
+  }
+  void setColorSource(const DlColorSource* source) override {
+    paint_.setColorSource(source);
+  }
+  void setColorFilter(const DlColorFilter* filter) override {
+    paint_.setColorFilter(filter);
+  }
+  void setInvertColors(bool invert) override {
+    paint_.setInvertColors(invert);
+  }
+  void setBlendMode(DlBlendMode mode) override { paint_.setBlendMode(mode); }
+  void setMaskFilter(const DlMaskFilter* filter) override {
+    paint_.setMaskFilter(filter);
+  }
+  void setImageFilter(const DlImageFilter* filter) override {
+    paint_.setImageFilter(filter);
+  }
+
+  void save() override { save_stack_.push_back({state_.matrix(), clip_}); }
+  void saveLayer(const DlRect& bounds,
+                 const SaveLayerOptions options,
+                 const DlImageFilter* backdrop,
+                 std::optional<int64_t> backdrop_id) override {
+    save_stack_.push_back({state_.matrix(), clip_, true});
+    layer_depth_++;
+    if (backdrop) {
+      first_hidden_index_ = current_index_ + 1;
+    }
+  }
+  void restore() override {
+    if (save_stack_.empty()) {
+      return;
+    }
+    const SaveInfo& info = save_stack_.back();
+    state_.setTransform(info.matrix);
+    clip_ = info.clip;
+    if (info.is_layer) {
+      layer_depth_--;
+    }
+    save_stack_.pop_back();
+  }
+
+  void translate(DlScalar tx, DlScalar ty) override {
+    state_.translate(tx, ty);
+  }
+  void scale(DlScalar sx, DlScalar sy) override { state_.scale(sx, sy); }
+  void rotate(DlScalar degrees) override { state_.rotate(degrees); }
+  void skew(DlScalar sx, DlScalar sy) override { state_.skew(sx, sy); }
+  // clang-format off
+  void transform2DAffine(DlScalar mxx, DlScalar mxy, DlScalar mxt,
+                         DlScalar myx, DlScalar myy, DlScalar myt) override {
+    state_.transform2DAffine(mxx, mxy, mxt, myx, myy, myt);
+  }
+  void transformFullPerspective(
+      DlScalar mxx, DlScalar mxy, DlScalar mxz, DlScalar mxt,
+      DlScalar myx, DlScalar myy, DlScalar myz, DlScalar myt,
+      DlScalar mzx, DlScalar mzy, DlScalar mzz, DlScalar mzt,
+      DlScalar mwx, DlScalar mwy, DlScalar mwz, DlScalar mwt) override {
+    state_.transformFullPerspective(mxx, mxy, mxz, mxt,
+                                    myx, myy, myz, myt,
+                                    mzx, mzy, mzz, mzt,
+                                    mwx, mwy, mwz, mwt);
+  }
+  // clang-format on
+  void transformReset() override { state_.setIdentity(); }
+
+  void clipRect(const DlRect& rect, ClipOp clip_op, bool is_aa) override {
+    DlRect device_rect;
+    if (clip_op == ClipOp::kIntersect && MapRect(rect, &device_rect)) {
+      clip_ = clip_.Intersection(device_rect).value_or(DlRect());
+    } else {
+      clip_ = DlRect();
+    }
+  }
+  void clipOval(const DlRect& bounds, ClipOp clip_op, bool is_aa) override {
+    clip_ = DlRect();
+  }
+  void clipRoundRect(const DlRoundRect& rrect,
+                     ClipOp clip_op,
+                     bool is_aa) override {
+    clip_ = DlRect();
+  }
+  void clipPath(const DlPath& path, ClipOp clip_op, bool is_aa) override {
+    clip_ = DlRect();
+  }
+
+  void drawColor(DlColor color, DlBlendMode mode) override {
+    if (color.isOpaque() &&
+        (mode == DlBlendMode::kSrcOver || mode == DlBlendMode::kSrc)) {
+      AddCover(clip_);
+    }
+  }
+  void drawPaint() override {
+    if (IsOpaqueCoverPaint(paint_)) {
+      AddCover(clip_);
+    }
+  }
+  void drawRect(const DlRect& rect) override {
+    DlRect device_rect;
+    if (paint_.getDrawStyle() == DlDrawStyle::kFill &&
+        IsOpaqueCoverPaint(paint_) && MapRect(rect, &device_rect)) {
+      AddCover(clip_.Intersection(device_rect).value_or(DlRect()));
+    }
+  }
+  void drawDisplayList(const sk_sp<DisplayList> display_list,
+                       DlScalar opacity) override {
+    if (display_list->root_has_backdrop_filter()) {
+      first_hidden_index_ = current_index_ + 1;
+    }
+  }
+
+ private:
+  struct SaveInfo {
+    DlMatrix matrix;
+    DlRect clip;
+    bool is_layer = false;
+  };
+
+  // Maps the rect to device space if the current transform maps rects
+  // to rects.
+  bool MapRect(const DlRect& rect, DlRect* device_rect) const {
+    if (!state_.matrix().IsTranslationScaleOnly()) {
+      return false;
+    }
+    return state_.mapRect(rect, device_rect);
+  }
+
+  void AddCover(const DlRect& device_rect) {
+    if (is_inside_layer()) {
+      return;
+    }
+    // Only the pixels entirely inside the rect are guaranteed to be
+    // replaced, anti-aliased edges may be partially transparent.
+    SkIRect bounds = ToSkRect(device_rect).roundIn();
+    if (!bounds.isEmpty()) {
+      covers_.push_back({current_index_, first_hidden_index_, bounds});
+    }
+  }
+
+  DisplayListMatrixClipState state_;
+  DlRect clip_;
+  DlPaint paint_;
+  std::vector<SaveInfo> save_stack_;
+  int layer_depth_ = 0;
+  DlIndex current_index_ = 0u;
+  DlIndex first_hidden_index_ = 0u;
+  std::vector<Cover> covers_;
+};
+
+// Returns a vector indicating which of the ops of |display_list| are
+// hidden by later opaque ops that are not inside a layer.
+std::vector<bool> FindOccludedOps(const DisplayList& display_list,
+                                  uint32_t* culled_count) {
+  const DlIndex count = display_list.GetRecordCount();
+  std::vector<bool> occluded(count, false);
+  const DlRTree* rtree = display_list.rtree().get();
+  if (!rtree) {
+    return occluded;
+  }
+
+  CoverFinder finder;
+  std::vector<bool> is_top_level(count, false);
+  for (DlIndex i = 0u; i < count; i++) {
+    is_top_level[i] = !finder.is_inside_layer();
+    finder.set_current_index(i);
+    display_list.Dispatch(finder, i);
+  }
+  if (finder.covers().empty()) {
+    return occluded;
+  }
+
+  // An op may have several rects in the RTree, such as a nested
+  // DisplayList, so the bounds of each op is the union of all of them.
+  std::vector<SkRect> op_bounds(count, SkRect::MakeEmpty());
+  for (int leaf = 0; leaf < rtree->leaf_count(); leaf++) {
+    op_bounds[rtree->id(leaf)].join(rtree->bounds(leaf));
+  }
+
+  for (const CoverFinder::Cover& cover : finder.covers()) {
+    rtree->searchEach(SkRect::Make(cover.device_bounds), [&](int result) {
+      DlIndex index = rtree->id(result);
+      if (index < cover.first_hidden_index || index >= cover.index ||
+          occluded[index] || !is_top_level[index]) {
+        return true;
+      }
+      DisplayListOpCategory category = display_list.GetOpCategory(index);
+      if (category != DisplayListOpCategory::kRendering &&
+          category != DisplayListOpCategory::kSubDisplayList) {
+        return true;
+      }
+      if (cover.device_bounds.contains(op_bounds[index].roundOut())) {
+        occluded[index] = true;
+        (*culled_count)++;
+      }
+      return true;
+    });
+  }
+  return occluded;
+}
+
+// Forwards ops to a builder while holding back attribute and transform
+// changes until an op that depends on them is reached.
+//
+// Attributes are flushed before every op that renders with them. The
+// builder ignores the values that have not changed, so any attribute that
+// was replaced while it was held back is never recorded.
+//
+// Transforms are concatenated while they are held back and flushed as a
+// single op before the next op that depends on the transform. Transforms
+// held back when a restore is reached are discarded since they would be
+// undone by the restore anyway.
+class OptimizingReceiver : public virtual DlOpReceiver {
+ public:
+  OptimizingReceiver(DlOpReceiver& receiver,
+                     const DlOptimizer::Options& options)
+      : receiver_(receiver),
+        defer_attributes_(options.eliminate_dead_attributes),
+        fold_transforms_(options.fold_transforms),
+        pending_transform_(DisplayListBuilder::kMaxCullRect) {}
+
+  void setAntiAlias(bool aa) override {
+    if (defer_attributes_) {
+      attributes_.setAntiAlias(aa);
+    } else {
+      receiver_.setAntiAlias(aa);
+    }
+  }
+  void setDrawStyle(DlDrawStyle style) override {
+    if (defer_attributes_) {
+      attributes_.setDrawStyle(style);
+    } else {
+      receiver_.setDrawStyle(style);
+    }
+  }
+  void setColor(DlColor color) override {
+    if (defer_attributes_) {
+      attributes_.setColor(color);
+    } else {
+      receiver_.setColor(color);
+    }
+  }
+  void setStrokeWidth(float width) override {
+    if (defer_attributes_) {
+      attributes_.setStrokeWidth(width);
+    } else {
+      receiver_.setStrokeWidth(width);
+    }
+  }
+  void setStrokeMiter(float limit) override {
+    if (defer_attributes_) {
+      attributes_.setStrokeMiter(limit);
+    } else {
+      receiver_.setStrokeMiter(limit);
+    }
+  }
+  void setStrokeCap(DlStrokeCap cap) override {
+    if (defer_attributes_) {
+      attributes_.setStrokeCap(cap);
+    } else {
+      receiver_.setStrokeCap(cap);
+    }
+  }
+  void setStrokeJoin(DlStrokeJoin join) override {
+    if (defer_attributes_) {
+      attributes_.setStrokeJoin(join);
+    } else {
+      receiver_.setStrokeJoin(join);
+    }
+  }
+  void setColorSource(const DlColorSource* source) override {
+    if (defer_attributes_) {
+      attributes_.setColorSource(source);
+    } else {
+      receiver_.setColorSource(source);
+    }
+  }
+  void setColorFilter(const DlColorFilter* filter) override {
+    if (defer_attributes_) {
+      attributes_.setColorFilter(filter);
+    } else {
+      receiver_.setColorFilter(filter);
+    }
+  }
+  void setInvertColors(bool invert) override {
+    if (defer_attributes_) {
+      attributes_.setInvertColors(invert);
+    } else {
+      receiver_.setInvertColors(invert);
+    }
+  }
+  void setBlendMode(DlBlendMode mode) override {
+    if (defer_attributes_) {
+      attributes_.setBlendMode(mode);
+    } else {
+      receiver_.setBlendMode(mode);
+    }
+  }
+  void setMaskFilter(const DlMaskFilter* filter) override {
+    if (defer_attributes_) {
+      attributes_.setMaskFilter(filter);
+    } else {
+      receiver_.setMaskFilter(filter);
+    }
+  }
+  void setImageFilter(const DlImageFilter* filter) override {
+    if (defer_attributes_) {
+      attributes_.setImageFilter(filter);
+    } else {
+      receiver_.setImageFilter(filter);
+    }
+  }
+
+  void save() override {
+    FlushTransform();
+    receiver_.save();
+  }
+  void saveLayer(const DlRect& bounds,
+                 const SaveLayerOptions options,
+                 const DlImageFilter* backdrop,
+                 std::optional<int64_t> backdrop_id) override {
+    FlushTransform();
+    if (options.renders_with_attributes()) {
+      FlushAttributes();
+    }
+    receiver_.saveLayer(bounds, options, backdrop, backdrop_id);
+  }
+  void restore() override {
+    DiscardTransform();
+    receiver_.restore();
+  }
+
+  void translate(DlScalar tx, DlScalar ty) override {
+    if (fold_transforms_) {
+      pending_transform_.translate(tx, ty);
+      has_pending_transform_ = true;
+    } else {
+      receiver_.translate(tx, ty);
+    }
+  }
+  void scale(DlScalar sx, DlScalar sy) override {
+    if (fold_transforms_) {
+      pending_transform_.scale(sx, sy);
+      has_pending_transform_ = true;
+    } else {
+      receiver_.scale(sx, sy);
+    }
+  }
+  void rotate(DlScalar degrees) override {
+    if (fold_transforms_) {
+      pending_transform_.rotate(degrees);
+      has_pending_transform_ = true;
+    } else {
+      receiver_.rotate(degrees);
+    }
+  }
+  void skew(DlScalar sx, DlScalar sy) override {
+    if (fold_transforms_) {
+      pending_transform_.skew(sx, sy);
+      has_pending_transform_ = true;
+    } else {
+      receiver_.skew(sx, sy);
+    }
+  }
+  // clang-format off
+  void transform2DAffine(DlScalar mxx, DlScalar mxy, DlScalar mxt,
+                         DlScalar myx, DlScalar myy, DlScalar myt) override {
+    if (fold_transforms_) {
+      pending_transform_.transform2DAffine(mxx, mxy, mxt, myx, myy, myt);
+      has_pending_transform_ = true;
+    } else {
+      receiver_.transform2DAffine(mxx, mxy, mxt, myx, myy, myt);
+    }
+  }
+  void transformFullPerspective(
+      DlScalar mxx, DlScalar mxy, DlScalar mxz, DlScalar mxt,
+      DlScalar myx, DlScalar myy, DlScalar myz, DlScalar myt,
+      DlScalar mzx, DlScalar mzy, DlScalar mzz, DlScalar mzt,
+      DlScalar mwx, DlScalar mwy, DlScalar mwz, DlScalar mwt) override {
+    if (fold_transforms_) {
+      pending_transform_.transformFullPerspective(mxx, mxy, mxz, mxt,
+                                                  myx, myy, myz, myt,
+                                                  mzx, mzy, mzz, mzt,
+                                                  mwx, mwy, mwz, mwt);
+      has_pending_transform_ = true;
+    } else {
+      receiver_.transformFullPerspective(mxx, mxy, mxz, mxt,
+                                         myx, myy, myz, myt,
+                                         mzx, mzy, mzz, mzt,
+                                         mwx, mwy, mwz, mwt);
+    }
+  }
+  // clang-format on
+  void transformReset() override {
+    DiscardTransform();
+    receiver_.transformReset();
+  }
+
+  void clipRect(const DlRect& rect, ClipOp clip_op, bool is_aa) override {
+    FlushTransform();
+    receiver_.clipRect(rect, clip_op, is_aa);
+  }
+  void clipOval(const DlRect& bounds, ClipOp clip_op, bool is_aa) override {
+    FlushTransform();
+    receiver_.clipOval(bounds, clip_op, is_aa);
+  }
+  void clipRoundRect(const DlRoundRect& rrect,
+                     ClipOp clip_op,
+                     bool is_aa) override {
+    FlushTransform();
+    receiver_.clipRoundRect(rrect, clip_op, is_aa);
+  }
+  void clipPath(const DlPath& path, ClipOp clip_op, bool is_aa) override {
+    FlushTransform();
+    receiver_.clipPath(path, clip_op, is_aa);
+  }
+
+  // drawColor fills the clip regardless of the transform and attributes.
+  void drawColor(DlColor color, DlBlendMode mode) override {
+    receiver_.drawColor(color, mode);
+  }
+  void drawPaint() override {
+    FlushForDraw(true);
+    receiver_.drawPaint();
+  }
+  void drawLine(const DlPoint& p0, const DlPoint& p1) override {
+    FlushForDraw(true);
+    receiver_.drawLine(p0, p1);
+  }
+  void drawDashedLine(const DlPoint& p0,
+                      const DlPoint& p1,
+                      DlScalar on_length,
+                      DlScalar off_length) override {
+    FlushForDraw(true);
+    receiver_.drawDashedLine(p0, p1, on_length, off_length);
+  }
+  void drawRect(const DlRect& rect) override {
+    FlushForDraw(true);
+    receiver_.drawRect(rect);
+  }
+  void drawOval(const DlRect& bounds) override {
+    FlushForDraw(true);
+    receiver_.drawOval(bounds);
+  }
+  void drawCircle(const DlPoint& center, DlScalar radius) override {
+    FlushForDraw(true);
+    receiver_.drawCircle(center, radius);
+  }
+  void drawRoundRect(const DlRoundRect& rrect) override {
+    FlushForDraw(true);
+    receiver_.drawRoundRect(rrect);
+  }
+  void drawDiffRoundRect(const DlRoundRect& outer,
+                         const DlRoundRect& inner) override {
+    FlushForDraw(true);
+    receiver_.drawDiffRoundRect(outer, inner);
+  }
+  void drawPath(const DlPath& path) override {
+    FlushForDraw(true);
+    receiver_.drawPath(path);
+  }
+  void drawArc(const DlRect& oval_bounds,
+               DlScalar start_degrees,
+               DlScalar sweep_degrees,
+               bool use_center) override {
+    FlushForDraw(true);
+    receiver_.drawArc(oval_bounds, start_degrees, sweep_degrees, use_center);
+  }
+  void drawPoints(PointMode mode,
+                  uint32_t count,
+                  const DlPoint points[]) override {
+    FlushForDraw(true);
+    receiver_.drawPoints(mode, count, points);
+  }
+  void drawVertices(const std::shared_ptr<DlVertices>& vertices,
+                    DlBlendMode mode) override {
+    FlushForDraw(true);
+    receiver_.drawVertices(vertices, mode);
+  }
+  void drawImage(const sk_sp<DlImage> image,
+                 const DlPoint& point,
+                 DlImageSampling sampling,
+                 bool render_with_attributes) override {
+    FlushForDraw(render_with_attributes);
+    receiver_.drawImage(image, point, sampling, render_with_attributes);
+  }
+  void drawImageRect(const sk_sp<DlImage> image,
+                     const DlRect& src,
+                     const DlRect& dst,
+                     DlImageSampling sampling,
+                     bool render_with_attributes,
+                     SrcRectConstraint constraint) override {
+    FlushForDraw(render_with_attributes);
+    receiver_.drawImageRect(image, src, dst, sampling, render_with_attributes,
+                            constraint);
+  }
+  void drawImageNine(const sk_sp<DlImage> image,
+                     const DlIRect& center,
+                     const DlRect& dst,
+                     DlFilterMode filter,
+                     bool render_with_attributes) override {
+    FlushForDraw(render_with_attributes);
+    receiver_.drawImageNine(image, center, dst, filter,
+                            render_with_attributes);
+  }
+  void drawAtlas(const sk_sp<DlImage> atlas,
+                 const SkRSXform xform[],
+                 const DlRect tex[],
+                 const DlColor colors[],
+                 int count,
+                 DlBlendMode mode,
+                 DlImageSampling sampling,
+                 const DlRect* cull_rect,
+                 bool render_with_attributes) override {
+    FlushForDraw(render_with_attributes);
+    receiver_.drawAtlas(atlas, xform, tex, colors, count, mode, sampling,
+                        cull_rect, render_with_attributes);
+  }
+  void drawDisplayList(const sk_sp<DisplayList> display_list,
+                       DlScalar opacity) override {
+    FlushForDraw(false);
+    receiver_.drawDisplayList(display_list, opacity);
+  }
+  void drawTextBlob(const sk_sp<SkTextBlob> blob,
+                    DlScalar x,
+                    DlScalar y) override {
+    FlushForDraw(true);
+    receiver_.drawTextBlob(blob, x, y);
+  }
+  void drawTextFrame(const std::shared_ptr<impeller::TextFrame>& text_frame,
+                     DlScalar x,
+                     DlScalar y) override {
+    FlushForDraw(true);
+    receiver_.drawTextFrame(text_frame, x, y);
+  }
+  void drawShadow(const DlPath& path,
+                  const DlColor color,
+                  const DlScalar elevation,
+                  bool transparent_occluder,
+                  DlScalar dpr) override {
+    FlushForDraw(false);
+    receiver_.drawShadow(path, color, elevation, transparent_occluder, dpr);
+  }
+
+ private:
+  void FlushForDraw(bool uses_attributes) {
+    FlushTransform();
+    if (uses_attributes) {
+      FlushAttributes();
+    }
+  }
+
+  void FlushAttributes() {
+    if (!defer_attributes_) {
+      return;
+    }
+    // The color source is set before the color as the receiver may turn
+    // a color source of type kColor into a color.
+    receiver_.setColorSource(attributes_.getColorSourcePtr());
+    receiver_.setColor(attributes_.getColor());
+    receiver_.setAntiAlias(attributes_.isAntiAlias());
+    receiver_.setBlendMode(attributes_.getBlendMode());
+    receiver_.setDrawStyle(attributes_.getDrawStyle());
+    receiver_.setStrokeWidth(attributes_.getStrokeWidth());
+    receiver_.setStrokeMiter(attributes_.getStrokeMiter());
+    receiver_.setStrokeCap(attributes_.getStrokeCap());
+    receiver_.setStrokeJoin(attributes_.getStrokeJoin());
+    receiver_.setColorFilter(attributes_.getColorFilterPtr());
+    receiver_.setInvertColors(attributes_.isInvertColors());
+    receiver_.setImageFilter(attributes_.getImageFilterPtr());
+    receiver_.setMaskFilter(attributes_.getMaskFilterPtr());
+  }
+
+  void FlushTransform() {
+    if (!has_pending_transform_) {
+      return;
+    }
+    const DlMatrix m = pending_transform_.matrix();
+    DiscardTransform();
+    if (m.IsIdentity()) {
+      return;
+    }
+    if (!m.IsAffine()) {
+      // clang-format off
+      receiver_.transformFullPerspective(m.m[0], m.m[4], m.m[8],  m.m[12],
+                                         m.m[1], m.m[5], m.m[9],  m.m[13],
+                                         m.m[2], m.m[6], m.m[10], m.m[14],
+                                         m.m[3], m.m[7], m.m[11], m.m[15]);
+      // clang-format on
+    } else if (m.m[1] != 0.0f || m.m[4] != 0.0f) {
+      receiver_.transform2DAffine(m.m[0], m.m[4], m.m[12],  //
+                                  m.m[1], m.m[5], m.m[13]);
+    } else if (m.m[0] == 1.0f && m.m[5] == 1.0f) {
+      receiver_.translate(m.m[12], m.m[13]);
+    } else if (m.m[12] == 0.0f && m.m[13] == 0.0f) {
+      receiver_.scale(m.m[0], m.m[5]);
+    } else {
+      receiver_.transform2DAffine(m.m[0], 0.0f, m.m[12],  //
+                                  0.0f, m.m[5], m.m[13]);
+    }
+  }
+
+  void DiscardTransform() {
+    pending_transform_.setIdentity();
+    has_pending_transform_ = false;
+  }
+
+  DlOpReceiver& receiver_;
+  const bool defer_attributes_;
+  const bool fold_transforms_;
+
+  DlPaint attributes_;
+  DisplayListMatrixClipState pending_transform_;
+  bool has_pending_transform_ = false;
+};
+
+void CountOps(const DisplayList& display_list,
+              uint32_t* attributes,
+              uint32_t* transforms,
+              uint32_t* saves) {
+  for (DlIndex i : display_list) {
+    switch (display_list.GetOpCategory(i)) {
+      case DisplayListOpCategory::kAttribute:
+        (*attributes)++;
+        break;
+      case DisplayListOpCategory::kTransform:
+        (*transforms)++;
+        break;
+      case DisplayListOpCategory::kSave:
+        (*saves)++;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+uint32_t CountRemoved(uint32_t before, uint32_t after) {
+  return before > after ? before - after : 0u;
+}
+
+}  // namespace
+
+sk_sp<DisplayList> DlOptimizer::Optimize(
+    const sk_sp<DisplayList>& display_list,
+    const Options& options,
+    Stats* stats) {
+  Stats unchanged;
+  unchanged.record_count_before = display_list->GetRecordCount();
+  unchanged.record_count_after = unchanged.record_count_before;
+  unchanged.bytes_before = display_list->bytes();
+  unchanged.bytes_after = unchanged.bytes_before;
+  if (stats) {
+    *stats = unchanged;
+  }
+
+  Stats result = unchanged;
+  std::vector<bool> occluded;
+  if (options.cull_occluded_ops) {
+    occluded = FindOccludedOps(*display_list, &result.ops_culled);
+  }
+  if (!options.eliminate_dead_attributes && !options.fold_transforms &&
+      result.ops_culled == 0u) {
+    return display_list;
+  }
+
+  DisplayListBuilder builder(display_list->has_rtree());
+  OptimizingReceiver receiver(builder.asReceiver(), options);
+  for (DlIndex i : *display_list) {
+    if (!occluded.empty() && occluded[i]) {
+      continue;
+    }
+    display_list->Dispatch(receiver, i);
+  }
+  sk_sp<DisplayList> optimized = builder.Build();
+  // Dead attributes are records but not ops, so only comparing the op
+  // counts would discard lists that only lost attributes.
+  if (optimized->GetRecordCount() >= display_list->GetRecordCount()) {
+    return display_list;
+  }
+
+  if (stats) {
+    uint32_t attributes_before = 0u;
+    uint32_t transforms_before = 0u;
+    uint32_t saves_before = 0u;
+    CountOps(*display_list, &attributes_before, &transforms_before,
+             &saves_before);
+    uint32_t attributes_after = 0u;
+    uint32_t transforms_after = 0u;
+    uint32_t saves_after = 0u;
+    CountOps(*optimized, &attributes_after, &transforms_after, &saves_after);
+    result.attributes_removed =
+        CountRemoved(attributes_before, attributes_after);
+    result.transforms_removed =
+        CountRemoved(transforms_before, transforms_after);
+    result.saves_removed = CountRemoved(saves_before, saves_after);
+    result.record_count_after = optimized->GetRecordCount();
+    result.bytes_after = optimized->bytes();
+    *stats = result;
+  }
+  return optimized;
+}
+
+}  // namespace flutter
@@ -0,0 +1,82 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_DISPLAY_LIST_DL_OPTIMIZER_H_
+#define FLUTTER_DISPLAY_LIST_DL_OPTIMIZER_H_
+
+#include "flutter/display_list/display_list.h"
+
+namespace flutter {
+
+// Rewrites a DisplayList into an equivalent list with fewer ops so that
+// a list which is dispatched many times, or a very large list recorded
+// by the framework on a heavy frame, is cheaper to dispatch on the raster
+// thread.
+//
+// The DisplayListBuilder already avoids recording attributes that do not
+// change and saves that do not need to be restored, but it has to record
+// everything else as it arrives. Once the whole list is known the
+// optimizer can additionally remove:
+//
+// - Dead attributes:
+//     Attribute values that are replaced before any rendering op uses
+//     them.
+// - Occluded ops:
+//     Rendering ops that are completely covered by a later opaque
+//     |drawPaint|, |drawColor| or |drawRect| that is not inside a
+//     saveLayer. The candidates are found by querying the RTree of the
+//     list so this pass only runs on lists built with an RTree.
+// - Redundant transforms:
+//     Runs of consecutive transform ops are folded into a single op, runs
+//     that compose to the identity are removed along with any save and
+//     restore pair that then no longer does anything, and transforms that
+//     are restored before they are used are dropped.
+//
+// The optimized list renders identically to the original, but the ops it
+// contains are different so it will not compare equal to it. Lists that
+// are compared from frame to frame (for instance by the raster cache or
+// by the diff context) should be compared before being optimized.
+class DlOptimizer {
+ public:
+  struct Options {
+    bool eliminate_dead_attributes = true;
+    bool cull_occluded_ops = true;
+    bool fold_transforms = true;
+  };
+
+  // The number of ops removed by each of the passes.
+  struct Stats {
+    uint32_t attributes_removed = 0u;
+    uint32_t ops_culled = 0u;
+    uint32_t transforms_removed = 0u;
+    uint32_t saves_removed = 0u;
+
+    // The number of records, including attribute, transform and save ops,
+    // which |DisplayList::op_count| leaves out.
+    uint32_t record_count_before = 0u;
+    uint32_t record_count_after = 0u;
+    size_t bytes_before = 0u;
+    size_t bytes_after = 0u;
+  };
+
+  // Returns an optimized version of |display_list|, or |display_list|
+  // itself if none of the enabled passes could remove any ops. Nested
+  // DisplayLists are left as they are.
+  //
+  // If |stats| is non-null it is filled in with the results of the
+  // passes.
+  static sk_sp<DisplayList> Optimize(const sk_sp<DisplayList>& display_list,
+                                     const Options& options,
+                                     Stats* stats = nullptr);
+  static sk_sp<DisplayList> Optimize(const sk_sp<DisplayList>& display_list) {
+    return Optimize(display_list, Options());
+  }
+
+ private:
+  DlOptimizer() = delete;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_DISPLAY_LIST_DL_OPTIMIZER_H_
@@ -0,0 +1,256 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/display_list/dl_optimizer.h"
+
+#include "flutter/display_list/dl_builder.h"
+#include "flutter/display_list/testing/dl_test_snippets.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+
+DlOpReceiver& DisplayListBuilderTestingAccessor(DisplayListBuilder& builder);
+
+namespace testing {
+
+TEST(DisplayListOptimizer, ReturnsOriginalWhenNothingCanBeRemoved) {
+  DisplayListBuilder builder(true);
+  builder.Translate(10, 10);
+  builder.DrawRect(SkRect::MakeLTRB(0, 0, 10, 10), DlPaint(DlColor::kRed()));
+  builder.DrawCircle(DlPoint(50, 50), 10, DlPaint(DlColor::kBlue()));
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DlOptimizer::Stats stats;
+  sk_sp<DisplayList> optimized =
+      DlOptimizer::Optimize(display_list, DlOptimizer::Options(), &stats);
+  EXPECT_EQ(optimized, display_list);
+  EXPECT_EQ(stats.record_count_before, display_list->GetRecordCount());
+  EXPECT_EQ(stats.record_count_after, display_list->GetRecordCount());
+  EXPECT_EQ(stats.attributes_removed, 0u);
+  EXPECT_EQ(stats.ops_culled, 0u);
+  EXPECT_EQ(stats.transforms_removed, 0u);
+  EXPECT_EQ(stats.saves_removed, 0u);
+}
+
+TEST(DisplayListOptimizer, RemovesDeadAttributes) {
+  DisplayListBuilder builder;
+  DlOpReceiver& receiver = DisplayListBuilderTestingAccessor(builder);
+  receiver.setColor(DlColor::kRed());
+  receiver.setBlendMode(DlBlendMode::kMultiply);
+  receiver.setColor(DlColor::kBlue());
+  receiver.setBlendMode(DlBlendMode::kSrcOver);
+  receiver.drawRect(DlRect::MakeLTRB(0, 0, 10, 10));
+  receiver.setColor(DlColor::kGreen());
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListBuilder expected_builder;
+  expected_builder.DrawRect(SkRect::MakeLTRB(0, 0, 10, 10),
+                            DlPaint(DlColor::kBlue()));
+  sk_sp<DisplayList> expected = expected_builder.Build();
+
+  DlOptimizer::Stats stats;
+  sk_sp<DisplayList> optimized =
+      DlOptimizer::Optimize(display_list, DlOptimizer::Options(), &stats);
+  EXPECT_TRUE(optimized->Equals(expected));
+  EXPECT_EQ(stats.attributes_removed, 4u);
+  EXPECT_EQ(stats.record_count_before, 6u);
+  EXPECT_EQ(stats.record_count_after, 2u);
+  EXPECT_EQ(optimized->bounds(), display_list->bounds());
+}
+
+TEST(DisplayListOptimizer, CullsOpsHiddenByOpaqueCovers) {
+  DisplayListBuilder builder(true);
+  builder.DrawRect(SkRect::MakeLTRB(10, 10, 20, 20), DlPaint(DlColor::kRed()));
+  builder.DrawCircle(DlPoint(50, 50), 10, DlPaint(DlColor::kGreen()));
+  builder.DrawRect(SkRect::MakeLTRB(0, 0, 100, 100),
+                   DlPaint(DlColor::kBlue()));
+  builder.DrawCircle(DlPoint(50, 50), 5, DlPaint(DlColor::kYellow()));
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListBuilder expected_builder(true);
+  expected_builder.DrawRect(SkRect::MakeLTRB(0, 0, 100, 100),
+                            DlPaint(DlColor::kBlue()));
+  expected_builder.DrawCircle(DlPoint(50, 50), 5,
+                              DlPaint(DlColor::kYellow()));
+  sk_sp<DisplayList> expected = expected_builder.Build();
+
+  DlOptimizer::Stats stats;
+  sk_sp<DisplayList> optimized =
+      DlOptimizer::Optimize(display_list, DlOptimizer::Options(), &stats);
+  EXPECT_TRUE(optimized->Equals(expected));
+  EXPECT_EQ(stats.ops_culled, 2u);
+  EXPECT_EQ(optimized->bounds(), display_list->bounds());
+  EXPECT_TRUE(optimized->has_rtree());
+}
+
+TEST(DisplayListOptimizer, CoversAreLimitedToTheirClip) {
+  DisplayListBuilder builder(true);
+  builder.DrawRect(SkRect::MakeLTRB(10, 10, 20, 20), DlPaint(DlColor::kRed()));
+  builder.DrawRect(SkRect::MakeLTRB(60, 60, 70, 70), DlPaint(DlColor::kRed()));
+  builder.Save();
+  builder.ClipRect(SkRect::MakeLTRB(0, 0, 50, 50));
+  builder.DrawPaint(DlPaint(DlColor::kBlue()));
+  builder.Restore();
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DlOptimizer::Stats stats;
+  DlOptimizer::Optimize(display_list, DlOptimizer::Options(), &stats);
+  EXPECT_EQ(stats.ops_culled, 1u);
+}
+
+TEST(DisplayListOptimizer, DoesNotCullBeneathNonOpaqueCovers) {
+  DlPaint translucent(DlColor::kBlue().withAlpha(0x80));
+  DlPaint stroked(DlColor::kBlue());
+  stroked.setDrawStyle(DlDrawStyle::kStroke);
+  DlPaint multiply(DlColor::kBlue());
+  multiply.setBlendMode(DlBlendMode::kMultiply);
+  DlPaint blurred(DlColor::kBlue());
+  blurred.setMaskFilter(DlBlurMaskFilter::Make(DlBlurStyle::kNormal, 2.0f));
+
+  for (const DlPaint& cover : {translucent, stroked, multiply, blurred}) {
+    DisplayListBuilder builder(true);
+    builder.DrawRect(SkRect::MakeLTRB(10, 10, 20, 20),
+                     DlPaint(DlColor::kRed()));
+    builder.DrawRect(SkRect::MakeLTRB(0, 0, 100, 100), cover);
+    sk_sp<DisplayList> display_list = builder.Build();
+
+    DlOptimizer::Stats stats;
+    DlOptimizer::Optimize(display_list, DlOptimizer::Options(), &stats);
+    EXPECT_EQ(stats.ops_culled, 0u);
+  }
+}
+
+TEST(DisplayListOptimizer, DoesNotCullAcrossLayers) {
+  {
+    // Ops inside a layer are composited as a group.
+    DisplayListBuilder builder(true);
+    builder.SaveLayer(nullptr, nullptr);
+    builder.DrawRect(SkRect::MakeLTRB(10, 10, 20, 20),
+                     DlPaint(DlColor::kRed()));
+    builder.Restore();
+    builder.DrawPaint(DlPaint(DlColor::kBlue()));
+    sk_sp<DisplayList> display_list = builder.Build();
+
+    DlOptimizer::Stats stats;
+    DlOptimizer::Optimize(display_list, DlOptimizer::Options(), &stats);
+    EXPECT_EQ(stats.ops_culled, 0u);
+  }
+  {
+    // A cover inside a layer only covers the contents of the layer.
+    DisplayListBuilder builder(true);
+    builder.DrawRect(SkRect::MakeLTRB(10, 10, 20, 20),
+                     DlPaint(DlColor::kRed()));
+    DlPaint layer_paint(DlColor::kBlack().withAlpha(0x80));
+    builder.SaveLayer(nullptr, &layer_paint);
+    builder.DrawPaint(DlPaint(DlColor::kBlue()));
+    builder.Restore();
+    sk_sp<DisplayList> display_list = builder.Build();
+
+    DlOptimizer::Stats stats;
+    DlOptimizer::Optimize(display_list, DlOptimizer::Options(), &stats);
+    EXPECT_EQ(stats.ops_culled, 0u);
+  }
+  {
+    // A backdrop filter may spread covered pixels outside of the cover.
+    DisplayListBuilder builder(true);
+    builder.DrawRect(SkRect::MakeLTRB(10, 10, 20, 20),
+                     DlPaint(DlColor::kRed()));
+    auto backdrop = DlBlurImageFilter::Make(5.0f, 5.0f, DlTileMode::kDecal);
+    builder.SaveLayer(nullptr, nullptr, backdrop.get());
+    builder.Restore();
+    builder.DrawRect(SkRect::MakeLTRB(0, 0, 50, 50),
+                     DlPaint(DlColor::kBlue()));
+    sk_sp<DisplayList> display_list = builder.Build();
+
+    DlOptimizer::Stats stats;
+    DlOptimizer::Optimize(display_list, DlOptimizer::Options(), &stats);
+    EXPECT_EQ(stats.ops_culled, 0u);
+  }
+}
+
+TEST(DisplayListOptimizer, DoesNotCullWithoutRTree) {
+  DisplayListBuilder builder(false);
+  builder.DrawRect(SkRect::MakeLTRB(10, 10, 20, 20), DlPaint(DlColor::kRed()));
+  builder.DrawPaint(DlPaint(DlColor::kBlue()));
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DlOptimizer::Stats stats;
+  sk_sp<DisplayList> optimized =
+      DlOptimizer::Optimize(display_list, DlOptimizer::Options(), &stats);
+  EXPECT_EQ(stats.ops_culled, 0u);
+  EXPECT_EQ(optimized, display_list);
+}
+
+TEST(DisplayListOptimizer, FoldsTransforms) {
+  DisplayListBuilder builder;
+  builder.Translate(10, 20);
+  builder.Scale(2, 3);
+  builder.DrawRect(SkRect::MakeLTRB(0, 0, 10, 10), DlPaint());
+  builder.Save();
+  builder.Translate(5, 5);
+  builder.Translate(-5, -5);
+  builder.DrawRect(SkRect::MakeLTRB(20, 20, 30, 30), DlPaint());
+  builder.Restore();
+  builder.Save();
+  builder.Rotate(45);
+  builder.Restore();
+  builder.Translate(100, 0);
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListBuilder expected_builder;
+  expected_builder.Transform2DAffine(2, 0, 10,  //
+                                     0, 3, 20);
+  expected_builder.DrawRect(SkRect::MakeLTRB(0, 0, 10, 10), DlPaint());
+  expected_builder.DrawRect(SkRect::MakeLTRB(20, 20, 30, 30), DlPaint());
+  sk_sp<DisplayList> expected = expected_builder.Build();
+
+  DlOptimizer::Stats stats;
+  sk_sp<DisplayList> optimized =
+      DlOptimizer::Optimize(display_list, DlOptimizer::Options(), &stats);
+  EXPECT_TRUE(optimized->Equals(expected));
+  EXPECT_EQ(stats.transforms_removed, 5u);
+  EXPECT_EQ(stats.saves_removed, 2u);
+  EXPECT_EQ(optimized->bounds(), display_list->bounds());
+}
+
+TEST(DisplayListOptimizer, PassesCanBeDisabled) {
+  DisplayListBuilder builder(true);
+  builder.Translate(10, 0);
+  builder.Translate(0, 10);
+  builder.DrawRect(SkRect::MakeLTRB(10, 10, 20, 20), DlPaint(DlColor::kRed()));
+  builder.DrawPaint(DlPaint(DlColor::kBlue()));
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DlOptimizer::Options options;
+  options.cull_occluded_ops = false;
+  DlOptimizer::Stats stats;
+  DlOptimizer::Optimize(display_list, options, &stats);
+  EXPECT_EQ(stats.ops_culled, 0u);
+  EXPECT_EQ(stats.transforms_removed, 1u);
+
+  options = DlOptimizer::Options();
+  options.fold_transforms = false;
+  DlOptimizer::Optimize(display_list, options, &stats);
+  EXPECT_EQ(stats.ops_culled, 1u);
+  EXPECT_EQ(stats.transforms_removed, 0u);
+}
+
+TEST(DisplayListOptimizer, OptimizedListsKeepTheirBounds) {
+  for (auto& group : CreateAllGroups()) {
+    for (size_t i = 0; i < group.variants.size(); i++) {
+      auto desc = group.op_name + "(variant " + std::to_string(i + 1) + ")";
+      DisplayListBuilder builder(true);
+      group.variants[i].Invoke(DisplayListBuilderTestingAccessor(builder));
+      sk_sp<DisplayList> display_list = builder.Build();
+
+      sk_sp<DisplayList> optimized = DlOptimizer::Optimize(display_list);
+      ASSERT_NE(optimized, nullptr) << desc;
+      EXPECT_EQ(optimized->bounds(), display_list->bounds()) << desc;
+      EXPECT_LE(optimized->op_count(), display_list->op_count()) << desc;
+    }
+  }
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,1602 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/display_list/dl_serializer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "flutter/display_list/dl_builder.h"
+#include "flutter/display_list/dl_op_receiver.h"
+#include "flutter/fml/logging.h"
+
+namespace flutter {
+
+namespace {
+
+// The values of these tags are part of the format. New tags may only be
+// added at the end and DlSerializer::kVersion must be incremented if the
+// encoding of any existing record changes.
+enum class Tag : uint32_t {
+  kSetAntiAlias,
+  kSetDrawStyle,
+  kSetColor,
+  kSetStrokeWidth,
+  kSetStrokeMiter,
+  kSetStrokeCap,
+  kSetStrokeJoin,
+  kSetColorSource,
+  kSetColorFilter,
+  kSetInvertColors,
+  kSetBlendMode,
+  kSetMaskFilter,
+  kSetImageFilter,
+
+  kSave,
+  kSaveLayer,
+  kRestore,
+
+  kTranslate,
+  kScale,
+  kRotate,
+  kSkew,
+  kTransform2DAffine,
+  kTransformFullPerspective,
+  kTransformReset,
+
+  kClipRect,
+  kClipOval,
+  kClipRoundRect,
+  kClipPath,
+
+  kDrawColor,
+  kDrawPaint,
+  kDrawLine,
+  kDrawDashedLine,
+  kDrawRect,
+  kDrawOval,
+  kDrawCircle,
+  kDrawRoundRect,
+  kDrawDiffRoundRect,
+  kDrawPath,
+  kDrawArc,
+  kDrawPoints,
+  kDrawVertices,
+  kDrawDisplayList,
+  kDrawShadow,
+};
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t flags;
+  uint32_t record_count;
+};
+
+struct RecordHeader {
+  uint32_t tag;
+  // The number of bytes of record data that follow the header, always
+  // a multiple of 4 so that every record starts on a 4 byte boundary.
+  uint32_t size;
+};
+
+constexpr uint32_t kHeaderHasRTree = 1u << 0;
+
+constexpr uint32_t kSaveLayerRendersWithAttributes = 1u << 0;
+constexpr uint32_t kSaveLayerBoundsFromCaller = 1u << 1;
+constexpr uint32_t kSaveLayerHasBackdropId = 1u << 2;
+
+constexpr uint32_t kVerticesHasTextureCoordinates = 1u << 0;
+constexpr uint32_t kVerticesHasColors = 1u << 1;
+constexpr uint32_t kMaxVertexCount = std::numeric_limits<int>::max();
+
+// Written in place of the type of an attribute that is not set.
+constexpr uint32_t kNoAttribute = 0xffffffffu;
+
+// Limits the nesting of image filters and display lists so that malformed
+// data cannot recurse without bound.
+constexpr int kMaxNestingDepth = 32;
+
+class DlWriter {
+ public:
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    WriteBytes(&value, sizeof(T));
+  }
+
+  template <typename T>
+  void WriteAt(size_t offset, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    FML_DCHECK(offset + sizeof(T) <= data_.size());
+    memcpy(data_.data() + offset, &value, sizeof(T));
+  }
+
+  void WriteBytes(const void* bytes, size_t size) {
+    auto begin = static_cast<const uint8_t*>(bytes);
+    data_.insert(data_.end(), begin, begin + size);
+  }
+
+  void Align() { data_.resize((data_.size() + 3u) & ~size_t{3u}, 0u); }
+
+  size_t size() const { return data_.size(); }
+
+  std::vector<uint8_t> TakeData() { return std::move(data_); }
+
+ private:
+  std::vector<uint8_t> data_;
+};
+
+class DlReader {
+ public:
+  DlReader() : DlReader(nullptr, 0u) {}
+  DlReader(const uint8_t* data, size_t size)
+      : start_(data), ptr_(data), end_(data + size) {}
+
+  size_t remaining() const { return end_ - ptr_; }
+
+  template <typename T>
+  bool Read(T* value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (remaining() < sizeof(T)) {
+      return false;
+    }
+    memcpy(value, ptr_, sizeof(T));
+    ptr_ += sizeof(T);
+    return true;
+  }
+
+  // Returns a pointer to |count| values stored in place in the source
+  // data, or nullptr if the data is too short to hold them.
+  template <typename T>
+  const T* ReadArray(size_t count) {
+    static_assert(alignof(T) <= 4u);
+    if (count > remaining() / sizeof(T)) {
+      return nullptr;
+    }
+    const T* values = reinterpret_cast<const T*>(ptr_);
+    ptr_ += count * sizeof(T);
+    Align();
+    return values;
+  }
+
+  // Returns a reader for the next |size| bytes and skips past them.
+  bool ReadSubReader(size_t size, DlReader* reader) {
+    if (size > remaining()) {
+      return false;
+    }
+    *reader = DlReader(ptr_, size);
+    ptr_ += size;
+    return true;
+  }
+
+  void Align() {
+    size_t offset = ((ptr_ - start_) + 3u) & ~size_t{3u};
+    ptr_ = start_ + std::min(offset, static_cast<size_t>(end_ - start_));
+  }
+
+ private:
+  const uint8_t* start_;
+  const uint8_t* ptr_;
+  const uint8_t* end_;
+};
+
+template <typename T>
+bool ReadEnum(DlReader& reader, T* value, T last) {
+  uint32_t raw;
+  if (!reader.Read(&raw) || raw > static_cast<uint32_t>(last)) {
+    return false;
+  }
+  *value = static_cast<T>(raw);
+  return true;
+}
+
+template <typename T>
+void WriteEnum(DlWriter& writer, T value) {
+  writer.Write(static_cast<uint32_t>(value));
+}
+
+bool ReadBool(DlReader& reader, bool* value) {
+  uint32_t raw;
+  if (!reader.Read(&raw) || raw > 1u) {
+    return false;
+  }
+  *value = raw != 0u;
+  return true;
+}
+
+void WriteBool(DlWriter& writer, bool value) {
+  writer.Write(static_cast<uint32_t>(value ? 1u : 0u));
+}
+
+void WritePoint(DlWriter& writer, const DlPoint& point) {
+  writer.Write(point.x);
+  writer.Write(point.y);
+}
+
+bool ReadPoint(DlReader& reader, DlPoint* point) {
+  return reader.Read(&point->x) && reader.Read(&point->y);
+}
+
+void WriteRect(DlWriter& writer, const DlRect& rect) {
+  writer.Write(rect.GetLeft());
+  writer.Write(rect.GetTop());
+  writer.Write(rect.GetRight());
+  writer.Write(rect.GetBottom());
+}
+
+bool ReadRect(DlReader& reader, DlRect* rect) {
+  DlScalar ltrb[4];
+  if (!reader.Read(&ltrb)) {
+    return false;
+  }
+  *rect = DlRect::MakeLTRB(ltrb[0], ltrb[1], ltrb[2], ltrb[3]);
+  return true;
+}
+
+void WriteRoundRect(DlWriter& writer, const DlRoundRect& rrect) {
+  WriteRect(writer, rrect.GetBounds());
+  const impeller::RoundingRadii& radii = rrect.GetRadii();
+  for (const impeller::Size& radius : {radii.top_left, radii.top_right,
+                                       radii.bottom_left, radii.bottom_right}) {
+    writer.Write(radius.width);
+    writer.Write(radius.height);
+  }
+}
+
+bool ReadRoundRect(DlReader& reader, DlRoundRect* rrect) {
+  DlRect bounds;
+  DlScalar radii[8];
+  if (!ReadRect(reader, &bounds) || !reader.Read(&radii)) {
+    return false;
+  }
+  *rrect = DlRoundRect::MakeRectRadii(
+      bounds, {
+                  .top_left = impeller::Size(radii[0], radii[1]),
+                  .top_right = impeller::Size(radii[2], radii[3]),
+                  .bottom_left = impeller::Size(radii[4], radii[5]),
+                  .bottom_right = impeller::Size(radii[6], radii[7]),
+              });
+  return true;
+}
+
+void WriteColor(DlWriter& writer, const DlColor& color) {
+  writer.Write(color.getAlphaF());
+  writer.Write(color.getRedF());
+  writer.Write(color.getGreenF());
+  writer.Write(color.getBlueF());
+  WriteEnum(writer, color.getColorSpace());
+}
+
+bool ReadColor(DlReader& reader, DlColor* color) {
+  DlScalar argb[4];
+  DlColorSpace color_space;
+  if (!reader.Read(&argb) ||
+      !ReadEnum(reader, &color_space, DlColorSpace::kDisplayP3)) {
+    return false;
+  }
+  *color = DlColor(argb[0], argb[1], argb[2], argb[3], color_space);
+  return true;
+}
+
+void WriteMatrix(DlWriter& writer, const SkMatrix& matrix) {
+  SkScalar values[9];
+  matrix.get9(values);
+  writer.Write(values);
+}
+
+bool ReadMatrix(DlReader& reader, SkMatrix* matrix) {
+  SkScalar values[9];
+  if (!reader.Read(&values)) {
+    return false;
+  }
+  matrix->set9(values);
+  return true;
+}
+
+void WritePath(DlWriter& writer, const DlPath& path) {
+  const SkPath& sk_path = path.GetSkPath();
+  size_t size = sk_path.writeToMemory(nullptr);
+  std::vector<uint8_t> bytes(size);
+  sk_path.writeToMemory(bytes.data());
+  writer.Write(static_cast<uint32_t>(size));
+  writer.WriteBytes(bytes.data(), size);
+  writer.Align();
+}
+
+bool ReadPath(DlReader& reader, DlPath* path) {
+  uint32_t size;
+  if (!reader.Read(&size)) {
+    return false;
+  }
+  const uint8_t* bytes = reader.ReadArray<uint8_t>(size);
+  if (!bytes) {
+    return false;
+  }
+  SkPath sk_path;
+  if (sk_path.readFromMemory(bytes, size) != size) {
+    return false;
+  }
+  *path = DlPath(sk_path);
+  return true;
+}
+
+void WriteGradient(DlWriter& writer, const DlGradientColorSourceBase* source) {
+  writer.Write(static_cast<uint32_t>(source->stop_count()));
+  WriteEnum(writer, source->tile_mode());
+  WriteMatrix(writer, source->matrix());
+  const DlColor* colors = source->colors();
+  for (int i = 0; i < source->stop_count(); i++) {
+    WriteColor(writer, colors[i]);
+  }
+  writer.WriteBytes(source->stops(), source->stop_count() * sizeof(float));
+}
+
+struct GradientData {
+  uint32_t stop_count;
+  DlTileMode tile_mode;
+  SkMatrix matrix;
+  std::vector<DlColor> colors;
+  const float* stops;
+};
+
+bool ReadGradient(DlReader& reader, GradientData* gradient) {
+  if (!reader.Read(&gradient->stop_count) ||
+      !ReadEnum(reader, &gradient->tile_mode, DlTileMode::kDecal) ||
+      !ReadMatrix(reader, &gradient->matrix)) {
+    return false;
+  }
+  // Every stop takes at least 6 words of data, which protects the
+  // allocation below from absurd counts.
+  if (gradient->stop_count > reader.remaining() / 24u) {
+    return false;
+  }
+  gradient->colors.resize(gradient->stop_count);
+  for (DlColor& color : gradient->colors) {
+    if (!ReadColor(reader, &color)) {
+      return false;
+    }
+  }
+  gradient->stops = reader.ReadArray<float>(gradient->stop_count);
+  return gradient->stops != nullptr;
+}
+
+bool WriteColorSource(DlWriter& writer, const DlColorSource* source) {
+  if (!source) {
+    writer.Write(kNoAttribute);
+    return true;
+  }
+  switch (source->type()) {
+    case DlColorSourceType::kColor:
+      WriteEnum(writer, source->type());
+      WriteColor(writer, source->asColor()->color());
+      return true;
+    case DlColorSourceType::kLinearGradient: {
+      const DlLinearGradientColorSource* linear = source->asLinearGradient();
+      WriteEnum(writer, source->type());
+      WritePoint(writer, linear->start_point());
+      WritePoint(writer, linear->end_point());
+      WriteGradient(writer, linear);
+      return true;
+    }
+    case DlColorSourceType::kRadialGradient: {
+      const DlRadialGradientColorSource* radial = source->asRadialGradient();
+      WriteEnum(writer, source->type());
+      WritePoint(writer, radial->center());
+      writer.Write(radial->radius());
+      WriteGradient(writer, radial);
+      return true;
+    }
+    case DlColorSourceType::kConicalGradient: {
+      const DlConicalGradientColorSource* conical =
+          source->asConicalGradient();
+      WriteEnum(writer, source->type());
+      WritePoint(writer, conical->start_center());
+      writer.Write(conical->start_radius());
+      WritePoint(writer, conical->end_center());
+      writer.Write(conical->end_radius());
+      WriteGradient(writer, conical);
+      return true;
+    }
+    case DlColorSourceType::kSweepGradient: {
+      const DlSweepGradientColorSource* sweep = source->asSweepGradient();
+      WriteEnum(writer, source->type());
+      WritePoint(writer, sweep->center());
+      writer.Write(sweep->start());
+      writer.Write(sweep->end());
+      WriteGradient(writer, sweep);
+      return true;
+    }
+    case DlColorSourceType::kImage:
+    case DlColorSourceType::kRuntimeEffect:
+      return false;
+  }
+  FML_UNREACHABLE();
+}
+
+bool ReadColorSource(DlReader& reader,
+                     std::shared_ptr<DlColorSource>* source) {
+  uint32_t raw_type;
+  if (!reader.Read(&raw_type)) {
+    return false;
+  }
+  if (raw_type == kNoAttribute) {
+    source->reset();
+    return true;
+  }
+  GradientData gradient;
+  switch (static_cast<DlColorSourceType>(raw_type)) {
+    case DlColorSourceType::kColor: {
+      DlColor color;
+      if (!ReadColor(reader, &color)) {
+        return false;
+      }
+      *source = std::make_shared<DlColorColorSource>(color);
+      return true;
+    }
+    case DlColorSourceType::kLinearGradient: {
+      DlPoint start;
+      DlPoint end;
+      if (!ReadPoint(reader, &start) || !ReadPoint(reader, &end) ||
+          !ReadGradient(reader, &gradient)) {
+        return false;
+      }
+      *source = DlColorSource::MakeLinear(
+          ToSkPoint(start), ToSkPoint(end), gradient.stop_count,
+          gradient.colors.data(), gradient.stops, gradient.tile_mode,
+          &gradient.matrix);
+      return true;
+    }
+    case DlColorSourceType::kRadialGradient: {
+      DlPoint center;
+      DlScalar radius;
+      if (!ReadPoint(reader, &center) || !reader.Read(&radius) ||
+          !ReadGradient(reader, &gradient)) {
+        return false;
+      }
+      *source = DlColorSource::MakeRadial(
+          ToSkPoint(center), radius, gradient.stop_count,
+          gradient.colors.data(), gradient.stops, gradient.tile_mode,
+          &gradient.matrix);
+      return true;
+    }
+    case DlColorSourceType::kConicalGradient: {
+      DlPoint start_center;
+      DlScalar start_radius;
+      DlPoint end_center;
+      DlScalar end_radius;
+      if (!ReadPoint(reader, &start_center) || !reader.Read(&start_radius) ||
+          !ReadPoint(reader, &end_center) || !reader.Read(&end_radius) ||
+          !ReadGradient(reader, &gradient)) {
+        return false;
+      }
+      *source = DlColorSource::MakeConical(
+          ToSkPoint(start_center), start_radius, ToSkPoint(end_center),
+          end_radius, gradient.stop_count, gradient.colors.data(),
+          gradient.stops, gradient.tile_mode, &gradient.matrix);
+      return true;
+    }
+    case DlColorSourceType::kSweepGradient: {
+      DlPoint center;
+      DlScalar start;
+      DlScalar end;
+      if (!ReadPoint(reader, &center) || !reader.Read(&start) ||
+          !reader.Read(&end) || !ReadGradient(reader, &gradient)) {
+        return false;
+      }
+      *source = DlColorSource::MakeSweep(
+          ToSkPoint(center), start, end, gradient.stop_count,
+          gradient.colors.data(), gradient.stops, gradient.tile_mode,
+          &gradient.matrix);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+void WriteColorFilter(DlWriter& writer, const DlColorFilter* filter) {
+  if (!filter) {
+    writer.Write(kNoAttribute);
+    return;
+  }
+  WriteEnum(writer, filter->type());
+  switch (filter->type()) {
+    case DlColorFilterType::kBlend:
+      WriteColor(writer, filter->asBlend()->color());
+      WriteEnum(writer, filter->asBlend()->mode());
+      break;
+    case DlColorFilterType::kMatrix: {
+      float matrix[20];
+      filter->asMatrix()->get_matrix(matrix);
+      writer.Write(matrix);
+      break;
+    }
+    case DlColorFilterType::kSrgbToLinearGamma:
+    case DlColorFilterType::kLinearToSrgbGamma:
+      break;
+  }
+}
+
+bool ReadColorFilter(DlReader& reader,
+                     std::shared_ptr<const DlColorFilter>* filter) {
+  uint32_t raw_type;
+  if (!reader.Read(&raw_type)) {
+    return false;
+  }
+  if (raw_type == kNoAttribute) {
+    filter->reset();
+    return true;
+  }
+  switch (static_cast<DlColorFilterType>(raw_type)) {
+    case DlColorFilterType::kBlend: {
+      DlColor color;
+      DlBlendMode mode;
+      if (!ReadColor(reader, &color) ||
+          !ReadEnum(reader, &mode, DlBlendMode::kLastMode)) {
+        return false;
+      }
+      *filter = DlBlendColorFilter::Make(color, mode);
+      return *filter != nullptr;
+    }
+    case DlColorFilterType::kMatrix: {
+      float matrix[20];
+      if (!reader.Read(&matrix)) {
+        return false;
+      }
+      *filter = DlMatrixColorFilter::Make(matrix);
+      return *filter != nullptr;
+    }
+    case DlColorFilterType::kSrgbToLinearGamma:
+      *filter = DlSrgbToLinearGammaColorFilter::kInstance;
+      return true;
+    case DlColorFilterType::kLinearToSrgbGamma:
+      *filter = DlLinearToSrgbGammaColorFilter::kInstance;
+      return true;
+    default:
+      return false;
+  }
+}
+
+void WriteImageFilter(DlWriter& writer, const DlImageFilter* filter) {
+  if (!filter) {
+    writer.Write(kNoAttribute);
+    return;
+  }
+  WriteEnum(writer, filter->type());
+  switch (filter->type()) {
+    case DlImageFilterType::kBlur:
+      writer.Write(filter->asBlur()->sigma_x());
+      writer.Write(filter->asBlur()->sigma_y());
+      WriteEnum(writer, filter->asBlur()->tile_mode());
+      break;
+    case DlImageFilterType::kDilate:
+      writer.Write(filter->asDilate()->radius_x());
+      writer.Write(filter->asDilate()->radius_y());
+      break;
+    case DlImageFilterType::kErode:
+      writer.Write(filter->asErode()->radius_x());
+      writer.Write(filter->asErode()->radius_y());
+      break;
+    case DlImageFilterType::kMatrix:
+      WriteMatrix(writer, filter->asMatrix()->matrix());
+      WriteEnum(writer, filter->asMatrix()->sampling());
+      break;
+    case DlImageFilterType::kCompose:
+      WriteImageFilter(writer, filter->asCompose()->outer().get());
+      WriteImageFilter(writer, filter->asCompose()->inner().get());
+      break;
+    case DlImageFilterType::kColorFilter:
+      WriteColorFilter(writer, filter->asColorFilter()->color_filter().get());
+      break;
+    case DlImageFilterType::kLocalMatrix:
+      WriteMatrix(writer, filter->asLocalMatrix()->matrix());
+      WriteImageFilter(writer,
+                       filter->asLocalMatrix()->image_filter().get());
+      break;
+  }
+}
+
+bool ReadImageFilter(DlReader& reader,
+                     std::shared_ptr<const DlImageFilter>* filter,
+                     int depth) {
+  uint32_t raw_type;
+  if (depth > kMaxNestingDepth || !reader.Read(&raw_type)) {
+    return false;
+  }
+  if (raw_type == kNoAttribute) {
+    filter->reset();
+    return true;
+  }
+  switch (static_cast<DlImageFilterType>(raw_type)) {
+    case DlImageFilterType::kBlur: {
+      DlScalar sigma_x;
+      DlScalar sigma_y;
+      DlTileMode tile_mode;
+      if (!reader.Read(&sigma_x) || !reader.Read(&sigma_y) ||
+          !ReadEnum(reader, &tile_mode, DlTileMode::kDecal)) {
+        return false;
+      }
+      *filter = DlBlurImageFilter::Make(sigma_x, sigma_y, tile_mode);
+      return *filter != nullptr;
+    }
+    case DlImageFilterType::kDilate:
+    case DlImageFilterType::kErode: {
+      DlScalar radius_x;
+      DlScalar radius_y;
+      if (!reader.Read(&radius_x) || !reader.Read(&radius_y)) {
+        return false;
+      }
+      *filter = static_cast<DlImageFilterType>(raw_type) ==
+                        DlImageFilterType::kDilate
+                    ? DlDilateImageFilter::Make(radius_x, radius_y)
+                    : DlErodeImageFilter::Make(radius_x, radius_y);
+      return *filter != nullptr;
+    }
+    case DlImageFilterType::kMatrix: {
+      SkMatrix matrix;
+      DlImageSampling sampling;
+      if (!ReadMatrix(reader, &matrix) ||
+          !ReadEnum(reader, &sampling, DlImageSampling::kCubic)) {
+        return false;
+      }
+      *filter = DlMatrixImageFilter::Make(matrix, sampling);
+      return *filter != nullptr;
+    }
+    case DlImageFilterType::kCompose: {
+      std::shared_ptr<const DlImageFilter> outer;
+      std::shared_ptr<const DlImageFilter> inner;
+      if (!ReadImageFilter(reader, &outer, depth + 1) ||
+          !ReadImageFilter(reader, &inner, depth + 1)) {
+        return false;
+      }
+      *filter = DlComposeImageFilter::Make(outer, inner);
+      return *filter != nullptr;
+    }
+    case DlImageFilterType::kColorFilter: {
+      std::shared_ptr<const DlColorFilter> color_filter;
+      if (!ReadColorFilter(reader, &color_filter)) {
+        return false;
+      }
+      *filter = DlColorFilterImageFilter::Make(color_filter);
+      return *filter != nullptr;
+    }
+    case DlImageFilterType::kLocalMatrix: {
+      SkMatrix matrix;
+      std::shared_ptr<const DlImageFilter> inner;
+      if (!ReadMatrix(reader, &matrix) ||
+          !ReadImageFilter(reader, &inner, depth + 1)) {
+        return false;
+      }
+      *filter = std::make_shared<DlLocalMatrixImageFilter>(matrix, inner);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+void WriteMaskFilter(DlWriter& writer, const DlMaskFilter* filter) {
+  if (!filter) {
+    writer.Write(kNoAttribute);
+    return;
+  }
+  WriteEnum(writer, filter->type());
+  switch (filter->type()) {
+    case DlMaskFilterType::kBlur:
+      WriteEnum(writer, filter->asBlur()->style());
+      writer.Write(filter->asBlur()->sigma());
+      WriteBool(writer, filter->asBlur()->respectCTM());
+      break;
+  }
+}
+
+bool ReadMaskFilter(DlReader& reader,
+                    std::shared_ptr<const DlMaskFilter>* filter) {
+  uint32_t raw_type;
+  if (!reader.Read(&raw_type)) {
+    return false;
+  }
+  if (raw_type == kNoAttribute) {
+    filter->reset();
+    return true;
+  }
+  if (static_cast<DlMaskFilterType>(raw_type) != DlMaskFilterType::kBlur) {
+    return false;
+  }
+  DlBlurStyle style;
+  DlScalar sigma;
+  bool respect_ctm;
+  if (!ReadEnum(reader, &style, DlBlurStyle::kInner) ||
+      !reader.Read(&sigma) || !ReadBool(reader, &respect_ctm)) {
+    return false;
+  }
+  *filter = DlBlurMaskFilter::Make(style, sigma, respect_ctm);
+  return *filter != nullptr;
+}
+
+bool SerializeDisplayList(DlWriter& writer, const DisplayList& display_list);
+
+// Encodes each op dispatched to it as a record, noting whether any op
+// referred to content that cannot be serialized.
+class SerializingReceiver final : public DlOpReceiver {
+ public:
+  explicit SerializingReceiver(DlWriter& writer) : writer_(writer) {}
+
+  bool failed() const { return failed_; }
+  uint32_t record_count() const { return record_count_; }
+
+  void setAntiAlias(bool aa) override {
+    Begin(Tag::kSetAntiAlias);
+    WriteBool(writer_, aa);
+    End();
+  }
+  void setDrawStyle(DlDrawStyle style) override {
+    Begin(Tag::kSetDrawStyle);
+    WriteEnum(writer_, style);
+    End();
+  }
+  void setColor(DlColor color) override {
+    Begin(Tag::kSetColor);
+    WriteColor(writer_, color);
+    End();
+  }
+  void setStrokeWidth(float width) override {
+    Begin(Tag::kSetStrokeWidth);
+    writer_.Write(width);
+    End();
+  }
+  void setStrokeMiter(float limit) override {
+    Begin(Tag::kSetStrokeMiter);
+    writer_.Write(limit);
+    End();
+  }
+  void setStrokeCap(DlStrokeCap cap) override {
+    Begin(Tag::kSetStrokeCap);
+    WriteEnum(writer_, cap);
+    End();
+  }
+  void setStrokeJoin(DlStrokeJoin join) override {
+    Begin(Tag::kSetStrokeJoin);
+    WriteEnum(writer_, join);
+    End();
+  }
+  void setColorSource(const DlColorSource* source) override {
+    Begin(Tag::kSetColorSource);
+    if (!WriteColorSource(writer_, source)) {
+      failed_ = true;
+    }
+    End();
+  }
+  void setColorFilter(const DlColorFilter* filter) override {
+    Begin(Tag::kSetColorFilter);
+    WriteColorFilter(writer_, filter);
+    End();
+  }
+  void setInvertColors(bool invert) override {
+    Begin(Tag::kSetInvertColors);
+    WriteBool(writer_, invert);
+    End();
+  }
+  void setBlendMode(DlBlendMode mode) override {
+    Begin(Tag::kSetBlendMode);
+    WriteEnum(writer_, mode);
+    End();
+  }
+  void setMaskFilter(const DlMaskFilter* filter) override {
+    Begin(Tag::kSetMaskFilter);
+    WriteMaskFilter(writer_, filter);
+    End();
+  }
+  void setImageFilter(const DlImageFilter* filter) override {
+    Begin(Tag::kSetImageFilter);
+    WriteImageFilter(writer_, filter);
+    End();
+  }
+
+  void save() override {
+    Begin(Tag::kSave);
+    End();
+  }
+  void saveLayer(const DlRect& bounds,
+                 const SaveLayerOptions options,
+                 const DlImageFilter* backdrop,
+                 std::optional<int64_t> backdrop_id) override {
+    uint32_t flags = 0u;
+    if (options.renders_with_attributes()) {
+      flags |= kSaveLayerRendersWithAttributes;
+    }
+    if (options.bounds_from_caller()) {
+      flags |= kSaveLayerBoundsFromCaller;
+    }
+    if (backdrop_id.has_value()) {
+      flags |= kSaveLayerHasBackdropId;
+    }
+    Begin(Tag::kSaveLayer);
+    WriteRect(writer_, bounds);
+    writer_.Write(flags);
+    writer_.Write(backdrop_id.value_or(0));
+    WriteImageFilter(writer_, backdrop);
+    End();
+  }
+  void restore() override {
+    Begin(Tag::kRestore);
+    End();
+  }
+
+  void translate(DlScalar tx, DlScalar ty) override {
+    Begin(Tag::kTranslate);
+    writer_.Write(tx);
+    writer_.Write(ty);
+    End();
+  }
+  void scale(DlScalar sx, DlScalar sy) override {
+    Begin(Tag::kScale);
+    writer_.Write(sx);
+    writer_.Write(sy);
+    End();
+  }
+  void rotate(DlScalar degrees) override {
+    Begin(Tag::kRotate);
+    writer_.Write(degrees);
+    End();
+  }
+  void skew(DlScalar sx, DlScalar sy) override {
+    Begin(Tag::kSkew);
+    writer_.Write(sx);
+    writer_.Write(sy);
+    End();
+  }
+  // clang-format off
+  void transform2DAffine(DlScalar mxx, DlScalar mxy, DlScalar mxt,
+                         DlScalar myx, DlScalar myy, DlScalar myt) override {
+    Begin(Tag::kTransform2DAffine);
+    for (DlScalar value : {mxx, mxy, mxt,
+                           myx, myy, myt}) {
+      writer_.Write(value);
+    }
+    End();
+  }
+  void transformFullPerspective(
+      DlScalar mxx, DlScalar mxy, DlScalar mxz, DlScalar mxt,
+      DlScalar myx, DlScalar myy, DlScalar myz, DlScalar myt,
+      DlScalar mzx, DlScalar mzy, DlScalar mzz, DlScalar mzt,
+      DlScalar mwx, DlScalar mwy, DlScalar mwz, DlScalar mwt) override {
+    Begin(Tag::kTransformFullPerspective);
+    for (DlScalar value : {mxx, mxy, mxz, mxt,
+                           myx, myy, myz, myt,
+                           mzx, mzy, mzz, mzt,
+                           mwx, mwy, mwz, mwt}) {
+      writer_.Write(value);
+    }
+    End();
+  }
+  // clang-format on
+  void transformReset() override {
+    Begin(Tag::kTransformReset);
+    End();
+  }
+
+  void clipRect(const DlRect& rect, ClipOp clip_op, bool is_aa) override {
+    Begin(Tag::kClipRect);
+    WriteRect(writer_, rect);
+    WriteEnum(writer_, clip_op);
+    WriteBool(writer_, is_aa);
+    End();
+  }
+  void clipOval(const DlRect& bounds, ClipOp clip_op, bool is_aa) override {
+    Begin(Tag::kClipOval);
+    WriteRect(writer_, bounds);
+    WriteEnum(writer_, clip_op);
+    WriteBool(writer_, is_aa);
+    End();
+  }
+  void clipRoundRect(const DlRoundRect& rrect,
+                     ClipOp clip_op,
+                     bool is_aa) override {
+    Begin(Tag::kClipRoundRect);
+    WriteRoundRect(writer_, rrect);
+    WriteEnum(writer_, clip_op);
+    WriteBool(writer_, is_aa);
+    End();
+  }
+  void clipPath(const DlPath& path, ClipOp clip_op, bool is_aa) override {
+    Begin(Tag::kClipPath);
+    WriteEnum(writer_, clip_op);
+    WriteBool(writer_, is_aa);
+    WritePath(writer_, path);
+    End();
+  }
+
+  void drawColor(DlColor color, DlBlendMode mode) override {
+    Begin(Tag::kDrawColor);
+    WriteColor(writer_, color);
+    WriteEnum(writer_, mode);
+    End();
+  }
+  void drawPaint() override {
+    Begin(Tag::kDrawPaint);
+    End();
+  }
+  void drawLine(const DlPoint& p0, const DlPoint& p1) override {
+    Begin(Tag::kDrawLine);
+    WritePoint(writer_, p0);
+    WritePoint(writer_, p1);
+    End();
+  }
+  void drawDashedLine(const DlPoint& p0,
+                      const DlPoint& p1,
+                      DlScalar on_length,
+                      DlScalar off_length) override {
+    Begin(Tag::kDrawDashedLine);
+    WritePoint(writer_, p0);
+    WritePoint(writer_, p1);
+    writer_.Write(on_length);
+    writer_.Write(off_length);
+    End();
+  }
+  void drawRect(const DlRect& rect) override {
+    Begin(Tag::kDrawRect);
+    WriteRect(writer_, rect);
+    End();
+  }
+  void drawOval(const DlRect& bounds) override {
+    Begin(Tag::kDrawOval);
+    WriteRect(writer_, bounds);
+    End();
+  }
+  void drawCircle(const DlPoint& center, DlScalar radius) override {
+    Begin(Tag::kDrawCircle);
+    WritePoint(writer_, center);
+    writer_.Write(radius);
+    End();
+  }
+  void drawRoundRect(const DlRoundRect& rrect) override {
+    Begin(Tag::kDrawRoundRect);
+    WriteRoundRect(writer_, rrect);
+    End();
+  }
+  void drawDiffRoundRect(const DlRoundRect& outer,
+                         const DlRoundRect& inner) override {
+    Begin(Tag::kDrawDiffRoundRect);
+    WriteRoundRect(writer_, outer);
+    WriteRoundRect(writer_, inner);
+    End();
+  }
+  void drawPath(const DlPath& path) override {
+    Begin(Tag::kDrawPath);
+    WritePath(writer_, path);
+    End();
+  }
+  void drawArc(const DlRect& oval_bounds,
+               DlScalar start_degrees,
+               DlScalar sweep_degrees,
+               bool use_center) override {
+    Begin(Tag::kDrawArc);
+    WriteRect(writer_, oval_bounds);
+    writer_.Write(start_degrees);
+    writer_.Write(sweep_degrees);
+    WriteBool(writer_, use_center);
+    End();
+  }
+  void drawPoints(PointMode mode,
+                  uint32_t count,
+                  const DlPoint points[]) override {
+    Begin(Tag::kDrawPoints);
+    WriteEnum(writer_, mode);
+    writer_.Write(count);
+    writer_.WriteBytes(points, count * sizeof(DlPoint));
+    End();
+  }
+  void drawVertices(const std::shared_ptr<DlVertices>& vertices,
+                    DlBlendMode mode) override {
+    uint32_t flags = 0u;
+    if (vertices->texture_coordinates()) {
+      flags |= kVerticesHasTextureCoordinates;
+    }
+    if (vertices->colors()) {
+      flags |= kVerticesHasColors;
+    }
+    Begin(Tag::kDrawVertices);
+    WriteEnum(writer_, mode);
+    WriteEnum(writer_, vertices->mode());
+    writer_.Write(flags);
+    writer_.Write(static_cast<uint32_t>(vertices->vertex_count()));
+    writer_.Write(static_cast<uint32_t>(vertices->index_count()));
+    writer_.WriteBytes(vertices->vertices(),
+                       vertices->vertex_count() * sizeof(SkPoint));
+    if (vertices->texture_coordinates()) {
+      writer_.WriteBytes(vertices->texture_coordinates(),
+                         vertices->vertex_count() * sizeof(SkPoint));
+    }
+    if (vertices->colors()) {
+      for (int i = 0; i < vertices->vertex_count(); i++) {
+        WriteColor(writer_, vertices->colors()[i]);
+      }
+    }
+    writer_.WriteBytes(vertices->indices(),
+                       vertices->index_count() * sizeof(uint16_t));
+    End();
+  }
+  void drawImage(const sk_sp<DlImage> image,
+                 const DlPoint& point,
+                 DlImageSampling sampling,
+                 bool render_with_attributes) override {
+    failed_ = true;
+  }
+  void drawImageRect(const sk_sp<DlImage> image,
+                     const DlRect& src,
+                     const DlRect& dst,
+                     DlImageSampling sampling,
+                     bool render_with_attributes,
+                     SrcRectConstraint constraint) override {
+    failed_ = true;
+  }
+  void drawImageNine(const sk_sp<DlImage> image,
+                     const DlIRect& center,
+                     const DlRect& dst,
+                     DlFilterMode filter,
+                     bool render_with_attributes) override {
+    failed_ = true;
+  }
+  void drawAtlas(const sk_sp<DlImage> atlas,
+                 const SkRSXform xform[],
+                 const DlRect tex[],
+                 const DlColor colors[],
+                 int count,
+                 DlBlendMode mode,
+                 DlImageSampling sampling,
+                 const DlRect* cull_rect,
+                 bool render_with_attributes) override {
+    failed_ = true;
+  }
+  void drawDisplayList(const sk_sp<DisplayList> display_list,
+                       DlScalar opacity) override {
+    Begin(Tag::kDrawDisplayList);
+    writer_.Write(opacity);
+    if (!SerializeDisplayList(writer_, *display_list)) {
+      failed_ = true;
+    }
+    End();
+  }
+  void drawTextBlob(const sk_sp<SkTextBlob> blob,
+                    DlScalar x,
+                    DlScalar y) override {
+    failed_ = true;
+  }
+  void drawTextFrame(const std::shared_ptr<impeller::TextFrame>& text_frame,
+                     DlScalar x,
+                     DlScalar y) override {
+    failed_ = true;
+  }
+  void drawShadow(const DlPath& path,
+                  const DlColor color,
+                  const DlScalar elevation,
+                  bool transparent_occluder,
+                  DlScalar dpr) override {
+    Begin(Tag::kDrawShadow);
+    WriteColor(writer_, color);
+    writer_.Write(elevation);
+    WriteBool(writer_, transparent_occluder);
+    writer_.Write(dpr);
+    WritePath(writer_, path);
+    End();
+  }
+
+ private:
+  void Begin(Tag tag) {
+    record_offset_ = writer_.size();
+    writer_.Write(RecordHeader{static_cast<uint32_t>(tag), 0u});
+  }
+
+  void End() {
+    writer_.Align();
+    size_t size = writer_.size() - record_offset_ - sizeof(RecordHeader);
+    writer_.WriteAt(record_offset_ + offsetof(RecordHeader, size),
+                    static_cast<uint32_t>(size));
+    record_count_++;
+  }
+
+  DlWriter& writer_;
+  size_t record_offset_ = 0u;
+  uint32_t record_count_ = 0u;
+  bool failed_ = false;
+};
+
+bool SerializeDisplayList(DlWriter& writer, const DisplayList& display_list) {
+  size_t header_offset = writer.size();
+  writer.Write(Header{
+      .magic = DlSerializer::kMagic,
+      .version = DlSerializer::kVersion,
+      .flags = display_list.has_rtree() ? kHeaderHasRTree : 0u,
+      .record_count = 0u,
+  });
+  SerializingReceiver receiver(writer);
+  display_list.Dispatch(receiver);
+  writer.WriteAt(header_offset + offsetof(Header, record_count),
+                 receiver.record_count());
+  return !receiver.failed();
+}
+
+}  // namespace
+
+std::unique_ptr<fml::Mapping> DlSerializer::Serialize(
+    const DisplayList& display_list) {
+  DlWriter writer;
+  if (!SerializeDisplayList(writer, display_list)) {
+    return nullptr;
+  }
+  return std::make_unique<fml::DataMapping>(writer.TakeData());
+}
+
+sk_sp<DisplayList> DlSerializer::Deserialize(const fml::Mapping& mapping) {
+  return Deserialize(mapping.GetMapping(), mapping.GetSize());
+}
+
+sk_sp<DisplayList> DlSerializer::Deserialize(const uint8_t* data,
+                                             size_t size) {
+  return Deserialize(data, size, 0);
+}
+
+sk_sp<DisplayList> DlSerializer::Deserialize(const uint8_t* data,
+                                             size_t size,
+                                             int depth) {
+  // The arrays in the records are handed to the builder in place so the
+  // data must be at least as aligned as the values within it.
+  if (!data || reinterpret_cast<uintptr_t>(data) % 4u != 0u ||
+      depth > kMaxNestingDepth) {
+    return nullptr;
+  }
+  DlReader reader(data, size);
+  Header header;
+  if (!reader.Read(&header) || header.magic != kMagic ||
+      header.version != kVersion) {
+    return nullptr;
+  }
+
+  DisplayListBuilder builder((header.flags & kHeaderHasRTree) != 0u);
+  DlOpReceiver& receiver = builder.asReceiver();
+  for (uint32_t i = 0; i < header.record_count; i++) {
+    RecordHeader record_header;
+    DlReader record;
+    if (!reader.Read(&record_header) ||
+        !reader.ReadSubReader(record_header.size, &record)) {
+      return nullptr;
+    }
+
+    bool valid = true;
+    switch (static_cast<Tag>(record_header.tag)) {
+      case Tag::kSetAntiAlias: {
+        bool aa;
+        valid = ReadBool(record, &aa);
+        if (valid) {
+          receiver.setAntiAlias(aa);
+        }
+        break;
+      }
+      case Tag::kSetDrawStyle: {
+        DlDrawStyle style;
+        valid = ReadEnum(record, &style, DlDrawStyle::kLastStyle);
+        if (valid) {
+          receiver.setDrawStyle(style);
+        }
+        break;
+      }
+      case Tag::kSetColor: {
+        DlColor color;
+        valid = ReadColor(record, &color);
+        if (valid) {
+          receiver.setColor(color);
+        }
+        break;
+      }
+      case Tag::kSetStrokeWidth: {
+        float width;
+        valid = record.Read(&width);
+        if (valid) {
+          receiver.setStrokeWidth(width);
+        }
+        break;
+      }
+      case Tag::kSetStrokeMiter: {
+        float limit;
+        valid = record.Read(&limit);
+        if (valid) {
+          receiver.setStrokeMiter(limit);
+        }
+        break;
+      }
+      case Tag::kSetStrokeCap: {
+        DlStrokeCap cap;
+        valid = ReadEnum(record, &cap, DlStrokeCap::kLastCap);
+        if (valid) {
+          receiver.setStrokeCap(cap);
+        }
+        break;
+      }
+      case Tag::kSetStrokeJoin: {
+        DlStrokeJoin join;
+        valid = ReadEnum(record, &join, DlStrokeJoin::kLastJoin);
+        if (valid) {
+          receiver.setStrokeJoin(join);
+        }
+        break;
+      }
+      case Tag::kSetColorSource: {
+        std::shared_ptr<DlColorSource> source;
+        valid = ReadColorSource(record, &source);
+        if (valid) {
+          receiver.setColorSource(source.get());
+        }
+        break;
+      }
+      case Tag::kSetColorFilter: {
+        std::shared_ptr<const DlColorFilter> filter;
+        valid = ReadColorFilter(record, &filter);
+        if (valid) {
+          receiver.setColorFilter(filter.get());
+        }
+        break;
+      }
+      case Tag::kSetInvertColors: {
+        bool invert;
+        valid = ReadBool(record, &invert);
+        if (valid) {
+          receiver.setInvertColors(invert);
+        }
+        break;
+      }
+      case Tag::kSetBlendMode: {
+        DlBlendMode mode;
+        valid = ReadEnum(record, &mode, DlBlendMode::kLastMode);
+        if (valid) {
+          receiver.setBlendMode(mode);
+        }
+        break;
+      }
+      case Tag::kSetMaskFilter: {
+        std::shared_ptr<const DlMaskFilter> filter;
+        valid = ReadMaskFilter(record, &filter);
+        if (valid) {
+          receiver.setMaskFilter(filter.get());
+        }
+        break;
+      }
+      case Tag::kSetImageFilter: {
+        std::shared_ptr<const DlImageFilter> filter;
+        valid = ReadImageFilter(record, &filter, 0);
+        if (valid) {
+          receiver.setImageFilter(filter.get());
+        }
+        break;
+      }
+
+      case Tag::kSave:
+        receiver.save();
+        break;
+      case Tag::kSaveLayer: {
+        DlRect bounds;
+        uint32_t flags;
+        int64_t backdrop_id;
+        std::shared_ptr<const DlImageFilter> backdrop;
+        valid = ReadRect(record, &bounds) && record.Read(&flags) &&
+                record.Read(&backdrop_id) &&
+                ReadImageFilter(record, &backdrop, 0);
+        if (valid) {
+          SaveLayerOptions options;
+          if (flags & kSaveLayerRendersWithAttributes) {
+            options = options.with_renders_with_attributes();
+          }
+          if (flags & kSaveLayerBoundsFromCaller) {
+            options = options.with_bounds_from_caller();
+          }
+          receiver.saveLayer(bounds, options, backdrop.get(),
+                             (flags & kSaveLayerHasBackdropId)
+                                 ? std::optional<int64_t>(backdrop_id)
+                                 : std::nullopt);
+        }
+        break;
+      }
+      case Tag::kRestore:
+        receiver.restore();
+        break;
+
+      case Tag::kTranslate:
+      case Tag::kScale:
+      case Tag::kSkew: {
+        DlScalar x;
+        DlScalar y;
+        valid = record.Read(&x) && record.Read(&y);
+        if (valid) {
+          switch (static_cast<Tag>(record_header.tag)) {
+            case Tag::kTranslate:
+              receiver.translate(x, y);
+              break;
+            case Tag::kScale:
+              receiver.scale(x, y);
+              break;
+            default:
+              receiver.skew(x, y);
+              break;
+          }
+        }
+        break;
+      }
+      case Tag::kRotate: {
+        DlScalar degrees;
+        valid = record.Read(&degrees);
+        if (valid) {
+          receiver.rotate(degrees);
+        }
+        break;
+      }
+      case Tag::kTransform2DAffine: {
+        DlScalar m[6];
+        valid = record.Read(&m);
+        if (valid) {
+          receiver.transform2DAffine(m[0], m[1], m[2],  //
+                                     m[3], m[4], m[5]);
+        }
+        break;
+      }
+      case Tag::kTransformFullPerspective: {
+        DlScalar m[16];
+        valid = record.Read(&m);
+        if (valid) {
+          receiver.transformFullPerspective(m[0], m[1], m[2], m[3],    //
+                                            m[4], m[5], m[6], m[7],    //
+                                            m[8], m[9], m[10], m[11],  //
+                                            m[12], m[13], m[14], m[15]);
+        }
+        break;
+      }
+      case Tag::kTransformReset:
+        receiver.transformReset();
+        break;
+
+      case Tag::kClipRect:
+      case Tag::kClipOval: {
+        DlRect rect;
+        DlCanvas::ClipOp clip_op;
+        bool is_aa;
+        valid = ReadRect(record, &rect) &&
+                ReadEnum(record, &clip_op, DlCanvas::ClipOp::kIntersect) &&
+                ReadBool(record, &is_aa);
+        if (valid) {
+          if (static_cast<Tag>(record_header.tag) == Tag::kClipRect) {
+            receiver.clipRect(rect, clip_op, is_aa);
+          } else {
+            receiver.clipOval(rect, clip_op, is_aa);
+          }
+        }
+        break;
+      }
+      case Tag::kClipRoundRect: {
+        DlRoundRect rrect;
+        DlCanvas::ClipOp clip_op;
+        bool is_aa;
+        valid = ReadRoundRect(record, &rrect) &&
+                ReadEnum(record, &clip_op, DlCanvas::ClipOp::kIntersect) &&
+                ReadBool(record, &is_aa);
+        if (valid) {
+          receiver.clipRoundRect(rrect, clip_op, is_aa);
+        }
+        break;
+      }
+      case Tag::kClipPath: {
+        DlCanvas::ClipOp clip_op;
+        bool is_aa;
+        DlPath path;
+        valid = ReadEnum(record, &clip_op, DlCanvas::ClipOp::kIntersect) &&
+                ReadBool(record, &is_aa) && ReadPath(record, &path);
+        if (valid) {
+          receiver.clipPath(path, clip_op, is_aa);
+        }
+        break;
+      }
+
+      case Tag::kDrawColor: {
+        DlColor color;
+        DlBlendMode mode;
+        valid = ReadColor(record, &color) &&
+                ReadEnum(record, &mode, DlBlendMode::kLastMode);
+        if (valid) {
+          receiver.drawColor(color, mode);
+        }
+        break;
+      }
+      case Tag::kDrawPaint:
+        receiver.drawPaint();
+        break;
+      case Tag::kDrawLine: {
+        DlPoint p0;
+        DlPoint p1;
+        valid = ReadPoint(record, &p0) && ReadPoint(record, &p1);
+        if (valid) {
+          receiver.drawLine(p0, p1);
+        }
+        break;
+      }
+      case Tag::kDrawDashedLine: {
+        DlPoint p0;
+        DlPoint p1;
+        DlScalar on_length;
+        DlScalar off_length;
+        valid = ReadPoint(record, &p0) && ReadPoint(record, &p1) &&
+                record.Read(&on_length) && record.Read(&off_length);
+        if (valid) {
+          receiver.drawDashedLine(p0, p1, on_length, off_length);
+        }
+        break;
+      }
+      case Tag::kDrawRect:
+      case Tag::kDrawOval: {
+        DlRect rect;
+        valid = ReadRect(record, &rect);
+        if (valid) {
+          if (static_cast<Tag>(record_header.tag) == Tag::kDrawRect) {
+            receiver.drawRect(rect);
+          } else {
+            receiver.drawOval(rect);
+          }
+        }
+        break;
+      }
+      case Tag::kDrawCircle: {
+        DlPoint center;
+        DlScalar radius;
+        valid = ReadPoint(record, &center) && record.Read(&radius);
+        if (valid) {
+          receiver.drawCircle(center, radius);
+        }
+        break;
+      }
+      case Tag::kDrawRoundRect: {
+        DlRoundRect rrect;
+        valid = ReadRoundRect(record, &rrect);
+        if (valid) {
+          receiver.drawRoundRect(rrect);
+        }
+        break;
+      }
+      case Tag::kDrawDiffRoundRect: {
+        DlRoundRect outer;
+        DlRoundRect inner;
+        valid = ReadRoundRect(record, &outer) && ReadRoundRect(record, &inner);
+        if (valid) {
+          receiver.drawDiffRoundRect(outer, inner);
+        }
+        break;
+      }
+      case Tag::kDrawPath: {
+        DlPath path;
+        valid = ReadPath(record, &path);
+        if (valid) {
+          receiver.drawPath(path);
+        }
+        break;
+      }
+      case Tag::kDrawArc: {
+        DlRect bounds;
+        DlScalar start;
+        DlScalar sweep;
+        bool use_center;
+        valid = ReadRect(record, &bounds) && record.Read(&start) &&
+                record.Read(&sweep) && ReadBool(record, &use_center);
+        if (valid) {
+          receiver.drawArc(bounds, start, sweep, use_center);
+        }
+        break;
+      }
+      case Tag::kDrawPoints: {
+        DlCanvas::PointMode mode;
+        uint32_t count;
+        const DlPoint* points = nullptr;
+        valid = ReadEnum(record, &mode, DlCanvas::PointMode::kPolygon) &&
+                record.Read(&count) &&
+                count < DlOpReceiver::kMaxDrawPointsCount &&
+                (points = record.ReadArray<DlPoint>(count)) != nullptr;
+        if (valid) {
+          receiver.drawPoints(mode, count, points);
+        }
+        break;
+      }
+      case Tag::kDrawVertices: {
+        DlBlendMode mode;
+        DlVertexMode vertex_mode;
+        uint32_t flags;
+        uint32_t vertex_count;
+        uint32_t index_count;
+        valid = ReadEnum(record, &mode, DlBlendMode::kLastMode) &&
+                ReadEnum(record, &vertex_mode, DlVertexMode::kTriangleFan) &&
+                record.Read(&flags) && record.Read(&vertex_count) &&
+                record.Read(&index_count) &&
+                vertex_count <= kMaxVertexCount &&
+                index_count <= kMaxVertexCount;
+        if (!valid) {
+          break;
+        }
+        const SkPoint* vertices = record.ReadArray<SkPoint>(vertex_count);
+        const SkPoint* texture_coordinates = nullptr;
+        if (flags & kVerticesHasTextureCoordinates) {
+          texture_coordinates = record.ReadArray<SkPoint>(vertex_count);
+          valid = texture_coordinates != nullptr;
+        }
+        std::vector<DlColor> colors;
+        if (valid && (flags & kVerticesHasColors)) {
+          // Each color takes 5 words of data, which protects the
+          // allocation below from absurd counts.
+          valid = vertex_count <= record.remaining() / 20u;
+          if (valid) {
+            colors.resize(vertex_count);
+            for (DlColor& color : colors) {
+              valid = valid && ReadColor(record, &color);
+            }
+          }
+        }
+        const uint16_t* indices = record.ReadArray<uint16_t>(index_count);
+        valid = valid && vertices && indices;
+        // Every mode may be indexed, but every index must name a vertex.
+        for (uint32_t i = 0; valid && i < index_count; i++) {
+          valid = indices[i] < vertex_count;
+        }
+        if (valid) {
+          receiver.drawVertices(
+              DlVertices::Make(vertex_mode, static_cast<int>(vertex_count),
+                               vertices, texture_coordinates,
+                               colors.empty() ? nullptr : colors.data(),
+                               static_cast<int>(index_count),
+                               index_count ? indices : nullptr),
+              mode);
+        }
+        break;
+      }
+      case Tag::kDrawDisplayList: {
+        DlScalar opacity;
+        valid = record.Read(&opacity);
+        if (valid) {
+          // The nested display list occupies the rest of the record.
+          size_t nested_size = record.remaining();
+          const uint8_t* nested = record.ReadArray<uint8_t>(nested_size);
+          sk_sp<DisplayList> display_list =
+              Deserialize(nested, nested_size, depth + 1);
+          valid = display_list != nullptr;
+          if (valid) {
+            receiver.drawDisplayList(display_list, opacity);
+          }
+        }
+        break;
+      }
+      case Tag::kDrawShadow: {
+        DlColor color;
+        DlScalar elevation;
+        bool transparent_occluder;
+        DlScalar dpr;
+        DlPath path;
+        valid = ReadColor(record, &color) && record.Read(&elevation) &&
+                ReadBool(record, &transparent_occluder) &&
+                record.Read(&dpr) && ReadPath(record, &path);
+        if (valid) {
+          receiver.drawShadow(path, color, elevation, transparent_occluder,
+                              dpr);
+        }
+        break;
+      }
+
+      default:
+        valid = false;
+        break;
+    }
+    if (!valid) {
+      return nullptr;
+    }
+  }
+  return builder.Build();
+}
+
+}  // namespace flutter
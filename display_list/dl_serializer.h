@@ -0,0 +1,67 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_DISPLAY_LIST_DL_SERIALIZER_H_
+#define FLUTTER_DISPLAY_LIST_DL_SERIALIZER_H_
+
+#include <memory>
+
+#include "flutter/display_list/display_list.h"
+#include "flutter/fml/mapping.h"
+
+namespace flutter {
+
+// Converts DisplayList objects to and from a compact, versioned binary
+// format so that static pictures such as splash screens and vector icons
+// can be recorded ahead of time and loaded without running the code that
+// originally recorded them.
+//
+// The format is a small header followed by one record per op. Records
+// hold only plain values and sizes, never pointers, so the data can be
+// loaded from any address, including directly from a memory mapped file.
+// Attributes such as color sources and image filters are encoded inline
+// in the records that set them and nested display lists are encoded
+// recursively inside the records that draw them.
+//
+// Loading reads the records in place and replays them into a
+// DisplayListBuilder which rebuilds the op storage, the bounds and the
+// RTree. The in-memory ops themselves cannot be persisted as they hold
+// vtables and reference counted pointers. Arrays of points, rects and
+// vertices are handed to the builder straight from the source data
+// without being copied first.
+//
+// Content that refers to resources which only exist at runtime (images,
+// text and runtime effects) cannot be serialized.
+class DlSerializer {
+ public:
+  // The first 4 bytes of every serialized DisplayList, "DLST".
+  static constexpr uint32_t kMagic = 0x54534c44u;
+
+  // Incremented whenever the encoding of any record changes. Data written
+  // with any other version is rejected rather than misinterpreted.
+  static constexpr uint32_t kVersion = 1u;
+
+  // Returns the serialized form of |display_list| or nullptr if the list
+  // contains content that cannot be serialized.
+  static std::unique_ptr<fml::Mapping> Serialize(
+      const DisplayList& display_list);
+
+  // Returns the DisplayList encoded in the indicated data, which is
+  // typically an fml::FileMapping of a file written from the output of
+  // |Serialize|, or nullptr if the data is not a valid serialized
+  // DisplayList of the current version.
+  static sk_sp<DisplayList> Deserialize(const fml::Mapping& mapping);
+  static sk_sp<DisplayList> Deserialize(const uint8_t* data, size_t size);
+
+ private:
+  static sk_sp<DisplayList> Deserialize(const uint8_t* data,
+                                        size_t size,
+                                        int depth);
+
+  DlSerializer() = delete;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_DISPLAY_LIST_DL_SERIALIZER_H_
@@ -0,0 +1,164 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/display_list/dl_serializer.h"
+
+#include <algorithm>
+
+#include "flutter/display_list/dl_builder.h"
+#include "flutter/display_list/testing/dl_test_snippets.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/mapping.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+
+DlOpReceiver& DisplayListBuilderTestingAccessor(DisplayListBuilder& builder);
+
+namespace testing {
+
+static sk_sp<DisplayList> MakeSerializableDisplayList() {
+  DisplayListBuilder nested_builder;
+  nested_builder.DrawCircle(DlPoint(20, 20), 10, DlPaint(DlColor::kBlue()));
+  sk_sp<DisplayList> nested = nested_builder.Build();
+
+  DlColor colors[] = {DlColor::kRed(), DlColor::kGreen()};
+  float stops[] = {0.0f, 1.0f};
+  DlPaint gradient_paint;
+  gradient_paint.setColorSource(
+      DlColorSource::MakeLinear(SkPoint::Make(0, 0), SkPoint::Make(100, 100),
+                                2, colors, stops, DlTileMode::kMirror));
+  DlPaint layer_paint;
+  layer_paint.setImageFilter(
+      DlBlurImageFilter::Make(2.0f, 3.0f, DlTileMode::kDecal));
+
+  DisplayListBuilder builder(true);
+  builder.DrawRect(SkRect::MakeLTRB(0, 0, 100, 100), gradient_paint);
+  builder.SaveLayer(nullptr, &layer_paint);
+  builder.Translate(10, 10);
+  builder.DrawPath(kTestPath1, DlPaint(DlColor::kYellow()));
+  builder.DrawDisplayList(nested, 0.5f);
+  builder.Restore();
+  SkPoint points[] = {{10, 10}, {50, 80}, {90, 20}};
+  builder.DrawPoints(DlCanvas::PointMode::kPolygon, 3, points, DlPaint());
+  return builder.Build();
+}
+
+TEST(DisplayListSerializer, RoundTripsAllSerializableOps) {
+  size_t serialized_count = 0u;
+  for (auto& group : CreateAllGroups()) {
+    for (size_t i = 0; i < group.variants.size(); i++) {
+      auto desc = group.op_name + "(variant " + std::to_string(i + 1) + ")";
+      DisplayListBuilder builder;
+      group.variants[i].Invoke(DisplayListBuilderTestingAccessor(builder));
+      sk_sp<DisplayList> display_list = builder.Build();
+
+      std::unique_ptr<fml::Mapping> data =
+          DlSerializer::Serialize(*display_list);
+      if (!data) {
+        // Images, text and runtime effects cannot be serialized.
+        continue;
+      }
+      serialized_count++;
+
+      sk_sp<DisplayList> copy = DlSerializer::Deserialize(*data);
+      ASSERT_NE(copy, nullptr) << desc;
+      EXPECT_TRUE(copy->Equals(*display_list)) << desc;
+      EXPECT_EQ(copy->op_count(true), display_list->op_count(true)) << desc;
+      EXPECT_EQ(copy->bounds(), display_list->bounds()) << desc;
+      EXPECT_EQ(copy->total_depth(), display_list->total_depth()) << desc;
+    }
+  }
+  EXPECT_GT(serialized_count, 0u);
+}
+
+TEST(DisplayListSerializer, RoundTripsThroughFileMapping) {
+  sk_sp<DisplayList> display_list = MakeSerializableDisplayList();
+  std::unique_ptr<fml::Mapping> data = DlSerializer::Serialize(*display_list);
+  ASSERT_NE(data, nullptr);
+
+  fml::ScopedTemporaryDirectory temp_dir;
+  ASSERT_TRUE(fml::WriteAtomically(temp_dir.fd(), "picture.dl", *data));
+  std::unique_ptr<fml::FileMapping> mapping =
+      fml::FileMapping::CreateReadOnly(temp_dir.fd(), "picture.dl");
+  ASSERT_NE(mapping, nullptr);
+  ASSERT_EQ(mapping->GetSize(), data->GetSize());
+
+  sk_sp<DisplayList> copy = DlSerializer::Deserialize(*mapping);
+  ASSERT_NE(copy, nullptr);
+  EXPECT_TRUE(copy->Equals(*display_list));
+  EXPECT_TRUE(copy->has_rtree());
+  EXPECT_EQ(copy->bounds(), display_list->bounds());
+  EXPECT_EQ(copy->rtree()->region().getRects(),
+            display_list->rtree()->region().getRects());
+
+  // The DisplayList does not refer back to the mapped data.
+  mapping.reset();
+  EXPECT_TRUE(copy->Equals(*display_list));
+}
+
+TEST(DisplayListSerializer, UnsupportedContentIsNotSerialized) {
+  DisplayListBuilder builder;
+  builder.DrawRect(SkRect::MakeLTRB(0, 0, 10, 10), DlPaint());
+  builder.DrawImage(TestImage1, DlPoint(10, 10),
+                    DlImageSampling::kNearestNeighbor);
+  sk_sp<DisplayList> display_list = builder.Build();
+  EXPECT_EQ(DlSerializer::Serialize(*display_list), nullptr);
+
+  DisplayListBuilder nested_builder;
+  nested_builder.DrawDisplayList(display_list);
+  EXPECT_EQ(DlSerializer::Serialize(*nested_builder.Build()), nullptr);
+}
+
+TEST(DisplayListSerializer, MalformedDataIsRejected) {
+  sk_sp<DisplayList> display_list = MakeSerializableDisplayList();
+  std::unique_ptr<fml::Mapping> data = DlSerializer::Serialize(*display_list);
+  ASSERT_NE(data, nullptr);
+  std::vector<uint8_t> bytes(data->GetMapping(),
+                             data->GetMapping() + data->GetSize());
+
+  for (size_t size = 0; size < bytes.size(); size++) {
+    EXPECT_EQ(DlSerializer::Deserialize(bytes.data(), size), nullptr) << size;
+  }
+
+  std::vector<uint8_t> bad_magic = bytes;
+  bad_magic[0] ^= 0xff;
+  EXPECT_EQ(DlSerializer::Deserialize(bad_magic.data(), bad_magic.size()),
+            nullptr);
+
+  std::vector<uint8_t> bad_version = bytes;
+  uint32_t version = DlSerializer::kVersion + 1;
+  memcpy(bad_version.data() + sizeof(uint32_t), &version, sizeof(version));
+  EXPECT_EQ(DlSerializer::Deserialize(bad_version.data(), bad_version.size()),
+            nullptr);
+
+  EXPECT_NE(DlSerializer::Deserialize(bytes.data(), bytes.size()), nullptr);
+}
+
+TEST(DisplayListSerializer, OutOfRangeVertexIndicesAreRejected) {
+  SkPoint vertices[] = {{0, 0}, {50, 0}, {0, 50}, {50, 50}};
+  uint16_t indices[] = {0, 1, 2, 1, 3, 2};
+  DisplayListBuilder builder;
+  builder.DrawVertices(
+      DlVertices::Make(DlVertexMode::kTriangles, 4, vertices, nullptr,
+                       nullptr, 6, indices),
+      DlBlendMode::kSrcOver, DlPaint());
+  std::unique_ptr<fml::Mapping> data =
+      DlSerializer::Serialize(*builder.Build());
+  ASSERT_NE(data, nullptr);
+  std::vector<uint8_t> bytes(data->GetMapping(),
+                             data->GetMapping() + data->GetSize());
+  ASSERT_NE(DlSerializer::Deserialize(bytes.data(), bytes.size()), nullptr);
+
+  auto found = std::search(bytes.begin(), bytes.end(),
+                           reinterpret_cast<const uint8_t*>(indices),
+                           reinterpret_cast<const uint8_t*>(indices + 6));
+  ASSERT_NE(found, bytes.end());
+  uint16_t out_of_range = 4;
+  memcpy(&*found + 4 * sizeof(uint16_t), &out_of_range, sizeof(uint16_t));
+  EXPECT_EQ(DlSerializer::Deserialize(bytes.data(), bytes.size()), nullptr);
+}
+
+}  // namespace testing
+}  // namespace flutter
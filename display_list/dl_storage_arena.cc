@@ -0,0 +1,117 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/display_list/dl_storage_arena.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "flutter/fml/logging.h"
+
+namespace flutter {
+
+std::shared_ptr<DisplayListArena> DisplayListArena::Make(
+    size_t chunk_size,
+    size_t max_retained_bytes) {
+  return std::shared_ptr<DisplayListArena>(
+      new DisplayListArena(chunk_size, max_retained_bytes));
+}
+
+DisplayListArena::DisplayListArena(size_t chunk_size,
+                                   size_t max_retained_bytes)
+    : chunk_size_(std::max(chunk_size, static_cast<size_t>(256u))),
+      max_retained_bytes_(max_retained_bytes) {
+  // Enough room for the blocks of a handful of builders so that releasing
+  // a block in the steady state does not need to grow the vector.
+  free_blocks_.reserve(16u);
+}
+
+DisplayListArena::~DisplayListArena() {
+  // Blocks that are still in use hold a reference to the arena so the
+  // only blocks that can remain at this point are the free blocks.
+  for (const Block& block : free_blocks_) {
+    std::free(block.ptr);
+  }
+}
+
+size_t DisplayListArena::allocation_count() const {
+  std::scoped_lock lock(mutex_);
+  return allocation_count_;
+}
+
+size_t DisplayListArena::retained_bytes() const {
+  std::scoped_lock lock(mutex_);
+  return retained_bytes_;
+}
+
+size_t DisplayListArena::RecommendedCapacity(size_t bytes) const {
+  // Leave some headroom so that a picture that grows slightly from one
+  // frame to the next still fits in a single chunk, and round up to a
+  // multiple of the chunk size so that buffers are interchangeable.
+  size_t capacity = std::max(bytes + bytes / 4u, chunk_size_);
+  return (capacity + chunk_size_ - 1) / chunk_size_ * chunk_size_;
+}
+
+DisplayListArena::Block DisplayListArena::Acquire(size_t min_capacity) {
+  {
+    std::scoped_lock lock(mutex_);
+    // Best fit search, the free list is only ever a handful of entries.
+    auto best = free_blocks_.end();
+    for (auto it = free_blocks_.begin(); it != free_blocks_.end(); ++it) {
+      if (it->capacity >= min_capacity &&
+          (best == free_blocks_.end() || it->capacity < best->capacity)) {
+        best = it;
+      }
+    }
+    if (best != free_blocks_.end()) {
+      Block block = *best;
+      *best = free_blocks_.back();
+      free_blocks_.pop_back();
+      retained_bytes_ -= block.capacity;
+      return block;
+    }
+    allocation_count_++;
+  }
+  size_t capacity = RecommendedCapacity(min_capacity);
+  FML_DCHECK(capacity >= min_capacity);
+  auto ptr = static_cast<uint8_t*>(std::malloc(capacity));
+  FML_CHECK(ptr);
+  return {ptr, capacity};
+}
+
+void DisplayListArena::Release(uint8_t* ptr, size_t capacity) {
+  if (!ptr) {
+    return;
+  }
+  {
+    std::scoped_lock lock(mutex_);
+    if (retained_bytes_ + capacity <= max_retained_bytes_) {
+      free_blocks_.push_back({ptr, capacity});
+      retained_bytes_ += capacity;
+      return;
+    }
+  }
+  std::free(ptr);
+}
+
+DisplayListStorage DisplayListArena::MakeStorage(
+    const std::shared_ptr<DisplayListArena>& arena,
+    const Block& block) {
+  return DisplayListStorage(block.ptr, arena, block.capacity);
+}
+
+DisplayListStorage::DisplayListStorage(uint8_t* ptr,
+                                       std::shared_ptr<DisplayListArena> arena,
+                                       size_t capacity)
+    : ptr_(ptr, FreeDeleter{std::move(arena), capacity}) {}
+
+void DisplayListStorage::FreeDeleter::operator()(uint8_t* p) {
+  if (arena) {
+    arena->Release(p, capacity);
+  } else {
+    std::free(p);
+  }
+}
+
+}  // namespace flutter
@@ -0,0 +1,103 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_DISPLAY_LIST_DL_STORAGE_ARENA_H_
+#define FLUTTER_DISPLAY_LIST_DL_STORAGE_ARENA_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "flutter/display_list/display_list.h"
+#include "flutter/fml/macros.h"
+
+namespace flutter {
+
+// A recycling pool of op storage buffers shared by one or more
+// DisplayListBuilder objects and the DisplayList objects they produce.
+//
+// A DisplayListBuilder that records into an arena writes its ops into
+// fixed-size chunks acquired from the arena rather than into a single
+// buffer grown with realloc, so recorded ops are never moved while the
+// list is being recorded. The first chunk of each recording is sized from
+// the size of the previously built list so that, in the steady state, a
+// whole frame fits in one chunk which is then handed to the DisplayList
+// without any copying.
+//
+// When a DisplayList whose storage came from an arena is destroyed its
+// buffer is returned to the arena rather than being freed so that a
+// builder which is reused to record a similar picture every frame will
+// not perform any heap allocations for its op storage once it reaches
+// a steady state.
+//
+// The arena may be accessed from multiple threads as DisplayList objects
+// are often released on a different thread than the one that recorded
+// them.
+class DisplayListArena {
+ public:
+  static constexpr size_t kDefaultChunkSize = 16 * 1024;
+  static constexpr size_t kDefaultMaxRetainedBytes = 4 * 1024 * 1024;
+
+  static std::shared_ptr<DisplayListArena> Make(
+      size_t chunk_size = kDefaultChunkSize,
+      size_t max_retained_bytes = kDefaultMaxRetainedBytes);
+
+  ~DisplayListArena();
+
+  // The minimum size of the chunks that builders will acquire from
+  // this arena while recording.
+  size_t chunk_size() const { return chunk_size_; }
+
+  // The total number of buffers that this arena has had to allocate
+  // from the heap since it was created. A builder that is recording
+  // in a steady state will stop incrementing this count.
+  size_t allocation_count() const;
+
+  // The number of bytes held in buffers that are not currently in use by
+  // any builder or DisplayList and are waiting to be reused.
+  size_t retained_bytes() const;
+
+  // Returns the capacity of the buffer that a recording which expects
+  // to use |bytes| bytes of op storage should acquire.
+  size_t RecommendedCapacity(size_t bytes) const;
+
+ private:
+  struct Block {
+    uint8_t* ptr;
+    size_t capacity;
+  };
+
+  DisplayListArena(size_t chunk_size, size_t max_retained_bytes);
+
+  // Returns a buffer of at least |min_capacity| bytes, reusing a released
+  // buffer if a suitable one is available.
+  Block Acquire(size_t min_capacity);
+
+  // Returns a buffer to the arena to be reused, or frees it if the arena
+  // is already retaining its maximum number of bytes.
+  void Release(uint8_t* ptr, size_t capacity);
+
+  // Wraps a buffer acquired from |arena| in a DisplayListStorage that will
+  // return the buffer to the arena when it is destroyed.
+  static DisplayListStorage MakeStorage(
+      const std::shared_ptr<DisplayListArena>& arena,
+      const Block& block);
+
+  const size_t chunk_size_;
+  const size_t max_retained_bytes_;
+
+  mutable std::mutex mutex_;
+  std::vector<Block> free_blocks_;
+  size_t retained_bytes_ = 0u;
+  size_t allocation_count_ = 0u;
+
+  friend class DisplayListBuilder;
+  friend class DisplayListStorage;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayListArena);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_DISPLAY_LIST_DL_STORAGE_ARENA_H_
@@ -87,9 +87,7 @@ size_t DlVertices::size() const {
 
 static SkRect compute_bounds(const SkPoint* points, int count) {
   AccumulationRect accumulator;
-  for (int i = 0; i < count; i++) {
-    accumulator.accumulate(points[i]);
-  }
+  accumulator.accumulate(ToDlPoints(points), count);
   return accumulator.bounds();
 }
 
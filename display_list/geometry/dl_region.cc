@@ -4,6 +4,10 @@
 
 #include "flutter/display_list/geometry/dl_region.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
 #include "flutter/fml/logging.h"
 
 namespace flutter {
@@ -12,6 +16,240 @@ namespace flutter {
 // search.
 const int kBinarySearchThreshold = 10;
 
+// Tiled regions use a grid of 32x32 tiles aligned to the origin so that the
+// bitmaps of two regions can be compared tile by tile.
+const int kTileShift = 5;
+const int32_t kTileOffsetMask = (1 << kTileShift) - 1;
+
+// The largest number of tiles in the bitmap of a tiled region, regions
+// with larger bounds are not tiled.
+const int64_t kMaxTileCount = 1 << 16;
+
+// The number of |intersects| queries that the tiles of a region cannot
+// answer which are resolved by scanning its source rectangles. Further
+// queries compute the span lines of the region once and search those.
+const uint32_t kMaxScannedQueries = 64;
+
+// Returns the range of tiles that |rect| touches, in units of tiles.
+static SkIRect TouchedTiles(const SkIRect& rect) {
+  return SkIRect::MakeLTRB(rect.fLeft >> kTileShift, rect.fTop >> kTileShift,
+                           ((rect.fRight - 1) >> kTileShift) + 1,
+                           ((rect.fBottom - 1) >> kTileShift) + 1);
+}
+
+// Returns the range of tiles that |rect| covers entirely, in units of
+// tiles.
+static SkIRect CoveredTiles(const SkIRect& rect) {
+  return SkIRect::MakeLTRB(
+      (rect.fLeft >> kTileShift) + ((rect.fLeft & kTileOffsetMask) != 0),
+      (rect.fTop >> kTileShift) + ((rect.fTop & kTileOffsetMask) != 0),
+      rect.fRight >> kTileShift, rect.fBottom >> kTileShift);
+}
+
+enum class TileOverlap {
+  // The regions do not intersect.
+  kNone,
+  // The regions intersect.
+  kSome,
+  // The tiles are not enough to tell whether the regions intersect.
+  kUnknown,
+};
+
+static bool FitsTileMask(const SkIRect& bounds) {
+  SkIRect tiles = TouchedTiles(bounds);
+  return tiles.width64() * tiles.height64() <= kMaxTileCount;
+}
+
+// The span lines of a tiled region, which are computed the first time an
+// operation needs them. |once| makes concurrent queries of the region, or
+// of its copies, compute them only once.
+struct DlRegion::TiledSpans {
+  std::once_flag once;
+  std::atomic<bool> resolved = false;
+  std::vector<SpanLine> lines;
+  SpanBuffer span_buffer;
+  // The number of |intersects| queries answered by scanning the source
+  // rectangles.
+  std::atomic<uint32_t> scanned_queries = 0;
+};
+
+struct DlRegion::TileMask {
+  // Returns null if |bounds| spans more than |kMaxTileCount| tiles.
+  static std::shared_ptr<const TileMask> Make(
+      const SkIRect& bounds,
+      const std::vector<SkIRect>& rects);
+
+  // Returns a mask for the range |tiles| with none of its bits set.
+  static std::shared_ptr<TileMask> Allocate(const SkIRect& tiles);
+
+  // Returns the mask of the union of the regions of |a| and |b|, whose
+  // combined bounds must fit in a mask.
+  static std::shared_ptr<const TileMask> Merge(const TileMask& a,
+                                               const TileMask& b);
+
+  // Calls |op(index, mask)| for the words holding the bits of the tiles in
+  // |range|, which must lie within |tiles|, until |op| returns true.
+  template <typename WordOp>
+  bool forEachWord(const SkIRect& range, WordOp&& op) const {
+    int32_t first = range.fLeft - tiles.fLeft;
+    int32_t last = range.fRight - 1 - tiles.fLeft;
+    for (int32_t row = range.fTop - tiles.fTop;
+         row < range.fBottom - tiles.fTop; row++) {
+      size_t row_start = static_cast<size_t>(row) * words_per_row;
+      for (int32_t word = first >> 6; word <= last >> 6; word++) {
+        int32_t lo = std::max(first - word * 64, 0);
+        int32_t hi = std::min(last - word * 64, 63);
+        uint64_t mask = (~uint64_t{0} >> (63 - hi)) & (~uint64_t{0} << lo);
+        if (op(row_start + word, mask)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  // Returns whether any of the tiles in |range| is set in |bits|.
+  bool any(const std::vector<uint64_t>& bits, const SkIRect& range) const {
+    SkIRect clipped = range;
+    if (!clipped.intersect(tiles)) {
+      return false;
+    }
+    return forEachWord(clipped, [&bits](size_t index, uint64_t mask) {
+      return (bits[index] & mask) != 0;
+    });
+  }
+
+  // Returns what the tiles tell about the intersection of the regions of
+  // this mask and |other|.
+  TileOverlap overlap(const TileMask& other) const;
+
+  // Returns the bits of the 64 tiles starting at tile |x| in row |y| of
+  // |bits|, with the bits of the tiles beyond |tiles| cleared.
+  uint64_t extract(const std::vector<uint64_t>& bits,
+                   int32_t x,
+                   int32_t y) const {
+    FML_DCHECK(x >= tiles.fLeft && x < tiles.fRight);
+    FML_DCHECK(y >= tiles.fTop && y < tiles.fBottom);
+    int32_t column = x - tiles.fLeft;
+    size_t index = static_cast<size_t>(y - tiles.fTop) * words_per_row +
+                   (column >> 6);
+    int shift = column & 63;
+    uint64_t result = bits[index] >> shift;
+    if (shift != 0 && (column >> 6) + 1 < words_per_row) {
+      result |= bits[index + 1] << (64 - shift);
+    }
+    return result;
+  }
+
+  // Sets the bits of the tiles that are set in |source|, which must lie
+  // within |tiles|.
+  void insert(const TileMask& source);
+
+  // The range of tiles held by the mask, in units of tiles.
+  SkIRect tiles;
+  int32_t words_per_row;
+
+  // The tiles that are touched by at least one rectangle of the region.
+  std::vector<uint64_t> touched;
+
+  // The tiles that are covered entirely by a single rectangle of the
+  // region. Tiles that are only covered by several rectangles together
+  // are not marked.
+  std::vector<uint64_t> covered;
+};
+
+std::shared_ptr<DlRegion::TileMask> DlRegion::TileMask::Allocate(
+    const SkIRect& tiles) {
+  auto mask = std::make_shared<TileMask>();
+  mask->tiles = tiles;
+  mask->words_per_row = (tiles.width() + 63) / 64;
+  mask->touched.resize(static_cast<size_t>(mask->words_per_row) *
+                       tiles.height());
+  mask->covered.resize(mask->touched.size());
+  return mask;
+}
+
+std::shared_ptr<const DlRegion::TileMask> DlRegion::TileMask::Make(
+    const SkIRect& bounds,
+    const std::vector<SkIRect>& rects) {
+  if (!FitsTileMask(bounds)) {
+    return nullptr;
+  }
+  auto mask = Allocate(TouchedTiles(bounds));
+  for (const SkIRect& rect : rects) {
+    mask->forEachWord(TouchedTiles(rect), [&mask](size_t index, uint64_t m) {
+      mask->touched[index] |= m;
+      return false;
+    });
+    SkIRect covered = CoveredTiles(rect);
+    if (!covered.isEmpty()) {
+      mask->forEachWord(covered, [&mask](size_t index, uint64_t m) {
+        mask->covered[index] |= m;
+        return false;
+      });
+    }
+  }
+  return mask;
+}
+
+std::shared_ptr<const DlRegion::TileMask> DlRegion::TileMask::Merge(
+    const TileMask& a,
+    const TileMask& b) {
+  SkIRect tiles = a.tiles;
+  tiles.join(b.tiles);
+  FML_DCHECK(tiles.width64() * tiles.height64() <= kMaxTileCount);
+  auto mask = Allocate(tiles);
+  mask->insert(a);
+  mask->insert(b);
+  return mask;
+}
+
+void DlRegion::TileMask::insert(const TileMask& source) {
+  FML_DCHECK(tiles.contains(source.tiles));
+  for (int32_t y = source.tiles.fTop; y < source.tiles.fBottom; y++) {
+    size_t row_start = static_cast<size_t>(y - tiles.fTop) * words_per_row;
+    for (int32_t x = source.tiles.fLeft; x < source.tiles.fRight; x += 64) {
+      int32_t column = x - tiles.fLeft;
+      size_t index = row_start + (column >> 6);
+      int shift = column & 63;
+      bool spills = shift != 0 && (column >> 6) + 1 < words_per_row;
+      uint64_t source_touched = source.extract(source.touched, x, y);
+      uint64_t source_covered = source.extract(source.covered, x, y);
+      touched[index] |= source_touched << shift;
+      covered[index] |= source_covered << shift;
+      if (spills) {
+        touched[index + 1] |= source_touched >> (64 - shift);
+        covered[index + 1] |= source_covered >> (64 - shift);
+      }
+    }
+  }
+}
+
+TileOverlap DlRegion::TileMask::overlap(const TileMask& other) const {
+  const TileMask& a = *this;
+  const TileMask& b = other;
+  SkIRect range = a.tiles;
+  if (!range.intersect(b.tiles)) {
+    return TileOverlap::kNone;
+  }
+  bool touched = false;
+  for (int32_t y = range.fTop; y < range.fBottom; y++) {
+    for (int32_t x = range.fLeft; x < range.fRight; x += 64) {
+      int32_t count = std::min(range.fRight - x, 64);
+      uint64_t valid = count == 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+      uint64_t a_touched = a.extract(a.touched, x, y) & valid;
+      uint64_t b_touched = b.extract(b.touched, x, y) & valid;
+      uint64_t a_covered = a.extract(a.covered, x, y) & valid;
+      uint64_t b_covered = b.extract(b.covered, x, y) & valid;
+      if ((a_covered & b_touched) != 0 || (b_covered & a_touched) != 0) {
+        return TileOverlap::kSome;
+      }
+      touched = touched || (a_touched & b_touched) != 0;
+    }
+  }
+  return touched ? TileOverlap::kUnknown : TileOverlap::kNone;
+}
+
 DlRegion::SpanBuffer::SpanBuffer(DlRegion::SpanBuffer&& m)
     : capacity_(m.capacity_), size_(m.size_), spans_(m.spans_) {
   m.size_ = 0;
@@ -94,8 +332,89 @@ void DlRegion::SpanBuffer::getSpans(SpanChunkHandle handle,
   end = begin + getChunkSize(handle);
 }
 
-DlRegion::DlRegion(const std::vector<SkIRect>& rects) {
-  setRects(rects);
+DlRegion::DlRegion(const std::vector<SkIRect>& rects,
+                   Representation representation) {
+  bool tiled = false;
+  switch (representation) {
+    case Representation::kAdaptive:
+      tiled = rects.size() >= kTiledRectThreshold && setTiledRects(rects);
+      break;
+    case Representation::kExact:
+      break;
+    case Representation::kTiled:
+      tiled = setTiledRects(rects);
+      break;
+  }
+  if (!tiled) {
+    setRects(rects);
+  }
+}
+
+bool DlRegion::setTiledRects(std::vector<SkIRect> rects) {
+  FML_DCHECK(lines_.empty() && !tiles_);
+  auto is_empty = [](const SkIRect& rect) { return rect.isEmpty(); };
+  rects.erase(std::remove_if(rects.begin(), rects.end(), is_empty),
+              rects.end());
+  if (rects.size() < 2) {
+    return false;
+  }
+  SkIRect bounds = SkIRect::MakeEmpty();
+  for (const SkIRect& rect : rects) {
+    bounds.join(rect);
+  }
+  auto tiles = TileMask::Make(bounds, rects);
+  if (!tiles) {
+    return false;
+  }
+  bounds_ = bounds;
+  tiles_ = std::move(tiles);
+  rects_ = std::make_shared<const std::vector<SkIRect>>(std::move(rects));
+  tiled_spans_ = std::make_shared<TiledSpans>();
+  return true;
+}
+
+void DlRegion::resolveSpans() const {
+  if (!tiles_) {
+    return;
+  }
+  TiledSpans& spans = *tiled_spans_;
+  std::call_once(spans.once, [this, &spans]() {
+    DlRegion exact;
+    exact.setRects(*rects_);
+    FML_DCHECK(exact.bounds_ == bounds_);
+    spans.lines = std::move(exact.lines_);
+    spans.span_buffer = std::move(exact.span_buffer_);
+    spans.resolved.store(true, std::memory_order_release);
+  });
+}
+
+bool DlRegion::spansResolved() const {
+  return !tiled_spans_ ||
+         tiled_spans_->resolved.load(std::memory_order_acquire);
+}
+
+const std::vector<DlRegion::SpanLine>& DlRegion::lines() const {
+  FML_DCHECK(spansResolved());
+  return tiled_spans_ ? tiled_spans_->lines : lines_;
+}
+
+const DlRegion::SpanBuffer& DlRegion::spanBuffer() const {
+  FML_DCHECK(spansResolved());
+  return tiled_spans_ ? tiled_spans_->span_buffer : span_buffer_;
+}
+
+DlRegion DlRegion::clipTiledRects(const SkIRect& clip) const {
+  FML_DCHECK(isTiled());
+  if (clip.contains(bounds_)) {
+    return *this;
+  }
+  std::vector<SkIRect> clipped;
+  for (SkIRect rect : *rects_) {
+    if (rect.intersect(clip)) {
+      clipped.push_back(rect);
+    }
+  }
+  return DlRegion(clipped);
 }
 
 DlRegion::DlRegion(const SkIRect& rect) : bounds_(rect) {
@@ -407,7 +726,48 @@ DlRegion DlRegion::MakeUnion(const DlRegion& a, const DlRegion& b) {
     return b;
   } else if (b.isEmpty()) {
     return a;
-  } else if (a.isSimple() && a.bounds_.contains(b.bounds_)) {
+  }
+
+  if (a.isTiled() || b.isTiled()) {
+    // The union of a tiled region is tiled as well, unless the combined
+    // bounds span too many tiles.
+    if (a.bounds_.isEmpty()) {
+      return b;
+    } else if (b.bounds_.isEmpty()) {
+      return a;
+    }
+    SkIRect bounds = a.bounds_;
+    bounds.join(b.bounds_);
+    if (FitsTileMask(bounds)) {
+      std::vector<SkIRect> rects;
+      std::shared_ptr<const TileMask> masks[2];
+      const DlRegion* regions[2] = {&a, &b};
+      for (int i = 0; i < 2; i++) {
+        const DlRegion* region = regions[i];
+        if (region->isTiled()) {
+          rects.insert(rects.end(), region->rects_->begin(),
+                       region->rects_->end());
+          masks[i] = region->tiles_;
+        } else {
+          auto region_rects = region->getRects(false);
+          masks[i] = TileMask::Make(region->bounds_, region_rects);
+          rects.insert(rects.end(), region_rects.begin(),
+                       region_rects.end());
+        }
+      }
+      DlRegion res;
+      res.bounds_ = bounds;
+      res.rects_ = std::make_shared<const std::vector<SkIRect>>(
+          std::move(rects));
+      res.tiles_ = TileMask::Merge(*masks[0], *masks[1]);
+      res.tiled_spans_ = std::make_shared<TiledSpans>();
+      return res;
+    }
+    a.resolveSpans();
+    b.resolveSpans();
+  }
+
+  if (a.isSimple() && a.bounds_.contains(b.bounds_)) {
     return a;
   } else if (b.isSimple() && b.bounds_.contains(a.bounds_)) {
     return b;
@@ -416,21 +776,21 @@ DlRegion DlRegion::MakeUnion(const DlRegion& a, const DlRegion& b) {
   DlRegion res;
   res.bounds_ = a.bounds_;
   res.bounds_.join(b.bounds_);
-  res.span_buffer_.reserve(a.span_buffer_.capacity() +
-                           b.span_buffer_.capacity());
+  res.span_buffer_.reserve(a.spanBuffer().capacity() +
+                           b.spanBuffer().capacity());
 
   auto& lines = res.lines_;
-  lines.reserve(a.lines_.size() + b.lines_.size());
+  lines.reserve(a.lines().size() + b.lines().size());
 
-  auto a_it = a.lines_.begin();
-  auto b_it = b.lines_.begin();
-  auto a_end = a.lines_.end();
-  auto b_end = b.lines_.end();
+  auto a_it = a.lines().begin();
+  auto b_it = b.lines().begin();
+  auto a_end = a.lines().end();
+  auto b_end = b.lines().end();
 
   FML_DCHECK(a_it != a_end && b_it != b_end);
 
-  auto& a_buffer = a.span_buffer_;
-  auto& b_buffer = b.span_buffer_;
+  auto& a_buffer = a.spanBuffer();
+  auto& b_buffer = b.spanBuffer();
 
   std::vector<Span> tmp;
 
@@ -497,7 +857,20 @@ DlRegion DlRegion::MakeUnion(const DlRegion& a, const DlRegion& b) {
 DlRegion DlRegion::MakeIntersection(const DlRegion& a, const DlRegion& b) {
   if (!SkIRect::Intersects(a.bounds_, b.bounds_)) {
     return DlRegion();
-  } else if (a.isSimple() && b.isSimple()) {
+  }
+
+  // Clipping the source rectangles of a tiled region to a rectangle is
+  // much cheaper than computing its span lines.
+  if (a.isTiled() && !a.spansResolved() && !b.isTiled() && b.isSimple()) {
+    return a.clipTiledRects(b.bounds_);
+  } else if (b.isTiled() && !b.spansResolved() && !a.isTiled() &&
+             a.isSimple()) {
+    return b.clipTiledRects(a.bounds_);
+  }
+  a.resolveSpans();
+  b.resolveSpans();
+
+  if (a.isSimple() && b.isSimple()) {
     SkIRect r(a.bounds_);
     [[maybe_unused]]
     auto res = r.intersect(b.bounds_);
@@ -511,19 +884,19 @@ DlRegion DlRegion::MakeIntersection(const DlRegion& a, const DlRegion& b) {
 
   DlRegion res;
   res.span_buffer_.reserve(
-      std::max(a.span_buffer_.capacity(), b.span_buffer_.capacity()));
+      std::max(a.spanBuffer().capacity(), b.spanBuffer().capacity()));
 
   auto& lines = res.lines_;
-  lines.reserve(std::min(a.lines_.size(), b.lines_.size()));
+  lines.reserve(std::min(a.lines().size(), b.lines().size()));
 
   std::vector<SpanLine>::const_iterator a_it, b_it;
-  getIntersectionIterators(a.lines_, b.lines_, a_it, b_it);
+  getIntersectionIterators(a.lines(), b.lines(), a_it, b_it);
 
-  auto a_end = a.lines_.end();
-  auto b_end = b.lines_.end();
+  auto a_end = a.lines().end();
+  auto b_end = b.lines().end();
 
-  auto& a_buffer = a.span_buffer_;
-  auto& b_buffer = b.span_buffer_;
+  auto& a_buffer = a.spanBuffer();
+  auto& b_buffer = b.spanBuffer();
 
   std::vector<Span> tmp;
 
@@ -564,21 +937,23 @@ std::vector<SkIRect> DlRegion::getRects(bool deband) const {
   std::vector<SkIRect> rects;
   if (isEmpty()) {
     return rects;
-  } else if (isSimple()) {
+  }
+  resolveSpans();
+  if (isSimple()) {
     rects.push_back(bounds_);
     return rects;
   }
 
   size_t rect_count = 0;
   size_t previous_span_end = 0;
-  for (const auto& line : lines_) {
-    rect_count += span_buffer_.getChunkSize(line.chunk_handle);
+  for (const auto& line : lines()) {
+    rect_count += spanBuffer().getChunkSize(line.chunk_handle);
   }
   rects.reserve(rect_count);
 
-  for (const auto& line : lines_) {
+  for (const auto& line : lines()) {
     const Span *span_begin, *span_end;
-    span_buffer_.getSpans(line.chunk_handle, span_begin, span_end);
+    spanBuffer().getSpans(line.chunk_handle, span_begin, span_end);
     for (const auto* span = span_begin; span < span_end; ++span) {
       SkIRect rect{span->left, line.top, span->right, line.bottom};
       if (deband) {
@@ -609,9 +984,10 @@ std::vector<SkIRect> DlRegion::getRects(bool deband) const {
 }
 
 bool DlRegion::isComplex() const {
-  return lines_.size() > 1 ||
-         (lines_.size() == 1 &&
-          span_buffer_.getChunkSize(lines_.front().chunk_handle) > 1);
+  resolveSpans();
+  return lines().size() > 1 ||
+         (lines().size() == 1 &&
+          spanBuffer().getChunkSize(lines().front().chunk_handle) > 1);
 }
 
 bool DlRegion::intersects(const SkIRect& rect) const {
@@ -621,6 +997,31 @@ bool DlRegion::intersects(const SkIRect& rect) const {
 
   auto bounds_intersect = SkIRect::Intersects(bounds_, rect);
 
+  if (isTiled()) {
+    if (!bounds_intersect) {
+      return false;
+    }
+    // Every tile that the rectangle touches overlaps it, so a covered tile
+    // is enough to know that they intersect.
+    SkIRect tiles = TouchedTiles(rect);
+    if (tiles_->any(tiles_->covered, tiles)) {
+      return true;
+    } else if (!tiles_->any(tiles_->touched, tiles)) {
+      return false;
+    }
+    if (!spansResolved() &&
+        tiled_spans_->scanned_queries.fetch_add(
+            1, std::memory_order_relaxed) < kMaxScannedQueries) {
+      for (const SkIRect& source : *rects_) {
+        if (SkIRect::Intersects(source, rect)) {
+          return true;
+        }
+      }
+      return false;
+    }
+    resolveSpans();
+  }
+
   if (isSimple()) {
     return bounds_intersect;
   }
@@ -629,12 +1030,12 @@ bool DlRegion::intersects(const SkIRect& rect) const {
     return false;
   }
 
-  auto it = lines_.begin();
-  auto end = lines_.end();
-  if (lines_.size() > kBinarySearchThreshold &&
+  auto it = lines().begin();
+  auto end = lines().end();
+  if (lines().size() > kBinarySearchThreshold &&
       it[kBinarySearchThreshold].bottom <= rect.fTop) {
     it = std::lower_bound(
-        lines_.begin() + kBinarySearchThreshold + 1, lines_.end(), rect.fTop,
+        lines().begin() + kBinarySearchThreshold + 1, lines().end(), rect.fTop,
         [](const SpanLine& line, int32_t top) { return line.bottom <= top; });
   } else {
     while (it != end && it->bottom <= rect.fTop) {
@@ -645,7 +1046,7 @@ bool DlRegion::intersects(const SkIRect& rect) const {
   while (it != end && it->top < rect.fBottom) {
     FML_DCHECK(rect.fTop < it->bottom && it->top < rect.fBottom);
     const Span *begin, *end;
-    span_buffer_.getSpans(it->chunk_handle, begin, end);
+    spanBuffer().getSpans(it->chunk_handle, begin, end);
     while (begin != end && begin->left < rect.fRight) {
       if (begin->right > rect.fLeft) {
         return true;
@@ -707,6 +1108,31 @@ bool DlRegion::intersects(const DlRegion& region) const {
     return false;
   }
 
+  if (isTiled() || region.isTiled()) {
+    if (!SkIRect::Intersects(bounds_, region.bounds_)) {
+      return false;
+    }
+    if (isTiled() && region.isTiled()) {
+      switch (tiles_->overlap(*region.tiles_)) {
+        case TileOverlap::kNone:
+          return false;
+        case TileOverlap::kSome:
+          return true;
+        case TileOverlap::kUnknown:
+          break;
+      }
+    } else if (isTiled()) {
+      if (!tiles_->any(tiles_->touched, TouchedTiles(region.bounds_))) {
+        return false;
+      }
+    } else if (!region.tiles_->any(region.tiles_->touched,
+                                   TouchedTiles(bounds_))) {
+      return false;
+    }
+    resolveSpans();
+    region.resolveSpans();
+  }
+
   auto our_complex = isComplex();
   auto their_complex = region.isComplex();
   auto bounds_intersect = SkIRect::Intersects(bounds_, region.bounds_);
@@ -728,9 +1154,9 @@ bool DlRegion::intersects(const DlRegion& region) const {
   }
 
   std::vector<SpanLine>::const_iterator ours, theirs;
-  getIntersectionIterators(lines_, region.lines_, ours, theirs);
-  auto ours_end = lines_.end();
-  auto theirs_end = region.lines_.end();
+  getIntersectionIterators(lines(), region.lines(), ours, theirs);
+  auto ours_end = lines().end();
+  auto theirs_end = region.lines().end();
 
   while (ours != ours_end && theirs != theirs_end) {
     if (ours->bottom <= theirs->top) {
@@ -740,9 +1166,9 @@ bool DlRegion::intersects(const DlRegion& region) const {
     } else {
       FML_DCHECK(ours->top < theirs->bottom && theirs->top < ours->bottom);
       const Span *ours_begin, *ours_end;
-      span_buffer_.getSpans(ours->chunk_handle, ours_begin, ours_end);
+      spanBuffer().getSpans(ours->chunk_handle, ours_begin, ours_end);
       const Span *theirs_begin, *theirs_end;
-      region.span_buffer_.getSpans(theirs->chunk_handle, theirs_begin,
+      region.spanBuffer().getSpans(theirs->chunk_handle, theirs_begin,
                                    theirs_end);
       if (spansIntersect(ours_begin, ours_end, theirs_begin, theirs_end)) {
         return true;
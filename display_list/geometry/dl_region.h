@@ -15,14 +15,42 @@ namespace flutter {
 /// Represents a region as a collection of non-overlapping rectangles.
 /// Implements a subset of SkRegion functionality optimized for quickly
 /// converting set of overlapping rectangles to non-overlapping rectangles.
+///
+/// Regions built from many rectangles can instead be tiled. A tiled region
+/// keeps its source rectangles along with a coarse bitmap of the tiles
+/// they touch and answers |intersects| and |MakeUnion| from the bitmap
+/// where it can. The non-overlapping rectangles of a tiled region are only
+/// computed by the operations that need them, once for the region and its
+/// copies, after which it behaves like any other region. Like any other
+/// region, a tiled region can be queried from several threads at once.
 class DlRegion {
  public:
+  /// How a region built from a list of rectangles is represented.
+  enum class Representation {
+    /// Tiles regions built from at least |kTiledRectThreshold| rectangles
+    /// and computes the non-overlapping rectangles of smaller ones.
+    kAdaptive,
+    /// Always computes the non-overlapping rectangles.
+    kExact,
+    /// Tiles the region unless it is a single rectangle or its bounds span
+    /// too many tiles.
+    kTiled,
+  };
+
+  /// The number of rectangles from which an adaptive region is tiled.
+  static constexpr size_t kTiledRectThreshold = 512;
+
   /// Creates an empty region.
   DlRegion() = default;
 
   /// Creates region by bulk adding the rectangles.
   /// Matches SkRegion::op(rect, SkRegion::kUnion_Op) behavior.
-  explicit DlRegion(const std::vector<SkIRect>& rects);
+  explicit DlRegion(const std::vector<SkIRect>& rects)
+      : DlRegion(rects, Representation::kAdaptive) {}
+
+  /// Creates region by bulk adding the rectangles using the given
+  /// representation.
+  DlRegion(const std::vector<SkIRect>& rects, Representation representation);
 
   /// Creates region covering area of a rectangle.
   explicit DlRegion(const SkIRect& rect);
@@ -59,7 +87,7 @@ class DlRegion {
   bool intersects(const DlRegion& region) const;
 
   /// Returns true if region is empty (contains no rectangles).
-  bool isEmpty() const { return lines_.empty(); }
+  bool isEmpty() const { return lines_.empty() && !tiles_; }
 
   /// Returns true if region is not empty and contains more than one rectangle.
   bool isComplex() const;
@@ -68,7 +96,12 @@ class DlRegion {
   /// empty.
   bool isSimple() const { return !isComplex(); }
 
+  /// Returns true if region is tiled.
+  bool isTiled() const { return tiles_ != nullptr; }
+
  private:
+  struct TileMask;
+  struct TiledSpans;
   typedef std::uint32_t SpanChunkHandle;
 
   struct Span {
@@ -120,6 +153,25 @@ class DlRegion {
 
   void setRects(const std::vector<SkIRect>& rects);
 
+  // Makes this region tiled unless it is a single rectangle or its bounds
+  // span too many tiles.
+  bool setTiledRects(std::vector<SkIRect> rects);
+
+  // Computes the span lines of a tiled region if they are not known yet.
+  void resolveSpans() const;
+
+  // Whether the span lines of this region are known, which they always are
+  // unless it is tiled.
+  bool spansResolved() const;
+
+  // The span lines of this region and the buffer holding their spans, which
+  // must be resolved.
+  const std::vector<SpanLine>& lines() const;
+  const SpanBuffer& spanBuffer() const;
+
+  // Returns the intersection of a tiled region with a rectangle.
+  DlRegion clipTiledRects(const SkIRect& clip) const;
+
   void appendLine(int32_t top,
                   int32_t bottom,
                   const Span* begin,
@@ -163,9 +215,16 @@ class DlRegion {
       std::vector<SpanLine>::const_iterator& a_it,
       std::vector<SpanLine>::const_iterator& b_it);
 
+  // The span lines of a region that is not tiled.
   std::vector<SpanLine> lines_;
   SkIRect bounds_ = SkIRect::MakeEmpty();
   SpanBuffer span_buffer_;
+
+  // The source rectangles, tile bitmap and span lines of a tiled region.
+  // They are shared between copies of the region.
+  std::shared_ptr<const std::vector<SkIRect>> rects_;
+  std::shared_ptr<const TileMask> tiles_;
+  std::shared_ptr<TiledSpans> tiled_spans_;
 };
 
 }  // namespace flutter
@@ -8,6 +8,7 @@
 #include "third_party/skia/include/core/SkRegion.h"
 
 #include <random>
+#include <thread>
 
 namespace flutter {
 namespace testing {
@@ -429,5 +430,189 @@ TEST(DisplayListRegion, TestAgainstSkRegion) {
   }
 }
 
+TEST(DisplayListRegion, AdaptiveRepresentation) {
+  std::vector<SkIRect> rects;
+  for (size_t i = 0; i < DlRegion::kTiledRectThreshold - 1; ++i) {
+    rects.push_back(SkIRect::MakeXYWH(i * 10, i % 7, 5, 5));
+  }
+  EXPECT_FALSE(DlRegion(rects).isTiled());
+  rects.push_back(SkIRect::MakeXYWH(0, 100, 5, 5));
+  DlRegion region(rects);
+  EXPECT_TRUE(region.isTiled());
+  EXPECT_FALSE(DlRegion(rects, DlRegion::Representation::kExact).isTiled());
+  EXPECT_EQ(region.getRects(),
+            DlRegion(rects, DlRegion::Representation::kExact).getRects());
+}
+
+TEST(DisplayListRegion, TiledRegionWithLargeBoundsIsExact) {
+  std::vector<SkIRect> rects{
+      SkIRect::MakeXYWH(0, 0, 10, 10),
+      SkIRect::MakeXYWH(100000, 100000, 10, 10),
+  };
+  DlRegion region(rects, DlRegion::Representation::kTiled);
+  EXPECT_FALSE(region.isTiled());
+  EXPECT_EQ(region.getRects().size(), 2u);
+
+  // Single rectangles are never tiled.
+  EXPECT_FALSE(DlRegion({SkIRect::MakeXYWH(0, 0, 10, 10)},
+                        DlRegion::Representation::kTiled)
+                   .isTiled());
+}
+
+TEST(DisplayListRegion, TiledRegionIntersects) {
+  DlRegion region(
+      {
+          SkIRect::MakeLTRB(-40, -40, 70, 70),
+          SkIRect::MakeLTRB(100, 0, 101, 1),
+      },
+      DlRegion::Representation::kTiled);
+  ASSERT_TRUE(region.isTiled());
+  EXPECT_TRUE(region.intersects(SkIRect::MakeLTRB(0, 0, 10, 10)));
+  EXPECT_TRUE(region.intersects(SkIRect::MakeLTRB(69, 69, 80, 80)));
+  EXPECT_FALSE(region.intersects(SkIRect::MakeLTRB(70, 70, 80, 80)));
+  EXPECT_TRUE(region.intersects(SkIRect::MakeLTRB(100, 0, 120, 10)));
+  EXPECT_FALSE(region.intersects(SkIRect::MakeLTRB(101, 0, 120, 10)));
+  EXPECT_FALSE(region.intersects(SkIRect::MakeLTRB(100, 1, 120, 10)));
+  EXPECT_FALSE(region.intersects(SkIRect::MakeLTRB(200, 0, 210, 10)));
+
+  DlRegion other(
+      {
+          SkIRect::MakeLTRB(70, 0, 100, 10),
+          SkIRect::MakeLTRB(101, 0, 110, 10),
+      },
+      DlRegion::Representation::kTiled);
+  ASSERT_TRUE(other.isTiled());
+  EXPECT_FALSE(region.intersects(other));
+  EXPECT_FALSE(other.intersects(region));
+  EXPECT_TRUE(region.intersects(DlRegion::MakeUnion(
+      other, DlRegion(SkIRect::MakeLTRB(100, 0, 101, 1)))));
+}
+
+TEST(DisplayListRegion, TiledRegionCanBeQueriedConcurrently) {
+  std::vector<SkIRect> rects;
+  for (int i = 0; i < 100; ++i) {
+    rects.push_back(SkIRect::MakeXYWH(i * 20, i * 10, 15, 15));
+  }
+  DlRegion region(rects, DlRegion::Representation::kTiled);
+  ASSERT_TRUE(region.isTiled());
+  DlRegion copy = region;
+  std::vector<SkIRect> expected = DlRegion(rects).getRects();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&region, &copy, &rects, &expected, t] {
+      const DlRegion& r = t % 2 == 0 ? region : copy;
+      for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(r.intersects(rects[i]));
+        EXPECT_FALSE(r.intersects(SkIRect::MakeXYWH(i * 20 + 16, 0, 1, 1)));
+      }
+      EXPECT_EQ(r.getRects(), expected);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(copy.getRects(), expected);
+}
+
+TEST(DisplayListRegion, UnionOfTiledRegionsIsTiled) {
+  DlRegion region1(
+      {
+          SkIRect::MakeXYWH(0, 0, 10, 10),
+          SkIRect::MakeXYWH(5, 5, 10, 10),
+      },
+      DlRegion::Representation::kTiled);
+  DlRegion region2(
+      {
+          SkIRect::MakeXYWH(5000, 5000, 10, 10),
+          SkIRect::MakeXYWH(5000, 5000, 5, 5),
+      },
+      DlRegion::Representation::kTiled);
+  ASSERT_TRUE(region1.isTiled());
+  ASSERT_TRUE(region2.isTiled());
+  DlRegion u = DlRegion::MakeUnion(region1, region2);
+  EXPECT_TRUE(u.isTiled());
+  EXPECT_EQ(u.bounds(), SkIRect::MakeLTRB(0, 0, 5010, 5010));
+  EXPECT_TRUE(u.intersects(SkIRect::MakeXYWH(5005, 5005, 1, 1)));
+  EXPECT_FALSE(u.intersects(SkIRect::MakeXYWH(2000, 2000, 1, 1)));
+  std::vector<SkIRect> expected{
+      SkIRect::MakeLTRB(0, 0, 10, 5),
+      SkIRect::MakeLTRB(0, 5, 15, 10),
+      SkIRect::MakeLTRB(5, 10, 15, 15),
+      SkIRect::MakeXYWH(5000, 5000, 10, 10),
+  };
+  EXPECT_EQ(u.getRects(), expected);
+
+  // The combined bounds span too many tiles to be tiled.
+  DlRegion u2 = DlRegion::MakeUnion(
+      u, DlRegion(SkIRect::MakeXYWH(100000, 100000, 10, 10)));
+  EXPECT_FALSE(u2.isTiled());
+  EXPECT_EQ(u2.getRects().size(), 5u);
+}
+
+TEST(DisplayListRegion, TiledRegionAgainstSkRegion) {
+  std::seed_seq seed{::testing::UnitTest::GetInstance()->random_seed()};
+  std::mt19937 rng(seed);
+
+  for (int max_size : {10, 100, 400}) {
+    // Negative coordinates exercise the rounding of the tile grid.
+    std::uniform_int_distribution pos(-1000, 1000);
+    std::uniform_int_distribution size(1, max_size);
+    std::uniform_int_distribution count(2, 100);
+
+    for (int iteration = 0; iteration < 20; ++iteration) {
+      std::vector<SkIRect> rects_in1;
+      std::vector<SkIRect> rects_in2;
+      for (int i = count(rng); i > 0; --i) {
+        rects_in1.push_back(
+            SkIRect::MakeXYWH(pos(rng), pos(rng), size(rng), size(rng)));
+      }
+      for (int i = count(rng); i > 0; --i) {
+        rects_in2.push_back(
+            SkIRect::MakeXYWH(pos(rng), pos(rng), size(rng), size(rng)));
+      }
+      SkRegion sk_region1;
+      sk_region1.setRects(rects_in1.data(), rects_in1.size());
+      SkRegion sk_region2;
+      sk_region2.setRects(rects_in2.data(), rects_in2.size());
+
+      // The queries are made before anything computes the span lines of
+      // the tiled regions.
+      DlRegion region1(rects_in1, DlRegion::Representation::kTiled);
+      DlRegion region2(rects_in2, DlRegion::Representation::kTiled);
+      ASSERT_TRUE(region1.isTiled());
+      ASSERT_TRUE(region2.isTiled());
+      for (const auto& r : rects_in2) {
+        EXPECT_EQ(region1.intersects(r), sk_region1.intersects(r));
+      }
+      EXPECT_EQ(region1.intersects(region2),
+                sk_region1.intersects(sk_region2));
+      EXPECT_EQ(region2.intersects(region1),
+                sk_region1.intersects(sk_region2));
+
+      DlRegion dl_union = DlRegion::MakeUnion(region1, region2);
+      EXPECT_TRUE(dl_union.isTiled());
+      SkRegion sk_union(sk_region1);
+      sk_union.op(sk_region2, SkRegion::kUnion_Op);
+      CheckEquality(dl_union, sk_union);
+
+      SkIRect clip = rects_in2.front();
+      DlRegion dl_clipped =
+          DlRegion::MakeIntersection(region1, DlRegion(clip));
+      SkRegion sk_clipped(sk_region1);
+      sk_clipped.op(clip, SkRegion::kIntersect_Op);
+      CheckEquality(dl_clipped, sk_clipped);
+
+      DlRegion dl_intersection = DlRegion::MakeIntersection(region1, region2);
+      SkRegion sk_intersection(sk_region1);
+      sk_intersection.op(sk_region2, SkRegion::kIntersect_Op);
+      CheckEquality(dl_intersection, sk_intersection);
+
+      CheckEquality(region1, sk_region1);
+      CheckEquality(region2, sk_region2);
+    }
+  }
+}
+
 }  // namespace testing
 }  // namespace flutter
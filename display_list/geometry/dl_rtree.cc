@@ -5,10 +5,103 @@
 #include "flutter/display_list/geometry/dl_rtree.h"
 #include "flutter/display_list/geometry/dl_region.h"
 
+#include <algorithm>
+#include <array>
+#include <limits>
+
 #include "flutter/fml/logging.h"
 
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace flutter {
 
+namespace {
+
+// The Hilbert curve used to order the leaves divides the bounds of the
+// tree into a grid of 512 x 512 cells, which is plenty to group nearby
+// rects together while keeping the distances along the curve small enough
+// to be sorted in 2 passes of a radix sort.
+constexpr int kHilbertOrder = 9;
+constexpr uint32_t kHilbertMax = (1u << kHilbertOrder) - 1u;
+
+uint32_t QuantizeForHilbert(float value, float min, float scale) {
+  float t = (value - min) * scale;
+  // Also catches NaN values from infinite rects.
+  if (!(t > 0.0f)) {
+    return 0u;
+  }
+  return t >= kHilbertMax ? kHilbertMax : static_cast<uint32_t>(t);
+}
+
+// The distance along the curve is computed 3 bits of each coordinate at a
+// time. Each entry of the table is indexed by the orientation of the curve
+// within the current cell and the next 3 bits of x and y, and holds the
+// next 6 bits of the distance in its low bits and the orientation of the
+// curve within the next cell in its top 2 bits. The orientation records
+// whether the coordinates are flipped (bit 1) and/or swapped (bit 0).
+constexpr std::array<uint8_t, 256> MakeHilbertTable() {
+  std::array<uint8_t, 256> table = {};
+  for (uint32_t state = 0u; state < 4u; state++) {
+    for (uint32_t x_bits = 0u; x_bits < 8u; x_bits++) {
+      for (uint32_t y_bits = 0u; y_bits < 8u; y_bits++) {
+        uint32_t orientation = state;
+        uint32_t distance = 0u;
+        for (int bit = 2; bit >= 0; bit--) {
+          uint32_t x = (x_bits >> bit) & 1u;
+          uint32_t y = (y_bits >> bit) & 1u;
+          if ((orientation & 2u) != 0u) {
+            x ^= 1u;
+            y ^= 1u;
+          }
+          if ((orientation & 1u) != 0u) {
+            uint32_t t = x;
+            x = y;
+            y = t;
+          }
+          distance = (distance << 2) | ((3u * x) ^ y);
+          orientation ^= ((x & (y ^ 1u)) << 1) | (y ^ 1u);
+        }
+        table[(state << 6) | (x_bits << 3) | y_bits] =
+            static_cast<uint8_t>(distance | (orientation << 6));
+      }
+    }
+  }
+  return table;
+}
+
+constexpr std::array<uint8_t, 256> kHilbertTable = MakeHilbertTable();
+
+// Returns the distance along the Hilbert curve of the point x, y where both
+// coordinates are between 0 and kHilbertMax.
+uint32_t HilbertIndex(uint32_t x, uint32_t y) {
+  static_assert(kHilbertOrder % 3 == 0);
+  uint32_t distance = 0u;
+  uint32_t orientation = 0u;
+  for (int shift = kHilbertOrder - 3; shift >= 0; shift -= 3) {
+    uint32_t entry = kHilbertTable[(orientation << 6) |
+                                   (((x >> shift) & 7u) << 3) |
+                                   ((y >> shift) & 7u)];
+    distance = (distance << 6) | (entry & 63u);
+    orientation = entry >> 6;
+  }
+  return distance;
+}
+
+int LowestBit(uint32_t mask) {
+  FML_DCHECK(mask != 0u);
+  int bit = 0;
+  while ((mask & (1u << bit)) == 0u) {
+    bit++;
+  }
+  return bit;
+}
+
+}  // namespace
+
 DlRTree::DlRTree(const SkRect rects[],
                  int N,
                  const int ids[],
@@ -33,110 +126,203 @@ DlRTree::DlRTree(const SkRect rects[],
     }
   }
   leaf_count_ = leaf_count;
-
-  // Count the total number of nodes (leaf and internal) up front
-  // so we can resize the vector just once.
-  uint32_t total_node_count = leaf_count;
-  uint32_t gen_count = leaf_count;
-  while (gen_count > 1) {
-    uint32_t family_count = (gen_count + kMaxChildren - 1u) / kMaxChildren;
-    total_node_count += family_count;
-    gen_count = family_count;
+  if (leaf_count == 0) {
+    return;
   }
 
-  nodes_.resize(total_node_count);
-
-  // Now place only the tracked rectangles into the nodes array
-  // in the first leaf_count_ entries.
-  int leaf_index = 0;
+  // Now place only the tracked rectangles into the leaves in the
+  // order in which they appear in the list.
+  leaves_.reserve(leaf_count);
   int id = invalid_id;
   for (int i = 0; i < N; i++) {
     if (!rects[i].isEmpty()) {
       if (ids == nullptr || p(id = ids[i])) {
-        Node& node = nodes_[leaf_index++];
-        node.bounds = rects[i];
-        node.id = id;
+        leaves_.push_back({rects[i], id});
+        bounds_.join(rects[i]);
       }
     }
   }
-  FML_DCHECK(leaf_index == leaf_count);
+  FML_DCHECK(static_cast<int>(leaves_.size()) == leaf_count);
 
   // --- Implementation note ---
-  // Many R-Tree algorithms attempt to consolidate nearby rectangles
-  // into branches of the tree in order to maximize the benefit of
-  // bounds testing against whole sub-trees. The Skia code from which
-  // this was based, though, indicated that empirical tests against a
-  // browser client showed little gains in rendering performance while
-  // costing 17% performance in bulk loading the rects into the R-Tree:
-  // https://github.com/google/skia/blob/12b6bd042f7cdffb9012c90c3b4885601fc7be95/src/core/SkRTree.cpp#L96
+  // The Skia code from which this was originally based kept the leaves
+  // in the order in which they were delivered, on the grounds that apps
+  // tend to render in a "page layout" fashion from top to bottom so that
+  // the rects are nearly sorted anyway. That is not true of lists that
+  // scatter sprites, particles or map tiles around the screen, where
+  // every branch ends up covering most of the list and a query has to
+  // visit nearly all of them.
   //
-  // Given that this class will most often be used to track rendering
-  // operations that were drawn in an app that performs a type of
-  // "page layout" with rendering proceeding in a linear fashion from
-  // top to bottom (and left to right or right to left), the rectangles
-  // are likely nearly sorted when they are delivered to this constructor
-  // so leaving them in their original order should show similar results
-  // to what Skia found in their empirical browser tests.
+  // Instead the leaves are attached to the branches in the order of the
+  // centers of their rects along a Hilbert curve through the bounds of
+  // the tree, which keeps the bounds of each branch compact whatever the
+  // order in which the rects were drawn. The leaves themselves stay in
+  // their original order so that the indices returned from the queries
+  // still reflect the order of the rects.
   // ---
+  const float width = bounds_.width();
+  const float height = bounds_.height();
+  const float scale_x = width > 0.0f ? kHilbertMax / width : 0.0f;
+  const float scale_y = height > 0.0f ? kHilbertMax / height : 0.0f;
+  std::vector<uint32_t> keys(leaf_count);
+  for (int i = 0; i < leaf_count; i++) {
+    const SkRect& rect = leaves_[i].bounds;
+    uint32_t x = QuantizeForHilbert(rect.centerX(), bounds_.fLeft, scale_x);
+    uint32_t y = QuantizeForHilbert(rect.centerY(), bounds_.fTop, scale_y);
+    keys[i] = HilbertIndex(x, y);
+  }
+  // A stable radix sort in 2 passes of |kHilbertOrder| bits each, so that
+  // ties are broken by the original order of the leaves.
+  sorted_leaves_.resize(leaf_count);
+  for (int i = 0; i < leaf_count; i++) {
+    sorted_leaves_[i] = i;
+  }
+  std::vector<uint32_t> scratch(leaf_count);
+  for (int shift = 0; shift < 2 * kHilbertOrder; shift += kHilbertOrder) {
+    uint32_t starts[kHilbertMax + 2u] = {};
+    for (int i = 0; i < leaf_count; i++) {
+      starts[((keys[i] >> shift) & kHilbertMax) + 1u]++;
+    }
+    for (uint32_t digit = 1u; digit <= kHilbertMax; digit++) {
+      starts[digit + 1u] += starts[digit];
+    }
+    for (uint32_t leaf : sorted_leaves_) {
+      scratch[starts[(keys[leaf] >> shift) & kHilbertMax]++] = leaf;
+    }
+    sorted_leaves_.swap(scratch);
+  }
+
+  // Each level of branches groups up to |kBranchFactor| consecutive
+  // nodes of the level below it until there is just one branch left,
+  // which is the root of the R-Tree.
+  std::vector<uint32_t> level_sizes;
+  uint32_t level_size = leaf_count;
+  do {
+    level_size = (level_size + kBranchFactor - 1u) / kBranchFactor;
+    level_sizes.push_back(level_size);
+  } while (level_size > 1u);
+  FML_DCHECK(level_sizes.size() <= kMaxDepth);
+
+  // The levels were counted from the bottom up, but are stored from the
+  // root down.
+  const uint32_t level_count = level_sizes.size();
+  level_starts_.resize(level_count);
+  uint32_t branch_count = 0u;
+  for (uint32_t level = 0u; level < level_count; level++) {
+    level_starts_[level] = branch_count;
+    branch_count += level_sizes[level_count - 1u - level];
+  }
 
-  // Continually process the previous level (generation) of nodes,
-  // combining them into a new generation of parent groups each grouping
-  // at most |kMaxChildren| children and joining their bounds into its
-  // parent bounds.
-  // Each generation will end up reduced by a factor of up to kMaxChildren
-  // until there is just one node left, which is the root node of
-  // the R-Tree.
-  uint32_t gen_start = 0;
-  gen_count = leaf_count;
-  while (gen_count > 1) {
-    uint32_t gen_end = gen_start + gen_count;
-
-    uint32_t family_count = (gen_count + kMaxChildren - 1u) / kMaxChildren;
-    FML_DCHECK(gen_end + family_count <= total_node_count);
-
-    // D here is similar to the variable in a Bresenham line algorithm where
-    // we want to slowly move |family_count| steps along the minor axis as
-    // we move |gen_count| steps along the major axis.
-    //
-    // Each inner loop increments D by family_count.
-    // The inner loop executes a total of gen_count times.
-    // Every time D exceeds 0 we subtract gen_count and move to a new parent.
-    // All told we will increment D by family_count a total of gen_count times.
-    // All told we will decrement D by gen_count a total of family_count times.
-    // This leaves D back at its starting value.
-    //
-    // We could bias/balance where the extra children are placed by varying
-    // the initial count of D from 0 to (1 - family_count), but we aren't
-    // looking at this process aesthetically so we just use 0 as an initial
-    // value. Using 0 provides a "greedy" allocation of the extra children.
-    // Bresenham also uses double the size of the steps we use here also to
-    // have better rounding of when the minor axis steps occur, but again we
-    // don't care about the distribution of the extra children.
-    int D = 0;
-
-    uint32_t sibling_index = gen_start;
-    uint32_t parent_index = gen_end;
-    Node* parent = nullptr;
-    while (sibling_index < gen_end) {
-      if ((D += family_count) > 0) {
-        D -= gen_count;
-        FML_DCHECK(parent_index < gen_end + family_count);
-        parent = &nodes_[parent_index++];
-        parent->bounds.setEmpty();
-        parent->child.index = sibling_index;
-        parent->child.count = 0;
+  Branch empty_branch;
+  for (int lane = 0; lane < kBranchFactor; lane++) {
+    empty_branch.left[lane] = std::numeric_limits<float>::infinity();
+    empty_branch.top[lane] = std::numeric_limits<float>::infinity();
+    empty_branch.right[lane] = -std::numeric_limits<float>::infinity();
+    empty_branch.bottom[lane] = -std::numeric_limits<float>::infinity();
+  }
+  branches_.resize(branch_count, empty_branch);
+
+  auto set_child = [](Branch& branch, uint32_t lane, const SkRect& bounds) {
+    branch.left[lane] = bounds.fLeft;
+    branch.top[lane] = bounds.fTop;
+    branch.right[lane] = bounds.fRight;
+    branch.bottom[lane] = bounds.fBottom;
+  };
+  auto branch_bounds = [](const Branch& branch) {
+    SkRect bounds = SkRect::MakeLTRB(branch.left[0], branch.top[0],
+                                     branch.right[0], branch.bottom[0]);
+    for (int lane = 1; lane < kBranchFactor; lane++) {
+      bounds.fLeft = std::min(bounds.fLeft, branch.left[lane]);
+      bounds.fTop = std::min(bounds.fTop, branch.top[lane]);
+      bounds.fRight = std::max(bounds.fRight, branch.right[lane]);
+      bounds.fBottom = std::max(bounds.fBottom, branch.bottom[lane]);
+    }
+    return bounds;
+  };
+
+  const uint32_t leaf_level = level_count - 1u;
+  Branch* leaf_parents = &branches_[level_starts_[leaf_level]];
+  for (int i = 0; i < leaf_count; i++) {
+    set_child(leaf_parents[i / kBranchFactor], i % kBranchFactor,
+              leaves_[sorted_leaves_[i]].bounds);
+  }
+  for (uint32_t level = leaf_level; level > 0u; level--) {
+    const uint32_t start = level_starts_[level];
+    const uint32_t end =
+        level < leaf_level ? level_starts_[level + 1u] : branch_count;
+    Branch* parents = &branches_[level_starts_[level - 1u]];
+    for (uint32_t index = start; index < end; index++) {
+      const uint32_t position = index - start;
+      set_child(parents[position / kBranchFactor], position % kBranchFactor,
+                branch_bounds(branches_[index]));
+    }
+  }
+}
+
+void DlRTree::Branch::Test(const SkRect& query,
+                           uint32_t* intersecting,
+                           uint32_t* contained) const {
+  static_assert(kBranchFactor == 4);
+#if defined(__SSE2__)
+  const __m128 left = _mm_load_ps(this->left);
+  const __m128 top = _mm_load_ps(this->top);
+  const __m128 right = _mm_load_ps(this->right);
+  const __m128 bottom = _mm_load_ps(this->bottom);
+  const __m128 query_left = _mm_set1_ps(query.fLeft);
+  const __m128 query_top = _mm_set1_ps(query.fTop);
+  const __m128 query_right = _mm_set1_ps(query.fRight);
+  const __m128 query_bottom = _mm_set1_ps(query.fBottom);
+  const __m128 hit = _mm_and_ps(
+      _mm_and_ps(_mm_cmplt_ps(left, query_right),
+                 _mm_cmplt_ps(query_left, right)),
+      _mm_and_ps(_mm_cmplt_ps(top, query_bottom),
+                 _mm_cmplt_ps(query_top, bottom)));
+  const __m128 inside = _mm_and_ps(
+      _mm_and_ps(_mm_cmpge_ps(left, query_left),
+                 _mm_cmpge_ps(top, query_top)),
+      _mm_and_ps(_mm_cmple_ps(right, query_right),
+                 _mm_cmple_ps(bottom, query_bottom)));
+  *intersecting = _mm_movemask_ps(hit);
+  *contained = _mm_movemask_ps(_mm_and_ps(hit, inside));
+#elif defined(__ARM_NEON)
+  const float32x4_t left = vld1q_f32(this->left);
+  const float32x4_t top = vld1q_f32(this->top);
+  const float32x4_t right = vld1q_f32(this->right);
+  const float32x4_t bottom = vld1q_f32(this->bottom);
+  const float32x4_t query_left = vdupq_n_f32(query.fLeft);
+  const float32x4_t query_top = vdupq_n_f32(query.fTop);
+  const float32x4_t query_right = vdupq_n_f32(query.fRight);
+  const float32x4_t query_bottom = vdupq_n_f32(query.fBottom);
+  const uint32x4_t hit = vandq_u32(
+      vandq_u32(vcltq_f32(left, query_right), vcltq_f32(query_left, right)),
+      vandq_u32(vcltq_f32(top, query_bottom), vcltq_f32(query_top, bottom)));
+  const uint32x4_t inside = vandq_u32(
+      vandq_u32(vcgeq_f32(left, query_left), vcgeq_f32(top, query_top)),
+      vandq_u32(vcleq_f32(right, query_right),
+                vcleq_f32(bottom, query_bottom)));
+  static const uint32_t kLaneBits[4] = {1u, 2u, 4u, 8u};
+  const uint32x4_t lane_bits = vld1q_u32(kLaneBits);
+  uint32_t lanes[4];
+  vst1q_u32(lanes, vandq_u32(hit, lane_bits));
+  *intersecting = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+  vst1q_u32(lanes, vandq_u32(vandq_u32(hit, inside), lane_bits));
+  *contained = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+#else
+  uint32_t hits = 0u;
+  uint32_t insides = 0u;
+  for (int lane = 0; lane < kBranchFactor; lane++) {
+    if (left[lane] < query.fRight && query.fLeft < right[lane] &&
+        top[lane] < query.fBottom && query.fTop < bottom[lane]) {
+      hits |= 1u << lane;
+      if (left[lane] >= query.fLeft && top[lane] >= query.fTop &&
+          right[lane] <= query.fRight && bottom[lane] <= query.fBottom) {
+        insides |= 1u << lane;
       }
-      FML_DCHECK(parent != nullptr);
-      parent->bounds.join(nodes_[sibling_index++].bounds);
-      parent->child.count++;
     }
-    FML_DCHECK(D == 0);
-    FML_DCHECK(sibling_index == gen_end);
-    FML_DCHECK(parent_index == gen_end + family_count);
-    gen_start = gen_end;
-    gen_count = family_count;
   }
-  FML_DCHECK(gen_start + gen_count == total_node_count);
+  *intersecting = hits;
+  *contained = insides;
+#endif  // __SSE2__
 }
 
 void DlRTree::search(const SkRect& query, std::vector<int>* results) const {
@@ -144,35 +330,105 @@ void DlRTree::search(const SkRect& query, std::vector<int>* results) const {
   if (query.isEmpty()) {
     return;
   }
-  if (nodes_.size() <= 0) {
-    FML_DCHECK(leaf_count_ == 0);
+  if (query.contains(bounds_)) {
+    // Every leaf is a hit and they are already in order.
+    results->reserve(results->size() + leaf_count_);
+    for (int i = 0; i < leaf_count_; i++) {
+      results->push_back(i);
+    }
+    return;
+  }
+  const size_t first = results->size();
+  searchEach(query, [results](int index) {
+    results->push_back(index);
+    return true;
+  });
+  // The tree is traversed in the order of the Hilbert curve, but the
+  // results are reported in the order of the original rects.
+  const size_t count = results->size() - first;
+  if (count * 16u < static_cast<size_t>(leaf_count_)) {
+    std::sort(results->begin() + first, results->end());
     return;
   }
-  const Node& root = nodes_.back();
-  if (root.bounds.intersects(query)) {
-    if (nodes_.size() == 1) {
-      FML_DCHECK(leaf_count_ == 1);
-      // The root node is the only node and it is a leaf node
-      results->push_back(0);
+  // With this many hits it is cheaper to mark them and scan all of the
+  // leaves in order.
+  std::vector<uint8_t> is_hit(leaf_count_, 0u);
+  for (size_t i = first; i < results->size(); i++) {
+    is_hit[(*results)[i]] = 1u;
+  }
+  // The scan below writes every leaf and only advances past the hits, so
+  // it needs one spare slot at the end.
+  results->push_back(0);
+  int* out = results->data() + first;
+  for (int i = 0; i < leaf_count_; i++) {
+    *out = i;
+    out += is_hit[i];
+  }
+  results->pop_back();
+  FML_DCHECK(out == results->data() + results->size());
+}
+
+bool DlRTree::searchEach(const SkRect& query,
+                         Visitor visitor,
+                         void* context) const {
+  if (query.isEmpty() || branches_.empty()) {
+    return true;
+  }
+
+  struct Frame {
+    uint32_t position;
+    uint32_t intersecting;
+    uint32_t contained;
+  };
+  Frame stack[kMaxDepth];
+  const int leaf_level = static_cast<int>(level_starts_.size()) - 1;
+
+  int depth = 0;
+  stack[0].position = 0u;
+  branches_[0].Test(query, &stack[0].intersecting, &stack[0].contained);
+  while (depth >= 0) {
+    Frame& frame = stack[depth];
+    if (frame.intersecting == 0u) {
+      depth--;
+      continue;
+    }
+    const uint32_t lane = LowestBit(frame.intersecting);
+    const uint32_t bit = 1u << lane;
+    frame.intersecting &= ~bit;
+    const uint32_t child = frame.position * kBranchFactor + lane;
+    if (depth == leaf_level || (frame.contained & bit) != 0u) {
+      // The child is either a leaf that intersects the query or a branch
+      // whose leaves all lie inside of the query, either way all of the
+      // leaves below it are hits without any further tests.
+      const uint64_t span = uint64_t{1} << (2 * (leaf_level - depth));
+      const uint64_t begin = child * span;
+      const uint64_t end =
+          std::min(begin + span, static_cast<uint64_t>(leaf_count_));
+      for (uint64_t i = begin; i < end; i++) {
+        if (!visitor(context, sorted_leaves_[i])) {
+          return false;
+        }
+      }
     } else {
-      search(root, query, results);
+      depth++;
+      FML_DCHECK(depth <= leaf_level);
+      Frame& child_frame = stack[depth];
+      child_frame.position = child;
+      branches_[level_starts_[depth] + child].Test(
+          query, &child_frame.intersecting, &child_frame.contained);
     }
   }
+  return true;
 }
 
 std::list<SkRect> DlRTree::searchAndConsolidateRects(const SkRect& query,
                                                      bool deband) const {
-  // Get the indexes for the operations that intersect with the query rect.
-  std::vector<int> intermediary_results;
-  search(query, &intermediary_results);
-
+  // Get the bounds of the operations that intersect with the query rect.
   std::vector<SkIRect> rects;
-  rects.reserve(intermediary_results.size());
-  for (int index : intermediary_results) {
-    SkIRect current_record_rect;
-    bounds(index).roundOut(&current_record_rect);
-    rects.push_back(current_record_rect);
-  }
+  searchEach(query, [this, &rects](int index) {
+    rects.push_back(bounds(index).roundOut());
+    return true;
+  });
   DlRegion region(rects);
 
   auto non_overlapping_rects = region.getRects(deband);
@@ -183,42 +439,16 @@ std::list<SkRect> DlRTree::searchAndConsolidateRects(const SkRect& query,
   return final_results;
 }
 
-void DlRTree::search(const Node& parent,
-                     const SkRect& query,
-                     std::vector<int>* results) const {
-  // Caller protects against empty query
-  int start = parent.child.index;
-  int end = start + parent.child.count;
-  for (int i = start; i < end; i++) {
-    const Node& node = nodes_[i];
-    if (node.bounds.intersects(query)) {
-      if (i < leaf_count_) {
-        results->push_back(i);
-      } else {
-        search(node, query, results);
-      }
-    }
-  }
-}
-
 const DlRegion& DlRTree::region() const {
   if (!region_) {
     std::vector<SkIRect> rects;
     rects.resize(leaf_count_);
     for (int i = 0; i < leaf_count_; i++) {
-      nodes_[i].bounds.roundOut(&rects[i]);
+      leaves_[i].bounds.roundOut(&rects[i]);
     }
     region_.emplace(rects);
   }
   return *region_;
 }
 
-const SkRect& DlRTree::bounds() const {
-  if (!nodes_.empty()) {
-    return nodes_.back().bounds;
-  } else {
-    return kEmpty;
-  }
-}
-
 }  // namespace flutter
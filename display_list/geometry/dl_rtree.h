@@ -7,6 +7,7 @@
 
 #include <list>
 #include <optional>
+#include <type_traits>
 #include <vector>
 
 #include "flutter/display_list/geometry/dl_region.h"
@@ -22,25 +23,37 @@ namespace flutter {
 ///
 /// The R-Tree can be searched in one of two ways:
 /// - Query for a list of hits among the original rectangles
-///   @see |search|
+///   @see |search| and |searchEach|
 /// - Query for a set of non-overlapping rectangles that are joined
 ///   from the original rectangles that intersect a query rect
 ///   @see |searchAndConsolidateRects|
 class DlRTree : public SkRefCnt {
  private:
-  static constexpr int kMaxChildren = 11;
+  // Each branch node holds the bounds of up to 4 children so that all of
+  // them can be tested against a query with a single SIMD comparison.
+  static constexpr int kBranchFactor = 4;
 
-  // Leaf nodes at start of vector have an ID,
-  // Internal nodes after that have child index and count.
-  struct Node {
+  // Enough levels of branches to hold 2^32 leaves.
+  static constexpr int kMaxDepth = 16;
+
+  struct Leaf {
     SkRect bounds;
-    union {
-      struct {
-        uint32_t index;
-        uint32_t count;
-      } child;
-      int id;
-    };
+    int id;
+  };
+
+  // The bounds of the children of a branch node, stored by coordinate.
+  // Unused children have inverted bounds that never intersect a query.
+  struct alignas(16) Branch {
+    float left[kBranchFactor];
+    float top[kBranchFactor];
+    float right[kBranchFactor];
+    float bottom[kBranchFactor];
+
+    // Returns a bit mask of the children that intersect the query and
+    // the subset of those that are contained within it.
+    void Test(const SkRect& query,
+              uint32_t* intersecting,
+              uint32_t* contained) const;
   };
 
  public:
@@ -80,29 +93,52 @@ class DlRTree : public SkRefCnt {
   /// |DlRTree::id| and |DlRTree::bounds| methods.
   void search(const SkRect& query, std::vector<int>* results) const;
 
+  /// Search the rectangles and call |callback| with the leaf node index
+  /// of each rectangle that intersects the query, stopping as soon as the
+  /// callback returns false.
+  ///
+  /// Unlike the vector version of |search|, the indices are delivered
+  /// in the spatial order of the tree rather than in the order in which
+  /// the rectangles were passed into the constructor. The search does not
+  /// allocate any memory.
+  ///
+  /// @return false if the search was stopped by the callback.
+  template <typename Callback>
+  bool searchEach(const SkRect& query, Callback&& callback) const {
+    using CallbackType = std::remove_reference_t<Callback>;
+    return searchEach(
+        query,
+        [](void* context, int index) -> bool {
+          return (*static_cast<CallbackType*>(context))(index);
+        },
+        const_cast<void*>(static_cast<const void*>(&callback)));
+  }
+
   /// Return the ID for the indicated result of a query or
   /// invalid_id if the index is not a valid leaf node index.
   int id(int result_index) const {
     return (result_index >= 0 && result_index < leaf_count_)
-               ? nodes_[result_index].id
+               ? leaves_[result_index].id
                : invalid_id_;
   }
 
   /// Returns maximum and minimum axis values of rectangles in this R-Tree.
   /// If R-Tree is empty returns an empty SkRect.
-  const SkRect& bounds() const;
+  const SkRect& bounds() const { return bounds_; }
 
   /// Return the rectangle bounds for the indicated result of a query
   /// or an empty rect if the index is not a valid leaf node index.
   const SkRect& bounds(int result_index) const {
     return (result_index >= 0 && result_index < leaf_count_)
-               ? nodes_[result_index].bounds
+               ? leaves_[result_index].bounds
                : kEmpty;
   }
 
   /// Returns the bytes used by the object and all of its node data.
   size_t bytes_used() const {
-    return sizeof(DlRTree) + sizeof(Node) * nodes_.size();
+    return sizeof(DlRTree) + sizeof(Leaf) * leaves_.size() +
+           sizeof(Branch) * branches_.size() +
+           sizeof(uint32_t) * (sorted_leaves_.size() + level_starts_.size());
   }
 
   /// Returns the number of leaf nodes corresponding to non-empty
@@ -111,8 +147,8 @@ class DlRTree : public SkRefCnt {
   int leaf_count() const { return leaf_count_; }
 
   /// Return the total number of nodes used in the R-Tree, both leaf
-  /// and internal consolidation nodes.
-  int node_count() const { return nodes_.size(); }
+  /// and internal branch nodes.
+  int node_count() const { return leaf_count_ + branches_.size(); }
 
   /// Finds the rects in the tree that intersect with the query rect.
   ///
@@ -139,11 +175,23 @@ class DlRTree : public SkRefCnt {
  private:
   static constexpr SkRect kEmpty = SkRect::MakeEmpty();
 
-  void search(const Node& parent,
-              const SkRect& query,
-              std::vector<int>* results) const;
-
-  std::vector<Node> nodes_;
+  using Visitor = bool (*)(void* context, int index);
+  bool searchEach(const SkRect& query, Visitor visitor, void* context) const;
+
+  // The leaves in the order in which they were passed to the constructor,
+  // which is the order of the leaf node indices returned by the queries.
+  std::vector<Leaf> leaves_;
+  // The leaf node indices sorted along a Hilbert curve, which is the
+  // order in which they are attached to the branches.
+  std::vector<uint32_t> sorted_leaves_;
+  // The branches, stored breadth first starting with the root. The
+  // children of the branch at position P of a level are found at
+  // positions 4P to 4P+3 of the next level, or of |sorted_leaves_| for
+  // the last level.
+  std::vector<Branch> branches_;
+  // The index in |branches_| of the first branch of each level.
+  std::vector<uint32_t> level_starts_;
+  SkRect bounds_ = kEmpty;
   int leaf_count_ = 0;
   int invalid_id_;
   mutable std::optional<DlRegion> region_;
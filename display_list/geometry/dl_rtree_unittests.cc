@@ -7,6 +7,8 @@
 
 #include "third_party/skia/include/core/SkRect.h"
 
+#include <algorithm>
+
 namespace flutter {
 namespace testing {
 
@@ -301,6 +303,91 @@ TEST(DisplayListRTree, OverlappingRects) {
   EXPECT_EQ(list.front(), SkRect::MakeLTRB(0, 0, 70, 70));
 }
 
+TEST(DisplayListRTree, SearchEach) {
+  // The same grid of 10 x 10 rectangles as the Grid test.
+  const int ROWS = 10;
+  const int COLS = 10;
+  const int N = ROWS * COLS;
+  SkRect rects[N];
+  for (int r = 0; r < ROWS; r++) {
+    for (int c = 0; c < COLS; c++) {
+      rects[r * COLS + c] = SkRect::MakeXYWH(c * 20 + 5, r * 20 + 5, 10, 10);
+    }
+  }
+  DlRTree tree(rects, N);
+
+  std::vector<int> hits;
+  auto collect = [&hits](int index) {
+    hits.push_back(index);
+    return true;
+  };
+  EXPECT_TRUE(tree.searchEach(SkRect::MakeEmpty(), collect));
+  EXPECT_EQ(hits.size(), 0u);
+
+  // A query that spans the gap between 2 rows and 2 columns.
+  EXPECT_TRUE(tree.searchEach(SkRect::MakeXYWH(34, 34, 12, 12), collect));
+  std::sort(hits.begin(), hits.end());
+  EXPECT_EQ(hits, std::vector<int>({11, 12, 21, 22}));
+
+  // A query that covers everything visits every rect exactly once.
+  hits.clear();
+  EXPECT_TRUE(tree.searchEach(SkRect::MakeLTRB(0, 0, 500, 500), collect));
+  std::sort(hits.begin(), hits.end());
+  ASSERT_EQ(hits.size(), static_cast<size_t>(N));
+  for (int i = 0; i < N; i++) {
+    EXPECT_EQ(hits[i], i);
+  }
+
+  // The search stops as soon as the callback returns false.
+  int count = 0;
+  EXPECT_FALSE(tree.searchEach(SkRect::MakeLTRB(0, 0, 500, 500),
+                               [&count](int index) { return ++count < 3; }));
+  EXPECT_EQ(count, 3);
+}
+
+TEST(DisplayListRTree, ScatteredRects) {
+  // Rects drawn in a random order are found just as well as rects drawn
+  // from top to bottom and are still reported in the order in which they
+  // were passed to the constructor.
+  const int N = 5000;
+  std::vector<SkRect> rects;
+  std::vector<int> ids;
+  uint32_t seed = 12345u;
+  auto next = [&seed](int range) {
+    seed = seed * 1103515245u + 12345u;
+    return static_cast<int>((seed >> 8) % range);
+  };
+  for (int i = 0; i < N; i++) {
+    rects.push_back(SkRect::MakeXYWH(next(2000), next(2000), next(40) + 1,
+                                     next(40) + 1));
+    ids.push_back(i * 2);
+  }
+  // Filter out every other rect so that the leaf indices differ from the
+  // rect indices.
+  DlRTree tree(rects.data(), N, ids.data(),
+               [](int id) { return (id % 4) == 0; });
+  ASSERT_EQ(tree.leaf_count(), N / 2);
+
+  std::vector<int> results;
+  for (int q = 0; q < 100; q++) {
+    SkRect query = SkRect::MakeXYWH(next(2000), next(2000), next(300) + 1,
+                                    next(300) + 1);
+    std::vector<int> expected;
+    for (int i = 0; i < N; i += 2) {
+      if (rects[i].intersects(query)) {
+        expected.push_back(i / 2);
+      }
+    }
+    results.clear();
+    tree.search(query, &results);
+    EXPECT_EQ(results, expected) << "query " << q;
+    for (int result : results) {
+      EXPECT_EQ(tree.bounds(result), rects[result * 2]);
+      EXPECT_EQ(tree.id(result), result * 4);
+    }
+  }
+}
+
 TEST(DisplayListRTree, Region) {
   SkRect rect[9];
   for (int i = 0; i < 9; i++) {
@@ -4,8 +4,98 @@
 
 #include "flutter/display_list/utils/dl_accumulation_rect.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace flutter {
 
+namespace {
+
+constexpr DlScalar kInfinity = std::numeric_limits<DlScalar>::infinity();
+
+// Computes the bounds of the finite points in the array as {min_x, min_y,
+// max_x, max_y}, leaving the bounds inverted if there are no such points.
+void ComputeFinitePointBounds(const DlPoint points[],
+                              size_t count,
+                              DlScalar bounds[4]) {
+  static_assert(sizeof(DlPoint) == 2 * sizeof(DlScalar));
+  DlScalar min_x = kInfinity;
+  DlScalar min_y = kInfinity;
+  DlScalar max_x = -kInfinity;
+  DlScalar max_y = -kInfinity;
+  size_t i = 0u;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+  // Two points are processed per vector as {x0, y0, x1, y1}.
+  const DlScalar* data = reinterpret_cast<const DlScalar*>(points);
+  float lanes_min[4];
+  float lanes_max[4];
+#if defined(__SSE2__)
+  const __m128 inf = _mm_set1_ps(kInfinity);
+  const __m128 neg_inf = _mm_set1_ps(-kInfinity);
+  const __m128 zero = _mm_setzero_ps();
+  __m128 vmin = inf;
+  __m128 vmax = neg_inf;
+  for (; i + 2u <= count; i += 2u) {
+    __m128 v = _mm_loadu_ps(data + i * 2u);
+    // v - v is 0 for finite values and NaN for infinities and NaNs, and
+    // a point is only used if both of its coordinates are finite.
+    __m128 finite = _mm_cmpeq_ps(_mm_sub_ps(v, v), zero);
+    finite = _mm_and_ps(
+        finite, _mm_shuffle_ps(finite, finite, _MM_SHUFFLE(2, 3, 0, 1)));
+    vmin = _mm_min_ps(
+        vmin, _mm_or_ps(_mm_and_ps(finite, v), _mm_andnot_ps(finite, inf)));
+    vmax = _mm_max_ps(vmax, _mm_or_ps(_mm_and_ps(finite, v),
+                                      _mm_andnot_ps(finite, neg_inf)));
+  }
+  _mm_storeu_ps(lanes_min, vmin);
+  _mm_storeu_ps(lanes_max, vmax);
+#else   // __ARM_NEON
+  const float32x4_t inf = vdupq_n_f32(kInfinity);
+  const float32x4_t neg_inf = vdupq_n_f32(-kInfinity);
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  float32x4_t vmin = inf;
+  float32x4_t vmax = neg_inf;
+  for (; i + 2u <= count; i += 2u) {
+    float32x4_t v = vld1q_f32(data + i * 2u);
+    // v - v is 0 for finite values and NaN for infinities and NaNs, and
+    // a point is only used if both of its coordinates are finite.
+    uint32x4_t finite = vceqq_f32(vsubq_f32(v, v), zero);
+    finite = vandq_u32(finite, vrev64q_u32(finite));
+    vmin = vminq_f32(vmin, vbslq_f32(finite, v, inf));
+    vmax = vmaxq_f32(vmax, vbslq_f32(finite, v, neg_inf));
+  }
+  vst1q_f32(lanes_min, vmin);
+  vst1q_f32(lanes_max, vmax);
+#endif  // __SSE2__
+  min_x = std::min(lanes_min[0], lanes_min[2]);
+  min_y = std::min(lanes_min[1], lanes_min[3]);
+  max_x = std::max(lanes_max[0], lanes_max[2]);
+  max_y = std::max(lanes_max[1], lanes_max[3]);
+#endif  // __SSE2__ || __ARM_NEON
+
+  for (; i < count; i++) {
+    DlScalar x = points[i].x;
+    DlScalar y = points[i].y;
+    if (std::isfinite(x) && std::isfinite(y)) {
+      min_x = std::min(min_x, x);
+      min_y = std::min(min_y, y);
+      max_x = std::max(max_x, x);
+      max_y = std::max(max_y, y);
+    }
+  }
+
+  bounds[0] = min_x;
+  bounds[1] = min_y;
+  bounds[2] = max_x;
+  bounds[3] = max_y;
+}
+
+}  // namespace
+
 void AccumulationRect::accumulate(SkScalar x, SkScalar y) {
   if (!std::isfinite(x) || !std::isfinite(y)) {
     return;
@@ -28,6 +118,24 @@ void AccumulationRect::accumulate(SkScalar x, SkScalar y) {
   }
 }
 
+void AccumulationRect::accumulate(const DlPoint points[], size_t count) {
+  DlScalar bounds[4];
+  ComputeFinitePointBounds(points, count, bounds);
+  if (bounds[0] > bounds[2]) {
+    // No finite points.
+    return;
+  }
+  if (count > 2u ||  //
+      (bounds[0] < max_x_ && bounds[2] >= min_x_ &&
+       bounds[1] < max_y_ && bounds[3] >= min_y_)) {
+    record_overlapping_bounds();
+  }
+  min_x_ = std::min(min_x_, bounds[0]);
+  min_y_ = std::min(min_y_, bounds[1]);
+  max_x_ = std::max(max_x_, bounds[2]);
+  max_y_ = std::max(max_y_, bounds[3]);
+}
+
 void AccumulationRect::accumulate(SkRect r) {
   if (r.isEmpty()) {
     return;
@@ -29,6 +29,13 @@ class AccumulationRect {
   void accumulate(SkScalar x, SkScalar y);
   void accumulate(SkPoint p) { accumulate(p.fX, p.fY); }
   void accumulate(DlPoint p) { accumulate(p.x, p.y); }
+  // Accumulates all of the finite points in the array using vector
+  // instructions where available. The resulting bounds are the same as
+  // if each point had been accumulated in turn, but as the points are not
+  // examined one at a time, overlap is conservatively recorded if more
+  // than 2 points are accumulated or if the points reach into the bounds
+  // that were already accumulated.
+  void accumulate(const DlPoint points[], size_t count);
   void accumulate(SkRect r);
   void accumulate(DlRect r) { accumulate(ToSkRect(r)); }
   void accumulate(AccumulationRect& ar);
@@ -132,6 +132,78 @@ TEST(DisplayListAccumulationRect, ThreePoints) {
        SkRect::MakeLTRB(10.0f, 10.0f, 20.0f, 20.0f), false, true, "Inside");
 }
 
+TEST(DisplayListAccumulationRect, PointArray) {
+  const DlScalar inf = std::numeric_limits<DlScalar>::infinity();
+  const DlScalar nan = std::numeric_limits<DlScalar>::quiet_NaN();
+  const DlPoint points[] = {
+      DlPoint(10.0f, 15.0f),  //
+      DlPoint(inf, 0.0f),     //
+      DlPoint(25.0f, 12.0f),  //
+      DlPoint(0.0f, nan),     //
+      DlPoint(18.0f, 30.0f),  //
+      DlPoint(-inf, -inf),    //
+      DlPoint(12.0f, 11.0f),
+  };
+  const size_t count = sizeof(points) / sizeof(points[0]);
+
+  for (size_t n = 0; n <= count; n++) {
+    AccumulationRect expected;
+    for (size_t i = 0; i < n; i++) {
+      expected.accumulate(points[i]);
+    }
+
+    AccumulationRect accumulator;
+    accumulator.accumulate(points, n);
+
+    EXPECT_EQ(accumulator.is_empty(), expected.is_empty()) << n;
+    EXPECT_EQ(accumulator.bounds(), expected.bounds()) << n;
+  }
+}
+
+TEST(DisplayListAccumulationRect, PointArrayOverlap) {
+  {
+    AccumulationRect accumulator;
+    const DlPoint points[] = {DlPoint(10.0f, 10.0f), DlPoint(20.0f, 20.0f)};
+    accumulator.accumulate(points, 2u);
+
+    EXPECT_EQ(accumulator.bounds(),
+              SkRect::MakeLTRB(10.0f, 10.0f, 20.0f, 20.0f));
+    EXPECT_FALSE(accumulator.overlap_detected());
+  }
+
+  {
+    AccumulationRect accumulator;
+    accumulator.accumulate(SkRect::MakeLTRB(0.0f, 0.0f, 10.0f, 10.0f));
+    const DlPoint points[] = {DlPoint(20.0f, 20.0f), DlPoint(30.0f, 30.0f)};
+    accumulator.accumulate(points, 2u);
+
+    EXPECT_EQ(accumulator.bounds(), SkRect::MakeLTRB(0.0f, 0.0f, 30.0f, 30.0f));
+    EXPECT_FALSE(accumulator.overlap_detected());
+  }
+
+  {
+    AccumulationRect accumulator;
+    accumulator.accumulate(SkRect::MakeLTRB(0.0f, 0.0f, 10.0f, 10.0f));
+    const DlPoint points[] = {DlPoint(5.0f, 5.0f), DlPoint(30.0f, 30.0f)};
+    accumulator.accumulate(points, 2u);
+
+    EXPECT_EQ(accumulator.bounds(), SkRect::MakeLTRB(0.0f, 0.0f, 30.0f, 30.0f));
+    EXPECT_TRUE(accumulator.overlap_detected());
+  }
+
+  {
+    // More than 2 points are conservatively assumed to overlap.
+    AccumulationRect accumulator;
+    const DlPoint points[] = {DlPoint(10.0f, 10.0f), DlPoint(20.0f, 20.0f),
+                              DlPoint(30.0f, 30.0f)};
+    accumulator.accumulate(points, 3u);
+
+    EXPECT_EQ(accumulator.bounds(),
+              SkRect::MakeLTRB(10.0f, 10.0f, 30.0f, 30.0f));
+    EXPECT_TRUE(accumulator.overlap_detected());
+  }
+}
+
 TEST(DisplayListAccumulationRect, EmptyRect) {
   auto test = [](DlScalar l, DlScalar t, DlScalar r, DlScalar b,  //
                  SkRect bounds,                                   //
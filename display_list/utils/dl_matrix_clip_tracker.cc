@@ -56,6 +56,28 @@ bool DisplayListMatrixClipState::inverseTransform(
 
 bool DisplayListMatrixClipState::mapAndClipRect(const SkRect& src,
                                                 SkRect* mapped) const {
+  if (matrix_.IsTranslationScaleOnly()) {
+    // The common case for the bounds of most rendering ops, mapping only
+    // the 2 opposing corners avoids transforming all 4 corners through
+    // the full matrix and the optional intermediate values.
+    if (src.fLeft < src.fRight && src.fTop < src.fBottom) {
+      DlScalar x0 = src.fLeft * matrix_.m[0] + matrix_.m[12];
+      DlScalar y0 = src.fTop * matrix_.m[5] + matrix_.m[13];
+      DlScalar x1 = src.fRight * matrix_.m[0] + matrix_.m[12];
+      DlScalar y1 = src.fBottom * matrix_.m[5] + matrix_.m[13];
+      DlScalar left = std::max(std::min(x0, x1), cull_rect_.GetLeft());
+      DlScalar top = std::max(std::min(y0, y1), cull_rect_.GetTop());
+      DlScalar right = std::min(std::max(x0, x1), cull_rect_.GetRight());
+      DlScalar bottom = std::min(std::max(y0, y1), cull_rect_.GetBottom());
+      // These comparisons also fail for NaN results.
+      if (left < right && top < bottom) {
+        mapped->setLTRB(left, top, right, bottom);
+        return true;
+      }
+    }
+    mapped->setEmpty();
+    return false;
+  }
   DlRect dl_mapped = ToDlRect(src).TransformAndClipBounds(matrix_);
   auto dl_intersected = dl_mapped.Intersection(cull_rect_);
   if (dl_intersected.has_value()) {
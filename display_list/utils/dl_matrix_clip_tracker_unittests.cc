@@ -764,6 +764,41 @@ TEST(DisplayListMatrixClipState, MapAndClipRectScale) {
   }
 }
 
+TEST(DisplayListMatrixClipState, MapAndClipRectNegativeScale) {
+  DlRect cull_rect = DlRect::MakeLTRB(-500.0f, -500.0f, -100.0f, -100.0f);
+  DlMatrix matrix = DlMatrix::MakeScale({-2.0f, -4.0f, 1.0f});
+  DisplayListMatrixClipState state(cull_rect, matrix);
+
+  {
+    // Rect entirely within clip after scaling
+    SkRect rect = SkRect::MakeLTRB(100.0f, 50.0f, 110.0f, 60.0f);
+    EXPECT_TRUE(state.mapAndClipRect(&rect));
+    EXPECT_EQ(rect, SkRect::MakeLTRB(-220.0f, -240.0f, -200.0f, -200.0f));
+  }
+
+  {
+    // Rect abuts clip right side after scaling
+    SkRect rect = SkRect::MakeLTRB(40.0f, 50.0f, 50.0f, 60.0f);
+    EXPECT_FALSE(state.mapAndClipRect(&rect));
+    EXPECT_TRUE(rect.isEmpty());
+  }
+
+  {
+    // Rect barely grazes clip bottom after scaling
+    SkRect rect = SkRect::MakeLTRB(100.0f, 15.0f, 110.0f, 26.0f);
+    EXPECT_TRUE(state.mapAndClipRect(&rect));
+    EXPECT_EQ(rect, SkRect::MakeLTRB(-220.0f, -104.0f, -200.0f, -100.0f));
+  }
+
+  {
+    // Non-finite src rects map to empty
+    SkRect rect = SkRect::MakeLTRB(
+        100.0f, 50.0f, std::numeric_limits<SkScalar>::quiet_NaN(), 60.0f);
+    EXPECT_FALSE(state.mapAndClipRect(&rect));
+    EXPECT_TRUE(rect.isEmpty());
+  }
+}
+
 TEST(DisplayListMatrixClipState, RectCoverage) {
   DlRect rect = DlRect::MakeLTRB(100.0f, 100.0f, 200.0f, 200.0f);
   DisplayListMatrixClipState state(rect);
@@ -15,6 +15,7 @@ std::optional<SkRect> FrameDamage::ComputeClipRect(
     flutter::LayerTree& layer_tree,
     bool has_raster_cache,
     bool impeller_enabled) {
+  statistics_.reset();
   if (layer_tree.root_layer()) {
     PaintRegionMap empty_paint_region_map;
     DiffContext context(layer_tree.frame_size(), layer_tree.paint_region_map(),
@@ -41,6 +42,12 @@ std::optional<SkRect> FrameDamage::ComputeClipRect(
     damage_ =
         context.ComputeDamage(additional_damage_, horizontal_clip_alignment_,
                               vertical_clip_alignment_);
+    frame_damage_rects_ =
+        CoalesceDamageRects(damage_->frame_damage_region, kMaxDamageRects);
+    buffer_damage_rects_ =
+        CoalesceDamageRects(damage_->buffer_damage_region, kMaxDamageRects);
+    buffer_damage_region_ = DlRegion(buffer_damage_rects_);
+    statistics_ = context.statistics();
     return SkRect::Make(damage_->buffer_damage);
   }
   return std::nullopt;
@@ -132,8 +139,11 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
     }
   }
 
-  bool root_needs_readback = layer_tree.Preroll(
-      *this, ignore_raster_cache, clip_rect ? *clip_rect : kGiantRect);
+  DiffContext::Statistics* statistics =
+      frame_damage ? frame_damage->statistics() : nullptr;
+  bool root_needs_readback =
+      layer_tree.Preroll(*this, ignore_raster_cache,
+                         clip_rect ? *clip_rect : kGiantRect, statistics);
   bool needs_save_layer = root_needs_readback && !surface_supports_readback();
   PostPrerollResult post_preroll_result = PostPrerollResult::kSuccess;
   if (view_embedder_ && raster_thread_merger_) {
@@ -151,7 +161,9 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   if (aiks_context_) {
     PaintLayerTreeImpeller(layer_tree, clip_rect, ignore_raster_cache);
   } else {
-    PaintLayerTreeSkia(layer_tree, clip_rect, needs_save_layer,
+    const DlRegion* damage_region =
+        clip_rect ? frame_damage->GetBufferDamageRegion() : nullptr;
+    PaintLayerTreeSkia(layer_tree, clip_rect, damage_region, needs_save_layer,
                        ignore_raster_cache);
   }
   return RasterStatus::kSuccess;
@@ -160,12 +172,28 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
 void CompositorContext::ScopedFrame::PaintLayerTreeSkia(
     flutter::LayerTree& layer_tree,
     std::optional<SkRect> clip_rect,
+    const DlRegion* damage_region,
     bool needs_save_layer,
     bool ignore_raster_cache) {
   DlAutoCanvasRestore restore(canvas(), clip_rect.has_value());
 
+  // A damage region made of a single rect is the clip rect, which the
+  // layers already cull against. Otherwise the region covers the at most
+  // FrameDamage::kMaxDamageRects buffer damage rects, which are also
+  // declared to the surface, so that it does not expect the pixels between
+  // them to be painted.
+  if (damage_region && !damage_region->isComplex()) {
+    damage_region = nullptr;
+  }
+
   if (canvas()) {
-    if (clip_rect) {
+    if (damage_region) {
+      SkPath path;
+      for (const SkIRect& rect : damage_region->getRects()) {
+        path.addRect(SkRect::Make(rect));
+      }
+      canvas()->ClipPath(DlPath(path));
+    } else if (clip_rect) {
       canvas()->ClipRect(*clip_rect);
     }
 
@@ -180,7 +208,7 @@ void CompositorContext::ScopedFrame::PaintLayerTreeSkia(
   }
 
   // The canvas()->Restore() is taken care of by the DlAutoCanvasRestore
-  layer_tree.Paint(*this, ignore_raster_cache);
+  layer_tree.Paint(*this, ignore_raster_cache, damage_region);
 }
 
 void CompositorContext::ScopedFrame::PaintLayerTreeImpeller(
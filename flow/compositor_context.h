@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "flutter/common/graphics/texture.h"
 #include "flutter/common/macros.h"
@@ -49,6 +50,12 @@ enum class RasterStatus {
 
 class FrameDamage {
  public:
+  // The max number of rects that the damage regions are merged down to.
+  //
+  // Every rect makes clipping and presenting the damage more expensive, so
+  // nearby rects are merged into their bounds beyond this count.
+  static constexpr size_t kMaxDamageRects = 16;
+
   // Sets previous layer tree for calculating frame damage. If not set, entire
   // frame will be repainted.
   void SetPreviousLayerTree(const LayerTree* prev_layer_tree) {
@@ -88,15 +95,44 @@ class FrameDamage {
                : std::nullopt;
   }
 
+  // See Damage::frame_damage_region. The rects are merged down to at most
+  // kMaxDamageRects and may overlap. Empty if there is no frame damage.
+  std::vector<SkIRect> GetFrameDamageRects() const {
+    return damage_ ? frame_damage_rects_ : std::vector<SkIRect>();
+  }
+
+  // See Damage::buffer_damage_region. The rects are merged down to at most
+  // kMaxDamageRects and may overlap. Empty if there is no buffer damage.
+  std::vector<SkIRect> GetBufferDamageRects() const {
+    return (damage_ && !ignore_damage_) ? buffer_damage_rects_
+                                        : std::vector<SkIRect>();
+  }
+
+  // The region covered by GetBufferDamageRects.
+  const DlRegion* GetBufferDamageRegion() const {
+    return (damage_ && !ignore_damage_) ? &buffer_damage_region_ : nullptr;
+  }
+
   // Remove reported buffer_damage to inform clients that a partial repaint
   // should not be performed on this frame.
   // frame_damage is required to correctly track accumulated damage for
   // subsequent frames.
   void Reset() { ignore_damage_ = true; }
 
+  // The statistics of the diff performed by the last call to
+  // ComputeClipRect, which Preroll keeps adding to. Null if no diff was
+  // performed.
+  DiffContext::Statistics* statistics() {
+    return statistics_ ? &statistics_.value() : nullptr;
+  }
+
  private:
   SkIRect additional_damage_ = SkIRect::MakeEmpty();
   std::optional<Damage> damage_;
+  std::vector<SkIRect> frame_damage_rects_;
+  std::vector<SkIRect> buffer_damage_rects_;
+  DlRegion buffer_damage_region_;
+  std::optional<DiffContext::Statistics> statistics_;
   const LayerTree* prev_layer_tree_ = nullptr;
   int vertical_clip_alignment_ = 1;
   int horizontal_clip_alignment_ = 1;
@@ -142,6 +178,7 @@ class CompositorContext {
    private:
     void PaintLayerTreeSkia(flutter::LayerTree& layer_tree,
                             std::optional<SkRect> clip_rect,
+                            const DlRegion* damage_region,
                             bool needs_save_layer,
                             bool ignore_raster_cache);
 
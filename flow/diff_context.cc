@@ -4,6 +4,9 @@
 
 #include "flutter/flow/diff_context.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/raster_cache_util.h"
 
@@ -120,6 +123,12 @@ Damage DiffContext::ComputeDamage(const SkIRect& accumulated_buffer_damage,
   buffer_damage.join(damage_);
   SkRect frame_damage(damage_);
 
+  std::vector<SkIRect> frame_damage_rects;
+  frame_damage_rects.reserve(damage_rects_.size());
+  for (const auto& r : damage_rects_) {
+    frame_damage_rects.push_back(r.roundOut());
+  }
+
   for (const auto& r : readbacks_) {
     SkRect paint_rect = SkRect::Make(r.paint_rect);
     SkRect readback_rect = SkRect::Make(r.readback_rect);
@@ -131,6 +140,8 @@ Damage DiffContext::ComputeDamage(const SkIRect& accumulated_buffer_damage,
       frame_damage.join(paint_rect);
       buffer_damage.join(readback_rect);
       buffer_damage.join(paint_rect);
+      frame_damage_rects.push_back(r.readback_rect);
+      frame_damage_rects.push_back(r.paint_rect);
     }
   }
 
@@ -152,9 +163,84 @@ Damage DiffContext::ComputeDamage(const SkIRect& accumulated_buffer_damage,
     AlignRect(res.frame_damage, horizontal_clip_alignment,
               vertical_clip_alignment);
   }
+
+  res.frame_damage_region =
+      MakeDamageRegion(frame_damage_rects, horizontal_clip_alignment,
+                       vertical_clip_alignment);
+  frame_damage_rects.push_back(accumulated_buffer_damage);
+  res.buffer_damage_region =
+      MakeDamageRegion(std::move(frame_damage_rects),
+                       horizontal_clip_alignment, vertical_clip_alignment);
   return res;
 }
 
+DlRegion DiffContext::MakeDamageRegion(std::vector<SkIRect> rects,
+                                       int horizontal_clip_alignment,
+                                       int vertical_clip_alignment) const {
+  // The rects are clipped and aligned one by one so that the region stays
+  // within the damage rect computed from their bounds.
+  SkIRect frame_clip = SkIRect::MakeSize(frame_size_);
+  size_t count = 0;
+  for (SkIRect& rect : rects) {
+    if (!rect.intersect(frame_clip)) {
+      continue;
+    }
+    if (horizontal_clip_alignment > 1 || vertical_clip_alignment > 1) {
+      AlignRect(rect, horizontal_clip_alignment, vertical_clip_alignment);
+    }
+    rects[count++] = rect;
+  }
+  rects.resize(count);
+  return DlRegion(rects);
+}
+
+std::vector<SkIRect> CoalesceDamageRects(const DlRegion& region,
+                                         size_t max_rects) {
+  std::vector<SkIRect> rects = region.getRects();
+  max_rects = std::max(max_rects, size_t{1});
+
+  // The rects of a region are sorted by their top edge, so neighbours are
+  // usually close to each other. Merging them in pairs quickly brings down
+  // the number of rects for the search below, which is quadratic.
+  while (rects.size() > max_rects * 4) {
+    size_t count = 0;
+    for (size_t i = 0; i < rects.size(); i += 2) {
+      SkIRect rect = rects[i];
+      if (i + 1 < rects.size()) {
+        rect.join(rects[i + 1]);
+      }
+      rects[count++] = rect;
+    }
+    rects.resize(count);
+  }
+
+  // Merge the two rects whose bounds cover the least area that neither of
+  // them covers, until there are few enough rects.
+  auto area = [](const SkIRect& rect) {
+    return static_cast<int64_t>(rect.width()) * rect.height();
+  };
+  while (rects.size() > max_rects) {
+    size_t best_i = 0;
+    size_t best_j = 1;
+    int64_t best_cost = std::numeric_limits<int64_t>::max();
+    for (size_t i = 0; i < rects.size(); i++) {
+      for (size_t j = i + 1; j < rects.size(); j++) {
+        SkIRect joined = rects[i];
+        joined.join(rects[j]);
+        int64_t cost = area(joined) - area(rects[i]) - area(rects[j]);
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_i = i;
+          best_j = j;
+        }
+      }
+    }
+    rects[best_i].join(rects[best_j]);
+    rects.erase(rects.begin() + best_j);
+  }
+  return rects;
+}
+
 SkRect DiffContext::MapRect(const SkRect& rect) {
   SkRect mapped_rect(rect);
   state_.matrix_clip.mapRect(&mapped_rect);
@@ -188,18 +274,26 @@ void DiffContext::MarkSubtreeDirty(const SkRect& previous_paint_region) {
   state_.dirty = true;
 }
 
-void DiffContext::AddLayerBounds(const SkRect& rect) {
+bool DiffContext::MapLayerRect(const SkRect& rect, SkRect& transformed_rect) {
   // During painting we cull based on non-overriden transform and then
   // override the transform right before paint. Do the same thing here to get
   // identical paint rect.
-  auto transformed_rect = ApplyFilterBoundsAdjustment(MapRect(rect));
-  if (transformed_rect.intersects(state_.matrix_clip.device_cull_rect())) {
-    if (state_.integral_transform) {
-      DisplayListMatrixClipState temp_state = state_.matrix_clip;
-      MakeTransformIntegral(temp_state);
-      temp_state.mapRect(rect, &transformed_rect);
-      transformed_rect = ApplyFilterBoundsAdjustment(transformed_rect);
-    }
+  transformed_rect = ApplyFilterBoundsAdjustment(MapRect(rect));
+  if (!transformed_rect.intersects(state_.matrix_clip.device_cull_rect())) {
+    return false;
+  }
+  if (state_.integral_transform) {
+    DisplayListMatrixClipState temp_state = state_.matrix_clip;
+    MakeTransformIntegral(temp_state);
+    temp_state.mapRect(rect, &transformed_rect);
+    transformed_rect = ApplyFilterBoundsAdjustment(transformed_rect);
+  }
+  return true;
+}
+
+void DiffContext::AddLayerBounds(const SkRect& rect) {
+  SkRect transformed_rect;
+  if (MapLayerRect(rect, transformed_rect)) {
     rects_->push_back(transformed_rect);
     if (IsSubtreeDirty()) {
       AddDamage(transformed_rect);
@@ -207,6 +301,13 @@ void DiffContext::AddLayerBounds(const SkRect& rect) {
   }
 }
 
+void DiffContext::AddLayerDamage(const SkRect& rect) {
+  SkRect transformed_rect;
+  if (MapLayerRect(rect, transformed_rect)) {
+    AddDamage(transformed_rect);
+  }
+}
+
 void DiffContext::MarkSubtreeHasTextureLayer() {
   // Set the has_texture flag on current state and all parent states. That
   // way we'll know that we can't skip diff for retained layers because
@@ -248,12 +349,16 @@ PaintRegion DiffContext::CurrentSubtreeRegion() const {
 void DiffContext::AddDamage(const PaintRegion& damage) {
   FML_DCHECK(damage.is_valid());
   for (const auto& r : damage) {
-    damage_.join(r);
+    AddDamage(r);
   }
 }
 
 void DiffContext::AddDamage(const SkRect& rect) {
+  if (rect.isEmpty()) {
+    return;
+  }
   damage_.join(rect);
+  damage_rects_.push_back(rect);
 }
 
 void DiffContext::SetLayerPaintRegion(const Layer* layer,
@@ -280,7 +385,12 @@ void DiffContext::Statistics::LogStatistics() {
                     deep_compare_pictures_, "SameInstancePictures",
                     same_instance_pictures_,
                     "DifferentInstanceButEqualPictures",
-                    different_instance_but_equal_pictures_);
+                    different_instance_but_equal_pictures_, "SplicedPictures",
+                    spliced_pictures_);
+  FML_TRACE_COUNTER("flutter", "DiffContextPreroll",
+                    reinterpret_cast<int64_t>(this), "UnchangedLayers",
+                    unchanged_layers_, "ReusedPrerolls", reused_prerolls_,
+                    "RecomputedPrerolls", recomputed_prerolls_);
 #endif  // !FLUTTER_RELEASE
 }
 
@@ -10,6 +10,7 @@
 #include <optional>
 #include <vector>
 #include "display_list/utils/dl_matrix_clip_tracker.h"
+#include "flutter/display_list/geometry/dl_region.h"
 #include "flutter/flow/paint_region.h"
 #include "flutter/fml/macros.h"
 #include "third_party/skia/include/core/SkM44.h"
@@ -35,8 +36,23 @@ struct Damage {
   // upfront may be useful for tile based GPUs.
   // Corresponds to "buffer damage" from EGL_KHR_partial_update.
   SkIRect buffer_damage;
+
+  // The parts of frame_damage that actually changed, i.e. the individual
+  // rects that were joined into frame_damage. This is often much smaller
+  // than frame_damage when a few small, distant parts of the frame changed.
+  DlRegion frame_damage_region;
+
+  // The parts of buffer_damage that actually changed. Painting can be
+  // restricted to this region.
+  DlRegion buffer_damage_region;
 };
 
+// Returns the rects of |region|, merging rects that are close to each
+// other until there are no more than |max_rects| of them. The returned
+// rects cover |region| but may overlap each other.
+std::vector<SkIRect> CoalesceDamageRects(const DlRegion& region,
+                                         size_t max_rects);
+
 // Layer Unique Id to PaintRegion
 using PaintRegionMap = std::map<uint64_t, PaintRegion>;
 
@@ -115,6 +131,12 @@ class DiffContext {
   // coordinates.
   void AddLayerBounds(const SkRect& rect);
 
+  // Add damage for a part of the current layer that changed since the last
+  // frame; rect is in "local" (layer) coordinates. Used by layers that can
+  // determine which parts of their content changed without the whole subtree
+  // being marked dirty.
+  void AddLayerDamage(const SkRect& rect);
+
   // Add entire paint region of retained layer for current subtree. This can
   // only be used in subtrees that are not dirty, otherwise ancestor transforms
   // or clips may result in different paint region.
@@ -189,6 +211,25 @@ class DiffContext {
       ++different_instance_but_equal_pictures_;
     };
 
+    // Picture that was spliced from the previous picture and therefore only
+    // needed its precomputed changed region to be damaged
+    void AddSplicedPicture() { ++spliced_pictures_; }
+
+    // Retained layer that has identical instance between frames
+    void AddUnchangedLayer() { ++unchanged_layers_; }
+
+    // Layer whose Preroll was skipped in favor of the results of the
+    // previous frame
+    void AddReusedPreroll() { ++reused_prerolls_; }
+
+    // Layer that could have reused its Preroll results but had to Preroll
+    // again, either because it changed or its Preroll inputs did
+    void AddRecomputedPreroll() { ++recomputed_prerolls_; }
+
+    int unchanged_layers() const { return unchanged_layers_; }
+    int reused_prerolls() const { return reused_prerolls_; }
+    int recomputed_prerolls() const { return recomputed_prerolls_; }
+
     // Logs the statistics to trace counter
     void LogStatistics();
 
@@ -198,6 +239,10 @@ class DiffContext {
     int same_instance_pictures_ = 0;
     int deep_compare_pictures_ = 0;
     int different_instance_but_equal_pictures_ = 0;
+    int spliced_pictures_ = 0;
+    int unchanged_layers_ = 0;
+    int reused_prerolls_ = 0;
+    int recomputed_prerolls_ = 0;
   };
 
   Statistics& statistics() { return statistics_; }
@@ -247,6 +292,8 @@ class DiffContext {
   SkRect ApplyFilterBoundsAdjustment(SkRect rect) const;
 
   SkRect damage_ = SkRect::MakeEmpty();
+  // The rects joined into damage_.
+  std::vector<SkRect> damage_rects_;
 
   PaintRegionMap& this_frame_paint_region_map_;
   const PaintRegionMap& last_frame_paint_region_map_;
@@ -255,10 +302,19 @@ class DiffContext {
 
   void AddDamage(const SkRect& rect);
 
+  // Maps rect in "local" (layer) coordinates to the screen coordinates in
+  // which it will be painted. Returns false if the result does not intersect
+  // the current clip.
+  bool MapLayerRect(const SkRect& rect, SkRect& transformed_rect);
+
   void AlignRect(SkIRect& rect,
                  int horizontal_alignment,
                  int vertical_clip_alignment) const;
 
+  DlRegion MakeDamageRegion(std::vector<SkIRect> rects,
+                            int horizontal_clip_alignment,
+                            int vertical_clip_alignment) const;
+
   struct Readback {
     // Index of rects_ entry that this readback belongs to. Used to
     // determine if subtree has any readback
@@ -68,5 +68,66 @@ TEST_F(DiffContextTest, DisjointDamage) {
   EXPECT_EQ(damage.buffer_damage, SkIRect::MakeEmpty());
 }
 
+TEST_F(DiffContextTest, DamageRegionsCoverChangedLayers) {
+  MockLayerTree t1(SkISize::Make(100, 100));
+  t1.root()->Add(CreateDisplayListLayer(
+      CreateDisplayList(SkRect::MakeLTRB(0, 0, 10, 10), DlColor::kRed())));
+  t1.root()->Add(CreateDisplayListLayer(
+      CreateDisplayList(SkRect::MakeLTRB(90, 90, 100, 100), DlColor::kRed())));
+
+  MockLayerTree t2(SkISize::Make(100, 100));
+  t2.root()->Add(CreateDisplayListLayer(
+      CreateDisplayList(SkRect::MakeLTRB(0, 0, 10, 10), DlColor::kBlue())));
+  t2.root()->Add(CreateDisplayListLayer(
+      CreateDisplayList(SkRect::MakeLTRB(90, 90, 100, 100), DlColor::kBlue())));
+
+  auto damage = DiffLayerTree(t2, t1, SkIRect::MakeLTRB(40, 40, 50, 50));
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(0, 0, 100, 100));
+  EXPECT_EQ(damage.frame_damage_region.getRects(),
+            std::vector<SkIRect>({SkIRect::MakeLTRB(0, 0, 10, 10),
+                                  SkIRect::MakeLTRB(90, 90, 100, 100)}));
+  // The accumulated damage only affects the buffer damage.
+  EXPECT_EQ(damage.buffer_damage_region.getRects(),
+            std::vector<SkIRect>({SkIRect::MakeLTRB(0, 0, 10, 10),
+                                  SkIRect::MakeLTRB(40, 40, 50, 50),
+                                  SkIRect::MakeLTRB(90, 90, 100, 100)}));
+}
+
+TEST(CoalesceDamageRectsTest, KeepsRectsWithinLimit) {
+  std::vector<SkIRect> rects = {SkIRect::MakeLTRB(0, 0, 10, 10),
+                                SkIRect::MakeLTRB(90, 90, 100, 100)};
+  EXPECT_EQ(CoalesceDamageRects(DlRegion(rects), 2), rects);
+}
+
+TEST(CoalesceDamageRectsTest, MergesNearestRects) {
+  DlRegion region(std::vector<SkIRect>{
+      SkIRect::MakeLTRB(0, 0, 10, 10),
+      SkIRect::MakeLTRB(12, 0, 20, 10),
+      SkIRect::MakeLTRB(90, 90, 100, 100),
+  });
+  EXPECT_EQ(CoalesceDamageRects(region, 2),
+            std::vector<SkIRect>({SkIRect::MakeLTRB(0, 0, 20, 10),
+                                  SkIRect::MakeLTRB(90, 90, 100, 100)}));
+  EXPECT_EQ(CoalesceDamageRects(region, 1),
+            std::vector<SkIRect>({SkIRect::MakeLTRB(0, 0, 100, 100)}));
+}
+
+TEST(CoalesceDamageRectsTest, CoversManyRects) {
+  std::vector<SkIRect> rects;
+  for (int i = 0; i < 100; i++) {
+    rects.push_back(SkIRect::MakeXYWH((i % 10) * 20, (i / 10) * 20, 10, 10));
+  }
+  DlRegion region(rects);
+  std::vector<SkIRect> coalesced = CoalesceDamageRects(region, 16);
+  EXPECT_LE(coalesced.size(), 16u);
+  for (const SkIRect& rect : rects) {
+    bool covered = false;
+    for (const SkIRect& coalesced_rect : coalesced) {
+      covered = covered || coalesced_rect.contains(rect);
+    }
+    EXPECT_TRUE(covered);
+  }
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -4,6 +4,8 @@
 
 #include "flutter/flow/frame_timings.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <string>
 
@@ -36,6 +38,15 @@ const char* StateToString(FrameTimingsRecorder::State state) {
   return "";
 }
 
+// The first kLinearBuckets microseconds each have a bucket of their own.
+// Every power of two above is split into kLinearBuckets / 2 buckets.
+constexpr int kLinearBucketBits = 5;
+constexpr int64_t kLinearBuckets = 1 << kLinearBucketBits;
+constexpr int64_t kHalfLinearBuckets = kLinearBuckets / 2;
+// Durations are clamped to about 71 minutes.
+constexpr int kMaxShift = 32 - kLinearBucketBits;
+constexpr size_t kBucketCount = kLinearBuckets + kMaxShift * kHalfLinearBuckets;
+
 }  // namespace
 
 std::atomic<uint64_t> FrameTimingsRecorder::frame_number_gen_ = {1};
@@ -286,4 +297,114 @@ void FrameTimingsRecorder::AssertInState(State state) const {
                               << ", actual state " << StateToString(state_);
 }
 
+FramePhaseHistogram::FramePhaseHistogram(size_t window)
+    : window_(std::max(window, size_t{1})) {
+  for (std::vector<uint32_t>& counts : counts_) {
+    counts.resize(kBucketCount);
+  }
+}
+
+FramePhaseHistogram::~FramePhaseHistogram() = default;
+
+void FramePhaseHistogram::AddFrame(
+    const FrameTiming& timing,
+    std::optional<fml::TimeDelta> raster_duration) {
+  fml::TimeDelta durations[kPhaseCount];
+  durations[kVsyncToBuild] = timing.Get(FrameTiming::kBuildStart) -
+                             timing.Get(FrameTiming::kVsyncStart);
+  durations[kBuild] = timing.Get(FrameTiming::kBuildFinish) -
+                      timing.Get(FrameTiming::kBuildStart);
+  durations[kRaster] = raster_duration.value_or(
+      timing.Get(FrameTiming::kRasterFinish) -
+      timing.Get(FrameTiming::kRasterStart));
+  durations[kTotal] = timing.Get(FrameTiming::kRasterFinish) -
+                      timing.Get(FrameTiming::kVsyncStart);
+
+  if (frames_.size() == window_) {
+    const FrameBuckets& oldest = frames_.front();
+    for (size_t phase = 0; phase < kPhaseCount; phase++) {
+      counts_[phase][oldest[phase]]--;
+    }
+    frames_.pop_front();
+  }
+
+  FrameBuckets buckets;
+  for (size_t phase = 0; phase < kPhaseCount; phase++) {
+    buckets[phase] = static_cast<uint16_t>(
+        BucketForMicroseconds(durations[phase].ToMicroseconds()));
+    counts_[phase][buckets[phase]]++;
+  }
+  frames_.push_back(buckets);
+}
+
+fml::TimeDelta FramePhaseHistogram::GetPercentile(Phase phase,
+                                                  double percentile) const {
+  if (frames_.empty()) {
+    return fml::TimeDelta::Zero();
+  }
+  double rank = std::ceil(frames_.size() * std::clamp(percentile, 0.0, 100.0) /
+                          100.0);
+  uint64_t target = std::max(static_cast<uint64_t>(rank), uint64_t{1});
+  uint64_t seen = 0;
+  const std::vector<uint32_t>& counts = counts_[phase];
+  for (size_t bucket = 0; bucket < counts.size(); bucket++) {
+    seen += counts[bucket];
+    if (seen >= target) {
+      return fml::TimeDelta::FromMicroseconds(MicrosecondsForBucket(bucket));
+    }
+  }
+  FML_UNREACHABLE();
+}
+
+size_t FramePhaseHistogram::BucketForMicroseconds(int64_t micros) {
+  // Phases that were not recorded, such as the build phase of a frame
+  // rasterized again from the last layer tree, count as zero.
+  micros = std::clamp(micros, int64_t{0}, (int64_t{1} << 32) - 1);
+  if (micros < kLinearBuckets) {
+    return micros;
+  }
+  // Shift the duration down to kLinearBucketBits bits, of which the
+  // highest one is set.
+  int shift = 1;
+  while ((micros >> shift) >= kLinearBuckets) {
+    shift++;
+  }
+  int64_t top = micros >> shift;
+  return kLinearBuckets + (shift - 1) * kHalfLinearBuckets +
+         (top - kHalfLinearBuckets);
+}
+
+int64_t FramePhaseHistogram::MicrosecondsForBucket(size_t bucket) {
+  if (bucket < kLinearBuckets) {
+    return bucket;
+  }
+  int64_t shift = 1 + (bucket - kLinearBuckets) / kHalfLinearBuckets;
+  int64_t top = kHalfLinearBuckets + (bucket - kLinearBuckets) %
+                                         kHalfLinearBuckets;
+  // The middle of the bucket.
+  return (top << shift) + (int64_t{1} << (shift - 1));
+}
+
+FramePhaseHistograms::FramePhaseHistograms() = default;
+
+FramePhaseHistograms::~FramePhaseHistograms() = default;
+
+void FramePhaseHistograms::AddFrame(
+    int64_t view_id,
+    const FrameTiming& timing,
+    std::optional<fml::TimeDelta> raster_duration) {
+  std::scoped_lock lock(mutex_);
+  histograms_[view_id].AddFrame(timing, raster_duration);
+}
+
+void FramePhaseHistograms::RemoveView(int64_t view_id) {
+  std::scoped_lock lock(mutex_);
+  histograms_.erase(view_id);
+}
+
+std::map<int64_t, FramePhaseHistogram> FramePhaseHistograms::Get() const {
+  std::scoped_lock lock(mutex_);
+  return histograms_;
+}
+
 }  // namespace flutter
@@ -5,7 +5,12 @@
 #ifndef FLUTTER_FLOW_FRAME_TIMINGS_H_
 #define FLUTTER_FLOW_FRAME_TIMINGS_H_
 
+#include <array>
+#include <deque>
+#include <map>
 #include <mutex>
+#include <optional>
+#include <vector>
 
 #include "flutter/common/settings.h"
 #include "flutter/flow/raster_cache.h"
@@ -164,6 +169,94 @@ class FrameTimingsRecorder {
   FML_DISALLOW_COPY_ASSIGN_AND_MOVE(FrameTimingsRecorder);
 };
 
+/// Rolling percentiles of how long the phases of the last frames took.
+///
+/// The durations are counted in buckets in the manner of an HDR histogram:
+/// every power of two of microseconds is split into 16 buckets of equal
+/// width, so percentiles are within 1/16th of the actual duration however
+/// long the frames take, while adding a frame and removing the oldest one
+/// only updates a few counters.
+///
+/// This class is not thread safe.
+class FramePhaseHistogram {
+ public:
+  enum Phase {
+    // From the vsync signal to the start of the build.
+    kVsyncToBuild,
+    // From the start to the end of the build.
+    kBuild,
+    // From the start to the end of the rasterization.
+    kRaster,
+    // From the vsync signal to the end of the rasterization. This does not
+    // include the time until the frame is displayed, which the engine does
+    // not know.
+    kTotal,
+    kPhaseCount,
+  };
+
+  static constexpr size_t kDefaultWindow = 600;
+
+  /// Creates a histogram of the last |window| frames.
+  explicit FramePhaseHistogram(size_t window = kDefaultWindow);
+
+  ~FramePhaseHistogram();
+
+  /// Adds the phases of |timing|. The duration of the raster phase is
+  /// |raster_duration| if set, to account for the views of a frame that
+  /// are rasterized one after the other.
+  void AddFrame(
+      const FrameTiming& timing,
+      std::optional<fml::TimeDelta> raster_duration = std::nullopt);
+
+  /// The number of frames the percentiles are computed from.
+  size_t frame_count() const { return frames_.size(); }
+
+  /// Returns the duration that |percentile| percent of the frames took at
+  /// most in |phase|, or zero if no frames were added.
+  fml::TimeDelta GetPercentile(Phase phase, double percentile) const;
+
+ private:
+  using FrameBuckets = std::array<uint16_t, kPhaseCount>;
+
+  static size_t BucketForMicroseconds(int64_t micros);
+  static int64_t MicrosecondsForBucket(size_t bucket);
+
+  const size_t window_;
+  std::array<std::vector<uint32_t>, kPhaseCount> counts_;
+  // The buckets of each of the last frames, oldest first.
+  std::deque<FrameBuckets> frames_;
+};
+
+/// The |FramePhaseHistogram| of each view, keyed by the view ID.
+///
+/// Frames are added on the raster thread, while the histograms may be read
+/// on any thread.
+class FramePhaseHistograms {
+ public:
+  FramePhaseHistograms();
+
+  ~FramePhaseHistograms();
+
+  /// Adds the phases of |timing| to the histogram of |view_id|.
+  ///
+  /// @see `FramePhaseHistogram::AddFrame`
+  void AddFrame(int64_t view_id,
+                const FrameTiming& timing,
+                std::optional<fml::TimeDelta> raster_duration = std::nullopt);
+
+  /// Drops the histogram of |view_id|.
+  void RemoveView(int64_t view_id);
+
+  /// Returns a copy of the histogram of each view.
+  std::map<int64_t, FramePhaseHistogram> Get() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<int64_t, FramePhaseHistogram> histograms_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(FramePhaseHistograms);
+};
+
 }  // namespace flutter
 
 #endif  // FLUTTER_FLOW_FRAME_TIMINGS_H_
@@ -296,4 +296,119 @@ TEST(FrameTimingsRecorderTest, FrameNumberTraceArgIsValid) {
   ASSERT_EQ(actual_arg, expected_arg);
 }
 
+static FrameTiming MakeFrameTiming(fml::TimeDelta vsync_to_build,
+                                   fml::TimeDelta build,
+                                   fml::TimeDelta raster) {
+  FrameTiming timing;
+  fml::TimePoint vsync_start =
+      fml::TimePoint::FromEpochDelta(fml::TimeDelta::FromSeconds(1));
+  timing.Set(FrameTiming::kVsyncStart, vsync_start);
+  timing.Set(FrameTiming::kBuildStart, vsync_start + vsync_to_build);
+  timing.Set(FrameTiming::kBuildFinish, vsync_start + vsync_to_build + build);
+  timing.Set(FrameTiming::kRasterStart, vsync_start + vsync_to_build + build);
+  timing.Set(FrameTiming::kRasterFinish,
+             vsync_start + vsync_to_build + build + raster);
+  return timing;
+}
+
+// The buckets of the histogram are at most 1/16 of their duration wide.
+static void ExpectNear(fml::TimeDelta actual, fml::TimeDelta expected) {
+  EXPECT_NEAR(actual.ToMicrosecondsF(), expected.ToMicrosecondsF(),
+              expected.ToMicrosecondsF() / 32.0)
+      << "Expected " << expected.ToMicroseconds() << "us, got "
+      << actual.ToMicroseconds() << "us";
+}
+
+TEST(FramePhaseHistogramTest, EmptyHistogramReportsZero) {
+  FramePhaseHistogram histogram;
+  EXPECT_EQ(histogram.frame_count(), 0u);
+  EXPECT_EQ(histogram.GetPercentile(FramePhaseHistogram::kBuild, 50.0),
+            fml::TimeDelta::Zero());
+}
+
+TEST(FramePhaseHistogramTest, ComputesPercentilesOfEachPhase) {
+  FramePhaseHistogram histogram;
+  for (int i = 1; i <= 1000; i++) {
+    histogram.AddFrame(MakeFrameTiming(fml::TimeDelta::FromMicroseconds(20),
+                                       fml::TimeDelta::FromMicroseconds(i * 10),
+                                       fml::TimeDelta::FromMilliseconds(4)));
+  }
+  // Only the last 600 frames are kept.
+  EXPECT_EQ(histogram.frame_count(), 600u);
+
+  // Durations below 32us are exact.
+  EXPECT_EQ(histogram.GetPercentile(FramePhaseHistogram::kVsyncToBuild, 99.9),
+            fml::TimeDelta::FromMicroseconds(20));
+  ExpectNear(histogram.GetPercentile(FramePhaseHistogram::kBuild, 50.0),
+             fml::TimeDelta::FromMicroseconds(7000));
+  ExpectNear(histogram.GetPercentile(FramePhaseHistogram::kBuild, 90.0),
+             fml::TimeDelta::FromMicroseconds(9400));
+  ExpectNear(histogram.GetPercentile(FramePhaseHistogram::kBuild, 99.9),
+             fml::TimeDelta::FromMicroseconds(10000));
+  ExpectNear(histogram.GetPercentile(FramePhaseHistogram::kRaster, 50.0),
+             fml::TimeDelta::FromMilliseconds(4));
+  ExpectNear(histogram.GetPercentile(FramePhaseHistogram::kTotal, 99.0),
+             fml::TimeDelta::FromMicroseconds(20 + 9940 + 4000));
+}
+
+TEST(FramePhaseHistogramTest, OldFramesLeaveTheWindow) {
+  FramePhaseHistogram histogram(10);
+  for (int i = 0; i < 10; i++) {
+    histogram.AddFrame(MakeFrameTiming(fml::TimeDelta::Zero(),
+                                       fml::TimeDelta::FromMilliseconds(50),
+                                       fml::TimeDelta::FromMilliseconds(1)));
+  }
+  ExpectNear(histogram.GetPercentile(FramePhaseHistogram::kBuild, 50.0),
+             fml::TimeDelta::FromMilliseconds(50));
+
+  for (int i = 0; i < 9; i++) {
+    histogram.AddFrame(MakeFrameTiming(fml::TimeDelta::Zero(),
+                                       fml::TimeDelta::FromMilliseconds(2),
+                                       fml::TimeDelta::FromMilliseconds(1)));
+  }
+  EXPECT_EQ(histogram.frame_count(), 10u);
+  ExpectNear(histogram.GetPercentile(FramePhaseHistogram::kBuild, 90.0),
+             fml::TimeDelta::FromMilliseconds(2));
+  // The one slow frame left is the tail.
+  ExpectNear(histogram.GetPercentile(FramePhaseHistogram::kBuild, 99.0),
+             fml::TimeDelta::FromMilliseconds(50));
+}
+
+TEST(FramePhaseHistogramTest, RasterDurationOverridesTheFrameTiming) {
+  FramePhaseHistogram histogram;
+  histogram.AddFrame(MakeFrameTiming(fml::TimeDelta::Zero(),
+                                     fml::TimeDelta::FromMilliseconds(2),
+                                     fml::TimeDelta::FromMilliseconds(8)),
+                     fml::TimeDelta::FromMilliseconds(3));
+  ExpectNear(histogram.GetPercentile(FramePhaseHistogram::kRaster, 50.0),
+             fml::TimeDelta::FromMilliseconds(3));
+  ExpectNear(histogram.GetPercentile(FramePhaseHistogram::kTotal, 50.0),
+             fml::TimeDelta::FromMilliseconds(10));
+}
+
+TEST(FramePhaseHistogramTest, HistogramsAreKeptPerView) {
+  FramePhaseHistograms histograms;
+  FrameTiming timing = MakeFrameTiming(fml::TimeDelta::Zero(),
+                                       fml::TimeDelta::FromMilliseconds(2),
+                                       fml::TimeDelta::FromMilliseconds(8));
+  histograms.AddFrame(1, timing, fml::TimeDelta::FromMilliseconds(3));
+  histograms.AddFrame(2, timing, fml::TimeDelta::FromMilliseconds(5));
+  histograms.AddFrame(2, timing, fml::TimeDelta::FromMilliseconds(5));
+
+  std::map<int64_t, FramePhaseHistogram> copy = histograms.Get();
+  ASSERT_EQ(copy.size(), 2u);
+  EXPECT_EQ(copy.at(1).frame_count(), 1u);
+  EXPECT_EQ(copy.at(2).frame_count(), 2u);
+  ExpectNear(copy.at(2).GetPercentile(FramePhaseHistogram::kRaster, 50.0),
+             fml::TimeDelta::FromMilliseconds(5));
+
+  // The copy is not affected by later frames.
+  histograms.AddFrame(1, timing);
+  histograms.RemoveView(2);
+  EXPECT_EQ(copy.at(1).frame_count(), 1u);
+  std::map<int64_t, FramePhaseHistogram> updated = histograms.Get();
+  ASSERT_EQ(updated.size(), 1u);
+  EXPECT_EQ(updated.at(1).frame_count(), 2u);
+}
+
 }  // namespace flutter
@@ -46,6 +46,15 @@ void ColorFilterLayer::Preroll(PrerollContext* context) {
 
   ContainerLayer::Preroll(context);
 
+  // Our filter can be applied to each of our children instead of to all of
+  // them in a saveLayer if they can apply color filters, unless it also
+  // changes the transparent pixels between the children.
+  if (filter_ && filter_->modifies_transparent_black()) {
+    set_children_renderable_state_flags(
+        children_renderable_state_flags() &
+        ~LayerStateStack::kCallerCanApplyColorFilter);
+  }
+
   // Our saveLayer would apply any outstanding opacity or any outstanding
   // image filter before it applies our color filter, but that is in the
   // wrong order compared to how these attributes were applied to the tree
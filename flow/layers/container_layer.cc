@@ -4,6 +4,7 @@
 
 #include "flutter/flow/layers/container_layer.h"
 
+#include <algorithm>
 #include <optional>
 
 namespace flutter {
@@ -91,6 +92,10 @@ void ContainerLayer::DiffChildren(DiffContext* context,
         // associate their paint region with current layer tree so that we can
         // retrieve it in next frame diff
         layer->PreservePaintRegion(context);
+
+        // The layer may also reuse the results of its previous Preroll
+        layer->MarkUnchangedSinceLastFrame();
+        context->statistics().AddUnchangedLayer();
       } else {
         layer->Diff(context, prev_layer.get());
       }
@@ -126,6 +131,27 @@ static bool safe_intersection_test(const SkRect* rect1, const SkRect& rect2) {
   return rect1->intersects(rect2);
 }
 
+// Returns true if any two of the |rects| intersect.
+//
+// The rects are sorted by their left edges and swept from left to right,
+// so that each rect is only tested against the rects that start before it
+// ends. Unlike testing each rect against the union of the rects before it,
+// this proves that the children of a grid or any other 2D layout do not
+// overlap.
+static bool any_rects_intersect(std::vector<SkRect>& rects) {
+  std::sort(rects.begin(), rects.end(),
+            [](const SkRect& a, const SkRect& b) { return a.fLeft < b.fLeft; });
+  for (size_t i = 0; i < rects.size(); i++) {
+    for (size_t j = i + 1;
+         j < rects.size() && rects[j].fLeft < rects[i].fRight; j++) {
+      if (rects[i].intersects(rects[j])) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 void ContainerLayer::PrerollChildren(PrerollContext* context,
                                      SkRect* child_paint_bounds) {
   // Platform views have no children, so context->has_platform_view should
@@ -135,7 +161,12 @@ void ContainerLayer::PrerollChildren(PrerollContext* context,
 
   bool child_has_platform_view = false;
   bool child_has_texture_layer = false;
-  bool all_renderable_state_flags = LayerStateStack::kCallerCanApplyAnything;
+  int all_renderable_state_flags = LayerStateStack::kCallerCanApplyAnything;
+  // The paint bounds of the children that paint anything, which only need
+  // to be tested for overlaps once a child intersects the bounds of the
+  // children before it.
+  std::vector<SkRect> painted_child_bounds;
+  bool may_overlap = false;
 
   for (auto& layer : layers_) {
     // Reset context->has_platform_view and context->has_texture_layer to false
@@ -148,14 +179,14 @@ void ContainerLayer::PrerollChildren(PrerollContext* context,
     // opt-in to applying state attributes during its |Preroll|
     context->renderable_state_flags = 0;
 
-    layer->Preroll(context);
+    layer->PrerollOrReuse(context);
 
     all_renderable_state_flags &= context->renderable_state_flags;
     if (safe_intersection_test(child_paint_bounds, layer->paint_bounds())) {
-      // This will allow inheritance by a linear sequence of non-overlapping
-      // children, but will fail with a grid or other arbitrary 2D layout.
-      // See https://github.com/flutter/flutter/issues/93899
-      all_renderable_state_flags = 0;
+      may_overlap = true;
+    }
+    if (!layer->paint_bounds().isEmpty()) {
+      painted_child_bounds.push_back(layer->paint_bounds());
     }
     child_paint_bounds->join(layer->paint_bounds());
 
@@ -165,6 +196,16 @@ void ContainerLayer::PrerollChildren(PrerollContext* context,
         child_has_texture_layer || context->has_texture_layer;
   }
 
+  // Opacity and color filters can be applied to each of the children,
+  // rather than to all of them in a saveLayer, as long as no two children
+  // overlap. Image filters can spread the contents of a child beyond its
+  // paint bounds, so they are always applied to the children as a group.
+  all_renderable_state_flags &= ~LayerStateStack::kCallerCanApplyImageFilter;
+  if (all_renderable_state_flags != 0 && may_overlap &&
+      any_rects_intersect(painted_child_bounds)) {
+    all_renderable_state_flags = 0;
+  }
+
   context->has_platform_view = child_has_platform_view;
   context->has_texture_layer = child_has_texture_layer;
   context->renderable_state_flags = all_renderable_state_flags;
@@ -188,10 +229,27 @@ void ContainerLayer::PaintChildren(PaintContext& context) const {
   // Intentionally not tracing here as there should be no self-time
   // and the trace event on this common function has a small overhead.
   for (auto& layer : layers_) {
-    if (layer->needs_painting(context)) {
+    if (layer->needs_painting(context) && IsDamaged(context, layer.get())) {
       layer->Paint(context);
     }
   }
 }
 
+bool ContainerLayer::IsDamaged(const PaintContext& context,
+                               const Layer* layer) {
+  if (!context.damage_region || !context.paint_region_map) {
+    return true;
+  }
+  auto found = context.paint_region_map->find(layer->unique_id());
+  if (found == context.paint_region_map->end() || !found->second.is_valid()) {
+    return true;
+  }
+  for (const SkRect& rect : found->second) {
+    if (context.damage_region->intersects(rect.roundOut())) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace flutter
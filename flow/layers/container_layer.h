@@ -48,6 +48,10 @@ class ContainerLayer : public Layer {
   void PrerollChildren(PrerollContext* context, SkRect* child_paint_bounds);
 
  private:
+  // Whether |layer| paints into the damage region of |context|, if there
+  // is one.
+  static bool IsDamaged(const PaintContext& context, const Layer* layer);
+
   std::vector<std::shared_ptr<Layer>> layers_;
   SkRect child_paint_bounds_;
   int children_renderable_state_flags_ = 0;
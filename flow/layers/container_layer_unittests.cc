@@ -4,10 +4,12 @@
 
 #include "flutter/flow/layers/container_layer.h"
 
+#include "flutter/flow/layers/backdrop_filter_layer.h"
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/layers/layer_tree.h"
 #include "flutter/flow/testing/diff_context_test.h"
 #include "flutter/flow/testing/layer_test.h"
+#include "flutter/flow/testing/mock_embedder.h"
 #include "flutter/flow/testing/mock_layer.h"
 #include "flutter/fml/macros.h"
 #include "gtest/gtest.h"
@@ -763,6 +765,253 @@ TEST_F(ContainerLayerDiffTest, ReplaceLayer) {
   EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(200, 0, 250, 150));
 }
 
+TEST_F(ContainerLayerDiffTest, RetainedLayerReusesPreroll) {
+  auto path1 = SkPath().addRect(SkRect::MakeLTRB(0, 0, 50, 50));
+  auto path2 = SkPath().addRect(SkRect::MakeLTRB(100, 0, 150, 50));
+
+  auto mock1 = std::make_shared<MockLayer>(path1);
+  auto c1 = CreateContainerLayer(mock1);
+
+  MockLayerTree t1;
+  t1.root()->Add(c1);
+  t1.root()->Add(CreateContainerLayer(std::make_shared<MockLayer>(path2)));
+  DiffLayerTree(t1, MockLayerTree());
+
+  DiffContext::Statistics statistics;
+  preroll_context()->diff_statistics = &statistics;
+  t1.root()->Preroll(preroll_context());
+  EXPECT_EQ(c1->paint_bounds(), path1.getBounds());
+  EXPECT_EQ(statistics.reused_prerolls(), 0);
+  EXPECT_EQ(statistics.recomputed_prerolls(), 0);
+
+  // Another Preroll of the child would restore its paint bounds.
+  mock1->set_paint_bounds(SkRect::MakeEmpty());
+
+  MockLayerTree t2;
+  t2.root()->Add(c1);
+  t2.root()->Add(CreateContainerLayer(std::make_shared<MockLayer>(path2)));
+  DiffLayerTree(t2, t1);
+  t2.root()->Preroll(preroll_context());
+  EXPECT_EQ(statistics.reused_prerolls(), 1);
+  EXPECT_EQ(statistics.recomputed_prerolls(), 0);
+  EXPECT_EQ(mock1->paint_bounds(), SkRect::MakeEmpty());
+  EXPECT_EQ(c1->paint_bounds(), path1.getBounds());
+  EXPECT_EQ(t2.root()->paint_bounds(), SkRect::MakeLTRB(0, 0, 150, 50));
+
+  // The previous Preroll cannot be reused under a different transform.
+  MockLayerTree t3;
+  t3.root()->Add(c1);
+  DiffLayerTree(t3, t2);
+  preroll_context()->state_stack.set_preroll_delegate(
+      SkMatrix::Translate(10, 0));
+  t3.root()->Preroll(preroll_context());
+  EXPECT_EQ(statistics.reused_prerolls(), 1);
+  EXPECT_EQ(statistics.recomputed_prerolls(), 1);
+  EXPECT_EQ(mock1->paint_bounds(), path1.getBounds());
+  EXPECT_EQ(mock1->parent_matrix(), SkMatrix::Translate(10, 0));
+}
+
+TEST_F(ContainerLayerDiffTest, RetainedLayerReplaysRasterCacheEntries) {
+  use_mock_raster_cache();
+  auto path = SkPath().addRect(SkRect::MakeLTRB(0, 0, 50, 50));
+  // The layer is cached once it has been prerolled 3 times.
+  auto cacheable = std::make_shared<MockCacheableLayer>(path);
+  auto c1 = CreateContainerLayer(cacheable);
+
+  DiffContext::Statistics statistics;
+  preroll_context()->diff_statistics = &statistics;
+  MockLayerTree previous;
+  for (int frame = 0; frame < 4; frame++) {
+    MockLayerTree tree;
+    tree.root()->Add(c1);
+    DiffLayerTree(tree, previous);
+    cacheable_items().clear();
+    preroll_context()->raster_cache->BeginFrame();
+    tree.root()->Preroll(preroll_context());
+    preroll_context()->raster_cache->EvictUnusedCacheEntries();
+
+    // The entry of the layer is registered again in every frame.
+    ASSERT_EQ(cacheable_items().size(), 1u);
+    EXPECT_EQ(cacheable_items()[0], cacheable->raster_cache_item());
+    EXPECT_EQ(statistics.reused_prerolls(), frame);
+    previous = std::move(tree);
+  }
+
+  // Replaying the Preroll advanced the caching decision of the layer as
+  // prerolling it would have.
+  EXPECT_EQ(statistics.recomputed_prerolls(), 0);
+  EXPECT_EQ(cacheable->raster_cache_item()->cache_state(),
+            RasterCacheItem::CacheState::kCurrent);
+}
+
+TEST_F(ContainerLayerDiffTest, RetainedLayerReplaysRenderableStateFlags) {
+  auto path1 = SkPath().addRect(SkRect::MakeLTRB(0, 0, 50, 50));
+  auto path2 = SkPath().addRect(SkRect::MakeLTRB(100, 0, 150, 50));
+  auto c1 = CreateContainerLayer(MockLayer::MakeOpacityCompatible(path1));
+  auto c2 = CreateContainerLayer(MockLayer::MakeOpacityCompatible(path2));
+
+  MockLayerTree t1;
+  t1.root()->Add(c1);
+  t1.root()->Add(c2);
+  DiffLayerTree(t1, MockLayerTree());
+  DiffContext::Statistics statistics;
+  preroll_context()->diff_statistics = &statistics;
+  t1.root()->Preroll(preroll_context());
+  EXPECT_EQ(preroll_context()->renderable_state_flags,
+            LayerStateStack::kCallerCanApplyOpacity);
+
+  // Both children replay the flags their previous Preroll left, which lets
+  // the root apply opacity to them.
+  MockLayerTree t2;
+  t2.root()->Add(c1);
+  t2.root()->Add(c2);
+  DiffLayerTree(t2, t1);
+  preroll_context()->renderable_state_flags = 0;
+  t2.root()->Preroll(preroll_context());
+  EXPECT_EQ(statistics.reused_prerolls(), 2);
+  EXPECT_EQ(preroll_context()->renderable_state_flags,
+            LayerStateStack::kCallerCanApplyOpacity);
+  EXPECT_EQ(t2.root()->children_renderable_state_flags(),
+            LayerStateStack::kCallerCanApplyOpacity);
+}
+
+TEST_F(ContainerLayerDiffTest, RetainedLayerWithPlatformViewIsPrerolled) {
+  auto path1 = SkPath().addRect(SkRect::MakeLTRB(0, 0, 50, 50));
+  auto mock1 = std::make_shared<MockLayer>(path1);
+  mock1->set_fake_has_platform_view(true);
+  auto c1 = CreateContainerLayer(mock1);
+
+  MockLayerTree t1;
+  t1.root()->Add(c1);
+  DiffLayerTree(t1, MockLayerTree());
+  DiffContext::Statistics statistics;
+  preroll_context()->diff_statistics = &statistics;
+  t1.root()->Preroll(preroll_context());
+  EXPECT_TRUE(preroll_context()->has_platform_view);
+  EXPECT_TRUE(c1->subtree_has_platform_view());
+
+  // The platform view has to be positioned by the view embedder in every
+  // frame, so its container is prerolled again and the platform view is
+  // reported to the root.
+  mock1->set_paint_bounds(SkRect::MakeEmpty());
+  MockLayerTree t2;
+  t2.root()->Add(c1);
+  DiffLayerTree(t2, t1);
+  preroll_context()->has_platform_view = false;
+  t2.root()->Preroll(preroll_context());
+  EXPECT_EQ(statistics.reused_prerolls(), 0);
+  EXPECT_EQ(statistics.recomputed_prerolls(), 1);
+  EXPECT_EQ(mock1->paint_bounds(), path1.getBounds());
+  EXPECT_TRUE(preroll_context()->has_platform_view);
+  EXPECT_TRUE(t2.root()->subtree_has_platform_view());
+}
+
+TEST_F(ContainerLayerDiffTest, ChangedLayerDoesNotReusePreroll) {
+  auto path1 = SkPath().addRect(SkRect::MakeLTRB(0, 0, 50, 50));
+  auto path2 = SkPath().addRect(SkRect::MakeLTRB(100, 0, 150, 50));
+  auto mock1 = std::make_shared<MockLayer>(path1);
+  auto c1 = CreateContainerLayer(mock1);
+
+  MockLayerTree t1;
+  t1.root()->Add(c1);
+  DiffLayerTree(t1, MockLayerTree());
+  DiffContext::Statistics statistics;
+  preroll_context()->diff_statistics = &statistics;
+  t1.root()->Preroll(preroll_context());
+
+  // A new container for the same child, as the framework creates when the
+  // subtree changes, is prerolled.
+  mock1->set_paint_bounds(SkRect::MakeEmpty());
+  auto c1_changed =
+      CreateContainerLayer({mock1, std::make_shared<MockLayer>(path2)});
+  MockLayerTree t2;
+  t2.root()->Add(c1_changed);
+  DiffLayerTree(t2, t1);
+  t2.root()->Preroll(preroll_context());
+  EXPECT_EQ(statistics.reused_prerolls(), 0);
+  EXPECT_EQ(mock1->paint_bounds(), path1.getBounds());
+  EXPECT_EQ(c1_changed->paint_bounds(), SkRect::MakeLTRB(0, 0, 150, 50));
+
+  // A layer is only marked unchanged for the Preroll that follows the diff
+  // that retained it.
+  MockLayerTree t3;
+  t3.root()->Add(c1_changed);
+  DiffLayerTree(t3, t2);
+  t3.root()->Preroll(preroll_context());
+  EXPECT_EQ(statistics.reused_prerolls(), 1);
+  mock1->set_paint_bounds(SkRect::MakeEmpty());
+  t3.root()->Preroll(preroll_context());
+  EXPECT_EQ(statistics.reused_prerolls(), 1);
+  EXPECT_EQ(mock1->paint_bounds(), path1.getBounds());
+
+  // Without a diff of the frame, the Preroll is never reused.
+  preroll_context()->diff_statistics = nullptr;
+  MockLayerTree t4;
+  t4.root()->Add(c1_changed);
+  DiffLayerTree(t4, t3);
+  mock1->set_paint_bounds(SkRect::MakeEmpty());
+  t4.root()->Preroll(preroll_context());
+  EXPECT_EQ(statistics.reused_prerolls(), 1);
+  EXPECT_EQ(mock1->paint_bounds(), path1.getBounds());
+}
+
+TEST_F(ContainerLayerDiffTest, RetainedLayerWithBackdropFilterIsPrerolled) {
+  class FilterCountingViewEmbedder : public MockViewEmbedder {
+   public:
+    void PushFilterToVisitedPlatformViews(
+        const std::shared_ptr<const DlImageFilter>& filter,
+        const SkRect& filter_rect) override {
+      pushed_filters++;
+    }
+    int pushed_filters = 0;
+  };
+
+  auto path1 = SkPath().addRect(SkRect::MakeLTRB(0, 0, 50, 50));
+  auto backdrop = std::make_shared<BackdropFilterLayer>(
+      std::make_shared<DlBlurImageFilter>(2.5, 3.2, DlTileMode::kClamp),
+      DlBlendMode::kSrcOver);
+  backdrop->Add(std::make_shared<MockLayer>(path1));
+  auto c1 = CreateContainerLayer(backdrop);
+  auto root = CreateContainerLayer(c1);
+
+  FilterCountingViewEmbedder embedder;
+  DiffContext::Statistics statistics;
+  preroll_context()->view_embedder = &embedder;
+  preroll_context()->diff_statistics = &statistics;
+  root->Preroll(preroll_context());
+  EXPECT_EQ(embedder.pushed_filters, 1);
+
+  // The filter has to be pushed to the platform views of every frame, so
+  // the container is prerolled again even when it is retained.
+  c1->MarkUnchangedSinceLastFrame();
+  root->Preroll(preroll_context());
+  EXPECT_EQ(statistics.reused_prerolls(), 0);
+  EXPECT_EQ(statistics.recomputed_prerolls(), 1);
+  EXPECT_EQ(embedder.pushed_filters, 2);
+  preroll_context()->view_embedder = nullptr;
+}
+
+TEST_F(ContainerLayerDiffTest, RetainedLayerIsPrerolledForNewColorSpace) {
+  auto path1 = SkPath().addRect(SkRect::MakeLTRB(0, 0, 50, 50));
+  auto mock1 = std::make_shared<MockLayer>(path1);
+  auto c1 = CreateContainerLayer(mock1);
+  auto root = CreateContainerLayer(c1);
+
+  DiffContext::Statistics statistics;
+  preroll_context()->diff_statistics = &statistics;
+  root->Preroll(preroll_context());
+
+  c1->MarkUnchangedSinceLastFrame();
+  preroll_context()->dst_color_space = SkColorSpace::MakeSRGBLinear();
+  root->Preroll(preroll_context());
+  EXPECT_EQ(statistics.reused_prerolls(), 0);
+  EXPECT_EQ(statistics.recomputed_prerolls(), 1);
+
+  c1->MarkUnchangedSinceLastFrame();
+  root->Preroll(preroll_context());
+  EXPECT_EQ(statistics.reused_prerolls(), 1);
+}
+
 }  // namespace testing
 }  // namespace flutter
 
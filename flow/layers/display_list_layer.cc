@@ -30,30 +30,45 @@ DisplayListLayer::DisplayListLayer(const SkPoint& offset,
 
 bool DisplayListLayer::IsReplacing(DiffContext* context,
                                    const Layer* layer) const {
-  // Only return true for identical display lists; This way
+  // Only return true for identical display lists, or for display lists
+  // spliced from the old one which know exactly what changed; This way
   // ContainerLayer::DiffChildren can detect when a display list layer
   // got inserted between other display list layers
   auto old_layer = layer->as_display_list_layer();
-  return old_layer != nullptr && offset_ == old_layer->offset_ &&
-         Compare(context->statistics(), this, old_layer);
+  if (old_layer == nullptr || offset_ != old_layer->offset_) {
+    return false;
+  }
+  if (display_list_->IsSplicedFrom(*old_layer->display_list_)) {
+    context->statistics().AddSplicedPicture();
+    return true;
+  }
+  return Compare(context->statistics(), this, old_layer);
 }
 
 void DisplayListLayer::Diff(DiffContext* context, const Layer* old_layer) {
   DiffContext::AutoSubtreeRestore subtree(context);
+  bool spliced = false;
   if (!context->IsSubtreeDirty()) {
-#ifndef NDEBUG
     FML_DCHECK(old_layer);
-    auto prev = old_layer->as_display_list_layer();
+    auto prev = old_layer ? old_layer->as_display_list_layer() : nullptr;
+    spliced = prev && display_list_->IsSplicedFrom(*prev->display_list_);
+#ifndef NDEBUG
     DiffContext::Statistics dummy_statistics;
     // IsReplacing has already determined that the display list is same
-    FML_DCHECK(prev->offset_ == offset_ &&
-               Compare(dummy_statistics, this, prev));
+    // or only differs within its precomputed changed region
+    FML_DCHECK(prev && prev->offset_ == offset_ &&
+               (spliced || Compare(dummy_statistics, this, prev)));
 #endif
   }
   context->PushTransform(SkMatrix::Translate(offset_.x(), offset_.y()));
   if (context->has_raster_cache()) {
     context->WillPaintWithIntegralTransform();
   }
+  if (spliced) {
+    for (const SkRect& rect : display_list_->GetSpliceChangedRects()) {
+      context->AddLayerDamage(rect);
+    }
+  }
   context->AddLayerBounds(display_list()->bounds());
   context->SetLayerPaintRegion(this, context->CurrentSubtreeRegion());
 }
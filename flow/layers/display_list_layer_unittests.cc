@@ -439,6 +439,32 @@ TEST_F(DisplayListLayerDiffTest, DisplayListCompare) {
   EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(20, 20, 70, 70));
 }
 
+TEST_F(DisplayListLayerDiffTest, SplicedDisplayList) {
+  DisplayListBuilder base_builder(/*prepare_rtree=*/true);
+  base_builder.DrawRect(DlRect::MakeLTRB(10, 10, 20, 20), DlPaint());
+  base_builder.DrawRect(DlRect::MakeLTRB(100, 100, 110, 110), DlPaint());
+  auto base = base_builder.Build();
+
+  MockLayerTree tree1;
+  tree1.root()->Add(CreateDisplayListLayer(base));
+  auto damage = DiffLayerTree(tree1, MockLayerTree());
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(10, 10, 110, 110));
+
+  DisplayListBuilder builder(/*prepare_rtree=*/true);
+  builder.BeginSplice(base);
+  builder.SpliceGroup(0);
+  builder.DrawRect(DlRect::MakeLTRB(100, 100, 110, 110),
+                   DlPaint(DlColor::kRed()));
+  auto spliced = builder.Build();
+  ASSERT_TRUE(spliced->IsSplicedFrom(*base));
+
+  // Only the changed region is damaged without deep comparing the lists
+  MockLayerTree tree2;
+  tree2.root()->Add(CreateDisplayListLayer(spliced));
+  damage = DiffLayerTree(tree2, tree1);
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(100, 100, 110, 110));
+}
+
 TEST_F(DisplayListLayerTest, DisplayListAccessCountDependsOnVisibility) {
   const SkPoint layer_offset = SkPoint::Make(1.5f, -0.5f);
   const SkRect picture_bounds = SkRect::MakeLTRB(5.0f, 6.0f, 20.5f, 21.5f);
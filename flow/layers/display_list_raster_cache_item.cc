@@ -6,6 +6,7 @@
 
 #include "flutter/flow/layers/display_list_raster_cache_item.h"
 
+#include <algorithm>
 #include <optional>
 #include <utility>
 
@@ -20,6 +21,8 @@
 
 namespace flutter {
 
+static const auto* flow_type = "RasterCacheFlow::DisplayList";
+
 static bool IsDisplayListWorthRasterizing(
     const DisplayList* display_list,
     bool will_change,
@@ -105,18 +108,56 @@ void DisplayListRasterCacheItem::PrerollFinalize(PrerollContext* context,
       !context->raster_cached_entries) {
     return;
   }
+  SkRect bounds = display_list_->bounds().makeOffset(offset_.x(), offset_.y());
+  preroll_matrix_ = matrix;
+  visible_ = !context->state_stack.content_culled(bounds);
+  UpdateCacheState(context);
+}
+
+bool DisplayListRasterCacheItem::CanReplayPreroll(
+    const PrerollContext& context) const {
+  if (!visible_) {
+    // Entries that are not visible are never drawn from the cache.
+    return true;
+  }
+  // Predict the outcome of the MarkSeen call in |UpdateCacheState|.
+  size_t accesses =
+      std::max(context.raster_cache->GetAccessCount(key_id_, preroll_matrix_),
+               0) +
+      1;
+  bool draws_from_cache =
+      accesses > context.raster_cache->access_threshold() &&
+      context.raster_cache->HasImage(key_id_, preroll_matrix_);
+  return draws_from_cache == draws_from_cache_;
+}
+
+void DisplayListRasterCacheItem::PrerollReplay(PrerollContext* context) {
+  UpdateCacheState(context);
+}
+
+void DisplayListRasterCacheItem::UpdateCacheState(PrerollContext* context) {
   auto* raster_cache = context->raster_cache;
   SkRect bounds = display_list_->bounds().makeOffset(offset_.x(), offset_.y());
-  bool visible = !context->state_stack.content_culled(bounds);
-  RasterCache::CacheInfo cache_info =
-      raster_cache->MarkSeen(key_id_, matrix, visible);
-  if (!visible ||
+  RasterCache::AsyncRequest async_request = {
+      // clang-format off
+      .display_list       = display_list_,
+      .dst_color_space    = context->dst_color_space,
+      .matrix             = transformation_matrix_,
+      .logical_rect       = bounds,
+      .flow_type          = flow_type,
+      // clang-format on
+  };
+  RasterCache::CacheInfo cache_info = raster_cache->MarkSeen(
+      key_id_, preroll_matrix_, visible_, &async_request);
+  draws_from_cache_ = false;
+  if (!visible_ ||
       cache_info.accesses_since_visible <= raster_cache->access_threshold()) {
     cache_state_ = kNone;
   } else {
     if (cache_info.has_image) {
       context->renderable_state_flags |=
           LayerStateStack::kCallerCanApplyOpacity;
+      draws_from_cache_ = true;
     }
     cache_state_ = kCurrent;
   }
@@ -141,8 +182,6 @@ bool DisplayListRasterCacheItem::Draw(const PaintContext& context,
   return false;
 }
 
-static const auto* flow_type = "RasterCacheFlow::DisplayList";
-
 bool DisplayListRasterCacheItem::TryToPrepareRasterCache(
     const PaintContext& context,
     bool parent_cached) const {
@@ -36,6 +36,10 @@ class DisplayListRasterCacheItem : public RasterCacheItem {
   void PrerollFinalize(PrerollContext* context,
                        const SkMatrix& matrix) override;
 
+  bool CanReplayPreroll(const PrerollContext& context) const override;
+
+  void PrerollReplay(PrerollContext* context) override;
+
   bool Draw(const PaintContext& context, const DlPaint* paint) const override;
 
   bool Draw(const PaintContext& context,
@@ -52,7 +56,15 @@ class DisplayListRasterCacheItem : public RasterCacheItem {
   const DisplayList* display_list() const { return display_list_.get(); }
 
  private:
+  void UpdateCacheState(PrerollContext* context);
+
   SkMatrix transformation_matrix_;
+  // The matrix and visibility of the last PrerollFinalize.
+  SkMatrix preroll_matrix_;
+  bool visible_ = false;
+  // Whether the last PrerollFinalize found an image to draw, which allows
+  // the layer to apply opacity to it.
+  bool draws_from_cache_ = false;
   sk_sp<DisplayList> display_list_;
   SkPoint offset_;
   bool is_complex_;
@@ -5,6 +5,7 @@
 #include "flutter/flow/layers/layer.h"
 
 #include "flutter/flow/paint_utils.h"
+#include "flutter/flow/raster_cache_item.h"
 
 namespace flutter {
 
@@ -24,6 +25,97 @@ uint64_t Layer::NextUniqueID() {
   return id;
 }
 
+static bool HasRasterCache(const PrerollContext* context) {
+#if SLIMPELLER
+  return false;
+#else   // SLIMPELLER
+  return context->raster_cache && context->raster_cached_entries;
+#endif  //  SLIMPELLER
+}
+
+void Layer::PrerollOrReuse(PrerollContext* context) {
+  bool unchanged = unchanged_since_last_frame_;
+  unchanged_since_last_frame_ = false;
+  // Only the Preroll of containers is worth remembering, and only when the
+  // diff of this frame can tell whether it is still valid.
+  if (!context->diff_statistics || !as_container_layer()) {
+    preroll_memo_.reset();
+    Preroll(context);
+    return;
+  }
+
+  if (unchanged) {
+    if (MatchesPrerollMemo(context) && ReplayPreroll(context)) {
+      context->diff_statistics->AddReusedPreroll();
+      return;
+    }
+    context->diff_statistics->AddRecomputedPreroll();
+  }
+
+  auto memo = std::make_unique<PrerollMemo>();
+  memo->transform = context->state_stack.transform_4x4();
+  memo->device_cull_rect = context->state_stack.device_cull_rect();
+  memo->dst_color_space = context->dst_color_space;
+  memo->has_raster_cache = HasRasterCache(context);
+  memo->surface_needs_readback_before = context->surface_needs_readback;
+  size_t first_entry = context->raster_cached_entries
+                           ? context->raster_cached_entries->size()
+                           : 0;
+  int first_pushed_filter = context->pushed_platform_view_filters;
+
+  Preroll(context);
+
+  // Platform views have to be prerolled every frame to be positioned by
+  // the view embedder, and so do backdrop filters that apply to the
+  // platform views below them.
+  if (context->has_platform_view || subtree_has_platform_view() ||
+      context->pushed_platform_view_filters != first_pushed_filter) {
+    preroll_memo_.reset();
+    return;
+  }
+  memo->surface_needs_readback = context->surface_needs_readback;
+  memo->has_texture_layer = context->has_texture_layer;
+  memo->renderable_state_flags = context->renderable_state_flags;
+  if (context->raster_cached_entries) {
+    memo->raster_cached_items.assign(
+        context->raster_cached_entries->begin() + first_entry,
+        context->raster_cached_entries->end());
+  }
+  preroll_memo_ = std::move(memo);
+}
+
+bool Layer::MatchesPrerollMemo(const PrerollContext* context) const {
+  return preroll_memo_ &&
+         preroll_memo_->transform == context->state_stack.transform_4x4() &&
+         preroll_memo_->device_cull_rect ==
+             context->state_stack.device_cull_rect() &&
+         SkColorSpace::Equals(preroll_memo_->dst_color_space.get(),
+                              context->dst_color_space.get()) &&
+         preroll_memo_->has_raster_cache == HasRasterCache(context) &&
+         preroll_memo_->surface_needs_readback_before ==
+             context->surface_needs_readback;
+}
+
+bool Layer::ReplayPreroll(PrerollContext* context) const {
+#if !SLIMPELLER
+  // Check every entry before replaying any of them so that a Preroll that
+  // cannot be reused does not leave the raster cache marked twice.
+  for (RasterCacheItem* item : preroll_memo_->raster_cached_items) {
+    if (!item->CanReplayPreroll(*context)) {
+      return false;
+    }
+  }
+  for (RasterCacheItem* item : preroll_memo_->raster_cached_items) {
+    context->raster_cached_entries->push_back(item);
+    item->PrerollReplay(context);
+  }
+#endif  //  !SLIMPELLER
+  context->surface_needs_readback = preroll_memo_->surface_needs_readback;
+  context->has_texture_layer = preroll_memo_->has_texture_layer;
+  context->renderable_state_flags = preroll_memo_->renderable_state_flags;
+  return true;
+}
+
 Layer::AutoPrerollSaveLayerState::AutoPrerollSaveLayerState(
     PrerollContext* preroll_context,
     bool save_layer_is_active,
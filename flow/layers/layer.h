@@ -69,6 +69,9 @@ struct PrerollContext {
   // These allow us to track properties like elevation, opacity, and the
   // presence of a texture layer during Preroll.
   bool has_texture_layer = false;
+  // The number of backdrop filters pushed to the platform views visited so
+  // far, which a Preroll that is reused would not push again.
+  int pushed_platform_view_filters = 0;
 
   // The list of flags that describe which rendering state attributes
   // (such as opacity, ColorFilter, ImageFilter) a given layer can
@@ -81,6 +84,11 @@ struct PrerollContext {
   int renderable_state_flags = 0;
 
   std::vector<RasterCacheItem*>* raster_cached_entries;
+
+  // Set when the layer tree was diffed against the previous frame before
+  // this Preroll, which allows unchanged layers to reuse the results of
+  // their previous Preroll. See |Layer::PrerollOrReuse|.
+  DiffContext::Statistics* diff_statistics = nullptr;
 };
 
 struct PaintContext {
@@ -114,6 +122,13 @@ struct PaintContext {
 
   bool impeller_enabled = false;
   impeller::AiksContext* aiks_context;
+
+  // When set, only the parts of the frame inside this region have to be
+  // painted, and |ContainerLayer::PaintChildren| skips the children whose
+  // paint region in |paint_region_map| does not intersect it. Both are in
+  // the screen coordinates of the frame the layer tree was diffed in.
+  const DlRegion* damage_region = nullptr;
+  const PaintRegionMap* paint_region_map = nullptr;
 };
 
 // Represents a single composited layer. Created on the UI thread but then
@@ -162,6 +177,21 @@ class Layer {
 
   virtual void Preroll(PrerollContext* context) = 0;
 
+  // Called by |ContainerLayer::DiffChildren| when this layer is retained
+  // from the previous frame, i.e. it is the same instance and neither it
+  // nor its subtree changed.
+  void MarkUnchangedSinceLastFrame() { unchanged_since_last_frame_ = true; }
+
+  // Used by container layers to preroll their children. Calls |Preroll|
+  // unless this layer was marked unchanged by the diff of the current frame
+  // and it is prerolled with the same transform, cull rect, color space and
+  // raster cache as last time, in which case the paint bounds and platform
+  // view state left on the subtree by the previous Preroll are kept and
+  // only the effects of that Preroll on |context| and the raster cache are
+  // replayed. Subtrees with platform views, or with backdrop filters that
+  // apply to platform views, are always prerolled.
+  void PrerollOrReuse(PrerollContext* context);
+
   // Used during Preroll by layers that employ a saveLayer to manage the
   // PrerollContext settings with values affected by the saveLayer mechanism.
   // This object must be created before calling Preroll on the children to
@@ -260,10 +290,30 @@ class Layer {
   virtual const testing::MockLayer* as_mock_layer() const { return nullptr; }
 
  private:
+  // The state a Preroll of this layer was performed in and its results.
+  struct PrerollMemo {
+    SkM44 transform;
+    SkRect device_cull_rect;
+    sk_sp<SkColorSpace> dst_color_space;
+    bool has_raster_cache;
+    bool surface_needs_readback_before;
+
+    bool surface_needs_readback;
+    bool has_texture_layer;
+    int renderable_state_flags;
+    // The entries the subtree added to |raster_cached_entries|, in order.
+    std::vector<RasterCacheItem*> raster_cached_items;
+  };
+
+  bool MatchesPrerollMemo(const PrerollContext* context) const;
+  bool ReplayPreroll(PrerollContext* context) const;
+
   SkRect paint_bounds_;
   uint64_t unique_id_;
   uint64_t original_layer_id_;
   bool subtree_has_platform_view_ = false;
+  bool unchanged_since_last_frame_ = false;
+  std::unique_ptr<PrerollMemo> preroll_memo_;
 
   static uint64_t NextUniqueID();
 
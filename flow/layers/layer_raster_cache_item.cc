@@ -43,6 +43,7 @@ std::unique_ptr<LayerRasterCacheItem> LayerRasterCacheItem::Make(
 
 void LayerRasterCacheItem::PrerollFinalize(PrerollContext* context,
                                            const SkMatrix& matrix) {
+  finalized_ = false;
   if (!context->raster_cache || !context->raster_cached_entries) {
     return;
   }
@@ -54,10 +55,24 @@ void LayerRasterCacheItem::PrerollFinalize(PrerollContext* context,
     return;
   }
   child_items_ = context->raster_cached_entries->size() - child_items_;
+  finalized_ = true;
+  UpdateCacheState(context->raster_cache);
+}
+
+void LayerRasterCacheItem::PrerollReplay(PrerollContext* context) {
+  // The subtree adds the same number of entries as last time, so
+  // |child_items_| is still correct.
+  cache_state_ = CacheState::kNone;
+  if (finalized_) {
+    UpdateCacheState(context->raster_cache);
+  }
+}
+
+void LayerRasterCacheItem::UpdateCacheState(const RasterCache* raster_cache) {
   if (num_cache_attempts_ >= layer_cached_threshold_) {
     // the layer can be cached
     cache_state_ = CacheState::kCurrent;
-    context->raster_cache->MarkSeen(key_id_, matrix_, true);
+    raster_cache->MarkSeen(key_id_, matrix_, true);
   } else {
     num_cache_attempts_++;
     // access current layer
@@ -71,8 +86,7 @@ void LayerRasterCacheItem::PrerollFinalize(PrerollContext* context,
                                    RasterCacheKeyType::kLayerChildren);
       }
       cache_state_ = CacheState::kChildren;
-      context->raster_cache->MarkSeen(layer_children_id_.value(), matrix_,
-                                      true);
+      raster_cache->MarkSeen(layer_children_id_.value(), matrix_, true);
     }
   }
 }
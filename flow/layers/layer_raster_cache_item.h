@@ -38,6 +38,8 @@ class LayerRasterCacheItem : public RasterCacheItem {
   void PrerollFinalize(PrerollContext* context,
                        const SkMatrix& matrix) override;
 
+  void PrerollReplay(PrerollContext* context) override;
+
   bool Draw(const PaintContext& context, const DlPaint* paint) const override;
 
   bool Draw(const PaintContext& context,
@@ -56,6 +58,8 @@ class LayerRasterCacheItem : public RasterCacheItem {
  protected:
   const SkRect* GetPaintBoundsFromLayer() const;
 
+  void UpdateCacheState(const RasterCache* raster_cache);
+
   Layer* layer_;
 
   // The id for cache the layer's children.
@@ -67,6 +71,9 @@ class LayerRasterCacheItem : public RasterCacheItem {
   bool can_cache_children_ = false;
 
   mutable int num_cache_attempts_ = 1;
+
+  // Whether the last PrerollFinalize found the layer worth caching.
+  bool finalized_ = false;
 };
 
 }  // namespace flutter
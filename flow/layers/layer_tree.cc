@@ -27,7 +27,8 @@ inline SkColorSpace* GetColorSpace(DlCanvas* canvas) {
 
 bool LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
                         bool ignore_raster_cache,
-                        SkRect cull_rect) {
+                        SkRect cull_rect,
+                        DiffContext::Statistics* statistics) {
   TRACE_EVENT0("flutter", "LayerTree::Preroll");
 
   if (!root_layer_) {
@@ -56,6 +57,7 @@ bool LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
       .ui_time = frame.context().ui_time(),
       .texture_registry = frame.context().texture_registry(),
       .raster_cached_entries = &raster_cache_items_,
+      .diff_statistics = statistics,
   };
 
   root_layer_->Preroll(&context);
@@ -94,7 +96,8 @@ void LayerTree::TryToRasterCache(
 #endif  //  !SLIMPELLER
 
 void LayerTree::Paint(CompositorContext::ScopedFrame& frame,
-                      bool ignore_raster_cache) const {
+                      bool ignore_raster_cache,
+                      const DlRegion* damage_region) const {
   TRACE_EVENT0("flutter", "LayerTree::Paint");
 
   if (!root_layer_) {
@@ -114,6 +117,11 @@ void LayerTree::Paint(CompositorContext::ScopedFrame& frame,
       ignore_raster_cache ? nullptr : &frame.context().raster_cache();
 #endif  //  !SLIMPELLER
 
+  // Platform views have to be composited even where nothing changed.
+  if (root_layer_->subtree_has_platform_view()) {
+    damage_region = nullptr;
+  }
+
   PaintContext context = {
       // clang-format off
       .state_stack                   = state_stack,
@@ -129,6 +137,8 @@ void LayerTree::Paint(CompositorContext::ScopedFrame& frame,
 #endif  //  !SLIMPELLER
       .impeller_enabled              = !!frame.aiks_context(),
       .aiks_context                  = frame.aiks_context(),
+      .damage_region                 = damage_region,
+      .paint_region_map              = &paint_region_map_,
       // clang-format on
   };
 
@@ -31,9 +31,14 @@ class LayerTree {
   // - a boolean indicating whether or not the top level of the
   //   layer tree performs any operations that require readback
   //   from the root surface.
+  //
+  // If |statistics| is provided, layers that the diff of this frame found
+  // unchanged may reuse the results of their previous Preroll, and the
+  // number of layers that did is added to |statistics|.
   bool Preroll(CompositorContext::ScopedFrame& frame,
                bool ignore_raster_cache = false,
-               SkRect cull_rect = kGiantRect);
+               SkRect cull_rect = kGiantRect,
+               DiffContext::Statistics* statistics = nullptr);
 
 #if !SLIMPELLER
   static void TryToRasterCache(
@@ -42,8 +47,11 @@ class LayerTree {
       bool ignore_raster_cache = false);
 #endif  //  !SLIMPELLER
 
+  // If |damage_region| is provided, the frame has been clipped to it and
+  // the layers that do not intersect it are not painted.
   void Paint(CompositorContext::ScopedFrame& frame,
-             bool ignore_raster_cache = false) const;
+             bool ignore_raster_cache = false,
+             const DlRegion* damage_region = nullptr) const;
 
   sk_sp<DisplayList> Flatten(
       const SkRect& bounds,
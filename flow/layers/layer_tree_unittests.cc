@@ -210,6 +210,73 @@ TEST_F(LayerTreeTest, NeedsSystemComposite) {
   EXPECT_TRUE(DisplayListsEQ_Verbose(display_list(), expected_dl));
 }
 
+TEST_F(LayerTreeTest, PaintSkipsLayersOutsideOfDamageRegion) {
+  const SkPath child_path1 = SkPath().addRect(0.0f, 0.0f, 10.0f, 10.0f);
+  const SkPath child_path2 = SkPath().addRect(20.0f, 0.0f, 30.0f, 10.0f);
+  const SkPath child_path3 = SkPath().addRect(40.0f, 0.0f, 50.0f, 10.0f);
+  const DlPaint child_paint = DlPaint(DlColor::kGreen());
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(std::make_shared<MockLayer>(child_path1, child_paint));
+  layer->Add(std::make_shared<MockLayer>(child_path2, child_paint));
+  layer->Add(std::make_shared<MockLayer>(child_path3, child_paint));
+
+  auto layer_tree = BuildLayerTree(layer);
+  FrameDamage frame_damage;
+  frame_damage.ComputeClipRect(*layer_tree, false, false);
+  layer_tree->Preroll(frame());
+
+  DlRegion damage_region({SkIRect::MakeLTRB(0, 0, 10, 10),
+                          SkIRect::MakeLTRB(40, 0, 50, 10)});
+  layer_tree->Paint(frame(), false, &damage_region);
+
+  DisplayListBuilder expected_builder;
+  expected_builder.DrawPath(DlPath(child_path1), child_paint);
+  expected_builder.DrawPath(DlPath(child_path3), child_paint);
+  auto expected_dl = expected_builder.Build();
+
+  auto dl = display_list();
+  EXPECT_EQ(dl->op_count(true), 2u);
+  EXPECT_TRUE(DisplayListsEQ_Verbose(dl, expected_dl));
+}
+
+TEST_F(LayerTreeTest, DamageRegionOnlyCoversChangedLayers) {
+  const SkPath child_path1 = SkPath().addRect(0.0f, 0.0f, 10.0f, 10.0f);
+  const SkPath child_path2 = SkPath().addRect(20.0f, 0.0f, 30.0f, 10.0f);
+  const SkPath child_path3 = SkPath().addRect(40.0f, 0.0f, 50.0f, 10.0f);
+  const DlPaint old_paint = DlPaint(DlColor::kGreen());
+  const DlPaint new_paint = DlPaint(DlColor::kRed());
+  auto retained_layer = std::make_shared<MockLayer>(child_path2, old_paint);
+
+  auto old_layer = std::make_shared<ContainerLayer>();
+  old_layer->Add(std::make_shared<MockLayer>(child_path1, old_paint));
+  old_layer->Add(retained_layer);
+  old_layer->Add(std::make_shared<MockLayer>(child_path3, old_paint));
+  auto old_layer_tree = BuildLayerTree(old_layer);
+  FrameDamage old_frame_damage;
+  old_frame_damage.ComputeClipRect(*old_layer_tree, false, false);
+
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(std::make_shared<MockLayer>(child_path1, new_paint));
+  layer->Add(retained_layer);
+  layer->Add(std::make_shared<MockLayer>(child_path3, new_paint));
+  auto layer_tree = BuildLayerTree(layer);
+  FrameDamage frame_damage;
+  frame_damage.SetPreviousLayerTree(old_layer_tree.get());
+  auto clip_rect = frame_damage.ComputeClipRect(*layer_tree, false, false);
+  ASSERT_TRUE(clip_rect.has_value());
+  EXPECT_EQ(clip_rect.value(), SkRect::MakeLTRB(0, 0, 50, 10));
+
+  const DlRegion* damage_region = frame_damage.GetBufferDamageRegion();
+  ASSERT_NE(damage_region, nullptr);
+  std::vector<SkIRect> expected_rects = {SkIRect::MakeLTRB(0, 0, 10, 10),
+                                         SkIRect::MakeLTRB(40, 0, 50, 10)};
+  EXPECT_EQ(damage_region->getRects(), expected_rects);
+
+  layer_tree->Preroll(frame());
+  layer_tree->Paint(frame(), false, damage_region);
+  EXPECT_EQ(display_list()->op_count(true), 2u);
+}
+
 TEST_F(LayerTreeTest, PrerollContextInitialization) {
   LayerStateStack state_stack;
   state_stack.set_preroll_delegate(kGiantRect, SkMatrix::I());
@@ -266,6 +333,8 @@ TEST_F(LayerTreeTest, PaintContextInitialization) {
     EXPECT_EQ(&context.ui_time, &mock_ui_time);
     EXPECT_EQ(context.texture_registry.get(), mock_registry.get());
     EXPECT_EQ(context.raster_cache, nullptr);
+    EXPECT_EQ(context.damage_region, nullptr);
+    EXPECT_EQ(context.paint_region_map, nullptr);
   };
 
   // These 4 initializers are required because they are handled by reference
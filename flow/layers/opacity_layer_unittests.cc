@@ -5,6 +5,7 @@
 #include "flutter/flow/layers/opacity_layer.h"
 
 #include "flutter/flow/layers/clip_rect_layer.h"
+#include "flutter/flow/layers/color_filter_layer.h"
 #include "flutter/flow/layers/image_filter_layer.h"
 #include "flutter/flow/layers/layer_tree.h"
 #include "flutter/flow/layers/platform_view_layer.h"
@@ -549,8 +550,11 @@ TEST_F(OpacityLayerTest, OpacityInheritanceThroughImageFilter) {
 
   PrerollContext* context = preroll_context();
   opacity_layer->Preroll(context);
+  // The saveLayer of the image filter can also apply the color filter of
+  // an ancestor.
   EXPECT_EQ(context->renderable_state_flags,
-            LayerStateStack::kCallerCanApplyOpacity);
+            LayerStateStack::kCallerCanApplyOpacity |
+                LayerStateStack::kCallerCanApplyColorFilter);
   EXPECT_TRUE(opacity_layer->children_can_accept_opacity());
 }
 
@@ -735,6 +739,129 @@ TEST_F(OpacityLayerTest, FullyTransparentDoesNotCullPlatformView) {
   EXPECT_EQ(embedder.painted_views(), std::vector<int64_t>({view_id}));
 }
 
+static int CountSaveLayers(const sk_sp<DisplayList>& display_list) {
+  int count = 0;
+  for (DlIndex i : *display_list) {
+    if (display_list->GetOpCategory(i) == DisplayListOpCategory::kSaveLayer) {
+      count++;
+    }
+  }
+  return count;
+}
+
+TEST_F(OpacityLayerTest, OpacityInheritanceThroughGridOfChildren) {
+  // Each child overlaps the union of the children before it, but no two
+  // children overlap.
+  //   [1][2]
+  //   [3][4]
+  auto opacity_layer = std::make_shared<OpacityLayer>(128, SkPoint());
+  auto container_layer = std::make_shared<ContainerLayer>();
+  container_layer->Add(
+      MockLayer::MakeOpacityCompatible(SkPath::Rect({0, 0, 10, 10})));
+  container_layer->Add(
+      MockLayer::MakeOpacityCompatible(SkPath::Rect({10, 0, 20, 10})));
+  container_layer->Add(
+      MockLayer::MakeOpacityCompatible(SkPath::Rect({0, 10, 10, 20})));
+  container_layer->Add(
+      MockLayer::MakeOpacityCompatible(SkPath::Rect({10, 10, 20, 20})));
+  opacity_layer->Add(container_layer);
+
+  opacity_layer->Preroll(preroll_context());
+  EXPECT_TRUE(opacity_layer->children_can_accept_opacity());
+
+  opacity_layer->Paint(display_list_paint_context());
+  EXPECT_EQ(CountSaveLayers(display_list()), 0);
+}
+
+TEST_F(OpacityLayerTest, OpacityInheritanceThroughOverlappingGridOfChildren) {
+  auto opacity_layer = std::make_shared<OpacityLayer>(128, SkPoint());
+  auto container_layer = std::make_shared<ContainerLayer>();
+  container_layer->Add(
+      MockLayer::MakeOpacityCompatible(SkPath::Rect({0, 0, 10, 10})));
+  container_layer->Add(
+      MockLayer::MakeOpacityCompatible(SkPath::Rect({10, 0, 20, 10})));
+  container_layer->Add(
+      MockLayer::MakeOpacityCompatible(SkPath::Rect({0, 10, 10, 20})));
+  container_layer->Add(
+      MockLayer::MakeOpacityCompatible(SkPath::Rect({5, 5, 15, 15})));
+  opacity_layer->Add(container_layer);
+
+  opacity_layer->Preroll(preroll_context());
+  EXPECT_FALSE(opacity_layer->children_can_accept_opacity());
+
+  opacity_layer->Paint(display_list_paint_context());
+  EXPECT_EQ(CountSaveLayers(display_list()), 1);
+}
+
+TEST_F(OpacityLayerTest, OpacityInheritanceThroughMixedChildren) {
+  auto opacity_layer = std::make_shared<OpacityLayer>(128, SkPoint());
+  auto container_layer = std::make_shared<ContainerLayer>();
+  auto filter_layer = std::make_shared<ImageFilterLayer>(
+      std::make_shared<DlBlurImageFilter>(2.0, 2.0, DlTileMode::kDecal));
+  filter_layer->Add(MockLayer::Make(SkPath::Rect({30, 30, 40, 40})));
+  container_layer->Add(
+      MockLayer::MakeOpacityCompatible(SkPath::Rect({0, 0, 10, 10})));
+  container_layer->Add(filter_layer);
+  container_layer->Add(
+      MockLayer::MakeOpacityCompatible(SkPath::Rect({60, 0, 70, 10})));
+  opacity_layer->Add(container_layer);
+
+  opacity_layer->Preroll(preroll_context());
+  EXPECT_TRUE(opacity_layer->children_can_accept_opacity());
+
+  // Only the image filter needs a saveLayer, which applies the opacity.
+  opacity_layer->Paint(display_list_paint_context());
+  EXPECT_EQ(CountSaveLayers(display_list()), 1);
+}
+
+TEST_F(OpacityLayerTest, ColorFilterInheritanceThroughGridOfChildren) {
+  auto color_filter_layer = std::make_shared<ColorFilterLayer>(
+      std::make_shared<DlBlendColorFilter>(DlColor::kRed(),
+                                           DlBlendMode::kSrcIn));
+  auto container_layer = std::make_shared<ContainerLayer>();
+  for (int i = 0; i < 4; i++) {
+    SkScalar x = (i % 2) * 40;
+    SkScalar y = (i / 2) * 40;
+    auto filter_layer = std::make_shared<ImageFilterLayer>(
+        std::make_shared<DlBlurImageFilter>(2.0, 2.0, DlTileMode::kDecal));
+    filter_layer->Add(MockLayer::Make(SkPath::Rect({x, y, x + 10, y + 10})));
+    container_layer->Add(filter_layer);
+  }
+  color_filter_layer->Add(container_layer);
+
+  color_filter_layer->Preroll(preroll_context());
+  EXPECT_EQ(color_filter_layer->children_renderable_state_flags(),
+            LayerStateStack::kCallerCanApplyOpacity |
+                LayerStateStack::kCallerCanApplyColorFilter);
+
+  // The color filter is applied by the saveLayer of each image filter
+  // rather than by a saveLayer of its own.
+  color_filter_layer->Paint(display_list_paint_context());
+  EXPECT_EQ(CountSaveLayers(display_list()), 4);
+}
+
+TEST_F(OpacityLayerTest, ColorFilterThatAffectsTransparencyIsNotInherited) {
+  auto color_filter_layer = std::make_shared<ColorFilterLayer>(
+      std::make_shared<DlBlendColorFilter>(DlColor::kRed(),
+                                           DlBlendMode::kSrcOver));
+  auto container_layer = std::make_shared<ContainerLayer>();
+  for (int i = 0; i < 2; i++) {
+    SkScalar x = i * 40;
+    auto filter_layer = std::make_shared<ImageFilterLayer>(
+        std::make_shared<DlBlurImageFilter>(2.0, 2.0, DlTileMode::kDecal));
+    filter_layer->Add(MockLayer::Make(SkPath::Rect({x, 0, x + 10, 10})));
+    container_layer->Add(filter_layer);
+  }
+  color_filter_layer->Add(container_layer);
+
+  color_filter_layer->Preroll(preroll_context());
+  EXPECT_EQ(color_filter_layer->children_renderable_state_flags(),
+            LayerStateStack::kCallerCanApplyOpacity);
+
+  color_filter_layer->Paint(display_list_paint_context());
+  EXPECT_EQ(CountSaveLayers(display_list()), 3);
+}
+
 }  // namespace testing
 }  // namespace flutter
 
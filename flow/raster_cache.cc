@@ -6,7 +6,9 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <mutex>
 #include <vector>
 
 #include "flutter/common/constants.h"
@@ -14,14 +16,18 @@
 #include "flutter/flow/layers/container_layer.h"
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/paint_utils.h"
+#include "flutter/flow/raster_cache_disk_store.h"
 #include "flutter/flow/raster_cache_util.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkColorSpace.h"
 #include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkPixmap.h"
 #include "third_party/skia/include/core/SkSurface.h"
 #include "third_party/skia/include/gpu/ganesh/GrDirectContext.h"
+#include "third_party/skia/include/gpu/ganesh/SkImageGanesh.h"
 #include "third_party/skia/include/gpu/ganesh/SkSurfaceGanesh.h"
 
 namespace flutter {
@@ -71,23 +77,34 @@ void RasterCacheResult::draw(DlCanvas& canvas,
 }
 
 RasterCache::RasterCache(size_t access_threshold,
-                         size_t display_list_cache_limit_per_frame)
+                         size_t display_list_cache_limit_per_frame,
+                         size_t max_bytes)
     : access_threshold_(access_threshold),
-      display_list_cache_limit_per_frame_(display_list_cache_limit_per_frame) {}
+      display_list_cache_limit_per_frame_(display_list_cache_limit_per_frame),
+      max_bytes_(max_bytes) {}
 
-/// @note Procedure doesn't copy all closures.
-std::unique_ptr<RasterCacheResult> RasterCache::Rasterize(
+// Returns the info of the image that |context| is rasterized into.
+static SkImageInfo MakeImageInfo(const RasterCache::Context& context) {
+  auto matrix = RasterCacheUtil::GetIntegralTransCTM(context.matrix);
+  SkRect dest_rect =
+      RasterCacheUtil::GetRoundedOutDeviceBounds(context.logical_rect, matrix);
+  return SkImageInfo::MakeN32Premul(dest_rect.width(), dest_rect.height(),
+                                    context.dst_color_space);
+}
+
+// Draws |draw_function| into a new surface the size of the device bounds
+// of |context.logical_rect|, and |draw_checkerboard| over it if it is not
+// null.
+static sk_sp<SkImage> RasterizeImage(
     const RasterCache::Context& context,
-    sk_sp<const DlRTree> rtree,
     const std::function<void(DlCanvas*)>& draw_function,
-    const std::function<void(DlCanvas*, const SkRect& rect)>& draw_checkerboard)
-    const {
+    const std::function<void(DlCanvas*, const SkRect& rect)>*
+        draw_checkerboard) {
   auto matrix = RasterCacheUtil::GetIntegralTransCTM(context.matrix);
   SkRect dest_rect =
       RasterCacheUtil::GetRoundedOutDeviceBounds(context.logical_rect, matrix);
 
-  const SkImageInfo image_info = SkImageInfo::MakeN32Premul(
-      dest_rect.width(), dest_rect.height(), context.dst_color_space);
+  const SkImageInfo image_info = MakeImageInfo(context);
 
   sk_sp<SkSurface> surface =
       context.gr_context
@@ -106,13 +123,30 @@ std::unique_ptr<RasterCacheResult> RasterCache::Rasterize(
   canvas.Transform(matrix);
   draw_function(&canvas);
 
-  if (checkerboard_images_) {
-    draw_checkerboard(&canvas, context.logical_rect);
+  if (draw_checkerboard) {
+    (*draw_checkerboard)(&canvas, context.logical_rect);
   }
 
-  auto image = DlImage::Make(surface->makeImageSnapshot());
-  return std::make_unique<RasterCacheResult>(
-      image, context.logical_rect, context.flow_type, std::move(rtree));
+  return surface->makeImageSnapshot();
+}
+
+/// @note Procedure doesn't copy all closures.
+std::unique_ptr<RasterCacheResult> RasterCache::Rasterize(
+    const RasterCache::Context& context,
+    sk_sp<const DlRTree> rtree,
+    const std::function<void(DlCanvas*)>& draw_function,
+    const std::function<void(DlCanvas*, const SkRect& rect)>& draw_checkerboard)
+    const {
+  sk_sp<SkImage> image = RasterizeImage(
+      context, draw_function,
+      checkerboard_images_ ? &draw_checkerboard : nullptr);
+  if (!image) {
+    return nullptr;
+  }
+  return std::make_unique<RasterCacheResult>(DlImage::Make(image),
+                                             context.logical_rect,
+                                             context.flow_type,
+                                             std::move(rtree));
 }
 
 bool RasterCache::UpdateCacheEntry(
@@ -122,11 +156,15 @@ bool RasterCache::UpdateCacheEntry(
     sk_sp<const DlRTree> rtree) const {
   RasterCacheKey key = RasterCacheKey(id, raster_cache_context.matrix);
   Entry& entry = cache_[key];
-  if (!entry.image) {
+  if (!entry.image && !entry.rasterizing_async) {
     void (*func)(DlCanvas*, const SkRect& rect) = DrawCheckerboard;
+    fml::TimePoint start = fml::TimePoint::Now();
     entry.image = Rasterize(raster_cache_context, std::move(rtree),
                             render_function, func);
     if (entry.image != nullptr) {
+      entry.rasterize_time = fml::TimePoint::Now() - start;
+      UpdatePriority(entry);
+      GetMetricsForKind(key.kind()).miss_count++;
       switch (id.type()) {
         case RasterCacheKeyType::kDisplayList: {
           display_list_cached_this_frame_++;
@@ -141,19 +179,151 @@ bool RasterCache::UpdateCacheEntry(
   return entry.image != nullptr;
 }
 
-RasterCache::CacheInfo RasterCache::MarkSeen(const RasterCacheKeyID& id,
-                                             const SkMatrix& matrix,
-                                             bool visible) const {
+RasterCache::CacheInfo RasterCache::MarkSeen(
+    const RasterCacheKeyID& id,
+    const SkMatrix& matrix,
+    bool visible,
+    const AsyncRequest* async_request) const {
   RasterCacheKey key = RasterCacheKey(id, matrix);
   Entry& entry = cache_[key];
+  if (!entry.encountered_this_frame) {
+    entry.frames_used++;
+    entry.previous_used_frame = entry.last_used_frame;
+    entry.last_used_frame = frame_count_;
+    if (entry.image) {
+      UpdatePriority(entry);
+    }
+  }
   entry.encountered_this_frame = true;
   entry.visible_this_frame = visible;
   if (visible || entry.accesses_since_visible > 0) {
     entry.accesses_since_visible++;
   }
+  if (async_request && async_worker_ && visible && !entry.image &&
+      !entry.rasterizing_async &&
+      entry.accesses_since_visible > access_threshold_ &&
+      GenerateNewCacheInThisFrame() &&
+      async_request->display_list->isUIThreadSafe()) {
+    entry.rasterizing_async = true;
+    display_list_cached_this_frame_++;
+    async_worker_->PostTask(
+        [key, display_list = async_request->display_list,
+         dst_color_space = async_request->dst_color_space,
+         matrix = async_request->matrix,
+         logical_rect = async_request->logical_rect,
+         flow_type = async_request->flow_type,
+         checkerboard = checkerboard_images_,
+         resource_context = async_resource_context_,
+         disk_store = disk_store_,
+         results = async_results_]() {
+          TRACE_EVENT0("flutter", "RasterCache::RasterizeAsync");
+          RasterCache::Context context = {
+              // clang-format off
+              .gr_context         = nullptr,
+              .dst_color_space    = dst_color_space,
+              .matrix             = matrix,
+              .logical_rect       = logical_rect,
+              .flow_type          = flow_type,
+              // clang-format on
+          };
+          std::function<void(DlCanvas*, const SkRect& rect)> draw_checkerboard =
+              DrawCheckerboard;
+          fml::TimePoint start = fml::TimePoint::Now();
+          sk_sp<SkImage> image;
+          std::string disk_key;
+          if (disk_store && !checkerboard) {
+            disk_key = RasterCacheDiskStore::ComputeKey(
+                *display_list, matrix, dst_color_space.get());
+            if (!disk_key.empty()) {
+              image = disk_store->Load(disk_key, MakeImageInfo(context));
+            }
+          }
+          SkPixmap pixmap;
+          if (!image) {
+            image = RasterizeImage(
+                context,
+                [&display_list](DlCanvas* canvas) {
+                  canvas->DrawDisplayList(display_list);
+                },
+                checkerboard ? &draw_checkerboard : nullptr);
+            if (image && !disk_key.empty() && image->peekPixels(&pixmap)) {
+              disk_store->Store(disk_key, pixmap);
+            }
+          }
+          if (image && resource_context && image->peekPixels(&pixmap)) {
+            // Upload on the worker too so that the raster thread does not
+            // have to upload the image the first time it is drawn.
+            sk_sp<SkImage> texture_image =
+                SkImages::CrossContextTextureFromPixmap(
+                    resource_context.get(),  // context
+                    pixmap,                  // pixmap
+                    false,                   // buildMips
+                    true                     // limitToMaxTextureSize
+                );
+            if (texture_image) {
+              image = std::move(texture_image);
+            }
+          }
+          fml::TimeDelta rasterize_time = fml::TimePoint::Now() - start;
+          std::unique_ptr<RasterCacheResult> result;
+          if (image) {
+            result = std::make_unique<RasterCacheResult>(
+                DlImage::Make(std::move(image)), logical_rect, flow_type,
+                display_list->rtree());
+          }
+          std::scoped_lock lock(results->mutex);
+          results->completed.push_back(
+              {key, std::move(result), rasterize_time});
+        });
+  }
   return {entry.accesses_since_visible, entry.image != nullptr};
 }
 
+void RasterCache::EnableAsyncPopulation(
+    fml::RefPtr<fml::TaskRunner> worker,
+    fml::WeakPtr<GrDirectContext> resource_context) {
+  async_worker_ = std::move(worker);
+  async_resource_context_ = std::move(resource_context);
+  if (!async_results_) {
+    async_results_ = std::make_shared<AsyncResults>();
+  }
+}
+
+void RasterCache::EnableDiskStore(
+    std::shared_ptr<RasterCacheDiskStore> disk_store) {
+  FML_DCHECK(async_worker_);
+  if (!async_worker_) {
+    return;
+  }
+  disk_store_ = std::move(disk_store);
+}
+
+void RasterCache::CollectAsyncResults() {
+  if (!async_results_) {
+    return;
+  }
+  std::vector<AsyncResults::Result> completed;
+  {
+    std::scoped_lock lock(async_results_->mutex);
+    completed.swap(async_results_->completed);
+  }
+  for (AsyncResults::Result& result : completed) {
+    auto it = cache_.find(result.key);
+    if (it == cache_.end()) {
+      // The entry was evicted while the worker was rasterizing it.
+      continue;
+    }
+    Entry& entry = it->second;
+    entry.rasterizing_async = false;
+    if (!entry.image && result.image) {
+      entry.image = std::move(result.image);
+      entry.rasterize_time = result.rasterize_time;
+      UpdatePriority(entry);
+      GetMetricsForKind(result.key.kind()).miss_count++;
+    }
+  }
+}
+
 int RasterCache::GetAccessCount(const RasterCacheKeyID& id,
                                 const SkMatrix& matrix) const {
   RasterCacheKey key = RasterCacheKey(id, matrix);
@@ -173,6 +343,13 @@ bool RasterCache::HasEntry(const RasterCacheKeyID& id,
   return false;
 }
 
+bool RasterCache::HasImage(const RasterCacheKeyID& id,
+                           const SkMatrix& matrix) const {
+  RasterCacheKey key = RasterCacheKey(id, matrix);
+  auto entry = cache_.find(key);
+  return entry != cache_.cend() && entry->second.image;
+}
+
 bool RasterCache::Draw(const RasterCacheKeyID& id,
                        DlCanvas& canvas,
                        const DlPaint* paint,
@@ -186,6 +363,7 @@ bool RasterCache::Draw(const RasterCacheKeyID& id,
 
   if (entry.image) {
     entry.image->draw(canvas, paint, preserve_rtree);
+    GetMetricsForKind(it->first.kind()).hit_count++;
     return true;
   }
 
@@ -193,30 +371,69 @@ bool RasterCache::Draw(const RasterCacheKeyID& id,
 }
 
 void RasterCache::BeginFrame() {
+  frame_count_++;
   display_list_cached_this_frame_ = 0;
   picture_metrics_ = {};
   layer_metrics_ = {};
+  CollectAsyncResults();
 }
 
 void RasterCache::UpdateMetrics() {
   for (auto it = cache_.begin(); it != cache_.end(); ++it) {
     Entry& entry = it->second;
-    FML_DCHECK(entry.encountered_this_frame);
+    FML_DCHECK(entry.encountered_this_frame || (max_bytes_ > 0 && entry.image));
     if (entry.image) {
       RasterCacheMetrics& metrics = GetMetricsForKind(it->first.kind());
-      metrics.in_use_count++;
-      metrics.in_use_bytes += entry.image->image_bytes();
+      if (entry.encountered_this_frame) {
+        metrics.in_use_count++;
+        metrics.in_use_bytes += entry.image->image_bytes();
+      } else {
+        metrics.retained_count++;
+        metrics.retained_bytes += entry.image->image_bytes();
+      }
     }
     entry.encountered_this_frame = false;
   }
 }
 
+void RasterCache::UpdatePriority(Entry& entry) const {
+  double bytes = std::max<int64_t>(entry.image->image_bytes(), 1);
+  double cost = entry.rasterize_time.ToMicrosecondsF();
+  entry.priority = eviction_clock_ + entry.frames_used * cost / bytes;
+}
+
 void RasterCache::EvictUnusedCacheEntries() {
   std::vector<RasterCacheKey::Map<Entry>::iterator> dead;
+  std::vector<RasterCacheKey::Map<Entry>::iterator> unused;
+  size_t total_bytes = 0;
 
   for (auto it = cache_.begin(); it != cache_.end(); ++it) {
     Entry& entry = it->second;
+    if (entry.image) {
+      total_bytes += entry.image->image_bytes();
+    }
     if (!entry.encountered_this_frame) {
+      if (max_bytes_ > 0 && entry.image) {
+        unused.push_back(it);
+      } else {
+        dead.push_back(it);
+      }
+    }
+  }
+
+  if (total_bytes > max_bytes_ && !unused.empty()) {
+    std::sort(unused.begin(), unused.end(), [](auto a, auto b) {
+      if (a->second.priority != b->second.priority) {
+        return a->second.priority < b->second.priority;
+      }
+      return a->second.previous_used_frame < b->second.previous_used_frame;
+    });
+    for (auto it : unused) {
+      if (total_bytes <= max_bytes_) {
+        break;
+      }
+      total_bytes -= it->second.image->image_bytes();
+      eviction_clock_ = std::max(eviction_clock_, it->second.priority);
       dead.push_back(it);
     }
   }
@@ -238,6 +455,7 @@ void RasterCache::EndFrame() {
 
 void RasterCache::Clear() {
   cache_.clear();
+  eviction_clock_ = 0.0;
   picture_metrics_ = {};
   layer_metrics_ = {};
 }
@@ -276,6 +494,19 @@ void RasterCache::TraceStatsToTimeline() const {
       "PictureCount", picture_metrics_.total_count(),                      //
       "PictureMBytes", picture_metrics_.total_bytes() / kMegaByteSizeInBytes);
 
+  size_t hits = layer_metrics_.hit_count + picture_metrics_.hit_count;
+  size_t misses = layer_metrics_.miss_count + picture_metrics_.miss_count;
+  size_t evictions =
+      layer_metrics_.eviction_count + picture_metrics_.eviction_count;
+  size_t retained_bytes =
+      layer_metrics_.retained_bytes + picture_metrics_.retained_bytes;
+  FML_TRACE_COUNTER(
+      "flutter",                                                 //
+      "RasterCacheEfficiency", reinterpret_cast<int64_t>(this),  //
+      "Hits", hits,                                              //
+      "Misses", misses,                                          //
+      "Evictions", evictions,                                    //
+      "RetainedMBytes", retained_bytes / kMegaByteSizeInBytes);
 #endif  // !FLUTTER_RELEASE
 }
 
@@ -301,7 +532,8 @@ size_t RasterCache::EstimatePictureCacheByteSize() const {
   return picture_cache_bytes;
 }
 
-RasterCacheMetrics& RasterCache::GetMetricsForKind(RasterCacheKeyKind kind) {
+RasterCacheMetrics& RasterCache::GetMetricsForKind(
+    RasterCacheKeyKind kind) const {
   switch (kind) {
     case RasterCacheKeyKind::kDisplayListMetrics:
       return picture_metrics_;
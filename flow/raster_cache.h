@@ -8,13 +8,18 @@
 #if !SLIMPELLER
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
+#include "flutter/display_list/display_list.h"
 #include "flutter/display_list/dl_canvas.h"
 #include "flutter/flow/raster_cache_key.h"
 #include "flutter/flow/raster_cache_util.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/task_runner.h"
+#include "flutter/fml/time/time_delta.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkMatrix.h"
 #include "third_party/skia/include/core/SkRect.h"
@@ -55,6 +60,7 @@ class RasterCacheResult {
 };
 
 class Layer;
+class RasterCacheDiskStore;
 class RasterCacheItem;
 struct PrerollContext;
 struct PaintContext;
@@ -80,15 +86,36 @@ struct RasterCacheMetrics {
    */
   size_t in_use_bytes = 0;
 
+  /**
+   * The number of cache entries with images that were not used in this frame
+   * but were kept within the byte budget of the cache.
+   */
+  size_t retained_count = 0;
+
+  /**
+   * The size of all of the images kept but not used in this frame.
+   */
+  size_t retained_bytes = 0;
+
+  /**
+   * The number of cached images drawn in this frame.
+   */
+  size_t hit_count = 0;
+
+  /**
+   * The number of entries rasterized into new images in this frame.
+   */
+  size_t miss_count = 0;
+
   /**
    * The total cache entries that had images during this frame.
    */
-  size_t total_count() const { return in_use_count; }
+  size_t total_count() const { return in_use_count + retained_count; }
 
   /**
    * The size of all of the cached images during this frame.
    */
-  size_t total_bytes() const { return in_use_bytes; }
+  size_t total_bytes() const { return in_use_bytes + retained_bytes; }
 };
 
 /**
@@ -106,9 +133,12 @@ struct RasterCacheMetrics {
  *         encountered by the current frame.
  * - Paint stage
  *   - RasterCache::EvictUnusedCacheEntries
- *       Evict cached images that are no longer used.
+ *       Evict cached images that are no longer used. If the cache has a byte
+ *       budget, images that were not used in this frame are kept as long as
+ *       all of the cached images fit in the budget, see |SetMaxBytes|.
  *   - LayerTree::TryToPrepareRasterCache
- *       Create cache image for each cache entry if it does not exist.
+ *       Create cache image for each cache entry if it does not exist and is
+ *       not being rasterized by the worker.
  *   - LayerTree::Paint - for each layer in the tree:
  *       If layers or display lists are cached as cached images, the method
  *       `RasterCache::Draw` will be used to draw those cache images.
@@ -128,6 +158,14 @@ class RasterCache {
     const size_t accesses_since_visible;
     const bool has_image;
   };
+  // What the worker needs to rasterize a display list entry off the frame.
+  struct AsyncRequest {
+    const sk_sp<DisplayList>& display_list;
+    const sk_sp<SkColorSpace>& dst_color_space;
+    const SkMatrix& matrix;
+    const SkRect& logical_rect;
+    const char* flow_type;
+  };
 
   std::unique_ptr<RasterCacheResult> Rasterize(
       const RasterCache::Context& context,
@@ -139,10 +177,63 @@ class RasterCache {
   explicit RasterCache(
       size_t access_threshold = 3,
       size_t picture_and_display_list_cache_limit_per_frame =
-          RasterCacheUtil::kDefaultPictureAndDisplayListCacheLimitPerFrame);
+          RasterCacheUtil::kDefaultPictureAndDisplayListCacheLimitPerFrame,
+      size_t max_bytes = 0);
 
   virtual ~RasterCache() = default;
 
+  /**
+   * @brief Sets the number of bytes of images, counting the entries used in
+   * the current frame, above which the cache evicts entries that were not
+   * used in the current frame.
+   *
+   * With the default of 0 an entry is evicted on the first frame that does
+   * not use it. Otherwise unused entries are kept, so that layers which are
+   * hidden for a few frames do not have to be rasterized again when they
+   * reappear, and when the images of all of the entries exceed |max_bytes|
+   * the unused entries are evicted in order of their Greedy-Dual-Size-
+   * Frequency priority:
+   *
+   *   priority = clock + frames_used * rasterization_time / image_bytes
+   *
+   * where |clock| is the priority of the last entry evicted, so entries that
+   * have not been used for a while age relative to newer ones. Ties are
+   * broken by evicting the entry whose second to last use is the oldest
+   * (LRU-2). Entries used in the current frame are never evicted.
+   */
+  void SetMaxBytes(size_t max_bytes) { max_bytes_ = max_bytes; }
+  size_t max_bytes() const { return max_bytes_; }
+
+  /**
+   * @brief Rasterizes display list entries on |worker| instead of in the
+   * frame that first qualifies them for caching.
+   *
+   * Once enabled, |MarkSeen| hands display lists that qualify for caching to
+   * |worker|, which draws them into a CPU surface and, if |resource_context|
+   * is still alive, uploads the result as a cross context texture. Frames
+   * keep drawing the display list without the cache until a frame begins
+   * after the worker has finished. Layer entries and display lists with
+   * images that may only be used on the raster thread are still rasterized
+   * synchronously.
+   *
+   * |resource_context| is only dereferenced on |worker|, so it should be the
+   * context of the IO thread and |worker| the IO task runner.
+   */
+  void EnableAsyncPopulation(fml::RefPtr<fml::TaskRunner> worker,
+                             fml::WeakPtr<GrDirectContext> resource_context);
+  bool async_population_enabled() const { return async_worker_ != nullptr; }
+
+  /**
+   * @brief Keeps the images of display list entries in |disk_store| so that
+   * they survive the process.
+   *
+   * The store is only used on the worker of the asynchronous population,
+   * which must have been enabled first, and its index must have been
+   * loaded. Entries that the worker is given are looked up in the store
+   * before they are rasterized, and stored after they are rasterized.
+   */
+  void EnableDiskStore(std::shared_ptr<RasterCacheDiskStore> disk_store);
+
   // Draws this item if it should be rendered from the cache and returns
   // true iff it was successfully drawn. Typically this should only fail
   // if the item was disabled due to conditions discovered during |Preroll|
@@ -160,6 +251,9 @@ class RasterCache {
 
   bool HasEntry(const RasterCacheKeyID& id, const SkMatrix&) const;
 
+  // Whether the entry exists and has been rasterized.
+  bool HasImage(const RasterCacheKeyID& id, const SkMatrix&) const;
+
   void BeginFrame();
 
   void EvictUnusedCacheEntries();
@@ -228,12 +322,15 @@ class RasterCache {
    * as visible in the current frame if the caller determines that it
    * intersects the cull rect. The access_count of the entry will be
    * increased if it is visible, or if it was ever visible.
+   * If asynchronous population is enabled and an |async_request| is given,
+   * an entry that has become eligible for caching is sent to the worker.
    * @return the number of times the entry has been hit since it was created.
    * For a new entry that will be 1 if it is visible, or zero if non-visible.
    */
   CacheInfo MarkSeen(const RasterCacheKeyID& id,
                      const SkMatrix& matrix,
-                     bool visible) const;
+                     bool visible,
+                     const AsyncRequest* async_request = nullptr) const;
 
   /**
    * Returns the access count (i.e. accesses_since_visible) for the given
@@ -252,19 +349,53 @@ class RasterCache {
     bool visible_this_frame = false;
     size_t accesses_since_visible = 0;
     std::unique_ptr<RasterCacheResult> image;
+    // Whether the worker is rasterizing the image of this entry.
+    bool rasterizing_async = false;
+
+    // The state used to choose which unused entries to evict when the cache
+    // is over its byte budget.
+    size_t frames_used = 0;
+    size_t last_used_frame = 0;
+    size_t previous_used_frame = 0;
+    fml::TimeDelta rasterize_time;
+    double priority = 0.0;
+  };
+
+  // The images rasterized by the worker that the raster thread has not
+  // yet moved into the cache. The worker tasks share ownership of this so
+  // that they can finish after the cache is destroyed.
+  struct AsyncResults {
+    struct Result {
+      RasterCacheKey key;
+      std::unique_ptr<RasterCacheResult> image;
+      fml::TimeDelta rasterize_time;
+    };
+    std::mutex mutex;
+    std::vector<Result> completed;
   };
 
   void UpdateMetrics();
 
-  RasterCacheMetrics& GetMetricsForKind(RasterCacheKeyKind kind);
+  void CollectAsyncResults();
+
+  void UpdatePriority(Entry& entry) const;
+
+  RasterCacheMetrics& GetMetricsForKind(RasterCacheKeyKind kind) const;
 
   const size_t access_threshold_;
   const size_t display_list_cache_limit_per_frame_;
+  size_t max_bytes_;
   mutable size_t display_list_cached_this_frame_ = 0;
-  RasterCacheMetrics layer_metrics_;
-  RasterCacheMetrics picture_metrics_;
+  mutable RasterCacheMetrics layer_metrics_;
+  mutable RasterCacheMetrics picture_metrics_;
   mutable RasterCacheKey::Map<Entry> cache_;
+  size_t frame_count_ = 0;
+  double eviction_clock_ = 0.0;
   bool checkerboard_images_ = false;
+  fml::RefPtr<fml::TaskRunner> async_worker_;
+  fml::WeakPtr<GrDirectContext> async_resource_context_;
+  std::shared_ptr<AsyncResults> async_results_;
+  std::shared_ptr<RasterCacheDiskStore> disk_store_;
 
   void TraceStatsToTimeline() const;
 
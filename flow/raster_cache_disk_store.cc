@@ -0,0 +1,372 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#if !SLIMPELLER
+
+#include "flutter/flow/raster_cache_disk_store.h"
+
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "flutter/common/graphics/persistent_cache.h"
+#include "flutter/display_list/dl_serializer.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/hex_codec.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/trace_event.h"
+#include "openssl/sha.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
+#include "third_party/skia/include/core/SkData.h"
+
+namespace flutter {
+
+namespace {
+
+// The headers are written to disk as they are, so they spell out their
+// padding to not write uninitialized bytes.
+struct EntryHeader {
+  uint32_t magic = RasterCacheDiskStore::kMagic;
+  uint32_t version = RasterCacheDiskStore::kVersion;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t color_type = 0;
+  uint32_t alpha_type = 0;
+  uint64_t row_bytes = 0;
+};
+static_assert(sizeof(EntryHeader) == 32u);
+
+struct IndexHeader {
+  uint32_t magic = RasterCacheDiskStore::kMagic;
+  uint32_t version = RasterCacheDiskStore::kVersion;
+  uint64_t count = 0;
+};
+static_assert(sizeof(IndexHeader) == 16u);
+
+// Each record of the index is followed by |key_size| bytes of the key.
+struct IndexRecord {
+  uint64_t bytes = 0;
+  uint32_t key_size = 0;
+  uint32_t reserved = 0;
+};
+static_assert(sizeof(IndexRecord) == 16u);
+
+// Keys are used as file names, so only the keys |ComputeKey| returns are
+// accepted, which are lowercase hex encoded SHA-256 digests.
+bool IsValidKey(std::string_view key) {
+  if (key.size() != SHA256_DIGEST_LENGTH * 2) {
+    return false;
+  }
+  for (char c : key) {
+    if (!(c >= '0' && c <= '9') && !(c >= 'a' && c <= 'f')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+std::mutex RasterCacheDiskStore::instance_mutex_;
+std::shared_ptr<RasterCacheDiskStore> RasterCacheDiskStore::instance_;
+
+RasterCacheDiskStore::RasterCacheDiskStore(
+    std::shared_ptr<fml::UniqueFD> directory,
+    size_t max_bytes,
+    bool read_only)
+    : directory_(std::move(directory)),
+      max_bytes_(max_bytes),
+      read_only_(read_only) {}
+
+RasterCacheDiskStore::~RasterCacheDiskStore() = default;
+
+// static
+std::shared_ptr<RasterCacheDiskStore> RasterCacheDiskStore::GetStoreForProcess(
+    size_t max_bytes) {
+  std::scoped_lock lock(instance_mutex_);
+  if (!instance_) {
+    PersistentCache* persistent_cache = PersistentCache::GetCacheForProcess();
+    instance_ = std::make_shared<RasterCacheDiskStore>(
+        persistent_cache->GetRasterCacheDirectory(), max_bytes,
+        persistent_cache->IsReadOnly());
+    instance_->LoadIndex();
+  }
+  return instance_;
+}
+
+std::string RasterCacheDiskStore::ComputeKey(const DisplayList& display_list,
+                                             const SkMatrix& matrix,
+                                             const SkColorSpace* color_space) {
+  std::unique_ptr<fml::Mapping> serialized =
+      DlSerializer::Serialize(display_list);
+  if (!serialized) {
+    return "";
+  }
+
+  SHA256_CTX sha;
+  SHA256_Init(&sha);
+  SHA256_Update(&sha, serialized->GetMapping(), serialized->GetSize());
+  const int kMatrixIndices[] = {
+      SkMatrix::kMScaleX, SkMatrix::kMSkewX,  SkMatrix::kMSkewY,
+      SkMatrix::kMScaleY, SkMatrix::kMPersp0, SkMatrix::kMPersp1,
+      SkMatrix::kMPersp2,
+  };
+  for (int index : kMatrixIndices) {
+    SkScalar value = matrix[index];
+    SHA256_Update(&sha, &value, sizeof(value));
+  }
+  if (color_space) {
+    sk_sp<SkData> color_space_data = color_space->serialize();
+    SHA256_Update(&sha, color_space_data->data(), color_space_data->size());
+  }
+
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256_Final(digest, &sha);
+  return fml::HexEncode(std::string_view(reinterpret_cast<const char*>(digest),
+                                         SHA256_DIGEST_LENGTH));
+}
+
+void RasterCacheDiskStore::LoadIndex() {
+  TRACE_EVENT0("flutter", "RasterCacheDiskStore::LoadIndex");
+  std::scoped_lock lock(mutex_);
+  lru_.clear();
+  index_.clear();
+  total_bytes_ = 0;
+  if (!directory_ || !directory_->is_valid()) {
+    return;
+  }
+
+  fml::UniqueFD index_file = fml::OpenFileReadOnly(*directory_, kIndexFileName);
+  if (index_file.is_valid()) {
+    fml::FileMapping mapping(index_file);
+    const uint8_t* data = mapping.GetMapping();
+    size_t size = mapping.GetSize();
+    IndexHeader header;
+    if (data && size >= sizeof(header)) {
+      memcpy(&header, data, sizeof(header));
+    }
+    if (!data || size < sizeof(header) || header.magic != kMagic ||
+        header.version != kVersion) {
+      FML_LOG(INFO) << "Raster cache disk index is corrupt.";
+    } else {
+      size_t offset = sizeof(header);
+      for (uint64_t i = 0; i < header.count; i++) {
+        IndexRecord record;
+        if (size - offset < sizeof(record)) {
+          break;
+        }
+        memcpy(&record, data + offset, sizeof(record));
+        offset += sizeof(record);
+        if (size - offset < record.key_size) {
+          break;
+        }
+        std::string key(reinterpret_cast<const char*>(data + offset),
+                        record.key_size);
+        offset += record.key_size;
+        if (!IsValidKey(key) || index_.find(key) != index_.end()) {
+          continue;
+        }
+        fml::UniqueFD file = fml::OpenFileReadOnly(*directory_, key.c_str());
+        if (!file.is_valid() ||
+            fml::FileMapping(file).GetSize() != record.bytes) {
+          continue;
+        }
+        lru_.push_back({key, static_cast<size_t>(record.bytes)});
+        index_[key] = std::prev(lru_.end());
+        total_bytes_ += record.bytes;
+      }
+    }
+  }
+
+  if (read_only_) {
+    // Entries over the budget are only dropped from the index in memory.
+    Purge();
+    return;
+  }
+
+  // Delete the files that the index does not know about, such as files
+  // written by a store that did not get to write its index.
+  std::vector<std::string> orphans;
+  fml::VisitFiles(*directory_, [this, &orphans](const fml::UniqueFD& directory,
+                                                const std::string& filename) {
+    if (filename != kIndexFileName && index_.find(filename) == index_.end()) {
+      orphans.push_back(filename);
+    }
+    return true;
+  });
+  for (const std::string& orphan : orphans) {
+    fml::UnlinkFile(*directory_, orphan.c_str());
+  }
+
+  size_t count = lru_.size();
+  Purge();
+  if (!orphans.empty() || lru_.size() != count) {
+    WriteIndex();
+  }
+}
+
+sk_sp<SkImage> RasterCacheDiskStore::Load(const std::string& key,
+                                          const SkImageInfo& info) {
+  TRACE_EVENT0("flutter", "RasterCacheDiskStore::Load");
+  std::scoped_lock lock(mutex_);
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    return nullptr;
+  }
+
+  fml::UniqueFD file = fml::OpenFileReadOnly(*directory_, key.c_str());
+  std::unique_ptr<fml::FileMapping> mapping;
+  if (file.is_valid()) {
+    mapping = std::make_unique<fml::FileMapping>(file);
+  }
+  EntryHeader header;
+  if (!mapping || !mapping->GetMapping() ||
+      mapping->GetSize() < sizeof(header)) {
+    Remove(found->second);
+    WriteIndex();
+    return nullptr;
+  }
+  memcpy(&header, mapping->GetMapping(), sizeof(header));
+  // The size of the pixels is only computed once it is known not to
+  // overflow.
+  size_t max_pixel_bytes = mapping->GetSize() - sizeof(header);
+  bool pixel_bytes_fit =
+      header.height == 0 || header.row_bytes <= max_pixel_bytes / header.height;
+  uint64_t pixel_bytes = pixel_bytes_fit ? header.row_bytes * header.height : 0;
+  if (header.magic != kMagic || header.version != kVersion ||
+      !pixel_bytes_fit || max_pixel_bytes != pixel_bytes) {
+    FML_LOG(INFO) << "Raster cache disk entry is corrupt: " << key;
+    Remove(found->second);
+    WriteIndex();
+    return nullptr;
+  }
+  if (header.width != static_cast<uint32_t>(info.width()) ||
+      header.height != static_cast<uint32_t>(info.height()) ||
+      header.color_type != static_cast<uint32_t>(info.colorType()) ||
+      header.alpha_type != static_cast<uint32_t>(info.alphaType()) ||
+      header.row_bytes < info.minRowBytes()) {
+    // The caller will store the image it rasterizes instead.
+    return nullptr;
+  }
+
+  sk_sp<SkData> pixels = SkData::MakeWithCopy(
+      mapping->GetMapping() + sizeof(header), pixel_bytes);
+  sk_sp<SkImage> image =
+      SkImages::RasterFromData(info, std::move(pixels), header.row_bytes);
+  if (image) {
+    Touch(found->second);
+    WriteIndex();
+  }
+  return image;
+}
+
+bool RasterCacheDiskStore::Store(const std::string& key,
+                                 const SkPixmap& pixmap) {
+  TRACE_EVENT0("flutter", "RasterCacheDiskStore::Store");
+  if (read_only_ || !IsValidKey(key) || !directory_ ||
+      !directory_->is_valid() || !pixmap.addr()) {
+    return false;
+  }
+  std::scoped_lock lock(mutex_);
+  // The rows are stored without padding.
+  size_t row_bytes = pixmap.info().minRowBytes();
+  size_t bytes = sizeof(EntryHeader) + row_bytes * pixmap.height();
+  if (bytes > max_bytes_) {
+    return false;
+  }
+
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    Remove(found->second);
+  }
+
+  std::vector<uint8_t> data(bytes);
+  EntryHeader header;
+  header.width = pixmap.width();
+  header.height = pixmap.height();
+  header.color_type = pixmap.colorType();
+  header.alpha_type = pixmap.alphaType();
+  header.row_bytes = row_bytes;
+  memcpy(data.data(), &header, sizeof(header));
+  for (int y = 0; y < pixmap.height(); y++) {
+    memcpy(data.data() + sizeof(header) + y * row_bytes, pixmap.addr(0, y),
+           row_bytes);
+  }
+  fml::DataMapping mapping(std::move(data));
+  if (!fml::WriteAtomically(*directory_, key.c_str(), mapping)) {
+    FML_LOG(WARNING) << "Could not write raster cache entry to disk.";
+    WriteIndex();
+    return false;
+  }
+
+  lru_.push_back({key, bytes});
+  index_[key] = std::prev(lru_.end());
+  total_bytes_ += bytes;
+  Purge();
+  WriteIndex();
+  return true;
+}
+
+size_t RasterCacheDiskStore::entry_count() const {
+  std::scoped_lock lock(mutex_);
+  return index_.size();
+}
+
+size_t RasterCacheDiskStore::total_bytes() const {
+  std::scoped_lock lock(mutex_);
+  return total_bytes_;
+}
+
+void RasterCacheDiskStore::Touch(std::list<Entry>::iterator it) {
+  lru_.splice(lru_.end(), lru_, it);
+}
+
+void RasterCacheDiskStore::Remove(std::list<Entry>::iterator it) {
+  if (!read_only_) {
+    fml::UnlinkFile(*directory_, it->key.c_str());
+  }
+  total_bytes_ -= it->bytes;
+  index_.erase(it->key);
+  lru_.erase(it);
+}
+
+void RasterCacheDiskStore::Purge() {
+  while (total_bytes_ > max_bytes_ && !lru_.empty()) {
+    Remove(lru_.begin());
+  }
+}
+
+void RasterCacheDiskStore::WriteIndex() {
+  if (read_only_) {
+    return;
+  }
+  size_t size = sizeof(IndexHeader);
+  for (const Entry& entry : lru_) {
+    size += sizeof(IndexRecord) + entry.key.size();
+  }
+  std::vector<uint8_t> data(size);
+  IndexHeader header;
+  header.count = lru_.size();
+  memcpy(data.data(), &header, sizeof(header));
+  size_t offset = sizeof(header);
+  for (const Entry& entry : lru_) {
+    IndexRecord record;
+    record.bytes = entry.bytes;
+    record.key_size = entry.key.size();
+    memcpy(data.data() + offset, &record, sizeof(record));
+    offset += sizeof(record);
+    memcpy(data.data() + offset, entry.key.data(), entry.key.size());
+    offset += entry.key.size();
+  }
+  fml::DataMapping mapping(std::move(data));
+  if (!fml::WriteAtomically(*directory_, kIndexFileName, mapping)) {
+    FML_LOG(WARNING) << "Could not write raster cache index to disk.";
+  }
+}
+
+}  // namespace flutter
+
+#endif  //  !SLIMPELLER
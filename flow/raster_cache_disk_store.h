@@ -0,0 +1,135 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_RASTER_CACHE_DISK_STORE_H_
+#define FLUTTER_FLOW_RASTER_CACHE_DISK_STORE_H_
+
+#if !SLIMPELLER
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "flutter/display_list/display_list.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/unique_fd.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+
+class SkColorSpace;
+
+namespace flutter {
+
+/// A store of rasterized DisplayLists on disk, so that the raster cache
+/// entries of static pictures such as logos and vector illustrations do not
+/// have to be rasterized again on the next launch of the application.
+///
+/// Entries are keyed by a hash of the serialized contents of the
+/// DisplayList together with the scale and skew of the matrix and the color
+/// space it is rasterized for, so only DisplayLists that |DlSerializer| can
+/// serialize are stored. Each entry is a file holding a small header and the
+/// raw pixels. An index file records the entries from least to most
+/// recently used. When the files exceed the byte budget, the least recently
+/// used entries are deleted. The index is rewritten whenever the order
+/// changes, which happens at most once per entry and launch as the raster
+/// cache keeps the images it loads in memory.
+///
+/// The store does blocking file IO, so it should only be used from worker
+/// task runners. It is thread-safe. |LoadIndex| must be called before any
+/// of the other methods. A read-only store never modifies the directory.
+///
+/// The engines of a process share the store returned by |GetStoreForProcess|,
+/// as separate stores over the same directory would delete each other's
+/// entries and overwrite each other's index.
+class RasterCacheDiskStore {
+ public:
+  // The first 4 bytes of every entry file, "RCDS".
+  static constexpr uint32_t kMagic = 0x53444352u;
+
+  // Incremented whenever the format of the entry or index files changes.
+  static constexpr uint32_t kVersion = 1u;
+
+  static constexpr char kIndexFileName[] = "index";
+
+  RasterCacheDiskStore(std::shared_ptr<fml::UniqueFD> directory,
+                       size_t max_bytes,
+                       bool read_only = false);
+
+  ~RasterCacheDiskStore();
+
+  /// Returns the store of the process, which keeps its entries in the
+  /// raster cache directory of |PersistentCache::GetCacheForProcess| and is
+  /// read-only if that cache is. The first call creates the store with a
+  /// budget of |max_bytes| and loads its index, so it does blocking file IO
+  /// and should be made on a worker task runner.
+  static std::shared_ptr<RasterCacheDiskStore> GetStoreForProcess(
+      size_t max_bytes);
+
+  /// Returns the name of the entry of |display_list| rasterized with
+  /// |matrix| into |color_space|, or an empty string if the DisplayList
+  /// cannot be serialized. The translation of |matrix| is ignored, as it is
+  /// by |RasterCacheKey|.
+  static std::string ComputeKey(const DisplayList& display_list,
+                                const SkMatrix& matrix,
+                                const SkColorSpace* color_space);
+
+  /// Reads the index and checks it against the files in the directory.
+  /// Files that are not in the index, and entries of the index whose keys
+  /// are not ones |ComputeKey| returns or whose files are missing or have
+  /// the wrong size, are deleted.
+  void LoadIndex();
+
+  /// Returns the image of the entry with |key| if there is one whose pixels
+  /// match |info|, and marks the entry as the most recently used. Entries
+  /// whose files turn out to be corrupt are deleted.
+  sk_sp<SkImage> Load(const std::string& key, const SkImageInfo& info);
+
+  /// Stores |pixmap| as the entry with |key| and deletes least recently used
+  /// entries until the store fits in its byte budget. |key| must be one
+  /// returned by |ComputeKey|, as it is used as the name of the file.
+  bool Store(const std::string& key, const SkPixmap& pixmap);
+
+  size_t entry_count() const;
+  size_t total_bytes() const;
+  size_t max_bytes() const { return max_bytes_; }
+  bool read_only() const { return read_only_; }
+
+ private:
+  struct Entry {
+    std::string key;
+    size_t bytes;
+  };
+
+  void Touch(std::list<Entry>::iterator it);
+  void Remove(std::list<Entry>::iterator it);
+  void Purge();
+  void WriteIndex();
+
+  static std::mutex instance_mutex_;
+  static std::shared_ptr<RasterCacheDiskStore> instance_;
+
+  const std::shared_ptr<fml::UniqueFD> directory_;
+  const size_t max_bytes_;
+  const bool read_only_;
+  mutable std::mutex mutex_;
+  // The entries from least to most recently used.
+  std::list<Entry> lru_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  size_t total_bytes_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(RasterCacheDiskStore);
+};
+
+}  // namespace flutter
+
+#else  //  !SLIMPELLER
+
+class RasterCacheDiskStore;
+
+#endif  //  !SLIMPELLER
+
+#endif  // FLUTTER_FLOW_RASTER_CACHE_DISK_STORE_H_
@@ -0,0 +1,275 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/raster_cache_disk_store.h"
+
+#include <cstring>
+
+#include "flutter/display_list/dl_builder.h"
+#include "flutter/display_list/testing/dl_test_snippets.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/mapping.h"
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
+
+namespace flutter {
+namespace testing {
+
+static sk_sp<DisplayList> MakeStaticDisplayList(DlColor color) {
+  DisplayListBuilder builder;
+  builder.DrawRect(SkRect::MakeLTRB(0, 0, 20, 20), DlPaint(color));
+  builder.DrawCircle(DlPoint(10, 10), 5, DlPaint(DlColor::kBlue()));
+  return builder.Build();
+}
+
+static SkBitmap MakeBitmap(int width, int height, SkColor color) {
+  SkBitmap bitmap;
+  bitmap.allocPixels(SkImageInfo::MakeN32Premul(width, height));
+  bitmap.eraseColor(color);
+  return bitmap;
+}
+
+static std::shared_ptr<fml::UniqueFD> OpenDirectory(
+    const fml::ScopedTemporaryDirectory& temp_dir) {
+  return std::make_shared<fml::UniqueFD>(fml::OpenDirectory(
+      temp_dir.path().c_str(), false, fml::FilePermission::kReadWrite));
+}
+
+// Returns a key in the format of |RasterCacheDiskStore::ComputeKey|.
+static std::string MakeKey(char digit) {
+  return std::string(64, digit);
+}
+
+TEST(RasterCacheDiskStore, KeyDependsOnContentScaleAndColorSpace) {
+  sk_sp<DisplayList> red = MakeStaticDisplayList(DlColor::kRed());
+  sk_sp<DisplayList> red_again = MakeStaticDisplayList(DlColor::kRed());
+  sk_sp<DisplayList> green = MakeStaticDisplayList(DlColor::kGreen());
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  std::string key =
+      RasterCacheDiskStore::ComputeKey(*red, SkMatrix::I(), srgb.get());
+  ASSERT_FALSE(key.empty());
+  EXPECT_EQ(RasterCacheDiskStore::ComputeKey(*red_again, SkMatrix::I(),
+                                             srgb.get()),
+            key);
+  EXPECT_EQ(RasterCacheDiskStore::ComputeKey(
+                *red, SkMatrix::Translate(10.5, 20), srgb.get()),
+            key);
+  EXPECT_NE(
+      RasterCacheDiskStore::ComputeKey(*green, SkMatrix::I(), srgb.get()),
+      key);
+  EXPECT_NE(RasterCacheDiskStore::ComputeKey(*red, SkMatrix::Scale(2, 2),
+                                             srgb.get()),
+            key);
+  EXPECT_NE(RasterCacheDiskStore::ComputeKey(
+                *red, SkMatrix::I(), SkColorSpace::MakeSRGBLinear().get()),
+            key);
+
+  DisplayListBuilder builder;
+  builder.DrawImage(TestImage1, DlPoint(10, 10),
+                    DlImageSampling::kNearestNeighbor);
+  EXPECT_TRUE(RasterCacheDiskStore::ComputeKey(*builder.Build(),
+                                               SkMatrix::I(), srgb.get())
+                  .empty());
+}
+
+TEST(RasterCacheDiskStore, EntriesSurviveReopening) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  SkBitmap bitmap = MakeBitmap(8, 4, SK_ColorRED);
+  const std::string key = MakeKey('e');
+
+  {
+    RasterCacheDiskStore store(OpenDirectory(temp_dir), 1024 * 1024);
+    store.LoadIndex();
+    ASSERT_EQ(store.entry_count(), 0u);
+    ASSERT_TRUE(store.Store(key, bitmap.pixmap()));
+    ASSERT_EQ(store.entry_count(), 1u);
+  }
+
+  RasterCacheDiskStore store(OpenDirectory(temp_dir), 1024 * 1024);
+  store.LoadIndex();
+  ASSERT_EQ(store.entry_count(), 1u);
+
+  // The pixels must match the image the caller is about to rasterize.
+  EXPECT_EQ(store.Load(key, SkImageInfo::MakeN32Premul(4, 8)), nullptr);
+  EXPECT_EQ(store.Load(MakeKey('f'), bitmap.info()), nullptr);
+
+  sk_sp<SkImage> image = store.Load(key, bitmap.info());
+  ASSERT_NE(image, nullptr);
+  SkPixmap pixmap;
+  ASSERT_TRUE(image->peekPixels(&pixmap));
+  EXPECT_EQ(pixmap.getColor(7, 3), SK_ColorRED);
+}
+
+TEST(RasterCacheDiskStore, LeastRecentlyUsedEntriesArePurged) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  SkBitmap bitmap = MakeBitmap(16, 16, SK_ColorBLUE);
+  const std::string key_a = MakeKey('a');
+  const std::string key_b = MakeKey('b');
+  const std::string key_c = MakeKey('c');
+  size_t entry_bytes = 0;
+  {
+    RasterCacheDiskStore store(OpenDirectory(temp_dir), 1024 * 1024);
+    store.LoadIndex();
+    ASSERT_TRUE(store.Store(key_a, bitmap.pixmap()));
+    entry_bytes = store.total_bytes();
+  }
+
+  RasterCacheDiskStore store(OpenDirectory(temp_dir), entry_bytes * 2);
+  store.LoadIndex();
+  ASSERT_TRUE(store.Store(key_b, bitmap.pixmap()));
+  ASSERT_EQ(store.entry_count(), 2u);
+
+  // Using "a" makes "b" the least recently used entry.
+  ASSERT_NE(store.Load(key_a, bitmap.info()), nullptr);
+  ASSERT_TRUE(store.Store(key_c, bitmap.pixmap()));
+  EXPECT_EQ(store.entry_count(), 2u);
+  EXPECT_EQ(store.total_bytes(), entry_bytes * 2);
+  EXPECT_NE(store.Load(key_a, bitmap.info()), nullptr);
+  EXPECT_EQ(store.Load(key_b, bitmap.info()), nullptr);
+  EXPECT_FALSE(fml::FileExists(temp_dir.fd(), key_b.c_str()));
+
+  // A store with a smaller budget purges when it loads its index.
+  RasterCacheDiskStore small_store(OpenDirectory(temp_dir), entry_bytes);
+  small_store.LoadIndex();
+  EXPECT_EQ(small_store.entry_count(), 1u);
+  EXPECT_NE(small_store.Load(key_a, bitmap.info()), nullptr);
+}
+
+TEST(RasterCacheDiskStore, InvalidFilesAreDeleted) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  SkBitmap bitmap = MakeBitmap(8, 8, SK_ColorGREEN);
+  const std::string good_key = MakeKey('0');
+  const std::string truncated_key = MakeKey('1');
+  {
+    RasterCacheDiskStore store(OpenDirectory(temp_dir), 1024 * 1024);
+    store.LoadIndex();
+    ASSERT_TRUE(store.Store(good_key, bitmap.pixmap()));
+    ASSERT_TRUE(store.Store(truncated_key, bitmap.pixmap()));
+  }
+  const char kGarbage[] = "garbage";
+  fml::DataMapping garbage(std::vector<uint8_t>(kGarbage, kGarbage + 7));
+  ASSERT_TRUE(
+      fml::WriteAtomically(temp_dir.fd(), truncated_key.c_str(), garbage));
+  ASSERT_TRUE(fml::WriteAtomically(temp_dir.fd(), "orphan", garbage));
+
+  RasterCacheDiskStore store(OpenDirectory(temp_dir), 1024 * 1024);
+  store.LoadIndex();
+  EXPECT_EQ(store.entry_count(), 1u);
+  EXPECT_FALSE(fml::FileExists(temp_dir.fd(), truncated_key.c_str()));
+  EXPECT_FALSE(fml::FileExists(temp_dir.fd(), "orphan"));
+  EXPECT_NE(store.Load(good_key, bitmap.info()), nullptr);
+}
+
+TEST(RasterCacheDiskStore, KeysThatAreNotDigestsAreRejected) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  SkBitmap bitmap = MakeBitmap(8, 8, SK_ColorGREEN);
+  RasterCacheDiskStore store(OpenDirectory(temp_dir), 1024 * 1024);
+  store.LoadIndex();
+  EXPECT_FALSE(store.Store("", bitmap.pixmap()));
+  EXPECT_FALSE(store.Store("../" + MakeKey('a').substr(3), bitmap.pixmap()));
+  EXPECT_FALSE(store.Store(MakeKey('A'), bitmap.pixmap()));
+  EXPECT_FALSE(store.Store(MakeKey('a') + "0", bitmap.pixmap()));
+  EXPECT_FALSE(store.Store(RasterCacheDiskStore::kIndexFileName,
+                           bitmap.pixmap()));
+  EXPECT_EQ(store.entry_count(), 0u);
+
+  // An index that names a file that is not an entry does not adopt it.
+  const std::string key = MakeKey('a');
+  ASSERT_TRUE(store.Store(key, bitmap.pixmap()));
+  size_t entry_bytes = store.total_bytes();
+  fml::UniqueFD index = fml::OpenFileReadOnly(
+      temp_dir.fd(), RasterCacheDiskStore::kIndexFileName);
+  ASSERT_TRUE(index.is_valid());
+  fml::FileMapping index_mapping(index);
+  std::vector<uint8_t> index_data(
+      index_mapping.GetMapping(),
+      index_mapping.GetMapping() + index_mapping.GetSize());
+  ASSERT_EQ(index_data.size(), 32u + key.size());
+  // Rename the entry in the index and on disk to a name that is not a key.
+  const std::string other_name = std::string(key.size() - 1, 'a') + "x";
+  memcpy(index_data.data() + 32u, other_name.data(), other_name.size());
+  fml::DataMapping renamed_index(std::move(index_data));
+  ASSERT_TRUE(fml::WriteAtomically(
+      temp_dir.fd(), RasterCacheDiskStore::kIndexFileName, renamed_index));
+  fml::UniqueFD entry = fml::OpenFileReadOnly(temp_dir.fd(), key.c_str());
+  ASSERT_TRUE(entry.is_valid());
+  fml::FileMapping entry_mapping(entry);
+  ASSERT_EQ(entry_mapping.GetSize(), entry_bytes);
+  fml::DataMapping entry_copy(std::vector<uint8_t>(
+      entry_mapping.GetMapping(),
+      entry_mapping.GetMapping() + entry_mapping.GetSize()));
+  ASSERT_TRUE(
+      fml::WriteAtomically(temp_dir.fd(), other_name.c_str(), entry_copy));
+
+  RasterCacheDiskStore reopened(OpenDirectory(temp_dir), 1024 * 1024);
+  reopened.LoadIndex();
+  EXPECT_EQ(reopened.entry_count(), 0u);
+  EXPECT_FALSE(fml::FileExists(temp_dir.fd(), other_name.c_str()));
+}
+
+TEST(RasterCacheDiskStore, EntriesWithOverflowingSizesAreDeleted) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  SkBitmap bitmap = MakeBitmap(8, 8, SK_ColorGREEN);
+  const std::string key = MakeKey('0');
+  RasterCacheDiskStore store(OpenDirectory(temp_dir), 1024 * 1024);
+  store.LoadIndex();
+  ASSERT_TRUE(store.Store(key, bitmap.pixmap()));
+
+  fml::UniqueFD entry = fml::OpenFileReadOnly(temp_dir.fd(), key.c_str());
+  ASSERT_TRUE(entry.is_valid());
+  fml::FileMapping entry_mapping(entry);
+  std::vector<uint8_t> entry_data(
+      entry_mapping.GetMapping(),
+      entry_mapping.GetMapping() + entry_mapping.GetSize());
+  ASSERT_EQ(entry_data.size(), 32u + 8u * 8u * 4u);
+  // The rows overflow to the size of the pixels when multiplied by the
+  // height of 8.
+  uint64_t row_bytes = (uint64_t{1} << 61) + 32u;
+  memcpy(entry_data.data() + 24u, &row_bytes, sizeof(row_bytes));
+  fml::DataMapping corrupt_entry(std::move(entry_data));
+  ASSERT_TRUE(fml::WriteAtomically(temp_dir.fd(), key.c_str(), corrupt_entry));
+
+  EXPECT_EQ(store.Load(key, bitmap.info()), nullptr);
+  EXPECT_EQ(store.entry_count(), 0u);
+  EXPECT_FALSE(fml::FileExists(temp_dir.fd(), key.c_str()));
+}
+
+TEST(RasterCacheDiskStore, ReadOnlyStoreDoesNotModifyTheDirectory) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  SkBitmap bitmap = MakeBitmap(8, 8, SK_ColorGREEN);
+  const std::string key1 = MakeKey('1');
+  const std::string key2 = MakeKey('2');
+  size_t entry_bytes;
+  {
+    RasterCacheDiskStore store(OpenDirectory(temp_dir), 1024 * 1024);
+    store.LoadIndex();
+    ASSERT_TRUE(store.Store(key1, bitmap.pixmap()));
+    ASSERT_TRUE(store.Store(key2, bitmap.pixmap()));
+    entry_bytes = store.total_bytes() / 2;
+  }
+  const char kGarbage[] = "garbage";
+  fml::DataMapping garbage(std::vector<uint8_t>(kGarbage, kGarbage + 7));
+  ASSERT_TRUE(fml::WriteAtomically(temp_dir.fd(), "orphan", garbage));
+
+  // The store only has room for the most recently used entry.
+  RasterCacheDiskStore store(OpenDirectory(temp_dir), entry_bytes,
+                             /*read_only=*/true);
+  store.LoadIndex();
+  EXPECT_EQ(store.entry_count(), 1u);
+  EXPECT_NE(store.Load(key2, bitmap.info()), nullptr);
+  EXPECT_FALSE(store.Store(MakeKey('3'), bitmap.pixmap()));
+
+  EXPECT_TRUE(fml::FileExists(temp_dir.fd(), key1.c_str()));
+  EXPECT_TRUE(fml::FileExists(temp_dir.fd(), "orphan"));
+  EXPECT_FALSE(fml::FileExists(temp_dir.fd(), MakeKey('3').c_str()));
+
+  RasterCacheDiskStore writable(OpenDirectory(temp_dir), 1024 * 1024);
+  writable.LoadIndex();
+  EXPECT_EQ(writable.entry_count(), 2u);
+}
+
+}  // namespace testing
+}  // namespace flutter
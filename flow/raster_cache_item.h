@@ -44,6 +44,19 @@ class RasterCacheItem {
   virtual void PrerollFinalize(PrerollContext* context,
                                const SkMatrix& matrix) = 0;
 
+  // Whether |PrerollReplay| would leave the same state in the
+  // PrerollContext as the last PrerollSetup/PrerollFinalize pair did, so
+  // that the layer owning this item does not have to be prerolled again.
+  virtual bool CanReplayPreroll(const PrerollContext& context) const {
+    return true;
+  }
+
+  // Repeats the raster cache bookkeeping of the last PrerollSetup and
+  // PrerollFinalize pair for a layer whose Preroll is skipped because
+  // nothing changed since the last frame. The item has already been added
+  // to the raster cached entries of |context|.
+  virtual void PrerollReplay(PrerollContext* context) = 0;
+
   virtual bool Draw(const PaintContext& context,
                     const DlPaint* paint) const = 0;
 
@@ -15,6 +15,9 @@
 #include "flutter/flow/raster_cache_item.h"
 #include "flutter/flow/testing/layer_test.h"
 #include "flutter/flow/testing/mock_raster_cache.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/thread.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/testing/assertions_skia.h"
 #include "gtest/gtest.h"
 #include "third_party/skia/include/core/SkMatrix.h"
@@ -320,6 +323,371 @@ TEST(RasterCache, EvictUnusedCacheEntries) {
   cache.EndFrame();
 }
 
+TEST(RasterCache, MaxBytesKeepsUnusedCacheEntries) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  cache.SetMaxBytes(51248u);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto display_list_1 = GetSampleDisplayList();
+  auto display_list_2 = GetSampleDisplayList();
+
+  DisplayListBuilder dummy_canvas(1000, 1000);
+  DlPaint paint;
+
+  LayerStateStack preroll_state_stack;
+  preroll_state_stack.set_preroll_delegate(kGiantRect, matrix);
+  LayerStateStack paint_state_stack;
+  preroll_state_stack.set_delegate(&dummy_canvas);
+
+  FixedRefreshRateStopwatch raster_time;
+  FixedRefreshRateStopwatch ui_time;
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder(
+      preroll_state_stack, &cache, &raster_time, &ui_time);
+  PaintContextHolder paint_context_holder = GetSamplePaintContextHolder(
+      paint_state_stack, &cache, &raster_time, &ui_time);
+  auto& preroll_context = preroll_context_holder.preroll_context;
+  auto& paint_context = paint_context_holder.paint_context;
+
+  DisplayListRasterCacheItem display_list_item_1(display_list_1, SkPoint(),
+                                                 true, false);
+  DisplayListRasterCacheItem display_list_item_2(display_list_2, SkPoint(),
+                                                 true, false);
+
+  for (int i = 0; i < 2; i++) {
+    cache.BeginFrame();
+    RasterCacheItemPreroll(display_list_item_1, preroll_context, matrix);
+    RasterCacheItemPreroll(display_list_item_2, preroll_context, matrix);
+    cache.EvictUnusedCacheEntries();
+    RasterCacheItemTryToRasterCache(display_list_item_1, paint_context);
+    RasterCacheItemTryToRasterCache(display_list_item_2, paint_context);
+    cache.EndFrame();
+  }
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 51248u);
+  ASSERT_EQ(cache.picture_metrics().miss_count, 2u);
+
+  // The second entry is not used but it fits within the budget.
+  cache.BeginFrame();
+  RasterCacheItemPreroll(display_list_item_1, preroll_context, matrix);
+  cache.EvictUnusedCacheEntries();
+  ASSERT_TRUE(
+      RasterCacheItemTryToRasterCache(display_list_item_1, paint_context));
+  ASSERT_TRUE(display_list_item_1.Draw(paint_context, &dummy_canvas, &paint));
+  cache.EndFrame();
+
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 51248u);
+  ASSERT_EQ(cache.picture_metrics().in_use_count, 1u);
+  ASSERT_EQ(cache.picture_metrics().retained_count, 1u);
+  ASSERT_EQ(cache.picture_metrics().total_count(), 2u);
+  ASSERT_EQ(cache.picture_metrics().total_bytes(), 51248u);
+  ASSERT_EQ(cache.picture_metrics().eviction_count, 0u);
+  ASSERT_EQ(cache.picture_metrics().hit_count, 1u);
+  ASSERT_EQ(cache.picture_metrics().miss_count, 0u);
+
+  // When the second entry reappears it is drawn without being rasterized.
+  cache.BeginFrame();
+  RasterCacheItemPreroll(display_list_item_2, preroll_context, matrix);
+  cache.EvictUnusedCacheEntries();
+  ASSERT_TRUE(
+      RasterCacheItemTryToRasterCache(display_list_item_2, paint_context));
+  ASSERT_TRUE(display_list_item_2.Draw(paint_context, &dummy_canvas, &paint));
+  cache.EndFrame();
+
+  ASSERT_EQ(cache.picture_metrics().hit_count, 1u);
+  ASSERT_EQ(cache.picture_metrics().miss_count, 0u);
+  ASSERT_EQ(cache.picture_metrics().retained_count, 1u);
+}
+
+TEST(RasterCache, MaxBytesEvictsOnlyUnusedCacheEntries) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  cache.SetMaxBytes(60000u);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  DisplayListBuilder dummy_canvas(1000, 1000);
+  DlPaint paint;
+
+  LayerStateStack preroll_state_stack;
+  preroll_state_stack.set_preroll_delegate(kGiantRect, matrix);
+  LayerStateStack paint_state_stack;
+  preroll_state_stack.set_delegate(&dummy_canvas);
+
+  FixedRefreshRateStopwatch raster_time;
+  FixedRefreshRateStopwatch ui_time;
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder(
+      preroll_state_stack, &cache, &raster_time, &ui_time);
+  PaintContextHolder paint_context_holder = GetSamplePaintContextHolder(
+      paint_state_stack, &cache, &raster_time, &ui_time);
+  auto& preroll_context = preroll_context_holder.preroll_context;
+  auto& paint_context = paint_context_holder.paint_context;
+
+  std::vector<std::unique_ptr<DisplayListRasterCacheItem>> items;
+  for (int i = 0; i < 3; i++) {
+    items.push_back(std::make_unique<DisplayListRasterCacheItem>(
+        GetSampleDisplayList(), SkPoint(), true, false));
+  }
+
+  for (int i = 0; i < 2; i++) {
+    cache.BeginFrame();
+    for (auto& item : items) {
+      RasterCacheItemPreroll(*item, preroll_context, matrix);
+    }
+    cache.EvictUnusedCacheEntries();
+    for (auto& item : items) {
+      RasterCacheItemTryToRasterCache(*item, paint_context);
+    }
+    cache.EndFrame();
+  }
+  // Entries used in the current frame are kept even if they exceed the
+  // budget.
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 76872u);
+
+  // Only two of the entries fit within the budget so one of the unused
+  // entries is evicted.
+  cache.BeginFrame();
+  RasterCacheItemPreroll(*items[0], preroll_context, matrix);
+  cache.EvictUnusedCacheEntries();
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 51248u);
+  ASSERT_TRUE(RasterCacheItemTryToRasterCache(*items[0], paint_context));
+  cache.EndFrame();
+  ASSERT_EQ(cache.picture_metrics().eviction_count, 1u);
+  ASSERT_EQ(cache.picture_metrics().retained_count, 1u);
+
+  // Nothing is used so the remaining unused entry is evicted until the
+  // cache fits within the budget.
+  cache.SetMaxBytes(25624u);
+  cache.BeginFrame();
+  cache.EvictUnusedCacheEntries();
+  cache.EndFrame();
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 25624u);
+  ASSERT_EQ(cache.picture_metrics().eviction_count, 1u);
+  ASSERT_EQ(cache.picture_metrics().retained_count, 1u);
+}
+
+// Fuchsia does not allow replacing the clock source.
+#if !defined(OS_FUCHSIA)
+
+namespace {
+
+// A clock that advances by |step| on every read, so that rasterizing an
+// entry of the raster cache takes a known time.
+class SteppingClock {
+ public:
+  explicit SteppingClock(fml::TimeDelta step) {
+    step_ = step;
+    fml::TimePoint::SetClockSource(&Now);
+  }
+
+  ~SteppingClock() { fml::TimePoint::SetClockSource(nullptr); }
+
+  void SetStep(fml::TimeDelta step) { step_ = step; }
+
+ private:
+  static inline fml::TimePoint now_;
+  static inline fml::TimeDelta step_;
+
+  static fml::TimePoint Now() {
+    now_ = now_ + step_;
+    return now_;
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(SteppingClock);
+};
+
+}  // namespace
+
+TEST(RasterCache, MaxBytesEvictsCacheEntriesCheapestToRasterizeFirst) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  cache.SetMaxBytes(25624u);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  DisplayListBuilder dummy_canvas(1000, 1000);
+
+  LayerStateStack preroll_state_stack;
+  preroll_state_stack.set_preroll_delegate(kGiantRect, matrix);
+  LayerStateStack paint_state_stack;
+  preroll_state_stack.set_delegate(&dummy_canvas);
+
+  FixedRefreshRateStopwatch raster_time;
+  FixedRefreshRateStopwatch ui_time;
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder(
+      preroll_state_stack, &cache, &raster_time, &ui_time);
+  PaintContextHolder paint_context_holder = GetSamplePaintContextHolder(
+      paint_state_stack, &cache, &raster_time, &ui_time);
+  auto& preroll_context = preroll_context_holder.preroll_context;
+  auto& paint_context = paint_context_holder.paint_context;
+
+  DisplayListRasterCacheItem cheap_item(GetSampleDisplayList(), SkPoint(), true,
+                                        false);
+  DisplayListRasterCacheItem costly_item(GetSampleDisplayList(), SkPoint(),
+                                         true, false);
+
+  // Both images have the same size and are used in the same frames, but the
+  // costly one takes four times as long to rasterize.
+  SteppingClock clock(fml::TimeDelta::FromMilliseconds(1));
+  for (int i = 0; i < 2; i++) {
+    cache.BeginFrame();
+    RasterCacheItemPreroll(cheap_item, preroll_context, matrix);
+    RasterCacheItemPreroll(costly_item, preroll_context, matrix);
+    cache.EvictUnusedCacheEntries();
+    clock.SetStep(fml::TimeDelta::FromMilliseconds(1));
+    RasterCacheItemTryToRasterCache(cheap_item, paint_context);
+    clock.SetStep(fml::TimeDelta::FromMilliseconds(4));
+    RasterCacheItemTryToRasterCache(costly_item, paint_context);
+    cache.EndFrame();
+  }
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 51248u);
+
+  cache.BeginFrame();
+  cache.EvictUnusedCacheEntries();
+  cache.EndFrame();
+  ASSERT_EQ(cache.picture_metrics().eviction_count, 1u);
+  ASSERT_FALSE(cache.HasEntry(cheap_item.GetId().value(), matrix));
+  ASSERT_TRUE(cache.HasEntry(costly_item.GetId().value(), matrix));
+}
+
+TEST(RasterCache, MaxBytesEvictsOldestSecondToLastUseOnPriorityTies) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  cache.SetMaxBytes(51248u);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  DisplayListBuilder dummy_canvas(1000, 1000);
+
+  LayerStateStack preroll_state_stack;
+  preroll_state_stack.set_preroll_delegate(kGiantRect, matrix);
+  LayerStateStack paint_state_stack;
+  preroll_state_stack.set_delegate(&dummy_canvas);
+
+  FixedRefreshRateStopwatch raster_time;
+  FixedRefreshRateStopwatch ui_time;
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder(
+      preroll_state_stack, &cache, &raster_time, &ui_time);
+  PaintContextHolder paint_context_holder = GetSamplePaintContextHolder(
+      paint_state_stack, &cache, &raster_time, &ui_time);
+  auto& preroll_context = preroll_context_holder.preroll_context;
+  auto& paint_context = paint_context_holder.paint_context;
+
+  DisplayListRasterCacheItem older_item(GetSampleDisplayList(), SkPoint(), true,
+                                        false);
+  DisplayListRasterCacheItem newer_item(GetSampleDisplayList(), SkPoint(), true,
+                                        false);
+
+  // Both images have the same size and rasterization time and are used in
+  // four frames each, which gives them the same priority. The older item
+  // skips the fourth frame and the newer item skips the third, so the
+  // second to last use of the older item is the oldest.
+  SteppingClock clock(fml::TimeDelta::FromMilliseconds(1));
+  const bool used[5][2] = {
+      {true, true}, {true, true}, {true, false}, {false, true}, {true, true},
+  };
+  for (const auto& [older_used, newer_used] : used) {
+    cache.BeginFrame();
+    if (older_used) {
+      RasterCacheItemPreroll(older_item, preroll_context, matrix);
+    }
+    if (newer_used) {
+      RasterCacheItemPreroll(newer_item, preroll_context, matrix);
+    }
+    cache.EvictUnusedCacheEntries();
+    if (older_used) {
+      RasterCacheItemTryToRasterCache(older_item, paint_context);
+    }
+    if (newer_used) {
+      RasterCacheItemTryToRasterCache(newer_item, paint_context);
+    }
+    cache.EndFrame();
+  }
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 51248u);
+  ASSERT_EQ(cache.picture_metrics().eviction_count, 0u);
+
+  cache.SetMaxBytes(25624u);
+  cache.BeginFrame();
+  cache.EvictUnusedCacheEntries();
+  cache.EndFrame();
+  ASSERT_EQ(cache.picture_metrics().eviction_count, 1u);
+  ASSERT_FALSE(cache.HasEntry(older_item.GetId().value(), matrix));
+  ASSERT_TRUE(cache.HasEntry(newer_item.GetId().value(), matrix));
+}
+
+#endif  // !defined(OS_FUCHSIA)
+
+TEST(RasterCache, AsyncPopulationRasterizesOffTheFrame) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  fml::Thread worker("raster_cache_worker");
+  cache.EnableAsyncPopulation(worker.GetTaskRunner(), {});
+  ASSERT_TRUE(cache.async_population_enabled());
+
+  // Hold the worker so that nothing it is given can finish during a frame.
+  fml::AutoResetWaitableEvent release_worker;
+  worker.GetTaskRunner()->PostTask([&release_worker] {
+    release_worker.Wait();
+  });
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto display_list = GetSampleDisplayList();
+
+  DisplayListBuilder dummy_canvas(1000, 1000);
+  DlPaint paint;
+
+  LayerStateStack preroll_state_stack;
+  preroll_state_stack.set_preroll_delegate(kGiantRect, matrix);
+  LayerStateStack paint_state_stack;
+  preroll_state_stack.set_delegate(&dummy_canvas);
+
+  FixedRefreshRateStopwatch raster_time;
+  FixedRefreshRateStopwatch ui_time;
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder(
+      preroll_state_stack, &cache, &raster_time, &ui_time);
+  PaintContextHolder paint_context_holder = GetSamplePaintContextHolder(
+      paint_state_stack, &cache, &raster_time, &ui_time);
+  auto& preroll_context = preroll_context_holder.preroll_context;
+  auto& paint_context = paint_context_holder.paint_context;
+
+  DisplayListRasterCacheItem display_list_item(display_list, SkPoint(), true,
+                                               false);
+
+  // The entry qualifies on the second frame, but neither that frame nor the
+  // ones after it rasterize it while the worker is busy. They draw the
+  // display list without the cache instead.
+  for (int i = 0; i < 3; i++) {
+    cache.BeginFrame();
+    RasterCacheItemPreroll(display_list_item, preroll_context, matrix);
+    cache.EvictUnusedCacheEntries();
+    ASSERT_FALSE(
+        RasterCacheItemTryToRasterCache(display_list_item, paint_context));
+    ASSERT_FALSE(display_list_item.Draw(paint_context, &dummy_canvas, &paint));
+    cache.EndFrame();
+    ASSERT_EQ(cache.picture_metrics().miss_count, 0u);
+    ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 0u);
+  }
+
+  fml::AutoResetWaitableEvent worker_done;
+  worker.GetTaskRunner()->PostTask([&worker_done] { worker_done.Signal(); });
+  release_worker.Signal();
+  worker_done.Wait();
+
+  // The image is picked up when the next frame begins.
+  cache.BeginFrame();
+  RasterCacheItemPreroll(display_list_item, preroll_context, matrix);
+  cache.EvictUnusedCacheEntries();
+  ASSERT_TRUE(
+      RasterCacheItemTryToRasterCache(display_list_item, paint_context));
+  ASSERT_TRUE(display_list_item.Draw(paint_context, &dummy_canvas, &paint));
+  cache.EndFrame();
+  ASSERT_EQ(cache.picture_metrics().miss_count, 1u);
+  ASSERT_EQ(cache.picture_metrics().hit_count, 1u);
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 25624u);
+}
+
 TEST(RasterCache, ComputeDeviceRectBasedOnFractionalTranslation) {
   SkRect logical_rect = SkRect::MakeLTRB(0, 0, 300.2, 300.3);
   SkMatrix ctm = SkMatrix::MakeAll(2.0, 0, 0, 0, 2.0, 0, 0, 0, 1);
@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "flutter/common/graphics/gl_context_switch.h"
 #include "flutter/display_list/dl_builder.h"
@@ -83,6 +84,12 @@ class SurfaceFrame {
     // Corresponds to EGL_KHR_partial_update
     std::optional<SkIRect> buffer_damage;
 
+    // The parts of frame_damage and buffer_damage that actually changed, as
+    // a small number of possibly overlapping rects. Empty if only the bounds
+    // of the damage are known, in which case they should be used instead.
+    std::vector<SkIRect> frame_damage_rects;
+    std::vector<SkIRect> buffer_damage_rects;
+
     // Time at which this frame is scheduled to be presented. This is a hint
     // that can be passed to the platform to drop queued frames.
     std::optional<fml::TimePoint> presentation_time;
@@ -0,0 +1,126 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/view_slicer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/display_list/dl_builder.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr float kScreenWidth = 1080;
+constexpr float kScreenHeight = 2340;
+
+enum class ViewLayout {
+  // Video tiles in a grid, each with a caption drawn above it.
+  kGrid,
+  // A map covering the screen with small platform views such as markers
+  // and info windows above it, and a toolbar drawn above everything.
+  kMap,
+  // Views stacked on top of each other, each partially covered by the
+  // Flutter UI of every slice above it.
+  kStacked,
+};
+
+struct SyntheticFrame {
+  std::vector<int64_t> composition_order;
+  std::unordered_map<int64_t, std::unique_ptr<EmbedderViewSlice>> slices;
+  std::unordered_map<int64_t, SkRect> view_rects;
+};
+
+SyntheticFrame MakeFrame(ViewLayout layout, int view_count) {
+  SyntheticFrame frame;
+  std::mt19937 rng(view_count);
+  std::uniform_real_distribution<float> x(0, kScreenWidth - 200);
+  std::uniform_real_distribution<float> y(0, kScreenHeight - 200);
+  int columns = std::max(1, static_cast<int>(std::sqrt(view_count)));
+  int rows = (view_count + columns - 1) / columns;
+  float tile_width = kScreenWidth / columns;
+  float tile_height = kScreenHeight / rows;
+  DlPaint paint;
+  for (int64_t id = 0; id < view_count; id++) {
+    SkRect view_rect;
+    auto slice = std::make_unique<DisplayListEmbedderViewSlice>(
+        SkRect::MakeWH(kScreenWidth, kScreenHeight));
+    DlCanvas* canvas = slice->canvas();
+    switch (layout) {
+      case ViewLayout::kGrid: {
+        float left = (id % columns) * tile_width;
+        float top = (id / columns) * tile_height;
+        view_rect = SkRect::MakeXYWH(left + 2.5, top + 2.5, tile_width - 5,
+                                     tile_height - 5);
+        canvas->DrawRect(SkRect::MakeXYWH(left + 10, top + tile_height - 40,
+                                          tile_width / 2, 24),
+                         paint);
+        canvas->DrawCircle(DlPoint(left + tile_width - 20, top + 20), 8,
+                           paint);
+        break;
+      }
+      case ViewLayout::kMap: {
+        view_rect = id == 0 ? SkRect::MakeWH(kScreenWidth, kScreenHeight)
+                            : SkRect::MakeXYWH(x(rng), y(rng), 120, 80);
+        if (id == view_count - 1) {
+          canvas->DrawRect(SkRect::MakeWH(kScreenWidth, 160), paint);
+        } else {
+          canvas->DrawCircle(DlPoint(x(rng), y(rng)), 12, paint);
+        }
+        break;
+      }
+      case ViewLayout::kStacked: {
+        float inset = id * 4.5;
+        view_rect = SkRect::MakeLTRB(inset, inset, kScreenWidth - inset,
+                                     kScreenHeight - inset);
+        for (int i = 0; i < 8; i++) {
+          canvas->DrawRect(SkRect::MakeXYWH(x(rng), y(rng), 150, 40), paint);
+        }
+        break;
+      }
+    }
+    frame.composition_order.push_back(id);
+    frame.view_rects[id] = view_rect;
+    frame.slices[id] = std::move(slice);
+  }
+  return frame;
+}
+
+}  // namespace
+
+static void BM_SliceViews(benchmark::State& state, ViewLayout layout) {
+  int view_count = state.range(0);
+  for (auto _ : state) {
+    state.PauseTiming();
+    SyntheticFrame frame = MakeFrame(layout, view_count);
+    DisplayListBuilder background(SkRect::MakeWH(kScreenWidth, kScreenHeight));
+    state.ResumeTiming();
+
+    auto overlays = SliceViews(&background, frame.composition_order,
+                               frame.slices, frame.view_rects);
+    benchmark::DoNotOptimize(overlays);
+  }
+  state.counters["Views"] = view_count;
+}
+
+BENCHMARK_CAPTURE(BM_SliceViews, Grid, ViewLayout::kGrid)
+    ->RangeMultiplier(2)
+    ->Range(4, 64)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SliceViews, Map, ViewLayout::kMap)
+    ->RangeMultiplier(2)
+    ->Range(4, 64)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SliceViews, Stacked, ViewLayout::kStacked)
+    ->RangeMultiplier(2)
+    ->Range(4, 64)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace flutter
@@ -134,5 +134,66 @@ TEST(ViewSlicerTest, OverlappingTwoPVs) {
   EXPECT_EQ(overlay->second, SkRect::MakeLTRB(0, 0, 100, 100));
 }
 
+TEST(ViewSlicerTest, IgnoresFractionalOverlapsOfComplexSlices) {
+  DisplayListBuilder builder(SkRect::MakeLTRB(0, 0, 100, 100));
+
+  std::vector<int64_t> composition_order = {1};
+  std::unordered_map<int64_t, std::unique_ptr<EmbedderViewSlice>> slices;
+  slices[1] = std::make_unique<DisplayListEmbedderViewSlice>(
+      SkRect::MakeLTRB(0, 0, 100, 100));
+  DlPaint paint;
+  paint.setColor(DlColor::kBlack());
+  slices[1]->canvas()->DrawRect(SkRect::MakeLTRB(0, 0, 50.49, 100), paint);
+  slices[1]->canvas()->DrawRect(SkRect::MakeLTRB(70, 70, 80, 80), paint);
+
+  std::unordered_map<int64_t, SkRect> view_rects = {
+      {1, SkRect::MakeLTRB(50.5, 50.5, 100, 100)}};
+
+  auto computed_overlays =
+      SliceViews(&builder, composition_order, slices, view_rects);
+
+  EXPECT_EQ(computed_overlays.size(), 1u);
+  auto overlay = computed_overlays.find(1);
+  ASSERT_NE(overlay, computed_overlays.end());
+
+  // The edge of the first rect is not part of the overlay.
+  EXPECT_EQ(overlay->second, SkRect::MakeLTRB(70, 70, 80, 80));
+}
+
+TEST(ViewSlicerTest, CanSliceGridOfViews) {
+  std::vector<int64_t> composition_order;
+  std::unordered_map<int64_t, SkRect> view_rects;
+  // A grid of 6 by 4 platform views with a caption above each of them and
+  // a banner across each row.
+  for (int64_t id = 0; id < 24; id++) {
+    float left = (id % 6) * 100;
+    float top = (id / 6) * 100;
+    composition_order.push_back(id);
+    view_rects[id] = SkRect::MakeXYWH(left + 5, top + 5, 90, 90);
+  }
+  std::unordered_map<int64_t, std::unique_ptr<EmbedderViewSlice>> slices;
+  for (int64_t id : composition_order) {
+    float left = (id % 6) * 100;
+    float top = (id / 6) * 100;
+    slices[id] = std::make_unique<DisplayListEmbedderViewSlice>(
+        SkRect::MakeLTRB(0, 0, 600, 400));
+    DlPaint paint;
+    slices[id]->canvas()->DrawRect(
+        SkRect::MakeXYWH(left + 10, top + 70, 60, 20), paint);
+    if (id % 6 == 5) {
+      slices[id]->canvas()->DrawRect(SkRect::MakeXYWH(0, top + 40, 600, 10.5),
+                                     paint);
+    }
+  }
+
+  DisplayListBuilder builder(SkRect::MakeLTRB(0, 0, 600, 400));
+  auto overlays = SliceViews(&builder, composition_order, slices, view_rects);
+
+  EXPECT_EQ(overlays.size(), 24u);
+  // The banner of the first row covers all of the views of the row.
+  EXPECT_EQ(overlays[5], SkRect::MakeLTRB(5, 40, 595, 90));
+  EXPECT_EQ(overlays[6], SkRect::MakeLTRB(10, 170, 70, 190));
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -26,6 +26,7 @@
 #include "impeller/entity/contents/filters/inputs/filter_input.h"
 #include "impeller/entity/entity.h"
 #include "impeller/entity/geometry/geometry.h"
+#include "impeller/entity/geometry/tessellation_cache.h"
 #include "impeller/geometry/color.h"
 #include "impeller/geometry/path.h"
 #include "impeller/geometry/path_builder.h"
@@ -1103,7 +1104,7 @@ void TextFrameDispatcher::drawTextFrame(
   }
   auto scale =
       (matrix_ * Matrix::MakeTranslation(Point(x, y))).GetMaxBasisLengthXY();
-  renderer_.GetLazyGlyphAtlas()->AddTextFrame(*text_frame,  //
+  renderer_.GetLazyGlyphAtlas()->AddTextFrame(text_frame,   //
                                               scale,        //
                                               Point(x, y),  //
                                               properties    //
@@ -1300,6 +1301,7 @@ bool RenderToOnscreen(ContentContext& context,
     context.GetTransientsBuffer().Reset();
   }
   context.GetLazyGlyphAtlas()->ResetTextFrames();
+  context.GetTessellationCache()->EndFrame();
 
   return true;
 }
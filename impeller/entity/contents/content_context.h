@@ -361,6 +361,7 @@ struct ContentContextOptions {
 };
 
 class Tessellator;
+class TessellationCache;
 class RenderTargetCache;
 
 class ContentContext {
@@ -376,6 +377,10 @@ class ContentContext {
 
   std::shared_ptr<Tessellator> GetTessellator() const;
 
+  const std::shared_ptr<TessellationCache>& GetTessellationCache() const {
+    return tessellation_cache_;
+  }
+
   std::shared_ptr<Pipeline<PipelineDescriptor>> GetFastGradientPipeline(
       ContentContextOptions opts) const {
     return GetPipeline(fast_gradient_pipelines_, opts);
@@ -1002,6 +1007,7 @@ class ContentContext {
 
   bool is_valid_ = false;
   std::shared_ptr<Tessellator> tessellator_;
+  std::shared_ptr<TessellationCache> tessellation_cache_;
   std::shared_ptr<RenderTargetAllocator> render_target_cache_;
   std::shared_ptr<HostBuffer> host_buffer_;
   std::shared_ptr<Texture> empty_texture_;
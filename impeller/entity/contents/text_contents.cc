@@ -4,9 +4,11 @@
 
 #include "impeller/entity/contents/text_contents.h"
 
+#include <algorithm>
 #include <cstring>
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "impeller/core/buffer_view.h"
 #include "impeller/core/formats.h"
@@ -81,47 +83,45 @@ bool TextContents::Render(const ContentContext& renderer,
     return true;
   }
 
-  auto type = frame_->GetAtlasType();
-  const std::shared_ptr<GlyphAtlas>& atlas =
-      renderer.GetLazyGlyphAtlas()->CreateOrGetGlyphAtlas(
-          *renderer.GetContext(), renderer.GetTransientsBuffer(), type);
+  const std::shared_ptr<LazyGlyphAtlas>& lazy_atlas =
+      renderer.GetLazyGlyphAtlas();
+  auto type = lazy_atlas->GetAtlasType(*frame_, scale_, properties_.stroke);
+  const std::shared_ptr<GlyphAtlas>& atlas = lazy_atlas->CreateOrGetGlyphAtlas(
+      *renderer.GetContext(), renderer.GetTransientsBuffer(), type);
 
   if (!atlas || !atlas->IsValid()) {
     VALIDATION_LOG << "Cannot render glyphs without prepared atlas.";
     return false;
   }
+  bool is_distance_field = type == GlyphAtlas::Type::kSignedDistanceField;
 
   // Information shared by all glyph draw calls.
-  pass.SetCommandLabel("TextFrame");
   auto opts = OptionsFromPassAndEntity(pass, entity);
   opts.primitive_type = PrimitiveType::kTriangle;
-  pass.SetPipeline(renderer.GetGlyphAtlasPipeline(opts));
 
   using VS = GlyphAtlasPipeline::VertexShader;
   using FS = GlyphAtlasPipeline::FragmentShader;
 
+  auto& host_buffer = renderer.GetTransientsBuffer();
+
   // Common vertex uniforms for all glyphs.
   VS::FrameInfo frame_info;
   frame_info.mvp =
       Entity::GetShaderTransform(entity.GetShaderClipDepth(), pass, Matrix());
-  ISize atlas_size = atlas->GetTexture()->GetSize();
   bool is_translation_scale = entity.GetTransform().IsTranslationScaleOnly();
   Matrix entity_transform = entity.GetTransform();
   Matrix basis_transform = entity_transform.Basis();
 
-  VS::BindFrameInfo(pass,
-                    renderer.GetTransientsBuffer().EmplaceUniform(frame_info));
+  BufferView frame_info_view = host_buffer.EmplaceUniform(frame_info);
 
   FS::FragInfo frag_info;
   frag_info.use_text_color = force_text_color_ ? 1.0 : 0.0;
   frag_info.text_color = ToVector(color.Premultiply());
   frag_info.is_color_glyph = type == GlyphAtlas::Type::kColorBitmap;
-
-  FS::BindFragInfo(pass,
-                   renderer.GetTransientsBuffer().EmplaceUniform(frag_info));
+  frag_info.distance_field_smoothing = 0.0;
 
   SamplerDescriptor sampler_desc;
-  if (is_translation_scale) {
+  if (is_translation_scale && !is_distance_field) {
     sampler_desc.min_filter = MinMagFilter::kNearest;
     sampler_desc.mag_filter = MinMagFilter::kNearest;
   } else {
@@ -130,6 +130,7 @@ bool TextContents::Render(const ContentContext& renderer,
     // on linear sampling to prevent crunchiness caused by the pixel grid not
     // being perfectly aligned.
     // The downside is that this slightly over-blurs rotated/skewed text.
+    // Distance fields are always scaled, and are interpolated linearly.
     sampler_desc.min_filter = MinMagFilter::kLinear;
     sampler_desc.mag_filter = MinMagFilter::kLinear;
   }
@@ -137,12 +138,32 @@ bool TextContents::Render(const ContentContext& renderer,
   // No mipmaps for glyph atlas (glyphs are generated at exact scales).
   sampler_desc.mip_filter = MipFilter::kBase;
 
-  FS::BindGlyphAtlasSampler(
-      pass,                 // command
-      atlas->GetTexture(),  // texture
-      renderer.GetContext()->GetSamplerLibrary()->GetSampler(
-          sampler_desc)  // sampler
-  );
+  const std::unique_ptr<const Sampler>& sampler =
+      renderer.GetContext()->GetSamplerLibrary()->GetSampler(sampler_desc);
+
+  // The glyphs are drawn with one draw call per page of the atlas that holds
+  // any of them, and for a distance field, per smoothing width.
+  auto draw_batch = [&](size_t page, Scalar smoothing,
+                        BufferView vertex_buffer, size_t vertex_count) {
+    frag_info.distance_field_smoothing = smoothing;
+    pass.SetCommandLabel("TextFrame");
+    pass.SetPipeline(renderer.GetGlyphAtlasPipeline(opts));
+    VS::BindFrameInfo(pass, frame_info_view);
+    FS::BindFragInfo(pass, host_buffer.EmplaceUniform(frag_info));
+    FS::BindGlyphAtlasSampler(pass,                     // command
+                              atlas->GetTexture(page),  // texture
+                              sampler                   // sampler
+    );
+    pass.SetVertexBuffer(std::move(vertex_buffer));
+    pass.SetIndexBuffer({}, IndexType::kNone);
+    pass.SetElementCount(vertex_count);
+    return pass.Draw().ok();
+  };
+
+  std::vector<ISize> page_sizes(atlas->GetPageCount());
+  for (size_t page = 0; page < page_sizes.size(); page++) {
+    page_sizes[page] = atlas->GetTexture(page)->GetSize();
+  }
 
   // Common vertex information for all glyphs.
   // All glyphs are given the same vertex information in the form of a
@@ -155,112 +176,182 @@ bool TextContents::Render(const ContentContext& renderer,
                                                 Point{0, 1}, Point{1, 0},
                                                 Point{0, 1}, Point{1, 1}};
 
-  auto& host_buffer = renderer.GetTransientsBuffer();
   size_t vertex_count = 0;
   for (const auto& run : frame_->GetRuns()) {
     vertex_count += run.GetGlyphPositions().size();
   }
   vertex_count *= 6;
 
-  BufferView buffer_view = host_buffer.Emplace(
-      vertex_count * sizeof(VS::PerVertexData), alignof(VS::PerVertexData),
-      [&](uint8_t* contents) {
-        VS::PerVertexData vtx;
-        VS::PerVertexData* vtx_contents =
-            reinterpret_cast<VS::PerVertexData*>(contents);
-        size_t i = 0u;
-        for (const TextRun& run : frame_->GetRuns()) {
-          const Font& font = run.GetFont();
-          Scalar rounded_scale = TextFrame::RoundScaledFontSize(
-              scale_, font.GetMetrics().point_size);
-          const FontGlyphAtlas* font_atlas =
-              atlas->GetFontGlyphAtlas(font, rounded_scale);
-          if (!font_atlas) {
-            VALIDATION_LOG << "Could not find font in the atlas.";
-            continue;
+  // Calls |emit| with the page, the distance field smoothing and the vertex
+  // data of each vertex of each glyph.
+  auto generate_vertices = [&](auto&& emit) {
+    VS::PerVertexData vtx;
+    for (const TextRun& run : frame_->GetRuns()) {
+      const Font& font = run.GetFont();
+      Scalar rounded_scale;
+      const FontGlyphAtlas* font_atlas;
+      Scalar smoothing = 0.0;
+      if (is_distance_field) {
+        rounded_scale =
+            TextFrame::GetDistanceFieldScale(font.GetMetrics().point_size);
+        font_atlas = atlas->GetFontGlyphAtlas(
+            TextFrame::GetDistanceFieldFont(font), 1.0f);
+        // Smooth the outline over one pixel. A pixel spans |pixel_distance|
+        // pixels of the atlas, which holds distances divided by twice the
+        // spread.
+        Scalar pixel_distance = rounded_scale / scale_;
+        smoothing = std::min(
+            pixel_distance / (4.0f * GlyphAtlas::kDistanceFieldSpread), 0.5f);
+      } else {
+        rounded_scale = TextFrame::RoundScaledFontSize(
+            scale_, font.GetMetrics().point_size);
+        font_atlas = atlas->GetFontGlyphAtlas(font, rounded_scale);
+      }
+      if (!font_atlas) {
+        VALIDATION_LOG << "Could not find font in the atlas.";
+        continue;
+      }
+
+      // Adjust glyph position based on the subpixel rounding
+      // used by the font.
+      Point subpixel_adjustment(0.5, 0.5);
+      switch (font.GetAxisAlignment()) {
+        case AxisAlignment::kNone:
+          break;
+        case AxisAlignment::kX:
+          subpixel_adjustment.x = 0.125;
+          break;
+        case AxisAlignment::kY:
+          subpixel_adjustment.y = 0.125;
+          break;
+        case AxisAlignment::kAll:
+          subpixel_adjustment.x = 0.125;
+          subpixel_adjustment.y = 0.125;
+          break;
+      }
+
+      Point screen_offset = (entity_transform * Point(0, 0));
+      for (const TextRun::GlyphPosition& glyph_position :
+           run.GetGlyphPositions()) {
+        SubpixelGlyph glyph{glyph_position.glyph, Point(0, 0), std::nullopt};
+        if (!is_distance_field) {
+          // Note: uses unrounded scale for more accurate subpixel position.
+          glyph.subpixel_offset = TextFrame::ComputeSubpixelPosition(
+              glyph_position, font.GetAxisAlignment(), offset_, scale_);
+          if (properties_.stroke || frame_->HasColor()) {
+            glyph.properties = properties_;
           }
-
-          // Adjust glyph position based on the subpixel rounding
-          // used by the font.
-          Point subpixel_adjustment(0.5, 0.5);
-          switch (font.GetAxisAlignment()) {
-            case AxisAlignment::kNone:
-              break;
-            case AxisAlignment::kX:
-              subpixel_adjustment.x = 0.125;
-              break;
-            case AxisAlignment::kY:
-              subpixel_adjustment.y = 0.125;
-              break;
-            case AxisAlignment::kAll:
-              subpixel_adjustment.x = 0.125;
-              subpixel_adjustment.y = 0.125;
-              break;
+        }
+        const GlyphAtlasEntry* atlas_glyph = font_atlas->FindGlyph(glyph);
+        if (!atlas_glyph) {
+          VALIDATION_LOG << "Could not find glyph position in the atlas.";
+          continue;
+        }
+        const Rect& atlas_glyph_bounds = atlas_glyph->position;
+        const ISize& atlas_size = page_sizes[atlas_glyph->page];
+        Rect glyph_bounds = atlas_glyph->bounds;
+        Rect scaled_bounds = glyph_bounds.Scale(1.0 / rounded_scale);
+
+        if (is_distance_field) {
+          // The distance field is drawn where the glyph is, without
+          // snapping to pixels, and its UVs cover exactly the glyph
+          // bounds that the atlas entry was rasterized from.
+          for (const Point& point : unit_points) {
+            vtx.uv = (atlas_glyph_bounds.GetLeftTop() +
+                      point * glyph_bounds.GetSize()) /
+                     atlas_size;
+            vtx.position =
+                entity_transform * (glyph_position.position +
+                                    scaled_bounds.GetLeftTop() +
+                                    point * scaled_bounds.GetSize());
+            emit(atlas_glyph->page, smoothing, vtx);
           }
+          continue;
+        }
 
-          Point screen_offset = (entity_transform * Point(0, 0));
-          for (const TextRun::GlyphPosition& glyph_position :
-               run.GetGlyphPositions()) {
-            // Note: uses unrounded scale for more accurate subpixel position.
-            Point subpixel = TextFrame::ComputeSubpixelPosition(
-                glyph_position, font.GetAxisAlignment(), offset_, scale_);
-            std::optional<std::pair<Rect, Rect>> maybe_atlas_glyph_bounds =
-                font_atlas->FindGlyphBounds(SubpixelGlyph{
-                    glyph_position.glyph, subpixel,
-                    (properties_.stroke || frame_->HasColor())
-                        ? std::optional<GlyphProperties>(properties_)
-                        : std::nullopt});
-            if (!maybe_atlas_glyph_bounds.has_value()) {
-              VALIDATION_LOG << "Could not find glyph position in the atlas.";
-              continue;
-            }
-            const Rect& atlas_glyph_bounds =
-                maybe_atlas_glyph_bounds.value().first;
-            Rect glyph_bounds = maybe_atlas_glyph_bounds.value().second;
-            Rect scaled_bounds = glyph_bounds.Scale(1.0 / rounded_scale);
-            // For each glyph, we compute two rectangles. One for the vertex
-            // positions and one for the texture coordinates (UVs). The atlas
-            // glyph bounds are used to compute UVs in cases where the
-            // destination and source sizes may differ due to clamping the sizes
-            // of large glyphs.
-            Point uv_origin =
-                (atlas_glyph_bounds.GetLeftTop() - Point(0.5, 0.5)) /
-                atlas_size;
-            Point uv_size =
-                (atlas_glyph_bounds.GetSize() + Point(1, 1)) / atlas_size;
-
-            Point unrounded_glyph_position =
-                basis_transform *
-                (glyph_position.position + scaled_bounds.GetLeftTop());
-
-            Point screen_glyph_position =
-                (screen_offset + unrounded_glyph_position + subpixel_adjustment)
-                    .Floor();
-
-            for (const Point& point : unit_points) {
-              Point position;
-              if (is_translation_scale) {
-                position = (screen_glyph_position +
-                            (basis_transform * point * scaled_bounds.GetSize()))
-                               .Round();
-              } else {
-                position = entity_transform * (glyph_position.position +
-                                               scaled_bounds.GetLeftTop() +
-                                               point * scaled_bounds.GetSize());
-              }
-              vtx.uv = uv_origin + (uv_size * point);
-              vtx.position = position;
-              vtx_contents[i++] = vtx;
-            }
+        // For each glyph, we compute two rectangles. One for the vertex
+        // positions and one for the texture coordinates (UVs). The atlas
+        // glyph bounds are used to compute UVs in cases where the
+        // destination and source sizes may differ due to clamping the sizes
+        // of large glyphs.
+        Point uv_origin =
+            (atlas_glyph_bounds.GetLeftTop() - Point(0.5, 0.5)) / atlas_size;
+        Point uv_size =
+            (atlas_glyph_bounds.GetSize() + Point(1, 1)) / atlas_size;
+
+        Point unrounded_glyph_position =
+            basis_transform *
+            (glyph_position.position + scaled_bounds.GetLeftTop());
+
+        Point screen_glyph_position =
+            (screen_offset + unrounded_glyph_position + subpixel_adjustment)
+                .Floor();
+
+        for (const Point& point : unit_points) {
+          Point position;
+          if (is_translation_scale) {
+            position = (screen_glyph_position +
+                        (basis_transform * point * scaled_bounds.GetSize()))
+                           .Round();
+          } else {
+            position = entity_transform * (glyph_position.position +
+                                           scaled_bounds.GetLeftTop() +
+                                           point * scaled_bounds.GetSize());
           }
+          vtx.uv = uv_origin + (uv_size * point);
+          vtx.position = position;
+          emit(atlas_glyph->page, smoothing, vtx);
         }
-      });
-
-  pass.SetVertexBuffer(std::move(buffer_view));
-  pass.SetIndexBuffer({}, IndexType::kNone);
-  pass.SetElementCount(vertex_count);
+      }
+    }
+  };
+
+  if (atlas->GetPageCount() == 1u && !is_distance_field) {
+    BufferView buffer_view = host_buffer.Emplace(
+        vertex_count * sizeof(VS::PerVertexData), alignof(VS::PerVertexData),
+        [&](uint8_t* contents) {
+          VS::PerVertexData* vtx_contents =
+              reinterpret_cast<VS::PerVertexData*>(contents);
+          size_t i = 0u;
+          generate_vertices(
+              [&](size_t, Scalar, const VS::PerVertexData& vtx) {
+                vtx_contents[i++] = vtx;
+              });
+        });
+    return draw_batch(0u, 0.0, std::move(buffer_view), vertex_count);
+  }
 
-  return pass.Draw().ok();
+  // The glyphs are spread over several pages or smoothing widths, so their
+  // vertices are sorted into batches before they are uploaded.
+  struct DrawBatch {
+    size_t page;
+    Scalar smoothing;
+    std::vector<VS::PerVertexData> vertices;
+  };
+  std::vector<DrawBatch> batches;
+  generate_vertices(
+      [&](size_t page, Scalar smoothing, const VS::PerVertexData& vtx) {
+        auto batch = std::find_if(
+            batches.rbegin(), batches.rend(), [&](const DrawBatch& batch) {
+              return batch.page == page && batch.smoothing == smoothing;
+            });
+        if (batch == batches.rend()) {
+          batches.push_back({page, smoothing, {}});
+          batch = batches.rbegin();
+        }
+        batch->vertices.push_back(vtx);
+      });
+  for (const DrawBatch& batch : batches) {
+    BufferView buffer_view = host_buffer.Emplace(
+        batch.vertices.data(),
+        batch.vertices.size() * sizeof(VS::PerVertexData),
+        alignof(VS::PerVertexData));
+    if (!draw_batch(batch.page, batch.smoothing, std::move(buffer_view),
+                    batch.vertices.size())) {
+      return false;
+    }
+  }
+  return true;
 }
 
 }  // namespace impeller
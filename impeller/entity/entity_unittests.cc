@@ -37,6 +37,7 @@
 #include "impeller/entity/geometry/geometry.h"
 #include "impeller/entity/geometry/stroke_path_geometry.h"
 #include "impeller/entity/geometry/superellipse_geometry.h"
+#include "impeller/entity/geometry/tessellation_cache.h"
 #include "impeller/geometry/color.h"
 #include "impeller/geometry/geometry_asserts.h"
 #include "impeller/geometry/path_builder.h"
@@ -51,6 +52,7 @@
 #include "impeller/renderer/render_target.h"
 #include "impeller/renderer/testing/mocks.h"
 #include "impeller/renderer/vertex_buffer_builder.h"
+#include "impeller/tessellator/tessellator.h"
 #include "impeller/typographer/backends/skia/text_frame_skia.h"
 #include "impeller/typographer/backends/skia/typographer_context_skia.h"
 #include "third_party/imgui/imgui.h"
@@ -2363,6 +2365,91 @@ TEST_P(EntityTest, CanRenderEmptyPathsWithoutCrashing) {
   ASSERT_TRUE(OpenPlaygroundHere(std::move(entity)));
 }
 
+TEST_P(EntityTest, TessellationCacheKeepsPathsDrawnAgain) {
+  auto allocator = GetContext()->GetResourceAllocator();
+  auto host_buffer = HostBuffer::Create(allocator);
+  TessellationCache cache(allocator);
+  Path path = PathBuilder{}.AddCircle({100, 100}, 50).TakePath();
+
+  size_t tessellations = 0u;
+  auto tessellate = [&path, &tessellations](Scalar scale,
+                                            std::vector<Point>& vertices,
+                                            std::vector<uint16_t>& indices) {
+    tessellations++;
+    Tessellator::TessellateConvexInternal(path, vertices, indices, scale);
+  };
+
+  VertexBuffer first = cache.GetOrTessellate(path, 1.0f, std::nullopt,
+                                             *host_buffer, tessellate);
+  EXPECT_EQ(cache.GetEntryCount(), 0u);
+
+  VertexBuffer second = cache.GetOrTessellate(path, 1.0f, std::nullopt,
+                                              *host_buffer, tessellate);
+  EXPECT_EQ(cache.GetEntryCount(), 1u);
+  EXPECT_GT(cache.GetByteSize(), 0u);
+
+  // Copies of the path drawn at a scale rounded up to the same step share
+  // the kept tessellation.
+  Path copy = path;
+  VertexBuffer third = cache.GetOrTessellate(copy, 0.9f, std::nullopt,
+                                             *host_buffer, tessellate);
+  EXPECT_EQ(tessellations, 2u);
+  EXPECT_EQ(third.vertex_buffer.buffer, second.vertex_buffer.buffer);
+  EXPECT_EQ(third.vertex_count, first.vertex_count);
+  EXPECT_EQ(third.index_type, IndexType::k16bit);
+  EXPECT_EQ(cache.GetFrameStatistics().hits, 1u);
+  EXPECT_EQ(cache.GetFrameStatistics().misses, 2u);
+
+  // Strokes and larger scales are kept apart.
+  cache.GetOrTessellate(path, 1.0f,
+                        TessellationCache::StrokeParameters{.width = 2.0f},
+                        *host_buffer, tessellate);
+  cache.GetOrTessellate(path, 2.0f, std::nullopt, *host_buffer, tessellate);
+  EXPECT_EQ(tessellations, 4u);
+
+  cache.EndFrame();
+  EXPECT_EQ(cache.GetFrameStatistics().hits, 0u);
+  EXPECT_EQ(cache.GetFrameStatistics().misses, 0u);
+  EXPECT_EQ(cache.GetEntryCount(), 1u);
+}
+
+TEST_P(EntityTest, TessellationCacheEvictsDestroyedAndUnusedPaths) {
+  auto allocator = GetContext()->GetResourceAllocator();
+  auto host_buffer = HostBuffer::Create(allocator);
+  TessellationCache cache(allocator, TessellationCache::kDefaultMaxBytes,
+                          /*max_entries=*/1u);
+  auto tessellate = [](const Path& path) {
+    return [&path](Scalar scale, std::vector<Point>& vertices,
+                   std::vector<uint16_t>& indices) {
+      Tessellator::TessellateConvexInternal(path, vertices, indices, scale);
+    };
+  };
+
+  Path circle = PathBuilder{}.AddCircle({100, 100}, 50).TakePath();
+  {
+    Path rect =
+        PathBuilder{}.AddRect(Rect::MakeXYWH(0, 0, 100, 100)).TakePath();
+    for (int i = 0; i < 2; i++) {
+      cache.GetOrTessellate(rect, 1.0f, std::nullopt, *host_buffer,
+                            tessellate(rect));
+    }
+    EXPECT_EQ(cache.GetEntryCount(), 1u);
+  }
+  cache.EndFrame();
+  EXPECT_EQ(cache.GetEntryCount(), 0u);
+  EXPECT_EQ(cache.GetByteSize(), 0u);
+
+  Path rect = PathBuilder{}.AddRect(Rect::MakeXYWH(0, 0, 100, 100)).TakePath();
+  for (const Path& path : {rect, circle, rect, circle}) {
+    cache.GetOrTessellate(path, 1.0f, std::nullopt, *host_buffer,
+                          tessellate(path));
+  }
+  EXPECT_EQ(cache.GetEntryCount(), 1u);
+  cache.GetOrTessellate(circle, 1.0f, std::nullopt, *host_buffer,
+                        tessellate(circle));
+  EXPECT_EQ(cache.GetFrameStatistics().hits, 1u);
+}
+
 TEST_P(EntityTest, DrawSuperEllipse) {
   auto callback = [&](ContentContext& context, RenderPass& pass) -> bool {
     // UI state.
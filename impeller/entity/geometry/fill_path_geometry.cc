@@ -9,6 +9,8 @@
 #include "impeller/core/vertex_buffer.h"
 #include "impeller/entity/contents/content_context.h"
 #include "impeller/entity/geometry/geometry.h"
+#include "impeller/entity/geometry/tessellation_cache.h"
+#include "impeller/tessellator/tessellator.h"
 
 namespace impeller {
 
@@ -38,8 +40,15 @@ GeometryResult FillPathGeometry::GetPositionBuffer(
     };
   }
 
-  VertexBuffer vertex_buffer = renderer.GetTessellator()->TessellateConvex(
-      path_, host_buffer, entity.GetTransform().GetMaxBasisLengthXY());
+  VertexBuffer vertex_buffer =
+      renderer.GetTessellationCache()->GetOrTessellate(
+          path_, entity.GetTransform().GetMaxBasisLengthXY(),
+          /*stroke=*/std::nullopt, host_buffer,
+          [this](Scalar scale, std::vector<Point>& vertices,
+                 std::vector<uint16_t>& indices) {
+            Tessellator::TessellateConvexInternal(path_, vertices, indices,
+                                                  scale);
+          });
 
   return GeometryResult{
       .type = PrimitiveType::kTriangleStrip,
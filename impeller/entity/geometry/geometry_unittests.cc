@@ -8,6 +8,7 @@
 #include "impeller/entity/contents/content_context.h"
 #include "impeller/entity/geometry/geometry.h"
 #include "impeller/entity/geometry/stroke_path_geometry.h"
+#include "impeller/entity/geometry/tessellation_cache.h"
 #include "impeller/geometry/constants.h"
 #include "impeller/geometry/geometry_asserts.h"
 #include "impeller/geometry/path_builder.h"
@@ -152,5 +153,19 @@ TEST(EntityGeometryTest, AlphaCoverageStrokePaths) {
   EXPECT_EQ(Geometry::MakeStrokePath({}, 40)->ComputeAlphaCoverage(matrix), 1);
 }
 
+TEST(EntityGeometryTest, TessellationCacheRoundsScalesUp) {
+  EXPECT_EQ(TessellationCache::QuantizeScale(1.0f), 1.0f);
+  EXPECT_EQ(TessellationCache::QuantizeScale(2.0f), 2.0f);
+  EXPECT_EQ(TessellationCache::QuantizeScale(0.25f), 0.25f);
+  for (Scalar scale : {0.3f, 0.9f, 1.01f, 1.5f, 3.7f, 100.0f}) {
+    Scalar quantized = TessellationCache::QuantizeScale(scale);
+    EXPECT_GE(quantized, scale);
+    EXPECT_LT(quantized, scale * 1.2f);
+  }
+  EXPECT_EQ(TessellationCache::QuantizeScale(0.9f),
+            TessellationCache::QuantizeScale(0.95f));
+  EXPECT_EQ(TessellationCache::QuantizeScale(0.0f), 0.0f);
+}
+
 }  // namespace testing
 }  // namespace impeller
@@ -7,6 +7,7 @@
 #include "impeller/core/buffer_view.h"
 #include "impeller/core/formats.h"
 #include "impeller/entity/geometry/geometry.h"
+#include "impeller/entity/geometry/tessellation_cache.h"
 #include "impeller/geometry/constants.h"
 #include "impeller/geometry/path_builder.h"
 #include "impeller/geometry/path_component.h"
@@ -46,6 +47,20 @@ class PositionWriter {
   std::vector<SolidFillVertexShader::PerVertexData> data_ = {};
 };
 
+// Writes positions into a vector of points, which have the layout of the
+// vertices of the solid fill shader.
+class PointWriter {
+ public:
+  explicit PointWriter(std::vector<Point>& points) : points_(points) {}
+
+  void AppendVertex(const Point& point) { points_.push_back(point); }
+
+ private:
+  std::vector<Point>& points_;
+};
+
+static_assert(sizeof(Point) == sizeof(SolidFillVertexShader::PerVertexData));
+
 template <typename VertexWriter>
 class StrokeGenerator {
  public:
@@ -583,27 +598,31 @@ GeometryResult StrokePathGeometry::GetPositionBuffer(
   auto& host_buffer = renderer.GetTransientsBuffer();
   auto scale = entity.GetTransform().GetMaxBasisLengthXY();
 
-  PositionWriter position_writer;
-  auto polyline = renderer.GetTessellator()->CreateTempPolyline(path_, scale);
-  CreateSolidStrokeVertices(position_writer, polyline, stroke_width,
-                            miter_limit_ * stroke_width_ * 0.5f,
-                            GetJoinProc<PositionWriter>(stroke_join_),
-                            GetCapProc<PositionWriter>(stroke_cap_), scale);
-
-  BufferView buffer_view =
-      host_buffer.Emplace(position_writer.GetData().data(),
-                          position_writer.GetData().size() *
-                              sizeof(SolidFillVertexShader::PerVertexData),
-                          alignof(SolidFillVertexShader::PerVertexData));
+  TessellationCache::StrokeParameters stroke{
+      .width = stroke_width,
+      .miter_limit = miter_limit_ * stroke_width_ * 0.5f,
+      .cap = stroke_cap_,
+      .join = stroke_join_,
+  };
+  VertexBuffer vertex_buffer =
+      renderer.GetTessellationCache()->GetOrTessellate(
+          path_, scale, stroke, host_buffer,
+          [this, &renderer, &stroke](Scalar tessellation_scale,
+                                     std::vector<Point>& vertices,
+                                     std::vector<uint16_t>& indices) {
+            PointWriter point_writer(vertices);
+            auto polyline = renderer.GetTessellator()->CreateTempPolyline(
+                path_, tessellation_scale);
+            CreateSolidStrokeVertices(point_writer, polyline, stroke.width,
+                                      stroke.miter_limit,
+                                      GetJoinProc<PointWriter>(stroke.join),
+                                      GetCapProc<PointWriter>(stroke.cap),
+                                      tessellation_scale);
+          });
 
   return GeometryResult{
       .type = PrimitiveType::kTriangleStrip,
-      .vertex_buffer =
-          {
-              .vertex_buffer = buffer_view,
-              .vertex_count = position_writer.GetData().size(),
-              .index_type = IndexType::kNone,
-          },
+      .vertex_buffer = std::move(vertex_buffer),
       .transform = entity.GetShaderTransform(pass),
       .mode = GeometryResult::Mode::kPreventOverdraw};
 }
@@ -0,0 +1,247 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "impeller/entity/geometry/tessellation_cache.h"
+
+#include <cmath>
+#include <utility>
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/trace_event.h"
+#include "impeller/core/device_buffer.h"
+#include "impeller/core/device_buffer_descriptor.h"
+#include "impeller/core/formats.h"
+#include "impeller/core/range.h"
+
+namespace impeller {
+
+namespace {
+
+bool IsCacheableScale(Scalar scale) {
+  return std::isfinite(scale) && scale > 0.0f;
+}
+
+Scalar GetScaleOfStep(int32_t step) {
+  return std::exp2(static_cast<Scalar>(step) /
+                   TessellationCache::kScaleStepsPerOctave);
+}
+
+int32_t GetScaleStep(Scalar scale) {
+  auto step = static_cast<int32_t>(
+      std::ceil(std::log2(scale) * TessellationCache::kScaleStepsPerOctave));
+  // Guard against rounding errors, tessellations must never be coarser than
+  // the requested scale.
+  if (GetScaleOfStep(step) < scale) {
+    step++;
+  }
+  return step;
+}
+
+VertexBuffer EmplaceTessellation(HostBuffer& host_buffer,
+                                 const std::vector<Point>& vertices,
+                                 const std::vector<uint16_t>& indices) {
+  BufferView vertex_buffer = host_buffer.Emplace(
+      vertices.data(), vertices.size() * sizeof(Point), alignof(Point));
+  if (indices.empty()) {
+    return VertexBuffer{
+        .vertex_buffer = std::move(vertex_buffer),
+        .vertex_count = vertices.size(),
+        .index_type = IndexType::kNone,
+    };
+  }
+  BufferView index_buffer = host_buffer.Emplace(
+      indices.data(), indices.size() * sizeof(uint16_t), alignof(uint16_t));
+  return VertexBuffer{
+      .vertex_buffer = std::move(vertex_buffer),
+      .index_buffer = std::move(index_buffer),
+      .vertex_count = indices.size(),
+      .index_type = IndexType::k16bit,
+  };
+}
+
+}  // namespace
+
+std::size_t TessellationCache::Key::Hash::operator()(const Key& key) const {
+  if (!key.stroke.has_value()) {
+    return fml::HashCombine(key.path, key.scale_step);
+  }
+  return fml::HashCombine(key.path, key.scale_step, key.stroke->width,
+                          key.stroke->miter_limit, key.stroke->cap,
+                          key.stroke->join);
+}
+
+TessellationCache::TessellationCache(std::shared_ptr<Allocator> allocator,
+                                     size_t max_bytes,
+                                     size_t max_entries)
+    : allocator_(std::move(allocator)),
+      max_bytes_(max_bytes),
+      max_entries_(max_entries) {}
+
+TessellationCache::~TessellationCache() = default;
+
+// static
+Scalar TessellationCache::QuantizeScale(Scalar scale) {
+  if (!IsCacheableScale(scale)) {
+    return scale;
+  }
+  return GetScaleOfStep(GetScaleStep(scale));
+}
+
+VertexBuffer TessellationCache::GetOrTessellate(
+    const Path& path,
+    Scalar scale,
+    const std::optional<StrokeParameters>& stroke,
+    HostBuffer& host_buffer,
+    const TessellateProc& tessellate) {
+  vertices_.clear();
+  indices_.clear();
+  if (!IsCacheableScale(scale) || !allocator_) {
+    tessellate(scale, vertices_, indices_);
+    return EmplaceTessellation(host_buffer, vertices_, indices_);
+  }
+
+  std::weak_ptr<const void> identity = path.GetIdentity();
+  int32_t scale_step = GetScaleStep(scale);
+  Key key{
+      .path = identity.lock().get(),
+      .scale_step = scale_step,
+      .stroke = stroke,
+  };
+
+  auto found = entries_.find(key);
+  if (found != entries_.end()) {
+    // A destroyed path whose data had the same address is another path.
+    if (!found->second.identity.expired()) {
+      frame_statistics_.hits++;
+      lru_.splice(lru_.begin(), lru_, found->second.lru_position);
+      return found->second.vertex_buffer;
+    }
+    Evict(key);
+  }
+  frame_statistics_.misses++;
+
+  tessellate(GetScaleOfStep(scale_step), vertices_, indices_);
+
+  auto candidate = candidates_.find(key);
+  if (candidate == candidates_.end() || candidate->second.expired()) {
+    candidates_.insert_or_assign(key, std::move(identity));
+    return EmplaceTessellation(host_buffer, vertices_, indices_);
+  }
+  candidates_.erase(candidate);
+
+  VertexBuffer vertex_buffer = Store(key, identity);
+  if (!vertex_buffer) {
+    return EmplaceTessellation(host_buffer, vertices_, indices_);
+  }
+  return vertex_buffer;
+}
+
+VertexBuffer TessellationCache::Store(const Key& key,
+                                      std::weak_ptr<const void> identity) {
+  // Both are tightly packed, the indices right after the vertices.
+  static_assert(alignof(Point) % alignof(uint16_t) == 0u);
+  size_t vertex_bytes = vertices_.size() * sizeof(Point);
+  size_t index_bytes = indices_.size() * sizeof(uint16_t);
+  size_t bytes = vertex_bytes + index_bytes;
+  if (vertices_.empty() || bytes > max_bytes_) {
+    return {};
+  }
+
+  DeviceBufferDescriptor desc;
+  desc.storage_mode = StorageMode::kHostVisible;
+  desc.size = bytes;
+  std::shared_ptr<DeviceBuffer> device_buffer = allocator_->CreateBuffer(desc);
+  if (!device_buffer ||
+      !device_buffer->CopyHostBuffer(
+          reinterpret_cast<const uint8_t*>(vertices_.data()),
+          Range{0u, vertex_bytes}, 0u) ||
+      !device_buffer->CopyHostBuffer(
+          reinterpret_cast<const uint8_t*>(indices_.data()),
+          Range{0u, index_bytes}, vertex_bytes)) {
+    return {};
+  }
+
+  VertexBuffer vertex_buffer;
+  vertex_buffer.vertex_buffer =
+      BufferView{device_buffer, Range{0u, vertex_bytes}};
+  if (indices_.empty()) {
+    vertex_buffer.vertex_count = vertices_.size();
+    vertex_buffer.index_type = IndexType::kNone;
+  } else {
+    vertex_buffer.index_buffer =
+        BufferView{device_buffer, Range{vertex_bytes, index_bytes}};
+    vertex_buffer.vertex_count = indices_.size();
+    vertex_buffer.index_type = IndexType::k16bit;
+  }
+
+  while (!lru_.empty() &&
+         (bytes_ + bytes > max_bytes_ || entries_.size() >= max_entries_)) {
+    Key oldest = lru_.back();
+    Evict(oldest);
+  }
+  lru_.push_front(key);
+  entries_.emplace(key, Entry{
+                            .identity = std::move(identity),
+                            .vertex_buffer = vertex_buffer,
+                            .bytes = bytes,
+                            .lru_position = lru_.begin(),
+                        });
+  bytes_ += bytes;
+  return vertex_buffer;
+}
+
+void TessellationCache::Evict(const Key& key) {
+  auto found = entries_.find(key);
+  if (found == entries_.end()) {
+    return;
+  }
+  bytes_ -= found->second.bytes;
+  lru_.erase(found->second.lru_position);
+  entries_.erase(found);
+}
+
+void TessellationCache::EndFrame() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.identity.expired()) {
+      bytes_ -= it->second.bytes;
+      lru_.erase(it->second.lru_position);
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = candidates_.begin(); it != candidates_.end();) {
+    if (it->second.expired()) {
+      it = candidates_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  // Paths that stay alive without being drawn twice, for example because
+  // they are only drawn at changing scales, would otherwise accumulate.
+  if (candidates_.size() > max_entries_) {
+    candidates_.clear();
+  }
+
+#if !FLUTTER_RELEASE
+  FML_TRACE_COUNTER("impeller", "TessellationCache",
+                    reinterpret_cast<int64_t>(this),                   //
+                    "Hits", frame_statistics_.hits,                    //
+                    "Misses", frame_statistics_.misses,                //
+                    "Entries", entries_.size(),                        //
+                    "KiloBytes", static_cast<int64_t>(bytes_ / 1024u)  //
+  );
+#endif  // !FLUTTER_RELEASE
+
+  frame_statistics_ = {};
+}
+
+void TessellationCache::Clear() {
+  entries_.clear();
+  lru_.clear();
+  candidates_.clear();
+  bytes_ = 0u;
+}
+
+}  // namespace impeller
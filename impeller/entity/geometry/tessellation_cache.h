@@ -0,0 +1,169 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_IMPELLER_ENTITY_GEOMETRY_TESSELLATION_CACHE_H_
+#define FLUTTER_IMPELLER_ENTITY_GEOMETRY_TESSELLATION_CACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "impeller/core/allocator.h"
+#include "impeller/core/host_buffer.h"
+#include "impeller/core/vertex_buffer.h"
+#include "impeller/geometry/path.h"
+#include "impeller/geometry/point.h"
+#include "impeller/geometry/scalar.h"
+
+namespace impeller {
+
+//------------------------------------------------------------------------------
+/// @brief      Keeps the vertices of paths that are filled or stroked in
+///             consecutive frames in device buffers, so that static paths
+///             such as icons are not tessellated again on every frame.
+///
+///             Tessellations are keyed by the identity of the path, the
+///             scale they are tessellated at, and for strokes the stroke
+///             parameters. Scales are rounded up to a fixed number of steps
+///             per doubling, so that paths whose scale changes slightly
+///             still hit the cache, and are never tessellated coarser than
+///             requested.
+///
+///             A tessellation is only kept once its key is seen for the
+///             second time, so that paths that are drawn once do not evict
+///             the ones that are drawn on every frame. Tessellations are
+///             evicted least recently used first to stay within the byte
+///             and entry budgets, and as soon as their path is destroyed.
+///
+///             The cache is not thread safe, and is used on the raster
+///             thread like the |Tessellator|.
+///
+class TessellationCache {
+ public:
+  // The number of scales tessellations are kept at per doubling of the
+  // scale.
+  static constexpr Scalar kScaleStepsPerOctave = 4.0f;
+
+  // The maximum size of the kept vertices and indices.
+  static constexpr size_t kDefaultMaxBytes = 8u * 1024u * 1024u;
+
+  // The maximum number of kept tessellations.
+  static constexpr size_t kDefaultMaxEntries = 1024u;
+
+  struct StrokeParameters {
+    Scalar width = 0.0f;
+    Scalar miter_limit = 0.0f;
+    Cap cap = Cap::kButt;
+    Join join = Join::kMiter;
+
+    constexpr bool operator==(const StrokeParameters& other) const {
+      return width == other.width && miter_limit == other.miter_limit &&
+             cap == other.cap && join == other.join;
+    }
+  };
+
+  /// Writes the tessellation of a path at |scale| into |vertices|, and its
+  /// 16 bit indices into |indices| if it is indexed. Both are empty when
+  /// called.
+  using TessellateProc = std::function<void(Scalar scale,
+                                            std::vector<Point>& vertices,
+                                            std::vector<uint16_t>& indices)>;
+
+  struct Statistics {
+    size_t hits = 0u;
+    size_t misses = 0u;
+  };
+
+  /// Tessellations are kept in buffers created by |allocator|. Nothing is
+  /// kept if it is null.
+  explicit TessellationCache(std::shared_ptr<Allocator> allocator,
+                             size_t max_bytes = kDefaultMaxBytes,
+                             size_t max_entries = kDefaultMaxEntries);
+
+  ~TessellationCache();
+
+  /// Returns the scale that paths drawn at |scale| are tessellated at, which
+  /// is the smallest step that is not smaller than |scale|, or |scale| itself
+  /// if it is not positive and finite.
+  static Scalar QuantizeScale(Scalar scale);
+
+  /// Returns the vertices of |path| filled, or stroked with |stroke|, at
+  /// |scale|. They are either the kept tessellation, or the result of
+  /// |tessellate| at the quantized scale in |host_buffer|.
+  VertexBuffer GetOrTessellate(const Path& path,
+                               Scalar scale,
+                               const std::optional<StrokeParameters>& stroke,
+                               HostBuffer& host_buffer,
+                               const TessellateProc& tessellate);
+
+  /// Evicts the tessellations of destroyed paths, traces the hit rate of
+  /// the frame, and resets the statistics of the frame.
+  void EndFrame();
+
+  /// Evicts all tessellations.
+  void Clear();
+
+  size_t GetEntryCount() const { return entries_.size(); }
+
+  size_t GetByteSize() const { return bytes_; }
+
+  const Statistics& GetFrameStatistics() const { return frame_statistics_; }
+
+ private:
+  struct Key {
+    const void* path = nullptr;
+    int32_t scale_step = 0;
+    std::optional<StrokeParameters> stroke;
+
+    bool operator==(const Key& other) const {
+      return path == other.path && scale_step == other.scale_step &&
+             stroke == other.stroke;
+    }
+
+    struct Hash {
+      std::size_t operator()(const Key& key) const;
+    };
+  };
+
+  struct Entry {
+    std::weak_ptr<const void> identity;
+    VertexBuffer vertex_buffer;
+    size_t bytes = 0u;
+    std::list<Key>::iterator lru_position;
+  };
+
+  // Copies the tessellation in |vertices_| and |indices_| into a device
+  // buffer kept for |key|.
+  VertexBuffer Store(const Key& key, std::weak_ptr<const void> identity);
+
+  void Evict(const Key& key);
+
+  const std::shared_ptr<Allocator> allocator_;
+  const size_t max_bytes_;
+  const size_t max_entries_;
+
+  std::unordered_map<Key, Entry, Key::Hash> entries_;
+  // The keys of |entries_|, most recently used first.
+  std::list<Key> lru_;
+  // The keys seen once, which are kept when they are seen again.
+  std::unordered_map<Key, std::weak_ptr<const void>, Key::Hash> candidates_;
+  size_t bytes_ = 0u;
+  Statistics frame_statistics_;
+
+  // Reused across tessellations.
+  std::vector<Point> vertices_;
+  std::vector<uint16_t> indices_;
+
+  TessellationCache(const TessellationCache&) = delete;
+
+  TessellationCache& operator=(const TessellationCache&) = delete;
+};
+
+}  // namespace impeller
+
+#endif  // FLUTTER_IMPELLER_ENTITY_GEOMETRY_TESSELLATION_CACHE_H_
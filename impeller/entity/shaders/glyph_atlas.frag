@@ -13,6 +13,10 @@ layout(constant_id = 0) const float use_alpha_color_channel = 1.0;
 uniform FragInfo {
   float is_color_glyph;
   float use_text_color;
+  // Half the width, in units of the atlas, of the transition from outside
+  // to inside of the glyphs of a signed distance field atlas. 0 for the
+  // bitmap atlases.
+  float distance_field_smoothing;
   f16vec4 text_color;
 }
 frag_info;
@@ -31,10 +35,13 @@ void main() {
       frag_color = value * frag_info.text_color.aaaa;
     }
   } else {
-    if (use_alpha_color_channel == 1.0) {
-      frag_color = value.aaaa * frag_info.text_color;
-    } else {
-      frag_color = value.rrrr * frag_info.text_color;
+    float16_t coverage = use_alpha_color_channel == 1.0 ? value.a : value.r;
+    if (frag_info.distance_field_smoothing > 0.0) {
+      // The outline of the glyph is at a distance of 0.5.
+      float smoothing = frag_info.distance_field_smoothing;
+      coverage = float16_t(
+          smoothstep(0.5 - smoothing, 0.5 + smoothing, float(coverage)));
     }
+    frag_color = coverage * frag_info.text_color;
   }
 }
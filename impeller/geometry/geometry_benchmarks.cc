@@ -4,9 +4,15 @@
 
 #include "flutter/benchmarking/benchmarking.h"
 
+#include <cstring>
+
 #include "flutter/impeller/entity/solid_fill.vert.h"
 
+#include "impeller/core/allocator.h"
+#include "impeller/core/device_buffer.h"
+#include "impeller/core/host_buffer.h"
 #include "impeller/entity/geometry/stroke_path_geometry.h"
+#include "impeller/entity/geometry/tessellation_cache.h"
 #include "impeller/geometry/path.h"
 #include "impeller/geometry/path_builder.h"
 #include "impeller/tessellator/tessellator_libtess.h"
@@ -35,6 +41,49 @@ Path CreateCubic(bool closed);
 Path CreateQuadratic(bool closed);
 /// Create a rounded rect.
 Path CreateRRect();
+
+/// A device buffer in host memory, so that the tessellation cache can be
+/// measured without a GPU.
+class HostMemoryDeviceBuffer final : public DeviceBuffer {
+ public:
+  explicit HostMemoryDeviceBuffer(const DeviceBufferDescriptor& desc)
+      : DeviceBuffer(desc), contents_(desc.size) {}
+
+  bool SetLabel(std::string_view label) override { return true; }
+
+  bool SetLabel(std::string_view label, Range range) override { return true; }
+
+  uint8_t* OnGetContents() const override {
+    return const_cast<uint8_t*>(contents_.data());
+  }
+
+ private:
+  std::vector<uint8_t> contents_;
+
+  bool OnCopyHostBuffer(const uint8_t* source,
+                        Range source_range,
+                        size_t offset) override {
+    std::memcpy(contents_.data() + offset, source + source_range.offset,
+                source_range.length);
+    return true;
+  }
+};
+
+class HostMemoryAllocator final : public Allocator {
+ public:
+  ISize GetMaxTextureSizeSupported() const override { return {}; }
+
+ private:
+  std::shared_ptr<DeviceBuffer> OnCreateBuffer(
+      const DeviceBufferDescriptor& desc) override {
+    return std::make_shared<HostMemoryDeviceBuffer>(desc);
+  }
+
+  std::shared_ptr<Texture> OnCreateTexture(
+      const TextureDescriptor& desc) override {
+    return nullptr;
+  }
+};
 }  // namespace
 
 static TessellatorLibtess tess;
@@ -116,6 +165,59 @@ static void BM_Convex(benchmark::State& state, Args&&... args) {
   state.counters["TotalPointCount"] = point_count;
 }
 
+/// Draws the same path on every iteration, as a static icon is on every
+/// frame, either through the tessellation cache or tessellating it again.
+template <class... Args>
+static void BM_TessellationCache(benchmark::State& state, Args&&... args) {
+  auto args_tuple = std::make_tuple(std::move(args)...);
+  auto path = std::get<0>(args_tuple);
+  bool stroke = std::get<1>(args_tuple);
+  bool cached = std::get<2>(args_tuple);
+
+  auto allocator = std::make_shared<HostMemoryAllocator>();
+  auto host_buffer = HostBuffer::Create(allocator);
+  // Without an allocator nothing is kept and every draw is tessellated.
+  TessellationCache cache(cached ? allocator : nullptr);
+
+  const Scalar stroke_width = 5.0f;
+  const Scalar miter_limit = 10.0f;
+  std::optional<TessellationCache::StrokeParameters> stroke_parameters;
+  if (stroke) {
+    stroke_parameters = TessellationCache::StrokeParameters{
+        .width = stroke_width,
+        .miter_limit = miter_limit * stroke_width * 0.5f,
+        .cap = Cap::kButt,
+        .join = Join::kMiter,
+    };
+  }
+  auto tessellate = [&path, stroke, stroke_width, miter_limit](
+                        Scalar scale, std::vector<Point>& vertices,
+                        std::vector<uint16_t>& indices) {
+    if (!stroke) {
+      Tessellator::TessellateConvexInternal(path, vertices, indices, scale);
+      return;
+    }
+    auto polyline = path.CreatePolyline(scale);
+    for (const auto& vertex :
+         ImpellerBenchmarkAccessor::GenerateSolidStrokeVertices(
+             polyline, stroke_width, miter_limit, Join::kMiter, Cap::kButt,
+             scale)) {
+      vertices.push_back(vertex.position);
+    }
+  };
+
+  size_t vertex_count = 0u;
+  while (state.KeepRunning()) {
+    VertexBuffer vertex_buffer = cache.GetOrTessellate(
+        path, 1.0f, stroke_parameters, *host_buffer, tessellate);
+    vertex_count = vertex_buffer.vertex_count;
+    host_buffer->Reset();
+    cache.EndFrame();
+  }
+  state.counters["VertexCount"] = vertex_count;
+  state.counters["EntryCount"] = cache.GetEntryCount();
+}
+
 #define MAKE_STROKE_BENCHMARK_CAPTURE(path, cap, join, closed)         \
   BENCHMARK_CAPTURE(BM_StrokePolyline, stroke_##path##_##cap##_##join, \
                     Create##path(closed), Cap::k##cap, Join::k##join)
@@ -143,6 +245,27 @@ MAKE_STROKE_BENCHMARK_CAPTURE(RRect, Butt, Bevel, );
 MAKE_STROKE_BENCHMARK_CAPTURE(RRect, Butt, Miter, );
 MAKE_STROKE_BENCHMARK_CAPTURE(RRect, Butt, Round, );
 
+BENCHMARK_CAPTURE(BM_TessellationCache,
+                  uncached_rrect_convex,
+                  CreateRRect(),
+                  false,
+                  false);
+BENCHMARK_CAPTURE(BM_TessellationCache,
+                  cached_rrect_convex,
+                  CreateRRect(),
+                  false,
+                  true);
+BENCHMARK_CAPTURE(BM_TessellationCache,
+                  uncached_cubic_stroke,
+                  CreateCubic(false),
+                  true,
+                  false);
+BENCHMARK_CAPTURE(BM_TessellationCache,
+                  cached_cubic_stroke,
+                  CreateCubic(false),
+                  true,
+                  true);
+
 namespace {
 
 Path CreateRRect() {
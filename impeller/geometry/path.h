@@ -6,6 +6,7 @@
 #define FLUTTER_IMPELLER_GEOMETRY_PATH_H_
 
 #include <functional>
+#include <memory>
 #include <optional>
 #include <tuple>
 #include <vector>
@@ -193,6 +194,12 @@ class Path {
   /// lines.
   void WritePolyline(Scalar scale, VertexWriter& writer) const;
 
+  /// Returns a reference to the data of this path, which is shared by its
+  /// copies and never modified. It expires once the path and all of its
+  /// copies are destroyed, and can be used to recognize the same path across
+  /// frames.
+  std::weak_ptr<const void> GetIdentity() const { return data_; }
+
  private:
   friend class PathBuilder;
 
@@ -4,12 +4,22 @@
 
 #include "impeller/typographer/backends/skia/typographer_context_skia.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/logging.h"
 #include "flutter/fml/trace_event.h"
 #include "fml/closure.h"
@@ -30,7 +40,9 @@
 #include "impeller/typographer/font_glyph_pair.h"
 #include "impeller/typographer/glyph.h"
 #include "impeller/typographer/glyph_atlas.h"
+#include "impeller/typographer/glyph_atlas_disk_cache.h"
 #include "impeller/typographer/rectangle_packer.h"
+#include "impeller/typographer/signed_distance_field.h"
 #include "impeller/typographer/typographer_context.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkImageInfo.h"
@@ -41,12 +53,24 @@
 #include "third_party/skia/include/core/SkBlendMode.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkFont.h"
+#include "third_party/skia/include/core/SkString.h"
 #include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/core/SkTypeface.h"
 
 namespace impeller {
 
 constexpr auto kPadding = 2;
 
+// Glyphs are only rasterized concurrently when there are at least this many
+// of them, and each worker claims this many glyphs at a time.
+constexpr size_t kMinGlyphsForConcurrentRasterization = 128u;
+constexpr size_t kGlyphsPerBatch = 32u;
+
+// The alignment of the pixels of each glyph in the staging buffer of an
+// atlas update, which satisfies the buffer offset requirements of all of
+// the backends for both the alpha and the color atlas formats.
+constexpr size_t kGlyphStagingAlignment = 16u;
+
 namespace {
 SkPaint::Cap ToSkiaCap(Cap cap) {
   switch (cap) {
@@ -71,13 +95,92 @@ SkPaint::Join ToSkiaJoin(Join join) {
   }
   FML_UNREACHABLE();
 }
+
+// The state shared between the calling thread and the worker tasks of a
+// concurrent glyph rasterization. Worker tasks may start running after the
+// rasterization has finished, at which point there are no glyphs left for
+// them to claim, so this state is reference counted.
+struct ConcurrentGlyphState {
+  explicit ConcurrentGlyphState(size_t count) : glyph_count(count) {}
+
+  const size_t glyph_count;
+  std::atomic<size_t> next_glyph{0u};
+
+  std::mutex mutex;
+  std::condition_variable all_glyphs_drawn;
+  size_t drawn_glyphs = 0u;
+};
+
+template <typename T>
+void AppendBytes(std::string& id, const T* values, size_t count) {
+  id.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
 }  // namespace
 
-std::shared_ptr<TypographerContext> TypographerContextSkia::Make() {
-  return std::make_shared<TypographerContextSkia>();
+/// Receives the pixels of the glyph at |index| of the new font-glyph pairs
+/// once it is drawn, on the thread that drew it.
+using GlyphDrawnCallback = std::function<void(size_t index,
+                                              const uint8_t* pixels,
+                                              size_t row_bytes,
+                                              ISize size)>;
+
+/// Calls |draw_batch| with ranges of glyph indices that together cover
+/// [0, count) exactly once, and returns after all of them are drawn.
+///
+/// With a worker task runner and enough glyphs, the ranges are drawn by
+/// the workers and the calling thread concurrently. Skia can rasterize text
+/// from several threads as long as each of them draws into a canvas of its
+/// own and the pixels they write do not overlap.
+static void DrawGlyphBatches(
+    size_t count,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& worker_task_runner,
+    const std::function<void(size_t begin, size_t end)>& draw_batch) {
+  if (!worker_task_runner || count < kMinGlyphsForConcurrentRasterization) {
+    draw_batch(0u, count);
+    return;
+  }
+  TRACE_EVENT0("impeller", __FUNCTION__);
+
+  auto state = std::make_shared<ConcurrentGlyphState>(count);
+  // Batches are only drawn after successfully claiming them, which can only
+  // happen before this method returns.
+  auto draw_batches = [state, draw_batch = &draw_batch]() {
+    size_t begin;
+    while ((begin = state->next_glyph.fetch_add(kGlyphsPerBatch)) <
+           state->glyph_count) {
+      size_t end = std::min(begin + kGlyphsPerBatch, state->glyph_count);
+      (*draw_batch)(begin, end);
+      std::scoped_lock lock(state->mutex);
+      state->drawn_glyphs += end - begin;
+      if (state->drawn_glyphs == state->glyph_count) {
+        state->all_glyphs_drawn.notify_all();
+      }
+    }
+  };
+  size_t batch_count = (count + kGlyphsPerBatch - 1u) / kGlyphsPerBatch;
+  size_t task_count = std::min<size_t>(
+      batch_count, std::max(std::thread::hardware_concurrency(), 1u));
+  // The calling thread draws glyphs as well.
+  for (size_t i = 1u; i < task_count; i++) {
+    worker_task_runner->PostTask(draw_batches);
+  }
+  draw_batches();
+
+  std::unique_lock lock(state->mutex);
+  state->all_glyphs_drawn.wait(lock, [&state]() {
+    return state->drawn_glyphs == state->glyph_count;
+  });
+}
+
+std::shared_ptr<TypographerContext> TypographerContextSkia::Make(
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner) {
+  return std::make_shared<TypographerContextSkia>(
+      std::move(worker_task_runner));
 }
 
-TypographerContextSkia::TypographerContextSkia() = default;
+TypographerContextSkia::TypographerContextSkia(
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner)
+    : worker_task_runner_(std::move(worker_task_runner)) {}
 
 TypographerContextSkia::~TypographerContextSkia() = default;
 
@@ -89,6 +192,7 @@ TypographerContextSkia::CreateGlyphAtlasContext(GlyphAtlas::Type type) const {
 static SkImageInfo GetImageInfo(const GlyphAtlas& atlas, Size size) {
   switch (atlas.GetType()) {
     case GlyphAtlas::Type::kAlphaBitmap:
+    case GlyphAtlas::Type::kSignedDistanceField:
       return SkImageInfo::MakeA8(SkISize{static_cast<int32_t>(size.width),
                                          static_cast<int32_t>(size.height)});
     case GlyphAtlas::Type::kColorBitmap:
@@ -97,111 +201,218 @@ static SkImageInfo GetImageInfo(const GlyphAtlas& atlas, Size size) {
   FML_UNREACHABLE();
 }
 
-/// Append as many glyphs to the texture as will fit, and return the first index
-/// of [extra_pairs] that did not fit.
-static size_t AppendToExistingAtlas(
-    const std::shared_ptr<GlyphAtlas>& atlas,
-    const std::vector<FontGlyphPair>& extra_pairs,
-    std::vector<Rect>& glyph_positions,
-    const std::vector<Rect>& glyph_sizes,
-    ISize atlas_size,
-    int64_t height_adjustment,
-    const std::shared_ptr<RectanglePacker>& rect_packer) {
-  TRACE_EVENT0("impeller", __FUNCTION__);
-  if (!rect_packer || atlas_size.IsEmpty()) {
-    return 0;
+/// Returns an identifier of the typeface of |font| that stays the same
+/// across launches, or an empty string if there is none. Besides the names
+/// and style of the typeface, it records the sizes of its tables, which
+/// tell versions of the same font apart, and the position of variable
+/// fonts in their design space.
+static std::string GetPersistentTypefaceId(const Font& font) {
+  const sk_sp<SkTypeface>& typeface =
+      TypefaceSkia::Cast(*font.GetTypeface()).GetSkiaTypeface();
+  if (!typeface) {
+    return "";
+  }
+  SkString family_name;
+  typeface->getFamilyName(&family_name);
+  SkString postscript_name;
+  if (!typeface->getPostScriptName(&postscript_name) &&
+      family_name.isEmpty()) {
+    return "";
   }
 
-  for (size_t i = 0; i < extra_pairs.size(); i++) {
-    ISize glyph_size = ISize::Ceil(glyph_sizes[i].GetSize());
-    IPoint16 location_in_atlas;
-    if (!rect_packer->AddRect(glyph_size.width + kPadding,   //
-                              glyph_size.height + kPadding,  //
-                              &location_in_atlas             //
-                              )) {
-      return i;
+  std::string id(family_name.c_str(), family_name.size());
+  id.push_back('\0');
+  id.append(postscript_name.c_str(), postscript_name.size());
+  id.push_back('\0');
+  SkFontStyle style = typeface->fontStyle();
+  int32_t properties[] = {style.weight(), style.width(), style.slant(),
+                          typeface->countGlyphs(), typeface->getUnitsPerEm()};
+  AppendBytes(id, properties, std::size(properties));
+
+  std::vector<SkFontTableTag> tags(std::max(typeface->countTables(), 0));
+  tags.resize(std::max(typeface->getTableTags(tags.data()), 0));
+  for (SkFontTableTag tag : tags) {
+    uint64_t table_size = typeface->getTableSize(tag);
+    AppendBytes(id, &tag, 1u);
+    AppendBytes(id, &table_size, 1u);
+  }
+
+  int axis_count = typeface->getVariationDesignPosition(nullptr, 0);
+  if (axis_count > 0) {
+    std::vector<SkFontArguments::VariationPosition::Coordinate> coordinates(
+        axis_count);
+    if (typeface->getVariationDesignPosition(coordinates.data(),
+                                             axis_count) == axis_count) {
+      AppendBytes(id, coordinates.data(), coordinates.size());
     }
-    // Position the glyph in the center of the 1px padding.
-    glyph_positions.push_back(Rect::MakeXYWH(
-        location_in_atlas.x() + 1,                      //
-        location_in_atlas.y() + height_adjustment + 1,  //
-        glyph_size.width,                               //
-        glyph_size.height                               //
-        ));
   }
+  return id;
+}
 
-  return extra_pairs.size();
+/// Returns the size of a page of the atlas that can hold a glyph of
+/// |padded_glyph_size|. That is the usual page size unless the glyph is
+/// larger than a usual page.
+static ISize ComputePageSize(ISize padded_glyph_size,
+                             ISize atlas_size,
+                             ISize max_texture_size) {
+  ISize page_size = atlas_size;
+  while (page_size.width < padded_glyph_size.width &&
+         page_size.width < max_texture_size.width) {
+    page_size.width *= 2;
+  }
+  while (page_size.height < padded_glyph_size.height &&
+         page_size.height < max_texture_size.height) {
+    page_size.height *= 2;
+  }
+  return page_size.Min(max_texture_size);
 }
 
-static size_t PairsFitInAtlasOfSize(
-    const std::vector<FontGlyphPair>& pairs,
-    const ISize& atlas_size,
-    std::vector<Rect>& glyph_positions,
-    const std::vector<Rect>& glyph_sizes,
-    int64_t height_adjustment,
-    const std::shared_ptr<RectanglePacker>& rect_packer,
-    size_t start_index) {
-  FML_DCHECK(!atlas_size.IsEmpty());
-
-  for (size_t i = start_index; i < pairs.size(); i++) {
-    ISize glyph_size = ISize::Ceil(glyph_sizes[i].GetSize());
-    IPoint16 location_in_atlas;
-    if (!rect_packer->AddRect(glyph_size.width + kPadding,   //
-                              glyph_size.height + kPadding,  //
-                              &location_in_atlas             //
-                              )) {
-      return i;
-    }
-    glyph_positions.push_back(Rect::MakeXYWH(
-        location_in_atlas.x() + 1,                      //
-        location_in_atlas.y() + height_adjustment + 1,  //
-        glyph_size.width,                               //
-        glyph_size.height                               //
-        ));
+static std::shared_ptr<Texture> CreatePageTexture(Context& context,
+                                                  GlyphAtlas::Type type,
+                                                  ISize size) {
+  TextureDescriptor descriptor;
+  switch (type) {
+    case GlyphAtlas::Type::kAlphaBitmap:
+    case GlyphAtlas::Type::kSignedDistanceField:
+      descriptor.format =
+          context.GetCapabilities()->GetDefaultGlyphAtlasFormat();
+      break;
+    case GlyphAtlas::Type::kColorBitmap:
+      descriptor.format = PixelFormat::kR8G8B8A8UNormInt;
+      break;
+  }
+  descriptor.size = size;
+  descriptor.storage_mode = StorageMode::kDevicePrivate;
+  descriptor.usage = TextureUsage::kShaderRead;
+  std::shared_ptr<Texture> texture =
+      context.GetResourceAllocator()->CreateTexture(descriptor);
+  if (texture) {
+    texture->SetLabel("GlyphAtlas");
   }
+  return texture;
+}
 
-  return pairs.size();
+/// Adds a page of |size| to the atlas and returns its index, or
+/// `std::nullopt` if its texture could not be created.
+static std::optional<size_t> AddPage(Context& context,
+                                     GlyphAtlasContext& atlas_context,
+                                     ISize size) {
+  GlyphAtlas& atlas = *atlas_context.GetGlyphAtlas();
+  std::shared_ptr<Texture> texture =
+      CreatePageTexture(context, atlas.GetType(), size);
+  if (!texture) {
+    return std::nullopt;
+  }
+  size_t page = atlas.AddPage(std::move(texture));
+  size_t context_page = atlas_context.AddPage(
+      RectanglePacker::Factory(size.width, size.height));
+  FML_DCHECK(page == context_page);
+  return page;
 }
 
-static ISize ComputeNextAtlasSize(
-    const std::shared_ptr<GlyphAtlasContext>& atlas_context,
-    const std::vector<FontGlyphPair>& extra_pairs,
-    std::vector<Rect>& glyph_positions,
-    const std::vector<Rect>& glyph_sizes,
-    size_t glyph_index_start,
-    int64_t max_texture_height) {
-  // Because we can't grow the skyline packer horizontally, pick a reasonable
-  // large width for all atlases.
-  static constexpr int64_t kAtlasWidth = 4096;
-  static constexpr int64_t kMinAtlasHeight = 1024;
-
-  ISize current_size = ISize(kAtlasWidth, kMinAtlasHeight);
-  if (atlas_context->GetAtlasSize().height > current_size.height) {
-    current_size.height = atlas_context->GetAtlasSize().height * 2;
-  }
-
-  auto height_adjustment = atlas_context->GetAtlasSize().height;
-  while (current_size.height <= max_texture_height) {
-    std::shared_ptr<RectanglePacker> rect_packer;
-    if (atlas_context->GetRectPacker() || glyph_index_start) {
-      rect_packer = RectanglePacker::Factory(
-          kAtlasWidth,
-          current_size.height - atlas_context->GetAtlasSize().height);
-    } else {
-      rect_packer = RectanglePacker::Factory(kAtlasWidth, current_size.height);
+enum class PlaceGlyphResult {
+  kPlaced,
+  // The glyph is larger than the largest texture and is left out of the
+  // atlas.
+  kTooLarge,
+  // A page could not be added for the glyph.
+  kFailed,
+};
+
+/// Replaces the texture of the emptied |page| with one of |size|, and
+/// returns whether it could be created.
+static bool ResizePage(Context& context,
+                       GlyphAtlasContext& atlas_context,
+                       size_t page,
+                       ISize size) {
+  GlyphAtlas& atlas = *atlas_context.GetGlyphAtlas();
+  std::shared_ptr<Texture> texture =
+      CreatePageTexture(context, atlas.GetType(), size);
+  if (!texture) {
+    return false;
+  }
+  atlas.SetTexture(page, std::move(texture));
+  atlas_context.SetRectPacker(
+      page, RectanglePacker::Factory(size.width, size.height));
+  return true;
+}
+
+/// Finds room for a glyph of |glyph_size| in the first page of the atlas
+/// that has some. When none of them do, a page is added, unless there are
+/// already |GlyphAtlasContext::kMaxPageCount| pages. Then the least recently
+/// used page is emptied and reused instead, with a texture of the size a new
+/// page would have if its own has another size. Pages whose texture is new
+/// are flagged in |new_pages|.
+static PlaceGlyphResult PlaceGlyph(Context& context,
+                                   GlyphAtlasContext& atlas_context,
+                                   ISize glyph_size,
+                                   ISize max_texture_size,
+                                   std::vector<bool>& new_pages,
+                                   size_t& page,
+                                   Rect& position) {
+  ISize padded_size(glyph_size.width + kPadding, glyph_size.height + kPadding);
+  auto try_add = [&](size_t candidate) {
+    IPoint16 location_in_atlas;
+    if (!atlas_context.GetRectPacker(candidate)->AddRect(
+            padded_size.width, padded_size.height, &location_in_atlas)) {
+      return false;
     }
-    glyph_positions.erase(glyph_positions.begin() + glyph_index_start,
-                          glyph_positions.end());
-    atlas_context->UpdateRectPacker(rect_packer);
-    auto next_index = PairsFitInAtlasOfSize(
-        extra_pairs, current_size, glyph_positions, glyph_sizes,
-        height_adjustment, rect_packer, glyph_index_start);
-    if (next_index == extra_pairs.size()) {
-      return current_size;
+    atlas_context.MarkPageUsed(candidate);
+    page = candidate;
+    // Position the glyph in the center of the 1px padding.
+    position = Rect::MakeXYWH(location_in_atlas.x() + 1,  //
+                              location_in_atlas.y() + 1,  //
+                              glyph_size.width,           //
+                              glyph_size.height           //
+    );
+    return true;
+  };
+
+  for (size_t i = 0; i < atlas_context.GetPageCount(); i++) {
+    if (try_add(i)) {
+      return PlaceGlyphResult::kPlaced;
     }
-    current_size = ISize(current_size.width, current_size.height * 2);
   }
-  return {};
+
+  ISize page_size = ComputePageSize(padded_size, atlas_context.GetAtlasSize(),
+                                    max_texture_size);
+  if (padded_size.width > page_size.width ||
+      padded_size.height > page_size.height) {
+    return PlaceGlyphResult::kTooLarge;
+  }
+
+  if (atlas_context.GetPageCount() >= GlyphAtlasContext::kMaxPageCount) {
+    std::optional<size_t> lru_page = atlas_context.FindLeastRecentlyUsedPage();
+    if (lru_page.has_value()) {
+      atlas_context.EvictPage(lru_page.value());
+      // A page that is too small for the glyph, or larger than it needs to
+      // be, gets a texture of the size a new page would have, so that the
+      // budget bounds the memory of the atlas.
+      if (atlas_context.GetGlyphAtlas()
+              ->GetTexture(lru_page.value())
+              ->GetSize() != page_size) {
+        if (!ResizePage(context, atlas_context, lru_page.value(),
+                        page_size)) {
+          return PlaceGlyphResult::kFailed;
+        }
+        new_pages[lru_page.value()] = true;
+      }
+      return try_add(lru_page.value()) ? PlaceGlyphResult::kPlaced
+                                       : PlaceGlyphResult::kTooLarge;
+    }
+    // Every page is used by the glyphs of this frame, so the atlas has to
+    // grow past its budget. The extra pages are released once a frame no
+    // longer uses them.
+  }
+
+  std::optional<size_t> new_page = AddPage(context, atlas_context, page_size);
+  if (!new_page.has_value()) {
+    return PlaceGlyphResult::kFailed;
+  }
+  new_pages.resize(new_page.value() + 1u, false);
+  new_pages[new_page.value()] = true;
+  return try_add(new_page.value()) ? PlaceGlyphResult::kPlaced
+                                   : PlaceGlyphResult::kTooLarge;
 }
 
 static void DrawGlyph(SkCanvas* canvas,
@@ -248,19 +459,24 @@ static void DrawGlyph(SkCanvas* canvas,
   canvas->restore();
 }
 
-/// @brief Batch render to a single surface.
+/// @brief Batch render the glyphs at |indices| of |new_pairs| to a single
+///        surface the size of the texture of a page.
 ///
 /// This is only safe for use when updating a fresh texture.
-static bool BulkUpdateAtlasBitmap(const GlyphAtlas& atlas,
-                                  std::shared_ptr<BlitPass>& blit_pass,
-                                  HostBuffer& host_buffer,
-                                  const std::shared_ptr<Texture>& texture,
-                                  const std::vector<FontGlyphPair>& new_pairs,
-                                  size_t start_index,
-                                  size_t end_index) {
+static bool BulkUpdateAtlasBitmap(
+    const GlyphAtlas& atlas,
+    std::shared_ptr<BlitPass>& blit_pass,
+    HostBuffer& host_buffer,
+    const std::shared_ptr<Texture>& texture,
+    const std::vector<FontGlyphPair>& new_pairs,
+    const std::vector<size_t>& indices,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& worker_task_runner,
+    const GlyphDrawnCallback& on_glyph_drawn) {
   TRACE_EVENT0("impeller", __FUNCTION__);
 
   bool has_color = atlas.GetType() == GlyphAtlas::Type::kColorBitmap;
+  bool is_distance_field =
+      atlas.GetType() == GlyphAtlas::Type::kSignedDistanceField;
 
   SkBitmap bitmap;
   bitmap.setInfo(GetImageInfo(atlas, Size(texture->GetSize())));
@@ -268,39 +484,66 @@ static bool BulkUpdateAtlasBitmap(const GlyphAtlas& atlas,
     return false;
   }
 
-  auto surface = SkSurfaces::WrapPixels(bitmap.pixmap());
-  if (!surface) {
-    return false;
-  }
-  auto canvas = surface->getCanvas();
-  if (!canvas) {
+  // Each batch draws into a surface of its own, and every glyph is clipped
+  // to its padded cell in the atlas so that batches drawn concurrently
+  // never write the same pixels.
+  std::atomic<bool> failed{false};
+  DrawGlyphBatches(
+      indices.size(), worker_task_runner, [&](size_t begin, size_t end) {
+        auto surface = SkSurfaces::WrapPixels(bitmap.pixmap());
+        auto canvas = surface ? surface->getCanvas() : nullptr;
+        if (!canvas) {
+          failed = true;
+          return;
+        }
+        for (size_t i = begin; i < end; i++) {
+          const FontGlyphPair& pair = new_pairs[indices[i]];
+          auto data = atlas.FindFontGlyphBounds(pair);
+          if (!data.has_value()) {
+            continue;
+          }
+          auto [pos, bounds] = data.value();
+          Size size = pos.GetSize();
+          if (size.IsEmpty()) {
+            continue;
+          }
+
+          canvas->save();
+          canvas->clipRect(SkRect::MakeXYWH(pos.GetLeft() - 1,
+                                            pos.GetTop() - 1, size.width + 2,
+                                            size.height + 2));
+          DrawGlyph(canvas, SkPoint::Make(pos.GetLeft(), pos.GetTop()),
+                    pair.scaled_font, pair.glyph, bounds,
+                    pair.glyph.properties, has_color);
+          canvas->restore();
+          if (is_distance_field) {
+            ConvertCoverageToSignedDistanceField(
+                bitmap.getAddr8(static_cast<int>(pos.GetLeft()),
+                                static_cast<int>(pos.GetTop())),
+                static_cast<size_t>(size.width),
+                static_cast<size_t>(size.height), bitmap.rowBytes(),
+                GlyphAtlas::kDistanceFieldSpread);
+          }
+          if (on_glyph_drawn) {
+            on_glyph_drawn(
+                indices[i],
+                static_cast<const uint8_t*>(
+                    bitmap.getAddr(static_cast<int>(pos.GetLeft()),
+                                   static_cast<int>(pos.GetTop()))),
+                bitmap.rowBytes(), ISize::Ceil(size));
+          }
+        }
+      });
+  if (failed) {
     return false;
   }
 
-  for (size_t i = start_index; i < end_index; i++) {
-    const FontGlyphPair& pair = new_pairs[i];
-    auto data = atlas.FindFontGlyphBounds(pair);
-    if (!data.has_value()) {
-      continue;
-    }
-    auto [pos, bounds] = data.value();
-    Size size = pos.GetSize();
-    if (size.IsEmpty()) {
-      continue;
-    }
-
-    DrawGlyph(canvas, SkPoint::Make(pos.GetLeft(), pos.GetTop()),
-              pair.scaled_font, pair.glyph, bounds, pair.glyph.properties,
-              has_color);
-  }
-
   // Writing to a malloc'd buffer and then copying to the staging buffers
   // benchmarks as substantially faster on a number of Android devices.
   BufferView buffer_view = host_buffer.Emplace(
       bitmap.getAddr(0, 0),
       texture->GetSize().Area() *
-          BytesPerPixelForPixelFormat(
-              atlas.GetTexture()->GetTextureDescriptor().format),
+          BytesPerPixelForPixelFormat(texture->GetTextureDescriptor().format),
       DefaultUniformAlignment());
 
   return blit_pass->AddCopy(std::move(buffer_view),  //
@@ -309,19 +552,39 @@ static bool BulkUpdateAtlasBitmap(const GlyphAtlas& atlas,
                                             texture->GetSize().height));
 }
 
-static bool UpdateAtlasBitmap(const GlyphAtlas& atlas,
-                              std::shared_ptr<BlitPass>& blit_pass,
-                              HostBuffer& host_buffer,
-                              const std::shared_ptr<Texture>& texture,
-                              const std::vector<FontGlyphPair>& new_pairs,
-                              size_t start_index,
-                              size_t end_index) {
+/// Renders the glyphs at |indices| of |new_pairs| into a single staging
+/// buffer, each into its own tightly packed block of pixels that is
+/// expanded by 1px of padding on each side, and copies the blocks to their
+/// places in the existing texture of a page.
+static bool UpdateAtlasBitmap(
+    const GlyphAtlas& atlas,
+    std::shared_ptr<BlitPass>& blit_pass,
+    HostBuffer& host_buffer,
+    const std::shared_ptr<Texture>& texture,
+    const std::vector<FontGlyphPair>& new_pairs,
+    const std::vector<size_t>& indices,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& worker_task_runner,
+    const GlyphDrawnCallback& on_glyph_drawn) {
   TRACE_EVENT0("impeller", __FUNCTION__);
 
   bool has_color = atlas.GetType() == GlyphAtlas::Type::kColorBitmap;
-
-  for (size_t i = start_index; i < end_index; i++) {
-    const FontGlyphPair& pair = new_pairs[i];
+  bool is_distance_field =
+      atlas.GetType() == GlyphAtlas::Type::kSignedDistanceField;
+  size_t bytes_per_pixel =
+      BytesPerPixelForPixelFormat(texture->GetTextureDescriptor().format);
+
+  struct StagedGlyph {
+    size_t index;
+    const FontGlyphPair* pair;
+    Rect bounds;
+    IRect region;
+    size_t offset;
+  };
+  std::vector<StagedGlyph> staged_glyphs;
+  staged_glyphs.reserve(indices.size());
+  size_t staging_size = 0u;
+  for (size_t index : indices) {
+    const FontGlyphPair& pair = new_pairs[index];
     auto data = atlas.FindFontGlyphBounds(pair);
     if (!data.has_value()) {
       continue;
@@ -333,47 +596,81 @@ static bool UpdateAtlasBitmap(const GlyphAtlas& atlas,
     }
     // The uploaded bitmap is expanded by 1px of padding
     // on each side.
-    size.width += 2;
-    size.height += 2;
-
-    SkBitmap bitmap;
-    bitmap.setInfo(GetImageInfo(atlas, size));
-    if (!bitmap.tryAllocPixels()) {
-      return false;
-    }
-
-    auto surface = SkSurfaces::WrapPixels(bitmap.pixmap());
-    if (!surface) {
-      return false;
-    }
-    auto canvas = surface->getCanvas();
-    if (!canvas) {
-      return false;
-    }
-
-    DrawGlyph(canvas, SkPoint::Make(1, 1), pair.scaled_font, pair.glyph, bounds,
-              pair.glyph.properties, has_color);
+    IRect region =
+        IRect::MakeXYWH(pos.GetLeft() - 1, pos.GetTop() - 1,
+                        size.width + 2, size.height + 2);
+    staging_size = (staging_size + kGlyphStagingAlignment - 1u) /
+                   kGlyphStagingAlignment * kGlyphStagingAlignment;
+    staged_glyphs.push_back({index, &pair, bounds, region, staging_size});
+    staging_size += region.Area() * bytes_per_pixel;
+  }
+  if (staged_glyphs.empty()) {
+    return blit_pass->ConvertTextureToShaderRead(texture);
+  }
 
-    // Writing to a malloc'd buffer and then copying to the staging buffers
-    // benchmarks as substantially faster on a number of Android devices.
-    BufferView buffer_view = host_buffer.Emplace(
-        bitmap.getAddr(0, 0),
-        size.Area() * BytesPerPixelForPixelFormat(
-                          atlas.GetTexture()->GetTextureDescriptor().format),
-        DefaultUniformAlignment());
+  // Writing to a malloc'd buffer and then copying to the staging buffers
+  // benchmarks as substantially faster on a number of Android devices.
+  std::vector<uint8_t> staging(staging_size, 0u);
+  std::atomic<bool> failed{false};
+  DrawGlyphBatches(
+      staged_glyphs.size(), worker_task_runner,
+      [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+          const StagedGlyph& glyph = staged_glyphs[i];
+          SkImageInfo info = GetImageInfo(
+              atlas, Size(glyph.region.GetWidth(), glyph.region.GetHeight()));
+          auto surface = SkSurfaces::WrapPixels(
+              info, staging.data() + glyph.offset, info.minRowBytes());
+          auto canvas = surface ? surface->getCanvas() : nullptr;
+          if (!canvas) {
+            failed = true;
+            return;
+          }
+          DrawGlyph(canvas, SkPoint::Make(1, 1), glyph.pair->scaled_font,
+                    glyph.pair->glyph, glyph.bounds,
+                    glyph.pair->glyph.properties, has_color);
+          if (is_distance_field) {
+            // Leave the padding empty.
+            ConvertCoverageToSignedDistanceField(
+                staging.data() + glyph.offset + info.minRowBytes() + 1u,
+                glyph.region.GetWidth() - 2, glyph.region.GetHeight() - 2,
+                info.minRowBytes(), GlyphAtlas::kDistanceFieldSpread);
+          }
+          if (on_glyph_drawn) {
+            // Leave out the padding.
+            on_glyph_drawn(glyph.index,
+                           staging.data() + glyph.offset + info.minRowBytes() +
+                               info.bytesPerPixel(),
+                           info.minRowBytes(),
+                           ISize(glyph.region.GetWidth() - 2,
+                                 glyph.region.GetHeight() - 2));
+          }
+        }
+      });
+  if (failed) {
+    return false;
+  }
 
-    // convert_to_read is set to false so that the texture remains in a transfer
-    // dst layout until we finish writing to it below. This only has an impact
-    // on Vulkan where we are responsible for managing image layouts.
+  BufferView staging_view = host_buffer.Emplace(
+      staging.data(), staging.size(), DefaultUniformAlignment());
+  if (!staging_view) {
+    return false;
+  }
+  for (const StagedGlyph& glyph : staged_glyphs) {
+    BufferView buffer_view = staging_view;
+    buffer_view.range = Range(staging_view.range.offset + glyph.offset,
+                              glyph.region.Area() * bytes_per_pixel);
+    // convert_to_read is set to false so that the texture remains in a
+    // transfer dst layout until we finish writing to it below. This only has
+    // an impact on Vulkan where we are responsible for managing image
+    // layouts.
     if (!blit_pass->AddCopy(std::move(buffer_view),  //
                             texture,                 //
-                            IRect::MakeXYWH(pos.GetLeft() - 1, pos.GetTop() - 1,
-                                            size.width, size.height),  //
-                            /*label=*/"",                              //
-                            /*mip_level=*/0,                           //
-                            /*slice=*/0,                               //
-                            /*convert_to_read=*/false                  //
-                            )) {
+                            glyph.region,            //
+                            /*label=*/"",            //
+                            /*mip_level=*/0,         //
+                            /*slice=*/0,             //
+                            /*convert_to_read=*/false)) {
       return false;
     }
   }
@@ -404,14 +701,25 @@ static Rect ComputeGlyphSize(const SkFont& font,
                         scaled_bounds.fBottom);
 };
 
-static void CollectNewGlyphs(const std::shared_ptr<GlyphAtlas>& atlas,
+/// Collects the glyphs of |font_glyph_map| that are not in the atlas yet,
+/// and records that the ones that are, and their pages, are used by the
+/// current frame.
+///
+/// With a disk cache, glyphs that are in the restored pages of the atlas
+/// are added to it without being drawn, and the disk cache keys of the new
+/// glyphs are collected into |glyph_keys|.
+static void CollectNewGlyphs(GlyphAtlasContext& atlas_context,
                              const FontGlyphMap& font_glyph_map,
                              std::vector<FontGlyphPair>& new_glyphs,
-                             std::vector<Rect>& glyph_sizes) {
+                             std::vector<Rect>& glyph_sizes,
+                             std::vector<std::string>& glyph_keys) {
+  GlyphAtlas& atlas = *atlas_context.GetGlyphAtlas();
+  uint64_t frame = atlas_context.GetCurrentFrame();
+  const GlyphAtlasDiskCache* disk_cache = atlas_context.GetDiskCache().get();
   for (const auto& font_value : font_glyph_map) {
     const ScaledFont& scaled_font = font_value.first;
-    const FontGlyphAtlas* font_glyph_atlas =
-        atlas->GetFontGlyphAtlas(scaled_font.font, scaled_font.scale);
+    FontGlyphAtlas* font_glyph_atlas =
+        atlas.GetFontGlyphAtlas(scaled_font.font, scaled_font.scale);
 
     auto metrics = scaled_font.font.GetMetrics();
 
@@ -427,22 +735,180 @@ static void CollectNewGlyphs(const std::shared_ptr<GlyphAtlas>& atlas,
     sk_font.setSize(sk_font.getSize() * scaled_font.scale);
     sk_font.setSubpixel(true);
 
-    if (font_glyph_atlas) {
-      for (const SubpixelGlyph& glyph : font_value.second) {
-        if (!font_glyph_atlas->FindGlyphBounds(glyph)) {
-          new_glyphs.emplace_back(scaled_font, glyph);
-          glyph_sizes.push_back(
-              ComputeGlyphSize(sk_font, glyph, scaled_font.scale));
+    // Only computed for fonts with glyphs that are not in the atlas.
+    std::optional<std::string> typeface_id;
+    for (const SubpixelGlyph& glyph : font_value.second) {
+      GlyphAtlasEntry* entry =
+          font_glyph_atlas ? font_glyph_atlas->FindGlyph(glyph) : nullptr;
+      if (entry) {
+        entry->last_used_frame = frame;
+        atlas_context.MarkPageUsed(entry->page);
+        continue;
+      }
+      if (disk_cache) {
+        if (!typeface_id.has_value()) {
+          typeface_id = GetPersistentTypefaceId(scaled_font.font);
+        }
+        std::string key = GlyphAtlasDiskCache::ComputeKey(
+            typeface_id.value(), scaled_font, glyph);
+        const GlyphAtlasDiskCache::Glyph* cached = disk_cache->FindGlyph(key);
+        if (cached && cached->page < atlas.GetPageCount()) {
+          const IRect& position = cached->position;
+          atlas.AddTypefaceGlyphPositionAndBounds(
+              FontGlyphPair(scaled_font, glyph),
+              Rect::MakeXYWH(position.GetX(), position.GetY(),
+                             position.GetWidth(), position.GetHeight()),
+              cached->bounds, cached->page, frame);
+          atlas_context.MarkPageUsed(cached->page);
+          continue;
         }
+        glyph_keys.push_back(std::move(key));
+      }
+      new_glyphs.emplace_back(scaled_font, glyph);
+      Rect glyph_size = ComputeGlyphSize(sk_font, glyph, scaled_font.scale);
+      if (atlas.GetType() == GlyphAtlas::Type::kSignedDistanceField &&
+          !glyph_size.IsEmpty()) {
+        // Make room for the distance field outside of the outline.
+        glyph_size = glyph_size.Expand(GlyphAtlas::kDistanceFieldSpread);
+      }
+      glyph_sizes.push_back(glyph_size);
+    }
+  }
+}
+
+/// Adds the pages kept by the disk cache of |atlas_context| to its empty
+/// atlas, with their packers where they left off and the pixels of their
+/// glyphs uploaded. The glyphs themselves are added to the atlas by
+/// |CollectNewGlyphs| as frames use them.
+static bool RestoreGlyphAtlas(Context& context,
+                              HostBuffer& host_buffer,
+                              GlyphAtlasContext& atlas_context) {
+  TRACE_EVENT0("impeller", __FUNCTION__);
+  GlyphAtlas& atlas = *atlas_context.GetGlyphAtlas();
+  const GlyphAtlasDiskCache& disk_cache = *atlas_context.GetDiskCache();
+  FML_DCHECK(atlas.GetPageCount() == 0u);
+
+  const ISize max_texture_size =
+      context.GetResourceAllocator()->GetMaxTextureSizeSupported();
+  const ISize& atlas_size = disk_cache.GetAtlasSize();
+  if (atlas_size.IsEmpty() || atlas_size.width > max_texture_size.width ||
+      atlas_size.height > max_texture_size.height) {
+    return false;
+  }
+
+  std::shared_ptr<CommandBuffer> cmd_buffer = context.CreateCommandBuffer();
+  std::shared_ptr<BlitPass> blit_pass =
+      cmd_buffer ? cmd_buffer->CreateBlitPass() : nullptr;
+  if (!blit_pass) {
+    return false;
+  }
+
+  struct RestoredPage {
+    std::shared_ptr<Texture> texture;
+    std::shared_ptr<RectanglePacker> rect_packer;
+  };
+  std::vector<RestoredPage> pages;
+  const std::vector<GlyphAtlasDiskCache::Page>& cached_pages =
+      disk_cache.GetPages();
+  for (size_t i = 0; i < cached_pages.size(); i++) {
+    const ISize& size = cached_pages[i].size;
+    if (size.width > max_texture_size.width ||
+        size.height > max_texture_size.height) {
+      return false;
+    }
+    std::shared_ptr<Texture> texture =
+        CreatePageTexture(context, atlas.GetType(), size);
+    std::shared_ptr<RectanglePacker> rect_packer =
+        RectanglePacker::Factory(size.width, size.height);
+    if (!texture || !rect_packer ||
+        !rect_packer->SetState(cached_pages[i].packer_state)) {
+      return false;
+    }
+
+    // The pixels between the glyphs are left empty, like those of a page
+    // uploaded by |BulkUpdateAtlasBitmap|.
+    size_t bytes_per_pixel =
+        BytesPerPixelForPixelFormat(texture->GetTextureDescriptor().format);
+    size_t row_bytes = size.width * bytes_per_pixel;
+    std::vector<uint8_t> pixels(size.height * row_bytes, 0u);
+    disk_cache.VisitPageGlyphs(i, [&](const GlyphAtlasDiskCache::Glyph& glyph) {
+      const IRect& position = glyph.position;
+      size_t glyph_row_bytes = position.GetWidth() * bytes_per_pixel;
+      if (glyph.pixels->size() != position.GetHeight() * glyph_row_bytes) {
+        return;
       }
-    } else {
-      for (const SubpixelGlyph& glyph : font_value.second) {
-        new_glyphs.emplace_back(scaled_font, glyph);
-        glyph_sizes.push_back(
-            ComputeGlyphSize(sk_font, glyph, scaled_font.scale));
+      for (int64_t y = 0; y < position.GetHeight(); y++) {
+        memcpy(pixels.data() + (position.GetY() + y) * row_bytes +
+                   position.GetX() * bytes_per_pixel,
+               glyph.pixels->data() + y * glyph_row_bytes, glyph_row_bytes);
       }
+    });
+    BufferView buffer_view = host_buffer.Emplace(pixels.data(), pixels.size(),
+                                                 DefaultUniformAlignment());
+    if (!buffer_view ||
+        !blit_pass->AddCopy(std::move(buffer_view), texture,
+                            IRect::MakeXYWH(0, 0, size.width, size.height))) {
+      return false;
     }
+    pages.push_back({std::move(texture), std::move(rect_packer)});
   }
+
+  if (!blit_pass->EncodeCommands(context.GetResourceAllocator()) ||
+      !context.EnqueueCommandBuffer(std::move(cmd_buffer))) {
+    return false;
+  }
+  atlas_context.SetAtlasSize(atlas_size);
+  for (RestoredPage& page : pages) {
+    size_t index = atlas.AddPage(std::move(page.texture));
+    size_t context_index = atlas_context.AddPage(std::move(page.rect_packer));
+    FML_DCHECK(index == context_index);
+  }
+  return true;
+}
+
+/// Records the new glyphs that have disk cache keys, and the pages of the
+/// atlas they are in, in the disk cache of |atlas_context|.
+static void UpdateDiskCache(
+    GlyphAtlasContext& atlas_context,
+    const std::vector<FontGlyphPair>& new_glyphs,
+    const std::vector<std::string>& glyph_keys,
+    const std::vector<std::vector<size_t>>& page_glyphs,
+    const std::vector<std::shared_ptr<const std::vector<uint8_t>>>&
+        glyph_pixels) {
+  TRACE_EVENT0("impeller", __FUNCTION__);
+  const GlyphAtlas& atlas = *atlas_context.GetGlyphAtlas();
+  GlyphAtlasDiskCache& disk_cache = *atlas_context.GetDiskCache();
+  for (size_t page = 0; page < page_glyphs.size(); page++) {
+    for (size_t i : page_glyphs[page]) {
+      if (glyph_keys[i].empty()) {
+        continue;
+      }
+      auto data = atlas.FindFontGlyphBounds(new_glyphs[i]);
+      if (!data.has_value()) {
+        continue;
+      }
+      auto [pos, bounds] = data.value();
+      GlyphAtlasDiskCache::Glyph glyph;
+      glyph.page = page;
+      glyph.position = IRect::MakeXYWH(pos.GetX(), pos.GetY(), pos.GetWidth(),
+                                       pos.GetHeight());
+      glyph.bounds = bounds;
+      glyph.pixels = glyph_pixels[i];
+      if (!glyph.pixels && glyph.position.IsEmpty()) {
+        // Empty glyphs are not drawn.
+        glyph.pixels = std::make_shared<std::vector<uint8_t>>();
+      }
+      disk_cache.AddGlyph(glyph_keys[i], std::move(glyph));
+    }
+  }
+
+  std::vector<GlyphAtlasDiskCache::Page> pages;
+  pages.reserve(atlas_context.GetPageCount());
+  for (size_t i = 0; i < atlas_context.GetPageCount(); i++) {
+    pages.push_back({atlas.GetTexture(i)->GetSize(),
+                     atlas_context.GetRectPacker(i)->GetState()});
+  }
+  disk_cache.SetPages(atlas_context.GetAtlasSize(), std::move(pages));
 }
 
 std::shared_ptr<GlyphAtlas> TypographerContextSkia::CreateGlyphAtlas(
@@ -455,139 +921,90 @@ std::shared_ptr<GlyphAtlas> TypographerContextSkia::CreateGlyphAtlas(
   if (!IsValid()) {
     return nullptr;
   }
-  std::shared_ptr<GlyphAtlas> last_atlas = atlas_context->GetGlyphAtlas();
-  FML_DCHECK(last_atlas->GetType() == type);
-
+  std::shared_ptr<GlyphAtlas> atlas = atlas_context->GetGlyphAtlas();
+  FML_DCHECK(atlas->GetType() == type);
+
+  uint64_t frame = atlas_context->BeginFrame();
+  const std::shared_ptr<GlyphAtlasDiskCache>& disk_cache =
+      atlas_context->GetDiskCache();
+  // The glyphs added by earlier frames are written once frames stop adding
+  // glyphs.
+  if (disk_cache) {
+    disk_cache->StoreIfNeeded();
+  }
   if (font_glyph_map.empty()) {
-    return last_atlas;
+    return atlas;
+  }
+
+  if (disk_cache && atlas->GetPageCount() == 0u &&
+      !disk_cache->GetPages().empty() &&
+      !RestoreGlyphAtlas(context, host_buffer, *atlas_context)) {
+    FML_LOG(WARNING) << "Could not restore the glyph atlas from disk.";
+    disk_cache->Clear();
   }
 
   // ---------------------------------------------------------------------------
-  // Step 1: Determine if the atlas type and font glyph pairs are compatible
-  //         with the current atlas and reuse if possible. For each new font and
-  //         glyph pair, compute the glyph size at scale.
+  // Step 1: Determine which font glyph pairs are already in the atlas, and
+  //         mark them as used by this frame. For each new font and glyph
+  //         pair, compute the glyph size at scale.
   // ---------------------------------------------------------------------------
   std::vector<FontGlyphPair> new_glyphs;
   std::vector<Rect> glyph_sizes;
-  CollectNewGlyphs(last_atlas, font_glyph_map, new_glyphs, glyph_sizes);
+  std::vector<std::string> glyph_keys;
+  CollectNewGlyphs(*atlas_context, font_glyph_map, new_glyphs, glyph_sizes,
+                   glyph_keys);
+  // Pages added past the budget by an earlier frame are released as soon as
+  // a frame no longer uses them.
+  atlas_context->ReleaseUnusedPages();
   if (new_glyphs.size() == 0) {
-    return last_atlas;
+    return atlas;
   }
 
   // ---------------------------------------------------------------------------
-  // Step 2: Determine if the additional missing glyphs can be appended to the
-  //         existing bitmap without recreating the atlas.
+  // Step 2: Find room for the new glyphs in the pages of the atlas, adding
+  //         pages or reusing the least recently used ones as needed, and
+  //         record their positions.
   // ---------------------------------------------------------------------------
-  std::vector<Rect> glyph_positions;
-  glyph_positions.reserve(new_glyphs.size());
-  size_t first_missing_index = 0;
-
-  if (last_atlas->GetTexture()) {
-    // Append all glyphs that fit into the current atlas.
-    first_missing_index = AppendToExistingAtlas(
-        last_atlas, new_glyphs, glyph_positions, glyph_sizes,
-        atlas_context->GetAtlasSize(), atlas_context->GetHeightAdjustment(),
-        atlas_context->GetRectPacker());
-
-    // ---------------------------------------------------------------------------
-    // Step 3a: Record the positions in the glyph atlas of the newly added
-    //          glyphs.
-    // ---------------------------------------------------------------------------
-    for (size_t i = 0; i < first_missing_index; i++) {
-      last_atlas->AddTypefaceGlyphPositionAndBounds(
-          new_glyphs[i], glyph_positions[i], glyph_sizes[i]);
-    }
-
-    std::shared_ptr<CommandBuffer> cmd_buffer = context.CreateCommandBuffer();
-    std::shared_ptr<BlitPass> blit_pass = cmd_buffer->CreateBlitPass();
-
-    fml::ScopedCleanupClosure closure([&]() {
-      blit_pass->EncodeCommands(context.GetResourceAllocator());
-      if (!context.EnqueueCommandBuffer(std::move(cmd_buffer))) {
-        VALIDATION_LOG << "Failed to submit glyph atlas command buffer";
-      }
-    });
+  const ISize max_texture_size =
+      context.GetResourceAllocator()->GetMaxTextureSizeSupported();
+  if (atlas_context->GetAtlasSize().IsEmpty()) {
+    // Because we can't grow the skyline packer horizontally, pick a
+    // reasonable large width for all pages.
+    static constexpr int64_t kAtlasWidth = 4096;
+    static constexpr int64_t kAtlasHeight = 1024;
+    // The glyphs of a signed distance field atlas have the same size at any
+    // scale, so far fewer of them are needed.
+    static constexpr int64_t kDistanceFieldAtlasWidth = 2048;
+    ISize atlas_size =
+        type == GlyphAtlas::Type::kSignedDistanceField
+            ? ISize(kDistanceFieldAtlasWidth, kAtlasHeight)
+            : ISize(kAtlasWidth, kAtlasHeight);
+    atlas_context->SetAtlasSize(atlas_size.Min(max_texture_size));
+  }
 
-    // ---------------------------------------------------------------------------
-    // Step 4a: Draw new font-glyph pairs into the a host buffer and encode
-    // the uploads into the blit pass.
-    // ---------------------------------------------------------------------------
-    if (!UpdateAtlasBitmap(*last_atlas, blit_pass, host_buffer,
-                           last_atlas->GetTexture(), new_glyphs, 0,
-                           first_missing_index)) {
-      return nullptr;
+  std::vector<bool> new_pages(atlas->GetPageCount(), false);
+  std::vector<std::vector<size_t>> page_glyphs(atlas->GetPageCount());
+  for (size_t i = 0; i < new_glyphs.size(); i++) {
+    size_t page = 0u;
+    Rect position;
+    switch (PlaceGlyph(context, *atlas_context,
+                       ISize::Ceil(glyph_sizes[i].GetSize()),
+                       max_texture_size, new_pages, page, position)) {
+      case PlaceGlyphResult::kPlaced:
+        break;
+      case PlaceGlyphResult::kTooLarge:
+        continue;
+      case PlaceGlyphResult::kFailed:
+        return nullptr;
     }
-
-    // If all glyphs fit, just return the old atlas.
-    if (first_missing_index == new_glyphs.size()) {
-      return last_atlas;
+    atlas->AddTypefaceGlyphPositionAndBounds(new_glyphs[i], position,
+                                             glyph_sizes[i], page, frame);
+    if (page >= page_glyphs.size()) {
+      page_glyphs.resize(page + 1u);
     }
+    page_glyphs[page].push_back(i);
   }
 
-  int64_t height_adjustment = atlas_context->GetAtlasSize().height;
-  const int64_t max_texture_height =
-      context.GetResourceAllocator()->GetMaxTextureSizeSupported().height;
-
-  // IF the current atlas size is as big as it can get, then "GC" and create an
-  // atlas with only the required glyphs. OpenGLES cannot reliably perform the
-  // blit required here, as 1) it requires attaching textures as read and write
-  // framebuffers which has substantially smaller size limits that max textures
-  // and 2) is missing a GLES 2.0 implementation and cap check.
-  bool blit_old_atlas = true;
-  std::shared_ptr<GlyphAtlas> new_atlas = last_atlas;
-  if (atlas_context->GetAtlasSize().height >= max_texture_height ||
-      context.GetBackendType() == Context::BackendType::kOpenGLES) {
-    blit_old_atlas = false;
-    new_atlas = std::make_shared<GlyphAtlas>(type);
-
-    new_glyphs.clear();
-    glyph_sizes.clear();
-    CollectNewGlyphs(new_atlas, font_glyph_map, new_glyphs, glyph_sizes);
-    glyph_positions.clear();
-    glyph_positions.reserve(new_glyphs.size());
-    first_missing_index = 0;
-
-    height_adjustment = 0;
-    atlas_context->UpdateRectPacker(nullptr);
-    atlas_context->UpdateGlyphAtlas(new_atlas, {0, 0}, 0);
-  }
-
-  // A new glyph atlas must be created.
-  ISize atlas_size = ComputeNextAtlasSize(atlas_context,        //
-                                          new_glyphs,           //
-                                          glyph_positions,      //
-                                          glyph_sizes,          //
-                                          first_missing_index,  //
-                                          max_texture_height    //
-  );
-
-  atlas_context->UpdateGlyphAtlas(new_atlas, atlas_size, height_adjustment);
-  if (atlas_size.IsEmpty()) {
-    return nullptr;
-  }
-  FML_DCHECK(new_glyphs.size() == glyph_positions.size());
-
-  TextureDescriptor descriptor;
-  switch (type) {
-    case GlyphAtlas::Type::kAlphaBitmap:
-      descriptor.format =
-          context.GetCapabilities()->GetDefaultGlyphAtlasFormat();
-      break;
-    case GlyphAtlas::Type::kColorBitmap:
-      descriptor.format = PixelFormat::kR8G8B8A8UNormInt;
-      break;
-  }
-  descriptor.size = atlas_size;
-  descriptor.storage_mode = StorageMode::kDevicePrivate;
-  descriptor.usage = TextureUsage::kShaderRead;
-  std::shared_ptr<Texture> new_texture =
-      context.GetResourceAllocator()->CreateTexture(descriptor);
-  if (!new_texture) {
-    return nullptr;
-  }
-
-  new_texture->SetLabel("GlyphAtlas");
-
   std::shared_ptr<CommandBuffer> cmd_buffer = context.CreateCommandBuffer();
   std::shared_ptr<BlitPass> blit_pass = cmd_buffer->CreateBlitPass();
 
@@ -598,41 +1015,80 @@ std::shared_ptr<GlyphAtlas> TypographerContextSkia::CreateGlyphAtlas(
     }
   });
 
-  // Now append all remaining glyphs. This should never have any missing data...
-  auto old_texture = new_atlas->GetTexture();
-  new_atlas->SetTexture(std::move(new_texture));
-
   // ---------------------------------------------------------------------------
-  // Step 3a: Record the positions in the glyph atlas of the newly added
-  //          glyphs.
+  // Step 3: Draw new font-glyph pairs into the a host buffer and encode
+  //         the uploads into the blit pass. New pages are uploaded as a
+  //         whole, the existing pages only where the new glyphs are.
   // ---------------------------------------------------------------------------
-  for (size_t i = first_missing_index; i < glyph_positions.size(); i++) {
-    new_atlas->AddTypefaceGlyphPositionAndBounds(
-        new_glyphs[i], glyph_positions[i], glyph_sizes[i]);
+  // The pixels of the glyphs that are kept on disk are copied as they are
+  // drawn. Each glyph is drawn once, so the copies do not race.
+  std::vector<std::shared_ptr<const std::vector<uint8_t>>> glyph_pixels;
+  GlyphDrawnCallback on_glyph_drawn;
+  if (disk_cache) {
+    glyph_pixels.resize(new_glyphs.size());
+    size_t bytes_per_pixel = GetImageInfo(*atlas, Size()).bytesPerPixel();
+    on_glyph_drawn = [&glyph_pixels, &glyph_keys, bytes_per_pixel](
+                         size_t index, const uint8_t* pixels,
+                         size_t row_bytes, ISize size) {
+      if (glyph_keys[index].empty()) {
+        return;
+      }
+      size_t glyph_row_bytes = size.width * bytes_per_pixel;
+      auto copy = std::make_shared<std::vector<uint8_t>>(size.height *
+                                                         glyph_row_bytes);
+      for (int64_t y = 0; y < size.height; y++) {
+        memcpy(copy->data() + y * glyph_row_bytes, pixels + y * row_bytes,
+               glyph_row_bytes);
+      }
+      glyph_pixels[index] = std::move(copy);
+    };
   }
-
-  // ---------------------------------------------------------------------------
-  // Step 4a: Draw new font-glyph pairs into the a host buffer and encode
-  // the uploads into the blit pass.
-  // ---------------------------------------------------------------------------
-  if (!BulkUpdateAtlasBitmap(*new_atlas, blit_pass, host_buffer,
-                             new_atlas->GetTexture(), new_glyphs,
-                             first_missing_index, new_glyphs.size())) {
-    return nullptr;
+  for (size_t page = 0; page < page_glyphs.size(); page++) {
+    if (page_glyphs[page].empty()) {
+      continue;
+    }
+    const std::shared_ptr<Texture>& texture = atlas->GetTexture(page);
+    bool updated =
+        new_pages[page]
+            ? BulkUpdateAtlasBitmap(*atlas, blit_pass, host_buffer, texture,
+                                    new_glyphs, page_glyphs[page],
+                                    worker_task_runner_, on_glyph_drawn)
+            : UpdateAtlasBitmap(*atlas, blit_pass, host_buffer, texture,
+                                new_glyphs, page_glyphs[page],
+                                worker_task_runner_, on_glyph_drawn);
+    if (!updated) {
+      return nullptr;
+    }
   }
 
-  // Blit the old texture to the top left of the new atlas.
-  if (blit_old_atlas && old_texture) {
-    blit_pass->AddCopy(old_texture, new_atlas->GetTexture(),
-                       IRect::MakeSize(new_atlas->GetTexture()->GetSize()),
-                       {0, 0});
+  if (disk_cache) {
+    UpdateDiskCache(*atlas_context, new_glyphs, glyph_keys, page_glyphs,
+                    glyph_pixels);
   }
 
-  // ---------------------------------------------------------------------------
-  // Step 8b: Record the texture in the glyph atlas.
-  // ---------------------------------------------------------------------------
-
-  return new_atlas;
+#if !FLUTTER_RELEASE
+  const char* counter_name = "GlyphAtlas";
+  switch (type) {
+    case GlyphAtlas::Type::kAlphaBitmap:
+      break;
+    case GlyphAtlas::Type::kColorBitmap:
+      counter_name = "ColorGlyphAtlas";
+      break;
+    case GlyphAtlas::Type::kSignedDistanceField:
+      counter_name = "DistanceFieldGlyphAtlas";
+      break;
+  }
+  FML_TRACE_COUNTER(
+      "impeller", counter_name,
+      reinterpret_cast<int64_t>(atlas_context.get()),  //
+      "Pages", atlas->GetPageCount(),                  //
+      "OccupancyPercent",
+      static_cast<int64_t>(atlas_context->GetOccupancy() * 100),  //
+      "EvictedPages", atlas_context->GetEvictedPageCount(),       //
+      "EvictedGlyphs", atlas_context->GetEvictedGlyphCount());
+#endif  // !FLUTTER_RELEASE
+
+  return atlas;
 }
 
 }  // namespace impeller
@@ -5,15 +5,26 @@
 #ifndef FLUTTER_IMPELLER_TYPOGRAPHER_BACKENDS_SKIA_TYPOGRAPHER_CONTEXT_SKIA_H_
 #define FLUTTER_IMPELLER_TYPOGRAPHER_BACKENDS_SKIA_TYPOGRAPHER_CONTEXT_SKIA_H_
 
+#include <memory>
+
 #include "impeller/typographer/typographer_context.h"
 
+namespace fml {
+class ConcurrentTaskRunner;
+}  // namespace fml
+
 namespace impeller {
 
 class TypographerContextSkia : public TypographerContext {
  public:
-  static std::shared_ptr<TypographerContext> Make();
+  /// When |worker_task_runner| is not null, large batches of new glyphs are
+  /// rasterized concurrently on its workers, with the calling thread
+  /// waiting for them.
+  static std::shared_ptr<TypographerContext> Make(
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner = nullptr);
 
-  TypographerContextSkia();
+  explicit TypographerContextSkia(
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner = nullptr);
 
   ~TypographerContextSkia() override;
 
@@ -30,6 +41,8 @@ class TypographerContextSkia : public TypographerContext {
       const FontGlyphMap& font_glyph_map) const override;
 
  private:
+  const std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner_;
+
   TypographerContextSkia(const TypographerContextSkia&) = delete;
 
   TypographerContextSkia& operator=(const TypographerContextSkia&) = delete;
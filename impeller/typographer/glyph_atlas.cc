@@ -7,6 +7,9 @@
 #include <numeric>
 #include <utility>
 
+#include "flutter/fml/logging.h"
+#include "impeller/typographer/glyph_atlas_disk_cache.h"
+
 namespace impeller {
 
 GlyphAtlasContext::GlyphAtlasContext(GlyphAtlas::Type type)
@@ -22,25 +25,125 @@ const ISize& GlyphAtlasContext::GetAtlasSize() const {
   return atlas_size_;
 }
 
-int64_t GlyphAtlasContext::GetHeightAdjustment() const {
-  return height_adjustment_;
+void GlyphAtlasContext::SetAtlasSize(ISize size) {
+  atlas_size_ = size;
 }
 
-std::shared_ptr<RectanglePacker> GlyphAtlasContext::GetRectPacker() const {
-  return rect_packer_;
+uint64_t GlyphAtlasContext::BeginFrame() {
+  return ++current_frame_;
 }
 
-void GlyphAtlasContext::UpdateGlyphAtlas(std::shared_ptr<GlyphAtlas> atlas,
-                                         ISize size,
-                                         int64_t height_adjustment) {
-  atlas_ = std::move(atlas);
-  atlas_size_ = size;
-  height_adjustment_ = height_adjustment;
+uint64_t GlyphAtlasContext::GetCurrentFrame() const {
+  return current_frame_;
+}
+
+std::shared_ptr<RectanglePacker> GlyphAtlasContext::GetRectPacker(
+    size_t page) const {
+  if (page >= pages_.size()) {
+    return nullptr;
+  }
+  return pages_[page].rect_packer;
+}
+
+size_t GlyphAtlasContext::AddPage(
+    std::shared_ptr<RectanglePacker> rect_packer) {
+  pages_.push_back({std::move(rect_packer), current_frame_});
+  return pages_.size() - 1u;
 }
 
-void GlyphAtlasContext::UpdateRectPacker(
+void GlyphAtlasContext::SetRectPacker(
+    size_t page,
     std::shared_ptr<RectanglePacker> rect_packer) {
-  rect_packer_ = std::move(rect_packer);
+  FML_DCHECK(page < pages_.size());
+  pages_[page].rect_packer = std::move(rect_packer);
+}
+
+size_t GlyphAtlasContext::GetPageCount() const {
+  return pages_.size();
+}
+
+void GlyphAtlasContext::MarkPageUsed(size_t page) {
+  FML_DCHECK(page < pages_.size());
+  pages_[page].last_used_frame = current_frame_;
+}
+
+uint64_t GlyphAtlasContext::GetPageLastUsedFrame(size_t page) const {
+  FML_DCHECK(page < pages_.size());
+  return pages_[page].last_used_frame;
+}
+
+std::optional<size_t> GlyphAtlasContext::FindLeastRecentlyUsedPage() const {
+  std::optional<size_t> result;
+  for (size_t i = 0; i < pages_.size(); i++) {
+    if (pages_[i].last_used_frame < current_frame_ &&
+        (!result.has_value() ||
+         pages_[i].last_used_frame < pages_[result.value()].last_used_frame)) {
+      result = i;
+    }
+  }
+  return result;
+}
+
+void GlyphAtlasContext::EvictPage(size_t page) {
+  FML_DCHECK(page < pages_.size());
+  pages_[page].rect_packer->Reset();
+  pages_[page].last_used_frame = current_frame_;
+  evicted_page_count_++;
+  evicted_glyph_count_ += atlas_->RemovePageGlyphs(page);
+  if (disk_cache_) {
+    disk_cache_->RemovePageGlyphs(page);
+  }
+}
+
+size_t GlyphAtlasContext::ReleaseUnusedPages() {
+  size_t released = 0u;
+  while (pages_.size() > kMaxPageCount) {
+    std::optional<size_t> page = FindLeastRecentlyUsedPage();
+    if (!page.has_value()) {
+      break;
+    }
+    pages_.erase(pages_.begin() + page.value());
+    evicted_page_count_++;
+    evicted_glyph_count_ += atlas_->RemovePage(page.value());
+    if (disk_cache_) {
+      disk_cache_->RemovePage(page.value());
+    }
+    released++;
+  }
+  return released;
+}
+
+Scalar GlyphAtlasContext::GetOccupancy() const {
+  Scalar used_area = 0;
+  Scalar total_area = 0;
+  for (size_t i = 0; i < pages_.size(); i++) {
+    const std::shared_ptr<Texture>& texture = atlas_->GetTexture(i);
+    if (!texture) {
+      continue;
+    }
+    Scalar area = texture->GetSize().Area();
+    used_area += pages_[i].rect_packer->PercentFull() * area;
+    total_area += area;
+  }
+  return total_area > 0 ? used_area / total_area : 0;
+}
+
+size_t GlyphAtlasContext::GetEvictedPageCount() const {
+  return evicted_page_count_;
+}
+
+size_t GlyphAtlasContext::GetEvictedGlyphCount() const {
+  return evicted_glyph_count_;
+}
+
+void GlyphAtlasContext::SetDiskCache(
+    std::shared_ptr<GlyphAtlasDiskCache> disk_cache) {
+  disk_cache_ = std::move(disk_cache);
+}
+
+const std::shared_ptr<GlyphAtlasDiskCache>& GlyphAtlasContext::GetDiskCache()
+    const {
+  return disk_cache_;
 }
 
 GlyphAtlas::GlyphAtlas(Type type) : type_(type) {}
@@ -48,26 +151,77 @@ GlyphAtlas::GlyphAtlas(Type type) : type_(type) {}
 GlyphAtlas::~GlyphAtlas() = default;
 
 bool GlyphAtlas::IsValid() const {
-  return !!texture_;
+  return !pages_.empty();
 }
 
 GlyphAtlas::Type GlyphAtlas::GetType() const {
   return type_;
 }
 
-const std::shared_ptr<Texture>& GlyphAtlas::GetTexture() const {
-  return texture_;
+size_t GlyphAtlas::AddPage(std::shared_ptr<Texture> texture) {
+  pages_.push_back(std::move(texture));
+  return pages_.size() - 1u;
+}
+
+size_t GlyphAtlas::GetPageCount() const {
+  return pages_.size();
+}
+
+const std::shared_ptr<Texture>& GlyphAtlas::GetTexture(size_t page) const {
+  static const std::shared_ptr<Texture> kNullTexture;
+  if (page >= pages_.size()) {
+    return kNullTexture;
+  }
+  return pages_[page];
 }
 
-void GlyphAtlas::SetTexture(std::shared_ptr<Texture> texture) {
-  texture_ = std::move(texture);
+void GlyphAtlas::SetTexture(size_t page, std::shared_ptr<Texture> texture) {
+  FML_DCHECK(page < pages_.size());
+  pages_[page] = std::move(texture);
+}
+
+size_t GlyphAtlas::RemovePage(size_t page) {
+  FML_DCHECK(page < pages_.size());
+  size_t count = RemovePageGlyphs(page);
+  pages_.erase(pages_.begin() + page);
+  for (auto& font_value : font_atlas_map_) {
+    for (auto& glyph_value : font_value.second.positions_) {
+      if (glyph_value.second.page > page) {
+        glyph_value.second.page--;
+      }
+    }
+  }
+  return count;
 }
 
 void GlyphAtlas::AddTypefaceGlyphPositionAndBounds(const FontGlyphPair& pair,
                                                    Rect position,
-                                                   Rect bounds) {
-  font_atlas_map_[pair.scaled_font].positions_[pair.glyph] =
-      std::make_pair(position, bounds);
+                                                   Rect bounds,
+                                                   size_t page,
+                                                   uint64_t frame) {
+  font_atlas_map_[pair.scaled_font].positions_[pair.glyph] = {
+      .position = position,
+      .bounds = bounds,
+      .page = page,
+      .last_used_frame = frame,
+  };
+}
+
+size_t GlyphAtlas::RemovePageGlyphs(size_t page) {
+  size_t count = 0u;
+  for (auto font_it = font_atlas_map_.begin();
+       font_it != font_atlas_map_.end();) {
+    auto& positions = font_it->second.positions_;
+    count += std::erase_if(positions, [page](const auto& glyph_value) {
+      return glyph_value.second.page == page;
+    });
+    if (positions.empty()) {
+      font_it = font_atlas_map_.erase(font_it);
+    } else {
+      ++font_it;
+    }
+  }
+  return count;
 }
 
 std::optional<std::pair<Rect, Rect>> GlyphAtlas::FindFontGlyphBounds(
@@ -88,6 +242,15 @@ const FontGlyphAtlas* GlyphAtlas::GetFontGlyphAtlas(const Font& font,
   return &found->second;
 }
 
+FontGlyphAtlas* GlyphAtlas::GetFontGlyphAtlas(const Font& font,
+                                              Scalar scale) {
+  auto found = font_atlas_map_.find(ScaledFont{font, scale});
+  if (found == font_atlas_map_.end()) {
+    return nullptr;
+  }
+  return &found->second;
+}
+
 size_t GlyphAtlas::GetGlyphCount() const {
   return std::accumulate(font_atlas_map_.begin(), font_atlas_map_.end(), 0,
                          [](const int a, const auto& b) {
@@ -108,7 +271,7 @@ size_t GlyphAtlas::IterateGlyphs(
     for (const auto& glyph_value : font_value.second.positions_) {
       count++;
       if (!iterator(font_value.first, glyph_value.first,
-                    glyph_value.second.first)) {
+                    glyph_value.second.position)) {
         return count;
       }
     }
@@ -122,7 +285,24 @@ std::optional<std::pair<Rect, Rect>> FontGlyphAtlas::FindGlyphBounds(
   if (found == positions_.end()) {
     return std::nullopt;
   }
-  return found->second;
+  return std::make_pair(found->second.position, found->second.bounds);
+}
+
+const GlyphAtlasEntry* FontGlyphAtlas::FindGlyph(
+    const SubpixelGlyph& glyph) const {
+  const auto& found = positions_.find(glyph);
+  if (found == positions_.end()) {
+    return nullptr;
+  }
+  return &found->second;
+}
+
+GlyphAtlasEntry* FontGlyphAtlas::FindGlyph(const SubpixelGlyph& glyph) {
+  auto found = positions_.find(glyph);
+  if (found == positions_.end()) {
+    return nullptr;
+  }
+  return &found->second;
 }
 
 }  // namespace impeller
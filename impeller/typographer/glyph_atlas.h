@@ -9,6 +9,7 @@
 #include <memory>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include "impeller/core/texture.h"
 #include "impeller/geometry/rect.h"
@@ -18,11 +19,27 @@
 namespace impeller {
 
 class FontGlyphAtlas;
+class GlyphAtlasDiskCache;
 
 //------------------------------------------------------------------------------
-/// @brief      A texture containing the bitmap representation of glyphs in
-///             different fonts along with the ability to query the location of
-///             specific font glyphs within the texture.
+/// @brief      The location of a glyph in a glyph atlas.
+///
+struct GlyphAtlasEntry {
+  /// The position of the glyph in the texture of its page.
+  Rect position;
+  /// The bounds of the glyph at scale.
+  Rect bounds;
+  /// The page of the atlas the glyph is in.
+  size_t page = 0u;
+  /// The last frame of the |GlyphAtlasContext| that used the glyph.
+  uint64_t last_used_frame = 0u;
+};
+
+//------------------------------------------------------------------------------
+/// @brief      A set of textures, called pages, containing the bitmap
+///             representation of glyphs in different fonts along with the
+///             ability to query the location of specific font glyphs within
+///             the pages.
 ///
 class GlyphAtlas {
  public:
@@ -42,8 +59,29 @@ class GlyphAtlas {
     /// colors.
     ///
     kColorBitmap,
+
+    //--------------------------------------------------------------------------
+    /// The glyphs are represented as signed distance fields in an 8-bit color
+    /// channel, rasterized at |kDistanceFieldFontSize| regardless of the size
+    /// they are drawn at.
+    ///
+    /// Each pixel holds 0.5 - d / (2 * |kDistanceFieldSpread|), clamped to
+    /// [0, 1], where d is the distance in pixels from its center to the
+    /// outline of the glyph, negative inside of it. A single glyph can be
+    /// drawn at any scale by thresholding the distance at 0.5.
+    kSignedDistanceField,
   };
 
+  //----------------------------------------------------------------------------
+  /// The size, in pixels, of the em square that the glyphs of a signed
+  /// distance field atlas are rasterized at.
+  static constexpr Scalar kDistanceFieldFontSize = 64.0f;
+
+  //----------------------------------------------------------------------------
+  /// The distance, in pixels of a signed distance field atlas, that the
+  /// distance field of each glyph extends to around its outline.
+  static constexpr Scalar kDistanceFieldSpread = 8.0f;
+
   //----------------------------------------------------------------------------
   /// @brief      Create an empty glyph atlas.
   ///
@@ -61,30 +99,72 @@ class GlyphAtlas {
   Type GetType() const;
 
   //----------------------------------------------------------------------------
-  /// @brief      Set the texture for the glyph atlas.
+  /// @brief      Add a page to the glyph atlas.
+  ///
+  /// @param[in]  texture  The texture of the page
+  ///
+  /// @return     The index of the new page.
+  ///
+  size_t AddPage(std::shared_ptr<Texture> texture);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Get the number of pages in the glyph atlas.
+  ///
+  size_t GetPageCount() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Get the texture of a page of the glyph atlas.
+  ///
+  /// @param[in]  page  The index of the page, the first page by default.
   ///
-  /// @param[in]  texture  The texture
+  /// @return     The texture, or nullptr if there is no such page.
   ///
-  void SetTexture(std::shared_ptr<Texture> texture);
+  const std::shared_ptr<Texture>& GetTexture(size_t page = 0u) const;
 
   //----------------------------------------------------------------------------
-  /// @brief      Get the texture for the glyph atlas.
+  /// @brief      Replace the texture of a page, for example with one of
+  ///             another size once the glyphs of the page are removed.
   ///
-  /// @return     The texture.
+  /// @param[in]  page     The index of the page
+  /// @param[in]  texture  The new texture of the page
   ///
-  const std::shared_ptr<Texture>& GetTexture() const;
+  void SetTexture(size_t page, std::shared_ptr<Texture> texture);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Remove a page and its glyphs. The pages after it, and their
+  ///             glyphs, move down by one.
+  ///
+  /// @param[in]  page  The page
+  ///
+  /// @return     The number of glyphs removed.
+  ///
+  size_t RemovePage(size_t page);
 
   //----------------------------------------------------------------------------
   /// @brief      Record the location of a specific font-glyph pair within the
   ///             atlas.
   ///
   /// @param[in]  pair  The font-glyph pair
-  /// @param[in]  rect  The position in the atlas
+  /// @param[in]  rect  The position in the texture of the page
   /// @param[in]  bounds The bounds of the glyph at scale
+  /// @param[in]  page  The page the glyph is in
+  /// @param[in]  frame The frame of the |GlyphAtlasContext| that added it
   ///
   void AddTypefaceGlyphPositionAndBounds(const FontGlyphPair& pair,
                                          Rect position,
-                                         Rect bounds);
+                                         Rect bounds,
+                                         size_t page = 0u,
+                                         uint64_t frame = 0u);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Forget the locations of all the glyphs in a page, so that
+  ///             the space they occupied can be reused.
+  ///
+  /// @param[in]  page  The page
+  ///
+  /// @return     The number of glyphs removed.
+  ///
+  size_t RemovePageGlyphs(size_t page);
 
   //----------------------------------------------------------------------------
   /// @brief      Get the number of unique font-glyph pairs in this atlas.
@@ -112,8 +192,8 @@ class GlyphAtlas {
   ///
   /// @param[in]  pair  The font-glyph pair
   ///
-  /// @return     The location of the font-glyph pair in the atlas.
-  ///             `std::nullopt` if the pair is not in the atlas.
+  /// @return     The location of the font-glyph pair in the texture of its
+  ///             page. `std::nullopt` if the pair is not in the atlas.
   ///
   std::optional<std::pair<Rect, Rect>> FindFontGlyphBounds(
       const FontGlyphPair& pair) const;
@@ -131,10 +211,11 @@ class GlyphAtlas {
   ///             valid for the lifetime of the GlyphAtlas.
   ///
   const FontGlyphAtlas* GetFontGlyphAtlas(const Font& font, Scalar scale) const;
+  FontGlyphAtlas* GetFontGlyphAtlas(const Font& font, Scalar scale);
 
  private:
   const Type type_;
-  std::shared_ptr<Texture> texture_;
+  std::vector<std::shared_ptr<Texture>> pages_;
 
   std::unordered_map<ScaledFont,
                      FontGlyphAtlas,
@@ -150,8 +231,23 @@ class GlyphAtlas {
 //------------------------------------------------------------------------------
 /// @brief      A container for caching a glyph atlas across frames.
 ///
+///             The atlas is made of pages that each have a rectangle packer
+///             of their own. Glyphs are added to the first page with room
+///             for them. When all pages are full and there are as many of
+///             them as the page budget allows, the page whose glyphs were
+///             least recently used is emptied and reused, so the atlas is
+///             never rebuilt as a whole.
+///
 class GlyphAtlasContext {
  public:
+  //----------------------------------------------------------------------------
+  /// @brief      The number of pages the atlas grows to before the least
+  ///             recently used pages are reused. An atlas can have more
+  ///             pages than this when all of them are used by the glyphs of
+  ///             the current frame, until a later frame no longer uses
+  ///             the extra pages.
+  static constexpr size_t kMaxPageCount = 4u;
+
   explicit GlyphAtlasContext(GlyphAtlas::Type type);
 
   virtual ~GlyphAtlasContext();
@@ -161,36 +257,109 @@ class GlyphAtlasContext {
   std::shared_ptr<GlyphAtlas> GetGlyphAtlas() const;
 
   //----------------------------------------------------------------------------
-  /// @brief      Retrieve the size of the current glyph atlas.
+  /// @brief      Retrieve the size of the pages of the glyph atlas. Pages
+  ///             that hold glyphs too large for a page of this size are
+  ///             larger.
   const ISize& GetAtlasSize() const;
 
   //----------------------------------------------------------------------------
-  /// @brief      Retrieve the previous (if any) rect packer.
-  std::shared_ptr<RectanglePacker> GetRectPacker() const;
+  /// @brief      Set the size of the pages of the glyph atlas.
+  void SetAtlasSize(ISize size);
 
   //----------------------------------------------------------------------------
-  /// @brief      A y-coordinate shift that must be applied to glyphs appended
-  /// to
-  ///             the atlas.
+  /// @brief      Advance to the next frame and return its number. Glyphs
+  ///             and pages record the last frame that used them.
+  uint64_t BeginFrame();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Retrieve the number of the current frame.
+  uint64_t GetCurrentFrame() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Retrieve the rect packer of a page of the atlas.
+  std::shared_ptr<RectanglePacker> GetRectPacker(size_t page) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Add the rect packer of a new page of the atlas.
+  ///
+  /// @return     The index of the new page.
+  size_t AddPage(std::shared_ptr<RectanglePacker> rect_packer);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Replace the rect packer of a page of the atlas, whose
+  ///             texture was replaced with one of another size.
+  void SetRectPacker(size_t page, std::shared_ptr<RectanglePacker> rect_packer);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Retrieve the number of pages of the atlas.
+  size_t GetPageCount() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Record that a page is used by the current frame.
+  void MarkPageUsed(size_t page);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Retrieve the last frame that used a page.
+  uint64_t GetPageLastUsedFrame(size_t page) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Find the page that was least recently used, ignoring the
+  ///             pages used by the current frame.
+  ///
+  /// @return     The page, or `std::nullopt` if every page is used by the
+  ///             current frame.
+  std::optional<size_t> FindLeastRecentlyUsedPage() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Empty a page of the atlas so that it can be reused, and
+  ///             count the glyphs evicted from it.
+  void EvictPage(size_t page);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Remove the least recently used pages that the current frame
+  ///             does not use until there are at most |kMaxPageCount| pages.
   ///
-  ///             The rectangle packer is only initialized for unfilled regions
-  ///             of the atlas. The area the rectangle packer covers is offset
-  ///             from the origin by this height adjustment.
-  int64_t GetHeightAdjustment() const;
+  /// @return     The number of pages removed.
+  size_t ReleaseUnusedPages();
 
   //----------------------------------------------------------------------------
-  /// @brief      Update the context with a newly constructed glyph atlas.
-  void UpdateGlyphAtlas(std::shared_ptr<GlyphAtlas> atlas,
-                        ISize size,
-                        int64_t height_adjustment_);
+  /// @brief      Retrieve the fraction of the area of the pages, between 0
+  ///             and 1, that is occupied by glyphs.
+  Scalar GetOccupancy() const;
 
-  void UpdateRectPacker(std::shared_ptr<RectanglePacker> rect_packer);
+  //----------------------------------------------------------------------------
+  /// @brief      Retrieve the number of times a page was emptied to make
+  ///             room for new glyphs.
+  size_t GetEvictedPageCount() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Retrieve the number of glyphs removed from the atlas to make
+  ///             room for new glyphs.
+  size_t GetEvictedGlyphCount() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Keep the glyphs of the atlas on disk, so that they can be
+  ///             restored instead of rasterized again on the next launch.
+  void SetDiskCache(std::shared_ptr<GlyphAtlasDiskCache> disk_cache);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Retrieve the copy on disk of the glyphs of the atlas, or
+  ///             nullptr if the glyphs are not kept on disk.
+  const std::shared_ptr<GlyphAtlasDiskCache>& GetDiskCache() const;
 
  private:
+  struct Page {
+    std::shared_ptr<RectanglePacker> rect_packer;
+    uint64_t last_used_frame = 0u;
+  };
+
   std::shared_ptr<GlyphAtlas> atlas_;
   ISize atlas_size_;
-  std::shared_ptr<RectanglePacker> rect_packer_;
-  int64_t height_adjustment_;
+  std::vector<Page> pages_;
+  uint64_t current_frame_ = 0u;
+  size_t evicted_page_count_ = 0u;
+  size_t evicted_glyph_count_ = 0u;
+  std::shared_ptr<GlyphAtlasDiskCache> disk_cache_;
 
   GlyphAtlasContext(const GlyphAtlasContext&) = delete;
 
@@ -210,16 +379,28 @@ class FontGlyphAtlas {
   ///
   /// @param[in]  glyph The glyph
   ///
-  /// @return     The location of the glyph in the atlas.
+  /// @return     The location of the glyph in the texture of its page.
   ///             `std::nullopt` if the glyph is not in the atlas.
   ///
   std::optional<std::pair<Rect, Rect>> FindGlyphBounds(
       const SubpixelGlyph& glyph) const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      Find the entry of a glyph in the atlas, which also records
+  ///             the page it is in.
+  ///
+  /// @param[in]  glyph The glyph
+  ///
+  /// @return     The entry of the glyph, or nullptr if the glyph is not in
+  ///             the atlas.
+  ///
+  const GlyphAtlasEntry* FindGlyph(const SubpixelGlyph& glyph) const;
+  GlyphAtlasEntry* FindGlyph(const SubpixelGlyph& glyph);
+
  private:
   friend class GlyphAtlas;
   std::unordered_map<SubpixelGlyph,
-                     std::pair<Rect, Rect>,
+                     GlyphAtlasEntry,
                      SubpixelGlyph::Hash,
                      SubpixelGlyph::Equal>
       positions_;
@@ -0,0 +1,452 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "impeller/typographer/glyph_atlas_disk_cache.h"
+
+#include <cstring>
+#include <utility>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/trace_event.h"
+
+namespace impeller {
+
+namespace {
+
+struct FileHeader {
+  uint32_t magic = GlyphAtlasDiskCache::kMagic;
+  uint32_t version = GlyphAtlasDiskCache::kVersion;
+  uint32_t type;
+  uint32_t bytes_per_pixel;
+  int32_t atlas_width;
+  int32_t atlas_height;
+  uint32_t page_count;
+  uint32_t glyph_count;
+};
+
+// Each record of a page is followed by |state_size| values of the state of
+// its rectangle packer.
+struct PageRecord {
+  int32_t width;
+  int32_t height;
+  uint32_t state_size;
+};
+
+// Each record of a glyph is followed by |key_size| bytes of the key, and
+// then by the |width| * |height| pixels of the glyph.
+struct GlyphRecord {
+  uint32_t key_size;
+  uint32_t page;
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+  float left;
+  float top;
+  float right;
+  float bottom;
+};
+
+template <typename T>
+void AppendBytes(std::string& key, const T& value) {
+  key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Reads from a mapping, failing instead of reading past its end.
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  bool Read(void* destination, size_t bytes) {
+    if (size_ - offset_ < bytes) {
+      return false;
+    }
+    memcpy(destination, data_ + offset_, bytes);
+    offset_ += bytes;
+    return true;
+  }
+
+  const uint8_t* Skip(size_t bytes) {
+    if (size_ - offset_ < bytes) {
+      return nullptr;
+    }
+    const uint8_t* start = data_ + offset_;
+    offset_ += bytes;
+    return start;
+  }
+
+  bool IsAtEnd() const { return offset_ == size_; }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t offset_ = 0u;
+};
+
+}  // namespace
+
+struct GlyphAtlasDiskCache::Snapshot {
+  // Increases with every snapshot of a cache.
+  uint64_t sequence;
+  GlyphAtlas::Type type;
+  size_t bytes_per_pixel;
+  ISize atlas_size;
+  std::vector<Page> pages;
+  std::vector<std::pair<std::string, Glyph>> glyphs;
+};
+
+struct GlyphAtlasDiskCache::WriteState {
+  // Keeps writes of the file from overlapping.
+  std::mutex mutex;
+  // The sequence number of the last snapshot written, so that a write that
+  // was posted before the cache was destroyed does not overwrite the file
+  // the destructor wrote.
+  uint64_t written_sequence = 0u;
+};
+
+GlyphAtlasDiskCache::GlyphAtlasDiskCache(
+    std::shared_ptr<fml::UniqueFD> directory,
+    GlyphAtlas::Type type,
+    size_t bytes_per_pixel,
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner)
+    : directory_(std::move(directory)),
+      type_(type),
+      bytes_per_pixel_(bytes_per_pixel),
+      worker_task_runner_(std::move(worker_task_runner)),
+      write_state_(std::make_shared<WriteState>()) {}
+
+GlyphAtlasDiskCache::~GlyphAtlasDiskCache() {
+  if (!dirty_) {
+    return;
+  }
+  // Write synchronously, as the worker may not outlive the cache.
+  std::shared_ptr<Snapshot> snapshot = TakeSnapshot();
+  if (snapshot) {
+    WriteIfNewer(*directory_, GetFileName(type_), *write_state_, *snapshot);
+  }
+}
+
+std::string GlyphAtlasDiskCache::ComputeKey(const std::string& typeface_id,
+                                            const ScaledFont& scaled_font,
+                                            const SubpixelGlyph& glyph) {
+  if (typeface_id.empty() || glyph.properties.has_value()) {
+    return "";
+  }
+  const Font::Metrics& metrics = scaled_font.font.GetMetrics();
+  std::string key = typeface_id;
+  key.push_back('\0');
+  AppendBytes(key, metrics.point_size);
+  AppendBytes(key, metrics.embolden);
+  AppendBytes(key, metrics.skewX);
+  AppendBytes(key, metrics.scaleX);
+  AppendBytes(key, scaled_font.font.GetAxisAlignment());
+  AppendBytes(key, scaled_font.scale);
+  AppendBytes(key, glyph.subpixel_offset.x);
+  AppendBytes(key, glyph.subpixel_offset.y);
+  AppendBytes(key, glyph.glyph.index);
+  AppendBytes(key, glyph.glyph.type);
+  return key;
+}
+
+const char* GlyphAtlasDiskCache::GetFileName(GlyphAtlas::Type type) {
+  switch (type) {
+    case GlyphAtlas::Type::kAlphaBitmap:
+      return "alpha_glyph_atlas";
+    case GlyphAtlas::Type::kSignedDistanceField:
+      return "distance_field_glyph_atlas";
+    case GlyphAtlas::Type::kColorBitmap:
+      return "";
+  }
+  return "";
+}
+
+bool GlyphAtlasDiskCache::Load() {
+  TRACE_EVENT0("impeller", "GlyphAtlasDiskCache::Load");
+  Clear();
+  const char* file_name = GetFileName(type_);
+  if (!directory_ || !directory_->is_valid() || file_name[0] == '\0') {
+    return false;
+  }
+  fml::UniqueFD file = fml::OpenFileReadOnly(*directory_, file_name);
+  if (!file.is_valid()) {
+    return false;
+  }
+
+  bool valid = false;
+  {
+    fml::FileMapping mapping(file);
+    const uint8_t* data = mapping.GetMapping();
+    Reader reader(data, data ? mapping.GetSize() : 0u);
+    FileHeader header;
+    valid = reader.Read(&header, sizeof(header)) && header.magic == kMagic &&
+            header.version == kVersion &&
+            header.type == static_cast<uint32_t>(type_) &&
+            header.bytes_per_pixel == bytes_per_pixel_ &&
+            header.atlas_width > 0 && header.atlas_height > 0;
+    if (valid) {
+      atlas_size_ = ISize(header.atlas_width, header.atlas_height);
+    }
+    for (uint32_t i = 0; valid && i < header.page_count; i++) {
+      PageRecord record;
+      valid = reader.Read(&record, sizeof(record)) && record.width > 0 &&
+              record.height > 0;
+      if (!valid) {
+        break;
+      }
+      const uint8_t* state =
+          reader.Skip(static_cast<size_t>(record.state_size) * sizeof(int32_t));
+      valid = state != nullptr;
+      if (!valid) {
+        break;
+      }
+      Page page;
+      page.size = ISize(record.width, record.height);
+      page.packer_state.resize(record.state_size);
+      memcpy(page.packer_state.data(), state,
+             page.packer_state.size() * sizeof(int32_t));
+      pages_.push_back(std::move(page));
+    }
+    for (uint32_t i = 0; valid && i < header.glyph_count; i++) {
+      GlyphRecord record;
+      valid = reader.Read(&record, sizeof(record)) &&
+              record.page < pages_.size() && record.x >= 0 && record.y >= 0 &&
+              record.width >= 0 && record.height >= 0 &&
+              record.x + record.width <= pages_[record.page].size.width &&
+              record.y + record.height <= pages_[record.page].size.height;
+      if (!valid) {
+        break;
+      }
+      const uint8_t* key = reader.Skip(record.key_size);
+      size_t pixel_bytes = static_cast<size_t>(record.width) * record.height *
+                           bytes_per_pixel_;
+      const uint8_t* pixels = key ? reader.Skip(pixel_bytes) : nullptr;
+      valid = key && pixels && record.key_size > 0u;
+      if (!valid) {
+        break;
+      }
+      Glyph glyph;
+      glyph.page = record.page;
+      glyph.position =
+          IRect::MakeXYWH(record.x, record.y, record.width, record.height);
+      glyph.bounds =
+          Rect::MakeLTRB(record.left, record.top, record.right, record.bottom);
+      glyph.pixels = std::make_shared<std::vector<uint8_t>>(
+          pixels, pixels + pixel_bytes);
+      glyphs_[std::string(reinterpret_cast<const char*>(key),
+                          record.key_size)] = std::move(glyph);
+    }
+    valid = valid && reader.IsAtEnd();
+  }
+
+  if (!valid) {
+    FML_LOG(INFO) << "Glyph atlas disk cache is corrupt: " << file_name;
+    fml::UnlinkFile(*directory_, file_name);
+    Clear();
+    dirty_ = false;
+    return false;
+  }
+  dirty_ = false;
+  return !glyphs_.empty();
+}
+
+const GlyphAtlasDiskCache::Glyph* GlyphAtlasDiskCache::FindGlyph(
+    const std::string& key) const {
+  auto found = glyphs_.find(key);
+  if (found == glyphs_.end()) {
+    return nullptr;
+  }
+  return &found->second;
+}
+
+void GlyphAtlasDiskCache::VisitPageGlyphs(
+    size_t page,
+    const std::function<void(const Glyph& glyph)>& visitor) const {
+  for (const auto& [key, glyph] : glyphs_) {
+    if (glyph.page == page) {
+      visitor(glyph);
+    }
+  }
+}
+
+void GlyphAtlasDiskCache::AddGlyph(std::string key, Glyph glyph) {
+  if (key.empty() || !glyph.pixels ||
+      glyph.pixels->size() !=
+          static_cast<size_t>(glyph.position.Area()) * bytes_per_pixel_) {
+    return;
+  }
+  glyphs_[std::move(key)] = std::move(glyph);
+  MarkDirty();
+}
+
+void GlyphAtlasDiskCache::RemovePageGlyphs(size_t page) {
+  size_t count = std::erase_if(
+      glyphs_, [page](const auto& entry) { return entry.second.page == page; });
+  if (count > 0u) {
+    MarkDirty();
+  }
+}
+
+void GlyphAtlasDiskCache::RemovePage(size_t page) {
+  RemovePageGlyphs(page);
+  for (auto& [key, glyph] : glyphs_) {
+    if (glyph.page > page) {
+      glyph.page--;
+    }
+  }
+  if (page < pages_.size()) {
+    pages_.erase(pages_.begin() + page);
+  }
+  MarkDirty();
+}
+
+void GlyphAtlasDiskCache::SetPages(ISize atlas_size, std::vector<Page> pages) {
+  atlas_size_ = atlas_size;
+  pages_ = std::move(pages);
+  MarkDirty();
+}
+
+void GlyphAtlasDiskCache::Clear() {
+  if (!glyphs_.empty() || !pages_.empty()) {
+    MarkDirty();
+  }
+  atlas_size_ = ISize();
+  pages_.clear();
+  glyphs_.clear();
+}
+
+void GlyphAtlasDiskCache::MarkDirty() {
+  dirty_ = true;
+  last_change_time_ = fml::TimePoint::Now();
+}
+
+void GlyphAtlasDiskCache::StoreIfNeeded() {
+  if (dirty_ && fml::TimePoint::Now() - last_change_time_ >= kStoreDelay) {
+    Store();
+  }
+}
+
+void GlyphAtlasDiskCache::Store() {
+  if (!dirty_) {
+    return;
+  }
+  std::shared_ptr<Snapshot> snapshot = TakeSnapshot();
+  if (!snapshot) {
+    return;
+  }
+  if (!worker_task_runner_) {
+    WriteIfNewer(*directory_, GetFileName(type_), *write_state_, *snapshot);
+    return;
+  }
+  worker_task_runner_->PostTask([directory = directory_,
+                                 file_name = GetFileName(type_),
+                                 write_state = write_state_, snapshot]() {
+    WriteIfNewer(*directory, file_name, *write_state, *snapshot);
+  });
+}
+
+std::shared_ptr<GlyphAtlasDiskCache::Snapshot>
+GlyphAtlasDiskCache::TakeSnapshot() {
+  if (!directory_ || !directory_->is_valid() ||
+      GetFileName(type_)[0] == '\0') {
+    return nullptr;
+  }
+  dirty_ = false;
+
+  // The pixels are shared with the snapshot rather than copied.
+  auto snapshot = std::make_shared<Snapshot>();
+  snapshot->sequence = next_sequence_++;
+  snapshot->type = type_;
+  snapshot->bytes_per_pixel = bytes_per_pixel_;
+  snapshot->atlas_size = atlas_size_;
+  snapshot->pages = pages_;
+  snapshot->glyphs.reserve(glyphs_.size());
+  for (const auto& [key, glyph] : glyphs_) {
+    snapshot->glyphs.emplace_back(key, glyph);
+  }
+  return snapshot;
+}
+
+void GlyphAtlasDiskCache::WriteIfNewer(const fml::UniqueFD& directory,
+                                       const char* file_name,
+                                       WriteState& write_state,
+                                       const Snapshot& snapshot) {
+  std::scoped_lock lock(write_state.mutex);
+  if (snapshot.sequence <= write_state.written_sequence) {
+    return;
+  }
+  write_state.written_sequence = snapshot.sequence;
+  Write(directory, file_name, snapshot);
+}
+
+bool GlyphAtlasDiskCache::Write(const fml::UniqueFD& directory,
+                                const char* file_name,
+                                const Snapshot& snapshot) {
+  TRACE_EVENT0("impeller", "GlyphAtlasDiskCache::Write");
+  if (snapshot.pages.empty()) {
+    return fml::UnlinkFile(directory, file_name);
+  }
+
+  size_t size = sizeof(FileHeader);
+  for (const Page& page : snapshot.pages) {
+    size += sizeof(PageRecord) + page.packer_state.size() * sizeof(int32_t);
+  }
+  for (const auto& [key, glyph] : snapshot.glyphs) {
+    size += sizeof(GlyphRecord) + key.size() + glyph.pixels->size();
+  }
+
+  std::vector<uint8_t> data(size);
+  size_t offset = 0u;
+  auto append = [&data, &offset](const void* bytes, size_t count) {
+    if (count > 0u) {
+      memcpy(data.data() + offset, bytes, count);
+      offset += count;
+    }
+  };
+
+  FileHeader header;
+  header.type = static_cast<uint32_t>(snapshot.type);
+  header.bytes_per_pixel = snapshot.bytes_per_pixel;
+  header.atlas_width = snapshot.atlas_size.width;
+  header.atlas_height = snapshot.atlas_size.height;
+  header.page_count = snapshot.pages.size();
+  header.glyph_count = snapshot.glyphs.size();
+  append(&header, sizeof(header));
+  for (const Page& page : snapshot.pages) {
+    PageRecord record;
+    record.width = page.size.width;
+    record.height = page.size.height;
+    record.state_size = page.packer_state.size();
+    append(&record, sizeof(record));
+    append(page.packer_state.data(),
+           page.packer_state.size() * sizeof(int32_t));
+  }
+  for (const auto& [key, glyph] : snapshot.glyphs) {
+    GlyphRecord record;
+    record.key_size = key.size();
+    record.page = glyph.page;
+    record.x = glyph.position.GetX();
+    record.y = glyph.position.GetY();
+    record.width = glyph.position.GetWidth();
+    record.height = glyph.position.GetHeight();
+    record.left = glyph.bounds.GetLeft();
+    record.top = glyph.bounds.GetTop();
+    record.right = glyph.bounds.GetRight();
+    record.bottom = glyph.bounds.GetBottom();
+    append(&record, sizeof(record));
+    append(key.data(), key.size());
+    append(glyph.pixels->data(), glyph.pixels->size());
+  }
+
+  fml::DataMapping mapping(std::move(data));
+  if (!fml::WriteAtomically(directory, file_name, mapping)) {
+    FML_LOG(WARNING) << "Could not write glyph atlas to disk.";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace impeller
@@ -0,0 +1,186 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_IMPELLER_TYPOGRAPHER_GLYPH_ATLAS_DISK_CACHE_H_
+#define FLUTTER_IMPELLER_TYPOGRAPHER_GLYPH_ATLAS_DISK_CACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/time/time_point.h"
+#include "flutter/fml/unique_fd.h"
+#include "impeller/geometry/rect.h"
+#include "impeller/geometry/size.h"
+#include "impeller/typographer/font_glyph_pair.h"
+#include "impeller/typographer/glyph_atlas.h"
+
+namespace fml {
+class ConcurrentTaskRunner;
+}  // namespace fml
+
+namespace impeller {
+
+//------------------------------------------------------------------------------
+/// @brief      A copy on disk of the glyphs of a glyph atlas, so that the
+///             glyphs an application draws on every launch, such as those of
+///             its UI font, do not have to be rasterized again on the next
+///             launch.
+///
+///             The copy is a single file per atlas type holding the state of
+///             the rectangle packer of each page, and the position, bounds
+///             and pixels of each glyph. Glyphs are keyed by the persistent
+///             identifier of their typeface, their font metrics and scale,
+///             their subpixel offset and their index. Glyphs with properties,
+///             that is color or stroked glyphs, are not kept.
+///
+///             When the file is loaded, the pages are restored to the atlas
+///             before its first glyphs are added, with the packers where
+///             they left off. The glyphs are then added to the atlas without
+///             rasterizing them as soon as a frame draws them.
+///
+///             The cache is only used on the thread that creates the glyph
+///             atlas, except that it may be loaded on another thread before
+///             it is handed to the atlas. The file is written on the worker
+///             task runner if one is given, once no glyphs were added for a
+///             while. A write is skipped when a newer one already ran.
+///
+class GlyphAtlasDiskCache {
+ public:
+  // The first 4 bytes of the file, "GADC".
+  static constexpr uint32_t kMagic = 0x43444147u;
+
+  // Incremented whenever the format of the file changes.
+  static constexpr uint32_t kVersion = 1u;
+
+  // The time without added or removed glyphs after which the file is
+  // written.
+  static constexpr fml::TimeDelta kStoreDelay = fml::TimeDelta::FromSeconds(2);
+
+  struct Page {
+    ISize size;
+    std::vector<int32_t> packer_state;
+  };
+
+  struct Glyph {
+    size_t page = 0u;
+    // The position of the glyph in the texture of its page, without padding.
+    IRect position;
+    Rect bounds;
+    // The pixels at |position|, row by row without padding.
+    std::shared_ptr<const std::vector<uint8_t>> pixels;
+  };
+
+  GlyphAtlasDiskCache(
+      std::shared_ptr<fml::UniqueFD> directory,
+      GlyphAtlas::Type type,
+      size_t bytes_per_pixel,
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner = nullptr);
+
+  /// Writes the glyphs added since the last write.
+  ~GlyphAtlasDiskCache();
+
+  /// Returns the key of |glyph| of |scaled_font|, or an empty string if the
+  /// glyph is not kept. |typeface_id| identifies the typeface of the font
+  /// across launches, and is empty if it cannot be identified.
+  static std::string ComputeKey(const std::string& typeface_id,
+                                const ScaledFont& scaled_font,
+                                const SubpixelGlyph& glyph);
+
+  /// Returns the name of the file of the atlases of |type|, or an empty
+  /// string if they are not kept.
+  static const char* GetFileName(GlyphAtlas::Type type);
+
+  /// Reads the file. Files that are corrupt, or that were written for
+  /// another pixel format, are deleted.
+  ///
+  /// @return     Whether any glyphs were read.
+  bool Load();
+
+  /// The pages the glyphs are in, in the order they are added to the atlas.
+  const ISize& GetAtlasSize() const { return atlas_size_; }
+  const std::vector<Page>& GetPages() const { return pages_; }
+
+  /// Returns the glyph with |key|, or nullptr if there is none.
+  const Glyph* FindGlyph(const std::string& key) const;
+
+  /// Calls |visitor| for each glyph in |page|.
+  void VisitPageGlyphs(
+      size_t page,
+      const std::function<void(const Glyph& glyph)>& visitor) const;
+
+  size_t GetGlyphCount() const { return glyphs_.size(); }
+
+  /// Adds a glyph that was rasterized into the atlas.
+  void AddGlyph(std::string key, Glyph glyph);
+
+  /// Removes the glyphs of |page|, whose glyphs were removed from the atlas.
+  void RemovePageGlyphs(size_t page);
+
+  /// Removes |page| and its glyphs, which were removed from the atlas. The
+  /// pages after it, and their glyphs, move down by one.
+  void RemovePage(size_t page);
+
+  /// Records the size and packer state of the pages of the atlas.
+  void SetPages(ISize atlas_size, std::vector<Page> pages);
+
+  /// Removes all of the pages and glyphs, for example because the pages
+  /// could not be restored.
+  void Clear();
+
+  /// Writes the file if glyphs were added or removed since the last write,
+  /// and none were for |kStoreDelay|, so that the file is not rewritten
+  /// while an application keeps drawing new glyphs.
+  void StoreIfNeeded();
+
+  /// Writes the file if glyphs were added or removed since the last write.
+  void Store();
+
+ private:
+  // The contents of the file, shared with the task that writes it.
+  struct Snapshot;
+
+  // The state shared with the tasks that write the file.
+  struct WriteState;
+
+  void MarkDirty();
+
+  std::shared_ptr<Snapshot> TakeSnapshot();
+
+  static bool Write(const fml::UniqueFD& directory,
+                    const char* file_name,
+                    const Snapshot& snapshot);
+
+  // Writes |snapshot| unless a newer snapshot was written already.
+  static void WriteIfNewer(const fml::UniqueFD& directory,
+                           const char* file_name,
+                           WriteState& write_state,
+                           const Snapshot& snapshot);
+
+  const std::shared_ptr<fml::UniqueFD> directory_;
+  const GlyphAtlas::Type type_;
+  const size_t bytes_per_pixel_;
+  const std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner_;
+  const std::shared_ptr<WriteState> write_state_;
+
+  ISize atlas_size_;
+  std::vector<Page> pages_;
+  std::unordered_map<std::string, Glyph> glyphs_;
+  bool dirty_ = false;
+  fml::TimePoint last_change_time_;
+  // The sequence number of the next snapshot.
+  uint64_t next_sequence_ = 1u;
+
+  GlyphAtlasDiskCache(const GlyphAtlasDiskCache&) = delete;
+
+  GlyphAtlasDiskCache& operator=(const GlyphAtlasDiskCache&) = delete;
+};
+
+}  // namespace impeller
+
+#endif  // FLUTTER_IMPELLER_TYPOGRAPHER_GLYPH_ATLAS_DISK_CACHE_H_
@@ -4,9 +4,11 @@
 
 #include "impeller/typographer/lazy_glyph_atlas.h"
 
+#include "flutter/fml/concurrent_message_loop.h"
 #include "fml/logging.h"
 #include "impeller/base/validation.h"
 #include "impeller/typographer/glyph_atlas.h"
+#include "impeller/typographer/glyph_atlas_disk_cache.h"
 #include "impeller/typographer/typographer_context.h"
 
 #include <memory>
@@ -18,50 +20,165 @@ static const std::shared_ptr<GlyphAtlas> kNullGlyphAtlas = nullptr;
 
 LazyGlyphAtlas::LazyGlyphAtlas(
     std::shared_ptr<TypographerContext> typographer_context)
-    : typographer_context_(std::move(typographer_context)),
-      alpha_context_(typographer_context_
-                         ? typographer_context_->CreateGlyphAtlasContext(
-                               GlyphAtlas::Type::kAlphaBitmap)
-                         : nullptr),
-      color_context_(typographer_context_
-                         ? typographer_context_->CreateGlyphAtlasContext(
-                               GlyphAtlas::Type::kColorBitmap)
-                         : nullptr) {}
+    : typographer_context_(std::move(typographer_context)) {
+  if (typographer_context_) {
+    alpha_state_.context = typographer_context_->CreateGlyphAtlasContext(
+        GlyphAtlas::Type::kAlphaBitmap);
+    color_state_.context = typographer_context_->CreateGlyphAtlasContext(
+        GlyphAtlas::Type::kColorBitmap);
+    distance_field_state_.context =
+        typographer_context_->CreateGlyphAtlasContext(
+            GlyphAtlas::Type::kSignedDistanceField);
+  }
+}
 
 LazyGlyphAtlas::~LazyGlyphAtlas() = default;
 
-void LazyGlyphAtlas::AddTextFrame(const TextFrame& frame,
+LazyGlyphAtlas::AtlasState& LazyGlyphAtlas::GetAtlasState(
+    GlyphAtlas::Type type) const {
+  switch (type) {
+    case GlyphAtlas::Type::kAlphaBitmap:
+      return alpha_state_;
+    case GlyphAtlas::Type::kColorBitmap:
+      return color_state_;
+    case GlyphAtlas::Type::kSignedDistanceField:
+      return distance_field_state_;
+  }
+  FML_UNREACHABLE();
+}
+
+void LazyGlyphAtlas::AddTextFrame(const std::shared_ptr<TextFrame>& frame,
                                   Scalar scale,
                                   Point offset,
                                   const GlyphProperties& properties) {
-  FML_DCHECK(alpha_atlas_ == nullptr && color_atlas_ == nullptr);
-  if (frame.GetAtlasType() == GlyphAtlas::Type::kAlphaBitmap) {
-    frame.CollectUniqueFontGlyphPairs(alpha_glyph_map_, scale, offset,
-                                      properties);
+  FML_DCHECK(alpha_state_.atlas == nullptr && color_state_.atlas == nullptr &&
+             distance_field_state_.atlas == nullptr);
+  RecordScale(frame, scale);
+  GlyphAtlas::Type type = GetAtlasType(*frame, scale, properties.stroke);
+  AtlasState& state = GetAtlasState(type);
+  if (type == GlyphAtlas::Type::kSignedDistanceField) {
+    frame->CollectDistanceFieldGlyphs(state.glyph_map);
   } else {
-    frame.CollectUniqueFontGlyphPairs(color_glyph_map_, scale, offset,
-                                      properties);
+    frame->CollectUniqueFontGlyphPairs(state.glyph_map, scale, offset,
+                                       properties);
   }
 }
 
 void LazyGlyphAtlas::ResetTextFrames() {
-  alpha_glyph_map_.clear();
-  color_glyph_map_.clear();
-  alpha_atlas_.reset();
-  color_atlas_.reset();
+  for (AtlasState* state :
+       {&alpha_state_, &color_state_, &distance_field_state_}) {
+    state->glyph_map.clear();
+    state->atlas.reset();
+  }
+  generation_++;
+  for (auto it = scale_histories_.begin(); it != scale_histories_.end();) {
+    if (it->second.frame.expired()) {
+      it = scale_histories_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+GlyphAtlas::Type LazyGlyphAtlas::GetAtlasType(const TextFrame& frame,
+                                              Scalar scale,
+                                              bool stroke) const {
+  return frame.GetAtlasType(scale, stroke, IsScaleAnimating(frame));
+}
+
+bool LazyGlyphAtlas::IsScaleAnimating(const TextFrame& frame) const {
+  auto it = scale_histories_.find(&frame);
+  if (it == scale_histories_.end() || it->second.frame.expired()) {
+    return false;
+  }
+  return it->second.frames_at_last_scale < kScaleSettleFrames;
+}
+
+void LazyGlyphAtlas::RecordScale(const std::shared_ptr<TextFrame>& frame,
+                                 Scalar scale) {
+  ScaleHistory& history = scale_histories_[frame.get()];
+  if (history.frame.expired()) {
+    history = {};
+    history.frame = frame;
+  }
+  if (history.generation == generation_) {
+    return;
+  }
+  history.generation = generation_;
+  if (scale != history.last_scale && history.last_scale != 0.0f) {
+    history.frames_at_last_scale = 0u;
+  } else if (history.frames_at_last_scale < kScaleSettleFrames) {
+    history.frames_at_last_scale++;
+  }
+  history.last_scale = scale;
+}
+
+void LazyGlyphAtlas::EnableDiskCache(
+    std::shared_ptr<fml::UniqueFD> directory,
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner) {
+  if (!typographer_context_ || !directory || !directory->is_valid()) {
+    return;
+  }
+  for (GlyphAtlas::Type type : {GlyphAtlas::Type::kAlphaBitmap,
+                                GlyphAtlas::Type::kSignedDistanceField}) {
+    AtlasState& state = GetAtlasState(type);
+    if (state.context->GetDiskCache() || state.loading_disk_cache) {
+      continue;
+    }
+    // The glyphs of both atlases are 8-bit coverage or distances.
+    auto disk_cache = std::make_shared<GlyphAtlasDiskCache>(
+        directory, type, /*bytes_per_pixel=*/1u, worker_task_runner);
+    if (!worker_task_runner) {
+      disk_cache->Load();
+      SetDiskCache(type, std::move(disk_cache));
+      continue;
+    }
+    auto loading_disk_cache = std::make_shared<LoadingDiskCache>();
+    state.loading_disk_cache = loading_disk_cache;
+    worker_task_runner->PostTask(
+        [loading_disk_cache, disk_cache = std::move(disk_cache)]() mutable {
+          disk_cache->Load();
+          std::scoped_lock lock(loading_disk_cache->mutex);
+          loading_disk_cache->disk_cache = std::move(disk_cache);
+        });
+  }
+}
+
+void LazyGlyphAtlas::SetDiskCache(
+    GlyphAtlas::Type type,
+    std::shared_ptr<GlyphAtlasDiskCache> disk_cache) const {
+  AtlasState& state = GetAtlasState(type);
+  // The pages are only restored into an empty atlas.
+  if (state.context->GetGlyphAtlas()->GetPageCount() > 0u) {
+    state.context = typographer_context_->CreateGlyphAtlasContext(type);
+  }
+  state.context->SetDiskCache(std::move(disk_cache));
+}
+
+void LazyGlyphAtlas::AdoptLoadedDiskCache(GlyphAtlas::Type type) const {
+  AtlasState& state = GetAtlasState(type);
+  if (!state.loading_disk_cache) {
+    return;
+  }
+  std::shared_ptr<GlyphAtlasDiskCache> disk_cache;
+  {
+    std::scoped_lock lock(state.loading_disk_cache->mutex);
+    disk_cache = std::move(state.loading_disk_cache->disk_cache);
+  }
+  if (!disk_cache) {
+    return;
+  }
+  state.loading_disk_cache.reset();
+  SetDiskCache(type, std::move(disk_cache));
 }
 
 const std::shared_ptr<GlyphAtlas>& LazyGlyphAtlas::CreateOrGetGlyphAtlas(
     Context& context,
     HostBuffer& host_buffer,
     GlyphAtlas::Type type) const {
-  {
-    if (type == GlyphAtlas::Type::kAlphaBitmap && alpha_atlas_) {
-      return alpha_atlas_;
-    }
-    if (type == GlyphAtlas::Type::kColorBitmap && color_atlas_) {
-      return color_atlas_;
-    }
+  AtlasState& state = GetAtlasState(type);
+  if (state.atlas) {
+    return state.atlas;
   }
 
   if (!typographer_context_) {
@@ -75,25 +192,15 @@ const std::shared_ptr<GlyphAtlas>& LazyGlyphAtlas::CreateOrGetGlyphAtlas(
     return kNullGlyphAtlas;
   }
 
-  auto& glyph_map = type == GlyphAtlas::Type::kAlphaBitmap ? alpha_glyph_map_
-                                                           : color_glyph_map_;
-  const std::shared_ptr<GlyphAtlasContext>& atlas_context =
-      type == GlyphAtlas::Type::kAlphaBitmap ? alpha_context_ : color_context_;
+  AdoptLoadedDiskCache(type);
   std::shared_ptr<GlyphAtlas> atlas = typographer_context_->CreateGlyphAtlas(
-      context, type, host_buffer, atlas_context, glyph_map);
+      context, type, host_buffer, state.context, state.glyph_map);
   if (!atlas || !atlas->IsValid()) {
     VALIDATION_LOG << "Could not create valid atlas.";
     return kNullGlyphAtlas;
   }
-  if (type == GlyphAtlas::Type::kAlphaBitmap) {
-    alpha_atlas_ = std::move(atlas);
-    return alpha_atlas_;
-  }
-  if (type == GlyphAtlas::Type::kColorBitmap) {
-    color_atlas_ = std::move(atlas);
-    return color_atlas_;
-  }
-  FML_UNREACHABLE();
+  state.atlas = std::move(atlas);
+  return state.atlas;
 }
 
 }  // namespace impeller
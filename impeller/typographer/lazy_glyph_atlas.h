@@ -5,11 +5,20 @@
 #ifndef FLUTTER_IMPELLER_TYPOGRAPHER_LAZY_GLYPH_ATLAS_H_
 #define FLUTTER_IMPELLER_TYPOGRAPHER_LAZY_GLYPH_ATLAS_H_
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "flutter/fml/unique_fd.h"
 #include "impeller/renderer/context.h"
 #include "impeller/typographer/glyph_atlas.h"
 #include "impeller/typographer/text_frame.h"
 #include "impeller/typographer/typographer_context.h"
 
+namespace fml {
+class ConcurrentTaskRunner;
+}  // namespace fml
+
 namespace impeller {
 
 class LazyGlyphAtlas {
@@ -19,27 +28,108 @@ class LazyGlyphAtlas {
 
   ~LazyGlyphAtlas();
 
-  void AddTextFrame(const TextFrame& frame,
+  //----------------------------------------------------------------------------
+  /// @brief      Adds the glyphs of |frame| drawn at |scale| to the atlas of
+  ///             the type returned by |GetAtlasType|.
+  ///
+  ///             Only the first scale |frame| is added at in each frame
+  ///             counts towards whether its scale is animating, so its atlas
+  ///             type does not change between the time its glyphs are added
+  ///             and the time it is rendered.
+  ///
+  void AddTextFrame(const std::shared_ptr<TextFrame>& frame,
                     Scalar scale,
                     Point offset,
                     const GlyphProperties& properties);
 
   void ResetTextFrames();
 
+  //----------------------------------------------------------------------------
+  /// @brief      The type of atlas the glyphs of |frame| drawn at |scale| are
+  ///             added to, with a stroke if |stroke| is true.
+  ///
+  GlyphAtlas::Type GetAtlasType(const TextFrame& frame,
+                                Scalar scale,
+                                bool stroke) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Whether the scale |frame| is added at has changed within the
+  ///             last |kScaleSettleFrames| frames it was added in.
+  ///
+  bool IsScaleAnimating(const TextFrame& frame) const;
+
+  /// The number of frames a text frame has to be added at the same scale in
+  /// for it to no longer be considered animating.
+  static constexpr uint32_t kScaleSettleFrames = 30u;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Keeps the glyphs of the alpha and signed distance field
+  ///             atlases in |directory|, and restores the glyphs kept there
+  ///             by a previous launch. See |GlyphAtlasDiskCache|. Does
+  ///             nothing for atlases that already keep their glyphs on disk.
+  ///
+  ///             The files are read on |worker_task_runner|, and the atlases
+  ///             start using them from the first frame after they are read.
+  ///
+  /// @param[in]  directory           The directory to keep the glyphs in.
+  /// @param[in]  worker_task_runner  The task runner to read and write the
+  ///                                 files on, or nullptr to do so inline.
+  ///
+  void EnableDiskCache(
+      std::shared_ptr<fml::UniqueFD> directory,
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner);
+
   const std::shared_ptr<GlyphAtlas>& CreateOrGetGlyphAtlas(
       Context& context,
       HostBuffer& host_buffer,
       GlyphAtlas::Type type) const;
 
  private:
+  // A disk cache that is loaded on a worker, and handed to the thread that
+  // creates the atlas once it is.
+  struct LoadingDiskCache {
+    std::mutex mutex;
+    std::shared_ptr<GlyphAtlasDiskCache> disk_cache;
+  };
+
+  // The scales a text frame was added at in recent frames.
+  struct ScaleHistory {
+    // Tells the text frame apart from one that is later allocated at the
+    // same address.
+    std::weak_ptr<const TextFrame> frame;
+    uint64_t generation = 0u;
+    Scalar last_scale = 0.0f;
+    uint32_t frames_at_last_scale = kScaleSettleFrames;
+  };
+
+  struct AtlasState {
+    FontGlyphMap glyph_map;
+    std::shared_ptr<GlyphAtlasContext> context;
+    std::shared_ptr<GlyphAtlas> atlas;
+    std::shared_ptr<LoadingDiskCache> loading_disk_cache;
+  };
+
+  AtlasState& GetAtlasState(GlyphAtlas::Type type) const;
+
+  // Keeps the glyphs of the atlas of |type| in |disk_cache|, which is
+  // loaded.
+  void SetDiskCache(GlyphAtlas::Type type,
+                    std::shared_ptr<GlyphAtlasDiskCache> disk_cache) const;
+
+  // Hands the disk cache of the atlas of |type| to it if it was loaded.
+  void AdoptLoadedDiskCache(GlyphAtlas::Type type) const;
+
+  // Records that |frame| is added at |scale| in the current frame.
+  void RecordScale(const std::shared_ptr<TextFrame>& frame, Scalar scale);
+
   std::shared_ptr<TypographerContext> typographer_context_;
 
-  FontGlyphMap alpha_glyph_map_;
-  FontGlyphMap color_glyph_map_;
-  std::shared_ptr<GlyphAtlasContext> alpha_context_;
-  std::shared_ptr<GlyphAtlasContext> color_context_;
-  mutable std::shared_ptr<GlyphAtlas> alpha_atlas_;
-  mutable std::shared_ptr<GlyphAtlas> color_atlas_;
+  mutable AtlasState alpha_state_;
+  mutable AtlasState color_state_;
+  mutable AtlasState distance_field_state_;
+  // Identifies the frame the text frames are added for.
+  uint64_t generation_ = 1u;
+  std::unordered_map<const TextFrame*, ScaleHistory> scale_histories_;
 
   LazyGlyphAtlas(const LazyGlyphAtlas&) = delete;
 
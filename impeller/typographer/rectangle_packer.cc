@@ -5,6 +5,7 @@
 #include "impeller/typographer/rectangle_packer.h"
 
 #include <algorithm>
+#include <utility>
 #include <vector>
 
 #include "flutter/fml/logging.h"
@@ -33,6 +34,10 @@ class SkylineRectanglePacker final : public RectanglePacker {
     return area_so_far_ / ((float)width() * height());
   }
 
+  std::vector<int32_t> GetState() const final;
+
+  bool SetState(const std::vector<int32_t>& state) final;
+
  private:
   struct SkylineSegment {
     int x_;
@@ -171,6 +176,47 @@ void SkylineRectanglePacker::AddSkylineLevel(size_t skyline_index,
   }
 }
 
+// The state is the area so far followed by the x, y and width of each
+// segment of the skyline.
+std::vector<int32_t> SkylineRectanglePacker::GetState() const {
+  std::vector<int32_t> state;
+  state.reserve(1u + skyline_.size() * 3u);
+  state.push_back(area_so_far_);
+  for (const SkylineSegment& segment : skyline_) {
+    state.push_back(segment.x_);
+    state.push_back(segment.y_);
+    state.push_back(segment.width_);
+  }
+  return state;
+}
+
+bool SkylineRectanglePacker::SetState(const std::vector<int32_t>& state) {
+  Reset();
+  if (state.size() < 4u || (state.size() - 1u) % 3u != 0u || state[0] < 0 ||
+      state[0] > width() * height()) {
+    return false;
+  }
+  // The segments must cover the width of the packer from left to right.
+  std::vector<SkylineSegment> skyline;
+  int x = 0;
+  for (size_t i = 1u; i < state.size(); i += 3u) {
+    SkylineSegment segment{state[i], state[i + 1], state[i + 2]};
+    if (segment.x_ != x || segment.width_ <= 0 ||
+        segment.width_ > width() - x || segment.y_ < 0 ||
+        segment.y_ > height()) {
+      return false;
+    }
+    x += segment.width_;
+    skyline.push_back(segment);
+  }
+  if (x != width()) {
+    return false;
+  }
+  skyline_ = std::move(skyline);
+  area_so_far_ = state[0];
+  return true;
+}
+
 std::shared_ptr<RectanglePacker> RectanglePacker::Factory(int width,
                                                           int height) {
   return std::make_shared<SkylineRectanglePacker>(width, height);
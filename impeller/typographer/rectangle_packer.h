@@ -9,6 +9,7 @@
 #include "impeller/geometry/scalar.h"
 
 #include <cstdint>
+#include <vector>
 
 namespace impeller {
 
@@ -56,6 +57,22 @@ class RectanglePacker {
   ///
   virtual void Reset() = 0;
 
+  //----------------------------------------------------------------------------
+  /// @brief     Returns the state of the packer, so that it can be persisted
+  ///            and restored with |SetState|.
+  ///
+  virtual std::vector<int32_t> GetState() const = 0;
+
+  //----------------------------------------------------------------------------
+  /// @brief     Replaces the rectangles of the packer with the ones described
+  ///            by a state that |GetState| returned for a packer of the same
+  ///            size.
+  ///
+  /// @return    Whether the state is valid. If it is not, the packer is left
+  ///            empty.
+  ///
+  virtual bool SetState(const std::vector<int32_t>& state) = 0;
+
  protected:
   RectanglePacker(int width, int height) : width_(width), height_(height) {
     FML_DCHECK(width >= 0);
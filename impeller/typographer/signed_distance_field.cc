@@ -0,0 +1,133 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "impeller/typographer/signed_distance_field.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace impeller {
+
+namespace {
+
+// Stands in for the distance to pixels that are not on the other side of
+// the outline.
+constexpr float kInfinity = 1e20f;
+
+// The scratch space of |DistanceTransform|, sized for the longest line.
+struct DistanceTransformBuffers {
+  explicit DistanceTransformBuffers(size_t length)
+      : f(length), v(length), z(length + 1u) {}
+
+  std::vector<float> f;
+  std::vector<int> v;
+  std::vector<float> z;
+};
+
+/// Replaces each of the |length| squared distances in |grid| that start at
+/// |offset| and are |stride| apart with the smallest sum of the squared
+/// distance of any of them and the square of the distance along the line
+/// to it.
+void DistanceTransform(std::vector<float>& grid,
+                       size_t offset,
+                       size_t stride,
+                       int length,
+                       DistanceTransformBuffers& buffers) {
+  std::vector<float>& f = buffers.f;
+  std::vector<int>& v = buffers.v;
+  std::vector<float>& z = buffers.z;
+
+  // Compute the lower envelope of the parabolas rooted at each sample.
+  f[0] = grid[offset];
+  v[0] = 0;
+  z[0] = -kInfinity;
+  z[1] = kInfinity;
+  int k = 0;
+  for (int q = 1; q < length; q++) {
+    f[q] = grid[offset + q * stride];
+    float s;
+    do {
+      int r = v[k];
+      s = (f[q] - f[r] + static_cast<float>(q * q - r * r)) /
+          static_cast<float>(q - r) / 2.0f;
+    } while (s <= z[k] && --k > -1);
+    k++;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = kInfinity;
+  }
+
+  k = 0;
+  for (int q = 0; q < length; q++) {
+    while (z[k + 1] < static_cast<float>(q)) {
+      k++;
+    }
+    int r = v[k];
+    float distance = static_cast<float>(q - r);
+    grid[offset + q * stride] = f[r] + distance * distance;
+  }
+}
+
+void DistanceTransform2D(std::vector<float>& grid,
+                         size_t width,
+                         size_t height,
+                         DistanceTransformBuffers& buffers) {
+  for (size_t x = 0; x < width; x++) {
+    DistanceTransform(grid, x, width, static_cast<int>(height), buffers);
+  }
+  for (size_t y = 0; y < height; y++) {
+    DistanceTransform(grid, y * width, 1u, static_cast<int>(width), buffers);
+  }
+}
+
+}  // namespace
+
+void ConvertCoverageToSignedDistanceField(uint8_t* pixels,
+                                          size_t width,
+                                          size_t height,
+                                          size_t row_bytes,
+                                          Scalar spread) {
+  if (!pixels || width == 0u || height == 0u || spread <= 0) {
+    return;
+  }
+
+  // The squared distances to the nearest pixel inside of the glyph for the
+  // pixels outside of it, and the other way around.
+  std::vector<float> outer(width * height);
+  std::vector<float> inner(width * height);
+  for (size_t y = 0; y < height; y++) {
+    const uint8_t* row = pixels + y * row_bytes;
+    for (size_t x = 0; x < width; x++) {
+      size_t index = y * width + x;
+      if (row[x] == 255u) {
+        outer[index] = 0;
+        inner[index] = kInfinity;
+      } else if (row[x] == 0u) {
+        outer[index] = kInfinity;
+        inner[index] = 0;
+      } else {
+        float distance = 0.5f - row[x] / 255.0f;
+        outer[index] = distance > 0 ? distance * distance : 0;
+        inner[index] = distance < 0 ? distance * distance : 0;
+      }
+    }
+  }
+
+  DistanceTransformBuffers buffers(std::max(width, height));
+  DistanceTransform2D(outer, width, height, buffers);
+  DistanceTransform2D(inner, width, height, buffers);
+
+  for (size_t y = 0; y < height; y++) {
+    uint8_t* row = pixels + y * row_bytes;
+    for (size_t x = 0; x < width; x++) {
+      size_t index = y * width + x;
+      float distance = std::sqrt(outer[index]) - std::sqrt(inner[index]);
+      float value = std::clamp(0.5f - distance / (2.0f * spread), 0.0f, 1.0f);
+      row[x] = static_cast<uint8_t>(std::round(value * 255.0f));
+    }
+  }
+}
+
+}  // namespace impeller
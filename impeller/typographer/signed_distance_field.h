@@ -0,0 +1,46 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_IMPELLER_TYPOGRAPHER_SIGNED_DISTANCE_FIELD_H_
+#define FLUTTER_IMPELLER_TYPOGRAPHER_SIGNED_DISTANCE_FIELD_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "impeller/geometry/scalar.h"
+
+namespace impeller {
+
+//------------------------------------------------------------------------------
+/// @brief      Converts the 8-bit coverage of a glyph to a signed distance
+///             field in place.
+///
+///             Each pixel becomes 0.5 - d / (2 * spread), clamped to [0, 1],
+///             where d is the distance in pixels from its center to the
+///             outline of the glyph, negative inside of it. So the outline
+///             is at 0.5, and pixels that are |spread| pixels or more
+///             outside of it are 0.
+///
+///             The distances are exact Euclidean distances to the pixels on
+///             the other side of the outline, computed in linear time with
+///             the algorithm of Felzenszwalb and Huttenlocher. Pixels with
+///             partial coverage are taken to be crossed by the outline, at a
+///             distance from their center given by their coverage.
+///
+/// @param[in]  pixels     The first pixel of the glyph.
+/// @param[in]  width      The width of the glyph in pixels.
+/// @param[in]  height     The height of the glyph in pixels.
+/// @param[in]  row_bytes  The distance in bytes between rows of pixels.
+/// @param[in]  spread     The distance that the field extends to around
+///                        the outline.
+///
+void ConvertCoverageToSignedDistanceField(uint8_t* pixels,
+                                          size_t width,
+                                          size_t height,
+                                          size_t row_bytes,
+                                          Scalar spread);
+
+}  // namespace impeller
+
+#endif  // FLUTTER_IMPELLER_TYPOGRAPHER_SIGNED_DISTANCE_FIELD_H_
@@ -3,6 +3,10 @@
 // found in the LICENSE file.
 
 #include "impeller/typographer/text_frame.h"
+
+#include <algorithm>
+#include <limits>
+
 #include "impeller/typographer/font.h"
 #include "impeller/typographer/font_glyph_pair.h"
 
@@ -32,6 +36,25 @@ GlyphAtlas::Type TextFrame::GetAtlasType() const {
                     : GlyphAtlas::Type::kAlphaBitmap;
 }
 
+GlyphAtlas::Type TextFrame::GetAtlasType(Scalar scale,
+                                         bool stroke,
+                                         bool scale_animating) const {
+  if (has_color_ || stroke || runs_.empty()) {
+    return GetAtlasType();
+  }
+  Scalar min_point_size = std::numeric_limits<Scalar>::max();
+  for (const TextRun& run : runs_) {
+    min_point_size =
+        std::min(min_point_size, run.GetFont().GetMetrics().point_size);
+  }
+  Scalar min_size = min_point_size * scale;
+  if (min_size >= kDistanceFieldMinimumSize ||
+      (min_size >= kAnimatedDistanceFieldMinimumSize && scale_animating)) {
+    return GlyphAtlas::Type::kSignedDistanceField;
+  }
+  return GlyphAtlas::Type::kAlphaBitmap;
+}
+
 bool TextFrame::HasColor() const {
   return has_color_;
 }
@@ -46,6 +69,19 @@ Scalar TextFrame::RoundScaledFontSize(Scalar scale, Scalar point_size) {
   return std::clamp(result, 0.0f, kMaximumTextScale);
 }
 
+// static
+Font TextFrame::GetDistanceFieldFont(const Font& font) {
+  Font::Metrics metrics = font.GetMetrics();
+  metrics.point_size = GlyphAtlas::kDistanceFieldFontSize;
+  return Font(font.GetTypeface(), metrics, AxisAlignment::kNone);
+}
+
+// static
+Scalar TextFrame::GetDistanceFieldScale(Scalar point_size) {
+  return point_size > 0 ? GlyphAtlas::kDistanceFieldFontSize / point_size
+                        : 1.0f;
+}
+
 static constexpr Scalar ComputeFractionalPosition(Scalar value) {
   value += 0.125;
   value = (value - floorf(value));
@@ -107,4 +143,15 @@ void TextFrame::CollectUniqueFontGlyphPairs(
   }
 }
 
+void TextFrame::CollectDistanceFieldGlyphs(FontGlyphMap& glyph_map) const {
+  for (const TextRun& run : GetRuns()) {
+    auto& set =
+        glyph_map[ScaledFont{GetDistanceFieldFont(run.GetFont()), 1.0f}];
+    for (const TextRun::GlyphPosition& glyph_position :
+         run.GetGlyphPositions()) {
+      set.emplace(glyph_position.glyph, Point(0, 0), std::nullopt);
+    }
+  }
+}
+
 }  // namespace impeller
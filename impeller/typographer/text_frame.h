@@ -37,6 +37,26 @@ class TextFrame {
 
   static Scalar RoundScaledFontSize(Scalar scale, Scalar point_size);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Adds the glyphs of this frame to |glyph_map| as they are
+  ///             stored in a signed distance field atlas, where a single
+  ///             entry serves every size and scale a glyph is drawn at.
+  ///
+  void CollectDistanceFieldGlyphs(FontGlyphMap& glyph_map) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      The font that the glyphs of |font| are stored with in a
+  ///             signed distance field atlas, at a scale of 1.
+  ///
+  static Font GetDistanceFieldFont(const Font& font);
+
+  //----------------------------------------------------------------------------
+  /// @brief      The scale from the coordinates of the glyphs of a font of
+  ///             |point_size| to the pixels of a signed distance field
+  ///             atlas.
+  ///
+  static Scalar GetDistanceFieldScale(Scalar point_size);
+
   //----------------------------------------------------------------------------
   /// @brief      The conservative bounding box for this text frame.
   ///
@@ -69,9 +89,31 @@ class TextFrame {
   bool HasColor() const;
 
   //----------------------------------------------------------------------------
-  /// @brief      The type of atlas this run should be emplaced in.
+  /// @brief      The type of bitmap atlas this run should be emplaced in.
   GlyphAtlas::Type GetAtlasType() const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      The type of atlas this run should be emplaced in when it is
+  ///             drawn at |scale|, with a stroke if |stroke| is true, and
+  ///             |scale_animating| if its scale changed in recent frames.
+  ///
+  ///             Glyphs without color or stroke are drawn from a signed
+  ///             distance field when they are large, or while the scale of
+  ///             the frame is animating, so that they do not fill the atlas
+  ///             with a bitmap for every size they are drawn at.
+  GlyphAtlas::Type GetAtlasType(Scalar scale,
+                                bool stroke,
+                                bool scale_animating) const;
+
+  /// The size in pixels above which glyphs are always drawn from a signed
+  /// distance field.
+  static constexpr Scalar kDistanceFieldMinimumSize = 64.0f;
+
+  /// The size in pixels above which glyphs are drawn from a signed distance
+  /// field while the scale of their frame is animating. Smaller glyphs keep
+  /// the hinting of their bitmaps.
+  static constexpr Scalar kAnimatedDistanceFieldMinimumSize = 16.0f;
+
   TextFrame& operator=(TextFrame&& other) = default;
 
   TextFrame(const TextFrame& other) = default;
@@ -0,0 +1,202 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/benchmarking/benchmarking.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "flutter/display_list/testing/dl_test_snippets.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "impeller/core/device_buffer.h"
+#include "impeller/core/host_buffer.h"
+#include "impeller/renderer/testing/mocks.h"
+#include "impeller/typographer/backends/skia/text_frame_skia.h"
+#include "impeller/typographer/backends/skia/typographer_context_skia.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+#include "third_party/skia/include/core/SkTypeface.h"
+
+namespace impeller {
+
+namespace {
+
+using ::testing::NiceMock;
+using ::testing::Return;
+
+/// A device buffer in host memory, so that the glyphs can be drawn into the
+/// host buffer without a GPU.
+class HostMemoryDeviceBuffer final : public DeviceBuffer {
+ public:
+  explicit HostMemoryDeviceBuffer(const DeviceBufferDescriptor& desc)
+      : DeviceBuffer(desc), contents_(desc.size) {}
+
+  bool SetLabel(std::string_view label) override { return true; }
+
+  bool SetLabel(std::string_view label, Range range) override { return true; }
+
+  uint8_t* OnGetContents() const override {
+    return const_cast<uint8_t*>(contents_.data());
+  }
+
+ private:
+  std::vector<uint8_t> contents_;
+
+  bool OnCopyHostBuffer(const uint8_t* source,
+                        Range source_range,
+                        size_t offset) override {
+    std::memcpy(contents_.data() + offset, source + source_range.offset,
+                source_range.length);
+    return true;
+  }
+};
+
+/// A texture that drops its contents. The uploads of the atlas are encoded
+/// into a mock blit pass, so only the time spent on the CPU is measured.
+class NullTexture final : public Texture {
+ public:
+  explicit NullTexture(const TextureDescriptor& desc) : Texture(desc) {}
+
+  void SetLabel(std::string_view label) override {}
+
+  void SetLabel(std::string_view label, std::string_view trailing) override {}
+
+  bool IsValid() const override { return true; }
+
+  ISize GetSize() const override { return GetTextureDescriptor().size; }
+
+ private:
+  bool OnSetContents(const uint8_t* contents,
+                     size_t length,
+                     size_t slice) override {
+    return true;
+  }
+
+  bool OnSetContents(std::shared_ptr<const fml::Mapping> mapping,
+                     size_t slice) override {
+    return true;
+  }
+};
+
+class HostMemoryAllocator final : public Allocator {
+ public:
+  ISize GetMaxTextureSizeSupported() const override { return {4096, 4096}; }
+
+ private:
+  std::shared_ptr<DeviceBuffer> OnCreateBuffer(
+      const DeviceBufferDescriptor& desc) override {
+    return std::make_shared<HostMemoryDeviceBuffer>(desc);
+  }
+
+  std::shared_ptr<Texture> OnCreateTexture(
+      const TextureDescriptor& desc) override {
+    return std::make_shared<NullTexture>(desc);
+  }
+};
+
+/// A context whose command buffers accept any blit and are never executed.
+std::shared_ptr<Context> CreateHostMemoryContext() {
+  auto context = std::make_shared<NiceMock<testing::MockImpellerContext>>();
+  auto allocator = std::make_shared<HostMemoryAllocator>();
+  auto capabilities = std::make_shared<NiceMock<testing::MockCapabilities>>();
+  ON_CALL(*capabilities, GetDefaultGlyphAtlasFormat)
+      .WillByDefault(Return(PixelFormat::kA8UNormInt));
+  auto command_queue = std::make_shared<NiceMock<testing::MockCommandQueue>>();
+  // The capabilities are returned by reference, so the action keeps a copy
+  // of the pointer to them.
+  std::shared_ptr<const Capabilities> const_capabilities = capabilities;
+  ON_CALL(*context, IsValid).WillByDefault(Return(true));
+  ON_CALL(*context, GetResourceAllocator).WillByDefault(Return(allocator));
+  ON_CALL(*context, GetCapabilities)
+      .WillByDefault(
+          [const_capabilities]() -> const std::shared_ptr<const Capabilities>& {
+            return const_capabilities;
+          });
+  ON_CALL(*context, GetCommandQueue).WillByDefault(Return(command_queue));
+  std::weak_ptr<const Context> weak_context = context;
+  ON_CALL(*context, CreateCommandBuffer).WillByDefault([weak_context]() {
+    auto command_buffer =
+        std::make_shared<NiceMock<testing::MockCommandBuffer>>(weak_context);
+    ON_CALL(*command_buffer, IsValid).WillByDefault(Return(true));
+    ON_CALL(*command_buffer, OnCreateBlitPass).WillByDefault([]() {
+      auto blit_pass = std::make_shared<NiceMock<testing::MockBlitPass>>();
+      ON_CALL(*blit_pass, IsValid).WillByDefault(Return(true));
+      ON_CALL(*blit_pass, EncodeCommands).WillByDefault(Return(true));
+      ON_CALL(*blit_pass, OnCopyBufferToTextureCommand)
+          .WillByDefault(Return(true));
+      return blit_pass;
+    });
+    return command_buffer;
+  });
+  return context;
+}
+
+/// Every glyph of the test font at enough scales for |glyph_count| unique
+/// glyphs.
+FontGlyphMap CollectGlyphs(size_t glyph_count) {
+  SkFont sk_font = flutter::testing::CreateTestFontOfSize(12);
+  int font_glyph_count = sk_font.getTypeface()->countGlyphs();
+  SkTextBlobBuilder builder;
+  auto buffer = builder.allocRunPos(sk_font, font_glyph_count);
+  for (int i = 0; i < font_glyph_count; i++) {
+    buffer.glyphs[i] = i;
+    buffer.points()[i] = SkPoint::Make(0, 0);
+  }
+  auto frame = MakeTextFrameFromTextBlobSkia(builder.make());
+
+  FontGlyphMap font_glyph_map;
+  size_t unique_glyph_count = 0u;
+  for (int i = 0; unique_glyph_count < glyph_count; i++) {
+    frame->CollectUniqueFontGlyphPairs(font_glyph_map, 1.0f + 0.05f * i,
+                                       {0, 0}, {});
+    unique_glyph_count = 0u;
+    for (const auto& [scaled_font, glyphs] : font_glyph_map) {
+      unique_glyph_count += glyphs.size();
+    }
+  }
+  return font_glyph_map;
+}
+
+}  // namespace
+
+static void BM_CreateGlyphAtlas(benchmark::State& state, bool concurrent) {
+  std::shared_ptr<fml::ConcurrentMessageLoop> loop;
+  std::shared_ptr<fml::ConcurrentTaskRunner> runner;
+  if (concurrent) {
+    loop = fml::ConcurrentMessageLoop::Create();
+    runner = loop->GetTaskRunner();
+  }
+  auto typographer_context = TypographerContextSkia::Make(runner);
+  std::shared_ptr<Context> context = CreateHostMemoryContext();
+  FontGlyphMap font_glyph_map = CollectGlyphs(state.range(0));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto host_buffer = HostBuffer::Create(context->GetResourceAllocator());
+    auto atlas_context = typographer_context->CreateGlyphAtlasContext(
+        GlyphAtlas::Type::kAlphaBitmap);
+    state.ResumeTiming();
+
+    auto atlas = typographer_context->CreateGlyphAtlas(
+        *context, GlyphAtlas::Type::kAlphaBitmap, *host_buffer, atlas_context,
+        font_glyph_map);
+    if (!atlas) {
+      state.SkipWithError("Could not create the glyph atlas.");
+      break;
+    }
+    benchmark::DoNotOptimize(atlas);
+  }
+  state.counters["Glyphs"] = state.range(0);
+}
+
+BENCHMARK_CAPTURE(BM_CreateGlyphAtlas, Serial, false)
+    ->RangeMultiplier(4)
+    ->Range(80, 5120)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_CreateGlyphAtlas, Concurrent, true)
+    ->RangeMultiplier(4)
+    ->Range(80, 5120)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace impeller
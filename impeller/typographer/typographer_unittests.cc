@@ -3,6 +3,10 @@
 // found in the LICENSE file.
 
 #include "flutter/display_list/testing/dl_test_snippets.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/testing/testing.h"
 #include "gtest/gtest.h"
 #include "impeller/core/host_buffer.h"
@@ -11,8 +15,10 @@
 #include "impeller/typographer/backends/skia/text_frame_skia.h"
 #include "impeller/typographer/backends/skia/typographer_context_skia.h"
 #include "impeller/typographer/font_glyph_pair.h"
+#include "impeller/typographer/glyph_atlas_disk_cache.h"
 #include "impeller/typographer/lazy_glyph_atlas.h"
 #include "impeller/typographer/rectangle_packer.h"
+#include "impeller/typographer/signed_distance_field.h"
 #include "third_party/skia/include/core/SkFont.h"
 #include "third_party/skia/include/core/SkFontMgr.h"
 #include "third_party/skia/include/core/SkRect.h"
@@ -137,14 +143,14 @@ TEST_P(TypographerTest, LazyAtlasTracksColor) {
 
   LazyGlyphAtlas lazy_atlas(TypographerContextSkia::Make());
 
-  lazy_atlas.AddTextFrame(*frame, 1.0f, {0, 0}, {});
+  lazy_atlas.AddTextFrame(frame, 1.0f, {0, 0}, {});
 
   frame = MakeTextFrameFromTextBlobSkia(
       SkTextBlob::MakeFromString("😀 ", emoji_font));
 
   ASSERT_TRUE(frame->GetAtlasType() == GlyphAtlas::Type::kColorBitmap);
 
-  lazy_atlas.AddTextFrame(*frame, 1.0f, {0, 0}, {});
+  lazy_atlas.AddTextFrame(frame, 1.0f, {0, 0}, {});
 
   // Creates different atlases for color and red bitmap.
   auto color_atlas = lazy_atlas.CreateOrGetGlyphAtlas(
@@ -263,7 +269,7 @@ TEST_P(TypographerTest, GlyphAtlasTextureIsRecycledIfUnchanged) {
       CreateGlyphAtlas(*GetContext(), context.get(), *host_buffer,
                        GlyphAtlas::Type::kAlphaBitmap, 1.0f, atlas_context,
                        *MakeTextFrameFromTextBlobSkia(blob));
-  auto old_packer = atlas_context->GetRectPacker();
+  auto old_packer = atlas_context->GetRectPacker(0);
 
   ASSERT_NE(atlas, nullptr);
   ASSERT_NE(atlas->GetTexture(), nullptr);
@@ -281,7 +287,7 @@ TEST_P(TypographerTest, GlyphAtlasTextureIsRecycledIfUnchanged) {
   ASSERT_EQ(atlas, next_atlas);
   auto* second_texture = next_atlas->GetTexture().get();
 
-  auto new_packer = atlas_context->GetRectPacker();
+  auto new_packer = atlas_context->GetRectPacker(0);
 
   ASSERT_EQ(second_texture, first_texture);
   ASSERT_EQ(old_packer, new_packer);
@@ -416,45 +422,239 @@ TEST(TypographerTest, RectanglePackerFillsRows) {
   EXPECT_EQ(loc.y(), 16);
 }
 
-TEST_P(TypographerTest, GlyphAtlasTextureWillGrowTilMaxTextureSize) {
-  if (GetBackend() == PlaygroundBackend::kOpenGLES) {
-    GTEST_SKIP() << "Atlas growth isn't supported for OpenGLES currently.";
+TEST(TypographerTest, RectanglePackerStateCanBeRestored) {
+  auto packer = RectanglePacker::Factory(200, 100);
+  IPoint16 loc;
+  ASSERT_TRUE(packer->AddRect(20, 30, &loc));
+  ASSERT_TRUE(packer->AddRect(50, 10, &loc));
+  ASSERT_TRUE(packer->AddRect(10, 40, &loc));
+
+  auto restored = RectanglePacker::Factory(200, 100);
+  ASSERT_TRUE(restored->SetState(packer->GetState()));
+  EXPECT_EQ(restored->PercentFull(), packer->PercentFull());
+  EXPECT_EQ(restored->GetState(), packer->GetState());
+
+  // Both packers place the next rectangles in the same places.
+  for (int i = 0; i < 10; i++) {
+    IPoint16 expected;
+    IPoint16 actual;
+    ASSERT_EQ(packer->AddRect(30, 20, &expected),
+              restored->AddRect(30, 20, &actual));
+    EXPECT_EQ(expected.x(), actual.x());
+    EXPECT_EQ(expected.y(), actual.y());
   }
 
+  // States that do not describe a skyline across the packer are rejected.
+  auto invalid = RectanglePacker::Factory(200, 100);
+  ASSERT_TRUE(invalid->AddRect(20, 30, &loc));
+  EXPECT_FALSE(invalid->SetState({}));
+  EXPECT_EQ(invalid->PercentFull(), 0);
+  EXPECT_FALSE(invalid->SetState({0, 0, 0, 100}));
+  EXPECT_FALSE(invalid->SetState({0, 0, 0, 100, 120, 0, 100}));
+  EXPECT_FALSE(invalid->SetState({0, 0, 101, 200}));
+  EXPECT_FALSE(RectanglePacker::Factory(100, 100)->SetState(
+      packer->GetState()));
+}
+
+TEST_P(TypographerTest, GlyphAtlasIsRestoredFromDiskCache) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto directory = std::make_shared<fml::UniqueFD>(fml::OpenDirectory(
+      temp_dir.path().c_str(), false, fml::FilePermission::kReadWrite));
   auto host_buffer = HostBuffer::Create(GetContext()->GetResourceAllocator());
   auto context = TypographerContextSkia::Make();
-  auto atlas_context =
-      context->CreateGlyphAtlasContext(GlyphAtlas::Type::kAlphaBitmap);
   ASSERT_TRUE(context && context->IsValid());
   SkFont sk_font = flutter::testing::CreateTestFontOfSize(12);
-  auto blob = SkTextBlob::MakeFromString("A", sk_font);
-  ASSERT_TRUE(blob);
+  auto frame = MakeTextFrameFromTextBlobSkia(
+      SkTextBlob::MakeFromString("the quick brown fox", sk_font));
+
+  auto make_atlas_context = [&]() {
+    auto atlas_context =
+        context->CreateGlyphAtlasContext(GlyphAtlas::Type::kAlphaBitmap);
+    auto disk_cache = std::make_shared<GlyphAtlasDiskCache>(
+        directory, GlyphAtlas::Type::kAlphaBitmap, 1u);
+    disk_cache->Load();
+    atlas_context->SetDiskCache(disk_cache);
+    return atlas_context;
+  };
+
+  std::vector<std::pair<Rect, Rect>> positions;
+  {
+    auto atlas_context = make_atlas_context();
+    EXPECT_EQ(atlas_context->GetDiskCache()->GetGlyphCount(), 0u);
+    auto atlas =
+        CreateGlyphAtlas(*GetContext(), context.get(), *host_buffer,
+                         GlyphAtlas::Type::kAlphaBitmap, 2.0f, atlas_context,
+                         *frame);
+    ASSERT_NE(atlas, nullptr);
+    EXPECT_EQ(atlas_context->GetDiskCache()->GetGlyphCount(),
+              atlas->GetGlyphCount());
+    atlas->IterateGlyphs([&](const ScaledFont& scaled_font,
+                             const SubpixelGlyph& glyph, const Rect&) {
+      positions.push_back(
+          atlas->FindFontGlyphBounds(FontGlyphPair(scaled_font, glyph))
+              .value());
+      return true;
+    });
+    // The cache is written when it is destroyed.
+  }
+  EXPECT_TRUE(fml::FileExists(
+      *directory,
+      GlyphAtlasDiskCache::GetFileName(GlyphAtlas::Type::kAlphaBitmap)));
+
+  auto atlas_context = make_atlas_context();
+  EXPECT_EQ(atlas_context->GetDiskCache()->GetGlyphCount(), positions.size());
+  EXPECT_EQ(atlas_context->GetDiskCache()->GetPages().size(), 1u);
   auto atlas =
       CreateGlyphAtlas(*GetContext(), context.get(), *host_buffer,
-                       GlyphAtlas::Type::kAlphaBitmap, 1.0f, atlas_context,
-                       *MakeTextFrameFromTextBlobSkia(blob));
-  // Continually append new glyphs until the glyph size grows to the maximum.
-  // Note that the sizes here are more or less experimentally determined, but
-  // the important expectation is that the atlas size will shrink again after
-  // growing to the maximum size.
-  constexpr ISize expected_sizes[13] = {
-      {4096, 4096},   //
-      {4096, 4096},   //
-      {4096, 8192},   //
-      {4096, 8192},   //
-      {4096, 8192},   //
-      {4096, 8192},   //
-      {4096, 16384},  //
-      {4096, 16384},  //
-      {4096, 16384},  //
-      {4096, 16384},  //
-      {4096, 16384},  //
-      {4096, 16384},  //
-      {4096, 4096}    // Shrinks!
+                       GlyphAtlas::Type::kAlphaBitmap, 2.0f, atlas_context,
+                       *frame);
+  ASSERT_NE(atlas, nullptr);
+  EXPECT_EQ(atlas->GetPageCount(), 1u);
+  EXPECT_EQ(atlas->GetGlyphCount(), positions.size());
+  std::vector<std::pair<Rect, Rect>> restored_positions;
+  atlas->IterateGlyphs([&](const ScaledFont& scaled_font,
+                           const SubpixelGlyph& glyph, const Rect&) {
+    restored_positions.push_back(
+        atlas->FindFontGlyphBounds(FontGlyphPair(scaled_font, glyph)).value());
+    return true;
+  });
+  ASSERT_EQ(restored_positions.size(), positions.size());
+  for (const auto& position : positions) {
+    EXPECT_NE(std::find(restored_positions.begin(), restored_positions.end(),
+                        position),
+              restored_positions.end());
+  }
+
+  // New glyphs are packed around the restored ones.
+  auto new_frame = MakeTextFrameFromTextBlobSkia(
+      SkTextBlob::MakeFromString("JUMPED", sk_font));
+  atlas = CreateGlyphAtlas(*GetContext(), context.get(), *host_buffer,
+                           GlyphAtlas::Type::kAlphaBitmap, 2.0f, atlas_context,
+                           *new_frame);
+  ASSERT_NE(atlas, nullptr);
+  atlas->IterateGlyphs([&](const ScaledFont& scaled_font,
+                           const SubpixelGlyph& glyph, const Rect&) {
+    auto bounds =
+        atlas->FindFontGlyphBounds(FontGlyphPair(scaled_font, glyph)).value();
+    if (std::find(positions.begin(), positions.end(), bounds) ==
+        positions.end()) {
+      for (const auto& [position, glyph_bounds] : positions) {
+        EXPECT_FALSE(bounds.first.IntersectsWithRect(position));
+      }
+    }
+    return true;
+  });
+}
+
+TEST(TypographerTest, CorruptGlyphAtlasDiskCacheIsDeleted) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto directory = std::make_shared<fml::UniqueFD>(fml::OpenDirectory(
+      temp_dir.path().c_str(), false, fml::FilePermission::kReadWrite));
+  const char* file_name =
+      GlyphAtlasDiskCache::GetFileName(GlyphAtlas::Type::kAlphaBitmap);
+  const char kGarbage[] = "garbage";
+  fml::DataMapping garbage(std::vector<uint8_t>(kGarbage, kGarbage + 7));
+  ASSERT_TRUE(fml::WriteAtomically(*directory, file_name, garbage));
+
+  GlyphAtlasDiskCache disk_cache(directory, GlyphAtlas::Type::kAlphaBitmap,
+                                 1u);
+  EXPECT_FALSE(disk_cache.Load());
+  EXPECT_EQ(disk_cache.GetGlyphCount(), 0u);
+  EXPECT_TRUE(disk_cache.GetPages().empty());
+  EXPECT_FALSE(fml::FileExists(*directory, file_name));
+}
+
+TEST(TypographerTest, GlyphAtlasDiskCacheWaitsForGlyphsToSettle) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto directory = std::make_shared<fml::UniqueFD>(fml::OpenDirectory(
+      temp_dir.path().c_str(), false, fml::FilePermission::kReadWrite));
+  const char* file_name =
+      GlyphAtlasDiskCache::GetFileName(GlyphAtlas::Type::kAlphaBitmap);
+
+  {
+    GlyphAtlasDiskCache disk_cache(directory,
+                                   GlyphAtlas::Type::kAlphaBitmap, 1u);
+    GlyphAtlasDiskCache::Glyph glyph;
+    glyph.position = IRect::MakeXYWH(1, 1, 2, 2);
+    glyph.bounds = Rect::MakeXYWH(0, -2, 2, 2);
+    glyph.pixels = std::make_shared<std::vector<uint8_t>>(4u, 0xFF);
+    disk_cache.AddGlyph("glyph", std::move(glyph));
+    disk_cache.SetPages(ISize(16, 16), {{ISize(16, 16), {}}});
+
+    // Glyphs were just added, so more are likely to follow.
+    disk_cache.StoreIfNeeded();
+    EXPECT_FALSE(fml::FileExists(*directory, file_name));
+  }
+
+  // The cache is written when it is destroyed.
+  EXPECT_TRUE(fml::FileExists(*directory, file_name));
+  GlyphAtlasDiskCache disk_cache(directory, GlyphAtlas::Type::kAlphaBitmap,
+                                 1u);
+  EXPECT_TRUE(disk_cache.Load());
+  EXPECT_EQ(disk_cache.GetGlyphCount(), 1u);
+}
+
+TEST(TypographerTest, GlyphAtlasDiskCacheSkipsStaleWrites) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto directory = std::make_shared<fml::UniqueFD>(fml::OpenDirectory(
+      temp_dir.path().c_str(), false, fml::FilePermission::kReadWrite));
+  auto loop = fml::ConcurrentMessageLoop::Create(1u);
+  auto task_runner = loop->GetTaskRunner();
+  fml::AutoResetWaitableEvent blocked;
+  fml::AutoResetWaitableEvent release;
+  // Hold the worker, so that the posted write runs after the cache is
+  // destroyed.
+  task_runner->PostTask([&blocked, &release]() {
+    blocked.Signal();
+    release.Wait();
+  });
+  blocked.Wait();
+
+  auto add_glyph = [](GlyphAtlasDiskCache& disk_cache, std::string key) {
+    GlyphAtlasDiskCache::Glyph glyph;
+    glyph.position = IRect::MakeXYWH(1, 1, 2, 2);
+    glyph.bounds = Rect::MakeXYWH(0, -2, 2, 2);
+    glyph.pixels = std::make_shared<std::vector<uint8_t>>(4u, 0xFF);
+    disk_cache.AddGlyph(std::move(key), std::move(glyph));
   };
+  {
+    GlyphAtlasDiskCache disk_cache(
+        directory, GlyphAtlas::Type::kAlphaBitmap, 1u, task_runner);
+    disk_cache.SetPages(ISize(16, 16), {{ISize(16, 16), {}}});
+    add_glyph(disk_cache, "first");
+    disk_cache.Store();
+    add_glyph(disk_cache, "second");
+  }
+  // The single worker runs the tasks in order, so the posted write is done
+  // once this task runs.
+  fml::AutoResetWaitableEvent written;
+  task_runner->PostTask([&written]() { written.Signal(); });
+  release.Signal();
+  written.Wait();
+
+  // The older snapshot with a single glyph did not overwrite the file the
+  // destructor wrote.
+  GlyphAtlasDiskCache disk_cache(directory, GlyphAtlas::Type::kAlphaBitmap,
+                                 1u);
+  EXPECT_TRUE(disk_cache.Load());
+  EXPECT_EQ(disk_cache.GetGlyphCount(), 2u);
+}
+
+TEST_P(TypographerTest, GlyphAtlasReusesLeastRecentlyUsedPages) {
+  auto host_buffer = HostBuffer::Create(GetContext()->GetResourceAllocator());
+  auto context = TypographerContextSkia::Make();
+  auto atlas_context =
+      context->CreateGlyphAtlasContext(GlyphAtlas::Type::kAlphaBitmap);
+  ASSERT_TRUE(context && context->IsValid());
+  // Small pages, so that each of the large glyphs needs a page of its own.
+  atlas_context->SetAtlasSize(ISize(128, 128));
 
   SkFont sk_font_small = flutter::testing::CreateTestFontOfSize(10);
+  std::shared_ptr<GlyphAtlas> first_atlas;
+  Texture* first_texture = nullptr;
 
+  // Every frame adds a new large glyph, and reuses a small glyph. The page
+  // budget runs out long before the last frame.
   for (int i = 0; i < 13; i++) {
     SkTextBlobBuilder builder;
 
@@ -465,24 +665,362 @@ TEST_P(TypographerTest, GlyphAtlasTextureWillGrowTilMaxTextureSize) {
       sk_font.getPos(buffer.glyphs, count, buffer.points(), {0, 0});
     };
 
-    SkFont sk_font = flutter::testing::CreateTestFontOfSize(50 + i);
+    SkFont sk_font = flutter::testing::CreateTestFontOfSize(110 + i * 4);
     add_char(sk_font, 'A');
     add_char(sk_font_small, 'B');
-    auto blob = builder.make();
+    auto frame = MakeTextFrameFromTextBlobSkia(builder.make());
 
-    atlas =
-        CreateGlyphAtlas(*GetContext(), context.get(), *host_buffer,
-                         GlyphAtlas::Type::kAlphaBitmap, 50 + i, atlas_context,
-                         *MakeTextFrameFromTextBlobSkia(blob));
+    auto atlas = CreateGlyphAtlas(*GetContext(), context.get(), *host_buffer,
+                                  GlyphAtlas::Type::kAlphaBitmap, 1.0f,
+                                  atlas_context, *frame);
+    ASSERT_TRUE(!!atlas);
+    if (i == 0) {
+      first_atlas = atlas;
+      first_texture = atlas->GetTexture().get();
+    }
+
+    // The atlas is updated in place rather than rebuilt.
+    EXPECT_EQ(atlas, first_atlas);
+    EXPECT_EQ(atlas->GetPageCount(), atlas_context->GetPageCount());
+    EXPECT_LE(atlas->GetPageCount(), GlyphAtlasContext::kMaxPageCount);
+
+    FontGlyphMap font_glyph_map;
+    frame->CollectUniqueFontGlyphPairs(font_glyph_map, 1.0f, {0, 0}, {});
+    for (const auto& [scaled_font, glyphs] : font_glyph_map) {
+      for (const SubpixelGlyph& glyph : glyphs) {
+        const GlyphAtlasEntry* entry =
+            atlas->GetFontGlyphAtlas(scaled_font.font, scaled_font.scale)
+                ->FindGlyph(glyph);
+        ASSERT_NE(entry, nullptr);
+        EXPECT_EQ(entry->last_used_frame, atlas_context->GetCurrentFrame());
+      }
+    }
+  }
+
+  EXPECT_GT(atlas_context->GetEvictedPageCount(), 0u);
+  EXPECT_GT(atlas_context->GetEvictedGlyphCount(), 0u);
+  EXPECT_GT(atlas_context->GetOccupancy(), 0.0f);
+  // The first page holds the small glyph, which every frame uses, so it is
+  // never reused.
+  EXPECT_EQ(first_atlas->GetTexture().get(), first_texture);
+}
+
+TEST_P(TypographerTest, GlyphAtlasStaysWithinPageBudgetAsGlyphsGrow) {
+  auto host_buffer = HostBuffer::Create(GetContext()->GetResourceAllocator());
+  auto context = TypographerContextSkia::Make();
+  auto atlas_context =
+      context->CreateGlyphAtlasContext(GlyphAtlas::Type::kAlphaBitmap);
+  ASSERT_TRUE(context && context->IsValid());
+  atlas_context->SetAtlasSize(ISize(128, 128));
+
+  // The first frame leaves a small page that no later frame uses, and every
+  // later frame adds a glyph larger than any page so far.
+  for (int i = 0; i < 13; i++) {
+    SkTextBlobBuilder builder;
+    SkFont sk_font =
+        flutter::testing::CreateTestFontOfSize(i == 0 ? 10 : 80 + i * 30);
+    char c = i == 0 ? 'B' : 'A';
+    int count = sk_font.countText(&c, 1, SkTextEncoding::kUTF8);
+    auto buffer = builder.allocRunPos(sk_font, count);
+    sk_font.textToGlyphs(&c, 1, SkTextEncoding::kUTF8, buffer.glyphs, count);
+    sk_font.getPos(buffer.glyphs, count, buffer.points(), {0, 0});
+    auto frame = MakeTextFrameFromTextBlobSkia(builder.make());
+
+    auto atlas = CreateGlyphAtlas(*GetContext(), context.get(), *host_buffer,
+                                  GlyphAtlas::Type::kAlphaBitmap, 1.0f,
+                                  atlas_context, *frame);
     ASSERT_TRUE(!!atlas);
-    EXPECT_EQ(atlas->GetTexture()->GetTextureDescriptor().size,
-              expected_sizes[i]);
+    EXPECT_EQ(atlas->GetPageCount(), atlas_context->GetPageCount());
+    EXPECT_LE(atlas->GetPageCount(), GlyphAtlasContext::kMaxPageCount);
+
+    FontGlyphMap font_glyph_map;
+    frame->CollectUniqueFontGlyphPairs(font_glyph_map, 1.0f, {0, 0}, {});
+    for (const auto& [scaled_font, glyphs] : font_glyph_map) {
+      for (const SubpixelGlyph& glyph : glyphs) {
+        EXPECT_TRUE(
+            atlas->FindFontGlyphBounds({scaled_font, glyph}).has_value());
+      }
+    }
+  }
+
+  // The small page was reused for a larger glyph instead of being kept.
+  EXPECT_GT(atlas_context->GetEvictedPageCount(), 0u);
+}
+
+TEST_P(TypographerTest, GlyphAtlasReleasesPagesOverBudget) {
+  auto host_buffer = HostBuffer::Create(GetContext()->GetResourceAllocator());
+  auto context = TypographerContextSkia::Make();
+  auto atlas_context =
+      context->CreateGlyphAtlasContext(GlyphAtlas::Type::kAlphaBitmap);
+  ASSERT_TRUE(context && context->IsValid());
+  atlas_context->SetAtlasSize(ISize(128, 128));
+
+  auto make_frame = [](int glyph_count) {
+    SkTextBlobBuilder builder;
+    for (int i = 0; i < glyph_count; i++) {
+      // Each of these glyphs needs a page of its own.
+      SkFont sk_font = flutter::testing::CreateTestFontOfSize(110 + i * 10);
+      char c = 'A';
+      int count = sk_font.countText(&c, 1, SkTextEncoding::kUTF8);
+      auto buffer = builder.allocRunPos(sk_font, count);
+      sk_font.textToGlyphs(&c, 1, SkTextEncoding::kUTF8, buffer.glyphs, count);
+      sk_font.getPos(buffer.glyphs, count, buffer.points(), {0, 0});
+    }
+    return MakeTextFrameFromTextBlobSkia(builder.make());
+  };
+
+  // A single frame that uses more glyphs than fit in the budget grows the
+  // atlas past it.
+  auto large_frame = make_frame(GlyphAtlasContext::kMaxPageCount + 2);
+  auto atlas = CreateGlyphAtlas(*GetContext(), context.get(), *host_buffer,
+                                GlyphAtlas::Type::kAlphaBitmap, 1.0f,
+                                atlas_context, *large_frame);
+  ASSERT_TRUE(!!atlas);
+  EXPECT_EQ(atlas->GetPageCount(), GlyphAtlasContext::kMaxPageCount + 2);
+
+  // The next frame no longer uses the extra pages, which are released.
+  auto small_frame = make_frame(1);
+  atlas = CreateGlyphAtlas(*GetContext(), context.get(), *host_buffer,
+                           GlyphAtlas::Type::kAlphaBitmap, 1.0f, atlas_context,
+                           *small_frame);
+  ASSERT_TRUE(!!atlas);
+  EXPECT_EQ(atlas->GetPageCount(), GlyphAtlasContext::kMaxPageCount);
+  EXPECT_EQ(atlas_context->GetPageCount(), GlyphAtlasContext::kMaxPageCount);
+  EXPECT_EQ(atlas->GetGlyphCount(), GlyphAtlasContext::kMaxPageCount);
+
+  FontGlyphMap font_glyph_map;
+  small_frame->CollectUniqueFontGlyphPairs(font_glyph_map, 1.0f, {0, 0}, {});
+  for (const auto& [scaled_font, glyphs] : font_glyph_map) {
+    for (const SubpixelGlyph& glyph : glyphs) {
+      EXPECT_TRUE(atlas->FindFontGlyphBounds({scaled_font, glyph}).has_value());
+    }
+  }
+}
+
+TEST_P(TypographerTest, GlyphAtlasRasterizesGlyphsConcurrently) {
+  SkFont sk_font = flutter::testing::CreateTestFontOfSize(12);
+  int font_glyph_count = sk_font.getTypeface()->countGlyphs();
+  ASSERT_GT(font_glyph_count, 0);
+  SkTextBlobBuilder builder;
+  auto buffer = builder.allocRunPos(sk_font, font_glyph_count);
+  for (int i = 0; i < font_glyph_count; i++) {
+    buffer.glyphs[i] = i;
+    buffer.points()[i] = SkPoint::Make(0, 0);
+  }
+  auto frame = MakeTextFrameFromTextBlobSkia(builder.make());
+
+  // Collect every glyph of the font at enough scales for 5,000 unique glyphs,
+  // the order of magnitude of the first frame of a CJK heavy screen.
+  constexpr size_t kUniqueGlyphCount = 5000u;
+  FontGlyphMap font_glyph_map;
+  size_t unique_glyph_count = 0u;
+  for (int i = 0; unique_glyph_count < kUniqueGlyphCount; i++) {
+    frame->CollectUniqueFontGlyphPairs(font_glyph_map, 1.0f + 0.05f * i,
+                                       {0, 0}, {});
+    unique_glyph_count = 0u;
+    for (const auto& [scaled_font, glyphs] : font_glyph_map) {
+      unique_glyph_count += glyphs.size();
+    }
+  }
+
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  auto serial_context = TypographerContextSkia::Make();
+  auto concurrent_context = TypographerContextSkia::Make(loop->GetTaskRunner());
+  // The timings are measured by BM_CreateGlyphAtlas in
+  // typographer_benchmarks.
+  auto create_atlas = [&](const TypographerContext& context) {
+    auto host_buffer =
+        HostBuffer::Create(GetContext()->GetResourceAllocator());
+    auto atlas_context =
+        context.CreateGlyphAtlasContext(GlyphAtlas::Type::kAlphaBitmap);
+    return context.CreateGlyphAtlas(
+        *GetContext(), GlyphAtlas::Type::kAlphaBitmap, *host_buffer,
+        atlas_context, font_glyph_map);
+  };
+  auto serial_atlas = create_atlas(*serial_context);
+  auto concurrent_atlas = create_atlas(*concurrent_context);
+  ASSERT_NE(serial_atlas, nullptr);
+  ASSERT_NE(concurrent_atlas, nullptr);
+  EXPECT_EQ(concurrent_atlas->GetGlyphCount(), unique_glyph_count);
+  EXPECT_EQ(concurrent_atlas->GetTexture()->GetSize(),
+            serial_atlas->GetTexture()->GetSize());
+  serial_atlas->IterateGlyphs([&](const ScaledFont& scaled_font,
+                                  const SubpixelGlyph& glyph,
+                                  const Rect& rect) {
+    auto bounds = concurrent_atlas->FindFontGlyphBounds(
+        FontGlyphPair(scaled_font, glyph));
+    EXPECT_TRUE(bounds.has_value());
+    EXPECT_EQ(bounds->first, rect);
+    return bounds.has_value();
+  });
+
+  // Glyphs appended to an existing atlas are rasterized concurrently too.
+  auto host_buffer = HostBuffer::Create(GetContext()->GetResourceAllocator());
+  auto atlas_context = concurrent_context->CreateGlyphAtlasContext(
+      GlyphAtlas::Type::kAlphaBitmap);
+  auto blob = SkTextBlob::MakeFromString("A", sk_font);
+  auto atlas =
+      CreateGlyphAtlas(*GetContext(), concurrent_context.get(), *host_buffer,
+                       GlyphAtlas::Type::kAlphaBitmap, 1.0f, atlas_context,
+                       *MakeTextFrameFromTextBlobSkia(blob));
+  ASSERT_NE(atlas, nullptr);
+  atlas = concurrent_context->CreateGlyphAtlas(
+      *GetContext(), GlyphAtlas::Type::kAlphaBitmap, *host_buffer,
+      atlas_context, font_glyph_map);
+  ASSERT_NE(atlas, nullptr);
+  EXPECT_GE(atlas->GetGlyphCount(), unique_glyph_count);
+}
+
+TEST(TypographerTest, CoverageIsConvertedToSignedDistanceField) {
+  // A disk with a radius of 10 pixels and anti-aliased edges.
+  constexpr size_t kSize = 40u;
+  constexpr Scalar kSpread = 8.0f;
+  std::vector<uint8_t> pixels(kSize * kSize);
+  auto distance_to_disk = [](size_t x, size_t y) {
+    return Point(x + 0.5f, y + 0.5f).GetDistance(Point(20, 20)) - 10.0f;
+  };
+  for (size_t y = 0; y < kSize; y++) {
+    for (size_t x = 0; x < kSize; x++) {
+      Scalar coverage = std::clamp(0.5f - distance_to_disk(x, y), 0.0f, 1.0f);
+      pixels[y * kSize + x] = static_cast<uint8_t>(std::round(coverage * 255));
+    }
+  }
+
+  ConvertCoverageToSignedDistanceField(pixels.data(), kSize, kSize, kSize,
+                                       kSpread);
+
+  for (size_t y = 0; y < kSize; y++) {
+    for (size_t x = 0; x < kSize; x++) {
+      Scalar expected =
+          std::clamp(0.5f - distance_to_disk(x, y) / (2 * kSpread), 0.0f,
+                     1.0f) *
+          255;
+      // The distances are measured to pixel centers, which are up to a
+      // pixel off of the outline.
+      EXPECT_NEAR(pixels[y * kSize + x], expected, 255 / (2 * kSpread) + 1)
+          << "at " << x << ", " << y;
+    }
+  }
+  EXPECT_EQ(pixels[0], 0u);
+  EXPECT_EQ(pixels[20 * kSize + 20], 255u);
+}
+
+TEST_P(TypographerTest, LargeAndAnimatedTextUsesDistanceFieldAtlas) {
+  SkFont sk_font = flutter::testing::CreateTestFontOfSize(12);
+  auto frame =
+      MakeTextFrameFromTextBlobSkia(SkTextBlob::MakeFromString("abc", sk_font));
+
+  EXPECT_EQ(frame->GetAtlasType(1.0f, false, false),
+            GlyphAtlas::Type::kAlphaBitmap);
+  EXPECT_EQ(frame->GetAtlasType(6.0f, false, false),
+            GlyphAtlas::Type::kSignedDistanceField);
+  // Stroked glyphs are always bitmaps.
+  EXPECT_EQ(frame->GetAtlasType(6.0f, true, false),
+            GlyphAtlas::Type::kAlphaBitmap);
+  EXPECT_EQ(frame->GetAtlasType(2.5f, false, true),
+            GlyphAtlas::Type::kSignedDistanceField);
+  // Small animated text keeps its bitmaps.
+  EXPECT_EQ(frame->GetAtlasType(1.0f, false, true),
+            GlyphAtlas::Type::kAlphaBitmap);
+
+  LazyGlyphAtlas lazy_atlas(TypographerContextSkia::Make());
+  auto add_text_frame = [&lazy_atlas](const std::shared_ptr<TextFrame>& frame,
+                                      Scalar scale) {
+    lazy_atlas.AddTextFrame(frame, scale, {0, 0}, {});
+  };
+
+  // A frame drawn at the same scale is not animating, even when it is drawn
+  // at another scale in the same frame.
+  add_text_frame(frame, 2.0f);
+  lazy_atlas.ResetTextFrames();
+  add_text_frame(frame, 2.0f);
+  add_text_frame(frame, 3.0f);
+  EXPECT_FALSE(lazy_atlas.IsScaleAnimating(*frame));
+  EXPECT_EQ(lazy_atlas.GetAtlasType(*frame, 2.0f, false),
+            GlyphAtlas::Type::kAlphaBitmap);
+
+  lazy_atlas.ResetTextFrames();
+  add_text_frame(frame, 2.5f);
+  EXPECT_TRUE(lazy_atlas.IsScaleAnimating(*frame));
+  EXPECT_EQ(lazy_atlas.GetAtlasType(*frame, 2.5f, false),
+            GlyphAtlas::Type::kSignedDistanceField);
+
+  // Each text frame has its own history.
+  auto other_frame =
+      MakeTextFrameFromTextBlobSkia(SkTextBlob::MakeFromString("abc", sk_font));
+  add_text_frame(other_frame, 2.5f);
+  EXPECT_FALSE(lazy_atlas.IsScaleAnimating(*other_frame));
+
+  // The frame settles after being drawn at the same scale for a while.
+  for (uint32_t i = 0; i < LazyGlyphAtlas::kScaleSettleFrames; i++) {
+    EXPECT_TRUE(lazy_atlas.IsScaleAnimating(*frame));
+    lazy_atlas.ResetTextFrames();
+    add_text_frame(frame, 2.5f);
   }
+  EXPECT_FALSE(lazy_atlas.IsScaleAnimating(*frame));
+  EXPECT_EQ(lazy_atlas.GetAtlasType(*frame, 2.5f, false),
+            GlyphAtlas::Type::kAlphaBitmap);
+
+  // Color glyphs are always bitmaps.
+#if FML_OS_MACOSX
+  auto mapping = flutter::testing::OpenFixtureAsSkData("Apple Color Emoji.ttc");
+#else
+  auto mapping = flutter::testing::OpenFixtureAsSkData("NotoColorEmoji.ttf");
+#endif
+  ASSERT_TRUE(mapping);
+  sk_sp<SkFontMgr> font_mgr = txt::GetDefaultFontManager();
+  SkFont emoji_font(font_mgr->makeFromData(mapping), 50.0);
+  auto emoji_frame = MakeTextFrameFromTextBlobSkia(
+      SkTextBlob::MakeFromString("😀 ", emoji_font));
+  EXPECT_EQ(emoji_frame->GetAtlasType(10.0f, false, true),
+            GlyphAtlas::Type::kColorBitmap);
+}
 
-  // The final atlas should contain both the "A" glyph (which was not present
-  // in the previous atlas) and the "B" glyph (which existed in the previous
-  // atlas).
-  ASSERT_EQ(atlas->GetGlyphCount(), 2u);
+TEST_P(TypographerTest, DistanceFieldAtlasEntriesServeAllSizes) {
+  auto host_buffer = HostBuffer::Create(GetContext()->GetResourceAllocator());
+  auto context = TypographerContextSkia::Make();
+  auto atlas_context =
+      context->CreateGlyphAtlasContext(GlyphAtlas::Type::kSignedDistanceField);
+  ASSERT_TRUE(context && context->IsValid());
+
+  std::shared_ptr<GlyphAtlas> first_atlas;
+  size_t glyph_count = 0u;
+  for (int size : {12, 30, 75, 200}) {
+    SkFont sk_font = flutter::testing::CreateTestFontOfSize(size);
+    auto frame = MakeTextFrameFromTextBlobSkia(
+        SkTextBlob::MakeFromString("the quick brown fox", sk_font));
+    FontGlyphMap font_glyph_map;
+    frame->CollectDistanceFieldGlyphs(font_glyph_map);
+    auto atlas = context->CreateGlyphAtlas(
+        *GetContext(), GlyphAtlas::Type::kSignedDistanceField, *host_buffer,
+        atlas_context, font_glyph_map);
+    ASSERT_NE(atlas, nullptr);
+    if (!first_atlas) {
+      first_atlas = atlas;
+      glyph_count = atlas->GetGlyphCount();
+    }
+    // No glyphs are added for the other sizes.
+    EXPECT_EQ(atlas, first_atlas);
+    EXPECT_EQ(atlas->GetGlyphCount(), glyph_count);
+    EXPECT_EQ(atlas->GetPageCount(), 1u);
+  }
+  EXPECT_GT(glyph_count, 0u);
+  EXPECT_EQ(first_atlas->GetTexture()->GetTextureDescriptor().format,
+            GetContext()->GetCapabilities()->GetDefaultGlyphAtlasFormat());
+
+  // Each visible glyph is surrounded by the spread of its distance field.
+  first_atlas->IterateGlyphs([](const ScaledFont& scaled_font,
+                                const SubpixelGlyph&, const Rect& rect) {
+    EXPECT_EQ(scaled_font.font.GetMetrics().point_size,
+              GlyphAtlas::kDistanceFieldFontSize);
+    EXPECT_EQ(scaled_font.scale, 1.0f);
+    if (rect.IsEmpty()) {
+      return true;
+    }
+    EXPECT_GE(rect.GetWidth(), 2 * GlyphAtlas::kDistanceFieldSpread);
+    EXPECT_GE(rect.GetHeight(), 2 * GlyphAtlas::kDistanceFieldSpread);
+    return true;
+  });
 }
 
 }  // namespace testing
@@ -6,6 +6,7 @@
 
 #include "flutter/lib/ui/painting/canvas.h"
 #include "flutter/lib/ui/painting/picture.h"
+#include "flutter/lib/ui/ui_dart_state.h"
 #include "third_party/tonic/converter/dart_converter.h"
 #include "third_party/tonic/dart_args.h"
 #include "third_party/tonic/dart_binding_macros.h"
@@ -28,6 +29,10 @@ PictureRecorder::~PictureRecorder() {}
 sk_sp<DisplayListBuilder> PictureRecorder::BeginRecording(SkRect bounds) {
   display_list_builder_ =
       sk_make_sp<DisplayListBuilder>(bounds, /*prepare_rtree=*/true);
+  if (UIDartState* state = UIDartState::Current()) {
+    display_list_builder_->SetAttributeInterner(
+        state->GetDisplayListAttributeInterner());
+  }
   return display_list_builder_;
 }
 
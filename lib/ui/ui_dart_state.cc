@@ -71,6 +71,7 @@ UIDartState::UIDartState(
       unhandled_exception_callback_(std::move(unhandled_exception_callback)),
       log_message_callback_(std::move(log_message_callback)),
       isolate_name_server_(std::move(isolate_name_server)),
+      attribute_interner_(DlAttributeInterner::Make()),
       context_(context) {
   AddOrRemoveTaskObserver(true /* add */);
 }
@@ -203,6 +204,11 @@ std::shared_ptr<IsolateNameServer> UIDartState::GetIsolateNameServer() const {
   return isolate_name_server_;
 }
 
+std::shared_ptr<DlAttributeInterner>
+UIDartState::GetDisplayListAttributeInterner() const {
+  return attribute_interner_;
+}
+
 tonic::DartErrorHandleType UIDartState::GetLastError() {
   tonic::DartErrorHandleType error = message_handler().isolate_last_error();
   if (error == tonic::kNoError) {
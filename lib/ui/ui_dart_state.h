@@ -11,6 +11,7 @@
 
 #include "flutter/common/settings.h"
 #include "flutter/common/task_runners.h"
+#include "flutter/display_list/dl_attribute_interner.h"
 #include "flutter/fml/build_config.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/fml/synchronization/waitable_event.h"
@@ -144,6 +145,10 @@ class UIDartState : public tonic::DartState {
 
   std::shared_ptr<IsolateNameServer> GetIsolateNameServer() const;
 
+  /// The table of canonical DisplayList attributes shared by all of the
+  /// pictures recorded in this isolate.
+  std::shared_ptr<DlAttributeInterner> GetDisplayListAttributeInterner() const;
+
   tonic::DartErrorHandleType GetLastError();
 
   // Logs `print` messages from the application via an embedder-specified
@@ -206,6 +211,7 @@ class UIDartState : public tonic::DartState {
   UnhandledExceptionCallback unhandled_exception_callback_;
   LogMessageCallback log_message_callback_;
   const std::shared_ptr<IsolateNameServer> isolate_name_server_;
+  const std::shared_ptr<DlAttributeInterner> attribute_interner_;
   UIDartState::Context context_;
 
   void AddOrRemoveTaskObserver(bool add);
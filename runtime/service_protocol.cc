@@ -39,6 +39,9 @@ const std::string_view
         "_flutter.estimateRasterCacheMemory";
 const std::string_view ServiceProtocol::kReloadAssetFonts =
     "_flutter.reloadAssetFonts";
+const std::string_view
+    ServiceProtocol::kGetFrameTimingPercentilesExtensionName =
+        "_flutter.getFrameTimingPercentiles";
 
 static constexpr std::string_view kViewIdPrefx = "_flutterView/";
 static constexpr std::string_view kListViewsExtensionName =
@@ -59,6 +62,7 @@ ServiceProtocol::ServiceProtocol()
           kGetSkSLsExtensionName,
           kEstimateRasterCacheMemoryExtensionName,
           kReloadAssetFonts,
+          kGetFrameTimingPercentilesExtensionName,
       }) {}
 
 ServiceProtocol::~ServiceProtocol() {
@@ -6,6 +6,7 @@
 
 #include "flutter/common/constants.h"
 #include "flutter/flow/frame_timings.h"
+#include "flutter/fml/logging.h"
 #include "flutter/fml/time/time_point.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/dart/runtime/include/dart_tools_api.h"
@@ -20,26 +21,45 @@ namespace {
 constexpr fml::TimeDelta kNotifyIdleTaskWaitTime =
     fml::TimeDelta::FromMilliseconds(51);
 
+uint32_t GetPipelineDepth(const TaskRunners& task_runners,
+                          const Settings& settings) {
+  bool threads_merged = task_runners.GetPlatformTaskRunner() ==
+                        task_runners.GetRasterTaskRunner();
+  if (settings.frame_pipeline_depth > 0) {
+    // Frames are rasterized on the thread that produces them, so there is
+    // never more than one of them in flight.
+    if (threads_merged && settings.frame_pipeline_depth > 1) {
+      FML_LOG(WARNING) << "A frame pipeline depth of "
+                       << settings.frame_pipeline_depth
+                       << " was requested but the platform and raster threads "
+                          "are merged, using a depth of 1 instead.";
+      return 1;
+    }
+    return settings.frame_pipeline_depth;
+  }
+#if SHELL_ENABLE_METAL
+  return 2;
+#else   // SHELL_ENABLE_METAL
+  // TODO(dnfield): We should remove this logic and set the pipeline depth
+  // back to 2 in this case. See
+  // https://github.com/flutter/engine/pull/9132 for discussion.
+  return threads_merged ? 1 : 2;
+#endif  // SHELL_ENABLE_METAL
+}
+
 }  // namespace
 
 Animator::Animator(Delegate& delegate,
                    const TaskRunners& task_runners,
-                   std::unique_ptr<VsyncWaiter> waiter)
+                   std::unique_ptr<VsyncWaiter> waiter,
+                   const Settings& settings)
     : delegate_(delegate),
       task_runners_(task_runners),
       waiter_(std::move(waiter)),
-#if SHELL_ENABLE_METAL
-      layer_tree_pipeline_(std::make_shared<FramePipeline>(2)),
-#else   // SHELL_ENABLE_METAL
-      // TODO(dnfield): We should remove this logic and set the pipeline depth
-      // back to 2 in this case. See
-      // https://github.com/flutter/engine/pull/9132 for discussion.
       layer_tree_pipeline_(std::make_shared<FramePipeline>(
-          task_runners.GetPlatformTaskRunner() ==
-                  task_runners.GetRasterTaskRunner()
-              ? 1
-              : 2)),
-#endif  // SHELL_ENABLE_METAL
+          GetPipelineDepth(task_runners, settings),
+          settings.frame_pipeline_policy,
+          settings.frame_pipeline_max_latency)),
       pending_frame_semaphore_(1),
       weak_factory_(this) {
 }
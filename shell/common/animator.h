@@ -7,6 +7,7 @@
 
 #include <deque>
 
+#include "flutter/common/settings.h"
 #include "flutter/common/task_runners.h"
 #include "flutter/flow/frame_timings.h"
 #include "flutter/fml/memory/ref_ptr.h"
@@ -47,7 +48,8 @@ class Animator final {
 
   Animator(Delegate& delegate,
            const TaskRunners& task_runners,
-           std::unique_ptr<VsyncWaiter> waiter);
+           std::unique_ptr<VsyncWaiter> waiter,
+           const Settings& settings);
 
   ~Animator();
 
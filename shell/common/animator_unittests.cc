@@ -144,7 +144,7 @@ TEST_F(ShellTest, AnimatorDoesNotNotifyIdleBeforeRender) {
     auto vsync_waiter = static_cast<std::unique_ptr<VsyncWaiter>>(
         std::make_unique<ShellTestVsyncWaiter>(task_runners, clock));
     animator = std::make_unique<Animator>(delegate, task_runners,
-                                          std::move(vsync_waiter));
+                                          std::move(vsync_waiter), Settings());
     latch.Signal();
   });
   latch.Wait();
@@ -232,7 +232,7 @@ TEST_F(ShellTest, AnimatorDoesNotNotifyDelegateIfPipelineIsNotEmpty) {
     auto vsync_waiter = static_cast<std::unique_ptr<VsyncWaiter>>(
         std::make_unique<ShellTestVsyncWaiter>(task_runners, clock));
     animator = std::make_unique<Animator>(delegate, task_runners,
-                                          std::move(vsync_waiter));
+                                          std::move(vsync_waiter), Settings());
   });
 
   fml::AutoResetWaitableEvent begin_frame_latch;
@@ -297,12 +297,14 @@ TEST_F(EngineAnimatorTest, AnimatorAcceptsMultipleRenders) {
 
   std::unique_ptr<Animator> animator;
   PostSync(task_runners_.GetUITaskRunner(),
-           [&animator, &animator_delegate, &task_runners = task_runners_] {
+           [&animator, &animator_delegate, &task_runners = task_runners_,
+            &settings = settings_] {
              animator = std::make_unique<Animator>(
                  animator_delegate, task_runners,
                  static_cast<std::unique_ptr<VsyncWaiter>>(
                      std::make_unique<testing::ConstantFiringVsyncWaiter>(
-                         task_runners)));
+                         task_runners)),
+                 settings);
            });
 
   engine_context = EngineContext::Create(delegate_, settings_, task_runners_,
@@ -357,12 +359,14 @@ TEST_F(EngineAnimatorTest, IgnoresOutOfFrameRenders) {
 
   std::unique_ptr<Animator> animator;
   PostSync(task_runners_.GetUITaskRunner(),
-           [&animator, &animator_delegate, &task_runners = task_runners_] {
+           [&animator, &animator_delegate, &task_runners = task_runners_,
+            &settings = settings_] {
              animator = std::make_unique<Animator>(
                  animator_delegate, task_runners,
                  static_cast<std::unique_ptr<VsyncWaiter>>(
                      std::make_unique<testing::ConstantFiringVsyncWaiter>(
-                         task_runners)));
+                         task_runners)),
+                 settings);
            });
 
   engine_context = EngineContext::Create(delegate_, settings_, task_runners_,
@@ -435,12 +439,14 @@ TEST_F(EngineAnimatorTest, IgnoresDuplicateRenders) {
 
   std::unique_ptr<Animator> animator;
   PostSync(task_runners_.GetUITaskRunner(),
-           [&animator, &animator_delegate, &task_runners = task_runners_] {
+           [&animator, &animator_delegate, &task_runners = task_runners_,
+            &settings = settings_] {
              animator = std::make_unique<Animator>(
                  animator_delegate, task_runners,
                  static_cast<std::unique_ptr<VsyncWaiter>>(
                      std::make_unique<testing::ConstantFiringVsyncWaiter>(
-                         task_runners)));
+                         task_runners)),
+                 settings);
            });
 
   engine_context = EngineContext::Create(delegate_, settings_, task_runners_,
@@ -488,12 +494,14 @@ TEST_F(EngineAnimatorTest, AnimatorSubmitsImplicitViewBeforeDrawFrameEnds) {
 
   std::unique_ptr<Animator> animator;
   PostSync(task_runners_.GetUITaskRunner(),
-           [&animator, &animator_delegate, &task_runners = task_runners_] {
+           [&animator, &animator_delegate, &task_runners = task_runners_,
+            &settings = settings_] {
              animator = std::make_unique<Animator>(
                  animator_delegate, task_runners,
                  static_cast<std::unique_ptr<VsyncWaiter>>(
                      std::make_unique<testing::ConstantFiringVsyncWaiter>(
-                         task_runners)));
+                         task_runners)),
+                 settings);
            });
 
   native_latch.Reset();
@@ -555,12 +563,14 @@ TEST_F(EngineAnimatorTest, AnimatorSubmitWarmUpImplicitView) {
 
   std::unique_ptr<Animator> animator;
   PostSync(task_runners_.GetUITaskRunner(),
-           [&animator, &animator_delegate, &task_runners = task_runners_] {
+           [&animator, &animator_delegate, &task_runners = task_runners_,
+            &settings = settings_] {
              animator = std::make_unique<Animator>(
                  animator_delegate, task_runners,
                  static_cast<std::unique_ptr<VsyncWaiter>>(
                      std::make_unique<testing::ConstantFiringVsyncWaiter>(
-                         task_runners)));
+                         task_runners)),
+                 settings);
            });
 
   engine_context = EngineContext::Create(delegate_, settings_, task_runners_,
@@ -625,12 +635,14 @@ TEST_F(EngineAnimatorTest, AnimatorSubmitPartialViewsForWarmUp) {
 
   std::unique_ptr<Animator> animator;
   PostSync(task_runners_.GetUITaskRunner(),
-           [&animator, &animator_delegate, &task_runners = task_runners_] {
+           [&animator, &animator_delegate, &task_runners = task_runners_,
+            &settings = settings_] {
              animator = std::make_unique<Animator>(
                  animator_delegate, task_runners,
                  static_cast<std::unique_ptr<VsyncWaiter>>(
                      std::make_unique<testing::ConstantFiringVsyncWaiter>(
-                         task_runners)));
+                         task_runners)),
+                 settings);
            });
 
   engine_context = EngineContext::Create(delegate_, settings_, task_runners_,
@@ -5,15 +5,17 @@
 #ifndef FLUTTER_SHELL_COMMON_PIPELINE_H_
 #define FLUTTER_SHELL_COMMON_PIPELINE_H_
 
-#include <deque>
+#include <atomic>
 #include <memory>
-#include <mutex>
 
+#include "flutter/common/settings.h"
 #include "flutter/flow/frame_timings.h"
 #include "flutter/flow/layers/layer_tree.h"
+#include "flutter/fml/logging.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/synchronization/semaphore.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/fml/trace_event.h"
 
 namespace flutter {
@@ -50,6 +52,14 @@ size_t GetNextPipelineTraceID();
 /// calls `Complete` on the continuation, which enqueues the resource and
 /// signals the waiting consumer.
 ///
+/// The resources are kept in a lock-free ring buffer. Besides the producer,
+/// the consumer may put a resource back into an empty pipeline with
+/// |ProduceIfEmpty|, so slots of the ring are claimed with a compare and swap
+/// before they are filled in.
+///
+/// The |FramePipelinePolicy| decides which of the waiting resources
+/// |Consume| hands to the consumer. Resources that are skipped are dropped.
+///
 /// Pipelines generate the following tracing information:
 /// * PipelineItem: async flow tracking time taken from the time a producer
 ///   calls |Produce| to the time a consumer consumes calls |Consume|.
@@ -128,12 +138,38 @@ class Pipeline {
     FML_DISALLOW_COPY_AND_ASSIGN(ProducerContinuation);
   };
 
-  explicit Pipeline(uint32_t depth)
-      : empty_(depth), available_(0), inflight_(0) {}
+  /// Creates a pipeline of at most |depth| resources. With
+  /// FramePipelinePolicy::kBoundedLatency, resources that waited for longer
+  /// than |max_latency| are dropped if there is a newer resource.
+  explicit Pipeline(uint32_t depth,
+                    FramePipelinePolicy policy = FramePipelinePolicy::kFifo,
+                    fml::TimeDelta max_latency = fml::TimeDelta::Max())
+      : depth_(depth),
+        policy_(policy),
+        max_latency_(max_latency),
+        capacity_(RingCapacity(depth)),
+        slots_(new Slot[capacity_]),
+        inflight_(0),
+        available_(0),
+        enqueue_position_(0),
+        dequeue_position_(0) {
+    for (size_t i = 0; i < capacity_; i++) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
 
   ~Pipeline() = default;
 
-  bool IsValid() const { return empty_.IsValid() && available_.IsValid(); }
+  bool IsValid() const {
+    for (size_t i = 0; i < capacity_; i++) {
+      if (!slots_[i].stored.IsValid()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  FramePipelinePolicy policy() const { return policy_; }
 
   /// Creates a `ProducerContinuation` that a producer can use to add a
   /// resource to the queue.
@@ -141,14 +177,9 @@ class Pipeline {
   /// If the queue is already at its maximum depth, the `ProducerContinuation`
   /// is returned with success = false.
   ProducerContinuation Produce() {
-    if (!empty_.TryWait()) {
+    if (!TryReserve()) {
       return {};
     }
-    ++inflight_;
-    FML_TRACE_COUNTER("flutter", "Pipeline Depth",
-                      reinterpret_cast<int64_t>(this),      //
-                      "frames in flight", inflight_.load()  //
-    );
 
     return ProducerContinuation{
         std::bind(&Pipeline::ProducerCommit, this, std::placeholders::_1,
@@ -162,14 +193,9 @@ class Pipeline {
   /// Prefer using |Produce|. ProducerContinuation returned by this method
   /// doesn't guarantee that the frame will be rendered.
   ProducerContinuation ProduceIfEmpty() {
-    if (!empty_.TryWait()) {
+    if (!TryReserve()) {
       return {};
     }
-    ++inflight_;
-    FML_TRACE_COUNTER("flutter", "Pipeline Depth",
-                      reinterpret_cast<int64_t>(this),      //
-                      "frames in flight", inflight_.load()  //
-    );
 
     return ProducerContinuation{
         std::bind(&Pipeline::ProducerCommitIfEmpty, this, std::placeholders::_1,
@@ -185,25 +211,29 @@ class Pipeline {
       return PipelineConsumeResult::NoneAvailable;
     }
 
-    if (!available_.TryWait()) {
+    size_t available = available_.load(std::memory_order_acquire);
+    if (available == 0) {
       return PipelineConsumeResult::NoneAvailable;
     }
 
     ResourcePtr resource;
     size_t trace_id = 0;
-    size_t items_count = 0;
+    fml::TimePoint commit_time;
+    size_t taken = 0;
+    do {
+      if (taken > 0) {
+        DropResource(std::move(resource), trace_id);
+      }
+      Dequeue(&resource, &trace_id, &commit_time);
+      taken++;
+    } while (taken < available && ShouldSkip(commit_time));
 
-    {
-      std::scoped_lock lock(queue_mutex_);
-      std::tie(resource, trace_id) = std::move(queue_.front());
-      queue_.pop_front();
-      items_count = queue_.size();
-    }
+    size_t items_count =
+        available_.fetch_sub(taken, std::memory_order_acq_rel) - taken;
 
     consumer(std::move(resource));
 
-    empty_.Signal();
-    --inflight_;
+    Release();
 
     TRACE_FLOW_END("flutter", "PipelineItem", trace_id);
     TRACE_EVENT_ASYNC_END0("flutter", "PipelineItem", trace_id);
@@ -213,42 +243,136 @@ class Pipeline {
   }
 
  private:
-  fml::Semaphore empty_;
-  fml::Semaphore available_;
+  struct Slot {
+    // Equal to the position of the slot in the ring when it is free, and to
+    // the position + 1 once the resource is stored in it.
+    std::atomic<size_t> sequence;
+    // Signaled once the resource is stored in the slot.
+    fml::Semaphore stored{0};
+    ResourcePtr resource;
+    size_t trace_id = 0;
+    fml::TimePoint commit_time;
+  };
+
+  const uint32_t depth_;
+  const FramePipelinePolicy policy_;
+  const fml::TimeDelta max_latency_;
+  const size_t capacity_;
+  const std::unique_ptr<Slot[]> slots_;
+  // The number of reserved resources, up to |depth_|.
   std::atomic<int> inflight_;
-  std::mutex queue_mutex_;
-  std::deque<std::pair<ResourcePtr, size_t>> queue_;
+  // The number of resources stored in the ring.
+  std::atomic<size_t> available_;
+  std::atomic<size_t> enqueue_position_;
+  std::atomic<size_t> dequeue_position_;
+
+  // The ring never holds more than |depth| resources. A power of two of at
+  // least 2 keeps the sequence of a free slot distinct from that of a full
+  // one.
+  static size_t RingCapacity(uint32_t depth) {
+    size_t capacity = 2;
+    while (capacity < depth) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  bool TryReserve() {
+    int inflight = inflight_.load(std::memory_order_relaxed);
+    do {
+      if (inflight >= static_cast<int>(depth_)) {
+        return false;
+      }
+    } while (!inflight_.compare_exchange_weak(inflight, inflight + 1,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_relaxed));
+    FML_TRACE_COUNTER("flutter", "Pipeline Depth",
+                      reinterpret_cast<int64_t>(this),  //
+                      "frames in flight", inflight + 1  //
+    );
+    return true;
+  }
+
+  void Release() { inflight_.fetch_sub(1, std::memory_order_acq_rel); }
+
+  /// Stores a resource in the slot at |position|, which the caller claimed
+  /// by advancing |enqueue_position_| past it, and returns whether it is the
+  /// only resource in the ring.
+  bool Enqueue(size_t position, ResourcePtr resource, size_t trace_id) {
+    Slot& slot = slots_[position & (capacity_ - 1)];
+    // The ring has room for every reserved resource, so the slot has been
+    // consumed since it was last used.
+    FML_DCHECK(slot.sequence.load(std::memory_order_acquire) == position);
+    slot.resource = std::move(resource);
+    slot.trace_id = trace_id;
+    slot.commit_time = fml::TimePoint::Now();
+    slot.sequence.store(position + 1, std::memory_order_release);
+    slot.stored.Signal();
+    return available_.fetch_add(1, std::memory_order_acq_rel) == 0;
+  }
+
+  /// Only called by the consumer, once |available_| says there is a
+  /// resource to take.
+  void Dequeue(ResourcePtr* resource,
+               size_t* trace_id,
+               fml::TimePoint* commit_time) {
+    size_t position = dequeue_position_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[position & (capacity_ - 1)];
+    // A resource stored after this one may have been counted already if
+    // the consumer put this one back while the producer was storing its
+    // own. The slot is filled in right after it is claimed.
+    FML_CHECK(slot.stored.Wait());
+    FML_DCHECK(slot.sequence.load(std::memory_order_acquire) == position + 1);
+    *resource = std::move(slot.resource);
+    *trace_id = slot.trace_id;
+    *commit_time = slot.commit_time;
+    slot.sequence.store(position + capacity_, std::memory_order_release);
+    dequeue_position_.store(position + 1, std::memory_order_release);
+  }
+
+  /// Whether a resource committed at |commit_time| should be dropped in
+  /// favor of the newer resource behind it.
+  bool ShouldSkip(fml::TimePoint commit_time) const {
+    switch (policy_) {
+      case FramePipelinePolicy::kFifo:
+        return false;
+      case FramePipelinePolicy::kLatestWins:
+        return true;
+      case FramePipelinePolicy::kBoundedLatency:
+        return fml::TimePoint::Now() - commit_time > max_latency_;
+    }
+    return false;
+  }
+
+  void DropResource(ResourcePtr resource, size_t trace_id) {
+    TRACE_EVENT0("flutter", "PipelineItemDropped");
+    resource.reset();
+    Release();
+    TRACE_FLOW_END("flutter", "PipelineItem", trace_id);
+    TRACE_EVENT_ASYNC_END0("flutter", "PipelineItem", trace_id);
+  }
 
   /// Commits a produced resource to the queue and signals the consumer that a
   /// resource is available.
   PipelineProduceResult ProducerCommit(ResourcePtr resource, size_t trace_id) {
-    bool is_first_item = false;
-    {
-      std::scoped_lock lock(queue_mutex_);
-      is_first_item = queue_.empty();
-      queue_.emplace_back(std::move(resource), trace_id);
-    }
-
-    // Ensure the queue mutex is not held as that would be a pessimization.
-    available_.Signal();
+    size_t position = enqueue_position_.fetch_add(1, std::memory_order_acq_rel);
+    bool is_first_item = Enqueue(position, std::move(resource), trace_id);
     return {.success = true, .is_first_item = is_first_item};
   }
 
   PipelineProduceResult ProducerCommitIfEmpty(ResourcePtr resource,
                                               size_t trace_id) {
-    {
-      std::scoped_lock lock(queue_mutex_);
-      if (!queue_.empty()) {
-        // Bail if the queue is not empty, opens up spaces to produce other
-        // frames.
-        empty_.Signal();
-        return {.success = false, .is_first_item = false};
-      }
-      queue_.emplace_back(std::move(resource), trace_id);
+    // Claiming the slot at the front of the ring only succeeds if no other
+    // slot has been claimed since the last resource was consumed.
+    size_t position = dequeue_position_.load(std::memory_order_acquire);
+    if (!enqueue_position_.compare_exchange_strong(
+            position, position + 1, std::memory_order_acq_rel)) {
+      // Bail if the queue is not empty, opens up spaces to produce other
+      // frames.
+      Release();
+      return {.success = false, .is_first_item = false};
     }
-
-    // Ensure the queue mutex is not held as that would be a pessimization.
-    available_.Signal();
+    Enqueue(position, std::move(resource), trace_id);
     return {.success = true, .is_first_item = true};
   }
 
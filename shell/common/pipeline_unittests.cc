@@ -6,9 +6,11 @@
 
 #include "flutter/shell/common/pipeline.h"
 
+#include <chrono>
 #include <functional>
 #include <future>
 #include <memory>
+#include <thread>
 
 #include "gtest/gtest.h"
 
@@ -144,5 +146,99 @@ TEST(PipelineTest, ProduceIfEmptySuccessfulIfQueueIsEmpty) {
   ASSERT_EQ(consume_result_1, PipelineConsumeResult::Done);
 }
 
+TEST(PipelineTest, LatestWinsConsumesNewestVal) {
+  const int depth = 3;
+  std::shared_ptr<IntPipeline> pipeline = std::make_shared<IntPipeline>(
+      depth, FramePipelinePolicy::kLatestWins);
+
+  for (int i = 1; i <= depth; i++) {
+    Continuation continuation = pipeline->Produce();
+    PipelineProduceResult result =
+        continuation.Complete(std::make_unique<int>(i));
+    ASSERT_EQ(result.success, true);
+    ASSERT_EQ(result.is_first_item, i == 1);
+  }
+
+  PipelineConsumeResult consume_result = pipeline->Consume(
+      [&](std::unique_ptr<int> v) { ASSERT_EQ(*v, depth); });
+  ASSERT_EQ(consume_result, PipelineConsumeResult::Done);
+
+  // The dropped values no longer count towards the depth.
+  for (int i = 0; i < depth; i++) {
+    ASSERT_TRUE(pipeline->Produce());
+  }
+}
+
+TEST(PipelineTest, BoundedLatencyDropsOnlyStaleVals) {
+  const int depth = 3;
+  std::shared_ptr<IntPipeline> pipeline = std::make_shared<IntPipeline>(
+      depth, FramePipelinePolicy::kBoundedLatency,
+      fml::TimeDelta::FromMilliseconds(1));
+
+  Continuation continuation_1 = pipeline->Produce();
+  Continuation continuation_2 = pipeline->Produce();
+  Continuation continuation_3 = pipeline->Produce();
+  ASSERT_TRUE(continuation_1.Complete(std::make_unique<int>(1)).success);
+  ASSERT_TRUE(continuation_2.Complete(std::make_unique<int>(2)).success);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  ASSERT_TRUE(continuation_3.Complete(std::make_unique<int>(3)).success);
+
+  // The first two values waited for too long, but the last one is consumed
+  // no matter how long it waited.
+  PipelineConsumeResult consume_result =
+      pipeline->Consume([](std::unique_ptr<int> v) { ASSERT_EQ(*v, 3); });
+  ASSERT_EQ(consume_result, PipelineConsumeResult::Done);
+}
+
+TEST(PipelineTest, BoundedLatencyKeepsFreshValsInOrder) {
+  const int depth = 2;
+  std::shared_ptr<IntPipeline> pipeline = std::make_shared<IntPipeline>(
+      depth, FramePipelinePolicy::kBoundedLatency,
+      fml::TimeDelta::FromSeconds(60));
+
+  Continuation continuation_1 = pipeline->Produce();
+  Continuation continuation_2 = pipeline->Produce();
+  ASSERT_TRUE(continuation_1.Complete(std::make_unique<int>(1)).success);
+  ASSERT_TRUE(continuation_2.Complete(std::make_unique<int>(2)).success);
+
+  PipelineConsumeResult consume_result_1 =
+      pipeline->Consume([](std::unique_ptr<int> v) { ASSERT_EQ(*v, 1); });
+  ASSERT_EQ(consume_result_1, PipelineConsumeResult::MoreAvailable);
+  PipelineConsumeResult consume_result_2 =
+      pipeline->Consume([](std::unique_ptr<int> v) { ASSERT_EQ(*v, 2); });
+  ASSERT_EQ(consume_result_2, PipelineConsumeResult::Done);
+}
+
+TEST(PipelineTest, ConsumesEveryValFromAnotherThread) {
+  const int depth = 2;
+  const int count = 10000;
+  std::shared_ptr<IntPipeline> pipeline = std::make_shared<IntPipeline>(depth);
+
+  std::thread producer([&]() {
+    for (int i = 0; i < count;) {
+      Continuation continuation = pipeline->Produce();
+      if (!continuation) {
+        std::this_thread::yield();
+        continue;
+      }
+      ASSERT_TRUE(continuation.Complete(std::make_unique<int>(i)).success);
+      i++;
+    }
+  });
+
+  int expected = 0;
+  while (expected < count) {
+    PipelineConsumeResult consume_result =
+        pipeline->Consume([&expected](std::unique_ptr<int> v) {
+          ASSERT_EQ(*v, expected);
+          expected++;
+        });
+    if (consume_result == PipelineConsumeResult::NoneAvailable) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -59,6 +59,10 @@ Rasterizer::Rasterizer(Delegate& delegate,
           SnapshotController::Make(*this, delegate.GetSettings())),
       weak_factory_(this) {
   FML_DCHECK(compositor_context_);
+#if !SLIMPELLER
+  compositor_context_->raster_cache().SetMaxBytes(
+      delegate.GetSettings().raster_cache_max_bytes_threshold);
+#endif  //  !SLIMPELLER
 }
 
 Rasterizer::~Rasterizer() = default;
@@ -77,6 +81,30 @@ void Rasterizer::SetImpellerContext(
   impeller_context_ = std::move(impeller_context);
 }
 
+void Rasterizer::EnableGlyphAtlasDiskCache(
+    std::shared_ptr<fml::UniqueFD> directory,
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner) {
+  glyph_atlas_directory_ = std::move(directory);
+  glyph_atlas_worker_task_runner_ = std::move(worker_task_runner);
+  if (surface_) {
+    SetupGlyphAtlasDiskCache();
+  }
+}
+
+void Rasterizer::SetupGlyphAtlasDiskCache() {
+#if IMPELLER_SUPPORTS_RENDERING
+  if (!glyph_atlas_directory_) {
+    return;
+  }
+  std::shared_ptr<impeller::AiksContext> aiks_context =
+      surface_->GetAiksContext();
+  if (aiks_context) {
+    aiks_context->GetContentContext().GetLazyGlyphAtlas()->EnableDiskCache(
+        glyph_atlas_directory_, glyph_atlas_worker_task_runner_);
+  }
+#endif  // IMPELLER_SUPPORTS_RENDERING
+}
+
 void Rasterizer::Setup(std::unique_ptr<Surface> surface) {
   surface_ = std::move(surface);
 
@@ -108,6 +136,8 @@ void Rasterizer::Setup(std::unique_ptr<Surface> surface) {
       }
     });
   }
+
+  SetupGlyphAtlasDiskCache();
 }
 
 void Rasterizer::TeardownExternalViewEmbedder() {
@@ -193,6 +223,7 @@ void Rasterizer::CollectView(int64_t view_id) {
     external_view_embedder_->CollectView(view_id);
   }
   view_records_.erase(view_id);
+  frame_phase_histograms_->RemoveView(view_id);
 }
 
 std::shared_ptr<flutter::TextureRegistry> Rasterizer::GetTextureRegistry() {
@@ -650,14 +681,20 @@ std::unique_ptr<FrameItem> Rasterizer::DrawToSurfacesUnsafe(
 
   // Second traverse: draw all layer trees.
   std::vector<std::unique_ptr<LayerTreeTask>> resubmitted_tasks;
+  std::vector<std::pair<int64_t, fml::TimeDelta>> view_raster_durations;
   for (std::unique_ptr<LayerTreeTask>& task : tasks) {
     int64_t view_id = task->view_id;
     std::unique_ptr<LayerTree> layer_tree = std::move(task->layer_tree);
     float device_pixel_ratio = task->device_pixel_ratio;
 
+    fml::TimePoint view_raster_start = fml::TimePoint::Now();
     DrawSurfaceStatus status = DrawToSurfaceUnsafe(
         view_id, *layer_tree, device_pixel_ratio, presentation_time);
     FML_DCHECK(status != DrawSurfaceStatus::kDiscarded);
+    if (status == DrawSurfaceStatus::kSuccess) {
+      view_raster_durations.emplace_back(
+          view_id, fml::TimePoint::Now() - view_raster_start);
+    }
 
     auto& view_record = EnsureViewRecord(task->view_id);
     view_record.last_draw_status = status;
@@ -671,8 +708,11 @@ std::unique_ptr<FrameItem> Rasterizer::DrawToSurfacesUnsafe(
   }
   // TODO(dkwingsmt): Pass in raster cache(s) for all views.
   // See https://github.com/flutter/flutter/issues/135530, item 4.
-  frame_timings_recorder.RecordRasterEnd(
+  FrameTiming timing = frame_timings_recorder.RecordRasterEnd(
       NOT_SLIMPELLER(&compositor_context_->raster_cache()));
+  for (const auto& [view_id, raster_duration] : view_raster_durations) {
+    frame_phase_histograms_->AddFrame(view_id, timing, raster_duration);
+  }
 
   FireNextFrameCallbackIfPresent();
 
@@ -781,6 +821,8 @@ DrawSurfaceStatus Rasterizer::DrawToSurfaceUnsafe(
     if (damage) {
       submit_info.frame_damage = damage->GetFrameDamage();
       submit_info.buffer_damage = damage->GetBufferDamage();
+      submit_info.frame_damage_rects = damage->GetFrameDamageRects();
+      submit_info.buffer_damage_rects = damage->GetBufferDamageRects();
     }
 
     frame->set_submit_info(submit_info);
@@ -18,12 +18,14 @@
 #include "flutter/flow/layers/layer_tree.h"
 #include "flutter/flow/surface.h"
 #include "flutter/fml/closure.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/fml/raster_thread_merger.h"
 #include "flutter/fml/synchronization/sync_switch.h"
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/fml/time/time_delta.h"
 #include "flutter/fml/time/time_point.h"
+#include "flutter/fml/unique_fd.h"
 #if IMPELLER_SUPPORTS_RENDERING
 #include "impeller/core/formats.h"               // nogncheck
 #include "impeller/display_list/aiks_context.h"  // nogncheck
@@ -207,6 +209,18 @@ class Rasterizer final : public SnapshotDelegate,
 
   void SetImpellerContext(std::weak_ptr<impeller::Context> impeller_context);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Keeps the glyphs of the Impeller glyph atlases of the
+  ///             surface in |directory| across launches. Takes effect now if
+  ///             there is a surface, and otherwise when one is set up.
+  ///
+  /// @param[in]  directory           The directory to keep the glyphs in.
+  /// @param[in]  worker_task_runner  The task runner to write them on.
+  ///
+  void EnableGlyphAtlasDiskCache(
+      std::shared_ptr<fml::UniqueFD> directory,
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner);
+
   //----------------------------------------------------------------------------
   /// @brief      Rasterizers may be created well before an on-screen surface is
   ///             available for rendering. Shells usually create a rasterizer in
@@ -284,6 +298,19 @@ class Rasterizer final : public SnapshotDelegate,
   ///
   flutter::LayerTree* GetLastLayerTree(int64_t view_id);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Returns the rolling histograms of the phases of the last
+  ///             frames drawn to each view. The raster phase of each view
+  ///             only covers the time spent drawing that view.
+  ///
+  ///             The histograms may be read on any thread, and outlive the
+  ///             rasterizer if a reference to them is kept.
+  ///
+  const std::shared_ptr<FramePhaseHistograms>& GetFramePhaseHistograms()
+      const {
+    return frame_phase_histograms_;
+  }
+
   //----------------------------------------------------------------------------
   /// @brief      Draws the last layer trees with their last configuration. This
   ///             may seem entirely redundant at first glance. After all, on
@@ -742,6 +769,8 @@ class Rasterizer final : public SnapshotDelegate,
 
   void FireNextFrameCallbackIfPresent();
 
+  void SetupGlyphAtlasDiskCache();
+
   static bool ShouldResubmitFrame(const DoDrawResult& result);
   static DrawStatus ToDrawStatus(DoDrawStatus status);
 
@@ -753,12 +782,16 @@ class Rasterizer final : public SnapshotDelegate,
   std::unique_ptr<SnapshotSurfaceProducer> snapshot_surface_producer_;
   std::unique_ptr<flutter::CompositorContext> compositor_context_;
   std::unordered_map<int64_t, ViewRecord> view_records_;
+  const std::shared_ptr<FramePhaseHistograms> frame_phase_histograms_ =
+      std::make_shared<FramePhaseHistograms>();
   fml::closure next_frame_callback_;
   bool user_override_resource_cache_bytes_ = false;
   std::optional<size_t> max_cache_bytes_;
   fml::RefPtr<fml::RasterThreadMerger> raster_thread_merger_;
   std::shared_ptr<ExternalViewEmbedder> external_view_embedder_;
   std::unique_ptr<SnapshotController> snapshot_controller_;
+  std::shared_ptr<fml::UniqueFD> glyph_atlas_directory_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> glyph_atlas_worker_task_runner_;
 
   // WeakPtrFactory must be the last member.
   fml::TaskRunnerAffineWeakPtrFactory<Rasterizer> weak_factory_;
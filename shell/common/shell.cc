@@ -13,6 +13,7 @@
 #include "flutter/assets/directory_asset_bundle.h"
 #include "flutter/common/constants.h"
 #include "flutter/common/graphics/persistent_cache.h"
+#include "flutter/flow/raster_cache_disk_store.h"
 #include "flutter/fml/base32.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/icu_util.h"
@@ -334,8 +335,10 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
 
         // The animator is owned by the UI thread but it gets its vsync pulses
         // from the platform.
-        auto animator = std::make_unique<Animator>(*shell, task_runners,
-                                                   std::move(vsync_waiter));
+        auto animator =
+            std::make_unique<Animator>(*shell, task_runners,
+                                       std::move(vsync_waiter),
+                                       shell->GetSettings());
 
         engine_promise.set_value(on_create_engine(
             *shell,                               //
@@ -510,6 +513,11 @@ Shell::Shell(DartVMRef vm,
       task_runners_.GetPlatformTaskRunner(),
       std::bind(&Shell::OnServiceProtocolReloadAssetFonts, this,
                 std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kGetFrameTimingPercentilesExtensionName] = {
+          task_runners_.GetRasterTaskRunner(),
+          std::bind(&Shell::OnServiceProtocolGetFrameTimingPercentiles, this,
+                    std::placeholders::_1, std::placeholders::_2)};
 }
 
 Shell::~Shell() {
@@ -749,6 +757,7 @@ bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
   // ptr.
   weak_engine_ = engine_->GetWeakPtr();
   weak_rasterizer_ = rasterizer_->GetWeakPtr();
+  frame_phase_histograms_ = rasterizer_->GetFramePhaseHistograms();
   weak_platform_view_ = platform_view_->GetWeakPtr();
 
   // Add the implicit view with empty metrics.
@@ -778,6 +787,51 @@ bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
   if (settings_.purge_persistent_cache) {
     PersistentCache::GetCacheForProcess()->Purge();
   }
+
+  if (settings_.raster_cache_async_population ||
+      settings_.raster_cache_disk_max_bytes > 0) {
+    task_runners_.GetRasterTaskRunner()->PostTask(
+        [rasterizer = weak_rasterizer_,
+         io_task_runner = task_runners_.GetIOTaskRunner(),
+         resource_context = io_manager_->GetResourceContext()] {
+          if (rasterizer) {
+            rasterizer->compositor_context()
+                ->raster_cache()
+                .EnableAsyncPopulation(io_task_runner, resource_context);
+          }
+        });
+  }
+
+  if (settings_.raster_cache_disk_max_bytes > 0) {
+    // The store creates its directory and loads its index on the IO task
+    // runner, which is also the worker that uses it.
+    task_runners_.GetIOTaskRunner()->PostTask(
+        [rasterizer = weak_rasterizer_,
+         raster_task_runner = task_runners_.GetRasterTaskRunner(),
+         max_bytes = settings_.raster_cache_disk_max_bytes] {
+          std::shared_ptr<RasterCacheDiskStore> disk_store =
+              RasterCacheDiskStore::GetStoreForProcess(max_bytes);
+          raster_task_runner->PostTask([rasterizer, disk_store] {
+            if (rasterizer) {
+              rasterizer->compositor_context()->raster_cache().EnableDiskStore(
+                  disk_store);
+            }
+          });
+        });
+  }
+
+  if (settings_.enable_impeller && settings_.enable_glyph_atlas_disk_cache) {
+    task_runners_.GetRasterTaskRunner()->PostTask(
+        [rasterizer = weak_rasterizer_,
+         directory =
+             PersistentCache::GetCacheForProcess()->GetGlyphAtlasDirectory(),
+         worker_task_runner = GetConcurrentWorkerTaskRunner()] {
+          if (rasterizer) {
+            rasterizer->EnableGlyphAtlasDiskCache(directory,
+                                                  worker_task_runner);
+          }
+        });
+  }
 #endif  //  !SLIMPELLER
 
   return true;
@@ -1873,6 +1927,13 @@ double Shell::GetMainDisplayRefreshRate() {
   return display_manager_->GetMainDisplayRefreshRate();
 }
 
+std::map<int64_t, FramePhaseHistogram> Shell::GetFramePhaseHistograms() const {
+  if (!frame_phase_histograms_) {
+    return {};
+  }
+  return frame_phase_histograms_->Get();
+}
+
 void Shell::RegisterImageDecoder(ImageGeneratorFactory factory,
                                  int32_t priority) {
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
@@ -1944,6 +2005,50 @@ bool Shell::OnServiceProtocolEstimateRasterCacheMemory(
   return true;
 }
 
+// Service protocol handler
+bool Shell::OnServiceProtocolGetFrameTimingPercentiles(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetRasterTaskRunner()->RunsTasksOnCurrentThread());
+
+  static constexpr std::pair<FramePhaseHistogram::Phase, const char*>
+      kPhases[] = {
+          {FramePhaseHistogram::kVsyncToBuild, "vsyncToBuild"},
+          {FramePhaseHistogram::kBuild, "build"},
+          {FramePhaseHistogram::kRaster, "raster"},
+          {FramePhaseHistogram::kTotal, "total"},
+      };
+  static constexpr std::pair<double, const char*> kPercentiles[] = {
+      {50.0, "p50"},
+      {90.0, "p90"},
+      {99.0, "p99"},
+      {99.9, "p99.9"},
+  };
+
+  auto& allocator = response->GetAllocator();
+  response->SetObject();
+  response->AddMember("type", "FrameTimingPercentiles", allocator);
+  rapidjson::Value views(rapidjson::kArrayType);
+  for (const auto& [view_id, histogram] : GetFramePhaseHistograms()) {
+    rapidjson::Value view(rapidjson::kObjectType);
+    view.AddMember<int64_t>("viewId", view_id, allocator);
+    view.AddMember<uint64_t>("frameCount", histogram.frame_count(), allocator);
+    for (const auto& [phase, phase_name] : kPhases) {
+      rapidjson::Value percentiles(rapidjson::kObjectType);
+      for (const auto& [percentile, percentile_name] : kPercentiles) {
+        percentiles.AddMember(
+            rapidjson::StringRef(percentile_name),
+            histogram.GetPercentile(phase, percentile).ToMicroseconds(),
+            allocator);
+      }
+      view.AddMember(rapidjson::StringRef(phase_name), percentiles, allocator);
+    }
+    views.PushBack(view, allocator);
+  }
+  response->AddMember("views", views, allocator);
+  return true;
+}
+
 // Service protocol handler
 bool Shell::OnServiceProtocolSetAssetBundlePath(
     const ServiceProtocol::Handler::ServiceProtocolMap& params,
@@ -6,6 +6,7 @@
 #define FLUTTER_SHELL_COMMON_SHELL_H_
 
 #include <functional>
+#include <map>
 #include <mutex>
 #include <string_view>
 #include <unordered_map>
@@ -386,6 +387,15 @@ class Shell final : public PlatformView::Delegate,
   ///
   double GetMainDisplayRefreshRate();
 
+  //----------------------------------------------------------------------------
+  /// @brief      Returns the rolling histograms of the phases of the last
+  ///             frames drawn to each view, keyed by the view ID. May be
+  ///             called on any thread.
+  ///
+  /// @see        `Rasterizer::GetFramePhaseHistograms`
+  ///
+  std::map<int64_t, FramePhaseHistogram> GetFramePhaseHistograms() const;
+
   //----------------------------------------------------------------------------
   /// @brief      Install a new factory that can match against and decode image
   ///             data.
@@ -457,6 +467,8 @@ class Shell final : public PlatformView::Delegate,
       weak_rasterizer_;  // to be shared across threads
   fml::WeakPtr<PlatformView>
       weak_platform_view_;  // to be shared across threads
+  // Shared with the rasterizer, and read on any thread.
+  std::shared_ptr<FramePhaseHistograms> frame_phase_histograms_;
 
   std::unordered_map<std::string_view,  // method
                      std::pair<fml::RefPtr<fml::TaskRunner>,
@@ -751,6 +763,14 @@ class Shell final : public PlatformView::Delegate,
       const ServiceProtocol::Handler::ServiceProtocolMap& params,
       rapidjson::Document* response);
 
+  // Service protocol handler
+  //
+  // Reports the p50, p90, p99 and p99.9 durations of the phases of the last
+  // frames of each view, in microseconds.
+  bool OnServiceProtocolGetFrameTimingPercentiles(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
   // Service protocol handler
   //
   // Forces the FontCollection to reload the font manifest. Used to support
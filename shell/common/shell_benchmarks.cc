@@ -4,9 +4,12 @@
 
 #include "flutter/shell/common/shell.h"
 
+#include <thread>
+
 #include "flutter/benchmarking/benchmarking.h"
 #include "flutter/fml/logging.h"
 #include "flutter/runtime/dart_vm.h"
+#include "flutter/shell/common/pipeline.h"
 #include "flutter/shell/common/thread_host.h"
 #include "flutter/testing/elf_loader.h"
 #include "flutter/testing/testing.h"
@@ -120,4 +123,81 @@ static void BM_ShellInitializationAndShutdown(benchmark::State& state) {
 
 BENCHMARK(BM_ShellInitializationAndShutdown);
 
+// Produces items as fast as the pipeline accepts them on one thread while
+// another thread consumes them, and reports how long the consumed items
+// waited in the pipeline and how many of them were dropped.
+static void BM_PipelineProduceConsume(benchmark::State& state,
+                                      FramePipelinePolicy policy) {
+  using TimePointPipeline = Pipeline<fml::TimePoint>;
+  const int kItemsPerIteration = 1000;
+  const auto kMaxLatency = fml::TimeDelta::FromMicroseconds(50);
+  const uint32_t depth = state.range(0);
+
+  int64_t produced = 0;
+  int64_t consumed = 0;
+  fml::TimeDelta total_latency;
+  while (state.KeepRunning()) {
+    TimePointPipeline pipeline(depth, policy, kMaxLatency);
+    std::atomic<bool> done = false;
+    std::thread consumer([&]() {
+      TimePointPipeline::Consumer consume =
+          [&](std::unique_ptr<fml::TimePoint> produce_time) {
+            total_latency = total_latency +
+                            (fml::TimePoint::Now() - *produce_time);
+            consumed++;
+          };
+      while (true) {
+        // Read the flag first so that no item is left behind once it is
+        // set.
+        bool producer_done = done.load();
+        if (pipeline.Consume(consume) ==
+                PipelineConsumeResult::NoneAvailable &&
+            producer_done) {
+          break;
+        }
+      }
+    });
+    for (int i = 0; i < kItemsPerIteration;) {
+      TimePointPipeline::ProducerContinuation continuation =
+          pipeline.Produce();
+      if (!continuation) {
+        continue;
+      }
+      auto result = continuation.Complete(
+          std::make_unique<fml::TimePoint>(fml::TimePoint::Now()));
+      FML_CHECK(result.success);
+      i++;
+    }
+    produced += kItemsPerIteration;
+    done = true;
+    consumer.join();
+  }
+
+  state.counters["LatencyUs"] =
+      consumed > 0 ? total_latency.ToMicrosecondsF() / consumed : 0;
+  state.counters["DroppedPercent"] =
+      produced > 0 ? 100.0 * (produced - consumed) / produced : 0;
+  state.SetItemsProcessed(produced);
+}
+
+BENCHMARK_CAPTURE(BM_PipelineProduceConsume, Fifo, FramePipelinePolicy::kFifo)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_PipelineProduceConsume,
+                  LatestWins,
+                  FramePipelinePolicy::kLatestWins)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_PipelineProduceConsume,
+                  BoundedLatency,
+                  FramePipelinePolicy::kBoundedLatency)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->UseRealTime();
+
 }  // namespace flutter
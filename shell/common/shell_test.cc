@@ -319,6 +319,10 @@ void ShellTest::OnServiceProtocol(
           case ServiceProtocolEnum::kRunInView:
             shell->OnServiceProtocolRunInView(params, response);
             break;
+          case ServiceProtocolEnum::kGetFrameTimingPercentiles:
+            shell->OnServiceProtocolGetFrameTimingPercentiles(params,
+                                                              response);
+            break;
         }
         finished.set_value(true);
       });
@@ -135,6 +135,7 @@ class ShellTest : public FixtureTest {
     kEstimateRasterCacheMemory,
     kSetAssetBundlePath,
     kRunInView,
+    kGetFrameTimingPercentiles,
   };
 
   // Helper method to test private method Shell::OnServiceProtocolGetSkSLs.
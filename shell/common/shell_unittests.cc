@@ -2592,6 +2592,57 @@ TEST_F(ShellTest, OnServiceProtocolEstimateRasterCacheMemoryWorks) {
   DestroyShell(std::move(shell));
 }
 
+TEST_F(ShellTest, OnServiceProtocolGetFrameTimingPercentilesWorks) {
+  Settings settings = CreateSettingsForFixture();
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  ServiceProtocol::Handler::ServiceProtocolMap empty_params;
+
+  auto get_percentiles_json = [&shell, &empty_params]() {
+    rapidjson::Document document;
+    OnServiceProtocol(shell.get(),
+                      ServiceProtocolEnum::kGetFrameTimingPercentiles,
+                      shell->GetTaskRunners().GetRasterTaskRunner(),
+                      empty_params, &document);
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    document.Accept(writer);
+    return std::string(buffer.GetString());
+  };
+
+  // No view has drawn a frame yet.
+  ASSERT_EQ(get_percentiles_json(),
+            "{\"type\":\"FrameTimingPercentiles\",\"views\":[]}");
+
+  // Durations of less than 32us are counted exactly.
+  FrameTiming timing;
+  fml::TimePoint vsync_start =
+      fml::TimePoint::FromEpochDelta(fml::TimeDelta::FromSeconds(1));
+  timing.Set(FrameTiming::kVsyncStart, vsync_start);
+  timing.Set(FrameTiming::kBuildStart,
+             vsync_start + fml::TimeDelta::FromMicroseconds(2));
+  timing.Set(FrameTiming::kBuildFinish,
+             vsync_start + fml::TimeDelta::FromMicroseconds(10));
+  timing.Set(FrameTiming::kRasterStart,
+             vsync_start + fml::TimeDelta::FromMicroseconds(10));
+  timing.Set(FrameTiming::kRasterFinish,
+             vsync_start + fml::TimeDelta::FromMicroseconds(14));
+  PostSync(shell->GetTaskRunners().GetRasterTaskRunner(), [&shell, &timing] {
+    shell->GetRasterizer()->GetFramePhaseHistograms()->AddFrame(
+        kImplicitViewId, timing);
+  });
+
+  std::string expected_json =
+      "{\"type\":\"FrameTimingPercentiles\",\"views\":[{\"viewId\":0,"
+      "\"frameCount\":1,"
+      "\"vsyncToBuild\":{\"p50\":2,\"p90\":2,\"p99\":2,\"p99.9\":2},"
+      "\"build\":{\"p50\":8,\"p90\":8,\"p99\":8,\"p99.9\":8},"
+      "\"raster\":{\"p50\":4,\"p90\":4,\"p99\":4,\"p99.9\":4},"
+      "\"total\":{\"p50\":14,\"p90\":14,\"p99\":14,\"p99.9\":14}}]}";
+  ASSERT_EQ(get_percentiles_json(), expected_json);
+
+  DestroyShell(std::move(shell));
+}
+
 // TODO(https://github.com/flutter/flutter/issues/100273): Disabled due to
 // flakiness.
 // TODO(https://github.com/flutter/flutter/issues/100299): Fix it when
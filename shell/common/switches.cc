@@ -523,6 +523,53 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
         std::stoi(resource_cache_max_bytes_threshold);
   }
 
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::RasterCacheMaxBytesThreshold))) {
+    std::string raster_cache_max_bytes_threshold;
+    command_line.GetOptionValue(
+        FlagForSwitch(Switch::RasterCacheMaxBytesThreshold),
+        &raster_cache_max_bytes_threshold);
+    settings.raster_cache_max_bytes_threshold =
+        std::stoull(raster_cache_max_bytes_threshold);
+  }
+
+  settings.raster_cache_async_population = command_line.HasOption(
+      FlagForSwitch(Switch::RasterCacheAsyncPopulation));
+
+  if (command_line.HasOption(FlagForSwitch(Switch::RasterCacheDiskMaxBytes))) {
+    std::string raster_cache_disk_max_bytes;
+    command_line.GetOptionValue(FlagForSwitch(Switch::RasterCacheDiskMaxBytes),
+                                &raster_cache_disk_max_bytes);
+    settings.raster_cache_disk_max_bytes =
+        std::stoull(raster_cache_disk_max_bytes);
+  }
+
+  settings.enable_glyph_atlas_disk_cache = command_line.HasOption(
+      FlagForSwitch(Switch::EnableGlyphAtlasDiskCache));
+
+  std::string frame_pipeline_policy;
+  if (command_line.GetOptionValue(FlagForSwitch(Switch::FramePipelinePolicy),
+                                  &frame_pipeline_policy)) {
+    if (frame_pipeline_policy == "latest-wins") {
+      settings.frame_pipeline_policy = FramePipelinePolicy::kLatestWins;
+    } else if (frame_pipeline_policy == "bounded-latency") {
+      settings.frame_pipeline_policy = FramePipelinePolicy::kBoundedLatency;
+    } else if (frame_pipeline_policy != "fifo") {
+      FML_LOG(ERROR) << "Unknown frame pipeline policy: "
+                     << frame_pipeline_policy;
+    }
+  }
+
+  GetSwitchValue(command_line, Switch::FramePipelineDepth,
+                 &settings.frame_pipeline_depth);
+
+  int64_t frame_pipeline_max_latency_ms = 0;
+  if (GetSwitchValue(command_line, Switch::FramePipelineMaxLatencyMs,
+                     &frame_pipeline_max_latency_ms)) {
+    settings.frame_pipeline_max_latency =
+        fml::TimeDelta::FromMilliseconds(frame_pipeline_max_latency_ms);
+  }
+
   settings.enable_platform_isolates =
       command_line.HasOption(FlagForSwitch(Switch::EnablePlatformIsolates));
 
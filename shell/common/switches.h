@@ -262,6 +262,40 @@ DEF_SWITCH(OldGenHeapSize,
 DEF_SWITCH(ResourceCacheMaxBytesThreshold,
            "resource-cache-max-bytes-threshold",
            "The max bytes threshold of resource cache, or 0 for unlimited.")
+DEF_SWITCH(RasterCacheMaxBytesThreshold,
+           "raster-cache-max-bytes-threshold",
+           "The max bytes of all raster cache images above which images of "
+           "layers not drawn in the current frame are evicted, or 0 to evict "
+           "them immediately.")
+DEF_SWITCH(RasterCacheAsyncPopulation,
+           "raster-cache-async-population",
+           "Rasterize display lists for the raster cache on the IO thread "
+           "instead of in the frame that first qualifies them for caching.")
+DEF_SWITCH(RasterCacheDiskMaxBytes,
+           "raster-cache-disk-max-bytes",
+           "The max bytes of raster cache images kept in the persistent cache "
+           "directory across launches, or 0 to not keep any. Implies "
+           "--raster-cache-async-population.")
+DEF_SWITCH(EnableGlyphAtlasDiskCache,
+           "enable-glyph-atlas-disk-cache",
+           "Keep the glyphs rasterized for the Impeller glyph atlases in the "
+           "persistent cache directory, and restore them on the next launch "
+           "instead of rasterizing them again.")
+DEF_SWITCH(FramePipelinePolicy,
+           "frame-pipeline-policy",
+           "How frames waiting for the raster thread are handled: 'fifo' "
+           "rasterizes all of them in order, 'latest-wins' only the newest "
+           "one, and 'bounded-latency' drops those that waited for longer "
+           "than --frame-pipeline-max-latency-ms. Defaults to 'fifo'.")
+DEF_SWITCH(FramePipelineDepth,
+           "frame-pipeline-depth",
+           "The max number of frames in flight between the UI and raster "
+           "threads. Clamped to 1 when the platform and raster threads are "
+           "merged.")
+DEF_SWITCH(FramePipelineMaxLatencyMs,
+           "frame-pipeline-max-latency-ms",
+           "The max time in milliseconds a frame may wait for the raster "
+           "thread with --frame-pipeline-policy=bounded-latency.")
 DEF_SWITCH(EnableImpeller,
            "enable-impeller",
            "Enable the Impeller renderer on supported platforms. Ignored if "
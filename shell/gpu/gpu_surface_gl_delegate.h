@@ -6,6 +6,7 @@
 #define FLUTTER_SHELL_GPU_GPU_SURFACE_GL_DELEGATE_H_
 
 #include <optional>
+#include <vector>
 
 #include "flutter/common/graphics/gl_context_switch.h"
 #include "flutter/flow/embedded_views.h"
@@ -46,6 +47,11 @@ struct GLPresentInfo {
   // The buffer damage refers to the region that needs to be set as damaged
   // within the frame buffer.
   const std::optional<SkIRect>& buffer_damage;
+
+  // The parts of frame_damage and buffer_damage that actually changed, or
+  // empty if only their bounds are known.
+  std::vector<SkIRect> frame_damage_rects = {};
+  std::vector<SkIRect> buffer_damage_rects = {};
 };
 
 class GPUSurfaceGLDelegate {
@@ -60,8 +66,11 @@ class GPUSurfaceGLDelegate {
   virtual bool GLContextClearCurrent() = 0;
 
   // Inform the GL Context that there's going to be no writing beyond
-  // the specified region
-  virtual void GLContextSetDamageRegion(const std::optional<SkIRect>& region) {}
+  // the specified region. If |rects| is not empty, writing is limited to
+  // those parts of |region|, and pixels of |region| outside of them may be
+  // left undefined.
+  virtual void GLContextSetDamageRegion(const std::optional<SkIRect>& region,
+                                        const std::vector<SkIRect>& rects) {}
 
   // Called to present the main GL surface. This is only called for the main GL
   // context and not any of the contexts dedicated for IO.
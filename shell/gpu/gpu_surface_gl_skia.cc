@@ -277,13 +277,18 @@ bool GPUSurfaceGLSkia::PresentSurface(const SurfaceFrame& frame) {
     return false;
   }
 
-  delegate_->GLContextSetDamageRegion(frame.submit_info().buffer_damage);
+  // Painting is clipped to the buffer damage rects, so they have to be
+  // declared as well.
+  delegate_->GLContextSetDamageRegion(frame.submit_info().buffer_damage,
+                                      frame.submit_info().buffer_damage_rects);
 
   GLPresentInfo present_info = {
       .fbo_id = fbo_id_,
       .frame_damage = frame.submit_info().frame_damage,
       .presentation_time = frame.submit_info().presentation_time,
       .buffer_damage = frame.submit_info().buffer_damage,
+      .frame_damage_rects = frame.submit_info().frame_damage_rects,
+      .buffer_damage_rects = frame.submit_info().buffer_damage_rects,
   };
   if (!delegate_->GLContextPresent(present_info)) {
     return false;
@@ -19,8 +19,11 @@ GPUSurfaceVulkanImpeller::GPUSurfaceVulkanImpeller(
     return;
   }
 
+  // New glyphs are rasterized on the same workers that compile pipelines.
+  const auto& context_vk = impeller::SurfaceContextVK::Cast(*context);
   auto aiks_context = std::make_shared<impeller::AiksContext>(
-      context, impeller::TypographerContextSkia::Make());
+      context, impeller::TypographerContextSkia::Make(
+                   context_vk.GetParent()->GetConcurrentWorkerTaskRunner()));
   if (!aiks_context->IsValid()) {
     return;
   }
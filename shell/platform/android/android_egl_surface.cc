@@ -64,7 +64,8 @@ class AndroidEGLSurfaceDamage {
 
   void SetDamageRegion(EGLDisplay display,
                        EGLSurface surface,
-                       const std::optional<SkIRect>& region) {}
+                       const std::optional<SkIRect>& region,
+                       const std::vector<SkIRect>& rects) {}
 
   /// This was disabled after discussion in
   /// https://github.com/flutter/flutter/issues/123353
@@ -137,8 +138,10 @@ AndroidEGLSurfaceMakeCurrentStatus AndroidEGLSurface::MakeCurrent() const {
 }
 
 void AndroidEGLSurface::SetDamageRegion(
-    const std::optional<SkIRect>& buffer_damage) {
-  damage_->SetDamageRegion(display_, surface_, buffer_damage);
+    const std::optional<SkIRect>& buffer_damage,
+    const std::vector<SkIRect>& buffer_damage_rects) {
+  damage_->SetDamageRegion(display_, surface_, buffer_damage,
+                           buffer_damage_rects);
 }
 
 bool AndroidEGLSurface::SetPresentationTime(
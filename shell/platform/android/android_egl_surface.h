@@ -9,6 +9,7 @@
 #include <EGL/eglext.h>
 #include <KHR/khrplatform.h>
 #include <optional>
+#include <vector>
 
 #include "flutter/fml/macros.h"
 #include "flutter/fml/time/time_point.h"
@@ -78,8 +79,10 @@ class AndroidEGLSurface {
 
   //----------------------------------------------------------------------------
   /// @brief      Sets the damage region for current surface. Corresponds to
-  //              eglSetDamageRegionKHR
-  void SetDamageRegion(const std::optional<SkIRect>& buffer_damage);
+  //              eglSetDamageRegionKHR, which is given |buffer_damage_rects|
+  //              if not empty and |buffer_damage| otherwise.
+  void SetDamageRegion(const std::optional<SkIRect>& buffer_damage,
+                       const std::vector<SkIRect>& buffer_damage_rects);
 
   //----------------------------------------------------------------------------
   /// @brief      Sets the presentation time for the current surface. This
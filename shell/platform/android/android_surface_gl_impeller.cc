@@ -124,7 +124,8 @@ AndroidSurfaceGLImpeller::GLContextFramebufferInfo() const {
 
 // |GPUSurfaceGLDelegate|
 void AndroidSurfaceGLImpeller::GLContextSetDamageRegion(
-    const std::optional<SkIRect>& region) {
+    const std::optional<SkIRect>& region,
+    const std::vector<SkIRect>& rects) {
   // Not supported.
 }
 
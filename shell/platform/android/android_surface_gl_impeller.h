@@ -61,7 +61,8 @@ class AndroidSurfaceGLImpeller final : public GPUSurfaceGLDelegate,
   SurfaceFrame::FramebufferInfo GLContextFramebufferInfo() const override;
 
   // |GPUSurfaceGLDelegate|
-  void GLContextSetDamageRegion(const std::optional<SkIRect>& region) override;
+  void GLContextSetDamageRegion(const std::optional<SkIRect>& region,
+                                const std::vector<SkIRect>& rects) override;
 
   // |GPUSurfaceGLDelegate|
   bool GLContextPresent(const GLPresentInfo& present_info) override;
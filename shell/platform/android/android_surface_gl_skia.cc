@@ -147,9 +147,10 @@ SurfaceFrame::FramebufferInfo AndroidSurfaceGLSkia::GLContextFramebufferInfo()
 }
 
 void AndroidSurfaceGLSkia::GLContextSetDamageRegion(
-    const std::optional<SkIRect>& region) {
+    const std::optional<SkIRect>& region,
+    const std::vector<SkIRect>& rects) {
   FML_DCHECK(IsValid());
-  onscreen_surface_->SetDamageRegion(region);
+  onscreen_surface_->SetDamageRegion(region, rects);
 }
 
 bool AndroidSurfaceGLSkia::GLContextPresent(const GLPresentInfo& present_info) {
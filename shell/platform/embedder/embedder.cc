@@ -7,6 +7,7 @@
 
 #include <cstring>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -270,6 +271,27 @@ static FlutterRect SkIRectToFlutterRect(const SkIRect sk_rect) {
   return flutter_rect;
 }
 
+// Auxiliary function used to translate a damage region to the rectangles of
+// a FlutterDamage. Falls back to the bounds of the damage if the rectangles
+// that make it up are not known.
+static std::vector<FlutterRect> DamageToFlutterRects(
+    const std::optional<SkIRect>& bounds,
+    const std::vector<SkIRect>& rects) {
+  std::vector<FlutterRect> flutter_rects;
+  if (!bounds) {
+    return flutter_rects;
+  }
+  if (rects.empty()) {
+    flutter_rects.push_back(SkIRectToFlutterRect(*bounds));
+    return flutter_rects;
+  }
+  flutter_rects.reserve(rects.size());
+  for (const SkIRect& rect : rects) {
+    flutter_rects.push_back(SkIRectToFlutterRect(rect));
+  }
+  return flutter_rects;
+}
+
 // Auxiliary function used to translate rectangles of type FlutterRect to
 // SkIRect.
 static const SkIRect FlutterRectToSkIRect(FlutterRect flutter_rect) {
@@ -328,33 +350,27 @@ InferOpenGLPlatformViewCreationCallback(
     if (present) {
       return present(user_data);
     } else {
-      // Format the frame and buffer damages accordingly. Note that, since the
-      // current compute damage algorithm only returns one rectangle for damage
-      // we are assuming the number of rectangles provided in frame and buffer
-      // damage are always 1. Once the function that computes damage implements
-      // support for multiple damage rectangles, GLPresentInfo should also
-      // contain the number of damage rectangles.
-
-      std::optional<FlutterRect> frame_damage_rect;
-      if (gl_present_info.frame_damage) {
-        frame_damage_rect =
-            SkIRectToFlutterRect(*(gl_present_info.frame_damage));
-      }
-      std::optional<FlutterRect> buffer_damage_rect;
-      if (gl_present_info.buffer_damage) {
-        buffer_damage_rect =
-            SkIRectToFlutterRect(*(gl_present_info.buffer_damage));
-      }
+      // Format the frame and buffer damages accordingly. The damage is made
+      // up of the few rectangles that changed when they are known, and of
+      // its bounds otherwise.
+      std::vector<FlutterRect> frame_damage_rects =
+          DamageToFlutterRects(gl_present_info.frame_damage,
+                               gl_present_info.frame_damage_rects);
+      std::vector<FlutterRect> buffer_damage_rects =
+          DamageToFlutterRects(gl_present_info.buffer_damage,
+                               gl_present_info.buffer_damage_rects);
 
       FlutterDamage frame_damage{
           .struct_size = sizeof(FlutterDamage),
-          .num_rects = frame_damage_rect ? size_t{1} : size_t{0},
-          .damage = frame_damage_rect ? &frame_damage_rect.value() : nullptr,
+          .num_rects = frame_damage_rects.size(),
+          .damage = frame_damage_rects.empty() ? nullptr
+                                               : frame_damage_rects.data(),
       };
       FlutterDamage buffer_damage{
           .struct_size = sizeof(FlutterDamage),
-          .num_rects = buffer_damage_rect ? size_t{1} : size_t{0},
-          .damage = buffer_damage_rect ? &buffer_damage_rect.value() : nullptr,
+          .num_rects = buffer_damage_rects.size(),
+          .damage = buffer_damage_rects.empty() ? nullptr
+                                                : buffer_damage_rects.data(),
       };
 
       // Construct the present information concerning the frame being rendered.
@@ -3503,6 +3519,62 @@ FlutterEngineResult FlutterEngineSetNextFrameCallback(
   return kSuccess;
 }
 
+// Auxiliary function used to translate the percentiles of a phase of a
+// FramePhaseHistogram to FlutterFramePhasePercentiles.
+static FlutterFramePhasePercentiles ToFlutterFramePhasePercentiles(
+    const flutter::FramePhaseHistogram& histogram,
+    flutter::FramePhaseHistogram::Phase phase) {
+  return {
+      .p50 = static_cast<uint64_t>(
+          histogram.GetPercentile(phase, 50.0).ToMicroseconds()),
+      .p90 = static_cast<uint64_t>(
+          histogram.GetPercentile(phase, 90.0).ToMicroseconds()),
+      .p99 = static_cast<uint64_t>(
+          histogram.GetPercentile(phase, 99.0).ToMicroseconds()),
+      .p99_9 = static_cast<uint64_t>(
+          histogram.GetPercentile(phase, 99.9).ToMicroseconds()),
+  };
+}
+
+FlutterEngineResult FlutterEngineGetFrameTimingPercentiles(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterViewId view_id,
+    FlutterFrameTimingPercentiles* percentiles) {
+  if (engine == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Invalid engine handle.");
+  }
+
+  if (percentiles == nullptr ||
+      percentiles->struct_size < sizeof(FlutterFrameTimingPercentiles)) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Frame timing percentiles were invalid.");
+  }
+
+  flutter::EmbedderEngine* embedder_engine =
+      reinterpret_cast<flutter::EmbedderEngine*>(engine);
+  std::map<int64_t, flutter::FramePhaseHistogram> histograms =
+      embedder_engine->GetShell().GetFramePhaseHistograms();
+
+  size_t struct_size = percentiles->struct_size;
+  *percentiles = {};
+  percentiles->struct_size = struct_size;
+  auto found = histograms.find(view_id);
+  if (found == histograms.end()) {
+    return kSuccess;
+  }
+  const flutter::FramePhaseHistogram& histogram = found->second;
+  percentiles->frame_count = histogram.frame_count();
+  percentiles->vsync_to_build = ToFlutterFramePhasePercentiles(
+      histogram, flutter::FramePhaseHistogram::kVsyncToBuild);
+  percentiles->build = ToFlutterFramePhasePercentiles(
+      histogram, flutter::FramePhaseHistogram::kBuild);
+  percentiles->raster = ToFlutterFramePhasePercentiles(
+      histogram, flutter::FramePhaseHistogram::kRaster);
+  percentiles->total = ToFlutterFramePhasePercentiles(
+      histogram, flutter::FramePhaseHistogram::kTotal);
+  return kSuccess;
+}
+
 FlutterEngineResult FlutterEngineGetProcAddresses(
     FlutterEngineProcTable* table) {
   if (!table) {
@@ -3557,6 +3629,7 @@ FlutterEngineResult FlutterEngineGetProcAddresses(
   SET_PROC(SetNextFrameCallback, FlutterEngineSetNextFrameCallback);
   SET_PROC(AddView, FlutterEngineAddView);
   SET_PROC(RemoveView, FlutterEngineRemoveView);
+  SET_PROC(GetFrameTimingPercentiles, FlutterEngineGetFrameTimingPercentiles);
 #undef SET_PROC
 
   return kSuccess;
@@ -567,8 +567,13 @@ typedef struct {
   /// Id of the fbo backing the surface that was presented.
   uint32_t fbo_id;
   /// Damage representing the area that the compositor needs to render.
+  ///
+  /// The damage may be made up of several rectangles, which may overlap.
+  /// Their number is kept small by merging rectangles that are close to each
+  /// other.
   FlutterDamage frame_damage;
-  /// Damage used to set the buffer's damage region.
+  /// Damage used to set the buffer's damage region. Like the frame damage,
+  /// it may be made up of several, possibly overlapping rectangles.
   FlutterDamage buffer_damage;
 } FlutterPresentInfo;
 
@@ -2508,6 +2513,36 @@ typedef struct {
   FlutterChannelUpdateCallback channel_update_callback;
 } FlutterProjectArgs;
 
+/// The durations, in microseconds, that a given percentage of the recent
+/// frames took at most in one of the phases of a frame.
+typedef struct {
+  uint64_t p50;
+  uint64_t p90;
+  uint64_t p99;
+  uint64_t p99_9;
+} FlutterFramePhasePercentiles;
+
+/// The percentiles of the durations of the phases of the recent frames of a
+/// view.
+///
+/// See: \ref FlutterEngineGetFrameTimingPercentiles.
+typedef struct {
+  /// The size of this struct. Must be
+  /// sizeof(FlutterFrameTimingPercentiles).
+  size_t struct_size;
+  /// The number of recent frames the percentiles are computed from.
+  uint64_t frame_count;
+  /// From the vsync signal to the start of the build of the frame.
+  FlutterFramePhasePercentiles vsync_to_build;
+  /// From the start to the end of the build of the frame.
+  FlutterFramePhasePercentiles build;
+  /// From the start to the end of the rasterization of the view.
+  FlutterFramePhasePercentiles raster;
+  /// From the vsync signal to the end of the rasterization of the view. This
+  /// does not include the time until the frame is displayed.
+  FlutterFramePhasePercentiles total;
+} FlutterFrameTimingPercentiles;
+
 #ifndef FLUTTER_ENGINE_NO_PROTOTYPES
 
 // NOLINTBEGIN(google-objc-function-naming)
@@ -3258,6 +3293,26 @@ FlutterEngineResult FlutterEngineSetNextFrameCallback(
     VoidCallback callback,
     void* user_data);
 
+//------------------------------------------------------------------------------
+/// @brief      Gets the p50, p90, p99 and p99.9 durations of the phases of the
+///             recent frames of a view, so that embedders can monitor the
+///             tail latency of frames without collecting traces. The
+///             percentiles cover about the last 600 frames.
+///
+/// @param[in]  engine       A running engine instance.
+/// @param[in]  view_id      The ID of the view.
+/// @param[out] percentiles  The percentiles of the view. The struct_size
+///                          member must be set by the caller. If the view
+///                          has not drawn any frames, the frame_count is 0.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineGetFrameTimingPercentiles(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterViewId view_id,
+    FlutterFrameTimingPercentiles* percentiles);
+
 #endif  // !FLUTTER_ENGINE_NO_PROTOTYPES
 
 // Typedefs for the function pointers in FlutterEngineProcTable.
@@ -3386,6 +3441,10 @@ typedef FlutterEngineResult (*FlutterEngineAddViewFnPtr)(
 typedef FlutterEngineResult (*FlutterEngineRemoveViewFnPtr)(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
     const FlutterRemoveViewInfo* info);
+typedef FlutterEngineResult (*FlutterEngineGetFrameTimingPercentilesFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterViewId view_id,
+    FlutterFrameTimingPercentiles* percentiles);
 
 /// Function-pointer-based versions of the APIs above.
 typedef struct {
@@ -3434,6 +3493,7 @@ typedef struct {
   FlutterEngineSetNextFrameCallbackFnPtr SetNextFrameCallback;
   FlutterEngineAddViewFnPtr AddView;
   FlutterEngineRemoveViewFnPtr RemoveView;
+  FlutterEngineGetFrameTimingPercentilesFnPtr GetFrameTimingPercentiles;
 } FlutterEngineProcTable;
 
 //------------------------------------------------------------------------------
@@ -1551,6 +1551,35 @@ void render_gradient_retained() {
   PlatformDispatcher.instance.scheduleFrame();
 }
 
+@pragma('vm:entry-point')
+// ignore: non_constant_identifier_names
+void render_gradient_with_changing_corners() {
+  OffsetEngineLayer? offsetLayer; // Retain the offset layer.
+  int frame = 0;
+  PlatformDispatcher.instance.onBeginFrame = (Duration duration) {
+    const Size size = Size(800.0, 600.0);
+    const Size cornerSize = Size(20.0, 20.0);
+
+    // Only the boxes in the opposite corners change from frame to frame.
+    final Color cornerColor = frame.isEven
+        ? const Color.fromARGB(255, 255, 0, 0)
+        : const Color.fromARGB(255, 0, 0, 255);
+    frame++;
+
+    final SceneBuilder builder = SceneBuilder();
+
+    offsetLayer = builder.pushOffset(0.0, 0.0, oldLayer: offsetLayer);
+    builder.addPicture(Offset.zero, createGradientBox(size));
+    builder.addPicture(Offset.zero, createColoredBox(cornerColor, cornerSize));
+    builder.addPicture(const Offset(780.0, 580.0),
+        createColoredBox(cornerColor, cornerSize));
+    builder.pop();
+
+    PlatformDispatcher.instance.views.first.render(builder.build());
+  };
+  PlatformDispatcher.instance.scheduleFrame();
+}
+
 @pragma('vm:entry-point')
 // ignore: non_constant_identifier_names
 void render_impeller_test() {
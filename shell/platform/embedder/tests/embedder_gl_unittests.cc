@@ -3865,6 +3865,91 @@ TEST_F(EmbedderTest, PresentInfoReceivesEmptyDamage) {
   latch.Wait();
 }
 
+TEST_F(EmbedderTest, PresentInfoReceivesDamageOfEachChangedArea) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kOpenGLContext);
+
+  EmbedderConfigBuilder builder(context);
+  builder.SetOpenGLRendererConfig(SkISize::Make(800, 600));
+  builder.SetDartEntrypoint("render_gradient_with_changing_corners");
+  builder.GetRendererConfig().open_gl.populate_existing_damage =
+      [](void* context, const intptr_t id,
+         FlutterDamage* existing_damage) -> void {
+    return reinterpret_cast<EmbedderTestContextGL*>(context)
+        ->GLPopulateExistingDamage(id, existing_damage);
+  };
+
+  // Return no existing damage on purpose.
+  static_cast<EmbedderTestContextGL&>(context)
+      .SetGLPopulateExistingDamageCallback(
+          [](const intptr_t id, FlutterDamage* existing_damage_ptr) {
+            const size_t num_rects = 1;
+            // The array must be valid after the callback returns.
+            static FlutterRect existing_damage_rects[num_rects] = {
+                FlutterRect{0, 0, 0, 0}};
+            existing_damage_ptr->num_rects = num_rects;
+            existing_damage_ptr->damage = existing_damage_rects;
+          });
+
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+
+  fml::AutoResetWaitableEvent latch;
+
+  // First frame should be entirely rerendered.
+  static_cast<EmbedderTestContextGL&>(context).SetGLPresentCallback(
+      [&](FlutterPresentInfo present_info) {
+        const size_t num_rects = 1;
+        ASSERT_EQ(present_info.frame_damage.num_rects, num_rects);
+        ASSERT_EQ(present_info.frame_damage.damage->right, 800);
+        ASSERT_EQ(present_info.frame_damage.damage->bottom, 600);
+
+        latch.Signal();
+      });
+
+  // Send a window metrics events so frames may be scheduled.
+  FlutterWindowMetricsEvent event = {};
+  event.struct_size = sizeof(event);
+  event.width = 800;
+  event.height = 600;
+  event.pixel_ratio = 1.0;
+  ASSERT_EQ(FlutterEngineSendWindowMetricsEvent(engine.get(), &event),
+            kSuccess);
+  latch.Wait();
+
+  // Only the boxes in the opposite corners change color in the second frame,
+  // so the damage should be made up of the two boxes rather than of the
+  // bounds of both, which cover the entire screen.
+  static_cast<EmbedderTestContextGL&>(context).SetGLPresentCallback(
+      [&](FlutterPresentInfo present_info) {
+        const size_t num_rects = 2;
+        ASSERT_EQ(present_info.frame_damage.num_rects, num_rects);
+        ASSERT_EQ(present_info.frame_damage.damage[0].left, 0);
+        ASSERT_EQ(present_info.frame_damage.damage[0].top, 0);
+        ASSERT_EQ(present_info.frame_damage.damage[0].right, 20);
+        ASSERT_EQ(present_info.frame_damage.damage[0].bottom, 20);
+        ASSERT_EQ(present_info.frame_damage.damage[1].left, 780);
+        ASSERT_EQ(present_info.frame_damage.damage[1].top, 580);
+        ASSERT_EQ(present_info.frame_damage.damage[1].right, 800);
+        ASSERT_EQ(present_info.frame_damage.damage[1].bottom, 600);
+
+        ASSERT_EQ(present_info.buffer_damage.num_rects, num_rects);
+        ASSERT_EQ(present_info.buffer_damage.damage[0].left, 0);
+        ASSERT_EQ(present_info.buffer_damage.damage[0].top, 0);
+        ASSERT_EQ(present_info.buffer_damage.damage[0].right, 20);
+        ASSERT_EQ(present_info.buffer_damage.damage[0].bottom, 20);
+        ASSERT_EQ(present_info.buffer_damage.damage[1].left, 780);
+        ASSERT_EQ(present_info.buffer_damage.damage[1].top, 580);
+        ASSERT_EQ(present_info.buffer_damage.damage[1].right, 800);
+        ASSERT_EQ(present_info.buffer_damage.damage[1].bottom, 600);
+
+        latch.Signal();
+      });
+
+  ASSERT_EQ(FlutterEngineSendWindowMetricsEvent(engine.get(), &event),
+            kSuccess);
+  latch.Wait();
+}
+
 TEST_F(EmbedderTest, PresentInfoReceivesPartialDamage) {
   auto& context = GetEmbedderContext(EmbedderTestContextType::kOpenGLContext);
 
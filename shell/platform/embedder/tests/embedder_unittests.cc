@@ -3429,6 +3429,62 @@ TEST_F(EmbedderTest, CanSetNextFrameCallback) {
   callback_latch.Wait();
 }
 
+TEST_F(EmbedderTest, CanGetFrameTimingPercentiles) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  builder.SetDartEntrypoint("draw_solid_red");
+
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+
+  FlutterFrameTimingPercentiles percentiles = {};
+  ASSERT_EQ(FlutterEngineGetFrameTimingPercentiles(
+                engine.get(), kFlutterImplicitViewId, &percentiles),
+            kInvalidArguments);
+
+  // No frame has been drawn yet.
+  percentiles.struct_size = sizeof(percentiles);
+  ASSERT_EQ(FlutterEngineGetFrameTimingPercentiles(
+                engine.get(), kFlutterImplicitViewId, &percentiles),
+            kSuccess);
+  EXPECT_EQ(percentiles.struct_size, sizeof(percentiles));
+  EXPECT_EQ(percentiles.frame_count, 0u);
+  EXPECT_EQ(percentiles.total.p99_9, 0u);
+
+  // The percentiles are updated before the next frame callback is invoked.
+  fml::AutoResetWaitableEvent callback_latch;
+  VoidCallback callback = [](void* user_data) {
+    static_cast<fml::AutoResetWaitableEvent*>(user_data)->Signal();
+  };
+  ASSERT_EQ(FlutterEngineSetNextFrameCallback(engine.get(), callback,
+                                              &callback_latch),
+            kSuccess);
+
+  FlutterWindowMetricsEvent event = {};
+  event.struct_size = sizeof(event);
+  event.width = 800;
+  event.height = 600;
+  event.pixel_ratio = 1.0;
+  ASSERT_EQ(FlutterEngineSendWindowMetricsEvent(engine.get(), &event),
+            kSuccess);
+  callback_latch.Wait();
+
+  ASSERT_EQ(FlutterEngineGetFrameTimingPercentiles(
+                engine.get(), kFlutterImplicitViewId, &percentiles),
+            kSuccess);
+  EXPECT_GE(percentiles.frame_count, 1u);
+  EXPECT_GT(percentiles.total.p50, 0u);
+  EXPECT_LE(percentiles.total.p50, percentiles.total.p99_9);
+  EXPECT_LE(percentiles.raster.p50, percentiles.total.p50);
+
+  // Views that do not exist have no frames.
+  ASSERT_EQ(FlutterEngineGetFrameTimingPercentiles(engine.get(), 123,
+                                                   &percentiles),
+            kSuccess);
+  EXPECT_EQ(percentiles.frame_count, 0u);
+}
+
 #if defined(FML_OS_MACOSX)
 
 static void MockThreadConfigSetter(const fml::Thread::ThreadConfig& config) {
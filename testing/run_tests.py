@@ -583,12 +583,16 @@ def run_engine_benchmarks(build_dir, executable_filter):
 
   run_engine_executable(build_dir, 'fml_benchmarks', executable_filter, icu_flags)
 
+  run_engine_executable(build_dir, 'flow_benchmarks', executable_filter, icu_flags)
+
   run_engine_executable(build_dir, 'ui_benchmarks', executable_filter, icu_flags)
 
   run_engine_executable(build_dir, 'display_list_builder_benchmarks', executable_filter, icu_flags)
 
   run_engine_executable(build_dir, 'geometry_benchmarks', executable_filter, icu_flags)
 
+  run_engine_executable(build_dir, 'typographer_benchmarks', executable_filter, icu_flags)
+
   if is_linux():
     run_engine_executable(build_dir, 'txt_benchmarks', executable_filter, icu_flags)
 